@@ -0,0 +1,106 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+/*
+ * Helpers shared by the microbenchmarks in this directory.
+ *
+ * Every benchmark program writes its results to stdout as JSON, one object per line:
+ *
+ *     {"benchmark": "coaddPsf.computeKernelImage", "params": {"nInputs": 16}, "iterations": 200,
+ *      "mean": 0.00123, "min": 0.00118}
+ *
+ * where mean and min are the mean and fastest time of one iteration, in seconds.  runBenchmarks.py runs
+ * all the programs and collects their results, so that they can be compared across releases.
+ */
+#ifndef LSST_MEAS_ALGORITHMS_BENCHMARKS_Benchmark_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_BENCHMARKS_Benchmark_h_INCLUDED
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace benchmarks {
+
+/// Name and value of each parameter of a benchmark.
+typedef std::vector<std::pair<std::string, double>> Parameters;
+
+struct Timing {
+    int iterations;
+    double mean;  // mean time of an iteration (s)
+    double min;   // fastest iteration (s)
+};
+
+/// Return the number of iterations given on the command line, or defaultIter if there is none.
+inline int getIterations(int argc, char** argv, int defaultIter) {
+    int const nIter = (argc > 1) ? std::atoi(argv[1]) : defaultIter;
+    return std::max(nIter, 1);
+}
+
+/**
+ * Time nIter calls to function(i), for i = 0, ..., nIter - 1.
+ *
+ * Any setup that shouldn't be timed (e.g. copying an image that the benchmark modifies) should be done
+ * by the caller, or by passing setup, which is called with i before each timed call.
+ */
+template <typename Function, typename Setup>
+Timing timeIt(int nIter, Function&& function, Setup&& setup) {
+    Timing timing = {nIter, 0.0, std::numeric_limits<double>::infinity()};
+    for (int i = 0; i < nIter; ++i) {
+        setup(i);
+        auto const start = std::chrono::steady_clock::now();
+        function(i);
+        std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+        timing.mean += elapsed.count();
+        timing.min = std::min(timing.min, elapsed.count());
+    }
+    timing.mean /= nIter;
+    return timing;
+}
+
+template <typename Function>
+Timing timeIt(int nIter, Function&& function) {
+    return timeIt(nIter, std::forward<Function>(function), [](int) {});
+}
+
+/// Write the result of one benchmark as a line of JSON.
+inline void report(std::string const& name, Parameters const& params, Timing const& timing,
+                   std::ostream& os = std::cout) {
+    auto const precision = os.precision(8);
+    os << "{\"benchmark\": \"" << name << "\", \"params\": {";
+    for (std::size_t i = 0; i < params.size(); ++i) {
+        os << (i == 0 ? "" : ", ") << "\"" << params[i].first << "\": " << params[i].second;
+    }
+    os << "}, \"iterations\": " << timing.iterations << ", \"mean\": " << timing.mean
+       << ", \"min\": " << timing.min << "}" << std::endl;
+    os.precision(precision);
+}
+
+}  // namespace benchmarks
+
+#endif  // !LSST_MEAS_ALGORITHMS_BENCHMARKS_Benchmark_h_INCLUDED
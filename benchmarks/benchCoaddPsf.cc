@@ -0,0 +1,91 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+/*
+ * Benchmark CoaddPsf::computeKernelImage against the number of inputs contributing at each position.
+ *
+ * Usage: benchCoaddPsf [nIter]
+ *
+ * Each input is an HSC-sized CCD with a DoubleGaussianPsf whose Wcs is rotated and shifted slightly with
+ * respect to the coadd's, so every input's kernel image must really be warped.
+ */
+#include <memory>
+
+#include "lsst/geom/Angle.h"
+#include "lsst/geom/Box.h"
+#include "lsst/geom/SpherePoint.h"
+#include "lsst/afw/geom/SkyWcs.h"
+#include "lsst/afw/table/Exposure.h"
+#include "lsst/meas/algorithms/CoaddPsf.h"
+#include "lsst/meas/algorithms/DoubleGaussianPsf.h"
+
+#include "Benchmark.h"
+
+namespace geom = lsst::geom;
+namespace afwGeom = lsst::afw::geom;
+namespace afwTable = lsst::afw::table;
+namespace measAlg = lsst::meas::algorithms;
+
+namespace {
+
+double const PIXEL_SCALE = 0.168;  // arcsec
+geom::SpherePoint const CENTER(45.0 * geom::degrees, 10.0 * geom::degrees);
+
+std::shared_ptr<measAlg::CoaddPsf> makeCoaddPsf(int nInputs, afwGeom::SkyWcs const& coaddWcs) {
+    afwTable::Schema schema = afwTable::ExposureTable::makeMinimalSchema();
+    afwTable::Key<double> const weightKey = schema.addField<double>("weight", "coadd weight");
+    afwTable::ExposureCatalog catalog(schema);
+    for (int i = 0; i < nInputs; ++i) {
+        std::shared_ptr<afwTable::ExposureRecord> record = catalog.addNew();
+        record->setId(i);
+        record->set(weightKey, 1.0 + 0.01 * i);
+        record->setBBox(geom::Box2I(geom::Point2I(0, 0), geom::Extent2I(2048, 4176)));
+        record->setPsf(std::make_shared<measAlg::DoubleGaussianPsf>(25, 25, 1.5 + 0.01 * i, 3.5, 0.1));
+        // Dithers of up to a few hundred pixels, with small rotations
+        geom::SpherePoint const crval = CENTER.offset((37.0 * i) * geom::degrees,
+                                                      (5.0 * (i % 8)) * PIXEL_SCALE * geom::arcseconds);
+        record->setWcs(afwGeom::makeSkyWcs(geom::Point2D(1024.0, 2088.0), crval,
+                                           afwGeom::makeCdMatrix(PIXEL_SCALE * geom::arcseconds,
+                                                                 (0.5 * i) * geom::degrees)));
+    }
+    return std::make_shared<measAlg::CoaddPsf>(catalog, coaddWcs);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int const nIter = benchmarks::getIterations(argc, argv, 200);
+
+    auto const coaddWcs = afwGeom::makeSkyWcs(geom::Point2D(2000.0, 2000.0), CENTER,
+                                              afwGeom::makeCdMatrix(PIXEL_SCALE * geom::arcseconds));
+    for (int nInputs : {1, 4, 16, 64}) {
+        auto const psf = makeCoaddPsf(nInputs, *coaddWcs);
+        // Vary the position so neither the Psf's own cache nor the kernel image cache is used
+        benchmarks::Timing const timing = benchmarks::timeIt(nIter, [&psf](int i) {
+            psf->computeKernelImage(geom::Point2D(2000.0 + 0.37 * i, 2000.0 - 0.23 * i));
+        });
+        benchmarks::report("coaddPsf.computeKernelImage", {{"nInputs", nInputs}}, timing);
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+/*
+ * Benchmark findCosmicRays on a synthetic 4k x 4k frame with injected cosmic rays.
+ *
+ * Usage: benchCosmicRays [nIter]
+ */
+#include <cmath>
+#include <memory>
+
+#include "lsst/daf/base.h"
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/afw/math/Random.h"
+#include "lsst/meas/algorithms/CR.h"
+#include "lsst/meas/algorithms/DoubleGaussianPsf.h"
+
+#include "Benchmark.h"
+
+namespace afwImage = lsst::afw::image;
+namespace afwMath = lsst::afw::math;
+namespace measAlg = lsst::meas::algorithms;
+
+namespace {
+
+typedef afwImage::MaskedImage<float> MaskedImage;
+
+int const SIZE = 4096;
+
+MaskedImage makeImage(double background, int nCr) {
+    MaskedImage mimage(lsst::geom::Extent2I(SIZE, SIZE));
+    afwMath::Random rand;
+    double const sigma = std::sqrt(background);
+    for (int y = 0; y < SIZE; ++y) {
+        auto ptr = mimage.row_begin(y);
+        for (int x = 0; x < SIZE; ++x, ++ptr) {
+            ptr.image() = background + sigma * rand.gaussian();
+            ptr.variance() = background;
+        }
+    }
+    // Short tracks of hot pixels in random directions
+    for (int i = 0; i < nCr; ++i) {
+        int const x0 = 4 + static_cast<int>(rand.flat(0, SIZE - 8));
+        int const y0 = 4 + static_cast<int>(rand.flat(0, SIZE - 8));
+        int const dx = static_cast<int>(rand.flat(-1, 2));
+        int const dy = static_cast<int>(rand.flat(-1, 2));
+        int const length = 1 + static_cast<int>(rand.flat(0, 6));
+        for (int k = 0; k < length; ++k) {
+            int const x = x0 + k * dx;
+            int const y = y0 + k * dy;
+            if (x > 1 && x < SIZE - 2 && y > 1 && y < SIZE - 2) {
+                mimage.at(x, y).image() += rand.flat(300, 3000);
+            }
+        }
+    }
+    return mimage;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int const nIter = benchmarks::getIterations(argc, argv, 3);
+    double const background = 1000.0;
+    int const nCr = 6000;
+
+    MaskedImage const original = makeImage(background, nCr);
+    measAlg::DoubleGaussianPsf const psf(29, 29, 2.0, 4.0, 0.1);
+
+    lsst::daf::base::PropertySet ps;
+    ps.set("minSigma", 6.0);
+    ps.set("min_DN", 150.0);
+    ps.set("cond3_fac", 2.5);
+    ps.set("cond3_fac2", 0.6);
+    ps.set("niteration", 3);
+    ps.set("nCrPixelMax", 1000000);
+
+    for (int nThreads : {1, 4}) {
+        ps.set("nThreads", nThreads);
+        std::shared_ptr<MaskedImage> mimage;
+        benchmarks::Timing const timing = benchmarks::timeIt(
+                nIter, [&](int) { measAlg::findCosmicRays(*mimage, psf, background, ps); },
+                [&](int) { mimage = std::make_shared<MaskedImage>(original, true); });
+        benchmarks::report("cosmicRays.findCosmicRays",
+                           {{"size", SIZE}, {"nCr", nCr}, {"nThreads", nThreads}}, timing);
+    }
+    return 0;
+}
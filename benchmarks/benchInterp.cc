@@ -0,0 +1,101 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+/*
+ * Benchmark defect interpolation on a 4k x 4k frame against the number of defects, both building the
+ * CompiledDefectMap and interpolating over it.
+ *
+ * Usage: benchInterp [nIter]
+ *
+ * The defects are mostly narrow columns, like the bad columns of a real CCD.
+ */
+#include <memory>
+#include <vector>
+
+#include "lsst/geom/Box.h"
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/afw/math/Random.h"
+#include "lsst/meas/algorithms/Interp.h"
+
+#include "Benchmark.h"
+
+namespace geom = lsst::geom;
+namespace afwImage = lsst::afw::image;
+namespace afwMath = lsst::afw::math;
+namespace measAlg = lsst::meas::algorithms;
+
+namespace {
+
+typedef afwImage::MaskedImage<float> MaskedImage;
+
+int const SIZE = 4096;
+
+std::vector<measAlg::Defect::Ptr> makeDefects(int nDefect, afwMath::Random& rand) {
+    std::vector<measAlg::Defect::Ptr> defects;
+    defects.reserve(nDefect);
+    for (int i = 0; i < nDefect; ++i) {
+        // One in ten defects is a wide block; the rest are 1-4 pixels across
+        int const width = (i % 10 == 9) ? 5 + static_cast<int>(rand.flat(0, 20))
+                                        : 1 + static_cast<int>(rand.flat(0, 4));
+        int const height = 1 + static_cast<int>(rand.flat(0, SIZE / 4));
+        int const x0 = static_cast<int>(rand.flat(0, SIZE - width));
+        int const y0 = static_cast<int>(rand.flat(0, SIZE - height));
+        geom::Box2I const bbox(geom::Point2I(x0, y0), geom::Extent2I(width, height));
+        defects.push_back(std::make_shared<measAlg::Defect>(bbox));
+    }
+    return defects;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int const nIter = benchmarks::getIterations(argc, argv, 5);
+
+    afwMath::Random rand;
+    MaskedImage original(geom::Extent2I(SIZE, SIZE));
+    for (int y = 0; y < SIZE; ++y) {
+        auto ptr = original.row_begin(y);
+        for (int x = 0; x < SIZE; ++x, ++ptr) {
+            ptr.image() = 1000.0 + 30.0 * rand.gaussian();
+            ptr.variance() = 900.0;
+        }
+    }
+
+    for (int nDefect : {10, 100, 1000}) {
+        std::vector<measAlg::Defect::Ptr> const defects = makeDefects(nDefect, rand);
+
+        benchmarks::Timing const compileTiming = benchmarks::timeIt(
+                nIter, [&](int) { measAlg::CompiledDefectMap const defectMap(defects, original.getBBox()); });
+        benchmarks::report("interp.compiledDefectMap", {{"size", SIZE}, {"nDefect", nDefect}}, compileTiming);
+
+        measAlg::CompiledDefectMap const defectMap(defects, original.getBBox());
+        std::shared_ptr<MaskedImage> mimage;
+        benchmarks::Timing const interpTiming = benchmarks::timeIt(
+                nIter, [&](int) { measAlg::interpolateOverDefects(*mimage, defectMap, 0.0, true); },
+                [&](int) { mimage = std::make_shared<MaskedImage>(original, true); });
+        benchmarks::report("interp.interpolateOverDefects", {{"size", SIZE}, {"nDefect", nDefect}},
+                           interpTiming);
+    }
+    return 0;
+}
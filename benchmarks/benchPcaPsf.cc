@@ -0,0 +1,170 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+/*
+ * Benchmark the PCA PSF fit (createKernelFromPsfCandidates followed by the linear spatial fit in
+ * fitSpatialKernelFromPsfCandidates) against the number of PSF candidates.
+ *
+ * Usage: benchPcaPsf [nIter]
+ *
+ * The stars are circular Gaussians on a noisy 2k x 2k image; createKernelFromPsfCandidates is timed with a
+ * fresh set of candidates every iteration, so the time includes extracting their stamps.
+ */
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "lsst/geom/Box.h"
+#include "lsst/afw/image/Exposure.h"
+#include "lsst/afw/math/Random.h"
+#include "lsst/afw/math/SpatialCell.h"
+#include "lsst/afw/table/Source.h"
+#include "lsst/afw/table/aggregates.h"
+#include "lsst/meas/algorithms/PsfCandidate.h"
+#include "lsst/meas/algorithms/SpatialModelPsf.h"
+
+#include "Benchmark.h"
+
+namespace geom = lsst::geom;
+namespace afwImage = lsst::afw::image;
+namespace afwMath = lsst::afw::math;
+namespace afwTable = lsst::afw::table;
+namespace measAlg = lsst::meas::algorithms;
+
+namespace {
+
+typedef afwImage::Exposure<float> Exposure;
+
+int const SIZE = 2048;
+int const KSIZE = 21;
+int const BORDER = 3;
+
+struct Star {
+    double x;
+    double y;
+};
+
+std::vector<Star> makeStars(int nStar, afwMath::Random& rand) {
+    std::vector<Star> stars;
+    stars.reserve(nStar);
+    double const margin = KSIZE;
+    for (int i = 0; i < nStar; ++i) {
+        stars.push_back({rand.flat(margin, SIZE - margin), rand.flat(margin, SIZE - margin)});
+    }
+    return stars;
+}
+
+std::shared_ptr<Exposure> makeExposure(std::vector<Star> const& stars, afwMath::Random& rand) {
+    double const sky = 100.0;
+    auto exposure = std::make_shared<Exposure>(geom::Extent2I(SIZE, SIZE));
+    afwImage::MaskedImage<float>& mimage = exposure->getMaskedImage();
+    for (int y = 0; y < SIZE; ++y) {
+        auto ptr = mimage.row_begin(y);
+        for (int x = 0; x < SIZE; ++x, ++ptr) {
+            ptr.image() = std::sqrt(sky) * rand.gaussian();
+            ptr.variance() = sky;
+        }
+    }
+    // Circular Gaussians whose width varies slowly across the image
+    int const half = KSIZE / 2 + BORDER;
+    for (Star const& star : stars) {
+        double const sigma = 1.5 + 0.3 * star.x / SIZE + 0.2 * star.y / SIZE;
+        double const amplitude = 10000.0 / (2 * M_PI * sigma * sigma);
+        int const x0 = static_cast<int>(star.x);
+        int const y0 = static_cast<int>(star.y);
+        for (int y = y0 - half; y <= y0 + half; ++y) {
+            for (int x = x0 - half; x <= x0 + half; ++x) {
+                double const r2 = (x - star.x) * (x - star.x) + (y - star.y) * (y - star.y);
+                double const value = amplitude * std::exp(-0.5 * r2 / (sigma * sigma));
+                mimage.at(x, y).image() += value;
+                mimage.at(x, y).variance() += value;
+            }
+        }
+    }
+    return exposure;
+}
+
+std::shared_ptr<afwMath::SpatialCellSet> makeCells(afwTable::SourceCatalog const& catalog,
+                                                   std::shared_ptr<Exposure> const& exposure) {
+    auto cells = std::make_shared<afwMath::SpatialCellSet>(exposure->getBBox(), 256, 256);
+    for (std::size_t i = 0; i < catalog.size(); ++i) {
+        auto const candidate = measAlg::makePsfCandidate(catalog.get(i), exposure);
+        candidate->setWidth(KSIZE);
+        candidate->setHeight(KSIZE);
+        cells->insertCandidate(candidate);
+    }
+    return cells;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int const nIter = benchmarks::getIterations(argc, argv, 5);
+    int const nEigenComponents = 4;
+    int const spatialOrder = 2;
+
+    measAlg::PsfCandidate<float>::setMaskBlends(false);
+    measAlg::PsfCandidate<float>::setBorderWidth(BORDER);
+
+    afwTable::Schema schema = afwTable::SourceTable::makeMinimalSchema();
+    afwTable::PointKey<double> const centroidKey =
+            afwTable::PointKey<double>::addFields(schema, "centroid", "star position", "pixel");
+    schema.addField<afwTable::Flag>("centroid_flag", "centroid failed");
+    schema.getAliasMap()->set("slot_Centroid", "centroid");
+
+    for (int nCandidate : {25, 100, 400}) {
+        afwMath::Random rand;
+        std::vector<Star> const stars = makeStars(nCandidate, rand);
+        std::shared_ptr<Exposure> const exposure = makeExposure(stars, rand);
+
+        afwTable::SourceCatalog catalog(schema);
+        for (Star const& star : stars) {
+            catalog.addNew()->set(centroidKey, geom::Point2D(star.x, star.y));
+        }
+        benchmarks::Parameters const params = {{"nCandidate", nCandidate},
+                                               {"nEigenComponents", nEigenComponents},
+                                               {"spatialOrder", spatialOrder}};
+
+        std::shared_ptr<afwMath::SpatialCellSet> cells;
+        benchmarks::Timing const createTiming = benchmarks::timeIt(
+                nIter,
+                [&](int) {
+                    measAlg::createKernelFromPsfCandidates<float>(*cells, exposure->getDimensions(),
+                                                                  exposure->getXY0(), nEigenComponents,
+                                                                  spatialOrder, KSIZE, -1, true, BORDER);
+                },
+                [&](int) { cells = makeCells(catalog, exposure); });
+        benchmarks::report("pcaPsf.createKernel", params, createTiming);
+
+        auto const kernel = measAlg::createKernelFromPsfCandidates<float>(
+                                    *cells, exposure->getDimensions(), exposure->getXY0(), nEigenComponents,
+                                    spatialOrder, KSIZE, -1, true, BORDER)
+                                    .first;
+        benchmarks::Timing const fitTiming = benchmarks::timeIt(nIter, [&](int) {
+            measAlg::fitSpatialKernelFromPsfCandidates<float>(kernel.get(), *cells, false);
+        });
+        benchmarks::report("pcaPsf.fitSpatialKernel", params, fitTiming);
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+/*
+ * Benchmark WarpedPsf::computeKernelImage against the size of the kernel image, warping with
+ * afw::math::warpImage and with LanczosStampWarper.
+ *
+ * Usage: benchWarpedPsf [nIter]
+ */
+#include <memory>
+
+#include "lsst/geom/AffineTransform.h"
+#include "lsst/afw/geom/transformFactory.h"
+#include "lsst/afw/math/warpExposure.h"
+#include "lsst/meas/algorithms/DoubleGaussianPsf.h"
+#include "lsst/meas/algorithms/LanczosStampWarper.h"
+#include "lsst/meas/algorithms/WarpedPsf.h"
+
+#include "Benchmark.h"
+
+namespace geom = lsst::geom;
+namespace afwGeom = lsst::afw::geom;
+namespace afwMath = lsst::afw::math;
+namespace measAlg = lsst::meas::algorithms;
+
+int main(int argc, char** argv) {
+    int const nIter = benchmarks::getIterations(argc, argv, 2000);
+
+    // A mild rotation plus scale, typical of the exposure-to-coadd mapping.
+    auto const distortion = afwGeom::makeTransform(
+            geom::AffineTransform(geom::LinearTransform::makeRotation(0.3 * geom::radians) *
+                                  geom::LinearTransform::makeScaling(1.02, 0.98)));
+    auto const control = std::make_shared<afwMath::WarpingControl>("lanczos3", "", 10000);
+    auto const stampWarper = measAlg::LanczosStampWarper::fromWarpingControl(*control);
+
+    for (int size : {15, 21, 31, 41, 61}) {
+        auto const undistorted = std::make_shared<measAlg::DoubleGaussianPsf>(size, size, 2.0, 4.0, 0.1);
+        for (bool useStampWarper : {false, true}) {
+            auto const psf = std::make_shared<measAlg::WarpedPsf>(undistorted, distortion, control, 0.0, 0,
+                                                                  useStampWarper ? stampWarper : nullptr);
+            // Vary the sub-pixel position so every call does a real warp.
+            benchmarks::Timing const timing = benchmarks::timeIt(nIter, [&psf](int i) {
+                psf->computeKernelImage(geom::Point2D(1000.0 + 0.37 * i, 1000.0 - 0.23 * i));
+            });
+            benchmarks::report("warpedPsf.computeKernelImage",
+                               {{"size", size}, {"useStampWarper", useStampWarper}}, timing);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+#!/usr/bin/env python
+
+#
+# LSST Data Management System
+# Copyright 2008-2018 LSST Corporation.
+#
+# This product includes software developed by the
+# LSST Project (http://www.lsst.org/).
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the LSST License Statement and
+# the GNU General Public License along with this program.  If not,
+# see <http://www.lsstcorp.org/LegalNotices/>.
+#
+
+
+"""Run the microbenchmarks in this directory and collect their results as a single JSON document.
+
+Usage: runBenchmarks.py [--output results.json] [--iterations N] [name ...]
+
+Every executable named bench* in this directory is run, or just those given by name.  Each benchmark
+writes one line of JSON per result; these are gathered, along with the package version, host and date,
+so that runs from different releases or machines can be compared.
+"""
+import argparse
+import datetime
+import json
+import os
+import platform
+import subprocess
+import sys
+
+
+def findBenchmarks(directory, names=None):
+    """Return the paths of the benchmark executables in directory, optionally restricted to names."""
+    paths = []
+    for filename in sorted(os.listdir(directory)):
+        path = os.path.join(directory, filename)
+        if not filename.startswith("bench") or os.path.splitext(filename)[1]:
+            continue
+        if not (os.path.isfile(path) and os.access(path, os.X_OK)):
+            continue
+        if names and filename not in names:
+            continue
+        paths.append(path)
+    return paths
+
+
+def runBenchmark(path, iterations=None):
+    """Run one benchmark and return the list of results it reports."""
+    command = [path] if iterations is None else [path, str(iterations)]
+    output = subprocess.check_output(command, universal_newlines=True)
+    return [json.loads(line) for line in output.splitlines() if line.strip()]
+
+
+def getVersion():
+    try:
+        from lsst.meas.algorithms.version import __version__
+    except ImportError:
+        return None
+    return __version__
+
+
+def run(names=None, iterations=None, output=None):
+    directory = os.path.dirname(os.path.abspath(__file__))
+    paths = findBenchmarks(directory, names)
+    if not paths:
+        sys.exit("No benchmarks found in %s; build them with \"scons lib benchmarks\"" % directory)
+
+    results = []
+    for path in paths:
+        print("Running %s" % os.path.basename(path), file=sys.stderr)
+        results.extend(runBenchmark(path, iterations))
+
+    document = dict(
+        package="meas_algorithms",
+        version=getVersion(),
+        host=platform.node(),
+        platform=platform.platform(),
+        date=datetime.datetime.now().isoformat(),
+        results=results,
+    )
+    if output is None:
+        json.dump(document, sys.stdout, indent=2)
+        print()
+    else:
+        with open(output, "w") as fd:
+            json.dump(document, fd, indent=2)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("names", nargs="*", help="Benchmarks to run (default: all)")
+    parser.add_argument("--output", "-o", help="File to write the results to (default: stdout)")
+    parser.add_argument("--iterations", "-n", type=int,
+                        help="Iterations of each benchmark (default: its own)")
+    args = parser.parse_args()
+    run(args.names, args.iterations, args.output)
@@ -0,0 +1,121 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/*
+ * Benchmark findCosmicRays on an HSC-sized CCD (2048x4176 pixels).
+ *
+ * Usage: crBenchmark [nIter [file.fits [background]]]
+ *
+ * If a file is given its MaskedImage is used (e.g. a background-subtracted HSC calexp, in which case
+ * background should be 0); otherwise a synthetic image with Gaussian noise and a few thousand cosmic
+ * rays is generated.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "lsst/daf/base.h"
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/afw/math/Random.h"
+#include "lsst/meas/algorithms/CR.h"
+#include "lsst/meas/algorithms/DoubleGaussianPsf.h"
+
+namespace afwImage = lsst::afw::image;
+namespace afwMath = lsst::afw::math;
+namespace measAlg = lsst::meas::algorithms;
+
+namespace {
+
+typedef afwImage::MaskedImage<float> MaskedImage;
+
+int const HSC_WIDTH = 2048;
+int const HSC_HEIGHT = 4176;
+
+MaskedImage makeImage(double background) {
+    MaskedImage mimage(lsst::geom::Extent2I(HSC_WIDTH, HSC_HEIGHT));
+    afwMath::Random rand;
+    double const sigma = std::sqrt(background);
+    for (int y = 0; y < HSC_HEIGHT; ++y) {
+        auto ptr = mimage.row_begin(y);
+        for (int x = 0; x < HSC_WIDTH; ++x, ++ptr) {
+            ptr.image() = background + sigma * rand.gaussian();
+            ptr.variance() = background;
+        }
+    }
+    // Short tracks of hot pixels in random directions
+    for (int i = 0; i < 3000; ++i) {
+        int const x0 = 4 + static_cast<int>(rand.flat(0, HSC_WIDTH - 8));
+        int const y0 = 4 + static_cast<int>(rand.flat(0, HSC_HEIGHT - 8));
+        int const dx = static_cast<int>(rand.flat(-1, 2));
+        int const dy = static_cast<int>(rand.flat(-1, 2));
+        int const length = 1 + static_cast<int>(rand.flat(0, 6));
+        for (int k = 0; k < length; ++k) {
+            int const x = x0 + k * dx;
+            int const y = y0 + k * dy;
+            if (x > 1 && x < HSC_WIDTH - 2 && y > 1 && y < HSC_HEIGHT - 2) {
+                mimage.at(x, y).image() += rand.flat(300, 3000);
+            }
+        }
+    }
+    return mimage;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int const nIter = (argc > 1) ? std::atoi(argv[1]) : 3;
+    std::string const filename = (argc > 2) ? argv[2] : "";
+    double const background = (argc > 3) ? std::atof(argv[3]) : (filename.empty() ? 1000.0 : 0.0);
+
+    MaskedImage const original = filename.empty() ? makeImage(background) : MaskedImage(filename);
+    measAlg::DoubleGaussianPsf const psf(29, 29, 2.0, 4.0, 0.1);
+
+    lsst::daf::base::PropertySet ps;
+    ps.set("minSigma", 6.0);
+    ps.set("min_DN", 150.0);
+    ps.set("cond3_fac", 2.5);
+    ps.set("cond3_fac2", 0.6);
+    ps.set("niteration", 3);
+    ps.set("nCrPixelMax", 1000000);
+
+    std::cout << original.getWidth() << "x" << original.getHeight() << " pixels\n";
+    std::cout << "nThreads  nCR  time(ms)  Mpix/s\n";
+    for (int nThreads : {1, 2, 4, 8}) {
+        ps.set("nThreads", nThreads);
+        std::size_t nCr = 0;
+        double elapsed = 0.0;
+        for (int i = 0; i < nIter; ++i) {
+            MaskedImage mimage(original, true);
+            auto const start = std::chrono::steady_clock::now();
+            nCr = measAlg::findCosmicRays(mimage, psf, background, ps).size();
+            elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        double const perCall = elapsed / nIter;
+        std::cout << nThreads << "  " << nCr << "  " << 1e3 * perCall << "  "
+                  << 1e-6 * original.getWidth() * original.getHeight() / perCall << "\n";
+    }
+    return 0;
+}
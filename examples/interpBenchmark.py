@@ -0,0 +1,91 @@
+#!/usr/bin/env python
+
+#
+# LSST Data Management System
+# Copyright 2008-2018 LSST Corporation.
+#
+# This product includes software developed by the
+# LSST Project (http://www.lsst.org/).
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the LSST License Statement and
+# the GNU General Public License along with this program.  If not,
+# see <http://www.lsstcorp.org/LegalNotices/>.
+#
+
+"""Time interpolateOverDefects for a real defect list and for synthetic bad columns of various widths.
+
+Usage: interpBenchmark.py [nIter [defects.ecsv]]
+
+The default defect list is policy/BadPixels.ecsv.  Bad columns up to 4 pixels wide are handled by
+the specialized narrow-defect kernels and wider ones by the general code, so comparing the widths shows
+what the specialization buys; run against an older build to compare the real list.
+"""
+import os
+import sys
+import time
+
+import numpy as np
+
+import lsst.geom
+import lsst.afw.image as afwImage
+import lsst.meas.algorithms as measAlg
+import lsst.utils
+
+WIDTH, HEIGHT = 2048, 4611  # the size of the CCD BadPixels.ecsv describes
+
+
+def makeImage(seed=1):
+    rng = np.random.RandomState(seed)
+    mi = afwImage.MaskedImageF(lsst.geom.ExtentI(WIDTH, HEIGHT))
+    mi.image.array[:] = rng.normal(1000.0, 30.0, (HEIGHT, WIDTH))
+    mi.variance.set(900.0)
+    mi.mask.addMaskPlane("INTERP")
+    return mi
+
+
+def makeColumns(width, spacing=16):
+    """Return full-height bad columns of the given width, every spacing pixels."""
+    defects = measAlg.Defects()
+    for x0 in range(8, WIDTH - 8 - width, spacing):
+        defects.append(lsst.geom.BoxI(lsst.geom.PointI(x0, 0), lsst.geom.ExtentI(width, HEIGHT)))
+    return defects
+
+
+def timeDefects(original, defects, nIter):
+    """Return the mean time to interpolate over defects, and the number of bad pixels."""
+    defectMap = defects.compile(original.getBBox())
+    elapsed = 0.0
+    for i in range(nIter):
+        mi = original.clone()
+        start = time.time()
+        measAlg.interpolateOverDefects(mi, defectMap, 0.0, True)
+        elapsed += time.time() - start
+    return elapsed/nIter, np.count_nonzero(mi.mask.array & mi.mask.getPlaneBitMask("INTERP"))
+
+
+def run(nIter=5, filename=None):
+    if filename is None:
+        filename = os.path.join(lsst.utils.getPackageDir("meas_algorithms"), "policy", "BadPixels.ecsv")
+    original = makeImage()
+
+    print("%-20s %10s %10s %10s" % ("defects", "time (ms)", "bad pix", "Mpix/s"))
+    cases = [(os.path.basename(filename), measAlg.Defects.readText(filename))]
+    cases += [("columns, width %d" % width, makeColumns(width)) for width in (1, 2, 3, 4, 5, 8)]
+    for name, defects in cases:
+        elapsed, nBad = timeDefects(original, defects, nIter)
+        print("%-20s %10.2f %10d %10.1f" % (name, 1e3*elapsed, nBad, 1e-6*nBad/elapsed))
+
+
+if __name__ == "__main__":
+    nIter = int(sys.argv[1]) if len(sys.argv) > 1 else 5
+    run(nIter, sys.argv[2] if len(sys.argv) > 2 else None)
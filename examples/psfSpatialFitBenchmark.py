@@ -0,0 +1,122 @@
+#!/usr/bin/env python
+
+#
+# LSST Data Management System
+# Copyright 2008-2018 LSST Corporation.
+#
+# This product includes software developed by the
+# LSST Project (http://www.lsst.org/).
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the LSST License Statement and
+# the GNU General Public License along with this program.  If not,
+# see <http://www.lsstcorp.org/LegalNotices/>.
+#
+
+"""Compare the wall-clock time of the linear and non-linear (Minuit) spatial fits in the PCA PSF determiner.
+
+Usage: psfSpatialFitBenchmark.py [nStar [nIter]]
+
+The stars are drawn from a double Gaussian whose core fraction varies linearly over the image, in the
+same way as tests/test_psfDetermination.py does.
+"""
+import sys
+import time
+
+import numpy as np
+
+import lsst.geom
+import lsst.afw.detection as afwDetection
+import lsst.afw.image as afwImage
+import lsst.afw.table as afwTable
+import lsst.daf.base as dafBase
+import lsst.meas.algorithms as measAlg
+import lsst.meas.base as measBase
+
+
+def makeExposure(nStar, width=1024, height=1024, ksize=31, sd=3.0, seed=1):
+    """Make an Exposure containing nStar stars with a spatially-varying PSF."""
+    rng = np.random.RandomState(seed)
+    mi = afwImage.MaskedImageF(lsst.geom.ExtentI(width, height))
+    mi.image.array[:] = rng.normal(0.0, sd, (height, width))
+    mi.variance.set(sd*sd)
+    mi.mask.addMaskPlane("DETECTED")
+
+    sigma1, sigma2 = 1.75, 3.5
+    half = ksize//2
+    iy, ix = np.mgrid[-half:half + 1, -half:half + 1]
+    for x, y in zip(rng.uniform(half, width - half - 1, nStar), rng.uniform(half, height - half - 1, nStar)):
+        x0, y0 = int(x), int(y)
+        dx, dy = ix + x0 - x, iy + y0 - y
+        k = 0.5e-2*x/width + 0.2e-2*y/height  # functional variation of the PSF ...
+        b = k*sigma1**2/((1 - k)*sigma2**2)    # ... converted to a double Gaussian's "b"
+        r2 = dx**2 + dy**2
+        psf = np.exp(-0.5*r2/sigma1**2) + b*np.exp(-0.5*r2/sigma2**2)
+        flux = 80000*(1 + 0.1*(rng.uniform() - 0.5))
+        intensity = flux*psf/psf.sum()
+        stamp = (slice(y0 - half, y0 + half + 1), slice(x0 - half, x0 + half + 1))
+        mi.image.array[stamp] += rng.poisson(intensity)
+        mi.variance.array[stamp] += intensity
+
+    exposure = afwImage.makeExposure(mi)
+    exposure.setPsf(measAlg.DoubleGaussianPsf(ksize, ksize, 1.5*sigma1, 1, 0.1))
+    return exposure
+
+
+def measure(exposure):
+    """Detect and measure the stars, returning a SourceCatalog."""
+    schema = afwTable.SourceTable.makeMinimalSchema()
+    config = measBase.SingleFrameMeasurementConfig()
+    config.algorithms.names = ["base_PixelFlags", "base_SdssCentroid", "base_SdssShape", "base_PsfFlux"]
+    config.slots.centroid = "base_SdssCentroid"
+    config.slots.psfFlux = "base_PsfFlux"
+    config.slots.shape = "base_SdssShape"
+    for slot in ("apFlux", "modelFlux", "gaussianFlux", "calibFlux"):
+        setattr(config.slots, slot, None)
+    measureTask = measBase.SingleFrameMeasurementTask(schema, config=config)
+
+    footprintSet = afwDetection.FootprintSet(exposure.getMaskedImage(), afwDetection.Threshold(100),
+                                             "DETECTED")
+    catalog = afwTable.SourceCatalog(schema)
+    footprintSet.makeSources(catalog)
+    measureTask.run(catalog, exposure)
+    return catalog
+
+
+def run(nStar=200, nIter=3):
+    exposure = makeExposure(nStar)
+    catalog = measure(exposure)
+
+    print("%d sources" % len(catalog))
+    print("%-10s %10s %14s" % ("fit", "time (s)", "spatialFitChi2"))
+    for nonLinear in (False, True):
+        config = measAlg.PcaPsfDeterminerTask.ConfigClass()
+        config.nonLinearSpatialFit = nonLinear
+        config.spatialOrder = 1
+        config.kernelSizeMin = 31
+        determiner = measAlg.PcaPsfDeterminerTask(config=config)
+
+        elapsed = 0.0
+        for i in range(nIter):
+            candidates = [measAlg.makePsfCandidate(source, exposure) for source in catalog]
+            metadata = dafBase.PropertyList()
+            start = time.time()
+            determiner.determinePsf(exposure, candidates, metadata)
+            elapsed += time.time() - start
+
+        print("%-10s %10.3f %14.1f" % ("non-linear" if nonLinear else "linear", elapsed/nIter,
+                                       metadata.getScalar("spatialFitChi2")))
+
+
+if __name__ == "__main__":
+    args = [int(a) for a in sys.argv[1:]]
+    run(*args)
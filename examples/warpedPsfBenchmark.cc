@@ -0,0 +1,83 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/*
+ * Microbenchmark comparing afw::math::warpImage with LanczosStampWarper for warping
+ * WarpedPsf kernel images of typical sizes.
+ *
+ * Usage: warpedPsfBenchmark [nIter]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+#include "lsst/geom/AffineTransform.h"
+#include "lsst/afw/geom/transformFactory.h"
+#include "lsst/meas/algorithms/DoubleGaussianPsf.h"
+#include "lsst/meas/algorithms/WarpedPsf.h"
+
+namespace geom = lsst::geom;
+namespace afwGeom = lsst::afw::geom;
+namespace afwMath = lsst::afw::math;
+namespace measAlg = lsst::meas::algorithms;
+
+namespace {
+
+// Return the mean time per kernel image, in microseconds.
+double timePsf(measAlg::WarpedPsf const& psf, int nIter) {
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i < nIter; ++i) {
+        // Vary the sub-pixel position so every call does a real warp.
+        psf.computeKernelImage(geom::Point2D(1000.0 + 0.37 * i, 1000.0 - 0.23 * i));
+    }
+    std::chrono::duration<double, std::micro> const elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / nIter;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int const nIter = (argc > 1) ? std::atoi(argv[1]) : 2000;
+
+    // A mild rotation plus scale, typical of the exposure-to-coadd mapping.
+    auto const distortion = afwGeom::makeTransform(
+            geom::AffineTransform(geom::LinearTransform::makeRotation(0.3 * geom::radians) *
+                                  geom::LinearTransform::makeScaling(1.02, 0.98)));
+
+    std::cout << "kernel    size  warpImage(us)  stampWarper(us)  speedup\n";
+    for (std::string const kernelName : {"lanczos3", "lanczos5"}) {
+        auto const control = std::make_shared<afwMath::WarpingControl>(kernelName, "", 10000);
+        auto const stampWarper = measAlg::LanczosStampWarper::fromWarpingControl(*control);
+        for (int size : {21, 31, 41}) {
+            auto const undistorted = std::make_shared<measAlg::DoubleGaussianPsf>(size, size, 2.0, 4.0, 0.1);
+            measAlg::WarpedPsf afwPsf(undistorted, distortion, control);
+            measAlg::WarpedPsf stampPsf(undistorted, distortion, control, 0.0, 0, stampWarper);
+            double const afwTime = timePsf(afwPsf, nIter);
+            double const stampTime = timePsf(stampPsf, nIter);
+            std::cout << kernelName << "  " << size << "    " << afwTime << "    " << stampTime << "    "
+                      << afwTime / stampTime << "\n";
+        }
+    }
+    return 0;
+}
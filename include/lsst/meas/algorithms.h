@@ -22,12 +22,28 @@
 
 #include "lsst/meas/algorithms/CR.h"
 #include "lsst/meas/algorithms/Interp.h"
+#include "lsst/meas/algorithms/BackgroundStatistics.h"
+#include "lsst/meas/algorithms/DetectionSmoother.h"
+#include "lsst/meas/algorithms/SpanComponents.h"
+#include "lsst/meas/algorithms/FusedDetection.h"
+#include "lsst/meas/algorithms/SkyObjectPlacement.h"
+#include "lsst/meas/algorithms/HtmMesh.h"
+#include "lsst/meas/algorithms/PsfStampArena.h"
 #include "lsst/meas/algorithms/PsfCandidate.h"
 #include "lsst/meas/algorithms/SpatialModelPsf.h"
 #include "lsst/meas/algorithms/KernelPsf.h"
+#include "lsst/meas/algorithms/GaussianPsfMoments.h"
 #include "lsst/meas/algorithms/SingleGaussianPsf.h"
 #include "lsst/meas/algorithms/DoubleGaussianPsf.h"
 #include "lsst/meas/algorithms/PcaPsf.h"
+#include "lsst/meas/algorithms/CoaddInputIndex.h"
 #include "lsst/meas/algorithms/CoaddPsf.h"
+#include "lsst/meas/algorithms/LanczosStampShifter.h"
+#include "lsst/meas/algorithms/LanczosStampWarper.h"
+#include "lsst/meas/algorithms/PsfEvaluationLock.h"
+#include "lsst/meas/algorithms/PsfImageCache.h"
+#include "lsst/meas/algorithms/PsfResultCache.h"
 #include "lsst/meas/algorithms/WarpedPsf.h"
 #include "lsst/meas/algorithms/CoaddBoundedField.h"
+#include "lsst/meas/algorithms/CoaddBoundedFieldSet.h"
+#include "lsst/meas/algorithms/Instrumentation.h"
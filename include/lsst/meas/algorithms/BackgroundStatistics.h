@@ -0,0 +1,79 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_ALGORITHMS_BackgroundStatistics_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_BackgroundStatistics_h_INCLUDED
+
+#include <memory>
+#include <vector>
+
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/afw/math/Statistics.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+/**
+ *  @brief Return the first pixel of each of n background bins along an axis of the given length.
+ *
+ *  The bins are laid out as afw::math::Background lays them out; the last element of the returned
+ *  vector (which has n + 1 elements) is the length.
+ */
+std::vector<int> makeBackgroundBinEdges(int length, int n);
+
+/**
+ *  @brief Compute the statistic of each bin of a background model, in parallel.
+ *
+ *  This computes the same statistics image as afw::math::BackgroundMI, so that a BackgroundMI made
+ *  from it (with the BackgroundMI(bbox, statsImage) constructor) gives the same model.  Each band of
+ *  bins is read a row at a time, gathering each bin's unmasked pixels into its own buffer, and the
+ *  bands are shared among nThreads threads (including the calling one).
+ *
+ *  Pixels with any of the StatisticsControl's andMask bits set, and NaN pixels, are ignored.  MEANCLIP
+ *  starts from the median and interquartile range and clips numIter times at numSigmaClip standard
+ *  deviations, as afw::math::Statistics does.
+ *
+ *  @param[in] image       Image whose background is to be modelled.
+ *  @param[in] nx          Number of bins in x.
+ *  @param[in] ny          Number of bins in y.
+ *  @param[in] sctrl       Mask bits to ignore and clipping parameters.
+ *  @param[in] property    Statistic to compute: MEAN, MEANCLIP or MEDIAN.
+ *  @param[in] nThreads    Number of threads to use.
+ *
+ *  @returns An nx by ny image of the statistic, whose variance is the square of its error (NaN for bins
+ *           with no usable pixels).
+ *
+ *  @throws InvalidParameterError if nx or ny is not positive or greater than the image's size, or the
+ *          property is not supported.
+ */
+template <typename PixelT>
+std::shared_ptr<afw::image::MaskedImage<float>> computeBackgroundStatistics(
+        afw::image::MaskedImage<PixelT> const& image, int nx, int ny,
+        afw::math::StatisticsControl const& sctrl, afw::math::Property property, int nThreads = 1);
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_ALGORITHMS_BackgroundStatistics_h_INCLUDED
@@ -30,6 +30,7 @@
 #include <vector>
 #include "lsst/base.h"
 #include "lsst/daf/base.h"
+#include "lsst/geom/Box.h"
 #include "lsst/afw/image/MaskedImage.h"
 
 namespace lsst {
@@ -45,12 +46,110 @@ namespace lsst {
 namespace meas {
 namespace algorithms {
 
+/**
+ * @brief Everything findCosmicRays needs that doesn't depend on the pixel values
+ *
+ * Building a context parses the PropertySet, looks up the mask planes and realises the PSF to compute the
+ * thresholds for condition #3.  A context can be built once per exposure and passed to repeated calls of
+ * findCosmicRays.
+ *
+ * By default the PSF is realised once, at its average position.  If a bbox and a grid are given the PSF
+ * is instead realised at the centre of each cell of an nx x ny grid covering the bbox, and the thresholds
+ * are interpolated bilinearly between the cell centres, following a PSF that varies over the image.
+ */
+class CrDetectionContext {
+public:
+    typedef afw::image::MaskPixel MaskPixel;
+
+    /// Thresholds for condition #3
+    struct Thresholds {
+        double horizontal;
+        double vertical;
+        double diagonal;
+    };
+
+    /**
+     * @param[in] psf   The PSF of the images to be searched
+     * @param[in] mask  A mask with the same mask planes as the images to be searched
+     * @param[in] ps    PropertySet directing the behaviour (see FindCosmicRaysConfig)
+     * @param[in] bbox  Region (in parent coordinates) covered by the grid; ignored if nx == ny == 1
+     * @param[in] nx    Number of grid cells in x
+     * @param[in] ny    Number of grid cells in y
+     *
+     * @throws pex::exceptions::NotFoundError if the PSF is unable to return a kernel
+     * @throws pex::exceptions::InvalidParameterError if nx or ny is less than 1, or if a grid is
+     *         requested with an empty bbox
+     */
+    CrDetectionContext(afw::detection::Psf const& psf, afw::image::Mask<MaskPixel> const& mask,
+                       daf::base::PropertySet const& ps, lsst::geom::Box2I const& bbox = lsst::geom::Box2I(),
+                       int nx = 1, int ny = 1);
+
+    /// Return the thresholds for condition #3 at a position (in parent coordinates)
+    Thresholds getThresholds(double x, double y) const;
+
+    /// Return the thresholds for condition #3 at each grid cell centre, in row-major order
+    std::vector<Thresholds> const& getGridThresholds() const { return _thresholds; }
+
+    lsst::geom::Box2I const& getBBox() const { return _bbox; }
+    int getNx() const { return _nx; }
+    int getNy() const { return _ny; }
+
+    double getMinSigma() const { return _minSigma; }
+    double getMinDn() const { return _minDn; }
+    double getCond3Fac() const { return _cond3Fac; }
+    double getCond3Fac2() const { return _cond3Fac2; }
+    int getNIteration() const { return _niteration; }
+    int getNCrPixelMax() const { return _nCrPixelMax; }
+    int getNThreads() const { return _nThreads; }
+
+    MaskPixel getBadBit() const { return _badBit; }
+    MaskPixel getCrBit() const { return _crBit; }
+    MaskPixel getInterpBit() const { return _interpBit; }
+    MaskPixel getSaturBit() const { return _saturBit; }
+    MaskPixel getNoDataBit() const { return _nodataBit; }
+
+    /// Pixels with any of these bits set can't be CRs (BAD | INTRP | SAT | NO_DATA)
+    MaskPixel getBadMask() const { return _badBit | _interpBit | _saturBit | _nodataBit; }
+
+private:
+    double _minSigma;      // min sigma over sky in pixel for CR candidate
+    double _minDn;         // min number of DN in an CRs
+    double _cond3Fac;      // fiddle factor for condition #3
+    double _cond3Fac2;     // 2nd fiddle factor for condition #3
+    int _niteration;       // Number of times to look for contaminated pixels near CRs
+    int _nCrPixelMax;      // maximum number of contaminated pixels
+    int _nThreads;         // threads used for the first pass
+    MaskPixel _badBit;     // Generic bad pixels
+    MaskPixel _crBit;      // CR-contaminated pixels
+    MaskPixel _interpBit;  // Interpolated pixels
+    MaskPixel _saturBit;   // Saturated pixels
+    MaskPixel _nodataBit;  // Non data pixels
+    lsst::geom::Box2I _bbox;
+    int _nx, _ny;
+    std::vector<Thresholds> _thresholds;  // at the cell centres, row-major
+};
+
 template <typename MaskedImageT>
 std::vector<std::shared_ptr<afw::detection::Footprint> > findCosmicRays(MaskedImageT& image,
                                                                         afw::detection::Psf const& psf,
                                                                         double const bkgd,
                                                                         daf::base::PropertySet const& ps,
                                                                         bool const keep = false);
+
+/**
+ * @brief Find cosmic rays in an image, using a context built for the image's exposure
+ *
+ * This is equivalent to the version taking a Psf and a PropertySet, with the thresholds for condition #3
+ * interpolated from the context's grid.
+ *
+ * If metadata is provided, the wall-clock time (s) spent finding candidate pixels, merging them into
+ * CRs, filtering, removing, growing and finishing the CRs is written to it as crFindTime, crMergeTime,
+ * crFilterTime, crRemoveTime, crGrowTime and crFinishTime, along with crPixelCount and crCount.
+ */
+template <typename MaskedImageT>
+std::vector<std::shared_ptr<afw::detection::Footprint> > findCosmicRays(
+        MaskedImageT& image, CrDetectionContext const& context, double const bkgd, bool const keep = false,
+        daf::base::PropertySet* metadata = nullptr);
 }
 }  // namespace meas
 }  // namespace lsst
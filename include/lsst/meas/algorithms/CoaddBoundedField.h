@@ -24,10 +24,14 @@
 #ifndef LSST_MEAS_ALGORITHMS_CoaddBoundedField_h_INCLUDED
 #define LSST_MEAS_ALGORITHMS_CoaddBoundedField_h_INCLUDED
 
+#include <memory>
+#include <vector>
+
 #include "lsst/geom/Box.h"
 #include "lsst/afw/math/BoundedField.h"
 #include "lsst/afw/geom/SkyWcs.h"
 #include "lsst/afw/geom/polygon/Polygon.h"
+#include "lsst/meas/algorithms/CoaddInputIndex.h"
 
 namespace lsst {
 namespace meas {
@@ -68,9 +72,41 @@ public:
     explicit CoaddBoundedField(geom::Box2I const& bbox, PTR(afw::geom::SkyWcs const) coaddWcs,
                                ElementVector const& elements, double default_);
 
+    using afw::math::BoundedField::evaluate;
+
     /// @copydoc afw::math::BoundedField::evaluate
     double evaluate(geom::Point2D const& position) const override;
 
+    /**
+     *  @brief Evaluate the field at many points at once.
+     *
+     *  The sky coordinates of all the points are computed in one call, and each element's sky-to-pixel
+     *  transform and field are evaluated once for all the points it may contain; elements whose
+     *  footprint does not overlap the points are skipped.
+     */
+    ndarray::Array<double, 1, 1> evaluate(ndarray::Array<double const, 1> const& x,
+                                          ndarray::Array<double const, 1> const& y) const override;
+
+    /**
+     *  @brief Assign the field's values to an image.
+     *
+     *  Equivalent to afw::math::BoundedField::fillImage, but evaluates blocks of rows together; see
+     *  the array overload of evaluate.  Interpolated evaluation (xStep or yStep > 1) is delegated to
+     *  the base class.
+     */
+    template <typename T>
+    void fillImage(afw::image::Image<T>& image, bool overlapOnly = false, int xStep = 1,
+                   int yStep = 1) const;
+
+    /**
+     *  @brief Add the field's values (times scaleBy) to an image.
+     *
+     *  Equivalent to afw::math::BoundedField::addToImage; see fillImage.
+     */
+    template <typename T>
+    void addToImage(afw::image::Image<T>& image, double scaleBy = 1.0, bool overlapOnly = false,
+                    int xStep = 1, int yStep = 1) const;
+
     /// Get the coaddWcs
     std::shared_ptr<afw::geom::SkyWcs const> getCoaddWcs() const { return _coaddWcs; };
 
@@ -80,6 +116,31 @@ public:
     /// Get the elements vector
     ElementVector getElements() const { return _elements; };
 
+    /**
+     *  @brief Return a copy that evaluates through approximate coadd-to-element pixel mappings.
+     *
+     *  For each element, the mapping from coadd pixels to element pixels (through the sky) is
+     *  tabulated on a regular grid over the element's coadd-frame footprint and interpolated
+     *  bilinearly; the grid is refined until the interpolation error, measured halfway between grid
+     *  points, is below maxError.  Evaluation then needs no Wcs transforms for that element.  Elements
+     *  whose mapping cannot be approximated this well on a grid of at most 128x128 cells are
+     *  evaluated exactly.
+     *
+     *  The approximation affects only evaluation; it is not persisted and does not participate in
+     *  equality comparisons.
+     *
+     *  @param[in] maxError   Maximum position error (element pixels); must be positive.
+     *
+     *  @throws InvalidParameterError if maxError is not positive.
+     */
+    PTR(CoaddBoundedField) approximated(double maxError) const;
+
+    /// Return the maximum position error of the approximation (0 if evaluation is exact).
+    double getApproximationMaxError() const { return _approximationMaxError; }
+
+    /// Return the number of elements that are evaluated through an approximate mapping.
+    std::size_t getApproximatedElementCount() const;
+
     /**
      *  @brief Return true if the CoaddBoundedField persistable (always true).
      */
@@ -104,10 +165,29 @@ protected:
     void write(OutputArchiveHandle& handle) const override;
 
 private:
+    friend class CoaddBoundedFieldSetMember;  // persists itself as a CoaddBoundedField
+
+    class ElementApproximation;
+
+    // Return the approximate mapping for element i, or nullptr if it is evaluated exactly.
+    ElementApproximation const* _getApproximation(std::size_t i) const {
+        return _approximations.empty() ? nullptr : _approximations[i].get();
+    }
+
+    // Evaluate at each position, using the batched transforms.
+    ndarray::Array<double, 1, 1> _evaluate(std::vector<geom::Point2D> const& positions) const;
+
+    // Apply functor(pixel, value) to the pixels of image in region (see fillImage).
+    template <typename T, typename F>
+    void _applyToImage(afw::image::Image<T>& image, bool overlapOnly, F functor) const;
+
     bool _throwOnMissing;  // instead of using _default, raise an exception
     double _default;       // when none of the elements contribute at a point, return this value
     PTR(afw::geom::SkyWcs const) _coaddWcs;  // coordinate system this field is defined in
     ElementVector _elements;                 // vector of constituent fields being coadded
+    std::shared_ptr<CoaddInputIndex const> _index;  // coadd-frame footprints of the elements
+    double _approximationMaxError;                  // 0 if evaluation is exact
+    std::vector<std::shared_ptr<ElementApproximation const>> _approximations;  // empty, or one per element
 
     std::string toString() const override {
         std::ostringstream os;
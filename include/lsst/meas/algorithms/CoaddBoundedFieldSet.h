@@ -0,0 +1,255 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_ALGORITHMS_CoaddBoundedFieldSet_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_CoaddBoundedFieldSet_h_INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ndarray.h"
+#include "lsst/geom/Box.h"
+#include "lsst/afw/math/BoundedField.h"
+#include "lsst/afw/geom/SkyWcs.h"
+#include "lsst/afw/geom/polygon/Polygon.h"
+#include "lsst/afw/table/io/Persistable.h"
+#include "lsst/meas/algorithms/CoaddBoundedField.h"
+#include "lsst/meas/algorithms/CoaddInputIndex.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+/// Struct used to hold one Exposure's data in a CoaddBoundedFieldSet
+struct CoaddBoundedFieldSetElement {
+    CoaddBoundedFieldSetElement(std::vector<PTR(afw::math::BoundedField)> const& fields_,
+                                PTR(afw::geom::SkyWcs const) wcs_,
+                                PTR(afw::geom::polygon::Polygon const) validPolygon_, double weight_ = 1.0)
+            : fields(fields_), wcs(wcs_), validPolygon(validPolygon_), weight(weight_) {}
+
+    std::vector<PTR(afw::math::BoundedField)> fields;  // one per field name; null if the field is missing
+    PTR(afw::geom::SkyWcs const) wcs;
+    PTR(afw::geom::polygon::Polygon const) validPolygon;
+    double weight;
+};
+
+/**
+ *  @brief Several CoaddBoundedFields over the same inputs, sharing their geometry.
+ *
+ *  Each input (e.g. a visit/ccd of a coadd) has one Wcs, validPolygon and weight, and a BoundedField
+ *  for each of the named fields (e.g. the aperture corrections of an ApCorrMap).  Each field is the
+ *  weighted average of the inputs' fields, exactly as for a CoaddBoundedField built from the inputs
+ *  that have that field; but the sky round trip and validPolygon test of each input are done once
+ *  for all the fields, and the Wcss and validPolygons are persisted once.
+ *
+ *  Use getField to obtain one of the fields as a BoundedField (e.g. to put in an ApCorrMap).  The set
+ *  must be held by a shared_ptr.  Those fields are persisted as plain CoaddBoundedFields; the set itself
+ *  is only persisted (as a CoaddBoundedFieldSet) if it is written directly.
+ */
+class CoaddBoundedFieldSet : public afw::table::io::PersistableFacade<CoaddBoundedFieldSet>,
+                             public afw::table::io::Persistable,
+                             public std::enable_shared_from_this<CoaddBoundedFieldSet> {
+public:
+    typedef CoaddBoundedFieldSetElement Element;
+    typedef std::vector<Element> ElementVector;
+
+    /// Maximum length of a field name.
+    static std::size_t const MAX_NAME_LENGTH = 64;
+
+    /**
+     *  @param[in] bbox        Bounding box of the coadd.
+     *  @param[in] coaddWcs    Wcs of the coadd.
+     *  @param[in] names       Name of each field.
+     *  @param[in] elements    The inputs; the fields of each must be in the same order as names.
+     *
+     *  Evaluating a field at a point where none of the inputs have it raises DomainError.
+     *
+     *  @throws LengthError if an element doesn't have one field per name, or a name is too long.
+     *  @throws InvalidParameterError if an element has no Wcs.
+     */
+    CoaddBoundedFieldSet(geom::Box2I const& bbox, PTR(afw::geom::SkyWcs const) coaddWcs,
+                         std::vector<std::string> const& names, ElementVector const& elements);
+
+    /// As above, but return default_ where none of the inputs have a field.
+    CoaddBoundedFieldSet(geom::Box2I const& bbox, PTR(afw::geom::SkyWcs const) coaddWcs,
+                         std::vector<std::string> const& names, ElementVector const& elements,
+                         double default_);
+
+    /// Evaluate all the fields at a point, returning one value per field.
+    ndarray::Array<double, 1, 1> evaluate(geom::Point2D const& position) const;
+
+    /**
+     *  @brief Evaluate all the fields at many points at once.
+     *
+     *  @returns an array of shape (getFieldCount(), x.size()).
+     */
+    ndarray::Array<double, 2, 2> evaluate(ndarray::Array<double const, 1> const& x,
+                                          ndarray::Array<double const, 1> const& y) const;
+
+    /// Evaluate field i at a point.
+    double evaluate(std::size_t i, geom::Point2D const& position) const;
+
+    /// Evaluate field i at many points at once.
+    ndarray::Array<double, 1, 1> evaluate(std::size_t i, ndarray::Array<double const, 1> const& x,
+                                          ndarray::Array<double const, 1> const& y) const;
+
+    /// Return the field with the given name as a BoundedField that evaluates through this set.
+    PTR(afw::math::BoundedField) getField(std::string const& name) const;
+
+    /// Return field i as a standalone CoaddBoundedField over the elements that have it.
+    PTR(CoaddBoundedField) makeCoaddBoundedField(std::size_t i) const;
+
+    /// Return the index of the field with the given name; throws NotFoundError if there is none.
+    std::size_t getFieldIndex(std::string const& name) const;
+
+    /// Return the number of fields.
+    std::size_t getFieldCount() const { return _names.size(); }
+
+    /// Return the names of the fields.
+    std::vector<std::string> const& getNames() const { return _names; }
+
+    /// Get the bounding box of the coadd
+    geom::Box2I getBBox() const { return _bbox; }
+
+    /// Get the coaddWcs
+    std::shared_ptr<afw::geom::SkyWcs const> getCoaddWcs() const { return _coaddWcs; }
+
+    /// Get the default value
+    double getDefault() const { return _default; }
+
+    /// Get the elements vector
+    ElementVector getElements() const { return _elements; }
+
+    /// Return the number of elements.
+    std::size_t getElementCount() const { return _elements.size(); }
+
+    /// Sets are equal if their bounding boxes, coadd Wcss, defaults, names and elements are equal.
+    bool operator==(CoaddBoundedFieldSet const& rhs) const;
+
+    /// @copydoc operator==
+    bool operator!=(CoaddBoundedFieldSet const& rhs) const { return !(*this == rhs); }
+
+    /// Return true if the CoaddBoundedFieldSet is persistable (always true).
+    bool isPersistable() const noexcept override { return true; }
+
+    // Factory used to read CoaddBoundedFieldSet from an InputArchive; defined only in the source file.
+    class Factory;
+
+protected:
+    // See afw::table::io::Persistable::getPersistenceName
+    std::string getPersistenceName() const override;
+
+    // See afw::table::io::Persistable::getPythonModule
+    std::string getPythonModule() const override;
+
+    // See afw::table::io::Persistable::write
+    void write(OutputArchiveHandle& handle) const override;
+
+private:
+    // Evaluate fields [fieldBegin, fieldEnd) at each position: result[f - fieldBegin][k].
+    ndarray::Array<double, 2, 2> _evaluate(std::vector<geom::Point2D> const& positions,
+                                           std::size_t fieldBegin, std::size_t fieldEnd) const;
+
+    geom::Box2I _bbox;
+    bool _throwOnMissing;  // instead of using _default, raise an exception
+    double _default;       // when none of the elements contribute to a field at a point, return this value
+    PTR(afw::geom::SkyWcs const) _coaddWcs;  // coordinate system the fields are defined in
+    std::vector<std::string> _names;
+    ElementVector _elements;
+    std::shared_ptr<CoaddInputIndex const> _index;  // coadd-frame footprints of the elements
+};
+
+/**
+ *  @brief One field of a CoaddBoundedFieldSet, as a BoundedField.
+ *
+ *  It is persisted as the equivalent CoaddBoundedField (see makeCoaddBoundedField), so the files can
+ *  be read by code that doesn't know about sets.  The archive saves each Wcs and
+ *  validPolygon once, however many fields of the set are written.
+ */
+class CoaddBoundedFieldSetMember : public afw::table::io::PersistableFacade<CoaddBoundedFieldSetMember>,
+                                   public afw::math::BoundedField {
+public:
+    /**
+     *  @param[in] set     The set the field belongs to.
+     *  @param[in] index   Index of the field within the set.
+     *
+     *  @throws LengthError if index is out of range.
+     */
+    CoaddBoundedFieldSetMember(std::shared_ptr<CoaddBoundedFieldSet const> set, std::size_t index);
+
+    using afw::math::BoundedField::evaluate;
+
+    /// @copydoc afw::math::BoundedField::evaluate
+    double evaluate(geom::Point2D const& position) const override;
+
+    ndarray::Array<double, 1, 1> evaluate(ndarray::Array<double const, 1> const& x,
+                                          ndarray::Array<double const, 1> const& y) const override;
+
+    /// Return the set the field belongs to.
+    std::shared_ptr<CoaddBoundedFieldSet const> getSet() const { return _set; }
+
+    /// Return the index of the field within its set.
+    std::size_t getIndex() const { return _index; }
+
+    /// Return the name of the field.
+    std::string const& getName() const { return _set->getNames()[_index]; }
+
+    /// Return true if the CoaddBoundedFieldSetMember is persistable (always true).
+    bool isPersistable() const noexcept override { return true; }
+
+    PTR(afw::math::BoundedField) operator*(double const scale) const override;
+
+    /// Members are equal if they are the same field of the same set.
+    bool operator==(BoundedField const& rhs) const override;
+
+protected:
+    // See afw::table::io::Persistable::getPersistenceName
+    std::string getPersistenceName() const override;
+
+    // See afw::table::io::Persistable::getPythonModule
+    std::string getPythonModule() const override;
+
+    // See afw::table::io::Persistable::write
+    void write(OutputArchiveHandle& handle) const override;
+
+private:
+    std::shared_ptr<CoaddBoundedFieldSet const> _set;
+    std::size_t _index;
+
+    std::string toString() const override {
+        std::ostringstream os;
+        os << "CoaddBoundedFieldSetMember " << getName() << " of a set with " << _set->getElementCount()
+           << " elements";
+        return os.str();
+    }
+};
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_ALGORITHMS_CoaddBoundedFieldSet_h_INCLUDED
@@ -0,0 +1,129 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_ALGORITHMS_CoaddInputIndex_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_CoaddInputIndex_h_INCLUDED
+
+#include <cstddef>
+#include <vector>
+
+#include "lsst/geom/Box.h"
+#include "lsst/geom/Point.h"
+#include "lsst/afw/geom/SkyWcs.h"
+#include "lsst/afw/table/Exposure.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+/**
+ *  @brief A uniform grid over the footprints of a coadd's inputs, in coadd pixel coordinates.
+ *
+ *  Each input is represented by a conservative bounding box in the coadd pixel frame; the index
+ *  only answers the question "which inputs might contain this point?".  Callers are expected to
+ *  apply their own exact test (sky round trip, bbox and validPolygon) to the candidates, so the
+ *  index never changes which inputs contribute, only how many of them have to be tested.
+ *
+ *  Candidate lists are always sorted by input index, so iterating over them visits inputs in the
+ *  same order as the original catalog.
+ */
+class CoaddInputIndex {
+public:
+    /**
+     *  @brief Construct from the coadd-frame bounding boxes of each input.
+     *
+     *  @param[in] boxes   Bounding box of each input in coadd pixel coordinates.  Empty (or
+     *                     non-finite) boxes mark inputs whose footprint could not be determined;
+     *                     these are returned as candidates for every point.
+     */
+    explicit CoaddInputIndex(std::vector<geom::Box2D> const& boxes);
+
+    /**
+     *  @brief Construct from an ExposureCatalog of coadd inputs.
+     *
+     *  @param[in] catalog    Catalog of inputs; each record must have a Wcs and a bbox.
+     *  @param[in] coaddWcs   Wcs of the coadd.
+     */
+    CoaddInputIndex(afw::table::ExposureCatalog const& catalog, afw::geom::SkyWcs const& coaddWcs);
+
+    CoaddInputIndex(CoaddInputIndex const&) = default;
+    CoaddInputIndex(CoaddInputIndex&&) = default;
+    CoaddInputIndex& operator=(CoaddInputIndex const&) = default;
+    CoaddInputIndex& operator=(CoaddInputIndex&&) = default;
+    ~CoaddInputIndex() = default;
+
+    /**
+     *  @brief Compute a conservative bounding box of an input's bbox in coadd pixel coordinates.
+     *
+     *  The boundary of the input is sampled and mapped through the sky; the result is padded to
+     *  allow for curvature between samples.  Returns an empty box if the transform fails.
+     */
+    static geom::Box2D computeCoaddBBox(geom::Box2D const& bbox, afw::geom::SkyWcs const& inputWcs,
+                                        afw::geom::SkyWcs const& coaddWcs);
+
+    /// Return the (sorted) indices of the inputs that may contain the given coadd pixel position.
+    std::vector<std::size_t> const& getCandidates(geom::Point2D const& position) const;
+
+    /// Return the (sorted) indices of the inputs whose coadd-frame bbox may overlap the given box.
+    std::vector<std::size_t> getOverlapping(geom::Box2D const& box) const;
+
+    /// Return the coadd-frame bounding box of input i (empty if it could not be determined).
+    geom::Box2D const& getInputBBox(std::size_t i) const { return _boxes[i]; }
+
+    /// Return the number of inputs that were indexed.
+    std::size_t getInputCount() const { return _boxes.size(); }
+
+    /// Return the number of grid cells in the index.
+    std::size_t getCellCount() const { return _cells.size(); }
+
+    /// Return the total number of (cell, input) entries stored in the index.
+    std::size_t getEntryCount() const;
+
+    /// Return the approximate memory used by the index, in bytes.
+    std::size_t getMemorySize() const;
+
+    /// Return the wall-clock time (in seconds) spent building the index.
+    double getBuildTime() const { return _buildTime; }
+
+    /// Return the region covered by the grid, in coadd pixel coordinates.
+    geom::Box2D const& getBBox() const { return _bbox; }
+
+private:
+    void _build();
+
+    std::vector<geom::Box2D> _boxes;               // coadd-frame bbox of each input
+    std::vector<std::size_t> _unbounded;           // inputs that are candidates everywhere
+    std::vector<std::vector<std::size_t>> _cells;  // candidates per cell, row-major, sorted
+    geom::Box2D _bbox;                             // region covered by the grid
+    int _nx;                                       // number of cells in x
+    int _ny;                                       // number of cells in y
+    double _cellWidth;
+    double _cellHeight;
+    double _buildTime;
+};
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_ALGORITHMS_CoaddInputIndex_h_INCLUDED
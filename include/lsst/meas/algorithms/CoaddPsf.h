@@ -25,10 +25,15 @@
 #define LSST_MEAS_ALGORITHMS_COADDPSF_H
 
 #include <memory>
+#include <vector>
 #include "lsst/base.h"
 #include "lsst/pex/config.h"
 #include "lsst/meas/algorithms/ImagePsf.h"
+#include "lsst/meas/algorithms/CoaddInputIndex.h"
+#include "lsst/meas/algorithms/LanczosStampWarper.h"
+#include "lsst/meas/algorithms/PsfImageCache.h"
 #include "lsst/geom/Box.h"
+#include "lsst/geom/SpherePoint.h"
 #include "lsst/afw/geom/SkyWcs.h"
 #include "lsst/afw/geom/polygon/Polygon.h"
 #include "lsst/afw/table/Exposure.h"
@@ -39,14 +44,42 @@ namespace lsst {
 namespace meas {
 namespace algorithms {
 
+class WarpedPsf;
+
+/**
+ *  @brief Options for CoaddPsf.
+ *
+ *  Only warpingKernelName and cacheSize are saved when a CoaddPsf is persisted.  The other options
+ *  (threading, the image cache and the stamp warper) are choices made by the code that evaluates the
+ *  Psf rather than properties of the Psf, so CoaddPsfs read from archives use their default values;
+ *  use CoaddPsf::withControl to change them.
+ */
 class CoaddPsfControl {
 public:
     LSST_CONTROL_FIELD(warpingKernelName, std::string,
                        "Name of warping kernel; choices: lanczos3,lanczos4,lanczos5,bilinear,nearest");
     LSST_CONTROL_FIELD(cacheSize, int, "Warping kernel cache size");
+    LSST_CONTROL_FIELD(nThreads, int,
+                       "Number of threads used to warp the input Psfs that contribute at a point; "
+                       "values <= 1 warp serially.  Results do not depend on the number of threads.");
+    LSST_CONTROL_FIELD(imageCacheTolerance, double,
+                       "Grid spacing (pixels) of the position-quantized kernel image cache; positions in "
+                       "the same grid cell with the same contributing inputs share one image, evaluated "
+                       "at the cell center.  Values <= 0 disable the cache.");
+    LSST_CONTROL_FIELD(imageCacheSizeMB, int, "Maximum memory (MiB) used by the kernel image cache");
+    LSST_CONTROL_FIELD(useStampWarper, bool,
+                       "Warp input Psf images with LanczosStampWarper, which is specialized for small "
+                       "images, instead of afw::math::warpImage; requires a lanczos warping kernel.");
 
-    explicit CoaddPsfControl(std::string _warpingKernelName = "lanczos3", int _cacheSize = 10000)
-            : warpingKernelName(_warpingKernelName), cacheSize(_cacheSize) {}
+    explicit CoaddPsfControl(std::string _warpingKernelName = "lanczos3", int _cacheSize = 10000,
+                             int _nThreads = 1, double _imageCacheTolerance = 0.0,
+                             int _imageCacheSizeMB = 64, bool _useStampWarper = false)
+            : warpingKernelName(_warpingKernelName),
+              cacheSize(_cacheSize),
+              nThreads(_nThreads),
+              imageCacheTolerance(_imageCacheTolerance),
+              imageCacheSizeMB(_imageCacheSizeMB),
+              useStampWarper(_useStampWarper) {}
 };
 
 /**
@@ -74,7 +107,8 @@ public:
      */
     explicit CoaddPsf(afw::table::ExposureCatalog const& catalog, afw::geom::SkyWcs const& coaddWcs,
                       std::string const& weightFieldName = "weight",
-                      std::string const& warpingKernelName = "lanczos3", int cacheSize = 10000);
+                      std::string const& warpingKernelName = "lanczos3", int cacheSize = 10000)
+            : CoaddPsf(catalog, coaddWcs, CoaddPsfControl(warpingKernelName, cacheSize), weightFieldName) {}
 
     /**
      * @brief Constructor for CoaddPsf
@@ -91,8 +125,7 @@ public:
      *                              defaults to "weight".
      */
     CoaddPsf(afw::table::ExposureCatalog const& catalog, afw::geom::SkyWcs const& coaddWcs,
-             CoaddPsfControl const& ctrl, std::string const& weightFieldName = "weight")
-            : CoaddPsf(catalog, coaddWcs, weightFieldName, ctrl.warpingKernelName, ctrl.cacheSize) {}
+             CoaddPsfControl const& ctrl, std::string const& weightFieldName = "weight");
 
     /// Polymorphic deep copy.  Usually unnecessary, as Psfs are immutable.
     PTR(afw::detection::Psf) clone() const override;
@@ -167,6 +200,65 @@ public:
      */
     CONST_PTR(afw::geom::polygon::Polygon) getValidPolygon(int index);
 
+    /**
+     *  @brief Return the spatial index used to find the inputs that contribute at a point.
+     *
+     *  The index is built once, when the CoaddPsf is constructed or read from an archive;
+     *  its build time and size are available from its accessors.
+     */
+    CoaddInputIndex const& getInputIndex() const { return *_inputIndex; }
+
+    /// Return the position-quantized kernel image cache, or nullptr if it is disabled.
+    std::shared_ptr<PsfImageCache const> getImageCache() const { return _imageCache; }
+
+    /// Return the options used by this CoaddPsf.
+    CoaddPsfControl getControl() const;
+
+    /**
+     *  @brief Return a copy of this CoaddPsf that uses different options.
+     *
+     *  This is how the options that are not persisted (see CoaddPsfControl) are set for a CoaddPsf
+     *  read from an archive, e.g. psf->withControl(ctrl) where ctrl is psf->getControl() with nThreads
+     *  changed.  The copy shares its inputs (and the archive, if this was read lazily) with this
+     *  CoaddPsf, but none of its caches.
+     */
+    std::shared_ptr<CoaddPsf> withControl(CoaddPsfControl const& ctrl) const;
+
+    /**
+     *  @brief Return the number of component Psfs that have been read so far.
+     *
+     *  This is always getComponentCount() unless the CoaddPsf was read lazily (see LazyReadingScope).
+     */
+    int getLoadedComponentCount() const;
+
+    /**
+     *  @brief While an instance exists, CoaddPsfs read from archives by the thread that created it
+     *         defer reading their inputs' Psfs.
+     *
+     *  Each input's Psf is then only read from the archive the first time it's needed, so evaluating
+     *  the CoaddPsf in one region only reads the Psfs of the inputs that overlap it.  The inputs'
+     *  Wcss and validPolygons are still read up front, to build the spatial index.  The archive is
+     *  kept alive by the CoaddPsf until it is destroyed.  Reads on other threads are not affected,
+     *  and scopes may be nested.
+     */
+    class LazyReadingScope {
+    public:
+        explicit LazyReadingScope(bool lazy = true);
+
+        LazyReadingScope(LazyReadingScope const&) = delete;
+        LazyReadingScope(LazyReadingScope&&) = delete;
+        LazyReadingScope& operator=(LazyReadingScope const&) = delete;
+        LazyReadingScope& operator=(LazyReadingScope&&) = delete;
+
+        ~LazyReadingScope();
+
+    private:
+        bool _previous;
+    };
+
+    /// Return whether CoaddPsfs read by this thread are read lazily; see LazyReadingScope.
+    static bool getLazyReading();
+
     /**
      *  @brief Return true if the CoaddPsf persistable (always true).
      *
@@ -185,6 +277,10 @@ protected:
     PTR(afw::detection::Psf::Image)
     doComputeKernelImage(geom::Point2D const& ccdXY, afw::image::Color const& color) const override;
 
+    /// Batch evaluation that warps each contributing input once for all the positions it covers.
+    std::vector<PTR(afw::detection::Psf::Image)> doComputeKernelImages(
+            std::vector<geom::Point2D> const& positions, afw::image::Color const& color) const override;
+
     geom::Box2I doComputeBBox(geom::Point2D const& position, afw::image::Color const& color) const override;
 
     // See afw::table::io::Persistable::getPersistenceName
@@ -197,20 +293,70 @@ protected:
     void write(OutputArchiveHandle& handle) const override;
 
     // Used by persistence only
-    explicit CoaddPsf(afw::table::ExposureCatalog const& catalog,         ///< Unpersisted catalog
-                      afw::geom::SkyWcs const& coaddWcs,                  ///< WCS for the coadd
-                      geom::Point2D const& averagePosition,               ///< Default position for accessors
-                      std::string const& warpingKernelName = "lanczos3",  ///< Warping kernel name
-                      int cacheSize = 10000                               ///< Kernel cache size
+    explicit CoaddPsf(afw::table::ExposureCatalog const& catalog,      ///< Unpersisted catalog
+                      afw::geom::SkyWcs const& coaddWcs,               ///< WCS for the coadd
+                      geom::Point2D const& averagePosition,            ///< Default position for accessors
+                      CoaddPsfControl const& ctrl = CoaddPsfControl()  ///< Warping/execution options
     );
 
 private:
+    // Lazily-populated per-input WarpedPsfs; defined only in the source file.
+    class WarpedPsfCache;
+
+    // Persistent threads used by _warpInParallel; defined only in the source file.
+    class WorkerPool;
+
+    // Archive IDs of the inputs' components, for CoaddPsfs read lazily; defined only in the source file.
+    class LazyInputs;
+
+    // Used by lazy persistence only; the catalog's records have no Psfs yet.
+    CoaddPsf(afw::table::ExposureCatalog const& catalog, afw::geom::SkyWcs const& coaddWcs,
+             geom::Point2D const& averagePosition, CoaddPsfControl const& ctrl,
+             std::shared_ptr<LazyInputs> lazyInputs);
+
+    // Set the members that depend on the options, giving the CoaddPsf new (empty) caches.
+    void _setControl(CoaddPsfControl const& ctrl);
+
+    // Return the record for input i, first reading its Psf if needPsf and the CoaddPsf was read lazily.
+    afw::table::ExposureRecord const& _getRecord(std::size_t i, bool needPsf = true) const;
+
+    // Return the (cached) WarpedPsf that maps input i into the coadd frame.  It shares _warpingControl,
+    // whose warping kernel is modified while warping, so images must be computed with warpKernelImage(s)
+    // and a WarpingControl acquired from _warpedPsfCache.
+    std::shared_ptr<WarpedPsf const> _getWarpedPsf(std::size_t i) const;
+
+    // Compute the kernel image at ccdXY from the given (overlapping) inputs, bypassing _imageCache.
+    PTR(afw::detection::Psf::Image) _computeKernelImage(std::vector<std::size_t> const& subcat,
+                                                        geom::Point2D const& ccdXY,
+                                                        afw::image::Color const& color) const;
+
+    // Warp the inputs in subcat concurrently on up to _nThreads threads (this one and _workerPool's),
+    // filling imgVector in the same order as subcat.
+    void _warpInParallel(std::vector<std::size_t> const& subcat, geom::Point2D const& ccdXY,
+                         afw::image::Color const& color,
+                         std::vector<PTR(afw::image::Image<double>)>& imgVector) const;
+
+    // Return the indices of the inputs whose validPolygons contain the given coadd position,
+    // in catalog order; equivalent to _catalog.subsetContaining(ccdXY, _coaddWcs, true).
+    std::vector<std::size_t> _getOverlappingInputs(geom::Point2D const& ccdXY) const;
+
+    // As above, with the sky position of ccdXY already computed.
+    std::vector<std::size_t> _getOverlappingInputs(geom::Point2D const& ccdXY,
+                                                   geom::SpherePoint const& coord) const;
+
     afw::table::ExposureCatalog _catalog;
     afw::geom::SkyWcs _coaddWcs;
     afw::table::Key<double> _weightKey;
     geom::Point2D _averagePosition;
     std::string _warpingKernelName;  // could be removed if we could get this from _warpingControl (#2949)
     CONST_PTR(afw::math::WarpingControl) _warpingControl;
+    int _nThreads;
+    CONST_PTR(LanczosStampWarper) _stampWarper;  // null unless CoaddPsfControl.useStampWarper
+    std::shared_ptr<CoaddInputIndex const> _inputIndex;
+    std::shared_ptr<WarpedPsfCache> _warpedPsfCache;
+    std::shared_ptr<WorkerPool> _workerPool;  // null unless _nThreads > 1; shared by copies
+    std::shared_ptr<PsfImageCache> _imageCache;
+    std::shared_ptr<LazyInputs> _lazyInputs;  // null unless read lazily
 };
 
 }  // namespace algorithms
@@ -24,6 +24,10 @@
 #ifndef LSST_MEAS_ALGORITHMS_CoaddTransmissionCurve_h_INCLUDED
 #define LSST_MEAS_ALGORITHMS_CoaddTransmissionCurve_h_INCLUDED
 
+#include <vector>
+
+#include "ndarray.h"
+#include "lsst/geom/Point.h"
 #include "lsst/afw/geom/SkyWcs.h"
 #include "lsst/afw/image/TransmissionCurve.h"
 #include "lsst/afw/table/Exposure.h"
@@ -53,6 +57,27 @@ namespace algorithms {
 std::shared_ptr<afw::image::TransmissionCurve const> makeCoaddTransmissionCurve(
         std::shared_ptr<afw::geom::SkyWcs const> coaddWcs, afw::table::ExposureCatalog const& inputSensors);
 
+/**
+ *  Sample a TransmissionCurve at many positions in one call.
+ *
+ *  For TransmissionCurves returned by makeCoaddTransmissionCurve, the sky coordinates of all the
+ *  positions are computed together and each input is only visited for the positions it may cover.
+ *  Other TransmissionCurves are sampled one position at a time.
+ *
+ *  @param[in]  curve          TransmissionCurve to sample.
+ *  @param[in]  positions      Positions at which to sample the curve.
+ *  @param[in]  wavelengths    Wavelengths at which to sample the curve (Angstroms).
+ *
+ *  @throws InvalidParameterError   Thrown if a position is not covered by any input of a coadd
+ *                                  TransmissionCurve.
+ *
+ *  @returns an array with shape (positions.size(), wavelengths.size()), whose row k is the
+ *           throughput at positions[k].
+ */
+ndarray::Array<double, 2, 2> sampleTransmissionCurveAt(
+        afw::image::TransmissionCurve const& curve, std::vector<geom::Point2D> const& positions,
+        ndarray::Array<double const, 1, 1> const& wavelengths);
+
 }  // namespace algorithms
 }  // namespace meas
 }  // namespace lsst
@@ -0,0 +1,99 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_ALGORITHMS_DetectionSmoother_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_DetectionSmoother_h_INCLUDED
+
+#include <vector>
+
+#include "lsst/geom/Box.h"
+#include "lsst/afw/image/MaskedImage.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+/**
+ *  @brief Smooth a MaskedImage with a circular Gaussian for source detection.
+ *
+ *  This gives the same result as afw::math::convolve with a normalized SeparableKernel made from a pair
+ *  of 1-d Gaussians (the image is convolved with the kernel, the variance with its square, and each mask
+ *  pixel is the OR of the mask pixels under the kernel), but applies the two 1-d passes a block of rows
+ *  at a time, on several threads if requested, and writes into a caller-provided image so the output
+ *  can be reused between calls.
+ *
+ *  Pixels within width/2 of the image's edge, where the kernel would extend off the image, are set to
+ *  NaN (image), NO_DATA (mask) and infinity (variance), as afw::math::convolve does; getGoodBBox returns
+ *  the rest.
+ */
+template <typename PixelT>
+class DetectionSmoother {
+public:
+    typedef afw::image::MaskedImage<PixelT> MaskedImageT;
+
+    /**
+     *  @param[in] sigma      Width of the Gaussian.
+     *  @param[in] width      Width (and height) of the kernel; must be odd.
+     *  @param[in] nThreads   Number of threads to use, including the calling one.
+     *
+     *  @throws InvalidParameterError if sigma is not positive or width is not a positive odd number.
+     */
+    DetectionSmoother(double sigma, int width, int nThreads = 1);
+
+    /**
+     *  @brief Smooth src into dest.
+     *
+     *  @param[in] src                Image to smooth.
+     *  @param[out] dest              Output image; must have the same dimensions as src and not share
+     *                                its pixels.  Its xy0 is set to that of src.
+     *  @param[in] doSmoothVariance   Whether to smooth the variance plane; if false, dest's variance is
+     *                                set to NaN, which is fine for thresholds that don't use it.
+     *
+     *  @throws LengthError if dest's dimensions differ from src's.
+     *  @throws InvalidParameterError if src is smaller than the kernel.
+     */
+    void smooth(MaskedImageT const& src, MaskedImageT& dest, bool doSmoothVariance = true) const;
+
+    /// Return the part of an image with the given bbox that is not affected by the edge.
+    geom::Box2I getGoodBBox(geom::Box2I const& bbox) const;
+
+    double getSigma() const { return _sigma; }
+    int getWidth() const { return _width; }
+    int getNThreads() const { return _nThreads; }
+
+    /// Return the normalized 1-d kernel.
+    std::vector<double> const& getKernel() const { return _kernel; }
+
+private:
+    double _sigma;
+    int _width;
+    int _nThreads;
+    std::vector<double> _kernel;
+};
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_ALGORITHMS_DetectionSmoother_h_INCLUDED
@@ -24,6 +24,7 @@
 #ifndef LSST_MEAS_ALGORITHMS_DoubleGaussianPsf_h_INCLUDED
 #define LSST_MEAS_ALGORITHMS_DoubleGaussianPsf_h_INCLUDED
 
+#include "lsst/meas/algorithms/GaussianPsfMoments.h"
 #include "lsst/meas/algorithms/KernelPsf.h"
 
 namespace lsst {
@@ -67,10 +68,19 @@ protected:
 
     void write(OutputArchiveHandle& handle) const override;
 
+    // Closed-form aperture flux and shape; these fall back to measuring the kernel image when the
+    // kernel's bbox truncates the Gaussian too much (see GaussianPsfMoments).
+    double doComputeApertureFlux(double radius, geom::Point2D const& position,
+                                 afw::image::Color const& color) const override;
+
+    afw::geom::ellipses::Quadrupole doComputeShape(geom::Point2D const& position,
+                                                   afw::image::Color const& color) const override;
+
 private:
     double _sigma1;
     double _sigma2;
     double _b;
+    GaussianPsfMoments _moments;
 };
 
 }  // namespace algorithms
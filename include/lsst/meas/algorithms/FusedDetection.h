@@ -0,0 +1,189 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_ALGORITHMS_FusedDetection_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_FusedDetection_h_INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "lsst/geom/Box.h"
+#include "lsst/afw/geom/Span.h"
+#include "lsst/afw/image/Mask.h"
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/afw/detection/FootprintSet.h"
+#include "lsst/afw/detection/Threshold.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+/// Positive and negative FootprintSets; either may be null if that polarity was not requested.
+typedef std::pair<std::shared_ptr<afw::detection::FootprintSet>,
+                  std::shared_ptr<afw::detection::FootprintSet>>
+        FootprintSetPair;
+
+/**
+ *  @brief Detect positive and negative Footprints in a single pass over an image.
+ *
+ *  This is equivalent to constructing an afw::detection::FootprintSet for each threshold, but reads the
+ *  image once, collecting the runs of pixels above the positive threshold and below the negative one as
+ *  it goes; the runs are then grouped into 8-connected Footprints with SpanComponents, so all later work
+ *  is proportional to the detected area rather than to the image.
+ *
+ *  Footprints with fewer than minPixels pixels, or with no pixel beyond the threshold times its include
+ *  multiplier, are dropped.  Peaks are the pixels of each Footprint that have no brighter 8-connected
+ *  neighbour in the image (no fainter one, for negative Footprints), most significant first.  The
+ *  DETECTED and DETECTED_NEGATIVE bits of the image's mask are set for the pixels of the Footprints.
+ *
+ *  @param[in] image      Image to threshold, normally the PSF-smoothed image.
+ *  @param[in] positive   Threshold for positive Footprints (polarity true), or null.
+ *  @param[in] negative   Threshold for negative Footprints (polarity false), or null.
+ *  @param[in] minPixels  Minimum number of pixels in a Footprint.
+ *  @param[in] region     Region of the returned FootprintSets and Footprints.
+ *
+ *  @throws InvalidParameterError if a threshold has the wrong polarity or a type other than VALUE or
+ *          PIXEL_STDEV.
+ */
+template <typename PixelT>
+FootprintSetPair thresholdFootprints(afw::image::MaskedImage<PixelT> const& image,
+                                     afw::detection::Threshold const* positive,
+                                     afw::detection::Threshold const* negative, int minPixels,
+                                     geom::Box2I const& region);
+
+/**
+ *  @brief Grow positive and negative Footprints and set their mask bits.
+ *
+ *  With combined growth the result is the same as the afw::detection::FootprintSet growing constructor:
+ *  grown Footprints are clipped to the set's region and those that overlap or touch are merged, keeping
+ *  the Peaks of all their inputs.  Otherwise each Footprint is dilated on its own, as Footprint::dilate
+ *  does.  The grown Footprints set the DETECTED (positive) and DETECTED_NEGATIVE (negative) bits of mask.
+ *
+ *  @param[in] positive         Positive Footprints, or null.
+ *  @param[in] negative         Negative Footprints, or null.
+ *  @param[in,out] mask         Mask in which to set the detection bits.
+ *  @param[in] nGrow            Number of pixels to grow by; no growth if not positive.
+ *  @param[in] isotropic        Grow with a circular (rather than Manhattan) stencil?
+ *  @param[in] combined         Merge the grown Footprints that overlap?
+ *  @param[in] returnOriginal   Return the input sets rather than the grown ones?
+ *
+ *  The input sets and their Footprints are not modified.
+ */
+FootprintSetPair growFootprints(std::shared_ptr<afw::detection::FootprintSet> positive,
+                                std::shared_ptr<afw::detection::FootprintSet> negative,
+                                afw::image::Mask<afw::image::MaskPixel>& mask, int nGrow, bool isotropic,
+                                bool combined, bool returnOriginal = false);
+
+/**
+ *  @brief Threshold, find peaks, grow and set the detection mask bits in one call.
+ *
+ *  Equivalent to thresholdFootprints followed by growFootprints, for callers that don't need to revise
+ *  the Peaks in between.  The grown Footprints set the detection bits of mask, which is usually that of
+ *  the unsmoothed image.
+ */
+template <typename PixelT>
+FootprintSetPair detectFootprints(afw::image::MaskedImage<PixelT> const& image,
+                                  afw::image::Mask<afw::image::MaskPixel>& mask,
+                                  afw::detection::Threshold const* positive,
+                                  afw::detection::Threshold const* negative, int minPixels,
+                                  geom::Box2I const& region, int nGrow, bool isotropic, bool combined,
+                                  bool returnOriginal = false);
+
+/**
+ *  @brief Detect Footprints in an image a tile at a time, joining them across the tile boundaries.
+ *
+ *  Each call to addTile thresholds the pixels of one core region (the tiles' cores should partition the
+ *  image), recording the runs of pixels beyond the threshold, whether each run has a pixel beyond the
+ *  threshold times its include multiplier, and the peaks.  A tile's image should extend at least a pixel
+ *  beyond its core (unless the core is at the edge of the image) so that peaks on the boundary are judged
+ *  against their neighbours in the next tile; if each tile is smoothed with a halo of half the kernel
+ *  width beyond that, the result is the same as that of thresholdFootprints on the whole smoothed image,
+ *  except that the mask of the smoothed image is not set.
+ *
+ *  Only the runs and peaks are kept between tiles, so the memory used is that of the detections plus one
+ *  tile's image.
+ */
+class FootprintStitcher {
+public:
+    /**
+     *  @param[in] region     Region of the FootprintSet to be made (normally the image's bbox).
+     *  @param[in] polarity   Detect positive (true) or negative (false) Footprints?
+     */
+    FootprintStitcher(geom::Box2I const& region, bool polarity);
+
+    FootprintStitcher(FootprintStitcher const&) = default;
+    FootprintStitcher(FootprintStitcher&&) = default;
+    FootprintStitcher& operator=(FootprintStitcher const&) = default;
+    FootprintStitcher& operator=(FootprintStitcher&&) = default;
+    ~FootprintStitcher() = default;
+
+    /**
+     *  @brief Threshold the core of one tile.
+     *
+     *  @param[in] image       Smoothed image of the tile; must contain core.
+     *  @param[in] core        Pixels to threshold; must not overlap those of earlier tiles.
+     *  @param[in] threshold   Threshold to apply (its polarity must match the stitcher's); it may differ
+     *                         between tiles, e.g. if it is set from each tile's noise.
+     *
+     *  @throws InvalidParameterError if core is not contained in image's bbox, or the threshold has the
+     *          wrong polarity or a type other than VALUE or PIXEL_STDEV.
+     */
+    template <typename PixelT>
+    void addTile(afw::image::MaskedImage<PixelT> const& image, geom::Box2I const& core,
+                 afw::detection::Threshold const& threshold);
+
+    /**
+     *  @brief Join the runs of all the tiles into Footprints.
+     *
+     *  Footprints with fewer than minPixels pixels, or with no pixel beyond the threshold times its
+     *  include multiplier, are dropped.  Peaks are sorted most significant first.
+     */
+    std::shared_ptr<afw::detection::FootprintSet> makeFootprintSet(int minPixels) const;
+
+    geom::Box2I getRegion() const { return _region; }
+    bool getPolarity() const { return _polarity; }
+
+    /// Number of runs of pixels recorded so far.
+    std::size_t getSpanCount() const { return _spans.size(); }
+
+private:
+    struct Peak {
+        int x;
+        int y;
+        double value;
+    };
+
+    geom::Box2I _region;
+    bool _polarity;
+    std::vector<afw::geom::Span> _spans;
+    std::vector<bool> _include;  // does each span have a pixel beyond the include threshold?
+    std::vector<Peak> _peaks;
+};
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_ALGORITHMS_FusedDetection_h_INCLUDED
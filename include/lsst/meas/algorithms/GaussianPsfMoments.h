@@ -0,0 +1,93 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_ALGORITHMS_GaussianPsfMoments_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_GaussianPsfMoments_h_INCLUDED
+
+#include <vector>
+
+#include "lsst/geom/Box.h"
+#include "lsst/afw/geom/ellipses/Quadrupole.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+/**
+ *  @brief Closed-form shape and aperture flux of a kernel image made of concentric circular Gaussians.
+ *
+ *  This reproduces what ImagePsf measures on a realization of SingleGaussianPsf or DoubleGaussianPsf
+ *  without making the image: the shape is the fixed point of the adaptive (SdssShape) moments of the
+ *  mixture, and the aperture flux is the integral of the mixture within the aperture, normalized (as
+ *  the realization is) by its integral over the kernel bbox.
+ *
+ *  The closed forms ignore truncation of the Gaussians by the kernel bbox when computing the shape, so
+ *  they are only used when the bbox extends at least MIN_SHAPE_EXTENT sigmas from the center, and the
+ *  aperture flux is only computed for apertures that lie within the bbox.  Mixtures with negative
+ *  amplitudes are never handled analytically.
+ */
+class GaussianPsfMoments {
+public:
+    /// Minimum distance (in units of the largest sigma) from the center to the edge of the bbox for which
+    /// the shape is computed analytically.
+    static double const MIN_SHAPE_EXTENT;
+
+    /**
+     *  @param[in] sigmas   Widths of the Gaussians.
+     *  @param[in] fluxes   Relative (integrated) fluxes of the Gaussians.
+     *  @param[in] bbox     Bounding box of the kernel image, with the Gaussians centered on the origin.
+     *
+     *  @throws LengthError if sigmas and fluxes have different sizes.
+     */
+    GaussianPsfMoments(std::vector<double> const& sigmas, std::vector<double> const& fluxes,
+                       geom::Box2I const& bbox);
+
+    /// Whether computeShape may be used.
+    bool hasShape() const { return _hasShape; }
+
+    /// Return the adaptive moments of the mixture; only valid if hasShape().
+    afw::geom::ellipses::Quadrupole computeShape() const {
+        return afw::geom::ellipses::Quadrupole(_moment, _moment, 0.0);
+    }
+
+    /// Whether computeApertureFlux may be used for an aperture of this radius.
+    bool hasApertureFlux(double radius) const;
+
+    /// Return the fraction of the kernel image's flux within radius; only valid if hasApertureFlux(radius).
+    double computeApertureFlux(double radius) const;
+
+private:
+    std::vector<double> _sigmas;
+    std::vector<double> _fluxes;  // normalized so the mixture integrates to 1 over the bbox
+    double _maxRadius;            // distance from the center to the nearest edge of the bbox
+    bool _positive;
+    bool _hasShape;
+    double _moment;
+};
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_ALGORITHMS_GaussianPsfMoments_h_INCLUDED
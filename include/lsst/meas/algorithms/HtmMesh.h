@@ -0,0 +1,116 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_ALGORITHMS_HtmMesh_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_HtmMesh_h_INCLUDED
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "ndarray.h"
+#include "lsst/geom/Angle.h"
+#include "lsst/geom/SpherePoint.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+/**
+ *  @brief A hierarchical triangular mesh (HTM) used to shard reference catalogs.
+ *
+ *  Trixel IDs follow the SDSS HTM convention also used by esutil.htm: the root trixels S0-S3 and N0-N3
+ *  are numbered 8-15 and the children of trixel i are 4i, ..., 4i+3.  Points are located using the same
+ *  vertex construction, edge tests (with the same 1e-15 tolerance) and child order as esutil, so points
+ *  on or numerically near an edge are assigned to the same trixel, and catalogs ingested with esutil
+ *  remain valid.
+ */
+class HtmMesh {
+public:
+    /// Largest supported depth; IDs then need 3 + 2*depth bits.
+    static int const MAX_DEPTH = 24;
+
+    /**
+     *  @param[in] depth   Number of levels below the root trixels, in the range [0, MAX_DEPTH].
+     *
+     *  @throws InvalidParameterError if depth is out of range.
+     */
+    explicit HtmMesh(int depth);
+
+    HtmMesh(HtmMesh const&) = default;
+    HtmMesh(HtmMesh&&) = default;
+    HtmMesh& operator=(HtmMesh const&) = default;
+    HtmMesh& operator=(HtmMesh&&) = default;
+    ~HtmMesh() = default;
+
+    int getDepth() const { return _depth; }
+
+    /// Return the ID of the trixel containing a position given in degrees.
+    std::int64_t indexPoint(double ra, double dec) const;
+
+    /**
+     *  Return the IDs of the trixels containing many positions given in degrees.
+     *
+     *  @param[in] ra        Right ascensions, in degrees.
+     *  @param[in] dec       Declinations, in degrees; must be the same length as ra.
+     *  @param[in] nThreads  Number of threads to divide the points among.
+     *
+     *  @throws LengthError if ra and dec have different lengths.
+     */
+    ndarray::Array<std::int64_t, 1, 1> indexPoints(ndarray::Array<double const, 1> const& ra,
+                                                   ndarray::Array<double const, 1> const& dec,
+                                                   int nThreads = 1) const;
+
+    /**
+     *  Return the trixels that intersect a circle, in increasing ID order, and for each one whether it
+     *  lies on the circle's boundary (is not wholly inside it).
+     *
+     *  The test is conservative: a trixel that only comes close to the circle may be included (and is
+     *  then flagged as on the boundary), but a trixel not flagged is always wholly inside the circle.
+     */
+    std::pair<std::vector<std::int64_t>, std::vector<bool>> getCircleCover(geom::SpherePoint const& center,
+                                                                           geom::Angle radius) const;
+
+    /**
+     *  Return the trixels that intersect a convex spherical polygon, in increasing ID order, and for
+     *  each one whether it lies on the polygon's boundary; the test is conservative, as for
+     *  getCircleCover.
+     *
+     *  @param[in] vertices   At least 3 vertices, in either winding order, of a polygon smaller than
+     *                        a hemisphere.
+     *
+     *  @throws InvalidParameterError if there are fewer than 3 vertices or the polygon is not convex.
+     */
+    std::pair<std::vector<std::int64_t>, std::vector<bool>> getPolygonCover(
+            std::vector<geom::SpherePoint> const& vertices) const;
+
+private:
+    int _depth;
+};
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_ALGORITHMS_HtmMesh_h_INCLUDED
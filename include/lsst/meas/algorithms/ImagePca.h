@@ -31,23 +31,105 @@
  *
  * @ingroup algorithms
  */
+#include <cstddef>
 #include <memory>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "Eigen/Core"
 #include "lsst/afw.h"
 
 namespace lsst {
 namespace meas {
 namespace algorithms {
 
+/**
+ * Inner products of the images analysed by a PsfImagePca, kept between analyses.
+ *
+ * Images are identified between analyses by a key (their PSF candidate, say, as the images themselves
+ * may be copies made afresh for each analysis).  Only the inner products involving images that are new,
+ * or whose pixels have changed (e.g. by ImagePca::updateBadPixels), are recomputed; images that are no
+ * longer present are forgotten.  Passing
+ * the same cache to the analyses made by successive iterations of the PSF determiner therefore updates
+ * the eigenimages for the candidates that were rejected at the cost of a small eigenproblem, rather than
+ * recomputing all n^2 inner products.  Results don't depend on the cache's contents.
+ */
+template <typename ImageT>
+class ImageInnerProductCache {
+public:
+    ImageInnerProductCache() : _hits(0), _misses(0) {}
+
+    ImageInnerProductCache(ImageInnerProductCache const&) = delete;
+    ImageInnerProductCache(ImageInnerProductCache&&) = delete;
+    ImageInnerProductCache& operator=(ImageInnerProductCache const&) = delete;
+    ImageInnerProductCache& operator=(ImageInnerProductCache&&) = delete;
+    ~ImageInnerProductCache() = default;
+
+    /// Return the matrix of inner products of the images' image planes, updating the cache
+    ///
+    /// keys[i] identifies images[i] between calls; the keys must be distinct.
+    Eigen::MatrixXd const& update(std::vector<std::shared_ptr<ImageT>> const& images,
+                                  std::vector<void const*> const& keys);
+
+    /// Forget all the images
+    void clear();
+
+    /// Number of images whose pixels are cached
+    std::size_t size() const { return _entries.size(); }
+
+    /// Number of inner products reused
+    std::size_t getHits() const { return _hits; }
+
+    /// Number of inner products computed
+    std::size_t getMisses() const { return _misses; }
+
+private:
+    typedef typename afw::image::GetImage<ImageT>::type::Pixel Pixel;
+
+    struct Entry {
+        void const* key;            // the key of the image whose pixels these are
+        std::vector<Pixel> pixels;  // copy of the image plane when its inner products were computed
+    };
+
+    std::vector<Entry> _entries;                       // in the order of the rows of _products
+    std::unordered_map<void const*, int> _index;       // index of each key in _entries
+    Eigen::MatrixXd _products;
+    std::size_t _hits;
+    std::size_t _misses;
+};
+
 template <typename ImageT>
 class PsfImagePca : public afw::image::ImagePca<ImageT> {
     typedef typename afw::image::ImagePca<ImageT> Super;  ///< Base class
 public:
     /// Ctor
     explicit PsfImagePca(bool constantWeight = true, int border = 3)
-            : Super(constantWeight), _border(border) {}
+            : Super(constantWeight),
+              _border(border),
+              _constantWeight(constantWeight),
+              _nComponents(0),
+              _randomized(false),
+              _cache(nullptr) {}
+
+    /// Add an image to the set to be analyzed (as ImagePca::addImage)
+    ///
+    /// The key identifies the image to the inner product cache (default: the image itself).
+    void addImage(std::shared_ptr<ImageT> img, double flux = 0.0, void const* key = nullptr);
+
+    /**
+     * Only compute the first nComponents eigenimages (if positive), rather than as many as
+     * afw::image::ImagePca would
+     *
+     * If randomized, the components are found with a randomized truncated SVD (a few products of a
+     * block of nComponents + nOversample random vectors with the images) rather than a full
+     * eigendecomposition of the images' inner products, so only nComponents eigenvalues are found.
+     * The random vectors are seeded identically every time, so results are reproducible.
+     */
+    void setComponents(int nComponents, bool randomized = false);
+
+    /// Keep the images' inner products in cache between analyses (not owned; may be null)
+    void setInnerProductCache(ImageInnerProductCache<ImageT>* cache) { _cache = cache; }
 
     /// Generate eigenimages that are normalised and background-subtracted
     ///
@@ -55,7 +137,25 @@ public:
     virtual void analyze();
 
 private:
+    typedef std::vector<std::shared_ptr<ImageT>> ImageList;
+
+    // Eigendecomposition of the images' (weighted) inner products
+    void _analyzeFull(ImageList const& images);
+
+    // Randomized truncated SVD of the (weighted) images
+    void _analyzeRandomized(ImageList const& images);
+
+    // Set the eigenimages from the eigenvectors of the inner product matrix (in columns)
+    void _setEigenImages(ImageList const& images, Eigen::MatrixXd const& eigenVectors,
+                         std::vector<std::pair<double, int>> const& sorted, int nComponents);
+
     int const _border;  ///< Border width for background subtraction
+    bool const _constantWeight;
+    std::vector<double> _fluxes;  ///< fluxes of the images, as used by ImagePca
+    std::vector<void const*> _keys;  ///< keys of the images in the inner product cache
+    int _nComponents;
+    bool _randomized;
+    ImageInnerProductCache<ImageT>* _cache;
 };
 
 }  // namespace algorithms
@@ -23,8 +23,14 @@
 #ifndef LSST_MEAS_ALGORITHMS_ImagePsf_h_INCLUDED
 #define LSST_MEAS_ALGORITHMS_ImagePsf_h_INCLUDED
 
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "ndarray.h"
 #include "lsst/geom/Point.h"
 #include "lsst/afw/detection/Psf.h"
+#include "lsst/meas/algorithms/PsfResultCache.h"
 
 namespace lsst {
 namespace meas {
@@ -38,14 +44,70 @@ namespace algorithms {
  *  defined in meas_algorithms, and hence could not be included with the Psf base class in afw.
  */
 class ImagePsf : public afw::table::io::PersistableFacade<ImagePsf>, public afw::detection::Psf {
+public:
+    /**
+     *  @brief Return kernel images for many positions at once.
+     *
+     *  The result is identical to calling computeKernelImage at each position, but derived
+     *  classes may amortize per-call setup (e.g. transform construction) across the batch.
+     *
+     *  @param[in] positions   Positions at which to evaluate the PSF.
+     *  @param[in] color       Color of the source.
+     */
+    std::vector<PTR(Image)> computeKernelImages(std::vector<geom::Point2D> const& positions,
+                                                afw::image::Color const& color = afw::image::Color()) const;
+
+    /**
+     *  @brief Write kernel images for many positions into a caller-provided stack.
+     *
+     *  Each slice out[i] (shape height x width) is interpreted as a kernel image whose bbox is
+     *  centered on the origin, with minimum corner (-(width/2), -(height/2)).  The overlap of
+     *  each kernel image with that bbox is copied in, and the remainder of the slice is zeroed.
+     *
+     *  @param[in] positions   Positions at which to evaluate the PSF.
+     *  @param[out] out        Array with shape (positions.size(), height, width).
+     *  @param[in] color       Color of the source.
+     *
+     *  @throws LengthError if the first dimension of out does not match the number of positions.
+     */
+    void computeKernelImages(std::vector<geom::Point2D> const& positions,
+                             ndarray::Array<double, 3, 3> const& out,
+                             afw::image::Color const& color = afw::image::Color()) const;
+
+    /**
+     *  @brief Cache the shapes and aperture fluxes measured by this Psf, with the kernel images they
+     *         were measured on, for up to capacity positions.
+     *
+     *  A capacity of zero disables the cache.  Copies made by clone share the cache; Psfs made by
+     *  resized do not have one.  Derived classes that compute these quantities without measuring a
+     *  kernel image do not use it.
+     */
+    void setResultCacheCapacity(std::size_t capacity);
+
+    /// Return the shape and aperture flux cache, or nullptr if it is disabled.
+    std::shared_ptr<PsfResultCache const> getResultCache() const { return _resultCache; }
+
 protected:
     explicit ImagePsf(bool isFixed = false) : afw::detection::Psf(isFixed) {}
 
+    /**
+     *  Batch implementation of computeKernelImages.  The default implementation just calls
+     *  computeKernelImage for each position.
+     */
+    virtual std::vector<PTR(Image)> doComputeKernelImages(std::vector<geom::Point2D> const& positions,
+                                                          afw::image::Color const& color) const;
+
     virtual double doComputeApertureFlux(double radius, geom::Point2D const& position,
                                          afw::image::Color const& color) const;
 
     virtual afw::geom::ellipses::Quadrupole doComputeShape(geom::Point2D const& position,
                                                            afw::image::Color const& color) const;
+
+private:
+    // Return the kernel image stored in the result cache at position, or realize a new one.
+    PTR(Image) _getMeasurementImage(geom::Point2D const& position, afw::image::Color const& color) const;
+
+    std::shared_ptr<PsfResultCache> _resultCache;
 };
 
 }  // namespace algorithms
@@ -0,0 +1,137 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_ALGORITHMS_Instrumentation_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_Instrumentation_h_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+/**
+ *  @brief Lightweight timers and counters for the package's hot paths.
+ *
+ *  Instrumented code uses the LSST_MEAS_ALGORITHMS_TIME and LSST_MEAS_ALGORITHMS_COUNT macros.  Nothing
+ *  is recorded until collection is enabled with setEnabled(true); each thread then accumulates into its
+ *  own table, and getTimers and getCounters merge the tables of all threads, including those that have
+ *  since exited.  Defining LSST_MEAS_ALGORITHMS_NO_INSTRUMENTATION when building the package compiles the
+ *  macros away entirely.
+ *
+ *  Names must be string literals; they are compared by value when the tables are merged.
+ */
+class Instrumentation {
+public:
+    /// The accumulated value of a timer or counter.
+    struct Entry {
+        std::uint64_t calls;  ///< number of times the timer ran or the counter was incremented
+        double total;         ///< total wall-clock time (s), or sum of the increments
+    };
+
+    typedef std::map<std::string, Entry> EntryMap;
+
+    Instrumentation() = delete;
+
+    /// Return true unless the package was built with LSST_MEAS_ALGORITHMS_NO_INSTRUMENTATION.
+    static bool isCompiled();
+
+    /// Start (or stop) recording; already-recorded values are kept.
+    static void setEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+
+    static bool isEnabled() { return _enabled.load(std::memory_order_relaxed); }
+
+    /// Return the timers recorded by all threads.
+    static EntryMap getTimers();
+
+    /// Return the counters recorded by all threads.
+    static EntryMap getCounters();
+
+    /// Discard everything recorded so far, by all threads.
+    static void reset();
+
+    /// Add seconds to the calling thread's timer name, counting one call.
+    static void addTime(char const* name, double seconds);
+
+    /// Add value to the calling thread's counter name, counting one increment.
+    static void addCount(char const* name, double value);
+
+    /// Add the time from construction to destruction to a timer, if recording was enabled at construction.
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(char const* name) : _name(isEnabled() ? name : nullptr) {
+            if (_name) {
+                _start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ScopedTimer(ScopedTimer const&) = delete;
+        ScopedTimer(ScopedTimer&&) = delete;
+        ScopedTimer& operator=(ScopedTimer const&) = delete;
+        ScopedTimer& operator=(ScopedTimer&&) = delete;
+
+        ~ScopedTimer() {
+            if (_name) {
+                auto const elapsed = std::chrono::steady_clock::now() - _start;
+                addTime(_name, std::chrono::duration<double>(elapsed).count());
+            }
+        }
+
+    private:
+        char const* _name;
+        std::chrono::steady_clock::time_point _start;
+    };
+
+private:
+    static std::atomic<bool> _enabled;
+};
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
+
+#define LSST_MEAS_ALGORITHMS_CONCAT_IMPL(a, b) a##b
+#define LSST_MEAS_ALGORITHMS_CONCAT(a, b) LSST_MEAS_ALGORITHMS_CONCAT_IMPL(a, b)
+
+#ifndef LSST_MEAS_ALGORITHMS_NO_INSTRUMENTATION
+/// Time the rest of the enclosing scope with the timer name.
+#define LSST_MEAS_ALGORITHMS_TIME(name)                           \
+    ::lsst::meas::algorithms::Instrumentation::ScopedTimer const \
+            LSST_MEAS_ALGORITHMS_CONCAT(instrumentationTimer, __LINE__)(name)
+/// Add value (which is only evaluated if recording is enabled) to the counter name.
+#define LSST_MEAS_ALGORITHMS_COUNT(name, value)                                  \
+    do {                                                                         \
+        if (::lsst::meas::algorithms::Instrumentation::isEnabled()) {            \
+            ::lsst::meas::algorithms::Instrumentation::addCount(name, (value)); \
+        }                                                                        \
+    } while (false)
+#else
+#define LSST_MEAS_ALGORITHMS_TIME(name) static_cast<void>(0)
+#define LSST_MEAS_ALGORITHMS_COUNT(name, value) static_cast<void>(0)
+#endif
+
+#endif  // !LSST_MEAS_ALGORITHMS_Instrumentation_h_INCLUDED
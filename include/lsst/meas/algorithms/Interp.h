@@ -27,6 +27,7 @@
 //!
 // Interpolate over defects in a MaskedImage
 //
+#include <cstddef>
 #include <limits>
 #include <vector>
 
@@ -107,10 +108,127 @@ private:
     unsigned int _type;   //!< Type of defect
 };
 
+/**
+ * @brief The defects of a detector, clipped to an image's bbox and broken into classified runs
+ *
+ * Building the map does all the work of interpolateOverDefects that doesn't depend on the pixel values
+ * (clipping, sorting, merging and classifying the defects), so a map built once for a detector's static
+ * defects may be applied to any number of images with the same bbox.
+ */
+class CompiledDefectMap {
+public:
+    /**
+     * @brief A run of bad pixels within a single row, with its interpolation position and type
+     */
+    class Run {
+    public:
+        Run(int x0 = 0, int x1 = 0, Defect::DefectPosition pos = static_cast<Defect::DefectPosition>(0),
+            unsigned int type = 0)
+                : _x0(x0), _x1(x1), _pos(pos), _type(type) {}
+
+        void classify(Defect::DefectPosition pos, unsigned int type) {
+            _pos = pos;
+            _type = type;
+        }
+
+        int getX0() const { return _x0; }                //!< Return the first bad column, relative to x0
+        int getX1() const { return _x1; }                //!< Return the last bad column, relative to x0
+        unsigned int getType() const { return _type; }  //!< Return the run's interpolation type
+        Defect::DefectPosition getPos() const { return _pos; }  //!< Return the position of the run
+
+        bool operator==(Run const &other) const {
+            return _x0 == other._x0 && _x1 == other._x1 && _pos == other._pos && _type == other._type;
+        }
+
+    private:
+        int _x0, _x1;
+        Defect::DefectPosition _pos;
+        unsigned int _type;
+    };
+
+    /**
+     * @brief Compile a list of defects for images with the given bbox
+     *
+     * @param defects  the defects, in the parent coordinates of bbox
+     * @param bbox     bbox of the images the map will be applied to
+     */
+    CompiledDefectMap(std::vector<Defect::Ptr> const &defects, geom::Box2I const &bbox);
+
+    /**
+     * @brief Reconstruct a map from its runs, e.g. when unpersisting it
+     *
+     * @param bbox     bbox of the images the map will be applied to
+     * @param offsets  index of the first run of each row, plus the total number of runs (bbox height + 1)
+     * @param runs     the runs, row by row
+     *
+     * @throws lsst::pex::exceptions::LengthError if offsets and runs aren't consistent with bbox
+     */
+    CompiledDefectMap(geom::Box2I const &bbox, std::vector<std::size_t> const &offsets,
+                      std::vector<Run> const &runs);
+
+    CompiledDefectMap(CompiledDefectMap const &) = default;
+    CompiledDefectMap(CompiledDefectMap &&) = default;
+    CompiledDefectMap &operator=(CompiledDefectMap const &) = default;
+    CompiledDefectMap &operator=(CompiledDefectMap &&) = default;
+    ~CompiledDefectMap() = default;
+
+    geom::Box2I const &getBBox() const { return _bbox; }     //!< Return the bbox the map was built for
+    std::vector<std::size_t> const &getOffsets() const { return _offsets; }  //!< Start of each row's runs
+    std::vector<Run> const &getRuns() const { return _runs; }  //!< Return all the runs, row by row
+
+    /// Return the first of the runs in row y (relative to the bbox's origin)
+    Run const *beginRow(int y) const { return _runs.data() + _offsets[y]; }
+    /// Return one past the last of the runs in row y (relative to the bbox's origin)
+    Run const *endRow(int y) const { return _runs.data() + _offsets[y + 1]; }
+
+private:
+    geom::Box2I _bbox;
+    std::vector<std::size_t> _offsets;  // index of first run in each row; _offsets.back() == _runs.size()
+    std::vector<Run> _runs;
+};
+
 template <typename MaskedImageT>
 void interpolateOverDefects(MaskedImageT &image, afw::detection::Psf const &psf,
                             std::vector<Defect::Ptr> &badList, double fallbackValue = 0.0,
-                            bool useFallbackValueAtEdge = false);
+                            bool useFallbackValueAtEdge = false, int nThreads = 1);
+
+/**
+ * @brief Set bits in a mask for all the pixels in a list of boxes
+ *
+ * The boxes (in the mask's parent coordinates) are clipped to the mask and merged row by row, so each
+ * masked pixel is only visited once however many boxes cover it.
+ *
+ * @param mask     the mask to modify
+ * @param bboxes   the boxes to mask, e.g. the bounding boxes of a list of defects
+ * @param bitmask  the bits to OR into the masked pixels
+ */
+void maskBoxes(afw::image::Mask<afw::image::MaskPixel> &mask, std::vector<geom::Box2I> const &bboxes,
+               afw::image::MaskPixel const bitmask);
+
+/**
+ * @brief Return boxes covering the pixels of a mask with any of the given bits set
+ *
+ * The pixels are grouped into eight-connected footprints by SpanComponents, each of which is
+ * decomposed into boxes by afw::detection::footprintToBBoxList; the result is the same as doing so in
+ * Python, one footprint of a FootprintSet at a time.
+ *
+ * @param mask     the mask to search
+ * @param bitmask  the bits to look for
+ */
+std::vector<geom::Box2I> boxesFromMask(afw::image::Mask<afw::image::MaskPixel> const &mask,
+                                       afw::image::MaskPixel const bitmask);
+
+/**
+ * @brief Interpolate over the defects in a CompiledDefectMap
+ *
+ * This is equivalent to the version taking a list of Defects, but does no per-call setup.
+ *
+ * @throws lsst::pex::exceptions::LengthError if the image's bbox isn't that of the map
+ */
+template <typename MaskedImageT>
+void interpolateOverDefects(MaskedImageT &image, CompiledDefectMap const &defectMap,
+                            double fallbackValue = 0.0, bool useFallbackValueAtEdge = false,
+                            int nThreads = 1);
 
 }  // namespace algorithms
 }  // namespace meas
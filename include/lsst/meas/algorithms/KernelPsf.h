@@ -23,6 +23,8 @@
 #ifndef LSST_MEAS_ALGORITHMS_KernelPsf_h_INCLUDED
 #define LSST_MEAS_ALGORITHMS_KernelPsf_h_INCLUDED
 
+#include <memory>
+
 #include "lsst/geom/Box.h"
 #include "lsst/meas/algorithms/ImagePsf.h"
 
@@ -63,6 +65,18 @@ public:
     /// Whether this object is persistable; just delegates to the kernel.
      bool isPersistable() const noexcept override;
 
+    /**
+     *  @brief Enable or disable caching of the shape and aperture fluxes of a spatially constant kernel.
+     *
+     *  When enabled, computeShape and computeApertureFlux measure the kernel image once (per aperture
+     *  radius) and return the stored values afterwards, regardless of position.  Copies made by clone
+     *  share the cache.  This has no effect if the kernel is spatially varying.
+     */
+    void setCacheMoments(bool cacheMoments);
+
+    /// Whether shapes and aperture fluxes are being cached; see setCacheMoments.
+    bool getCacheMoments() const { return static_cast<bool>(_momentsCache); }
+
 protected:
     /// Construct a KernelPsf with the given kernel; it should not be modified afterwards.
     explicit KernelPsf(PTR(afw::math::Kernel) kernel, geom::Point2D const& averagePosition = geom::Point2D());
@@ -76,6 +90,13 @@ protected:
     // Output persistence implementation (should be overridden by derived classes if they add data members).
     void write(OutputArchiveHandle& handle) const override;
 
+    // Measure the kernel image as ImagePsf does, using the moments cache if it is enabled.
+    double doComputeApertureFlux(double radius, geom::Point2D const& position,
+                                 afw::image::Color const& color) const override;
+
+    afw::geom::ellipses::Quadrupole doComputeShape(geom::Point2D const& position,
+                                                   afw::image::Color const& color) const override;
+
     // For access to protected ctor; avoids unnecessary copies when loading
     template <typename T, typename K>
     friend class KernelPsfFactory;
@@ -86,8 +107,11 @@ private:
 
     geom::Box2I doComputeBBox(geom::Point2D const& position, afw::image::Color const& color) const override;
 
+    struct MomentsCache;
+
     PTR(afw::math::Kernel) _kernel;
     geom::Point2D _averagePosition;
+    std::shared_ptr<MomentsCache> _momentsCache;  // null unless setCacheMoments(true) on a constant kernel
 };
 
 }  // namespace algorithms
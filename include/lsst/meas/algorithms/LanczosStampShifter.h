@@ -0,0 +1,102 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_ALGORITHMS_LanczosStampShifter_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_LanczosStampShifter_h_INCLUDED
+
+#include <memory>
+#include <string>
+
+#include "lsst/afw/image/Image.h"
+#include "lsst/afw/image/MaskedImage.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+/**
+ *  @brief A separable Lanczos sub-pixel shift for small images (e.g. PSF candidate stamps and kernels).
+ *
+ *  The result is the same (up to floating-point rounding) as afw::math::offsetImage with a "lanczosN"
+ *  algorithm: the 2N normalized weights for each axis are computed once per call, pixels within the
+ *  kernel's reach of the (optionally padded) edge are copied from the input (and flagged EDGE in a
+ *  mask), the integer part of any shift of a pixel or more goes into xy0, and variances are shifted
+ *  with the squared weights.  No padded copy or convolved temporary is allocated; each row is swept
+ *  with one contiguous loop per tap, which the compiler vectorizes, into a per-thread scratch buffer
+ *  that is reused between calls.  Instances are immutable and may be shared between threads.
+ */
+class LanczosStampShifter {
+public:
+    /**
+     *  @param[in] order  Lanczos order; must be positive.
+     *
+     *  @throws InvalidParameterError if order is not positive.
+     */
+    explicit LanczosStampShifter(int order);
+
+    /// Return a shifter for a warping algorithm name (e.g. "lanczos5"), or nullptr if it isn't Lanczos.
+    static std::shared_ptr<LanczosStampShifter const> fromAlgorithm(std::string const& algorithmName);
+
+    //@{
+    /**
+     *  @brief Shift src by (dx, dy) into dest.
+     *
+     *  @param[in]  src     Image to shift.
+     *  @param[in]  dx, dy  Shift to apply, as for afw::math::offsetImage.
+     *  @param[out] dest    Destination, with the same dimensions as src; may be src itself.
+     *  @param[in]  buffer  Width of the zero-padding assumed around src.
+     *
+     *  @throws LengthError if the shapes don't match, or src is too small for the kernel.
+     */
+    template <typename PixelT>
+    void shift(afw::image::Image<PixelT> const& src, float dx, float dy, afw::image::Image<PixelT>& dest,
+               unsigned int buffer = 0) const;
+    template <typename PixelT>
+    void shift(afw::image::MaskedImage<PixelT> const& src, float dx, float dy,
+               afw::image::MaskedImage<PixelT>& dest, unsigned int buffer = 0) const;
+    //@}
+
+    /// Return a shifted copy of src; see the other overloads.
+    template <typename ImageT>
+    std::shared_ptr<ImageT> shift(ImageT const& src, float dx, float dy, unsigned int buffer = 0) const;
+
+    int getOrder() const { return _order; }
+
+private:
+    int _order;
+};
+
+/**
+ *  @brief Drop-in replacement for afw::math::offsetImage.
+ *
+ *  Lanczos algorithms use LanczosStampShifter; anything else is passed on to afw::math::offsetImage.
+ */
+template <typename ImageT>
+std::shared_ptr<ImageT> offsetStamp(ImageT const& image, float dx, float dy, std::string const& algorithmName,
+                                    unsigned int buffer = 0);
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_ALGORITHMS_LanczosStampShifter_h_INCLUDED
@@ -0,0 +1,107 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_ALGORITHMS_LanczosStampWarper_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_LanczosStampWarper_h_INCLUDED
+
+#include <memory>
+#include <vector>
+
+#include "lsst/geom/AffineTransform.h"
+#include "lsst/afw/detection/Psf.h"
+#include "lsst/afw/math/warpExposure.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+/**
+ *  @brief A Lanczos warper specialized for small images (e.g. Psf kernel images) and affine transforms.
+ *
+ *  afw::math::warpImage is designed for full CCD images and arbitrary transforms; for a 21x21 to 41x41
+ *  Psf stamp its per-call setup (transform wrapping, kernel parameter updates, bbox bookkeeping and the
+ *  zero-padded copy of the input) dominates.  This class precomputes a table of normalized separable
+ *  Lanczos weights at tableSize+1 fractional offsets, steps the affine transform incrementally along each
+ *  destination row, and runs the inner convolution loops with a compile-time kernel width so the
+ *  compiler can unroll and vectorize them.  Pixels outside the source image are treated as zero, so
+ *  the input does not have to be padded.
+ *
+ *  The result agrees with afw::math::warpImage (with the same Lanczos order and a kernel cache of
+ *  the same size) up to the quantization of the fractional offsets and an overall scale factor, which
+ *  is irrelevant for Psf images as they are normalized afterwards.  Instances are immutable and may
+ *  be shared between threads.
+ */
+class LanczosStampWarper {
+public:
+    typedef afw::detection::Psf::Image Image;
+
+    /**
+     *  @param[in] order      Lanczos order; must be between 1 and 5.
+     *  @param[in] tableSize  Number of intervals into which the fractional pixel offset is quantized.
+     *
+     *  @throws InvalidParameterError if order or tableSize is out of range.
+     */
+    explicit LanczosStampWarper(int order, int tableSize = 10000);
+
+    /**
+     *  @brief Construct a warper matching a WarpingControl.
+     *
+     *  @throws InvalidParameterError if the control's warping kernel is not a Lanczos kernel.
+     */
+    static std::shared_ptr<LanczosStampWarper const> fromWarpingControl(
+            afw::math::WarpingControl const& control);
+
+    /**
+     *  @brief Warp src into dest.
+     *
+     *  @param[in]  src        Image to warp; pixels outside it are taken to be zero.
+     *  @param[in]  srcToDest  Affine transform from source to destination pixel coordinates; only the
+     *                         inverse is used.
+     *  @param[out] dest       Destination image (or view); every pixel is overwritten.
+     *
+     *  @returns the sum of the destination pixels, accumulated while warping.
+     */
+    double warp(Image const& src, geom::AffineTransform const& srcToDest, Image& dest) const;
+
+    int getOrder() const { return _order; }
+    int getTableSize() const { return _tableSize; }
+
+private:
+    template <int N>
+    double _warp(Image const& src, geom::AffineTransform const& destToSrc, Image& dest) const;
+
+    // Return the 2*order weights for a fractional offset in [0, 1].
+    double const* _getWeights(double frac) const {
+        return &_table[static_cast<std::size_t>(frac * _tableSize + 0.5) * 2 * _order];
+    }
+
+    int _order;
+    int _tableSize;
+    std::vector<double> _table;  // (tableSize + 1) rows of 2*order normalized weights
+};
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_ALGORITHMS_LanczosStampWarper_h_INCLUDED
@@ -24,7 +24,12 @@
 #ifndef LSST_MEAS_ALGORITHMS_PcaPsf_h_INCLUDED
 #define LSST_MEAS_ALGORITHMS_PcaPsf_h_INCLUDED
 
+#include <memory>
+#include <vector>
+
+#include "Eigen/Core"
 #include "lsst/geom/Point.h"
+#include "lsst/afw/math/Kernel.h"
 #include "lsst/meas/algorithms/KernelPsf.h"
 
 namespace lsst {
@@ -33,6 +38,11 @@ namespace algorithms {
 
 /**
  * @brief Represent a PSF as a linear combination of PCA (== Karhunen-Loeve) basis functions
+ *
+ * The basis images are fixed, so rather than asking the LinearCombinationKernel to recompute them at
+ * every position, PcaPsf stacks them (one flattened basis image per column) when it is constructed and
+ * realizes the kernel image at a position as a single matrix-vector product of that stack with the
+ * spatial coefficients; batches of positions are evaluated as one matrix-matrix product.
  */
 class PcaPsf : public afw::table::io::PersistableFacade<PcaPsf>, public KernelPsf {
 public:
@@ -41,9 +51,12 @@ public:
      *
      *  @param[in] kernel           Kernel that defines the Psf.
      *  @param[in] averagePosition  Average position of stars used to construct the Psf.
+     *  @param[in] singlePrecision  Realize kernel images with the basis stack in single precision
+     *                              (the result is still normalized in double precision).  This is not
+     *                              persisted; Psfs read from an archive use double precision.
      */
     explicit PcaPsf(PTR(afw::math::LinearCombinationKernel) kernel,
-                    geom::Point2D const& averagePosition = geom::Point2D());
+                    geom::Point2D const& averagePosition = geom::Point2D(), bool singlePrecision = false);
 
     /// Polymorphic deep copy; should usually be unnecessary as Psfs are immutable.x
     PTR(afw::detection::Psf) clone() const override;
@@ -54,9 +67,30 @@ public:
     /// PcaPsf always has a LinearCombinationKernel, so we can override getKernel to make it more useful.
     PTR(afw::math::LinearCombinationKernel const) getKernel() const;
 
+    /// Whether kernel images are realized in single precision.
+    bool isSinglePrecision() const { return _singlePrecision; }
+
+protected:
+    /// Batch evaluation that realizes all the kernel images with one product against the basis stack.
+    std::vector<PTR(afw::detection::Psf::Image)> doComputeKernelImages(
+            std::vector<geom::Point2D> const& positions, afw::image::Color const& color) const override;
+
 private:
     // Name used in table persistence; the rest of is implemented by KernelPsf.
     std::string getPersistenceName() const override { return "PcaPsf"; }
+
+    PTR(Image)
+    doComputeKernelImage(geom::Point2D const& position, afw::image::Color const& color) const override;
+
+    void _init();
+
+    // Evaluate the spatial model (or copy the fixed kernel parameters) at position into coefficients.
+    void _computeCoefficients(geom::Point2D const& position, Eigen::Ref<Eigen::VectorXd> coefficients) const;
+
+    bool _singlePrecision;
+    std::shared_ptr<Eigen::MatrixXd const> _basis;   // one flattened basis image per column
+    std::shared_ptr<Eigen::MatrixXf const> _basisF;  // _basis in single precision, if _singlePrecision
+    std::shared_ptr<std::vector<afw::math::Kernel::SpatialFunctionPtr> const> _spatialFunctions;
 };
 
 }  // namespace algorithms
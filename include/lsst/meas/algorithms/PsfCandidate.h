@@ -32,6 +32,7 @@
  * @ingroup algorithms
  */
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "lsst/geom/Point.h"
@@ -40,6 +41,7 @@
 #include "lsst/afw/detection/FootprintSet.h"
 #include "lsst/afw/table/Source.h"
 #include "lsst/afw/math/SpatialCell.h"
+#include "lsst/meas/algorithms/PsfStampArena.h"
 
 namespace lsst {
 namespace meas {
@@ -72,10 +74,13 @@ public:
             : afw::math::SpatialCellImageCandidate(source->getX(), source->getY()),
               _parentExposure(parentExposure),
               _offsetImage(),
+              _offsetAlgorithm(),
+              _offsetBuffer(0),
               _source(source),
               _image(nullptr),
               _amplitude(0.0),
-              _var(1.0) {}
+              _var(1.0),
+              _arena() {}
 
     /**
      * Construct a PsfCandidate from a specified source, image and xyCenter.
@@ -89,10 +94,13 @@ public:
             : afw::math::SpatialCellImageCandidate(xCenter, yCenter),
               _parentExposure(parentExposure),
               _offsetImage(),
+              _offsetAlgorithm(),
+              _offsetBuffer(0),
               _source(source),
               _image(nullptr),
               _amplitude(0.0),
-              _var(1.0) {}
+              _var(1.0),
+              _arena() {}
 
     /// Destructor
     virtual ~PsfCandidate(){};
@@ -124,6 +132,18 @@ public:
     PTR(afw::image::MaskedImage<PixelT>)
     getOffsetImage(std::string const algorithm, unsigned int buffer) const;
 
+    /**
+     * Set the arena in which copies of the candidate's images are made
+     *
+     * Images that don't match the arena's dimensions, or are extracted once it's full, are allocated in
+     * the usual way.  An arena is usually shared by all the candidates in a SpatialCellSet; a null
+     * pointer reverts to ordinary allocation.
+     */
+    void setStampArena(std::shared_ptr<PsfStampArena<PixelT>> arena) { _arena = arena; }
+
+    /// Return the arena in which copies of the candidate's images are made (may be null)
+    std::shared_ptr<PsfStampArena<PixelT>> getStampArena() const { return _arena; }
+
     /// Return the number of pixels being ignored around the candidate image's edge
     static int getBorderWidth();
 
@@ -155,11 +175,14 @@ private:
     extractImage(unsigned int width, unsigned int height) const;
 
     PTR(afw::image::MaskedImage<PixelT>) mutable _offsetImage;  // %image offset to put center on a pixel
+    mutable std::string _offsetAlgorithm;  // algorithm used to make _offsetImage
+    mutable unsigned int _offsetBuffer;    // buffer used to make _offsetImage
     PTR(afw::table::SourceRecord) _source;                      // the Source itself
 
     mutable std::shared_ptr<afw::image::MaskedImage<PixelT>> _image;  // cutout image to return (cached)
     double _amplitude;   // best-fit amplitude of current PSF model
     double _var;         // variance to use when fitting this candidate
+    std::shared_ptr<PsfStampArena<PixelT>> _arena;  // where to allocate copies of images; may be null
     static int _border;  // width of border of ignored pixels around _image
     geom::Point2D _xyCenter;
     static int _defaultWidth;
@@ -0,0 +1,69 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_ALGORITHMS_PsfEvaluationLock_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_PsfEvaluationLock_h_INCLUDED
+
+#include <mutex>
+
+#include "lsst/afw/detection/Psf.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+/**
+ *  @brief A lock that keeps other threads from evaluating a Psf while it is held.
+ *
+ *  afw::detection::Psf keeps the images it computes in caches that are not locked, so a Psf must not be
+ *  evaluated by two threads at once.  The code in this package that may evaluate a Psf without the GIL
+ *  (and so from several threads at once) holds one of these while it does; Psfs evaluated through
+ *  other packages' bindings are only protected by the GIL.  Each Psf has a mutex of its own, so
+ *  different Psfs can be evaluated concurrently.  The mutexes are recursive, so evaluating a Psf may
+ *  lock it again (e.g. from a Psf implemented in Python), and lock the Psfs it is made of.
+ *
+ *  A thread holding the lock on a Psf implemented in Python needs the GIL to evaluate it, so such a Psf
+ *  should not be locked while holding the GIL.
+ */
+class PsfEvaluationLock {
+public:
+    explicit PsfEvaluationLock(afw::detection::Psf const& psf);
+
+    PsfEvaluationLock(PsfEvaluationLock const&) = delete;
+    PsfEvaluationLock(PsfEvaluationLock&&) = delete;
+    PsfEvaluationLock& operator=(PsfEvaluationLock const&) = delete;
+    PsfEvaluationLock& operator=(PsfEvaluationLock&&) = delete;
+
+    ~PsfEvaluationLock();
+
+private:
+    void const* _psf;
+    std::recursive_mutex* _mutex;
+};
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_ALGORITHMS_PsfEvaluationLock_h_INCLUDED
@@ -0,0 +1,142 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_ALGORITHMS_PsfImageCache_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_PsfImageCache_h_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "lsst/geom/Point.h"
+#include "lsst/afw/detection/Psf.h"
+#include "lsst/afw/image/Color.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+/**
+ *  @brief A bounded, thread-safe LRU cache of Psf kernel images keyed on quantized position.
+ *
+ *  Positions are snapped to a square grid with spacing equal to the tolerance, and Psfs that use
+ *  the cache evaluate the kernel image at the center of the grid cell rather than at the requested
+ *  position.  This makes the result independent of the order in which positions are requested,
+ *  while letting all positions within a cell share one image.
+ *
+ *  Keys may also include a list of integers (e.g. the indices of the CoaddPsf inputs contributing
+ *  at the requested position), so that a cell straddling an input boundary never reuses an image
+ *  built from a different set of inputs.
+ */
+class PsfImageCache {
+public:
+    typedef afw::detection::Psf::Image Image;
+
+    /// Key used to look up images; see makeKey.
+    struct Key {
+        std::int64_t ix;
+        std::int64_t iy;
+        afw::image::Color color;
+        std::vector<std::size_t> inputs;
+
+        bool operator==(Key const& other) const {
+            return ix == other.ix && iy == other.iy && color == other.color && inputs == other.inputs;
+        }
+    };
+
+    /**
+     *  @param[in] tolerance   Grid spacing (pixels) used to quantize positions; must be positive.
+     *  @param[in] maxBytes    Maximum memory used by cached image pixels; least recently used
+     *                         images are evicted past this limit.
+     *
+     *  @throws InvalidParameterError if tolerance is not positive.
+     */
+    PsfImageCache(double tolerance, std::size_t maxBytes);
+
+    PsfImageCache(PsfImageCache const&) = delete;
+    PsfImageCache(PsfImageCache&&) = delete;
+    PsfImageCache& operator=(PsfImageCache const&) = delete;
+    PsfImageCache& operator=(PsfImageCache&&) = delete;
+    ~PsfImageCache() = default;
+
+    /// Build the key for a position, color and (optional) list of contributing inputs.
+    Key makeKey(geom::Point2D const& position, afw::image::Color const& color,
+                std::vector<std::size_t> const& inputs = std::vector<std::size_t>()) const;
+
+    /// Return the position at which images for this key are evaluated (the grid cell center).
+    geom::Point2D getPosition(Key const& key) const;
+
+    /// Return the cached image for key, or nullptr; counts a hit or a miss.
+    PTR(Image) get(Key const& key);
+
+    /// Return the cached image for key, or nullptr, without updating the counters or LRU order.
+    PTR(Image) find(Key const& key) const;
+
+    /// Insert an image, evicting the least recently used entries if the memory budget is exceeded.
+    void insert(Key const& key, PTR(Image) image);
+
+    /// Remove all cached images (counters are not reset).
+    void clear();
+
+    double getTolerance() const { return _tolerance; }
+    std::size_t getMaxBytes() const { return _maxBytes; }
+
+    /// Number of lookups satisfied from the cache.
+    std::size_t getHits() const;
+
+    /// Number of lookups that had to compute a new image.
+    std::size_t getMisses() const;
+
+    /// Number of cached images.
+    std::size_t getSize() const;
+
+    /// Memory currently used by cached image pixels, in bytes.
+    std::size_t getMemoryUsage() const;
+
+private:
+    struct KeyHash {
+        std::size_t operator()(Key const& key) const;
+    };
+
+    typedef std::list<std::pair<Key, PTR(Image)>> EntryList;
+
+    static std::size_t _getBytes(Image const& image);
+
+    double const _tolerance;
+    std::size_t const _maxBytes;
+    mutable std::mutex _mutex;
+    EntryList _entries;  // most recently used first
+    std::unordered_map<Key, EntryList::iterator, KeyHash> _lookup;
+    std::size_t _memoryUsage;
+    std::size_t _hits;
+    std::size_t _misses;
+};
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_ALGORITHMS_PsfImageCache_h_INCLUDED
@@ -0,0 +1,141 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_ALGORITHMS_PsfResultCache_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_PsfResultCache_h_INCLUDED
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#include "lsst/geom/Point.h"
+#include "lsst/afw/detection/Psf.h"
+#include "lsst/afw/geom/ellipses/Quadrupole.h"
+#include "lsst/afw/image/Color.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+/**
+ *  @brief A bounded, thread-safe LRU cache of the shapes and aperture fluxes measured by ImagePsf.
+ *
+ *  Entries are keyed on exact position and color, so cached values are identical to freshly measured
+ *  ones.  Each entry also keeps the kernel image the values were measured on, so asking for the shape
+ *  and then an aperture flux (or fluxes for several radii) at one position realizes the image only once.
+ *  Once the cache holds capacity positions, the least recently used one is evicted.
+ */
+class PsfResultCache {
+public:
+    typedef afw::detection::Psf::Image Image;
+
+    /**
+     *  @param[in] capacity   Maximum number of positions to hold results for; must be positive.
+     *
+     *  @throws InvalidParameterError if capacity is zero.
+     */
+    explicit PsfResultCache(std::size_t capacity);
+
+    PsfResultCache(PsfResultCache const&) = delete;
+    PsfResultCache(PsfResultCache&&) = delete;
+    PsfResultCache& operator=(PsfResultCache const&) = delete;
+    PsfResultCache& operator=(PsfResultCache&&) = delete;
+    ~PsfResultCache() = default;
+
+    /// Set shape to the cached shape at position and return true, or return false; counts a hit or miss.
+    bool getShape(geom::Point2D const& position, afw::image::Color const& color,
+                  afw::geom::ellipses::Quadrupole& shape);
+
+    /// Set flux to the cached aperture flux at position and return true, or return false; counts a hit
+    /// or miss.
+    bool getApertureFlux(double radius, geom::Point2D const& position, afw::image::Color const& color,
+                         double& flux);
+
+    /// Return the kernel image cached at position, or nullptr, without updating the counters.
+    PTR(Image) getImage(geom::Point2D const& position, afw::image::Color const& color) const;
+
+    /// Store the shape measured on image at position.
+    void insertShape(geom::Point2D const& position, afw::image::Color const& color,
+                     afw::geom::ellipses::Quadrupole const& shape, PTR(Image) image);
+
+    /// Store the aperture flux measured on image at position.
+    void insertApertureFlux(double radius, geom::Point2D const& position, afw::image::Color const& color,
+                            double flux, PTR(Image) image);
+
+    /// Remove all cached results (counters are not reset).
+    void clear();
+
+    std::size_t getCapacity() const { return _capacity; }
+
+    /// Number of lookups satisfied from the cache.
+    std::size_t getHits() const;
+
+    /// Number of lookups that had to measure the kernel image.
+    std::size_t getMisses() const;
+
+    /// Number of positions with cached results.
+    std::size_t getSize() const;
+
+private:
+    struct Key {
+        geom::Point2D position;
+        afw::image::Color color;
+
+        bool operator==(Key const& other) const {
+            return position == other.position && color == other.color;
+        }
+    };
+
+    struct KeyHash {
+        std::size_t operator()(Key const& key) const;
+    };
+
+    struct Entry {
+        PTR(Image) image;
+        bool hasShape = false;
+        afw::geom::ellipses::Quadrupole shape;
+        std::map<double, double> apertureFluxes;  // keyed on radius
+    };
+
+    typedef std::list<std::pair<Key, Entry>> EntryList;
+
+    // Return the entry for key (creating it, and evicting old entries, if necessary) and mark it as
+    // most recently used; must be called with the mutex held.
+    Entry& _getOrInsert(Key const& key, PTR(Image) image);
+
+    std::size_t const _capacity;
+    mutable std::mutex _mutex;
+    EntryList _entries;  // most recently used first
+    std::unordered_map<Key, EntryList::iterator, KeyHash> _lookup;
+    std::size_t _hits;
+    std::size_t _misses;
+};
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_ALGORITHMS_PsfResultCache_h_INCLUDED
@@ -0,0 +1,104 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_ALGORITHMS_PsfStampArena_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_PsfStampArena_h_INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+#include "lsst/geom/Extent.h"
+#include "lsst/afw/image/MaskedImage.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+/**
+ *  @brief A single allocation holding the pixels of many equal-sized PSF candidate stamps.
+ *
+ *  Each stamp is a MaskedImage whose image, mask and variance planes view a fixed-stride slot of one
+ *  block of memory, rather than three separate heap allocations.  Stamps keep the block alive, so it is
+ *  freed once the arena and all the stamps handed out by it have gone.  Slots are never reused; once
+ *  the arena is full, allocate returns nullptr and callers fall back to ordinary MaskedImages.
+ *
+ *  Each stamp's planes have their own ndarray reference counts, so stamps may be used from different
+ *  threads just as independently-allocated MaskedImages can.
+ */
+template <typename PixelT>
+class PsfStampArena {
+public:
+    typedef afw::image::MaskedImage<PixelT> MaskedImageT;
+
+    /**
+     *  @param[in] width      Width of each stamp.
+     *  @param[in] height     Height of each stamp.
+     *  @param[in] capacity   Number of stamps to allocate space for.
+     *
+     *  @throws InvalidParameterError if width or height is not positive.
+     */
+    PsfStampArena(int width, int height, std::size_t capacity);
+
+    PsfStampArena(PsfStampArena const&) = delete;
+    PsfStampArena(PsfStampArena&&) = delete;
+    PsfStampArena& operator=(PsfStampArena const&) = delete;
+    PsfStampArena& operator=(PsfStampArena&&) = delete;
+    ~PsfStampArena() = default;
+
+    /**
+     *  Return a new stamp (with unspecified pixel values and xy0 of (0, 0)), or nullptr if dims don't
+     *  match the arena's or it is full.  Safe to call from several threads at once.
+     */
+    std::shared_ptr<MaskedImageT> allocate(geom::Extent2I const& dims);
+
+    int getWidth() const { return _width; }
+    int getHeight() const { return _height; }
+
+    /// Number of stamps the arena can hold.
+    std::size_t getCapacity() const { return _capacity; }
+
+    /// Number of stamps handed out so far.
+    std::size_t getSize() const;
+
+    /// Size of the arena's block of memory, in bytes.
+    std::size_t getMemorySize() const { return _bytes; }
+
+private:
+    int const _width;
+    int const _height;
+    std::size_t const _capacity;
+    std::size_t _maskOffset;      // offset of the mask plane within a stamp's slot, in bytes
+    std::size_t _varianceOffset;  // offset of the variance plane within a stamp's slot, in bytes
+    std::size_t _stride;          // size of a stamp's slot, in bytes
+    std::size_t _bytes;
+    std::shared_ptr<char> _block;
+    mutable std::mutex _mutex;
+    std::size_t _size;
+};
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_ALGORITHMS_PsfStampArena_h_INCLUDED
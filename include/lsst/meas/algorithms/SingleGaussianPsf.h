@@ -25,6 +25,7 @@
 #define LSST_MEAS_ALGORITHMS_SingleGaussianPsf_h_INCLUDED
 
 #include "lsst/base.h"
+#include "lsst/meas/algorithms/GaussianPsfMoments.h"
 #include "lsst/meas/algorithms/KernelPsf.h"
 
 namespace lsst {
@@ -64,8 +65,17 @@ protected:
 
     void write(OutputArchiveHandle& handle) const override;
 
+    // Closed-form aperture flux and shape; these fall back to measuring the kernel image when the
+    // kernel's bbox truncates the Gaussian too much (see GaussianPsfMoments).
+    double doComputeApertureFlux(double radius, geom::Point2D const& position,
+                                 afw::image::Color const& color) const override;
+
+    afw::geom::ellipses::Quadrupole doComputeShape(geom::Point2D const& position,
+                                                   afw::image::Color const& color) const override;
+
 private:
     double _sigma;  ///< Width of Gaussian
+    GaussianPsfMoments _moments;
 };
 
 }  // namespace algorithms
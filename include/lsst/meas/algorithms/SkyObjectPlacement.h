@@ -0,0 +1,64 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_ALGORITHMS_SkyObjectPlacement_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_SkyObjectPlacement_h_INCLUDED
+
+#include <memory>
+#include <vector>
+
+#include "lsst/afw/image/Mask.h"
+#include "lsst/afw/detection/Footprint.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+/**
+ *  @brief Place circular sky objects where they overlap neither masked pixels nor each other.
+ *
+ *  The masked pixels are dilated by the circle once, giving the set of centers at which a sky object
+ *  would overlap them, recorded in a grid of one bit per pixel.  Centers are then drawn uniformly (more
+ *  than radius + 1 from the edge of the mask) and rejected if blocked, and each one accepted blocks the
+ *  centers at which a later object would overlap it.  Each draw costs O(1), and each object accepted
+ *  O(radius^2).
+ *
+ *  @param[in] mask          Mask of the pixels to avoid.
+ *  @param[in] avoidBitmask  Mask bits of the pixels to avoid.
+ *  @param[in] radius        Radius of the sky objects, as for afw::geom::SpanSet::fromShape.
+ *  @param[in] nSources      Maximum number of sky objects to return.
+ *  @param[in] nTrials       Maximum number of centers to draw.
+ *  @param[in] seed          Seed for the random number generator.
+ *  @param[in] growMask      Number of pixels to grow the masked pixels by.
+ *
+ *  @returns Footprints of the sky objects, each with a single peak (of value 0) at its center.
+ */
+std::vector<std::shared_ptr<afw::detection::Footprint>> placeSkyObjects(
+        afw::image::Mask<afw::image::MaskPixel> const& mask, afw::image::MaskPixel avoidBitmask, int radius,
+        int nSources, int nTrials, unsigned long seed, int growMask = 0);
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_ALGORITHMS_SkyObjectPlacement_h_INCLUDED
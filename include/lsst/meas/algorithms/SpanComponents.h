@@ -0,0 +1,93 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_ALGORITHMS_SpanComponents_h_INCLUDED
+#define LSST_MEAS_ALGORITHMS_SpanComponents_h_INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "lsst/afw/geom/Span.h"
+#include "lsst/afw/geom/SpanSet.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+/**
+ *  @brief Connected components of a set of pixels given as Spans.
+ *
+ *  Spans are sorted by row and column, then spans that touch, either in the same row or in adjacent
+ *  rows, are joined with a union-find.  Each row is swept against the next one once, so the cost is
+ *  proportional to the number of spans (plus sorting them), not to the number of pixels or to the area
+ *  of the bounding box.
+ *
+ *  Components are numbered in the order of their first span, i.e. of their lowest, leftmost pixel.
+ */
+class SpanComponents {
+public:
+    /**
+     *  @param[in] spans           Spans to group; may be in any order, but must not overlap.
+     *  @param[in] eightConnected  If true, spans that only touch at a corner are connected.
+     */
+    explicit SpanComponents(std::vector<afw::geom::Span> spans, bool eightConnected = true);
+
+    SpanComponents(SpanComponents const&) = default;
+    SpanComponents(SpanComponents&&) = default;
+    SpanComponents& operator=(SpanComponents const&) = default;
+    SpanComponents& operator=(SpanComponents&&) = default;
+    ~SpanComponents() = default;
+
+    /// Return the spans, sorted by row and then by starting column.
+    std::vector<afw::geom::Span> const& getSpans() const { return _spans; }
+
+    /// Return the component of each span in getSpans().
+    std::vector<int> const& getLabels() const { return _labels; }
+
+    /// Return the number of components.
+    std::size_t getComponentCount() const { return _nComponents; }
+
+    /// Return the index (into getSpans()) of the first span of each component.
+    std::vector<std::size_t> getFirstSpans() const;
+
+    /// Return the index (into getSpans()) of the last span of each component.
+    std::vector<std::size_t> getLastSpans() const;
+
+    /// Return the spans of each component, in component order.
+    std::vector<std::vector<afw::geom::Span>> getComponentSpans() const;
+
+    /// Return each component as a SpanSet, in component order.
+    std::vector<std::shared_ptr<afw::geom::SpanSet>> makeSpanSets() const;
+
+private:
+    std::vector<afw::geom::Span> _spans;
+    std::vector<int> _labels;
+    std::size_t _nComponents;
+};
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_ALGORITHMS_SpanComponents_h_INCLUDED
@@ -31,7 +31,9 @@
  *
  * @ingroup algorithms
  */
+#include <cstddef>
 #include <memory>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -40,6 +42,7 @@
 #include "lsst/afw/detection/Psf.h"
 #include "lsst/afw/math/Kernel.h"
 #include "lsst/afw/math/SpatialCell.h"
+#include "lsst/meas/algorithms/ImagePca.h"
 
 namespace lsst {
 namespace meas {
@@ -50,21 +53,90 @@ std::pair<std::shared_ptr<afw::math::LinearCombinationKernel>, std::vector<doubl
 createKernelFromPsfCandidates(afw::math::SpatialCellSet const& psfCells, geom::Extent2I const& dims,
                               geom::Point2I const& xy0, int const nEigenComponents, int const spatialOrder,
                               int const ksize, int const nStarPerCell = -1, bool const constantWeight = true,
-                              int const border = 3);
+                              int const border = 3, int const nThreads = 1, bool const randomized = false,
+                              ImageInnerProductCache<afw::image::MaskedImage<PixelT>>* cache = nullptr);
 
 template <typename PixelT>
 int countPsfCandidates(afw::math::SpatialCellSet const& psfCells, int const nStarPerCell = -1);
 
+/**
+ * Per-candidate quantities used by the linear fit in fitSpatialKernelFromPsfCandidates that depend only
+ * on the candidate's image and the Kernel's basis: the basis offset to the candidate's sub-pixel position,
+ * the candidate's amplitude fitted to the basis, and the inner products of the basis with the data.
+ *
+ * Passing the same cache to repeated fits (e.g. the iterations of the PCA PSF determiner) saves
+ * recomputing them.  The cache checks the Kernel's basis (and the PsfCandidate border width) each time it
+ * is used, and each candidate's image when its entry is used, discarding anything that has changed; it
+ * may therefore be used with any Kernel and candidates, and the fit doesn't depend on its contents.
+ */
+template <typename PixelT>
+class SpatialKernelFitCache {
+public:
+    typedef afw::image::Image<afw::math::Kernel::Pixel> KernelImage;
+
+    /// The cached quantities for one candidate
+    struct Entry {
+        std::shared_ptr<afw::image::MaskedImage<PixelT> const> data;  ///< image the entry applies to
+        double basisAmplitude;                                      ///< amplitude fitted to the basis
+        std::vector<std::shared_ptr<KernelImage>> offsetBasis;      ///< basis offset to the candidate
+        double amplitude;                  ///< amplitude used to normalise the data in basisDotData
+        std::vector<double> basisDotData;  ///< inner products of offsetBasis with the normalised data
+        bool reused;                       ///< was anything in the entry reused by the last fit?
+
+        Entry();
+    };
+
+    SpatialKernelFitCache();
+
+    SpatialKernelFitCache(SpatialKernelFitCache const&) = delete;
+    SpatialKernelFitCache(SpatialKernelFitCache&&) = delete;
+    SpatialKernelFitCache& operator=(SpatialKernelFitCache const&) = delete;
+    SpatialKernelFitCache& operator=(SpatialKernelFitCache&&) = delete;
+    ~SpatialKernelFitCache() = default;
+
+    /**
+     * Return the entries for the candidates, in order, after discarding all the entries if kernel's basis
+     * differs from the one they were computed for.  Not thread-safe, although the entries themselves may
+     * be updated by different threads.
+     */
+    std::vector<Entry*> getEntries(afw::math::LinearCombinationKernel const& kernel,
+                                   std::vector<afw::math::SpatialCellCandidate*> const& candidates);
+
+    /// Count the entries reused (hits) or computed afresh (misses) by the last fit
+    void countUses(std::vector<Entry*> const& entries);
+
+    /// Discard all cached quantities (counters are not reset)
+    void clear();
+
+    /// Number of candidates with an entry
+    std::size_t size() const { return _entries.size(); }
+
+    /// Number of times a candidate's entry was reused
+    std::size_t getHits() const { return _hits; }
+
+    /// Number of times a candidate's entry had to be computed
+    std::size_t getMisses() const { return _misses; }
+
+private:
+    std::vector<std::shared_ptr<KernelImage>> _basis;  // basis the entries were computed for
+    int _border;                                       // PsfCandidate border width used for the entries
+    std::unordered_map<int, Entry> _entries;           // keyed by candidate ID
+    std::size_t _hits;
+    std::size_t _misses;
+};
+
 template <typename PixelT>
 std::pair<bool, double> fitSpatialKernelFromPsfCandidates(afw::math::Kernel* kernel,
                                                           afw::math::SpatialCellSet const& psfCells,
                                                           int const nStarPerCell = -1,
                                                           double const tolerance = 1e-5,
-                                                          double const lambda = 0.0);
+                                                          double const lambda = 0.0,
+                                                          int const nThreads = 1);
 template <typename PixelT>
 std::pair<bool, double> fitSpatialKernelFromPsfCandidates(
         afw::math::Kernel* kernel, afw::math::SpatialCellSet const& psfCells, bool const doNonLinearFit,
-        int const nStarPerCell = -1, double const tolerance = 1e-5, double const lambda = 0.0);
+        int const nStarPerCell = -1, double const tolerance = 1e-5, double const lambda = 0.0,
+        int const nThreads = 1, int const nAmplitudeIter = 0, SpatialKernelFitCache<PixelT>* cache = nullptr);
 
 template <typename ImageT>
 double subtractPsf(afw::detection::Psf const& psf, ImageT* data, double x, double y,
@@ -22,10 +22,15 @@
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
 
+#include <vector>
+
 #include "lsst/geom/Box.h"
+#include "lsst/geom/LinearTransform.h"
 #include "lsst/afw/geom/Transform.h"
 #include "lsst/afw/math/warpExposure.h"
 #include "lsst/meas/algorithms/ImagePsf.h"
+#include "lsst/meas/algorithms/LanczosStampWarper.h"
+#include "lsst/meas/algorithms/PsfImageCache.h"
 
 #ifndef LSST_AFW_DETECTION_WARPEDPSF_H
 #define LSST_AFW_DETECTION_WARPEDPSF_H
@@ -62,6 +67,27 @@ public:
               CONST_PTR(afw::geom::TransformPoint2ToPoint2) distortion,
               std::string const& kernelName = "lanczos3", unsigned int cache = 10000);
 
+    /**
+     * @brief Construct a WarpedPsf with a position-quantized kernel image cache.
+     *
+     * Kernel images are evaluated at the center of a grid cell of size imageCacheTolerance
+     * (pixels) and reused for every position in that cell; see PsfImageCache.
+     *
+     * @param[in] undistortedPsf       Psf in the undistorted frame.
+     * @param[in] distortion           Transform from undistorted to distorted (nominal) pixels.
+     * @param[in] control              Warping parameters.
+     * @param[in] imageCacheTolerance  Grid spacing for the image cache; values <= 0 disable it.
+     * @param[in] imageCacheMaxBytes   Memory budget for cached images.
+     * @param[in] stampWarper          If not null, used instead of afw::math::warpImage to warp the
+     *                                 kernel images; it should use the same Lanczos order as control.
+     *                                 Only it sums the image as it warps; with afw::math::warpImage
+     *                                 the normalization takes an extra pass over the image.
+     */
+    WarpedPsf(CONST_PTR(afw::detection::Psf) undistortedPsf,
+              CONST_PTR(afw::geom::TransformPoint2ToPoint2) distortion,
+              CONST_PTR(afw::math::WarpingControl) control, double imageCacheTolerance,
+              std::size_t imageCacheMaxBytes, CONST_PTR(LanczosStampWarper) stampWarper = nullptr);
+
     /**
      *  @brief Return the average of the positions of the stars that went into this Psf.
      *
@@ -75,17 +101,71 @@ public:
     /// Return a clone with specified kernel dimensions
     virtual PTR(afw::detection::Psf) resized(int width, int height) const;
 
+    /**
+     * @brief Compute the kernel image at a position into a caller-provided buffer.
+     *
+     * This avoids allocating the output image and the zero-padded warp input, so a single buffer
+     * can be reused across many calls.  The kernel is written into the sub-image of out covering
+     * computeBBox(position, color); the rest of out is set to zero.
+     *
+     * @param[out] out       Image whose bbox must contain the kernel bbox.
+     * @param[in] position   Position at which to evaluate the PSF.
+     * @param[in] color      Color of the source.
+     * @returns the bbox of the kernel image within out.
+     * @throws LengthError if out does not contain the kernel bbox.
+     */
+    geom::Box2I computeKernelImageInto(Image& out, geom::Point2D const& position,
+                                       afw::image::Color const& color = afw::image::Color()) const;
+
+    /**
+     * @brief Compute the kernel image at a position, warping with the given WarpingControl.
+     *
+     * This is computeKernelImage without any image cache (afw's or this Psf's), warping with
+     * warpingControl rather than this Psf's own (unless there is a stamp warper).  The warping kernel
+     * of a WarpingControl is modified while warping, so this lets threads with WarpingControls of their
+     * own share one WarpedPsf.
+     */
+    PTR(Image) warpKernelImage(geom::Point2D const& position, afw::image::Color const& color,
+                               afw::math::WarpingControl const& warpingControl) const;
+
+    /// Compute the kernel images at many positions, as warpKernelImage and computeKernelImages.
+    std::vector<PTR(Image)> warpKernelImages(std::vector<geom::Point2D> const& positions,
+                                             afw::image::Color const& color,
+                                             afw::math::WarpingControl const& warpingControl) const;
+
+    /// Return the position-quantized kernel image cache, or nullptr if it is disabled.
+    std::shared_ptr<PsfImageCache const> getImageCache() const { return _imageCache; }
+
+    /// Return the small-stamp warper, or nullptr if afw::math::warpImage is used.
+    CONST_PTR(LanczosStampWarper) getStampWarper() const { return _stampWarper; }
+
 protected:
     virtual PTR(afw::detection::Psf::Image)
             doComputeKernelImage(geom::Point2D const& position, afw::image::Color const& color) const;
 
+    /// Batch evaluation that inverts the distortion once and maps all positions in one call.
+    std::vector<PTR(afw::detection::Psf::Image)> doComputeKernelImages(
+            std::vector<geom::Point2D> const& positions, afw::image::Color const& color) const override;
+
 protected:
     PTR(afw::detection::Psf const) _undistortedPsf;
     PTR(afw::geom::TransformPoint2ToPoint2 const) _distortion;
 
 private:
     void _init();
+
+    // Warp the undistorted kernel image at undistortedPosition with warpingControl, where linear is
+    // the linearized mapping from warped to undistorted coordinates.  If buffer is not null, the result
+    // is a view into it (and the rest of it is zeroed); otherwise a new image is allocated.
+    PTR(afw::detection::Psf::Image) _warpKernelImage(geom::Point2D const& undistortedPosition,
+                                                     geom::LinearTransform const& linear,
+                                                     afw::image::Color const& color,
+                                                     afw::math::WarpingControl const& warpingControl,
+                                                     Image* buffer = nullptr) const;
+
     CONST_PTR(afw::math::WarpingControl) _warpingControl;
+    std::shared_ptr<PsfImageCache> _imageCache;
+    CONST_PTR(LanczosStampWarper) _stampWarper;
 
     virtual geom::Box2I doComputeBBox(geom::Point2D const& position, afw::image::Color const& color) const;
 };
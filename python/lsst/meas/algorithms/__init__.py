@@ -26,16 +26,25 @@
 import lsst.afw.image
 import lsst.afw.math
 
+from .backgroundStatistics import *
 from .crLib import *
 from .coaddBoundedField import *
+from .coaddBoundedFieldSet import *
+from .detectionSmoother import *
+from .fusedDetection import *
+from .htmMesh import *
 from .imagePsf import *
+from .instrumentation import *
 from .interp import *
 from .kernelPsf import *
 from .pcaPsf import *
 from .psfCandidate import * #python
 from .singleGaussianPsf import *
+from .skyObjectPlacement import *
+from .spanComponents import *
 from .spatialModelPsf import *
 from .warpedPsf import *
+from .coaddInputIndex import *
 from .coaddPsf import *
 from .coaddTransmissionCurve import *
 from .doubleGaussianPsf import *
@@ -0,0 +1,53 @@
+/*
+ * LSST Data Management System
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ * See the COPYRIGHT file
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include "lsst/meas/algorithms/BackgroundStatistics.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+namespace {
+
+template <typename PixelT>
+void declareComputeBackgroundStatistics(py::module &mod) {
+    mod.def("computeBackgroundStatistics", &computeBackgroundStatistics<PixelT>, "image"_a, "nx"_a, "ny"_a,
+            "sctrl"_a, "property"_a, "nThreads"_a = 1, py::call_guard<py::gil_scoped_release>());
+}
+
+PYBIND11_MODULE(backgroundStatistics, mod) {
+    py::module::import("lsst.afw.image");
+    py::module::import("lsst.afw.math");
+
+    declareComputeBackgroundStatistics<float>(mod);
+    declareComputeBackgroundStatistics<double>(mod);
+    mod.def("makeBackgroundBinEdges", &makeBackgroundBinEdges, "length"_a, "n"_a);
+}
+
+}  // namespace
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
@@ -21,6 +21,7 @@
  */
 #include "pybind11/pybind11.h"
 #include "pybind11/stl.h"
+#include "ndarray/pybind11.h"
 
 #include "lsst/geom/Box.h"
 #include "lsst/afw/table/io/python.h"
@@ -34,6 +35,16 @@ namespace meas {
 namespace algorithms {
 namespace {
 
+template <typename T>
+void declareTemplates(py::class_<CoaddBoundedField, std::shared_ptr<CoaddBoundedField>,
+                                 afw::table::io::PersistableFacade<CoaddBoundedField>,
+                                 afw::math::BoundedField> &cls) {
+    cls.def("fillImage", &CoaddBoundedField::fillImage<T>, "image"_a, "overlapOnly"_a = false,
+            "xStep"_a = 1, "yStep"_a = 1);
+    cls.def("addToImage", &CoaddBoundedField::addToImage<T>, "image"_a, "scaleBy"_a = 1.0,
+            "overlapOnly"_a = false, "xStep"_a = 1, "yStep"_a = 1);
+}
+
 PYBIND11_MODULE(coaddBoundedField, mod) {
     py::class_<CoaddBoundedFieldElement> clsCoaddBoundedFieldElement(mod, "CoaddBoundedFieldElement");
 
@@ -79,11 +90,29 @@ PYBIND11_MODULE(coaddBoundedField, mod) {
     clsCoaddBoundedField.def("__imul__", &CoaddBoundedField::operator*);
 
     /* Members */
-    clsCoaddBoundedField.def("evaluate", &CoaddBoundedField::evaluate);
+    clsCoaddBoundedField.def("evaluate", py::overload_cast<geom::Point2D const &>(&CoaddBoundedField::evaluate,
+                                                                               py::const_));
+    clsCoaddBoundedField.def("evaluate",
+                             py::overload_cast<ndarray::Array<double const, 1> const &,
+                                               ndarray::Array<double const, 1> const &>(
+                                     &CoaddBoundedField::evaluate, py::const_),
+                             "x"_a, "y"_a);
+    clsCoaddBoundedField.def("evaluate",
+                             [](CoaddBoundedField const &self, double x, double y) {
+                                 return self.evaluate(geom::Point2D(x, y));
+                             },
+                             "x"_a, "y"_a);
     clsCoaddBoundedField.def("getCoaddWcs", &CoaddBoundedField::getCoaddWcs);
     clsCoaddBoundedField.def("getDefault", &CoaddBoundedField::getDefault);
     clsCoaddBoundedField.def("getElements", &CoaddBoundedField::getElements);
     clsCoaddBoundedField.def("isPersistable", &CoaddBoundedField::isPersistable);
+    clsCoaddBoundedField.def("approximated", &CoaddBoundedField::approximated, "maxError"_a);
+    clsCoaddBoundedField.def("getApproximationMaxError", &CoaddBoundedField::getApproximationMaxError);
+    clsCoaddBoundedField.def("getApproximatedElementCount",
+                             &CoaddBoundedField::getApproximatedElementCount);
+
+    declareTemplates<float>(clsCoaddBoundedField);
+    declareTemplates<double>(clsCoaddBoundedField);
 }
 
 }  // namespace
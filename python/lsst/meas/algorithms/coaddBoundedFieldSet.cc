@@ -0,0 +1,138 @@
+/*
+ * LSST Data Management System
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ * See the COPYRIGHT file
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+#include "ndarray/pybind11.h"
+
+#include "lsst/geom/Box.h"
+#include "lsst/afw/table/io/python.h"
+#include "lsst/meas/algorithms/CoaddBoundedFieldSet.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+namespace {
+
+PYBIND11_MODULE(coaddBoundedFieldSet, mod) {
+    py::class_<CoaddBoundedFieldSetElement> clsElement(mod, "CoaddBoundedFieldSetElement");
+
+    clsElement.def(py::init([](std::vector<std::shared_ptr<afw::math::BoundedField>> const &fields,
+                               std::shared_ptr<afw::geom::SkyWcs const> wcs, py::object polygon,
+                               double weight) {
+                       if (polygon.is(py::none())) {
+                           return new CoaddBoundedFieldSetElement(fields, wcs, nullptr, weight);
+                       } else {
+                           auto pgon = py::cast<std::shared_ptr<afw::geom::polygon::Polygon const>>(polygon);
+                           return new CoaddBoundedFieldSetElement(fields, wcs, pgon, weight);
+                       }
+                   }),
+                   "fields"_a, "wcs"_a, "validPolygon"_a, "weight"_a = 1.0);
+
+    clsElement.def_readwrite("fields", &CoaddBoundedFieldSetElement::fields);
+    clsElement.def_readwrite("wcs", &CoaddBoundedFieldSetElement::wcs);
+    clsElement.def_readwrite("validPolygon", &CoaddBoundedFieldSetElement::validPolygon);
+    clsElement.def_readwrite("weight", &CoaddBoundedFieldSetElement::weight);
+
+    afw::table::io::python::declarePersistableFacade<CoaddBoundedFieldSet>(mod, "CoaddBoundedFieldSet");
+
+    py::class_<CoaddBoundedFieldSet, std::shared_ptr<CoaddBoundedFieldSet>,
+               afw::table::io::PersistableFacade<CoaddBoundedFieldSet>, afw::table::io::Persistable>
+            clsSet(mod, "CoaddBoundedFieldSet");
+
+    clsSet.attr("Element") = clsElement;
+    clsSet.attr("MAX_NAME_LENGTH") = py::int_(CoaddBoundedFieldSet::MAX_NAME_LENGTH);
+
+    /* Constructors */
+    clsSet.def(py::init<geom::Box2I const &, std::shared_ptr<afw::geom::SkyWcs const>,
+                        std::vector<std::string> const &, CoaddBoundedFieldSet::ElementVector const &>(),
+               "bbox"_a, "coaddWcs"_a, "names"_a, "elements"_a);
+    clsSet.def(py::init<geom::Box2I const &, std::shared_ptr<afw::geom::SkyWcs const>,
+                        std::vector<std::string> const &, CoaddBoundedFieldSet::ElementVector const &,
+                        double>(),
+               "bbox"_a, "coaddWcs"_a, "names"_a, "elements"_a, "default"_a);
+
+    /* Operators */
+    clsSet.def("__eq__", &CoaddBoundedFieldSet::operator==, py::is_operator());
+    clsSet.def("__ne__", &CoaddBoundedFieldSet::operator!=, py::is_operator());
+
+    /* Members */
+    clsSet.def("evaluate",
+               py::overload_cast<geom::Point2D const &>(&CoaddBoundedFieldSet::evaluate, py::const_),
+               "position"_a, py::call_guard<py::gil_scoped_release>());
+    clsSet.def("evaluate",
+               py::overload_cast<ndarray::Array<double const, 1> const &,
+                                 ndarray::Array<double const, 1> const &>(&CoaddBoundedFieldSet::evaluate,
+                                                                          py::const_),
+               "x"_a, "y"_a, py::call_guard<py::gil_scoped_release>());
+    clsSet.def("getField", &CoaddBoundedFieldSet::getField, "name"_a);
+    clsSet.def("makeCoaddBoundedField", &CoaddBoundedFieldSet::makeCoaddBoundedField, "i"_a);
+    clsSet.def("getFieldIndex", &CoaddBoundedFieldSet::getFieldIndex, "name"_a);
+    clsSet.def("getFieldCount", &CoaddBoundedFieldSet::getFieldCount);
+    clsSet.def("getNames", &CoaddBoundedFieldSet::getNames);
+    clsSet.def("getBBox", &CoaddBoundedFieldSet::getBBox);
+    clsSet.def("getCoaddWcs", &CoaddBoundedFieldSet::getCoaddWcs);
+    clsSet.def("getDefault", &CoaddBoundedFieldSet::getDefault);
+    clsSet.def("getElements", &CoaddBoundedFieldSet::getElements);
+    clsSet.def("getElementCount", &CoaddBoundedFieldSet::getElementCount);
+    clsSet.def("isPersistable", &CoaddBoundedFieldSet::isPersistable);
+
+    afw::table::io::python::declarePersistableFacade<CoaddBoundedFieldSetMember>(mod,
+                                                                                "CoaddBoundedFieldSetMember");
+
+    py::class_<CoaddBoundedFieldSetMember, std::shared_ptr<CoaddBoundedFieldSetMember>,
+               afw::table::io::PersistableFacade<CoaddBoundedFieldSetMember>, afw::math::BoundedField>
+            clsMember(mod, "CoaddBoundedFieldSetMember");
+
+    /* Constructors */
+    clsMember.def(py::init<std::shared_ptr<CoaddBoundedFieldSet const>, std::size_t>(), "set"_a, "index"_a);
+
+    /* Operators */
+    clsMember.def("__eq__", &CoaddBoundedFieldSetMember::operator==, py::is_operator());
+    clsMember.def("__ne__", &CoaddBoundedFieldSetMember::operator!=, py::is_operator());
+    clsMember.def("__imul__", &CoaddBoundedFieldSetMember::operator*);
+
+    /* Members */
+    clsMember.def("evaluate", py::overload_cast<geom::Point2D const &>(&CoaddBoundedFieldSetMember::evaluate,
+                                                                      py::const_));
+    clsMember.def("evaluate",
+                  py::overload_cast<ndarray::Array<double const, 1> const &,
+                                    ndarray::Array<double const, 1> const &>(
+                          &CoaddBoundedFieldSetMember::evaluate, py::const_),
+                  "x"_a, "y"_a);
+    clsMember.def("evaluate",
+                  [](CoaddBoundedFieldSetMember const &self, double x, double y) {
+                      return self.evaluate(geom::Point2D(x, y));
+                  },
+                  "x"_a, "y"_a);
+    clsMember.def("getSet", &CoaddBoundedFieldSetMember::getSet);
+    clsMember.def("getIndex", &CoaddBoundedFieldSetMember::getIndex);
+    clsMember.def("getName", &CoaddBoundedFieldSetMember::getName);
+    clsMember.def("isPersistable", &CoaddBoundedFieldSetMember::isPersistable);
+}
+
+}  // namespace
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,63 @@
+/*
+ * LSST Data Management System
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ * See the COPYRIGHT file
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include "lsst/meas/algorithms/CoaddInputIndex.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+namespace {
+
+PYBIND11_MODULE(coaddInputIndex, mod) {
+    py::module::import("lsst.afw.geom");
+    py::module::import("lsst.afw.table");
+
+    py::class_<CoaddInputIndex, std::shared_ptr<CoaddInputIndex>> cls(mod, "CoaddInputIndex");
+
+    /* Constructors */
+    cls.def(py::init<std::vector<geom::Box2D> const &>(), "boxes"_a);
+    cls.def(py::init<afw::table::ExposureCatalog const &, afw::geom::SkyWcs const &>(), "catalog"_a,
+            "coaddWcs"_a);
+
+    /* Members */
+    cls.def_static("computeCoaddBBox", &CoaddInputIndex::computeCoaddBBox, "bbox"_a, "inputWcs"_a,
+                   "coaddWcs"_a);
+    cls.def("getCandidates", &CoaddInputIndex::getCandidates, "position"_a);
+    cls.def("getOverlapping", &CoaddInputIndex::getOverlapping, "box"_a);
+    cls.def("getInputBBox", &CoaddInputIndex::getInputBBox, "i"_a);
+    cls.def("getInputCount", &CoaddInputIndex::getInputCount);
+    cls.def("getCellCount", &CoaddInputIndex::getCellCount);
+    cls.def("getEntryCount", &CoaddInputIndex::getEntryCount);
+    cls.def("getMemorySize", &CoaddInputIndex::getMemorySize);
+    cls.def("getBuildTime", &CoaddInputIndex::getBuildTime);
+    cls.def("getBBox", &CoaddInputIndex::getBBox);
+}
+
+}  // namespace
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
@@ -19,6 +19,8 @@
  * the GNU General Public License along with this program.  If not,
  * see <https://www.lsstcorp.org/LegalNotices/>.
  */
+#include <memory>
+
 #include "pybind11/pybind11.h"
 
 #include "lsst/afw/table/io/python.h"
@@ -33,12 +35,32 @@ namespace meas {
 namespace algorithms {
 namespace {
 
+// A Python context manager that holds a CoaddPsf::LazyReadingScope between __enter__ and __exit__.
+class LazyReading {
+public:
+    explicit LazyReading(bool lazy) : _lazy(lazy) {}
+
+    void enter() { _scope.reset(new CoaddPsf::LazyReadingScope(_lazy)); }
+
+    void exit() { _scope.reset(); }
+
+private:
+    bool _lazy;
+    std::unique_ptr<CoaddPsf::LazyReadingScope> _scope;
+};
+
 PYBIND11_MODULE(coaddPsf, mod) {
     /* CoaddPsfControl */
     py::class_<CoaddPsfControl, std::shared_ptr<CoaddPsfControl>> clsControl(mod, "CoaddPsfControl");
-    clsControl.def(py::init<std::string, int>(), "warpingKernelName"_a = "lanczos3", "cacheSize"_a = 10000);
+    clsControl.def(py::init<std::string, int, int, double, int, bool>(), "warpingKernelName"_a = "lanczos3",
+                   "cacheSize"_a = 10000, "nThreads"_a = 1, "imageCacheTolerance"_a = 0.0,
+                   "imageCacheSizeMB"_a = 64, "useStampWarper"_a = false);
     LSST_DECLARE_CONTROL_FIELD(clsControl, CoaddPsfControl, warpingKernelName);
     LSST_DECLARE_CONTROL_FIELD(clsControl, CoaddPsfControl, cacheSize);
+    LSST_DECLARE_CONTROL_FIELD(clsControl, CoaddPsfControl, nThreads);
+    LSST_DECLARE_CONTROL_FIELD(clsControl, CoaddPsfControl, imageCacheTolerance);
+    LSST_DECLARE_CONTROL_FIELD(clsControl, CoaddPsfControl, imageCacheSizeMB);
+    LSST_DECLARE_CONTROL_FIELD(clsControl, CoaddPsfControl, useStampWarper);
 
     /* CoaddPsf */
     afw::table::io::python::declarePersistableFacade<CoaddPsf>(mod, "CoaddPsf");
@@ -60,13 +82,31 @@ PYBIND11_MODULE(coaddPsf, mod) {
     clsCoaddPsf.def("getAveragePosition", &CoaddPsf::getAveragePosition);
     clsCoaddPsf.def("getCoaddWcs", &CoaddPsf::getCoaddWcs);
     clsCoaddPsf.def("getComponentCount", &CoaddPsf::getComponentCount);
+    clsCoaddPsf.def("getLoadedComponentCount", &CoaddPsf::getLoadedComponentCount);
+    clsCoaddPsf.def_static("getLazyReading", &CoaddPsf::getLazyReading);
     clsCoaddPsf.def("getPsf", &CoaddPsf::getPsf);
     clsCoaddPsf.def("getWcs", &CoaddPsf::getWcs);
     clsCoaddPsf.def("getWeight", &CoaddPsf::getWeight);
     clsCoaddPsf.def("getId", &CoaddPsf::getId);
     clsCoaddPsf.def("getBBox", &CoaddPsf::getBBox);
     clsCoaddPsf.def("getValidPolygon", &CoaddPsf::getValidPolygon);
+    clsCoaddPsf.def("getImageCache", [](CoaddPsf const &self) {
+        return std::const_pointer_cast<PsfImageCache>(self.getImageCache());
+    });
+    clsCoaddPsf.def("getControl", &CoaddPsf::getControl);
+    clsCoaddPsf.def("withControl", &CoaddPsf::withControl, "ctrl"_a);
+    clsCoaddPsf.def("getInputIndex", &CoaddPsf::getInputIndex, py::return_value_policy::reference_internal);
     clsCoaddPsf.def("isPersistable", &CoaddPsf::isPersistable);
+
+    py::class_<LazyReading> clsLazyReading(clsCoaddPsf, "LazyReading");
+    clsLazyReading.def(py::init<bool>(), "lazy"_a = true);
+    clsLazyReading.def("__enter__",
+                       [](LazyReading &self) -> LazyReading & {
+                           self.enter();
+                           return self;
+                       },
+                       py::return_value_policy::reference);
+    clsLazyReading.def("__exit__", [](LazyReading &self, py::args) { self.exit(); });
 }
 
 }  // namespace
@@ -21,6 +21,8 @@
  * see <https://www.lsstcorp.org/LegalNotices/>.
  */
 #include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+#include "ndarray/pybind11.h"
 
 #include "lsst/meas/algorithms/CoaddTransmissionCurve.h"
 
@@ -37,6 +39,8 @@ PYBIND11_MODULE(coaddTransmissionCurve, mod) {
     py::module::import("lsst.afw.image");
     py::module::import("lsst.afw.table");
     mod.def("makeCoaddTransmissionCurve", &makeCoaddTransmissionCurve, "coaddWcs"_a, "inputSensors"_a);
+    mod.def("sampleTransmissionCurveAt", &sampleTransmissionCurveAt, "curve"_a, "positions"_a,
+            "wavelengths"_a);
 }
 
 }  // namespace
@@ -22,6 +22,7 @@
 #include "pybind11/pybind11.h"
 #include "pybind11/stl.h"
 
+#include "lsst/geom/Box.h"
 #include "lsst/afw/detection/Footprint.h"
 #include "lsst/afw/detection/Psf.h"
 #include "lsst/meas/algorithms/CR.h"
@@ -34,13 +35,57 @@ namespace meas {
 namespace algorithms {
 namespace {
 
+void declareCrDetectionContext(py::module& mod) {
+    py::class_<CrDetectionContext, std::shared_ptr<CrDetectionContext>> cls(mod, "CrDetectionContext");
+
+    py::class_<CrDetectionContext::Thresholds> clsThresholds(cls, "Thresholds");
+    clsThresholds.def_readonly("horizontal", &CrDetectionContext::Thresholds::horizontal);
+    clsThresholds.def_readonly("vertical", &CrDetectionContext::Thresholds::vertical);
+    clsThresholds.def_readonly("diagonal", &CrDetectionContext::Thresholds::diagonal);
+
+    cls.def(py::init<afw::detection::Psf const&, afw::image::Mask<CrDetectionContext::MaskPixel> const&,
+                     daf::base::PropertySet const&, lsst::geom::Box2I const&, int, int>(),
+            "psf"_a, "mask"_a, "ps"_a, "bbox"_a = lsst::geom::Box2I(), "nx"_a = 1, "ny"_a = 1,
+            py::call_guard<py::gil_scoped_release>());
+
+    cls.def("getThresholds", &CrDetectionContext::getThresholds, "x"_a, "y"_a);
+    cls.def("getGridThresholds", &CrDetectionContext::getGridThresholds);
+    cls.def("getBBox", &CrDetectionContext::getBBox);
+    cls.def("getNx", &CrDetectionContext::getNx);
+    cls.def("getNy", &CrDetectionContext::getNy);
+    cls.def("getMinSigma", &CrDetectionContext::getMinSigma);
+    cls.def("getMinDn", &CrDetectionContext::getMinDn);
+    cls.def("getCond3Fac", &CrDetectionContext::getCond3Fac);
+    cls.def("getCond3Fac2", &CrDetectionContext::getCond3Fac2);
+    cls.def("getNIteration", &CrDetectionContext::getNIteration);
+    cls.def("getNCrPixelMax", &CrDetectionContext::getNCrPixelMax);
+    cls.def("getNThreads", &CrDetectionContext::getNThreads);
+    cls.def("getBadMask", &CrDetectionContext::getBadMask);
+}
+
 template <typename PixelT>
 void declareFindCosmicRays(py::module& mod) {
-    mod.def("_findCosmicRays", &findCosmicRays<afw::image::MaskedImage<PixelT>>, "image"_a, "psf"_a, "bkgd"_a,
-            "policy"_a, "keep"_a = false);
+    typedef afw::image::MaskedImage<PixelT> MaskedImageT;
+    // findCosmicRays is reentrant, so let other Python threads run (e.g. on other CCDs) while it works;
+    // it locks the Psf while evaluating it (see PsfEvaluationLock).
+    mod.def("_findCosmicRays",
+            py::overload_cast<MaskedImageT&, afw::detection::Psf const&, double const,
+                              daf::base::PropertySet const&, bool const>(&findCosmicRays<MaskedImageT>),
+            "image"_a, "psf"_a, "bkgd"_a, "policy"_a, "keep"_a = false,
+            py::call_guard<py::gil_scoped_release>());
+    mod.def("_findCosmicRays",
+            py::overload_cast<MaskedImageT&, CrDetectionContext const&, double const, bool const,
+                              daf::base::PropertySet*>(&findCosmicRays<MaskedImageT>),
+            "image"_a, "context"_a, "bkgd"_a, "keep"_a = false, "metadata"_a = nullptr,
+            py::call_guard<py::gil_scoped_release>());
 }
 
 PYBIND11_MODULE(cr, mod) {
+    py::module::import("lsst.daf.base");
+    py::module::import("lsst.afw.detection");
+    py::module::import("lsst.afw.image");
+
+    declareCrDetectionContext(mod);
     declareFindCosmicRays<float>(mod);
 }
 
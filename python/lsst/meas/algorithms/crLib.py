@@ -1,19 +1,31 @@
-__all__ = ["findCosmicRays"]
+__all__ = ["findCosmicRays", "CrDetectionContext"]
 
 import warnings
 
 import lsst.pex.policy as pexPolicy
-from .cr import _findCosmicRays
+from .cr import _findCosmicRays, CrDetectionContext
 
 
-def findCosmicRays(image, psf, bkgd, ps, keep=False):
-    """Find cosmic rays in an image."""
+def findCosmicRays(image, psf, bkgd, ps=None, keep=False, metadata=None):
+    """Find cosmic rays in an image.
+
+    ``psf`` may instead be a `CrDetectionContext` built once for the
+    exposure, in which case ``ps`` must be `None`.
+
+    If ``metadata`` (an `lsst.daf.base.PropertySet`) is given, the time
+    spent in each phase of the search and the number of CR pixels and CRs
+    found are written to it.
+    """
+    if isinstance(psf, CrDetectionContext):
+        if ps is not None:
+            raise TypeError("ps must be None when a CrDetectionContext is given")
+        return _findCosmicRays(image, psf, bkgd, keep, metadata)
     if isinstance(ps, pexPolicy.Policy):
         warnings.warn("findCosmicRays acceptance of Policy is deprecated. Use PropertySet "
                       "(support will be removed after v19.0)",
                       category=FutureWarning, stacklevel=2)
         ps = ps.asPropertySet()
+    if metadata is not None:
+        return _findCosmicRays(image, CrDetectionContext(psf, image.getMask(), ps), bkgd, keep, metadata)
     return _findCosmicRays(image, psf, bkgd, ps, keep)
 
-
-findCosmicRays.__doc__ = _findCosmicRays.__doc__
@@ -39,10 +39,9 @@ import lsst.geom
 import lsst.afw.table
 import lsst.afw.detection
 import lsst.afw.image
-import lsst.afw.geom
 from lsst.daf.base import PropertyList
 
-from . import Defect
+from . import Defect, CompiledDefectMap, maskBoxes, boxesFromMask
 
 log = logging.getLogger(__name__)
 
@@ -217,6 +216,24 @@ class Defects(collections.abc.MutableSequence):
             retDefectList.append(nbbox)
         return retDefectList
 
+    def compile(self, bbox):
+        """Compile these defects for interpolating over images with a
+        given bounding box.
+
+        Parameters
+        ----------
+        bbox : `lsst.geom.Box2I`
+            Bounding box of the images to be interpolated.
+
+        Returns
+        -------
+        defectMap : `CompiledDefectMap`
+            The clipped, merged and classified defects; this may be
+            pickled and passed to `interpolateOverDefects` in place of
+            the psf and list of defects for any image with ``bbox``.
+        """
+        return CompiledDefectMap(list(self), bbox)
+
     def maskPixels(self, maskedImage, maskName="BAD"):
         """Set mask plane based on these defects.
 
@@ -230,9 +247,7 @@ class Defects(collections.abc.MutableSequence):
         # mask bad pixels
         mask = maskedImage.getMask()
         bitmask = mask.getPlaneBitMask(maskName)
-        for defect in self:
-            bbox = defect.getBBox()
-            lsst.afw.geom.SpanSet(bbox).clippedTo(mask.getBBox()).setMask(mask, bitmask)
+        maskBoxes(mask, [defect.getBBox() for defect in self], bitmask)
 
     def toFitsRegionTable(self):
         """Convert defect list to `~lsst.afw.table.BaseCatalog` using the
@@ -669,7 +684,4 @@ class Defects(collections.abc.MutableSequence):
             Defect list constructed from masked pixels.
         """
         mask = maskedImage.getMask()
-        thresh = lsst.afw.detection.Threshold(mask.getPlaneBitMask(maskName),
-                                              lsst.afw.detection.Threshold.BITMASK)
-        fpList = lsst.afw.detection.FootprintSet(mask, thresh).getFootprints()
-        return cls.fromFootprintList(fpList)
+        return cls(boxesFromMask(mask, mask.getPlaneBitMask(maskName)))
@@ -38,6 +38,8 @@ import lsst.afw.table as afwTable
 import lsst.pex.config as pexConfig
 import lsst.pipe.base as pipeBase
 from .subtractBackground import SubtractBackgroundTask
+from .detectionSmoother import DetectionSmootherF, DetectionSmootherD
+from .fusedDetection import thresholdFootprints, growFootprints, FootprintStitcher
 
 
 class SourceDetectionConfig(pexConfig.Config):
@@ -143,6 +145,39 @@ class SourceDetectionConfig(pexConfig.Config):
         doc="Mask planes to ignore when calculating statistics of image (for thresholdType=stdev)",
         default=['BAD', 'SAT', 'EDGE', 'NO_DATA'],
     )
+    doFastSmoothing = pexConfig.Field(
+        dtype=bool,
+        doc=("Smooth with the separable, multithreaded DetectionSmoother rather than afwMath.convolve? "
+             "The smoothed image is written into a buffer that is reused by the next call to convolveImage."),
+        default=False,
+    )
+    nSmoothingThreads = pexConfig.RangeField(
+        dtype=int,
+        doc="Number of threads used to smooth the image (if doFastSmoothing)",
+        default=1, min=1,
+    )
+    doSmoothVariance = pexConfig.Field(
+        dtype=bool,
+        doc=("Smooth the variance plane even if thresholdType doesn't use it? Only used if doFastSmoothing; "
+             "when False, the smoothed variance is NaN unless thresholdType is 'variance' or 'pixel_stdev'."),
+        default=True,
+    )
+    doFusedDetection = pexConfig.Field(
+        dtype=bool,
+        doc=("Find the positive and negative footprints in a single pass over the smoothed image, and grow "
+             "them, with thresholdFootprints and growFootprints rather than afw.detection.FootprintSet? "
+             "Not used if thresholdType is 'variance'."),
+        default=False,
+    )
+    tileSize = pexConfig.RangeField(
+        dtype=int,
+        doc=("If positive, smooth and threshold the image in square tiles of this size (each with a halo of "
+             "half the smoothing kernel), joining the footprints across the tile boundaries, so that no "
+             "full-sized smoothed copy of the image is made. The temporary wide and local backgrounds are "
+             "not applied, a 'stdev' threshold is set from the noise in each tile, and 'variance' thresholds "
+             "are not supported."),
+        default=0, min=0,
+    )
 
     def setDefaults(self):
         self.tempLocalBackground.binSize = 64
@@ -293,6 +328,7 @@ into your debug.py file and run measAlgTasks.py with the @c --debug flag.
             self.makeSubtask("tempLocalBackground")
         if self.config.doTempWideBackground:
             self.makeSubtask("tempWideBackground")
+        self._smoothingBuffer = None
 
     @pipeBase.timeMethod
     def run(self, table, exposure, doSmooth=True, sigma=None, clearMask=True, expId=None):
@@ -537,7 +573,10 @@ into your debug.py file and run measAlgTasks.py with the @c --debug flag.
         Return Struct contents
         ----------------------
         middle : `lsst.afw.image.MaskedImage`
-            Convolved image, without the edges.
+            Convolved image, without the edges.  If ``doFastSmoothing``,
+            this is a view of a buffer that the next call to
+            ``convolveImage`` overwrites; copy it (e.g. with
+            ``middle.Factory(middle, True)``) to keep it past that call.
         sigma : `float`
             Gaussian sigma used for the convolution.
         """
@@ -553,16 +592,10 @@ into your debug.py file and run measAlgTasks.py with the @c --debug flag.
         # Make a SingleGaussian (separable) kernel with the 'sigma'
         kWidth = self.calculateKernelSize(sigma)
         self.metadata.set("smoothingKernelWidth", kWidth)
-        gaussFunc = afwMath.GaussianFunction1D(sigma)
-        gaussKernel = afwMath.SeparableKernel(kWidth, kWidth, gaussFunc, gaussFunc)
-
-        convolvedImage = maskedImage.Factory(maskedImage.getBBox())
-
-        afwMath.convolve(convolvedImage, maskedImage, gaussKernel, afwMath.ConvolutionControl())
+        convolvedImage, goodBBox = self._smooth(maskedImage, sigma, kWidth)
         #
         # Only search psf-smoothed part of frame
         #
-        goodBBox = gaussKernel.shrinkBBox(convolvedImage.getBBox())
         middle = convolvedImage.Factory(convolvedImage, goodBBox, afwImage.PARENT, False)
         #
         # Mark the parts of the image outside goodBBox as EDGE
@@ -571,6 +604,58 @@ into your debug.py file and run measAlgTasks.py with the @c --debug flag.
 
         return pipeBase.Struct(middle=middle, sigma=sigma)
 
+    def _smooth(self, maskedImage, sigma, kWidth):
+        """Smooth an image with a Gaussian
+
+        Parameters
+        ----------
+        maskedImage : `lsst.afw.image.MaskedImage`
+            Image to smooth.
+        sigma : `float`
+            Gaussian sigma.
+        kWidth : `int`
+            Width of the (odd-sized) kernel.
+
+        Returns
+        -------
+        convolvedImage : `lsst.afw.image.MaskedImage`
+            Smoothed image; if ``doFastSmoothing``, it is overwritten by
+            the next call.
+        goodBBox : `lsst.geom.Box2I`
+            Part of ``convolvedImage`` not affected by the edges.
+        """
+        if self.config.doFastSmoothing:
+            convolvedImage = self._getSmoothingBuffer(maskedImage)
+            if isinstance(maskedImage, afwImage.MaskedImageD):
+                smoother = DetectionSmootherD(sigma, kWidth, self.config.nSmoothingThreads)
+            else:
+                smoother = DetectionSmootherF(sigma, kWidth, self.config.nSmoothingThreads)
+            doSmoothVariance = (self.config.doSmoothVariance or
+                                self.config.thresholdType in ("variance", "pixel_stdev"))
+            smoother.smooth(maskedImage, convolvedImage, doSmoothVariance)
+            goodBBox = smoother.getGoodBBox(convolvedImage.getBBox())
+        else:
+            gaussFunc = afwMath.GaussianFunction1D(sigma)
+            gaussKernel = afwMath.SeparableKernel(kWidth, kWidth, gaussFunc, gaussFunc)
+
+            convolvedImage = maskedImage.Factory(maskedImage.getBBox())
+
+            afwMath.convolve(convolvedImage, maskedImage, gaussKernel, afwMath.ConvolutionControl())
+            goodBBox = gaussKernel.shrinkBBox(convolvedImage.getBBox())
+        return convolvedImage, goodBBox
+
+    def _getSmoothingBuffer(self, maskedImage):
+        """Return a MaskedImage to smooth ``maskedImage`` into, reusing
+        the one from the previous call if it has the same type and
+        bounding box.
+        """
+        buffer = self._smoothingBuffer
+        if (buffer is None or type(buffer) is not type(maskedImage) or
+                buffer.getBBox() != maskedImage.getBBox()):
+            buffer = maskedImage.Factory(maskedImage.getBBox())
+            self._smoothingBuffer = buffer
+        return buffer
+
     def applyThreshold(self, middle, bbox, factor=1.0):
         """Apply thresholds to the convolved image
 
@@ -599,6 +684,23 @@ into your debug.py file and run measAlgTasks.py with the @c --debug flag.
         """
         results = pipeBase.Struct(positive=None, negative=None, factor=factor)
         # Detect the Footprints (peaks may be replaced if doTempLocalBackground)
+        if self.config.doFusedDetection and self.config.thresholdType != "variance":
+            doPositive = self.config.reEstimateBackground or self.config.thresholdPolarity != "negative"
+            doNegative = self.config.reEstimateBackground or self.config.thresholdPolarity != "positive"
+            positive = self.makeThreshold(middle, "positive", factor=factor)
+            negative = None
+            if doNegative:
+                # Same threshold with the opposite polarity, without measuring the image again
+                negative = afwDet.Threshold(positive.getValue(), positive.getType(), False,
+                                            positive.getIncludeMultiplier())
+            results.positive, results.negative = thresholdFootprints(
+                middle,
+                positive if doPositive else None,
+                negative,
+                self.config.minPixels,
+                bbox
+            )
+            return results
         if self.config.reEstimateBackground or self.config.thresholdPolarity != "negative":
             threshold = self.makeThreshold(middle, "positive", factor=factor)
             results.positive = afwDet.FootprintSet(
@@ -643,23 +745,38 @@ into your debug.py file and run measAlgTasks.py with the @c --debug flag.
         factor : `float`
             Multiplier for the configured threshold.
         """
-        for polarity, maskName in (("positive", "DETECTED"), ("negative", "DETECTED_NEGATIVE")):
-            fpSet = getattr(results, polarity)
-            if fpSet is None:
-                continue
+        if self.config.doFusedDetection:
+            nGrow = 0
             if self.config.nSigmaToGrow > 0:
                 nGrow = int((self.config.nSigmaToGrow * sigma) + 0.5)
                 self.metadata.set("nGrow", nGrow)
-                if self.config.combinedGrow:
-                    fpSet = afwDet.FootprintSet(fpSet, nGrow, self.config.isotropicGrow)
-                else:
-                    stencil = (afwGeom.Stencil.CIRCLE if self.config.isotropicGrow else
-                               afwGeom.Stencil.MANHATTAN)
-                    for fp in fpSet:
-                        fp.dilate(nGrow, stencil)
-            fpSet.setMask(mask, maskName)
-            if not self.config.returnOriginalFootprints:
-                setattr(results, polarity, fpSet)
+            results.positive, results.negative = growFootprints(
+                results.positive,
+                results.negative,
+                mask,
+                nGrow,
+                self.config.isotropicGrow,
+                self.config.combinedGrow,
+                self.config.returnOriginalFootprints
+            )
+        else:
+            for polarity, maskName in (("positive", "DETECTED"), ("negative", "DETECTED_NEGATIVE")):
+                fpSet = getattr(results, polarity)
+                if fpSet is None:
+                    continue
+                if self.config.nSigmaToGrow > 0:
+                    nGrow = int((self.config.nSigmaToGrow * sigma) + 0.5)
+                    self.metadata.set("nGrow", nGrow)
+                    if self.config.combinedGrow:
+                        fpSet = afwDet.FootprintSet(fpSet, nGrow, self.config.isotropicGrow)
+                    else:
+                        stencil = (afwGeom.Stencil.CIRCLE if self.config.isotropicGrow else
+                                   afwGeom.Stencil.MANHATTAN)
+                        for fp in fpSet:
+                            fp.dilate(nGrow, stencil)
+                fpSet.setMask(mask, maskName)
+                if not self.config.returnOriginalFootprints:
+                    setattr(results, polarity, fpSet)
 
         results.numPos = 0
         results.numPosPeaks = 0
@@ -784,6 +901,8 @@ into your debug.py file and run measAlgTasks.py with the @c --debug flag.
             self.clearMask(maskedImage.getMask())
 
         psf = self.getPsf(exposure, sigma=sigma)
+        if self.config.tileSize > 0:
+            return self.detectFootprintsTiled(exposure, psf, doSmooth=doSmooth)
         with self.tempWideBackgroundContext(exposure):
             convolveResults = self.convolveImage(maskedImage, psf, doSmooth=doSmooth)
             middle = convolveResults.middle
@@ -803,6 +922,97 @@ into your debug.py file and run measAlgTasks.py with the @c --debug flag.
 
         return results
 
+    def detectFootprintsTiled(self, exposure, psf, doSmooth=True):
+        """Detect footprints on an exposure a tile at a time
+
+        Each tile of ``tileSize`` pixels is smoothed with a halo of half
+        the kernel width (plus a pixel, so that peaks on a tile's boundary
+        are compared with their neighbours in the next one), and its core is
+        thresholded into a `FootprintStitcher`, which joins the footprints
+        that cross the tile boundaries. Only one tile's smoothed image is
+        held at a time. Within the image the footprints are the same as
+        those found by smoothing the whole image, provided the threshold
+        doesn't depend on the noise in each tile.
+
+        The footprints are then grown and the mask set as usual by
+        `finalizeFootprints`. The temporary wide and local backgrounds are
+        not applied.
+
+        Parameters
+        ----------
+        exposure : `lsst.afw.image.Exposure`
+            Exposure to process; DETECTED{,_NEGATIVE} mask plane will be
+            set in-place.
+        psf : `lsst.afw.detection.Psf`
+            Gaussian PSF to smooth with, from `getPsf`.
+        doSmooth : `bool`, optional
+            If True, smooth the image before detection.
+
+        Returns
+        -------
+        results : `lsst.pipe.base.Struct`
+            As for `detectFootprints`.
+        """
+        if self.config.doTempWideBackground or self.config.doTempLocalBackground:
+            self.log.warn("Temporary wide and local backgrounds are not applied when detecting in tiles")
+        maskedImage = exposure.maskedImage
+        bbox = maskedImage.getBBox()
+        sigma = psf.computeShape().getDeterminantRadius()
+        self.metadata.set("doSmooth", doSmooth)
+        self.metadata.set("sigma", sigma)
+
+        halo = 0
+        goodBBox = bbox
+        if doSmooth:
+            kWidth = self.calculateKernelSize(sigma)
+            self.metadata.set("smoothingKernelWidth", kWidth)
+            halo = kWidth//2
+            goodBBox = lsst.geom.Box2I(bbox)
+            goodBBox.grow(-halo)
+            self.setEdgeBits(maskedImage, goodBBox, maskedImage.getMask().getPlaneBitMask("EDGE"))
+
+        doPositive = self.config.reEstimateBackground or self.config.thresholdPolarity != "negative"
+        doNegative = self.config.reEstimateBackground or self.config.thresholdPolarity != "positive"
+        positive = FootprintStitcher(bbox, True) if doPositive else None
+        negative = FootprintStitcher(bbox, False) if doNegative else None
+
+        tileSize = self.config.tileSize
+        for y0 in range(goodBBox.getMinY(), goodBBox.getEndY(), tileSize):
+            for x0 in range(goodBBox.getMinX(), goodBBox.getEndX(), tileSize):
+                core = lsst.geom.Box2I(lsst.geom.Point2I(x0, y0), lsst.geom.Extent2I(tileSize, tileSize))
+                core.clip(goodBBox)
+                tileBBox = lsst.geom.Box2I(core)
+                tileBBox.grow(halo + 1)
+                tileBBox.clip(bbox)
+                tile = maskedImage.Factory(maskedImage, tileBBox, afwImage.PARENT, False)
+                if doSmooth:
+                    convolvedImage, tileGoodBBox = self._smooth(tile, sigma, kWidth)
+                    middle = convolvedImage.Factory(convolvedImage, tileGoodBBox, afwImage.PARENT, False)
+                else:
+                    middle = tile
+
+                threshold = self.makeThreshold(middle, "positive")
+                if positive is not None:
+                    positive.addTile(middle, core, threshold)
+                if negative is not None:
+                    negative.addTile(middle, core, afwDet.Threshold(threshold.getValue(), threshold.getType(),
+                                                                    False, threshold.getIncludeMultiplier()))
+
+        results = pipeBase.Struct(positive=None, negative=None, factor=1.0,
+                                  background=afwMath.BackgroundList())
+        if positive is not None:
+            results.positive = positive.makeFootprintSet(self.config.minPixels)
+        if negative is not None:
+            results.negative = negative.makeFootprintSet(self.config.minPixels)
+        self.finalizeFootprints(maskedImage.mask, results, sigma)
+
+        if self.config.reEstimateBackground:
+            self.reEstimateBackground(maskedImage, results.background)
+
+        self.clearUnwantedResults(maskedImage.getMask(), results)
+        self.display(exposure, results)
+        return results
+
     def makeThreshold(self, image, thresholdParity, factor=1.0):
         """Make an afw.detection.Threshold object corresponding to the task's
         configuration and the statistics of the given image.
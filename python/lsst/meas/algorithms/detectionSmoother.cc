@@ -0,0 +1,61 @@
+/*
+ * LSST Data Management System
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ * See the COPYRIGHT file
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include "lsst/meas/algorithms/DetectionSmoother.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+namespace {
+
+template <typename PixelT>
+void declareDetectionSmoother(py::module &mod, std::string const &suffix) {
+    typedef DetectionSmoother<PixelT> Class;
+    py::class_<Class, std::shared_ptr<Class>> cls(mod, ("DetectionSmoother" + suffix).c_str());
+
+    cls.def(py::init<double, int, int>(), "sigma"_a, "width"_a, "nThreads"_a = 1);
+
+    cls.def("smooth", &Class::smooth, "src"_a, "dest"_a, "doSmoothVariance"_a = true,
+            py::call_guard<py::gil_scoped_release>());
+    cls.def("getGoodBBox", &Class::getGoodBBox, "bbox"_a);
+    cls.def("getSigma", &Class::getSigma);
+    cls.def("getWidth", &Class::getWidth);
+    cls.def("getNThreads", &Class::getNThreads);
+    cls.def("getKernel", &Class::getKernel);
+}
+
+PYBIND11_MODULE(detectionSmoother, mod) {
+    py::module::import("lsst.afw.image");
+
+    declareDetectionSmoother<float>(mod, "F");
+    declareDetectionSmoother<double>(mod, "D");
+}
+
+}  // namespace
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
@@ -27,6 +27,12 @@ class DynamicDetectionConfig(SourceDetectionConfig):
     minNumSources = Field(dtype=int, default=10,
                           doc="Minimum number of sky sources in statistical sample; "
                               "if below this number, we refuse to modify the threshold.")
+    doReuseSmoothedImage = Field(dtype=bool, default=False,
+                                 doc="For the background tweak, re-threshold the smoothed image from the "
+                                     "first pass, corrected for any (smooth) backgrounds added or removed "
+                                     "since, rather than smoothing the image again?  This is faster, but "
+                                     "approximate: the background changes are not smoothed, and are "
+                                     "ignored in NO_DATA pixels.")
 
     def setDefaults(self):
         SourceDetectionConfig.setDefaults(self)
@@ -143,7 +149,8 @@ class DynamicDetectionTask(SourceDetectionTask):
         This varies from the vanilla ``detectFootprints`` method because we
         do detection twice: one with a low threshold so that we can find
         sky uncontaminated by objects, then one more with the new calculated
-        threshold.
+        threshold.  Both passes threshold the same smoothed image, as does
+        the detection for the background tweak if ``doReuseSmoothedImage``.
 
         Parameters
         ----------
@@ -200,6 +207,12 @@ class DynamicDetectionTask(SourceDetectionTask):
             convolveResults = self.convolveImage(maskedImage, psf, doSmooth=doSmooth)
             middle = convolveResults.middle
             sigma = convolveResults.sigma
+            reuseSmoothed = self.config.doBackgroundTweak and self.config.doReuseSmoothedImage
+            if reuseSmoothed:
+                # Snapshots of the smoothed image (which the temporary local background will modify) and of
+                # the pixels it was made from, so the background tweak can re-threshold it
+                smoothedArray = middle.image.array.copy()
+                unsmoothedArray = self._getImageArray(maskedImage, middle.getBBox()).copy()
             prelim = self.applyThreshold(middle, maskedImage.getBBox(), self.config.prelimThresholdFactor)
             self.finalizeFootprints(maskedImage.mask, prelim, sigma, self.config.prelimThresholdFactor)
 
@@ -241,8 +254,18 @@ class DynamicDetectionTask(SourceDetectionTask):
             originalMask = maskedImage.mask.array.copy()
             try:
                 self.clearMask(exposure.mask)
-                convolveResults = self.convolveImage(maskedImage, psf, doSmooth=doSmooth)
-                tweakDetResults = self.applyThreshold(convolveResults.middle, maskedImage.getBBox(), factor)
+                if reuseSmoothed:
+                    # The backgrounds restored or subtracted since we smoothed are smooth on the scale of the
+                    # PSF, so smoothing them again changes them little: add them straight to the old image.
+                    delta = self._getImageArray(maskedImage, middle.getBBox()) - unsmoothedArray
+                    noDataBit = maskedImage.mask.getPlaneBitMask("NO_DATA")
+                    noData = self._getMaskArray(maskedImage, middle.getBBox()) & noDataBit > 0
+                    delta[noData] = 0.0  # filled with the median by tempWideBackgroundContext
+                    middle.image.array[:] = smoothedArray + delta
+                    tweakMiddle = middle
+                else:
+                    tweakMiddle = self.convolveImage(maskedImage, psf, doSmooth=doSmooth).middle
+                tweakDetResults = self.applyThreshold(tweakMiddle, maskedImage.getBBox(), factor)
                 self.finalizeFootprints(maskedImage.mask, tweakDetResults, sigma, factor)
                 bgLevel = self.calculateThreshold(exposure, seed, sigma=sigma).additive
             finally:
@@ -251,6 +274,22 @@ class DynamicDetectionTask(SourceDetectionTask):
 
         return results
 
+    @staticmethod
+    def _getImageArray(maskedImage, bbox):
+        """Return a view of the image pixels of ``maskedImage`` within
+        ``bbox`` (in ``PARENT`` coordinates) as an array
+        """
+        image = maskedImage.image
+        return image.Factory(image, bbox, lsst.afw.image.PARENT, False).array
+
+    @staticmethod
+    def _getMaskArray(maskedImage, bbox):
+        """Return a view of the mask pixels of ``maskedImage`` within
+        ``bbox`` (in ``PARENT`` coordinates) as an array
+        """
+        mask = maskedImage.mask
+        return mask.Factory(mask, bbox, lsst.afw.image.PARENT, False).array
+
     def tweakBackground(self, exposure, bgLevel, bgList=None):
         """Modify the background by a constant value
 
@@ -57,6 +57,11 @@ class FindCosmicRaysConfig(pexConfig.Config):
         doc="number of times to look for contaminated pixels near known CR pixels",
         default=3,
     )
+    nThreads = pexConfig.Field(
+        dtype=int,
+        doc="number of threads used for the initial search; the results don't depend on it",
+        default=1,
+    )
     keepCRs = pexConfig.Field(
         dtype=bool,
         doc="Don't interpolate over CR pixels",
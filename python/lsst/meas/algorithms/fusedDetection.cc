@@ -0,0 +1,74 @@
+/*
+ * LSST Data Management System
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ * See the COPYRIGHT file
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include "lsst/meas/algorithms/FusedDetection.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+namespace {
+
+template <typename PixelT>
+void declareFusedDetection(py::module &mod) {
+    mod.def("thresholdFootprints", &thresholdFootprints<PixelT>, "image"_a, "positive"_a, "negative"_a,
+            "minPixels"_a, "region"_a, py::call_guard<py::gil_scoped_release>());
+    mod.def("detectFootprints", &detectFootprints<PixelT>, "image"_a, "mask"_a, "positive"_a, "negative"_a,
+            "minPixels"_a, "region"_a, "nGrow"_a, "isotropic"_a, "combined"_a, "returnOriginal"_a = false,
+            py::call_guard<py::gil_scoped_release>());
+}
+
+template <typename PixelT>
+void declareAddTile(py::class_<FootprintStitcher, std::shared_ptr<FootprintStitcher>> &cls) {
+    cls.def("addTile", &FootprintStitcher::addTile<PixelT>, "image"_a, "core"_a, "threshold"_a,
+            py::call_guard<py::gil_scoped_release>());
+}
+
+PYBIND11_MODULE(fusedDetection, mod) {
+    py::module::import("lsst.afw.detection");
+    py::module::import("lsst.afw.image");
+
+    declareFusedDetection<float>(mod);
+    declareFusedDetection<double>(mod);
+    mod.def("growFootprints", &growFootprints, "positive"_a, "negative"_a, "mask"_a, "nGrow"_a,
+            "isotropic"_a, "combined"_a, "returnOriginal"_a = false,
+            py::call_guard<py::gil_scoped_release>());
+
+    py::class_<FootprintStitcher, std::shared_ptr<FootprintStitcher>> cls(mod, "FootprintStitcher");
+    cls.def(py::init<geom::Box2I const &, bool>(), "region"_a, "polarity"_a);
+    declareAddTile<float>(cls);
+    declareAddTile<double>(cls);
+    cls.def("makeFootprintSet", &FootprintStitcher::makeFootprintSet, "minPixels"_a,
+            py::call_guard<py::gil_scoped_release>());
+    cls.def("getRegion", &FootprintStitcher::getRegion);
+    cls.def("getPolarity", &FootprintStitcher::getPolarity);
+    cls.def("getSpanCount", &FootprintStitcher::getSpanCount);
+}
+
+}  // namespace
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
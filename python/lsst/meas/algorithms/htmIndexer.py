@@ -20,7 +20,9 @@
 # the GNU General Public License along with this program.  If not,
 # see <https://www.lsstcorp.org/LegalNotices/>.
 #
-import esutil
+import numpy as np
+
+from .htmMesh import HtmMesh
 
 
 class HtmIndexer:
@@ -31,9 +33,17 @@ class HtmIndexer:
     ----------
     depth : `int`
         Depth of the HTM hierarchy to construct.
+    nThreads : `int`
+        Number of threads to use when indexing points.
+
+    Notes
+    -----
+    Shard IDs are identical to those computed by ``esutil.htm``, so
+    catalogs ingested with either remain interchangeable.
     """
-    def __init__(self, depth=8):
-        self.htm = esutil.htm.HTM(depth)
+    def __init__(self, depth=8, nThreads=1):
+        self.htm = HtmMesh(depth)
+        self.nThreads = nThreads
 
     def getShardIds(self, ctrCoord, radius):
         """Get the IDs of all shards that touch a circular aperture.
@@ -56,31 +66,47 @@ class HtmIndexer:
                 For each shard in ``shardIdList`` is the shard on the
                 boundary (not fully enclosed by the search region)?
         """
-        shardIdList = self.htm.intersect(ctrCoord.getLongitude().asDegrees(),
-                                         ctrCoord.getLatitude().asDegrees(),
-                                         radius.asDegrees(), inclusive=True)
-        coveredShardIdList = self.htm.intersect(ctrCoord.getLongitude().asDegrees(),
-                                                ctrCoord.getLatitude().asDegrees(),
-                                                radius.asDegrees(), inclusive=False)
-        isOnBoundary = (shardId not in coveredShardIdList for shardId in shardIdList)
-        return shardIdList, isOnBoundary
+        return self.htm.getCircleCover(ctrCoord, radius)
+
+    def getShardIdsInPolygon(self, vertices):
+        """Get the IDs of all shards that touch a convex polygon.
+
+        Parameters
+        ----------
+        vertices : `list` of `lsst.geom.SpherePoint`
+            ICRS vertices of the polygon, in either winding order.
+
+        Returns
+        -------
+        results : `tuple`
+            A tuple containing:
+
+            - shardIdList : `list` of `int`
+                List of shard IDs
+            - isOnBoundary : `list` of `bool`
+                For each shard in ``shardIdList`` is the shard on the
+                boundary (not fully enclosed by the search region)?
+        """
+        return self.htm.getPolygonCover(vertices)
 
     def indexPoints(self, raList, decList):
         """Generate shard IDs for sky positions.
 
         Parameters
         ----------
-        raList : `list` of `float`
+        raList : array-like of `float`
             List of right ascensions, in degrees.
-        decList : `list` of `float`
+        decList : array-like of `float`
             List of declinations, in degrees.
 
         Returns
         -------
-        shardIds : `list` of `int`
+        shardIds : `numpy.ndarray` of `int`
             List of shard IDs
         """
-        return self.htm.lookup_id(raList, decList)
+        return self.htm.indexPoints(np.ascontiguousarray(raList, dtype=np.float64),
+                                    np.ascontiguousarray(decList, dtype=np.float64),
+                                    self.nThreads)
 
     @staticmethod
     def makeDataId(shardId, datasetName):
@@ -0,0 +1,53 @@
+/*
+ * LSST Data Management System
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ * See the COPYRIGHT file
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+#include "ndarray/pybind11.h"
+
+#include "lsst/meas/algorithms/HtmMesh.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+namespace {
+
+PYBIND11_MODULE(htmMesh, mod) {
+    py::module::import("lsst.geom");
+
+    py::class_<HtmMesh> cls(mod, "HtmMesh");
+    cls.def(py::init<int>(), "depth"_a);
+    cls.attr("MAX_DEPTH") = py::int_(HtmMesh::MAX_DEPTH);
+    cls.def("getDepth", &HtmMesh::getDepth);
+    cls.def("indexPoint", &HtmMesh::indexPoint, "ra"_a, "dec"_a);
+    cls.def("indexPoints", &HtmMesh::indexPoints, "ra"_a, "dec"_a, "nThreads"_a = 1,
+            py::call_guard<py::gil_scoped_release>());
+    cls.def("getCircleCover", &HtmMesh::getCircleCover, "center"_a, "radius"_a);
+    cls.def("getPolygonCover", &HtmMesh::getPolygonCover, "vertices"_a);
+}
+
+}  // namespace
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
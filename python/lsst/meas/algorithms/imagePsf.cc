@@ -19,10 +19,20 @@
  * the GNU General Public License along with this program.  If not,
  * see <https://www.lsstcorp.org/LegalNotices/>.
  */
+#include <functional>
+#include <limits>
+
 #include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include "ndarray/pybind11.h"
 
+#include "lsst/afw/detection/Psf.h"
 #include "lsst/afw/table/io/python.h"
 #include "lsst/meas/algorithms/ImagePsf.h"
+#include "lsst/meas/algorithms/PsfEvaluationLock.h"
+#include "lsst/meas/algorithms/PsfImageCache.h"
+#include "lsst/meas/algorithms/PsfResultCache.h"
 
 namespace py = pybind11;
 using namespace pybind11::literals;
@@ -32,14 +42,84 @@ namespace meas {
 namespace algorithms {
 namespace {
 
+// Return a function that calls a const member function of Class with the object's PsfEvaluationLock held.
+template <typename Class, typename Result, typename... Params>
+std::function<Result(Class const &, Params...)> locked(Result (Class::*method)(Params...) const) {
+    return [method](Class const &self, Params... params) {
+        PsfEvaluationLock lock(self);
+        return (self.*method)(params...);
+    };
+}
+
+/*
+ * Rebind afw's Psf evaluation methods so that they release the GIL, letting Python threads evaluate
+ * Psfs (e.g. of different CCDs) concurrently.  afw's caches of the images a Psf computes are not locked,
+ * so each Psf is locked while it is evaluated (see PsfEvaluationLock); Python implementations of Psf
+ * methods reacquire the GIL.
+ */
+template <typename Class, typename... Args>
+void declareEvaluation(py::class_<Class, Args...> &cls) {
+    using afw::detection::Psf;
+    geom::Point2D const nullPoint(std::numeric_limits<double>::quiet_NaN());
+    cls.def("computeImage", locked(&Psf::computeImage), "position"_a = nullPoint,
+            "color"_a = afw::image::Color(), "owner"_a = Psf::COPY, py::call_guard<py::gil_scoped_release>());
+    cls.def("computeKernelImage", locked(&Psf::computeKernelImage), "position"_a = nullPoint,
+            "color"_a = afw::image::Color(), "owner"_a = Psf::COPY, py::call_guard<py::gil_scoped_release>());
+    cls.def("computePeak", locked(&Psf::computePeak), "position"_a = nullPoint,
+            "color"_a = afw::image::Color(), py::call_guard<py::gil_scoped_release>());
+    cls.def("computeApertureFlux", locked(&Psf::computeApertureFlux), "radius"_a, "position"_a = nullPoint,
+            "color"_a = afw::image::Color(), py::call_guard<py::gil_scoped_release>());
+    cls.def("computeShape", locked(&Psf::computeShape), "position"_a = nullPoint,
+            "color"_a = afw::image::Color(), py::call_guard<py::gil_scoped_release>());
+    cls.def("computeBBox", locked(&Psf::computeBBox), "position"_a = nullPoint,
+            "color"_a = afw::image::Color(), py::call_guard<py::gil_scoped_release>());
+    cls.def("getLocalKernel", locked(&Psf::getLocalKernel), "position"_a = nullPoint,
+            "color"_a = afw::image::Color(), py::call_guard<py::gil_scoped_release>());
+}
+
 PYBIND11_MODULE(imagePsf, mod) {
     py::module::import("lsst.afw.detection");
+    py::module::import("lsst.afw.image");
+
+    py::class_<PsfImageCache, std::shared_ptr<PsfImageCache>> clsPsfImageCache(mod, "PsfImageCache");
+    clsPsfImageCache.def(py::init<double, std::size_t>(), "tolerance"_a, "maxBytes"_a);
+    clsPsfImageCache.def("getTolerance", &PsfImageCache::getTolerance);
+    clsPsfImageCache.def("getMaxBytes", &PsfImageCache::getMaxBytes);
+    clsPsfImageCache.def("getHits", &PsfImageCache::getHits);
+    clsPsfImageCache.def("getMisses", &PsfImageCache::getMisses);
+    clsPsfImageCache.def("getSize", &PsfImageCache::getSize);
+    clsPsfImageCache.def("getMemoryUsage", &PsfImageCache::getMemoryUsage);
+    clsPsfImageCache.def("clear", &PsfImageCache::clear);
+
+    py::class_<PsfResultCache, std::shared_ptr<PsfResultCache>> clsPsfResultCache(mod, "PsfResultCache");
+    clsPsfResultCache.def(py::init<std::size_t>(), "capacity"_a);
+    clsPsfResultCache.def("getCapacity", &PsfResultCache::getCapacity);
+    clsPsfResultCache.def("getHits", &PsfResultCache::getHits);
+    clsPsfResultCache.def("getMisses", &PsfResultCache::getMisses);
+    clsPsfResultCache.def("getSize", &PsfResultCache::getSize);
+    clsPsfResultCache.def("clear", &PsfResultCache::clear);
 
     afw::table::io::python::declarePersistableFacade<ImagePsf>(mod, "ImagePsf");
 
     py::class_<ImagePsf, std::shared_ptr<ImagePsf>, afw::table::io::PersistableFacade<ImagePsf>,
                afw::detection::Psf>
             clsImagePsf(mod, "ImagePsf");
+
+    declareEvaluation(clsImagePsf);
+    clsImagePsf.def("computeKernelImages",
+                    locked(py::overload_cast<std::vector<geom::Point2D> const &, afw::image::Color const &>(
+                            &ImagePsf::computeKernelImages, py::const_)),
+                    "positions"_a, "color"_a = afw::image::Color(), py::call_guard<py::gil_scoped_release>());
+    clsImagePsf.def("computeKernelImages",
+                    locked(py::overload_cast<std::vector<geom::Point2D> const &,
+                                             ndarray::Array<double, 3, 3> const &, afw::image::Color const &>(
+                            &ImagePsf::computeKernelImages, py::const_)),
+                    "positions"_a, "out"_a, "color"_a = afw::image::Color(),
+                    py::call_guard<py::gil_scoped_release>());
+    clsImagePsf.def("setResultCacheCapacity", &ImagePsf::setResultCacheCapacity, "capacity"_a);
+    clsImagePsf.def("getResultCache", [](ImagePsf const &self) {
+        return std::const_pointer_cast<PsfResultCache>(self.getResultCache());
+    });
 }
 
 }  // namespace
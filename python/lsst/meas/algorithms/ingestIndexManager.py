@@ -21,9 +21,11 @@
 
 __all__ = ["IngestIndexManager", "IngestGaiaManager"]
 
+import collections
 import os.path
-import itertools
 import multiprocessing
+import shutil
+import tempfile
 
 import astropy.time
 import astropy.units as u
@@ -80,11 +82,18 @@ class IngestIndexManager:
         self.htmRange = htmRange
         self.addRefCatMetadata = addRefCatMetadata
         self.log = log
+        self.spillDir = None
 
     def run(self, inputFiles):
         """Index a set of input files from a reference catalog, and write the
         output to the appropriate filenames, in parallel.
 
+        The work is done in two phases, so that no output file is shared
+        between processes.  First each input file is read, indexed and
+        written, sorted by HTM pixel, to a spill file in a temporary
+        directory next to the outputs.  Then each output file is written
+        exactly once, from the pieces of the spill files that belong to it.
+
         Parameters
         ----------
         inputFiles : `list`
@@ -92,40 +101,52 @@ class IngestIndexManager:
         """
         global COUNTER, FILE_PROGRESS
         self.nInputFiles = len(inputFiles)
+        COUNTER = multiprocessing.Value('i', 0)
+        FILE_PROGRESS = multiprocessing.Value('i', 0)
 
-        with multiprocessing.Manager() as manager:
-            COUNTER = multiprocessing.Value('i', 0)
-            FILE_PROGRESS = multiprocessing.Value('i', 0)
-            fileLocks = manager.dict()
-            self.log.info("Creating %s file locks.", self.htmRange[1] - self.htmRange[0])
-            for i in range(self.htmRange[0], self.htmRange[1]):
-                fileLocks[i] = manager.Lock()
-            self.log.info("File locks created.")
+        outputDir = os.path.dirname(next(iter(self.filenames.values())))
+        self.spillDir = tempfile.mkdtemp(prefix="ingestSpill", dir=outputDir)
+        try:
             with multiprocessing.Pool(self.config.n_processes) as pool:
-                pool.starmap(self._ingestOneFile, zip(inputFiles, itertools.repeat(fileLocks)))
-
-    def _ingestOneFile(self, filename, fileLocks):
-        """Read and process one file, and write its records to the correct
-        indexed files, while handling exceptions in a useful way so that they
-        don't get swallowed by the multiprocess pool.
+                spills = pool.starmap(self._ingestOneFile, enumerate(inputFiles))
+                pieces = collections.defaultdict(list)
+                for spill in spills:
+                    for pixelId, piece in spill.items():
+                        pieces[pixelId].append(piece)
+                self.log.info("Writing %d HTM pixels.", len(pieces))
+                pool.starmap(self._mergeOnePixel, sorted(pieces.items()))
+        finally:
+            shutil.rmtree(self.spillDir, ignore_errors=True)
+            self.spillDir = None
+
+    def _ingestOneFile(self, index, filename):
+        """Read and index one file, and write its records to a spill file,
+        while handling exceptions in a useful way so that they don't get
+        swallowed by the multiprocess pool.
 
         Parameters
         ----------
+        index : `int`
+            Index of the file among all the input files; used to name the
+            spill file.
         filename : `str`
             The file to process.
-        fileLocks : `dict` [`int`, `multiprocessing.Lock`]
-            A Lock for each HTM pixel; each pixel gets one file written, and
-            we need to block when one process is accessing that file.
+
+        Returns
+        -------
+        pieces : `dict` [`int`, `tuple`]
+            The spill file name prefix and the start and end rows within it
+            of the records for each HTM pixel.
         """
-        global FILE_PROGRESS
+        global COUNTER, FILE_PROGRESS
         inputData = self.file_reader.run(filename)
         fluxes = self._getFluxes(inputData)
         matchedPixels = self.indexer.indexPoints(inputData[self.config.ra_name],
                                                  inputData[self.config.dec_name])
-        pixel_ids = set(matchedPixels)
-        for pixelId in pixel_ids:
-            with fileLocks[pixelId]:
-                self._doOnePixel(inputData, matchedPixels, pixelId, fluxes)
+        with COUNTER.get_lock():
+            ids = self._getIds(inputData)
+        pieces = self._writeSpillFile(os.path.join(self.spillDir, "%d" % index),
+                                      inputData, matchedPixels, fluxes, ids)
         with FILE_PROGRESS.get_lock():
             oldPercent = 100 * FILE_PROGRESS.value / self.nInputFiles
             FILE_PROGRESS.value += 1
@@ -136,59 +157,131 @@ class IngestIndexManager:
                               FILE_PROGRESS.value,
                               self.nInputFiles,
                               percent)
+        return pieces
+
+    @staticmethod
+    def _writeSpillFile(prefix, inputData, matchedPixels, fluxes, ids):
+        """Write the rows of one input file, sorted by HTM pixel, to a spill
+        file.
 
-    def _doOnePixel(self, inputData, matchedPixels, pixelId, fluxes):
-        """Process one HTM pixel, appending to an existing catalog or creating
-        a new catalog, as needed.
+        The rows, ids and fluxes are saved as numpy arrays in the files
+        ``prefix + "_rows.npy"``, ``prefix + "_ids.npy"`` and
+        ``prefix + "_fluxes.npy"`` (omitted if there are no fluxes), so the
+        merge phase can read just the rows it needs.  `numpy.save` can't
+        write masked arrays (e.g. from FITS files with null values), so the
+        mask of the rows, if any, goes in ``prefix + "_mask.npy"``.
 
         Parameters
         ----------
-        inputData : `numpy.ndarray`
+        prefix : `str`
+            Path and name prefix of the spill file.
+        inputData : `numpy.ndarray` or `numpy.ma.MaskedArray`
             The data from one input file.
         matchedPixels : `numpy.ndarray`
             The row-matched pixel indexes corresponding to ``inputData``.
-        pixelId : `int`
-            The pixel index we are currently processing.
         fluxes : `dict` [`str`, `numpy.ndarray`]
             The values that will go into the flux and fluxErr fields in the
             output catalog.
+        ids : `numpy.ndarray`
+            The values that will go into the id field of the output catalog.
+
+        Returns
+        -------
+        pieces : `dict` [`int`, `tuple`]
+            The spill file name prefix and the start and end rows within it
+            of the records for each HTM pixel.
         """
-        idx = np.where(matchedPixels == pixelId)[0]
-        catalog = self.getCatalog(pixelId, self.schema, len(idx))
-        for outputRow, inputRow in zip(catalog[-len(idx):], inputData[idx]):
-            self._fillRecord(outputRow, inputRow)
+        order = np.argsort(matchedPixels, kind="stable")
+        rows = inputData[order]
+        np.save(prefix + "_rows.npy", np.ma.getdata(rows))
+        if np.ma.isMaskedArray(rows):
+            np.save(prefix + "_mask.npy", np.ma.getmaskarray(rows))
+        np.save(prefix + "_ids.npy", np.asarray(ids)[order])
+        if fluxes:
+            names = sorted(fluxes)
+            np.save(prefix + "_fluxes.npy", np.rec.fromarrays([fluxes[name][order] for name in names],
+                                                              names=names))
+        pixelIds, starts, counts = np.unique(np.asarray(matchedPixels)[order], return_index=True,
+                                             return_counts=True)
+        return {int(pixelId): (prefix, int(start), int(start + count))
+                for pixelId, start, count in zip(pixelIds, starts, counts)}
 
-        global COUNTER
-        with COUNTER.get_lock():
-            self._setIds(inputData[idx], catalog)
+    @staticmethod
+    def _readSpillFile(prefix, start, end):
+        """Read some of the rows written by `_writeSpillFile`.
 
-        for name, array in fluxes.items():
-            catalog[self.key_map[name]][-len(idx):] = array[idx]
+        Parameters
+        ----------
+        prefix : `str`
+            Path and name prefix of the spill file.
+        start, end : `int`
+            The range of rows to read.
+
+        Returns
+        -------
+        inputData : `numpy.ndarray` or `numpy.ma.MaskedArray`
+            The rows, masked as they were in the input data.
+        """
+        inputData = np.load(prefix + "_rows.npy", mmap_mode="r")[start:end]
+        if os.path.exists(prefix + "_mask.npy"):
+            mask = np.load(prefix + "_mask.npy", mmap_mode="r")[start:end]
+            inputData = np.ma.MaskedArray(inputData, mask=mask)
+        return inputData
+
+    def _mergeOnePixel(self, pixelId, pieces):
+        """Write the catalog for one HTM pixel, appending to an existing
+        catalog or creating a new catalog, as needed.
+
+        Parameters
+        ----------
+        pixelId : `int`
+            The pixel index we are currently processing.
+        pieces : `list` [`tuple`]
+            The spill file name prefix and the start and end rows within it
+            of each set of records for this pixel.
+        """
+        nNew = sum(end - start for _, start, end in pieces)
+        catalog = self.getCatalog(pixelId, self.schema, nNew)
+        offset = len(catalog) - nNew
+        for prefix, start, end in pieces:
+            inputData = self._readSpillFile(prefix, start, end)
+            for outputRow, inputRow in zip(catalog[offset:offset + len(inputData)], inputData):
+                self._fillRecord(outputRow, inputRow)
+            catalog['id'][offset:offset + len(inputData)] = np.load(prefix + "_ids.npy",
+                                                                    mmap_mode="r")[start:end]
+            if os.path.exists(prefix + "_fluxes.npy"):
+                fluxes = np.load(prefix + "_fluxes.npy", mmap_mode="r")[start:end]
+                for name in fluxes.dtype.names:
+                    catalog[self.key_map[name]][offset:offset + len(inputData)] = fluxes[name]
+            offset += len(inputData)
 
         catalog.writeFits(self.filenames[pixelId])
 
-    def _setIds(self, inputData, catalog):
-        """Fill the `id` field of catalog with a running index, filling the
-        last values up to the length of ``inputData``.
+    def _getIds(self, inputData):
+        """Return the values of the `id` field for the records of one input
+        file.
 
-        Fill with `self.config.id_name` if specified, otherwise use the
-        global running counter value.
+        Use `self.config.id_name` if specified, otherwise use the global
+        running counter value, which must be locked by the caller.
 
         Parameters
         ----------
         inputData : `numpy.ndarray`
             The input data that is being processed.
-        catalog : `lsst.afw.table.SimpleCatalog`
-            The output catalog to fill the ids.
+
+        Returns
+        -------
+        ids : `numpy.ndarray`
+            The ids, one per row of ``inputData``.
         """
         global COUNTER
         size = len(inputData)
         if self.config.id_name:
-            catalog['id'][-size:] = inputData[self.config.id_name]
-        else:
-            idEnd = COUNTER.value + size
-            catalog['id'][-size:] = np.arange(COUNTER.value, idEnd)
-            COUNTER.value = idEnd
+            return np.asarray(inputData[self.config.id_name])
+        idEnd = COUNTER.value + size
+        ids = np.arange(COUNTER.value, idEnd)
+        COUNTER.value = idEnd
+        return ids
 
     def getCatalog(self, pixelId, schema, nNewElements):
         """Get a catalog from disk or create it if it doesn't exist.
@@ -208,7 +301,7 @@ class IngestIndexManager:
         catalog : `lsst.afw.table.SimpleCatalog`
             The new or read-and-resized catalog specified by `dataId`.
         """
-        # This is safe, because we lock on this file before getCatalog is called.
+        # This is safe, because each pixel is merged by exactly one process.
         if os.path.isfile(self.filenames[pixelId]):
             catalog = afwTable.SimpleCatalog.readFits(self.filenames[pixelId])
             catalog.resize(len(catalog) + nNewElements)
@@ -328,7 +328,7 @@ class IngestIndexedReferenceTask(pipeBase.CmdLineTask):
         """
         schema, key_map = self._saveMasterSchema(inputFiles[0])
         # create an HTM we can interrogate about pixel ids
-        htm = lsst.sphgeom.HtmPixelization(self.indexer.htm.get_depth())
+        htm = lsst.sphgeom.HtmPixelization(self.indexer.htm.getDepth())
         filenames = self._getButlerFilenames(htm)
         worker = self.IngestManager(filenames,
                                     self.config,
@@ -0,0 +1,58 @@
+/*
+ * LSST Data Management System
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ * See the COPYRIGHT file
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include <string>
+
+#include "lsst/meas/algorithms/Instrumentation.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+namespace {
+
+PYBIND11_MODULE(instrumentation, mod) {
+    py::class_<Instrumentation> cls(mod, "Instrumentation");
+
+    py::class_<Instrumentation::Entry> clsEntry(cls, "Entry");
+    clsEntry.def_readonly("calls", &Instrumentation::Entry::calls);
+    clsEntry.def_readonly("total", &Instrumentation::Entry::total);
+    clsEntry.def("__repr__", [](Instrumentation::Entry const &self) {
+        return "Entry(calls=" + std::to_string(self.calls) + ", total=" + std::to_string(self.total) + ")";
+    });
+
+    cls.def_static("isCompiled", &Instrumentation::isCompiled);
+    cls.def_static("setEnabled", &Instrumentation::setEnabled, "enabled"_a);
+    cls.def_static("isEnabled", &Instrumentation::isEnabled);
+    cls.def_static("getTimers", &Instrumentation::getTimers);
+    cls.def_static("getCounters", &Instrumentation::getCounters);
+    cls.def_static("reset", &Instrumentation::reset);
+}
+
+}  // namespace
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
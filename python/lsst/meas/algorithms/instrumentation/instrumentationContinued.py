@@ -0,0 +1,53 @@
+#
+# LSST Data Management System
+#
+# Copyright 2008-2017  AURA/LSST.
+#
+# This product includes software developed by the
+# LSST Project (http://www.lsst.org/).
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the LSST License Statement and
+# the GNU General Public License along with this program.  If not,
+# see <https://www.lsstcorp.org/LegalNotices/>.
+#
+
+__all__ = []  # import only for side effects
+
+from lsst.utils import continueClass
+from .instrumentation import Instrumentation
+
+
+@continueClass
+class Instrumentation:
+
+    @staticmethod
+    def updateMetadata(metadata, prefix="instrumentation"):
+        """Copy the timers and counters recorded so far into metadata.
+
+        Timer ``name`` is written as ``<prefix>.<name>.calls`` and ``<prefix>.<name>.seconds``, and counter
+        ``name`` as ``<prefix>.<name>.count`` and ``<prefix>.<name>.total``; names containing "." (e.g.
+        "CoaddPsf.doComputeKernelImage") are thus nested in a `lsst.daf.base.PropertySet`.
+
+        Parameters
+        ----------
+        metadata : `lsst.daf.base.PropertySet`
+            Metadata to update, e.g. a Task's ``metadata``.
+        prefix : `str`, optional
+            Prefix for the names of the entries.
+        """
+        for name, entry in Instrumentation.getTimers().items():
+            metadata.set("%s.%s.calls" % (prefix, name), entry.calls)
+            metadata.set("%s.%s.seconds" % (prefix, name), entry.total)
+        for name, entry in Instrumentation.getCounters().items():
+            metadata.set("%s.%s.count" % (prefix, name), entry.calls)
+            metadata.set("%s.%s.total" % (prefix, name), entry.total)
@@ -34,12 +34,58 @@ namespace meas {
 namespace algorithms {
 namespace {
 
+void declareCompiledDefectMap(py::module& mod) {
+    py::class_<CompiledDefectMap, std::shared_ptr<CompiledDefectMap>> cls(mod, "CompiledDefectMap");
+
+    py::class_<CompiledDefectMap::Run> clsRun(cls, "Run");
+    clsRun.def(py::init<int, int, Defect::DefectPosition, unsigned int>(), "x0"_a, "x1"_a, "pos"_a,
+               "type"_a);
+    clsRun.def("getX0", &CompiledDefectMap::Run::getX0);
+    clsRun.def("getX1", &CompiledDefectMap::Run::getX1);
+    clsRun.def("getPos", &CompiledDefectMap::Run::getPos);
+    clsRun.def("getType", &CompiledDefectMap::Run::getType);
+    clsRun.def("__eq__", &CompiledDefectMap::Run::operator==, py::is_operator());
+    clsRun.def(py::pickle(
+            [](CompiledDefectMap::Run const& self) {
+                return py::make_tuple(self.getX0(), self.getX1(), self.getPos(), self.getType());
+            },
+            [](py::tuple state) {
+                return CompiledDefectMap::Run(state[0].cast<int>(), state[1].cast<int>(),
+                                              state[2].cast<Defect::DefectPosition>(),
+                                              state[3].cast<unsigned int>());
+            }));
+
+    cls.def(py::init<std::vector<Defect::Ptr> const&, geom::Box2I const&>(), "defects"_a, "bbox"_a);
+    cls.def(py::init<geom::Box2I const&, std::vector<std::size_t> const&,
+                     std::vector<CompiledDefectMap::Run> const&>(),
+            "bbox"_a, "offsets"_a, "runs"_a);
+    cls.def("getBBox", &CompiledDefectMap::getBBox);
+    cls.def("getOffsets", &CompiledDefectMap::getOffsets);
+    cls.def("getRuns", &CompiledDefectMap::getRuns);
+    cls.def(py::pickle(
+            [](CompiledDefectMap const& self) {
+                return py::make_tuple(self.getBBox(), self.getOffsets(), self.getRuns());
+            },
+            [](py::tuple state) {
+                return std::make_shared<CompiledDefectMap>(
+                        state[0].cast<geom::Box2I>(), state[1].cast<std::vector<std::size_t>>(),
+                        state[2].cast<std::vector<CompiledDefectMap::Run>>());
+            }));
+}
+
 template <typename PixelT>
 void declareInterpolateOverDefects(py::module& mod) {
+    typedef afw::image::MaskedImage<PixelT, afw::image::MaskPixel, afw::image::VariancePixel> MaskedImageT;
+    mod.def("interpolateOverDefects",
+            py::overload_cast<MaskedImageT&, afw::detection::Psf const&, std::vector<Defect::Ptr>&, double,
+                              bool, int>(&interpolateOverDefects<MaskedImageT>),
+            "image"_a, "psf"_a, "badList"_a, "fallBackValue"_a = 0.0, "useFallbackValueAtEdge"_a = false,
+            "nThreads"_a = 1, py::call_guard<py::gil_scoped_release>());
     mod.def("interpolateOverDefects",
-            interpolateOverDefects<
-                    afw::image::MaskedImage<PixelT, afw::image::MaskPixel, afw::image::VariancePixel>>,
-            "image"_a, "psf"_a, "badList"_a, "fallBackValue"_a = 0.0, "useFallbackValueAtEdge"_a = false);
+            py::overload_cast<MaskedImageT&, CompiledDefectMap const&, double, bool, int>(
+                    &interpolateOverDefects<MaskedImageT>),
+            "image"_a, "defectMap"_a, "fallBackValue"_a = 0.0, "useFallbackValueAtEdge"_a = false,
+            "nThreads"_a = 1, py::call_guard<py::gil_scoped_release>());
 }
 
 PYBIND11_MODULE(interp, mod) {
@@ -66,6 +112,9 @@ PYBIND11_MODULE(interp, mod) {
     clsDefect.def("getType", &Defect::getType);
     clsDefect.def("getPos", &Defect::getPos);
 
+    declareCompiledDefectMap(mod);
+    mod.def("maskBoxes", &maskBoxes, "mask"_a, "bboxes"_a, "bitmask"_a);
+    mod.def("boxesFromMask", &boxesFromMask, "mask"_a, "bitmask"_a);
     declareInterpolateOverDefects<float>(mod);
 }
 
@@ -46,6 +46,8 @@ PYBIND11_MODULE(kernelPsf, mod) {
     clsKernelPsf.def("getAveragePosition", &KernelPsf::getAveragePosition);
     clsKernelPsf.def("clone", &KernelPsf::clone);
     clsKernelPsf.def("isPersistable", &KernelPsf::isPersistable);
+    clsKernelPsf.def("setCacheMoments", &KernelPsf::setCacheMoments, "cacheMoments"_a);
+    clsKernelPsf.def("getCacheMoments", &KernelPsf::getCacheMoments);
 }
 
 }  // namespace
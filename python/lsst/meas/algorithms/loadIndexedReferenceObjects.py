@@ -23,6 +23,13 @@
 
 __all__ = ["LoadIndexedReferenceObjectsConfig", "LoadIndexedReferenceObjectsTask"]
 
+import collections
+import concurrent.futures
+import os
+import threading
+
+import numpy as np
+
 from .loadReferenceObjects import hasNanojanskyFluxUnits, convertToNanojansky, getFormatVersionFromRefCat
 from lsst.meas.algorithms import getRefFluxField, LoadReferenceObjectsTask, LoadReferenceObjectsConfig
 import lsst.afw.table as afwTable
@@ -38,6 +45,71 @@ class LoadIndexedReferenceObjectsConfig(LoadReferenceObjectsConfig):
         default='cal_ref_cat',
         doc='Name of the ingested reference dataset'
     )
+    shardCacheMaxBytes = pexConfig.RangeField(
+        dtype=int,
+        default=512*1024**2,
+        min=0,
+        doc="Maximum memory (bytes) used by shards cached between loads, shared by all loaders in the "
+            "process; the least recently used shards are dropped past this limit.  0 disables the cache."
+    )
+    nShardReaders = pexConfig.RangeField(
+        dtype=int,
+        default=1,
+        min=1,
+        doc="Number of threads used to read shards that are not already cached; more than one calls "
+            "butler.get concurrently, which the butler does not guarantee to be safe."
+    )
+
+
+class _ShardCache:
+    """A bounded, thread-safe LRU cache of reference catalog shards.
+
+    Shards are keyed on their file name and modification time, so a shard
+    rewritten by a later ingest is read again.
+
+    Parameters
+    ----------
+    maxBytes : `int`
+        Maximum memory used by cached shards.
+    """
+    def __init__(self, maxBytes=0):
+        self.maxBytes = maxBytes
+        self._lock = threading.Lock()
+        self._shards = collections.OrderedDict()  # least recently used first
+        self._memoryUsage = 0
+
+    @staticmethod
+    def _getBytes(shard):
+        return len(shard)*shard.schema.getRecordSize()
+
+    def get(self, key):
+        """Return the cached shard for key, or `None`."""
+        with self._lock:
+            shard = self._shards.get(key)
+            if shard is not None:
+                self._shards.move_to_end(key)
+            return shard
+
+    def insert(self, key, shard, maxBytes):
+        """Insert a shard, first shrinking the cache to ``maxBytes``."""
+        nBytes = self._getBytes(shard)
+        with self._lock:
+            self.maxBytes = maxBytes
+            if key not in self._shards and nBytes <= maxBytes:
+                self._shards[key] = shard
+                self._memoryUsage += nBytes
+            while self._memoryUsage > self.maxBytes:
+                _, oldest = self._shards.popitem(last=False)
+                self._memoryUsage -= self._getBytes(oldest)
+
+    def clear(self):
+        """Remove all cached shards."""
+        with self._lock:
+            self._shards.clear()
+            self._memoryUsage = 0
+
+
+_shardCache = _ShardCache()
 
 
 class LoadIndexedReferenceObjectsTask(LoadReferenceObjectsTask):
@@ -69,14 +141,14 @@ class LoadIndexedReferenceObjectsTask(LoadReferenceObjectsTask):
                                  dataId=self.indexer.makeDataId('master_schema', self.ref_dataset_name),
                                  immediate=True)
 
-        # load the catalog, one shard at a time
+        # load the catalog, one shard at a time; shards may be cached, so copy their records
         for shard, isOnBoundary in zip(shards, isOnBoundaryList):
             if shard is None:
                 continue
             if isOnBoundary:
-                refCat.extend(self._trimToCircle(shard, ctrCoord, radius))
+                refCat.extend(self._trimToCircle(shard, ctrCoord, radius), deep=True)
             else:
-                refCat.extend(shard)
+                refCat.extend(shard, deep=True)
 
         # apply proper motion corrections
         if epoch is not None and "pm_ra" in refCat.schema:
@@ -130,6 +202,9 @@ class LoadIndexedReferenceObjectsTask(LoadReferenceObjectsTask):
     def getShards(self, shardIdList):
         """Get shards by ID.
 
+        Shards are taken from a cache shared by all loaders in the process
+        when possible; the others are read concurrently, and then cached.
+
         Parameters
         ----------
         shardIdList : `list` of `int`
@@ -138,17 +213,41 @@ class LoadIndexedReferenceObjectsTask(LoadReferenceObjectsTask):
         Returns
         -------
         catalogs : `list` of `lsst.afw.table.SimpleCatalog`
-            A list of reference catalogs, one for each entry in shardIdList.
+            A list of reference catalogs, one for each entry in shardIdList;
+            `None` for shards that do not exist.  The catalogs may be shared
+            with other callers, so must not be modified.
         """
-        shards = []
-        for shardId in shardIdList:
-            if self.butler.datasetExists('ref_cat',
-                                         dataId=self.indexer.makeDataId(shardId, self.ref_dataset_name)):
-                shards.append(self.butler.get('ref_cat',
-                                              dataId=self.indexer.makeDataId(shardId, self.ref_dataset_name),
-                                              immediate=True))
+        keys = [self._getShardKey(shardId) for shardId in shardIdList]
+        shards = [_shardCache.get(key) if key is not None else None for key in keys]
+        missing = [i for i, (key, shard) in enumerate(zip(keys, shards)) if key is not None and shard is None]
+        if len(missing) > 1 and self.config.nShardReaders > 1:
+            with concurrent.futures.ThreadPoolExecutor(self.config.nShardReaders) as executor:
+                loaded = list(executor.map(self._readShard, (shardIdList[i] for i in missing)))
+        else:
+            loaded = [self._readShard(shardIdList[i]) for i in missing]
+        for i, shard in zip(missing, loaded):
+            shards[i] = shard
+            _shardCache.insert(keys[i], shard, self.config.shardCacheMaxBytes)
         return shards
 
+    def _getShardKey(self, shardId):
+        """Return the key of a shard in the shard cache, or `None` if the
+        shard does not exist.
+        """
+        dataId = self.indexer.makeDataId(shardId, self.ref_dataset_name)
+        if not self.butler.datasetExists('ref_cat', dataId=dataId):
+            return None
+        filename = self.butler.get('ref_cat_filename', dataId=dataId)[0]
+        try:
+            return (filename, os.stat(filename).st_mtime_ns)
+        except OSError:
+            return (filename, None)
+
+    def _readShard(self, shardId):
+        """Read one shard with the butler."""
+        return self.butler.get('ref_cat', dataId=self.indexer.makeDataId(shardId, self.ref_dataset_name),
+                               immediate=True)
+
     def _trimToCircle(self, refCat, ctrCoord, radius):
         """Trim a reference catalog to a circular aperture.
 
@@ -166,8 +265,15 @@ class LoadIndexedReferenceObjectsTask(LoadReferenceObjectsTask):
         catalog : `lsst.afw.table.SimpleCatalog`
             Catalog containing objects that fall in the circular aperture.
         """
-        tempCat = type(refCat)(refCat.schema)
-        for record in refCat:
-            if record.getCoord().separation(ctrCoord) < radius:
-                tempCat.append(record)
-        return tempCat
+        if not refCat.isContiguous():
+            refCat = refCat.copy(deep=True)
+        # Haversine formula, as used by lsst.geom.SpherePoint.separation
+        ra = refCat["coord_ra"]
+        dec = refCat["coord_dec"]
+        ctrRa = ctrCoord.getLongitude().asRadians()
+        ctrDec = ctrCoord.getLatitude().asRadians()
+        sinHalfDDec = np.sin(0.5*(dec - ctrDec))
+        sinHalfDRa = np.sin(0.5*(ra - ctrRa))
+        haversine = sinHalfDDec**2 + np.cos(dec)*np.cos(ctrDec)*sinHalfDRa**2
+        separation = 2.0*np.arcsin(np.sqrt(np.clip(haversine, 0.0, 1.0)))
+        return refCat[separation < radius.asRadians()]
@@ -313,14 +313,13 @@ class ReferenceObjectLoader:
             # defined by given bbox
             if innerSkyRegion.contains(region):
                 return refCat
-            # Create a new reference catalog, and populate it with records which fall inside the bbox
-            filteredRefCat = type(refCat)(refCat.table)
-            centroidKey = afwTable.Point2DKey(refCat.schema['centroid'])
-            for record in refCat:
-                pixCoords = record[centroidKey]
-                if bbox.contains(geom.Point2I(pixCoords)):
-                    filteredRefCat.append(record)
-            return filteredRefCat
+            # Select the records whose centroids (rounded to the nearest pixel) fall inside the bbox
+            if not refCat.isContiguous():
+                refCat = refCat.copy(deep=True)
+            x = numpy.floor(refCat['centroid_x'] + 0.5)
+            y = numpy.floor(refCat['centroid_y'] + 0.5)
+            return refCat[(x >= bbox.getMinX()) & (x <= bbox.getMaxX()) &
+                          (y >= bbox.getMinY()) & (y <= bbox.getMaxY())]
         return self.loadRegion(outerSkyRegion, filtFunc=_filterFunction, epoch=epoch, filterName=filterName)
 
     def loadRegion(self, region, filtFunc=None, filterName=None, epoch=None):
@@ -1018,13 +1017,12 @@ class LoadReferenceObjectsTask(pipeBase.Task, metaclass=abc.ABCMeta):
         @return a catalog of reference objects in bbox, with centroid and hasCentroid fields set
         """
         afwTable.updateRefCentroids(wcs, refCat)
-        centroidKey = afwTable.Point2DKey(refCat.schema["centroid"])
-        retStarCat = type(refCat)(refCat.table)
-        for star in refCat:
-            point = star.get(centroidKey)
-            if bbox.contains(point):
-                retStarCat.append(star)
-        return retStarCat
+        if not refCat.isContiguous():
+            refCat = refCat.copy(deep=True)
+        x = refCat["centroid_x"]
+        y = refCat["centroid_y"]
+        return refCat[(x >= bbox.getMinX()) & (x < bbox.getMaxX()) &
+                      (y >= bbox.getMinY()) & (y < bbox.getMaxY())]
 
     def _addFluxAliases(self, schema):
         """Add aliases for camera filter fluxes to the schema.
@@ -1453,6 +1451,36 @@ def joinMatchListWithCatalogImpl(refObjLoader, matchCat, sourceCat):
     return afwTable.unpackMatches(matchCat, refCat, sourceCat)
 
 
+def offsetCoords(ra, dec, bearing, amount):
+    """Move positions along great circles, as `lsst.geom.SpherePoint.offset`
+    does for a single position.
+
+    Parameters
+    ----------
+    ra, dec : `numpy.ndarray`
+        Right ascension and declination of each position (rad).
+    bearing : `numpy.ndarray`
+        Direction of each offset (rad), measured from East (+RA) towards
+        North (+Dec).
+    amount : `numpy.ndarray`
+        Length of each offset (rad).
+
+    Returns
+    -------
+    ra, dec : `numpy.ndarray`
+        Offset right ascensions, in [0, 2 pi), and declinations (rad).
+    """
+    sinRa, cosRa = numpy.sin(ra), numpy.cos(ra)
+    sinDec, cosDec = numpy.sin(dec), numpy.cos(dec)
+    # Unit vectors toward the position, East and North
+    position = numpy.array([cosDec*cosRa, cosDec*sinRa, sinDec])
+    east = numpy.array([-sinRa, cosRa, numpy.zeros_like(ra)])
+    north = numpy.array([-sinDec*cosRa, -sinDec*sinRa, cosDec])
+    direction = numpy.cos(bearing)*east + numpy.sin(bearing)*north
+    x, y, z = numpy.cos(amount)*position + numpy.sin(amount)*direction
+    return numpy.mod(numpy.arctan2(y, x), 2*numpy.pi), numpy.arctan2(z, numpy.hypot(x, y))
+
+
 def applyProperMotionsImpl(log, catalog, epoch):
     """Apply proper motion correction to a reference catalog.
 
@@ -1490,7 +1518,6 @@ def applyProperMotionsImpl(log, catalog, epoch):
     log.debug("Correcting reference catalog for proper motion to %r", epoch)
     # Use `epoch.tai` to make sure the time difference is in TAI
     timeDiffsYears = (epoch.tai - catEpoch).to(astropy.units.yr).value
-    coordKey = catalog.table.getCoordKey()
     # Compute the offset of each object due to proper motion
     # as components of the arc of a great circle along RA and Dec
     pmRaRad = catalog["pm_ra"]
@@ -1506,10 +1533,8 @@ def applyProperMotionsImpl(log, catalog, epoch):
     # needlessly large errors for short duration
     offsetBearingsRad = numpy.arctan2(pmDecRad*1e6, pmRaRad*1e6)
     offsetAmountsRad = numpy.hypot(offsetsRaRad, offsetsDecRad)
-    for record, bearingRad, amountRad in zip(catalog, offsetBearingsRad, offsetAmountsRad):
-        record.set(coordKey,
-                   record.get(coordKey).offset(bearing=bearingRad*lsst.geom.radians,
-                                               amount=amountRad*lsst.geom.radians))
+    catalog["coord_ra"], catalog["coord_dec"] = offsetCoords(catalog["coord_ra"], catalog["coord_dec"],
+                                                             offsetBearingsRad, offsetAmountsRad)
     # Increase error in RA and Dec based on error in proper motion
     if "coord_raErr" in catalog.schema:
         catalog["coord_raErr"] = numpy.hypot(catalog["coord_raErr"],
@@ -23,12 +23,16 @@
 __all__ = ["makeCoaddApCorrMap", ]
 
 from lsst.afw.image import ApCorrMap
-from .coaddBoundedField import CoaddBoundedField, CoaddBoundedFieldElement
+from .coaddBoundedFieldSet import CoaddBoundedFieldSet, CoaddBoundedFieldSetElement
 
 
 def makeCoaddApCorrMap(catalog, coaddBox, coaddWcs, weightFieldName="weight"):
     """Construct an ApCorrMap for a coadd
 
+    All the aperture corrections share one CoaddBoundedFieldSet, so the inputs' Wcss and valid
+    polygons are only used once for all of them.  They are persisted as plain CoaddBoundedFields,
+    as before.
+
     @param catalog: Table of coadd inputs (lsst.afw.table.ExposureCatalog)
     @param coaddBox: Bounding box for coadd (lsst.geom.Box2I)
     @param coaddWcs: Wcs for coadd
@@ -36,24 +40,27 @@ def makeCoaddApCorrMap(catalog, coaddBox, coaddWcs, weightFieldName="weight"):
     @return aperture corrections
     """
 
-    # Assemble the BoundedFields for each type
-    everything = {}  # name --> list of CoaddBoundedFieldElement
+    # Gather the BoundedFields of each input, and the names of all of them
+    names = []  # in order of first appearance
+    inputs = []  # (dict of name --> BoundedField, wcs, validPolygon, weight)
     weightKey = catalog.schema[weightFieldName].asKey()
     for row in catalog:
         apCorrMap = row.getApCorrMap()
         if not apCorrMap:
             continue
-        weight = row.get(weightKey)
-        wcs = row.getWcs()
-        validPolygon = row.getValidPolygon()
-        for name, bf in apCorrMap.items():
-            if name not in everything:
-                everything[name] = []
-            everything[name].append(CoaddBoundedFieldElement(bf, wcs, validPolygon, weight))
-
-    # Construct a CoaddBoundedField for each type
+        fields = dict(apCorrMap.items())
+        names.extend(name for name in fields if name not in names)
+        inputs.append((fields, row.getWcs(), row.getValidPolygon(), row.get(weightKey)))
+
     apCorrMap = ApCorrMap()
-    for name, elements in everything.items():
-        apCorrMap.set(name, CoaddBoundedField(coaddBox, coaddWcs, elements))
+    if not names:
+        return apCorrMap
+
+    # Construct the shared CoaddBoundedFieldSet; inputs are missing (None) the fields they don't have
+    elements = [CoaddBoundedFieldSetElement([fields.get(name) for name in names], wcs, validPolygon, weight)
+                for fields, wcs, validPolygon, weight in inputs]
+    fieldSet = CoaddBoundedFieldSet(coaddBox, coaddWcs, names, elements)
+    for name in names:
+        apCorrMap.set(name, fieldSet.getField(name))
 
     return apCorrMap
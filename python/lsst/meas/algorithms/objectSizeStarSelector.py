@@ -22,14 +22,11 @@
 import sys
 
 import numpy
-import warnings
 from functools import reduce
 
 from lsst.log import Log
 from lsst.pipe.base import Struct
-import lsst.geom
 from lsst.afw.cameraGeom import PIXELS, TAN_PIXELS
-import lsst.afw.geom as afwGeom
 import lsst.pex.config as pexConfig
 import lsst.afw.display as afwDisplay
 from .sourceSelector import BaseSourceSelectorTask, sourceSelectorRegistry
@@ -158,33 +155,37 @@ def _assignClusters(yvec, centers):
     """Return a vector of centerIds based on their distance to the centers"""
     assert len(centers) > 0
 
-    minDist = numpy.nan*numpy.ones_like(yvec)
-    clusterId = numpy.empty_like(yvec)
-    clusterId.dtype = int               # zeros_like(..., dtype=int) isn't in numpy 1.5
-    dbl = Log.getLogger("objectSizeStarSelector._assignClusters")
-    dbl.setLevel(dbl.INFO)
-
-    # Make sure we are logging aall numpy warnings...
-    oldSettings = numpy.seterr(all="warn")
-    with warnings.catch_warnings(record=True) as w:
-        warnings.simplefilter("always")
-        for i, mean in enumerate(centers):
-            dist = abs(yvec - mean)
-            if i == 0:
-                update = dist == dist       # True for all points
-            else:
-                update = dist < minDist
-                if w:  # Only do if w is not empty i.e. contains a warning message
-                    dbl.trace(str(w[-1]))
-
-            minDist[update] = dist[update]
-            clusterId[update] = i
-    numpy.seterr(**oldSettings)
+    with numpy.errstate(invalid="ignore"):
+        dist = numpy.abs(numpy.subtract.outer(yvec, centers))
+    # Points are only reassigned from center 0 to a center that is strictly closer, so NaN distances
+    # (from NaN centers) never win, and points whose distance to center 0 is NaN stay in cluster 0.
+    others = dist[:, 1:]
+    others[numpy.isnan(others)] = numpy.inf
+    clusterId = numpy.argmin(dist, axis=1)
+    clusterId[numpy.isnan(dist[:, 0])] = 0
 
     return clusterId
 
 
-def _kcenters(yvec, nCluster, useMedian=False, widthStdAllowed=0.15):
+def _clusterMedians(ysorted, sortedClusterId, nCluster):
+    """Return the median of each cluster, given the points in sorted order and their cluster IDs
+
+    Clusters with no points, or with NaN points (which sort last), have a NaN median.
+    """
+    counts = numpy.bincount(sortedClusterId, minlength=nCluster)
+    # A stable sort on cluster ID keeps each cluster's points in sorted order
+    grouped = ysorted[numpy.argsort(sortedClusterId, kind="mergesort")]
+    starts = numpy.cumsum(counts) - counts
+    medians = numpy.full(nCluster, numpy.nan)
+    full = counts > 0
+    lower = grouped[starts[full] + (counts[full] - 1)//2]
+    upper = grouped[starts[full] + counts[full]//2]
+    medians[full] = 0.5*(lower + upper)
+    medians[numpy.bincount(sortedClusterId[numpy.isnan(ysorted)], minlength=nCluster) > 0] = numpy.nan
+    return medians
+
+
+def _kcenters(yvec, nCluster, useMedian=False, widthStdAllowed=0.15, nIteration=100):
     """A classic k-means algorithm, clustering yvec into nCluster clusters
 
     Return the set of centres, and the cluster ID for each of the points
@@ -192,6 +193,9 @@ def _kcenters(yvec, nCluster, useMedian=False, widthStdAllowed=0.15):
     If useMedian is true, use the median of the cluster as its centre, rather than
     the traditional mean
 
+    Iteration stops when the assignment of points to clusters no longer changes, or after
+    nIteration iterations.
+
     Serge Monkewitz points out that there other (maybe smarter) ways of seeding the means:
        "e.g. why not use the Forgy or random partition initialization methods"
     however, the approach adopted here seems to work well for the particular sorts of things
@@ -200,28 +204,29 @@ def _kcenters(yvec, nCluster, useMedian=False, widthStdAllowed=0.15):
 
     assert nCluster > 0
 
-    mean0 = sorted(yvec)[len(yvec)//10]  # guess
+    yvec = numpy.asarray(yvec, dtype=float)
+    order = numpy.argsort(yvec, kind="mergesort")
+    ysorted = yvec[order]
+    mean0 = ysorted[len(yvec)//10]  # guess
     delta = mean0 * widthStdAllowed * 2.0
     centers = mean0 + delta * numpy.arange(nCluster)
 
-    func = numpy.median if useMedian else numpy.mean
-
-    clusterId = numpy.zeros_like(yvec) - 1            # which cluster the points are assigned to
-    clusterId.dtype = int                             # zeros_like(..., dtype=int) isn't in numpy 1.5
-    while True:
+    clusterId = numpy.full(len(yvec), -1, dtype=int)  # which cluster the points are assigned to
+    for _ in range(nIteration):
         oclusterId = clusterId
         clusterId = _assignClusters(yvec, centers)
 
-        if numpy.all(clusterId == oclusterId):
+        if numpy.array_equal(clusterId, oclusterId):
             break
 
-        for i in range(nCluster):
-            # Only compute func if some points are available; otherwise, default to NaN.
-            pointsInCluster = (clusterId == i)
-            if numpy.any(pointsInCluster):
-                centers[i] = func(yvec[pointsInCluster])
-            else:
-                centers[i] = numpy.nan
+        # Only compute the centers if some points are available; otherwise, default to NaN.
+        if useMedian:
+            centers = _clusterMedians(ysorted, clusterId[order], nCluster)
+        else:
+            counts = numpy.bincount(clusterId, minlength=nCluster)
+            with numpy.errstate(invalid="ignore", divide="ignore"):
+                centers = numpy.bincount(clusterId, weights=yvec, minlength=nCluster)/counts
+            centers[counts == 0] = numpy.nan
 
     return centers, clusterId
 
@@ -229,7 +234,7 @@ def _kcenters(yvec, nCluster, useMedian=False, widthStdAllowed=0.15):
 def _improveCluster(yvec, centers, clusterId, nsigma=2.0, nIteration=10, clusterNum=0, widthStdAllowed=0.15):
     """Improve our estimate of one of the clusters (clusterNum) by sigma-clipping around its median"""
 
-    nMember = sum(clusterId == clusterNum)
+    nMember = numpy.count_nonzero(clusterId == clusterNum)
     if nMember < 5:  # can't compute meaningful interquartile range, so no chance of improvement
         return clusterId
     for iter in range(nIteration):
@@ -241,19 +246,16 @@ def _improveCluster(yvec, centers, clusterId, nsigma=2.0, nIteration=10, cluster
         centers[clusterNum] = numpy.median(yv)
         stdev = numpy.std(yv)
 
-        syv = sorted(yv)
+        syv = numpy.sort(yv)
         stdev_iqr = 0.741*(syv[int(0.75*nMember)] - syv[int(0.25*nMember)])
         median = syv[int(0.5*nMember)]
 
         sd = stdev if stdev < stdev_iqr else stdev_iqr
 
-        if False:
-            print("sigma(iqr) = %.3f, sigma = %.3f" % (stdev_iqr, numpy.std(yv)))
         newCluster0 = abs(yvec - centers[clusterNum]) < nsigma*sd
-        clusterId[numpy.logical_and(inCluster0, newCluster0)] = clusterNum
         clusterId[numpy.logical_and(inCluster0, numpy.logical_not(newCluster0))] = -1
 
-        nMember = sum(clusterId == clusterNum)
+        nMember = numpy.count_nonzero(clusterId == clusterNum)
         # 'sd < widthStdAllowed * median' prevents too much rejections
         if nMember == old_nMember or sd < widthStdAllowed * median:
             break
@@ -261,6 +263,24 @@ def _improveCluster(yvec, centers, clusterId, nsigma=2.0, nIteration=10, cluster
     return clusterId
 
 
+def _transformMoments(transform, x, y, xx, xy, yy, step=1.0):
+    """Transform second moments measured at pixel positions (x, y) through transform
+
+    The Jacobian of the transform at each position is estimated by central differences, using four
+    batched transforms of all the positions rather than linearizing the transform at each one.
+
+    Return the transformed xx, xy and yy moments.
+    """
+    def apply(dx, dy):
+        return transform.applyForward(numpy.array([x + dx, y + dy], dtype=float))
+
+    a, c = (apply(step, 0.0) - apply(-step, 0.0))/(2.0*step)  # derivatives with respect to x
+    b, d = (apply(0.0, step) - apply(0.0, -step))/(2.0*step)  # derivatives with respect to y
+    return (a*a*xx + 2.0*a*b*xy + b*b*yy,
+            a*c*xx + (a*d + b*c)*xy + b*d*yy,
+            c*c*xx + 2.0*c*d*xy + d*d*yy)
+
+
 def plot(mag, width, centers, clusterId, marker="o", markersize=2, markeredgewidth=0, ltype='-',
          magType="model", clear=True):
 
@@ -421,19 +441,11 @@ class ObjectSizeStarSelectorTask(BaseSourceSelectorTask):
         flux = sourceCat.get(self.config.sourceFluxField)
         fluxErr = sourceCat.get(self.config.sourceFluxField + "Err")
 
-        xx = numpy.empty(len(sourceCat))
-        xy = numpy.empty_like(xx)
-        yy = numpy.empty_like(xx)
-        for i, source in enumerate(sourceCat):
-            Ixx, Ixy, Iyy = source.getIxx(), source.getIxy(), source.getIyy()
-            if pixToTanPix:
-                p = lsst.geom.Point2D(source.getX(), source.getY())
-                linTransform = afwGeom.linearizeTransform(pixToTanPix, p).getLinear()
-                m = afwGeom.Quadrupole(Ixx, Iyy, Ixy)
-                m.transform(linTransform)
-                Ixx, Iyy, Ixy = m.getIxx(), m.getIyy(), m.getIxy()
-
-            xx[i], xy[i], yy[i] = Ixx, Ixy, Iyy
+        xx = sourceCat.getIxx()
+        xy = sourceCat.getIxy()
+        yy = sourceCat.getIyy()
+        if pixToTanPix:
+            xx, xy, yy = _transformMoments(pixToTanPix, sourceCat.getX(), sourceCat.getY(), xx, xy, yy)
 
         width = numpy.sqrt(0.5*(xx + yy))
         with numpy.errstate(invalid="ignore"):  # suppress NAN warnings
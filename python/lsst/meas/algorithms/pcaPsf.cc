@@ -39,11 +39,13 @@ PYBIND11_MODULE(pcaPsf, mod) {
     py::class_<PcaPsf, std::shared_ptr<PcaPsf>, afw::table::io::PersistableFacade<PcaPsf>, KernelPsf>
             clsPcaPsf(mod, "PcaPsf");
 
-    clsPcaPsf.def(py::init<std::shared_ptr<afw::math::LinearCombinationKernel>, geom::Point2D const &>(),
-                  "kernel"_a, "averagePosition"_a = geom::Point2D());
+    clsPcaPsf.def(py::init<std::shared_ptr<afw::math::LinearCombinationKernel>, geom::Point2D const &,
+                           bool>(),
+                  "kernel"_a, "averagePosition"_a = geom::Point2D(), "singlePrecision"_a = false);
 
     clsPcaPsf.def("clone", &PcaPsf::clone);
     clsPcaPsf.def("getKernel", &PcaPsf::getKernel);
+    clsPcaPsf.def("isSinglePrecision", &PcaPsf::isSinglePrecision);
 }
 
 }  // namespace
@@ -34,9 +34,10 @@ import lsst.afw.geom.ellipses as afwEll
 import lsst.afw.display as afwDisplay
 import lsst.afw.math as afwMath
 from .psfDeterminer import BasePsfDeterminerTask, psfDeterminerRegistry
-from .psfCandidate import PsfCandidateF
+from .psfCandidate import PsfCandidateF, PsfStampArenaF
 from .spatialModelPsf import createKernelFromPsfCandidates, countPsfCandidates, \
-    fitSpatialKernelFromPsfCandidates, fitKernelParamsToImage
+    fitSpatialKernelFromPsfCandidates, fitKernelParamsToImage, SpatialKernelFitCacheF, \
+    ImageInnerProductCacheF
 from .pcaPsf import PcaPsf
 from . import utils
 
@@ -69,7 +70,8 @@ def numCandidatesToReject(numBadCandidates, numIter, totalIter):
 
 class PcaPsfDeterminerConfig(BasePsfDeterminerTask.ConfigClass):
     nonLinearSpatialFit = pexConfig.Field(
-        doc="Use non-linear fitter for spatial variation of Kernel",
+        doc="Use non-linear fitter for spatial variation of Kernel, rather than solving the linear system "
+            "(which falls back to the non-linear fitter if the system is degenerate)",
         dtype=bool,
         default=False,
     )
@@ -78,6 +80,18 @@ class PcaPsfDeterminerConfig(BasePsfDeterminerTask.ConfigClass):
         dtype=int,
         default=4,
     )
+    incrementalPca = pexConfig.Field(
+        doc="Keep the inner products of the candidates' images between PCA analyses, recomputing only "
+            "those of new or changed images (e.g. after candidates are rejected)?",
+        dtype=bool,
+        default=False,
+    )
+    randomizedPca = pexConfig.Field(
+        doc="Find only the nEigenComponents leading PCA components, with a randomized truncated SVD "
+            "rather than a full eigendecomposition?  The results are approximate.",
+        dtype=bool,
+        default=False,
+    )
     spatialOrder = pexConfig.Field(
         doc="specify spatial order for PSF kernel creation",
         dtype=int,
@@ -122,6 +136,12 @@ class PcaPsfDeterminerConfig(BasePsfDeterminerTask.ConfigClass):
         dtype=int,
         default=3,
     )
+    nIterForSpatialAmplitude = pexConfig.Field(
+        doc="Maximum number of times the linear spatial fit is repeated using the amplitudes of the previous "
+            "fit's model to each candidate; stops early once chi^2 changes by less than tolerance",
+        dtype=int,
+        default=0,
+    )
     tolerance = pexConfig.Field(
         doc="tolerance of spatial fitting",
         dtype=float,
@@ -157,6 +177,17 @@ class PcaPsfDeterminerConfig(BasePsfDeterminerTask.ConfigClass):
         dtype=bool,
         default=True,
     )
+    nThreads = pexConfig.Field(
+        doc="Number of threads used to visit PSF candidates while fitting; the results don't depend on it",
+        dtype=int,
+        default=1,
+    )
+    useStampArena = pexConfig.Field(
+        doc="Store the candidates' stamps in a single block of memory shared by the SpatialCellSet, "
+            "rather than allocating each separately?",
+        dtype=bool,
+        default=False,
+    )
 
 
 class PcaPsfDeterminerTask(BasePsfDeterminerTask):
@@ -164,7 +195,8 @@ class PcaPsfDeterminerTask(BasePsfDeterminerTask):
     """
     ConfigClass = PcaPsfDeterminerConfig
 
-    def _fitPsf(self, exposure, psfCellSet, kernelSize, nEigenComponents):
+    def _fitPsf(self, exposure, psfCellSet, kernelSize, nEigenComponents, spatialFitCache=None,
+                pcaCache=None):
         PsfCandidateF.setPixelThreshold(self.config.pixelThreshold)
         PsfCandidateF.setMaskBlends(self.config.doMaskBlends)
         #
@@ -176,7 +208,8 @@ class PcaPsfDeterminerTask(BasePsfDeterminerTask):
                 kernel, eigenValues = createKernelFromPsfCandidates(
                     psfCellSet, exposure.getDimensions(), exposure.getXY0(), nEigen,
                     self.config.spatialOrder, kernelSize, self.config.nStarPerCell,
-                    bool(self.config.constantWeight))
+                    bool(self.config.constantWeight), nThreads=self.config.nThreads,
+                    randomized=self.config.randomizedPca, cache=pcaCache)
 
                 break                   # OK, we can get nEigen components
             except pexExceptions.LengthError as e:
@@ -196,7 +229,9 @@ class PcaPsfDeterminerTask(BasePsfDeterminerTask):
         # Fit spatial model
         status, chi2 = fitSpatialKernelFromPsfCandidates(
             kernel, psfCellSet, bool(self.config.nonLinearSpatialFit),
-            self.config.nStarPerCellSpatialFit, self.config.tolerance, self.config.lam)
+            self.config.nStarPerCellSpatialFit, self.config.tolerance, self.config.lam,
+            nThreads=self.config.nThreads, nAmplitudeIter=self.config.nIterForSpatialAmplitude,
+            cache=spatialFitCache)
 
         psf = PcaPsf(kernel)
 
@@ -296,6 +331,13 @@ class PcaPsfDeterminerTask(BasePsfDeterminerTask):
         psfCandidateList[0].setHeight(actualKernelSize)
         psfCandidateList[0].setWidth(actualKernelSize)
 
+        if self.config.useStampArena:
+            # Room for each candidate's image and offset image
+            candidates = [cand for cell, cand in candidatesIter(psfCellSet, False)]
+            stampArena = PsfStampArenaF(actualKernelSize, actualKernelSize, 2*len(candidates))
+            for cand in candidates:
+                cand.setStampArena(stampArena)
+
         if self.config.doRejectBlends:
             # Remove blended candidates completely
             blendedCandidates = []  # Candidates to remove; can't do it while iterating
@@ -322,6 +364,10 @@ class PcaPsfDeterminerTask(BasePsfDeterminerTask):
         # Do a PCA decomposition of those PSF candidates
         #
         reply = "y"                         # used in interactive mode
+        # Per-candidate quantities for the spatial fit, reused while the PCA basis doesn't change
+        spatialFitCache = SpatialKernelFitCacheF()
+        # Inner products of the candidates' images, reused by the PCA for candidates that survive
+        pcaCache = ImageInnerProductCacheF() if self.config.incrementalPca else None
         for iterNum in range(self.config.nIterForPsf):
             if display and displayPsfCandidates:  # Show a mosaic of usable PSF candidates
 
@@ -368,7 +414,8 @@ class PcaPsfDeterminerTask(BasePsfDeterminerTask):
                 # First, estimate the PSF
                 #
                 psf, eigenValues, nEigenComponents, fitChi2 = \
-                    self._fitPsf(exposure, psfCellSet, actualKernelSize, nEigenComponents)
+                    self._fitPsf(exposure, psfCellSet, actualKernelSize, nEigenComponents, spatialFitCache,
+                                 pcaCache)
                 #
                 # In clipping, allow all candidates to be innocent until proven guilty on this iteration.
                 # Throw out any prima facie guilty candidates (naughty chi^2 values)
@@ -577,7 +624,13 @@ class PcaPsfDeterminerTask(BasePsfDeterminerTask):
 
         # One last time, to take advantage of the last iteration
         psf, eigenValues, nEigenComponents, fitChi2 = \
-            self._fitPsf(exposure, psfCellSet, actualKernelSize, nEigenComponents)
+            self._fitPsf(exposure, psfCellSet, actualKernelSize, nEigenComponents, spatialFitCache,
+                         pcaCache)
+        self.log.debug("Reused cached spatial fit quantities for %d of %d candidate fits",
+                       spatialFitCache.getHits(), spatialFitCache.getHits() + spatialFitCache.getMisses())
+        if pcaCache is not None:
+            self.log.debug("Reused %d of %d inner products of candidate images for the PCA",
+                           pcaCache.getHits(), pcaCache.getHits() + pcaCache.getMisses())
 
         #
         # Display code for debugging
@@ -31,6 +31,22 @@ namespace meas {
 namespace algorithms {
 namespace {
 
+template <typename PixelT>
+void declarePsfStampArena(py::module& mod, std::string const& suffix) {
+    using Class = PsfStampArena<PixelT>;
+
+    py::class_<Class, std::shared_ptr<Class>> cls(mod, ("PsfStampArena" + suffix).c_str());
+
+    cls.def(py::init<int, int, std::size_t>(), "width"_a, "height"_a, "capacity"_a);
+    cls.def("allocate", &Class::allocate, "dims"_a);
+    cls.def("getWidth", &Class::getWidth);
+    cls.def("getHeight", &Class::getHeight);
+    cls.def("getCapacity", &Class::getCapacity);
+    cls.def("getSize", &Class::getSize);
+    cls.def("__len__", &Class::getSize);
+    cls.def("getMemorySize", &Class::getMemorySize);
+}
+
 template <typename PixelT>
 void declarePsfCandidate(py::module& mod, std::string const& suffix) {
     using Class = PsfCandidate<PixelT>;
@@ -62,6 +78,8 @@ void declarePsfCandidate(py::module& mod, std::string const& suffix) {
                     Class::getMaskedImage,
             "width"_a, "height"_a);
     cls.def("getOffsetImage", &Class::getOffsetImage);
+    cls.def("setStampArena", &Class::setStampArena, "arena"_a);
+    cls.def("getStampArena", &Class::getStampArena);
     cls.def_static("getBorderWidth", &Class::getBorderWidth);
     cls.def_static("setBorderWidth", &Class::setBorderWidth);
     cls.def_static("setPixelThreshold", &Class::setPixelThreshold);
@@ -75,6 +93,7 @@ void declarePsfCandidate(py::module& mod, std::string const& suffix) {
 }  // namespace
 
 PYBIND11_MODULE(psfCandidate, mod) {
+    declarePsfStampArena<float>(mod, "F");
     declarePsfCandidate<float>(mod, "F");
 }
 
@@ -4,9 +4,7 @@ __all__ = ["SkyObjectsConfig", "SkyObjectsTask", "generateSkyObjects"]
 from lsst.pex.config import Config, Field, ListField
 from lsst.pipe.base import Task
 
-import lsst.afw.detection
-import lsst.afw.geom
-import lsst.afw.math
+from .skyObjectPlacement import placeSkyObjects
 
 
 class SkyObjectsConfig(Config):
@@ -35,7 +33,9 @@ def generateSkyObjects(mask, seed, config):
 
     The algorithm for determining sky objects is random trial and error:
     we try up to `nTrialSkySources` random positions to find `nSources`
-    sky objects.
+    sky objects. Positions at which a sky object would overlap the masked
+    pixels or the sky objects already found are rejected (see
+    `placeSkyObjects`).
 
     Parameters
     ----------
@@ -56,39 +56,12 @@ def generateSkyObjects(mask, seed, config):
     if config.nSources <= 0:
         return []
 
-    skySourceRadius = config.sourceRadius
-    nSkySources = config.nSources
     nTrialSkySources = config.nTrialSources
     if nTrialSkySources is None:
-        nTrialSkySources = config.nTrialSourcesMultiplier*nSkySources
+        nTrialSkySources = config.nTrialSourcesMultiplier*config.nSources
 
-    box = mask.getBBox()
-    box.grow(-(int(skySourceRadius) + 1))  # Avoid objects partially off the image
-    xMin, yMin = box.getMin()
-    xMax, yMax = box.getMax()
-
-    avoid = lsst.afw.geom.SpanSet.fromMask(mask, mask.getPlaneBitMask(config.avoidMask))
-    if config.growMask > 0:
-        avoid = avoid.dilated(config.growMask)
-
-    rng = lsst.afw.math.Random(seed=seed)
-
-    skyFootprints = []
-    for _ in range(nTrialSkySources):
-        if len(skyFootprints) == nSkySources:
-            break
-
-        x = int(rng.flat(xMin, xMax))
-        y = int(rng.flat(yMin, yMax))
-        spans = lsst.afw.geom.SpanSet.fromShape(int(skySourceRadius), offset=(x, y))
-        if spans.overlaps(avoid):
-            continue
-
-        fp = lsst.afw.detection.Footprint(spans, mask.getBBox())
-        fp.addPeak(x, y, 0)
-        skyFootprints.append(fp)
-
-    return skyFootprints
+    return placeSkyObjects(mask, mask.getPlaneBitMask(config.avoidMask), int(config.sourceRadius),
+                           config.nSources, nTrialSkySources, seed, config.growMask)
 
 
 class SkyObjectsTask(Task):
@@ -0,0 +1,56 @@
+/*
+ * LSST Data Management System
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ * See the COPYRIGHT file
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include "lsst/meas/algorithms/SpanComponents.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+namespace {
+
+PYBIND11_MODULE(spanComponents, mod) {
+    py::module::import("lsst.afw.geom");
+
+    py::class_<SpanComponents, std::shared_ptr<SpanComponents>> cls(mod, "SpanComponents");
+
+    /* Constructors */
+    cls.def(py::init<std::vector<afw::geom::Span>, bool>(), "spans"_a, "eightConnected"_a = true);
+
+    /* Members */
+    cls.def("getSpans", &SpanComponents::getSpans);
+    cls.def("getLabels", &SpanComponents::getLabels);
+    cls.def("getComponentCount", &SpanComponents::getComponentCount);
+    cls.def("getFirstSpans", &SpanComponents::getFirstSpans);
+    cls.def("getLastSpans", &SpanComponents::getLastSpans);
+    cls.def("getComponentSpans", &SpanComponents::getComponentSpans);
+    cls.def("makeSpanSets", &SpanComponents::makeSpanSets);
+}
+
+}  // namespace
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
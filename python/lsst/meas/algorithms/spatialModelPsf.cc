@@ -32,31 +32,66 @@ namespace meas {
 namespace algorithms {
 namespace {
 
+template <typename PixelT>
+static void declareSpatialKernelFitCache(py::module &mod, std::string const &suffix) {
+    using Class = SpatialKernelFitCache<PixelT>;
+
+    py::class_<Class, std::shared_ptr<Class>> cls(mod, ("SpatialKernelFitCache" + suffix).c_str());
+
+    cls.def(py::init<>());
+    cls.def("clear", &Class::clear);
+    cls.def("size", &Class::size);
+    cls.def("__len__", &Class::size);
+    cls.def("getHits", &Class::getHits);
+    cls.def("getMisses", &Class::getMisses);
+}
+
+template <typename PixelT>
+static void declareImageInnerProductCache(py::module &mod, std::string const &suffix) {
+    using Class = ImageInnerProductCache<afw::image::MaskedImage<PixelT>>;
+
+    py::class_<Class, std::shared_ptr<Class>> cls(mod, ("ImageInnerProductCache" + suffix).c_str());
+
+    cls.def(py::init<>());
+    cls.def("clear", &Class::clear);
+    cls.def("size", &Class::size);
+    cls.def("__len__", &Class::size);
+    cls.def("getHits", &Class::getHits);
+    cls.def("getMisses", &Class::getMisses);
+}
+
 template <typename PixelT>
 static void declareFunctions(py::module &mod) {
     using MaskedImageT = afw::image::MaskedImage<PixelT, afw::image::MaskPixel, afw::image::VariancePixel>;
 
     mod.def("createKernelFromPsfCandidates", createKernelFromPsfCandidates<PixelT>, "psfCells"_a, "dims"_a,
             "xy0"_a, "nEigenComponents"_a, "spatialOrder"_a, "ksize"_a, "nStarPerCell"_a = -1,
-            "constantWeight"_a = true, "border"_a = 3);
+            "constantWeight"_a = true, "border"_a = 3, "nThreads"_a = 1, "randomized"_a = false,
+            "cache"_a = nullptr, py::call_guard<py::gil_scoped_release>());
     mod.def("countPsfCandidates", countPsfCandidates<PixelT>, "psfCells"_a, "nStarPerCell"_a = -1);
     mod.def("fitSpatialKernelFromPsfCandidates",
             (std::pair<bool, double>(*)(afw::math::Kernel *, afw::math::SpatialCellSet const &, int const,
-                                        double const, double const))fitSpatialKernelFromPsfCandidates<PixelT>,
-            "kernel"_a, "psfCells"_a, "nStarPerCell"_a = -1, "tolerance"_a = 1e-5, "lambda"_a = 0.0);
+                                        double const, double const,
+                                        int const))fitSpatialKernelFromPsfCandidates<PixelT>,
+            "kernel"_a, "psfCells"_a, "nStarPerCell"_a = -1, "tolerance"_a = 1e-5, "lambda"_a = 0.0,
+            "nThreads"_a = 1, py::call_guard<py::gil_scoped_release>());
     mod.def("fitSpatialKernelFromPsfCandidates",
             (std::pair<bool, double>(*)(afw::math::Kernel *, afw::math::SpatialCellSet const &, bool const,
-                                        int const, double const,
-                                        double const))fitSpatialKernelFromPsfCandidates<PixelT>,
+                                        int const, double const, double const, int const, int const,
+                                        SpatialKernelFitCache<PixelT> *))
+                    fitSpatialKernelFromPsfCandidates<PixelT>,
             "kernel"_a, "psfCells"_a, "doNonLinearFit"_a, "nStarPerCell"_a = -1, "tolerance"_a = 1e-5,
-            "lambda"_a = 0.0);
+            "lambda"_a = 0.0, "nThreads"_a = 1, "nAmplitudeIter"_a = 0, "cache"_a = nullptr,
+            py::call_guard<py::gil_scoped_release>());
     mod.def("subtractPsf", subtractPsf<MaskedImageT>, "psf"_a, "data"_a, "x"_a, "y"_a,
-            "psfFlux"_a = std::numeric_limits<double>::quiet_NaN());
+            "psfFlux"_a = std::numeric_limits<double>::quiet_NaN(), py::call_guard<py::gil_scoped_release>());
     mod.def("fitKernelParamsToImage", fitKernelParamsToImage<MaskedImageT>, "kernel"_a, "image"_a, "pos"_a);
     mod.def("fitKernelToImage", fitKernelToImage<MaskedImageT>, "kernel"_a, "image"_a, "pos"_a);
 }
 
 PYBIND11_MODULE(spatialModelPsf, mod) {
+    declareSpatialKernelFitCache<float>(mod, "F");
+    declareImageInnerProductCache<float>(mod, "F");
     declareFunctions<float>(mod);
 }
 
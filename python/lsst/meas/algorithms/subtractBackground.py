@@ -34,6 +34,7 @@ import lsst.afw.image as afwImage
 import lsst.afw.math as afwMath
 import lsst.pex.config as pexConfig
 import lsst.pipe.base as pipeBase
+from .backgroundStatistics import computeBackgroundStatistics
 
 
 class SubtractBackgroundConfig(pexConfig.Config):
@@ -114,6 +115,15 @@ class SubtractBackgroundConfig(pexConfig.Config):
         doc="Use inverse variance weighting in calculation (valid only with useApprox=True)",
         dtype=bool, default=True,
     )
+    doFastStatistics = pexConfig.Field(
+        doc=("Compute the statistics of the bins with the multithreaded computeBackgroundStatistics rather "
+             "than lsst.afw.math.makeBackground? NaN pixels are always ignored."),
+        dtype=bool, default=False,
+    )
+    nThreads = pexConfig.RangeField(
+        doc="Number of threads used to compute the statistics of the bins (if doFastStatistics)",
+        dtype=int, default=1, min=1,
+    )
 
 
 ## @addtogroup LSST_task_documentation
@@ -237,7 +247,8 @@ class SubtractBackgroundTask(pipeBase.Task):
 
         maskedImage = exposure.getMaskedImage()
         fitBg = self.fitBackground(maskedImage)
-        maskedImage -= fitBg.getImageF(self.config.algorithm, self.config.undersampleStyle)
+        fitImage = fitBg.getImageF(self.config.algorithm, self.config.undersampleStyle)
+        maskedImage -= fitImage
 
         actrl = fitBg.getBackgroundControl().getApproximateControl()
         background.append((fitBg, getattr(afwMath.Interpolate, self.config.algorithm),
@@ -245,7 +256,9 @@ class SubtractBackgroundTask(pipeBase.Task):
                            actrl.getOrderX(), actrl.getOrderY(), actrl.getWeighting()))
 
         if stats:
-            self._addStats(exposure, background, statsKeys=statsKeys)
+            # If this is the only background, its image is the net background; don't make it again
+            self._addStats(exposure, background, statsKeys=statsKeys,
+                           netBgImg=fitImage if len(background) == 1 else None)
 
         subFrame = getDebugFrame(self._display, "subtracted")
         if subFrame:
@@ -262,7 +275,7 @@ class SubtractBackgroundTask(pipeBase.Task):
             background=background,
         )
 
-    def _addStats(self, exposure, background, statsKeys=None):
+    def _addStats(self, exposure, background, statsKeys=None, netBgImg=None):
         """Add statistics about the background to the exposure's metadata
 
         @param[in,out] exposure  exposure whose background was subtracted
@@ -270,8 +283,11 @@ class SubtractBackgroundTask(pipeBase.Task):
         @param[in] statsKeys  key names used to store the mean and variance of the background
             in the exposure's metadata (a pair of strings); if None then use ("BGMEAN", "BGVAR");
             ignored if stats is false
+        @param[in] netBgImg  image of the background model, if already available; if None then
+            it is made from background
         """
-        netBgImg = background.getImage()
+        if netBgImg is None:
+            netBgImg = background.getImage()
         if statsKeys is None:
             statsKeys = ("BGMEAN", "BGVAR")
         mnkey, varkey = statsKeys
@@ -282,13 +298,19 @@ class SubtractBackgroundTask(pipeBase.Task):
         meta.addDouble(mnkey, bgmean)
         meta.addDouble(varkey, bgvar)
 
-    def fitBackground(self, maskedImage, nx=0, ny=0, algorithm=None):
+    def fitBackground(self, maskedImage, nx=0, ny=0, algorithm=None, statsImage=None):
         """!Estimate the background of a masked image
 
         @param[in] maskedImage  masked image whose background is to be computed
         @param[in] nx  number of x bands; if 0 compute from width and config.binSizeX
         @param[in] ny  number of y bands; if 0 compute from height and config.binSizeY
         @param[in] algorithm  name of interpolation algorithm; if None use self.config.algorithm
+        @param[in] statsImage  statistics of the bins (an lsst.afw.image.MaskedImageF, e.g. from the
+            getStatsImage method of an earlier fit of the same image) to reuse, rather than measure
+            again; useful when only the interpolation or undersample style is to change.
+            Must match the grid of bins.
+
+        @throw ValueError if statsImage doesn't match the grid of bins
 
         @return fit background as an lsst.afw.math.Background
 
@@ -384,7 +406,26 @@ class SubtractBackgroundTask(pipeBase.Task):
                                                self.config.weighting)
             bctrl.setApproximateControl(actrl)
 
-        bg = afwMath.makeBackground(maskedImage, bctrl)
+        if self.config.doFastStatistics or statsImage is not None:
+            nBins = (bctrl.getNxSample(), bctrl.getNySample())
+            if statsImage is None:
+                statsImage = computeBackgroundStatistics(
+                    maskedImage, nBins[0], nBins[1], sctrl,
+                    afwMath.stringToStatisticsProperty(self.config.statisticsProperty), self.config.nThreads
+                )
+            elif (statsImage.getWidth(), statsImage.getHeight()) != nBins:
+                raise ValueError("Statistics image is %dx%d, but there are %dx%d bins" %
+                                 (statsImage.getWidth(), statsImage.getHeight(), nBins[0], nBins[1]))
+            bg = afwMath.BackgroundMI(maskedImage.getBBox(), statsImage)
+            # Copy the control, so that getImageF et al. behave as for a Background from makeBackground
+            bgCtrl = bg.getBackgroundControl()
+            bgCtrl.setInterpStyle(bctrl.getInterpStyle())
+            bgCtrl.setUndersampleStyle(bctrl.getUndersampleStyle())
+            bgCtrl.setStatisticsControl(bctrl.getStatisticsControl())
+            bgCtrl.setStatisticsProperty(bctrl.getStatisticsProperty())
+            bgCtrl.setApproximateControl(bctrl.getApproximateControl())
+        else:
+            bg = afwMath.makeBackground(maskedImage, bctrl)
         if bg is None:
             raise RuntimeError("lsst.afw.math.makeBackground failed to fit a background model")
         return bg
@@ -24,6 +24,7 @@
 namespace py = pybind11;
 using namespace pybind11::literals;
 
+#include "lsst/meas/algorithms/PsfEvaluationLock.h"
 #include "lsst/meas/algorithms/WarpedPsf.h"
 
 namespace lsst {
@@ -32,6 +33,17 @@ namespace algorithms {
 namespace {
 
 PYBIND11_MODULE(warpedPsf, mod) {
+    py::class_<LanczosStampWarper, std::shared_ptr<LanczosStampWarper>> clsStampWarper(mod,
+                                                                                    "LanczosStampWarper");
+    clsStampWarper.def(py::init<int, int>(), "order"_a, "tableSize"_a = 10000);
+    clsStampWarper.def_static("fromWarpingControl", [](afw::math::WarpingControl const &control) {
+        return std::const_pointer_cast<LanczosStampWarper>(LanczosStampWarper::fromWarpingControl(control));
+    });
+    clsStampWarper.def("warp", &LanczosStampWarper::warp, "src"_a, "srcToDest"_a, "dest"_a,
+                       py::call_guard<py::gil_scoped_release>());
+    clsStampWarper.def("getOrder", &LanczosStampWarper::getOrder);
+    clsStampWarper.def("getTableSize", &LanczosStampWarper::getTableSize);
+
     py::class_<WarpedPsf, std::shared_ptr<WarpedPsf>, ImagePsf> clsWarpedPsf(mod, "WarpedPsf");
 
     /* Constructors */
@@ -43,10 +55,31 @@ PYBIND11_MODULE(warpedPsf, mod) {
                               std::shared_ptr<afw::geom::TransformPoint2ToPoint2 const>, std::string const &,
                               unsigned int>(),
                      "undistortedPsf"_a, "distortion"_a, "kernelName"_a = "lanczos3", "cache"_a = 10000);
+    clsWarpedPsf.def(py::init<std::shared_ptr<afw::detection::Psf const>,
+                              std::shared_ptr<afw::geom::TransformPoint2ToPoint2 const>,
+                              std::shared_ptr<afw::math::WarpingControl const>, double, std::size_t,
+                              std::shared_ptr<LanczosStampWarper const>>(),
+                     "undistortedPsf"_a, "distortion"_a, "control"_a, "imageCacheTolerance"_a,
+                     "imageCacheMaxBytes"_a, "stampWarper"_a = nullptr);
 
     /* Members */
     clsWarpedPsf.def("getAveragePosition", &WarpedPsf::getAveragePosition);
     clsWarpedPsf.def("clone", &WarpedPsf::clone);
+    clsWarpedPsf.def("computeKernelImageInto",
+                     [](WarpedPsf const &self, WarpedPsf::Image &out, geom::Point2D const &position,
+                        afw::image::Color const &color) {
+                         // As the other evaluation methods (see imagePsf.cc)
+                         PsfEvaluationLock lock(self);
+                         return self.computeKernelImageInto(out, position, color);
+                     },
+                     "out"_a, "position"_a, "color"_a = afw::image::Color(),
+                     py::call_guard<py::gil_scoped_release>());
+    clsWarpedPsf.def("getStampWarper", [](WarpedPsf const &self) {
+        return std::const_pointer_cast<LanczosStampWarper>(self.getStampWarper());
+    });
+    clsWarpedPsf.def("getImageCache", [](WarpedPsf const &self) {
+        return std::const_pointer_cast<PsfImageCache>(self.getImageCache());
+    });
 }
 
 }  // namespace
@@ -0,0 +1,238 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <thread>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/algorithms/BackgroundStatistics.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+namespace {
+
+// Conversion from interquartile range to standard deviation for a Gaussian, as used by afw
+double const IQ_TO_STDEV = 0.741301109252802;
+
+/*
+ * Call processBands(j0, j1) for consecutive blocks of bands covering [0, nBand), using up to nThreads
+ * threads (including the calling one).  Any exception is rethrown once all the threads have finished.
+ */
+template <typename ProcessBands>
+void forEachBandBlock(int const nBand, int const nThreads, ProcessBands const& processBands) {
+    int const nBlocks = std::max(1, std::min(nThreads, nBand));
+    if (nBlocks == 1) {
+        processBands(0, nBand);
+        return;
+    }
+
+    std::vector<int> starts(nBlocks + 1);  // first band of each block
+    for (int k = 0; k <= nBlocks; ++k) {
+        starts[k] = static_cast<int>(static_cast<long>(nBand) * k / nBlocks);
+    }
+    std::vector<std::exception_ptr> errors(nBlocks);
+    auto work = [&](int k) {
+        try {
+            processBands(starts[k], starts[k + 1]);
+        } catch (...) {
+            errors[k] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(nBlocks - 1);
+    for (int k = 1; k < nBlocks; ++k) {
+        workers.emplace_back(work, k);
+    }
+    work(0);  // the calling thread processes the first block
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto const& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+// Return the given fraction of the values, interpolating linearly; reorders the values
+double percentile(std::vector<double>& values, double fraction) {
+    std::size_t const n = values.size();
+    if (n == 1) {
+        return values[0];
+    }
+    double const index = fraction * (n - 1);
+    std::size_t const lower = static_cast<std::size_t>(index);
+    std::nth_element(values.begin(), values.begin() + lower, values.end());
+    double const low = values[lower];
+    if (lower + 1 >= n) {
+        return low;
+    }
+    double const high = *std::min_element(values.begin() + lower + 1, values.end());
+    return low + (index - lower) * (high - low);
+}
+
+struct Moments {
+    std::size_t n;
+    double mean;
+    double variance;
+};
+
+// Mean and (unbiased) variance of the values within halfWidth of center
+Moments computeMoments(std::vector<double> const& values, double center, double halfWidth) {
+    std::size_t n = 0;
+    double sum = 0.0;
+    for (double value : values) {
+        if (std::abs(value - center) <= halfWidth) {
+            ++n;
+            sum += value - center;
+        }
+    }
+    if (n == 0) {
+        return Moments{0, std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN()};
+    }
+    double const offset = sum / n;
+    double sumSq = 0.0;
+    for (double value : values) {
+        if (std::abs(value - center) <= halfWidth) {
+            double const delta = value - center - offset;
+            sumSq += delta * delta;
+        }
+    }
+    double const variance = (n > 1) ? sumSq / (n - 1) : std::numeric_limits<double>::quiet_NaN();
+    return Moments{n, center + offset, variance};
+}
+
+// Compute a bin's statistic and the square of its error; reorders the values
+std::pair<double, double> computeStatistic(std::vector<double>& values, afw::math::Property property,
+                                           afw::math::StatisticsControl const& sctrl) {
+    double const nan = std::numeric_limits<double>::quiet_NaN();
+    if (values.empty()) {
+        return std::make_pair(nan, nan);
+    }
+    double const infinity = std::numeric_limits<double>::infinity();
+    if (property == afw::math::MEAN) {
+        Moments const moments = computeMoments(values, 0.0, infinity);
+        return std::make_pair(moments.mean, moments.variance / moments.n);
+    }
+    if (property == afw::math::MEDIAN) {
+        Moments const moments = computeMoments(values, 0.0, infinity);
+        double const median = percentile(values, 0.5);
+        // Asymptotic variance of the median for Gaussian data
+        return std::make_pair(median, 0.5 * M_PI * moments.variance / moments.n);
+    }
+    double const median = percentile(values, 0.5);
+    double const iqRange = percentile(values, 0.75) - percentile(values, 0.25);
+    double center = median;
+    double halfWidth = sctrl.getNumSigmaClip() * IQ_TO_STDEV * iqRange;
+    Moments moments{0, nan, nan};
+    for (int i = 0; i < sctrl.getNumIter(); ++i) {
+        moments = computeMoments(values, center, halfWidth);
+        if (moments.n == 0) {
+            break;
+        }
+        center = moments.mean;
+        if (moments.n > 1) {
+            halfWidth = sctrl.getNumSigmaClip() * std::sqrt(moments.variance);
+        }
+    }
+    return std::make_pair(moments.mean, moments.variance / moments.n);
+}
+
+}  // namespace
+
+std::vector<int> makeBackgroundBinEdges(int length, int n) {
+    std::vector<int> edges(n + 1, 0);
+    for (int i = 0; i < n; ++i) {
+        edges[i + 1] = std::min(static_cast<int>((static_cast<long>(i + 1) * length + n / 2) / n), length);
+    }
+    return edges;
+}
+
+template <typename PixelT>
+std::shared_ptr<afw::image::MaskedImage<float>> computeBackgroundStatistics(
+        afw::image::MaskedImage<PixelT> const& image, int nx, int ny,
+        afw::math::StatisticsControl const& sctrl, afw::math::Property property, int nThreads) {
+    if (nx <= 0 || ny <= 0 || nx > image.getWidth() || ny > image.getHeight()) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Cannot divide a %dx%d image into %dx%d bins") % image.getWidth() %
+                           image.getHeight() % nx % ny)
+                                  .str());
+    }
+    if (property != afw::math::MEAN && property != afw::math::MEANCLIP && property != afw::math::MEDIAN) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          "Only MEAN, MEANCLIP and MEDIAN background statistics are supported");
+    }
+
+    std::vector<int> const xEdges = makeBackgroundBinEdges(image.getWidth(), nx);
+    std::vector<int> const yEdges = makeBackgroundBinEdges(image.getHeight(), ny);
+    auto stats = std::make_shared<afw::image::MaskedImage<float>>(geom::Extent2I(nx, ny));
+    auto const inImage = image.getImage()->getArray();
+    auto const inMask = image.getMask()->getArray();
+    auto const outImage = stats->getImage()->getArray();
+    auto const outVariance = stats->getVariance()->getArray();
+    afw::image::MaskPixel const andMask = sctrl.getAndMask();
+
+    forEachBandBlock(ny, nThreads, [&](int j0, int j1) {
+        std::vector<std::vector<double>> values(nx);  // reused from band to band
+        for (int j = j0; j < j1; ++j) {
+            for (auto& binValues : values) {
+                binValues.clear();
+            }
+            for (int y = yEdges[j]; y < yEdges[j + 1]; ++y) {
+                PixelT const* imageRow = inImage[y].getData();
+                afw::image::MaskPixel const* maskRow = inMask[y].getData();
+                for (int i = 0; i < nx; ++i) {
+                    auto& binValues = values[i];
+                    for (int x = xEdges[i]; x < xEdges[i + 1]; ++x) {
+                        if ((maskRow[x] & andMask) == 0 && !std::isnan(imageRow[x])) {
+                            binValues.push_back(imageRow[x]);
+                        }
+                    }
+                }
+            }
+            for (int i = 0; i < nx; ++i) {
+                auto const result = computeStatistic(values[i], property, sctrl);
+                outImage[j][i] = result.first;
+                outVariance[j][i] = result.second;
+            }
+        }
+    });
+    return stats;
+}
+
+#define INSTANTIATE(TYPE)                                                                         \
+    template std::shared_ptr<afw::image::MaskedImage<float>> computeBackgroundStatistics(        \
+            afw::image::MaskedImage<TYPE> const&, int, int, afw::math::StatisticsControl const&, \
+            afw::math::Property, int);
+
+INSTANTIATE(float)
+INSTANTIATE(double)
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
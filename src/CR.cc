@@ -32,8 +32,13 @@
 #include <stdexcept>
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <exception>
+#include <memory>
 #include <string>
+#include <thread>
 #include <typeinfo>
+#include <vector>
 
 #include <iostream>
 
@@ -48,64 +53,10 @@
 #include "lsst/afw/image/MaskedImage.h"
 #include "lsst/afw/math/Random.h"
 #include "lsst/meas/algorithms/CR.h"
+#include "lsst/meas/algorithms/Instrumentation.h"
 #include "lsst/meas/algorithms/Interp.h"
-
-/**
- * @todo These should go into afw --- actually, there're already there, but
- * in an anon namespace
- */
-namespace lsst {
-namespace afw {
-namespace detection {
-/**
- * run-length code for part of object
- */
-class IdSpan {
-public:
-    typedef std::shared_ptr<IdSpan> Ptr;
-    typedef std::shared_ptr<const IdSpan> ConstPtr;
-
-    explicit IdSpan(int id, int y, int x0, int x1) : id(id), y(y), x0(x0), x1(x1) {}
-    int id;     /* ID for object */
-    int y;      /* Row wherein IdSpan dwells */
-    int x0, x1; /* inclusive range of columns */
-};
-/**
- * comparison functor; sort by ID, then by row (y), then by column range start (x0)
- */
-struct IdSpanCompar : public std::binary_function<const IdSpan::ConstPtr, const IdSpan::ConstPtr, bool> {
-    bool operator()(const IdSpan::ConstPtr a, const IdSpan::ConstPtr b) {
-        if (a->id < b->id) {
-            return true;
-        } else if (a->id > b->id) {
-            return false;
-        } else {
-            if (a->y < b->y) {
-                return true;
-            } else if (a->y > b->y) {
-                return false;
-            } else {
-                return (a->x0 < b->x0) ? true : false;
-            }
-        }
-    }
-};
-/**
- * Follow a chain of aliases, returning the final resolved value.
- */
-int resolve_alias(const std::vector<int> &aliases, /* list of aliases */
-                  int id) {                        /* alias to look up */
-    int resolved = id;                             /* resolved alias */
-
-    while (id != aliases[id]) {
-        resolved = id = aliases[id];
-    }
-
-    return (resolved);
-}
-}  // namespace detection
-}  // namespace afw
-}  // namespace lsst
+#include "lsst/meas/algorithms/PsfEvaluationLock.h"
+#include "lsst/meas/algorithms/SpanComponents.h"
 
 namespace lsst {
 namespace meas {
@@ -116,7 +67,8 @@ namespace {
 template <typename ImageT, typename MaskT>
 void removeCR(afw::image::MaskedImage<ImageT, MaskT> &mi,
               std::vector<std::shared_ptr<afw::detection::Footprint>> &CRs, double const bkgd, MaskT const,
-              MaskT const saturBit, MaskT const badMask, bool const debias, bool const grow);
+              MaskT const saturBit, MaskT const badMask, bool const debias, bool const grow,
+              afw::math::Random &rand);
 
 template <typename ImageT>
 bool condition_3(ImageT *estimate, double const peak, double const mean_ns, double const mean_we,
@@ -131,30 +83,43 @@ template <typename ImageT>
 struct CRPixel {
     typedef typename std::shared_ptr<CRPixel> Ptr;
 
-    CRPixel(int _col, int _row, ImageT _val, int _id = -1) : id(_id), col(_col), row(_row), val(_val) {
-        _i = ++i;
-    }
+    CRPixel(int _col, int _row, ImageT _val, int _index) : col(_col), row(_row), val(_val), _i(_index) {}
     ~CRPixel() {}
 
     bool operator<(const CRPixel &a) const { return _i < a._i; }
 
     int get_i() const { return _i; }
 
-    int id;      // Unique ID for cosmic ray (not cosmic ray pixel)
     int col;     // position
     int row;     //    of pixel
     ImageT val;  // initial value of pixel
 private:
-    static int i;    // current value of running index
     int mutable _i;  // running index
 };
 
+//
+// The state of a single call to findCosmicRays.  Nothing is shared between calls, so findCosmicRays may
+// be called on different images concurrently.
+//
 template <typename ImageT>
-int CRPixel<ImageT>::i = 0;
+struct CrCallState {
+    CrCallState() : nPixel(0) {}
 
-template <typename ImageT>
-struct Sort_CRPixel_by_id {
-    bool operator()(CRPixel<ImageT> const &a, CRPixel<ImageT> const &b) const { return a.id < b.id; }
+    // Add a pixel to the list of detected pixels, numbering it in birth order
+    void addPixel(int col, int row, ImageT val) {
+        pixels.push_back(CRPixel<ImageT>(col, row, val, ++nPixel));
+    }
+
+    // Return a random number generator for removeCR; every removal pass starts from the same state
+    afw::math::Random &resetRandom() {
+        random.reset(new afw::math::Random());
+        return *random;
+    }
+
+    std::vector<CRPixel<ImageT>> pixels;       // detected CR-contaminated pixels
+    int nPixel;                                // number of pixels ever added to pixels
+    std::unique_ptr<afw::math::Random> random;  // used to fill pixels with no good estimate
+    std::vector<afw::geom::Span> extraSpans;   // scratch space for checkSpanForCRs
 };
 
 /*****************************************************************************/
@@ -163,15 +128,14 @@ struct Sort_CRPixel_by_id {
  *
  * Note that the pixel in question is at index 0, so its value is pt_0[0]
  */
-template <typename MaskedImageT>
-bool is_cr_pixel(typename MaskedImageT::Image::Pixel *corr,  // corrected value
-                 typename MaskedImageT::xy_locator loc,      // locator for this pixel
-                 double const minSigma,                      // minSigma, or -threshold if negative
+template <typename ImagePixel, typename Locator>
+bool is_cr_pixel(ImagePixel *corr,        // corrected value
+                 Locator loc,             // locator for this pixel (an xy_locator or a CrRowLocator)
+                 double const minSigma,   // minSigma, or -threshold if negative
                  double const thresH, double const thresV, double const thresD,  // for condition #3
                  double const bkgd,     // unsubtracted background level
                  double const cond3Fac  // fiddle factor for condition #3
 ) {
-    typedef typename MaskedImageT::Image::Pixel ImagePixel;
     //
     // Unpack some values
     //
@@ -234,14 +198,14 @@ bool is_cr_pixel(typename MaskedImageT::Image::Pixel *corr,  // corrected value
 // to the left and just to the right)
 //
 template <typename MaskedImageT>
-void checkSpanForCRs(afw::detection::Footprint *extras,  // Extra spans get added to this Footprint
-                     std::vector<CRPixel<typename MaskedImageT::Image::Pixel>> &crpixels,
-                     // a list of pixels containing CRs
+void checkSpanForCRs(std::vector<afw::geom::Span> &extras,  // Extra spans get added to this list
+                     CrCallState<typename MaskedImageT::Image::Pixel> &state,
+                     // the list of pixels containing CRs
                      int const y,                 // the row to process
                      int const x0, int const x1,  // range of pixels in the span (inclusive)
                      MaskedImageT &image,         ///< Image to search
                      double const minSigma,       // minSigma
-                     double const thresH, double const thresV, double const thresD,  // for cond. #3
+                     CrDetectionContext const &context,  // thresholds for cond. #3
                      double const bkgd,      // unsubtracted background level
                      double const cond3Fac,  // fiddle factor for condition #3
                      bool const keep         // if true, don't remove the CRs
@@ -254,317 +218,562 @@ void checkSpanForCRs(afw::detection::Footprint *extras,  // Extra spans get adde
 
     for (int x = x0 - 1; x <= x1 + 1; ++x) {
         MImagePixel corr = 0;  // new value for pixel
-        if (is_cr_pixel<MaskedImageT>(&corr, loc, minSigma, thresH, thresV, thresD, bkgd, cond3Fac)) {
+        CrDetectionContext::Thresholds const thres = context.getThresholds(x + imageX0, y + imageY0);
+        if (is_cr_pixel(&corr, loc, minSigma, thres.horizontal, thres.vertical, thres.diagonal, bkgd,
+                        cond3Fac)) {
             if (keep) {
-                crpixels.push_back(CRPixel<MImagePixel>(x + imageX0, y + imageY0, loc.image()));
+                state.addPixel(x + imageX0, y + imageY0, loc.image());
             }
             loc.image() = corr;
 
-            std::vector<afw::geom::Span> spanList(extras->getSpans()->begin(), extras->getSpans()->end());
-            spanList.push_back(afw::geom::Span(y + imageY0, x + imageX0, x + imageX0));
-            extras->setSpans(std::make_shared<afw::geom::SpanSet>(std::move(spanList)));
+            extras.push_back(afw::geom::Span(y + imageY0, x + imageX0, x + imageX0));
         }
         ++loc.x();
     }
 }
 
 /************************************************************************************************************/
-/*
- * Find the sum of the pixels in a Footprint
- */
-template <typename ImageT>
-class CountsInCR {
+//
+// A stand-in for an xy_locator that reads the rows just below, at and just above the pixel of interest
+// from separate buffers.  This lets the first pass see its own preliminary corrections without writing
+// them into the image.
+//
+template <typename ImagePixel, typename VariancePixel, typename MaskPixel>
+class CrRowLocator {
 public:
-    CountsInCR(double const bkgd) : _bkgd(bkgd), _sum(0.0) {}
-
-    void operator()(geom::Point2I const &point, ImageT const &val) { _sum += val - _bkgd; }
+    CrRowLocator(ImagePixel const *const image[3], VariancePixel const *const variance[3],
+                 MaskPixel const *const mask[3], int x)
+            : _x(x) {
+        for (int i = 0; i != 3; ++i) {
+            _image[i] = image[i];
+            _variance[i] = variance[i];
+            _mask[i] = mask[i];
+        }
+    }
 
-    virtual void reset(afw::detection::Footprint const &) {}
-    virtual void reset() { _sum = 0.0; }
+    ImagePixel image(int dx, int dy) const { return _image[dy + 1][_x + dx]; }
+    ImagePixel image() const { return _image[1][_x]; }
+    VariancePixel variance(int dx, int dy) const { return _variance[dy + 1][_x + dx]; }
+    VariancePixel variance() const { return _variance[1][_x]; }
+    MaskPixel mask(int dx, int dy) const { return _mask[dy + 1][_x + dx]; }
+    MaskPixel mask() const { return _mask[1][_x]; }
 
-    double getCounts() const { return _sum; }
+    int &x() { return _x; }
 
 private:
-    double const _bkgd;  // the Image's background level
-    ImageT _sum;         // the sum of all DN in the Footprint, corrected for bkgd
+    ImagePixel const *_image[3];  // rows y - 1, y, y + 1
+    VariancePixel const *_variance[3];
+    MaskPixel const *_mask[3];
+    int _x;
 };
-}  // namespace
 
-/*
- * Restore all the pixels in crpixels to their pristine state
- */
-template <typename ImageT>
-static void reinstateCrPixels(
-        ImageT *image,                                                // the image in question
-        std::vector<CRPixel<typename ImageT::Pixel>> const &crpixels  // a list of pixels with CRs
-) {
-    if (crpixels.empty()) return;
+//
+// A pixel accepted by the first pass, with its preliminary corrected value
+//
+template <typename ImagePixel>
+struct CrCandidate {
+    int x;            // column, relative to the image's origin
+    ImagePixel val;   // initial value of pixel
+    ImagePixel corr;  // preliminary estimate of the uncontaminated value
 
-    typedef typename std::vector<CRPixel<typename ImageT::Pixel>>::const_iterator crpixel_iter;
-    for (crpixel_iter crp = crpixels.begin(), end = crpixels.end(); crp < end - 1; ++crp) {
-        *image->at(crp->col - image->getX0(), crp->row - image->getY0()) = crp->val;
-    }
-}
+    bool operator==(CrCandidate const &other) const { return x == other.x && corr == other.corr; }
+};
 
-/*!
- * @brief Find cosmic rays in an Image, and mask and remove them
- *
- * @return vector of CR's Footprints
- */
+//
+// The first pass of findCosmicRays: find the pixels that satisfy conditions #2--#4.
+//
+// Pixels are visited in row-major order and each contaminated pixel is replaced by its preliminary
+// estimate before its neighbours are examined, which increases the detection rate.  The outcome for row
+// y therefore depends on the corrected values of row y - 1 (and on those to its left in row y), but only
+// on the original values of row y + 1.  The corrected rows are kept in buffers rather than in the image,
+// so the image is never modified and horizontal strips can be searched concurrently.
+//
+// A strip cannot know the corrections in the row above it until the strip above is done, and starts from
+// the original values instead.  Once all strips are done the boundaries are revisited in order: each row
+// from the first row of a strip down is searched again using the (now final) row above, stopping at the
+// first row whose candidates are unchanged, as everything below such a row is then unchanged too.  The
+// result is identical to a single serial pass; usually only one row per boundary has to be repeated.
+//
 template <typename MaskedImageT>
-std::vector<std::shared_ptr<afw::detection::Footprint>> findCosmicRays(
-        MaskedImageT &mimage,               ///< Image to search
-        afw::detection::Psf const &psf,     ///< the Image's PSF
-        double const bkgd,                  ///< unsubtracted background of frame, DN
-        daf::base::PropertySet const &ps,   ///< PropertySet directing the behavior
-        bool const keep                     ///< if true, don't remove the CRs
-) {
-    typedef typename MaskedImageT::Image ImageT;
-    typedef typename ImageT::Pixel ImagePixel;
+class CrCandidateFinder {
+public:
+    typedef typename MaskedImageT::Image::Pixel ImagePixel;
+    typedef typename MaskedImageT::Variance::Pixel VariancePixel;
     typedef typename MaskedImageT::Mask::Pixel MaskPixel;
+    typedef std::vector<CrCandidate<ImagePixel>> RowCandidates;
 
-    // Parse the PropertySet
-    double const minSigma = ps.getAsDouble("minSigma");       // min sigma over sky in pixel for CR candidate
-    double const minDn = ps.getAsDouble("min_DN");            // min number of DN in an CRs
-    double const cond3Fac = ps.getAsDouble("cond3_fac");      // fiddle factor for condition #3
-    double const cond3Fac2 = ps.getAsDouble("cond3_fac2");    // 2nd fiddle factor for condition #3
-    int const niteration = ps.getAsInt("niteration");         // Number of times to look for contaminated
-                                                              // pixels near CRs
-    int const nCrPixelMax = ps.getAsInt("nCrPixelMax");       // maximum number of contaminated pixels
-                                                              /*
-                                                               * thresholds for 3rd condition
-                                                               *
-                                                               * Realise PSF at center of image
-                                                               */
-    std::shared_ptr<afw::math::Kernel const> kernel = psf.getLocalKernel();
-    if (!kernel) {
-        throw LSST_EXCEPT(pexExcept::NotFoundError, "Psf is unable to return a kernel");
-    }
-    afw::detection::Psf::Image psfImage =
-            afw::detection::Psf::Image(geom::ExtentI(kernel->getWidth(), kernel->getHeight()));
-    kernel->computeImage(psfImage, true);
+    CrCandidateFinder(MaskedImageT const &mimage, CrDetectionContext const &context, double const bkgd)
+            : _image(mimage.getImage()->getArray()),
+              _variance(mimage.getVariance()->getArray()),
+              _mask(mimage.getMask()->getArray()),
+              _ncol(mimage.getWidth()),
+              _nrow(mimage.getHeight()),
+              _x0(mimage.getX0()),
+              _y0(mimage.getY0()),
+              _context(context),
+              _minSigma(context.getMinSigma()),
+              _bkgd(bkgd),
+              _cond3Fac(context.getCond3Fac()),
+              _badMask(context.getBadMask()),
+              _interpBit(context.getInterpBit()) {}
 
-    int const xc = kernel->getCtrX();  // center of PSF
-    int const yc = kernel->getCtrY();
+    /*
+     * Search every row except the first and last, using up to nThreads threads; the candidates found
+     * in row y are returned as element y of the result
+     */
+    std::vector<RowCandidates> findAll(int const nThreads) const {
+        std::vector<RowCandidates> rows(std::max(_nrow, 0));
+        if (_nrow < 3 || _ncol < 3) {
+            return rows;
+        }
+        int const nStrips = std::max(1, std::min(nThreads, (_nrow - 2) / MIN_ROWS_PER_STRIP));
+        if (nStrips == 1) {
+            _searchRows(1, _nrow - 1, rows);
+            return rows;
+        }
 
-    double const I0 = psfImage(xc, yc);
-    double const thresH =
-            cond3Fac2 * (0.5 * (psfImage(xc - 1, yc) + psfImage(xc + 1, yc))) / I0;  // horizontal
-    double const thresV = cond3Fac2 * (0.5 * (psfImage(xc, yc - 1) + psfImage(xc, yc + 1))) / I0;  // vertical
-    double const thresD = cond3Fac2 *
-                          (0.25 * (psfImage(xc - 1, yc - 1) + psfImage(xc + 1, yc + 1) +
-                                   psfImage(xc - 1, yc + 1) + psfImage(xc + 1, yc - 1))) /
-                          I0;                                                  // diag
-                                                                               /*
-                                                                                * Setup desired mask planes
-                                                                                */
-    MaskPixel const badBit = mimage.getMask()->getPlaneBitMask("BAD");         // Generic bad pixels
-    MaskPixel const crBit = mimage.getMask()->getPlaneBitMask("CR");           // CR-contaminated pixels
-    MaskPixel const interpBit = mimage.getMask()->getPlaneBitMask("INTRP");    // Interpolated pixels
-    MaskPixel const saturBit = mimage.getMask()->getPlaneBitMask("SAT");       // Saturated pixels
-    MaskPixel const nodataBit = mimage.getMask()->getPlaneBitMask("NO_DATA");  // Non data pixels
-
-    MaskPixel const badMask = (badBit | interpBit | saturBit | nodataBit);  // naughty pixels
-                                                                            /*
-                                                                             * Go through the frame looking at each pixel (except the edge ones which we ignore)
-                                                                             */
-    int const ncol = mimage.getWidth();
-    int const nrow = mimage.getHeight();
+        std::vector<int> starts(nStrips + 1);  // first row of each strip
+        for (int k = 0; k <= nStrips; ++k) {
+            starts[k] = 1 + static_cast<int>(static_cast<long>(_nrow - 2) * k / nStrips);
+        }
+        std::vector<std::exception_ptr> errors(nStrips);
+        auto work = [&](int k) {
+            try {
+                _searchRows(starts[k], starts[k + 1], rows);
+            } catch (...) {
+                errors[k] = std::current_exception();
+            }
+        };
+        std::vector<std::thread> workers;
+        workers.reserve(nStrips - 1);
+        for (int k = 1; k < nStrips; ++k) {
+            workers.emplace_back(work, k);
+        }
+        work(0);  // the calling thread searches the first strip
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        for (auto const &error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
 
-    std::vector<CRPixel<ImagePixel>> crpixels;  // storage for detected CR-contaminated pixels
-    typedef typename std::vector<CRPixel<ImagePixel>>::iterator crpixel_iter;
-    typedef typename std::vector<CRPixel<ImagePixel>>::reverse_iterator crpixel_riter;
+        for (int k = 1; k < nStrips; ++k) {
+            _propagate(starts[k], rows);
+        }
+        return rows;
+    }
 
-    for (int j = 1; j < nrow - 1; ++j) {
-        typename MaskedImageT::xy_locator loc = mimage.xy_at(1, j);  // locator for data
+private:
+    typedef CrRowLocator<ImagePixel, VariancePixel, MaskPixel> Locator;
+
+    // Minimum height of a strip; shorter strips aren't worth a thread
+    static int const MIN_ROWS_PER_STRIP = 64;
 
-        for (int i = 1; i < ncol - 1; ++i, ++loc.x()) {
+    /*
+     * Evaluate the cheap start of is_cr_pixel (the sign of the pixel and condition #2) for every pixel in
+     * row y, using the same arithmetic but no branches so that the loop can be vectorised.  Pixels that
+     * fail can only pass is_cr_pixel if their left-hand neighbour is corrected (the rows above and below
+     * are the ones is_cr_pixel sees), so the exact test is needed for very few pixels.
+     */
+    void _prefilter(int const y, ImagePixel const *above, unsigned char *passes) const {
+        ImagePixel const *row = _image[y].getData();
+        ImagePixel const *below = _image[y + 1].getData();
+        VariancePixel const *variance = _variance[y].getData();
+
+        if (_minSigma < 0) { /* |thres_sky_sigma| is threshold */
+            for (int x = 1; x < _ncol - 1; ++x) {
+                ImagePixel const v_00 = row[x];
+                passes[x] = !(v_00 < 0) & !(v_00 < -_minSigma);
+            }
+            return;
+        }
+        for (int x = 1; x < _ncol - 1; ++x) {
+            ImagePixel const v_00 = row[x];
+            ImagePixel const mean_we = (row[x - 1] + row[x + 1]) / 2;
+            ImagePixel const mean_ns = (below[x] + above[x]) / 2;
+            ImagePixel const mean_swne = (above[x - 1] + below[x + 1]) / 2;
+            ImagePixel const mean_nwse = (below[x - 1] + above[x + 1]) / 2;
+            double const thres_sky_sigma = _minSigma * sqrt(variance[x]);
+
+            passes[x] = !(v_00 < 0) &
+                        !((v_00 < mean_ns + thres_sky_sigma) & (v_00 < mean_we + thres_sky_sigma) &
+                          (v_00 < mean_swne + thres_sky_sigma) & (v_00 < mean_nwse + thres_sky_sigma));
+        }
+    }
+
+    /*
+     * Search row y given the corrected values of row y - 1; on return current holds the corrected values
+     * of row y and found its candidates.  passes is scratch space for _prefilter
+     */
+    void _searchRow(int const y, ImagePixel const *above, std::vector<ImagePixel> &current,
+                    std::vector<unsigned char> &passes, RowCandidates &found) const {
+        ImagePixel const *imageRow = _image[y].getData();
+        current.assign(imageRow, imageRow + _ncol);
+        found.clear();
+
+        passes.resize(_ncol);
+        _prefilter(y, above, passes.data());
+
+        ImagePixel const *const image[3] = {above, current.data(), _image[y + 1].getData()};
+        VariancePixel const *const variance[3] = {_variance[y - 1].getData(), _variance[y].getData(),
+                                                  _variance[y + 1].getData()};
+        MaskPixel const *const mask[3] = {_mask[y - 1].getData(), _mask[y].getData(),
+                                          _mask[y + 1].getData()};
+        Locator loc(image, variance, mask, 1);
+
+        int lastCorrected = -1;  // column of the last corrected pixel
+        for (int x = 1; x < _ncol - 1; ++x, ++loc.x()) {
+            if (!passes[x] && lastCorrected != x - 1) {
+                continue;
+            }
             ImagePixel corr = 0;
-            if (!is_cr_pixel<MaskedImageT>(&corr, loc, minSigma, thresH, thresV, thresD, bkgd, cond3Fac)) {
+            CrDetectionContext::Thresholds const thres = _context.getThresholds(x + _x0, y + _y0);
+            if (!is_cr_pixel(&corr, loc, _minSigma, thres.horizontal, thres.vertical, thres.diagonal, _bkgd,
+                             _cond3Fac)) {
                 continue;
             }
             /*
              * condition #4
              */
-            if (loc.mask() & badMask) {
+            if (loc.mask() & _badMask) {
                 continue;
             }
             if ((loc.mask(-1, 1) | loc.mask(0, 1) | loc.mask(1, 1) | loc.mask(-1, 0) | loc.mask(1, 0) |
                  loc.mask(-1, -1) | loc.mask(0, -1) | loc.mask(1, -1)) &
-                interpBit) {
+                _interpBit) {
                 continue;
             }
             /*
              * OK, it's a CR
-             *
-             * replace CR-contaminated pixels with reasonable values as we go through
-             * image, which increases the detection rate
              */
-            crpixels.push_back(CRPixel<ImagePixel>(i + mimage.getX0(), j + mimage.getY0(), loc.image()));
-            loc.image() = corr; /* just a preliminary estimate */
-
-            if (static_cast<int>(crpixels.size()) > nCrPixelMax) {
-                reinstateCrPixels(mimage.getImage().get(), crpixels);
+            found.push_back(CrCandidate<ImagePixel>{x, current[x], corr});
+            current[x] = corr; /* just a preliminary estimate */
+            lastCorrected = x;
+        }
+    }
 
-                throw LSST_EXCEPT(pex::exceptions::LengthError,
-                                  (boost::format("Too many CR pixels (max %d)") % nCrPixelMax).str());
-            }
+    /*
+     * Search rows [y0, y1), starting from the original values of row y0 - 1
+     */
+    void _searchRows(int const y0, int const y1, std::vector<RowCandidates> &rows) const {
+        ImagePixel const *aboveRow = _image[y0 - 1].getData();
+        std::vector<ImagePixel> above(aboveRow, aboveRow + _ncol);
+        std::vector<ImagePixel> current;
+        std::vector<unsigned char> passes;
+        for (int y = y0; y < y1; ++y) {
+            _searchRow(y, above.data(), current, passes, rows[y]);
+            above.swap(current);
         }
     }
+
     /*
-     * We've found them on a pixel-by-pixel basis, now merge those pixels
-     * into cosmic rays
+     * Search again from row y0 down now that the candidates in rows < y0 are final, until a row's
+     * candidates don't change
      */
-    std::vector<int> aliases;                  // aliases for initially disjoint parts of CRs
-    aliases.reserve(1 + crpixels.size() / 2);  // initial size of aliases
+    void _propagate(int const y0, std::vector<RowCandidates> &rows) const {
+        ImagePixel const *aboveRow = _image[y0 - 1].getData();
+        std::vector<ImagePixel> above(aboveRow, aboveRow + _ncol);
+        for (auto const &candidate : rows[y0 - 1]) {
+            above[candidate.x] = candidate.corr;
+        }
+        std::vector<ImagePixel> current;
+        std::vector<unsigned char> passes;
+        RowCandidates found;
+        for (int y = y0; y < _nrow - 1; ++y) {
+            _searchRow(y, above.data(), current, passes, found);
+            if (found == rows[y]) {
+                break;
+            }
+            rows[y].swap(found);
+            above.swap(current);
+        }
+    }
 
-    std::vector<afw::detection::IdSpan::Ptr> spans;  // y:x0,x1 for objects
-    spans.reserve(aliases.capacity());               // initial size of spans
+    ndarray::Array<ImagePixel const, 2, 1> _image;
+    ndarray::Array<VariancePixel const, 2, 1> _variance;
+    ndarray::Array<MaskPixel const, 2, 1> _mask;
+    int const _ncol;
+    int const _nrow;
+    int const _x0, _y0;  // origin of the image in its parent
+    CrDetectionContext const &_context;
+    double const _minSigma;
+    double const _bkgd;
+    double const _cond3Fac;
+    MaskPixel const _badMask;
+    MaskPixel const _interpBit;
+};
 
-    aliases.push_back(0);  // 0 --> 0
+/************************************************************************************************************/
+/*
+ * Find the sum of the pixels in a Footprint
+ */
+template <typename ImageT>
+class CountsInCR {
+public:
+    CountsInCR(double const bkgd) : _bkgd(bkgd), _sum(0.0) {}
 
-    /**
-     In this loop, we look for strings of CRpixels on the same row and adjoining columns;
-     each of these becomes a Span with a unique ID.
-     */
+    void operator()(geom::Point2I const &point, ImageT const &val) { _sum += val - _bkgd; }
 
-    int ncr = 0;  // number of detected cosmic rays
-    if (!crpixels.empty()) {
-        int id;                        // id number for a CR
-        int x0 = -1, x1 = -1, y = -1;  // the beginning and end column, and row of this span in a CR
-
-        // I am dummy
-        CRPixel<ImagePixel> dummy(0, -1, 0, -1);
-        crpixels.push_back(dummy);
-        // printf("Created dummy CR: i %i, id %i, col %i, row %i, val %g\n", dummy.get_i(), dummy.id,
-        // dummy.col, dummy.row, (double)dummy.val);
-        for (crpixel_iter crp = crpixels.begin(); crp < crpixels.end() - 1; ++crp) {
-            // printf("Looking at CR: i %i, id %i, col %i, row %i, val %g\n", crp->get_i(), crp->id, crp->col,
-            // crp->row, (double)crp->val);
-
-            if (crp->id < 0) {    // not already assigned
-                crp->id = ++ncr;  // a new CR
-                aliases.push_back(crp->id);
-                y = crp->row;
-                x0 = x1 = crp->col;
-                // printf("  Assigned ID %i; looking at row %i, start col %i\n", crp->id, crp->row, crp->col);
-            }
-            id = crp->id;
-            // printf("  Next CRpix has i=%i, id=%i, row %i, col %i\n", crp[1].get_i(), crp[1].id, crp[1].row,
-            // crp[1].col);
-
-            if (crp[1].row == crp[0].row && crp[1].col == crp[0].col + 1) {
-                // printf("  Adjoining!  Set next CRpix id = %i; x1=%i\n", crp[1].id, x1);
-                crp[1].id = id;
-                ++x1;
-            } else {
-                assert(y >= 0 && x0 >= 0 && x1 >= 0);
-                spans.push_back(afw::detection::IdSpan::Ptr(new afw::detection::IdSpan(id, y, x0, x1)));
-                // printf("  Not adjoining; adding span id=%i, y=%i, x = [%i, %i]\n", id, y, x0, x1);
-            }
-        }
+    virtual void reset(afw::detection::Footprint const &) {}
+    virtual void reset() { _sum = 0.0; }
+
+    double getCounts() const { return _sum; }
+
+private:
+    double const _bkgd;  // the Image's background level
+    ImageT _sum;         // the sum of all DN in the Footprint, corrected for bkgd
+};
+}  // namespace
+
+namespace {
+/*
+ * Compute the thresholds for condition #3 from a realisation of the PSF
+ */
+CrDetectionContext::Thresholds computeThresholds(std::shared_ptr<afw::math::Kernel const> kernel,
+                                                 double const cond3Fac2) {
+    if (!kernel) {
+        throw LSST_EXCEPT(pex::exceptions::NotFoundError, "Psf is unable to return a kernel");
     }
+    afw::detection::Psf::Image psfImage =
+            afw::detection::Psf::Image(geom::ExtentI(kernel->getWidth(), kernel->getHeight()));
+    kernel->computeImage(psfImage, true);
+
+    int const xc = kernel->getCtrX();  // center of PSF
+    int const yc = kernel->getCtrY();
 
-    // At the end of this loop, all crpixel entries have been assigned an ID,
-    // except for the "dummy" entry at the end of the array.
-    if (crpixels.size() > 0) {
-        for (crpixel_iter cp = crpixels.begin(); cp != crpixels.end() - 1; cp++) {
-            assert(cp->id >= 0);
-            assert(cp->col >= 0);
-            assert(cp->row >= 0);
+    double const I0 = psfImage(xc, yc);
+    CrDetectionContext::Thresholds thresholds;
+    thresholds.horizontal = cond3Fac2 * (0.5 * (psfImage(xc - 1, yc) + psfImage(xc + 1, yc))) / I0;
+    thresholds.vertical = cond3Fac2 * (0.5 * (psfImage(xc, yc - 1) + psfImage(xc, yc + 1))) / I0;
+    thresholds.diagonal = cond3Fac2 *
+                          (0.25 * (psfImage(xc - 1, yc - 1) + psfImage(xc + 1, yc + 1) +
+                                   psfImage(xc - 1, yc + 1) + psfImage(xc + 1, yc - 1))) /
+                          I0;
+    return thresholds;
+}
+}  // namespace
+
+CrDetectionContext::CrDetectionContext(afw::detection::Psf const &psf,
+                                       afw::image::Mask<MaskPixel> const &mask,
+                                       daf::base::PropertySet const &ps, geom::Box2I const &bbox, int nx,
+                                       int ny)
+        : _minSigma(ps.getAsDouble("minSigma")),
+          _minDn(ps.getAsDouble("min_DN")),
+          _cond3Fac(ps.getAsDouble("cond3_fac")),
+          _cond3Fac2(ps.getAsDouble("cond3_fac2")),
+          _niteration(ps.getAsInt("niteration")),
+          _nCrPixelMax(ps.getAsInt("nCrPixelMax")),
+          _nThreads(ps.exists("nThreads") ? ps.getAsInt("nThreads") : 1),
+          _badBit(mask.getPlaneBitMask("BAD")),
+          _crBit(mask.getPlaneBitMask("CR")),
+          _interpBit(mask.getPlaneBitMask("INTRP")),
+          _saturBit(mask.getPlaneBitMask("SAT")),
+          _nodataBit(mask.getPlaneBitMask("NO_DATA")),
+          _bbox(bbox),
+          _nx(nx),
+          _ny(ny) {
+    if (nx < 1 || ny < 1) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Threshold grid must have at least one cell; got %dx%d") % nx % ny)
+                                  .str());
+    }
+    PsfEvaluationLock lock(psf);  // we may be called without the GIL on several threads
+    if (nx == 1 && ny == 1) {
+        // Realise PSF at its average position
+        _thresholds.push_back(computeThresholds(psf.getLocalKernel(), _cond3Fac2));
+        return;
+    }
+    if (bbox.isEmpty()) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "Threshold grid needs a non-empty bbox");
+    }
+    _thresholds.reserve(nx * ny);
+    double const cellWidth = static_cast<double>(bbox.getWidth()) / nx;
+    double const cellHeight = static_cast<double>(bbox.getHeight()) / ny;
+    for (int iy = 0; iy < ny; ++iy) {
+        for (int ix = 0; ix < nx; ++ix) {
+            geom::Point2D const center(bbox.getMinX() - 0.5 + (ix + 0.5) * cellWidth,
+                                       bbox.getMinY() - 0.5 + (iy + 0.5) * cellHeight);
+            _thresholds.push_back(computeThresholds(psf.getLocalKernel(center), _cond3Fac2));
         }
-        // dummy:
-        assert(crpixels[crpixels.size() - 1].id == -1);
-        assert(crpixels[crpixels.size() - 1].col == 0);
-        assert(crpixels[crpixels.size() - 1].row == -1);
     }
+}
 
-    for (std::vector<afw::detection::IdSpan::Ptr>::iterator sp = spans.begin(), end = spans.end(); sp != end;
-         sp++) {
-        assert((*sp)->id >= 0);
-        assert((*sp)->y >= 0);
-        assert((*sp)->x0 >= 0);
-        assert((*sp)->x1 >= (*sp)->x0);
-        for (std::vector<afw::detection::IdSpan::Ptr>::iterator sp2 = sp + 1; sp2 != end; sp2++) {
-            assert((*sp2)->y >= (*sp)->y);
-            if ((*sp2)->y == (*sp)->y) {
-                assert((*sp2)->x0 > (*sp)->x1);
-            }
-        }
+CrDetectionContext::Thresholds CrDetectionContext::getThresholds(double x, double y) const {
+    if (_thresholds.size() == 1) {
+        return _thresholds.front();
     }
+    // Position in units of cells relative to the centre of cell (0, 0), clamped to the grid
+    double const fx = std::min(std::max((x - _bbox.getMinX() + 0.5) * _nx / _bbox.getWidth() - 0.5, 0.0),
+                               _nx - 1.0);
+    double const fy = std::min(std::max((y - _bbox.getMinY() + 0.5) * _ny / _bbox.getHeight() - 0.5, 0.0),
+                               _ny - 1.0);
+    int const ix0 = static_cast<int>(fx);
+    int const iy0 = static_cast<int>(fy);
+    int const ix1 = std::min(ix0 + 1, _nx - 1);
+    int const iy1 = std::min(iy0 + 1, _ny - 1);
+    double const wx = fx - ix0;
+    double const wy = fy - iy0;
+
+    Thresholds const &t00 = _thresholds[iy0 * _nx + ix0];
+    Thresholds const &t10 = _thresholds[iy0 * _nx + ix1];
+    Thresholds const &t01 = _thresholds[iy1 * _nx + ix0];
+    Thresholds const &t11 = _thresholds[iy1 * _nx + ix1];
+    // Written so that equal values are reproduced exactly
+    auto interpolate = [wx, wy](double v00, double v10, double v01, double v11) {
+        double const v0 = v00 + wx * (v10 - v00);
+        double const v1 = v01 + wx * (v11 - v01);
+        return v0 + wy * (v1 - v0);
+    };
+    Thresholds result;
+    result.horizontal = interpolate(t00.horizontal, t10.horizontal, t01.horizontal, t11.horizontal);
+    result.vertical = interpolate(t00.vertical, t10.vertical, t01.vertical, t11.vertical);
+    result.diagonal = interpolate(t00.diagonal, t10.diagonal, t01.diagonal, t11.diagonal);
+    return result;
+}
+
+/*!
+ * @brief Find cosmic rays in an Image, and mask and remove them
+ *
+ * @return vector of CR's Footprints
+ */
+template <typename MaskedImageT>
+std::vector<std::shared_ptr<afw::detection::Footprint>> findCosmicRays(
+        MaskedImageT &mimage,               ///< Image to search
+        afw::detection::Psf const &psf,     ///< the Image's PSF
+        double const bkgd,                  ///< unsubtracted background of frame, DN
+        daf::base::PropertySet const &ps,   ///< PropertySet directing the behavior
+        bool const keep                     ///< if true, don't remove the CRs
+) {
+    return findCosmicRays(mimage, CrDetectionContext(psf, *mimage.getMask(), ps), bkgd, keep);
+}
 
+/*!
+ * @brief Find cosmic rays in an Image, and mask and remove them
+ *
+ * @return vector of CR's Footprints
+ */
+template <typename MaskedImageT>
+std::vector<std::shared_ptr<afw::detection::Footprint>> findCosmicRays(
+        MaskedImageT &mimage,                 ///< Image to search
+        CrDetectionContext const &context,    ///< thresholds, mask bits and parameters for the search
+        double const bkgd,                    ///< unsubtracted background of frame, DN
+        bool const keep,                      ///< if true, don't remove the CRs
+        daf::base::PropertySet *metadata      ///< if not null, per-phase timings are written here
+) {
+    typedef typename MaskedImageT::Image ImageT;
+    typedef typename ImageT::Pixel ImagePixel;
+    typedef typename MaskedImageT::Mask::Pixel MaskPixel;
+    LSST_MEAS_ALGORITHMS_TIME("findCosmicRays");
+
+    double const minSigma = context.getMinSigma();  // min sigma over sky in pixel for CR candidate
+    double const minDn = context.getMinDn();        // min number of DN in an CRs
+    int const niteration = context.getNIteration();  // Number of times to look for contaminated
+                                                     // pixels near CRs
+    int const nCrPixelMax = context.getNCrPixelMax();  // maximum number of contaminated pixels
+
+    MaskPixel const crBit = context.getCrBit();          // CR-contaminated pixels
+    MaskPixel const interpBit = context.getInterpBit();  // Interpolated pixels
+    MaskPixel const saturBit = context.getSaturBit();    // Saturated pixels
+    MaskPixel const badMask = context.getBadMask();      // naughty pixels
     /*
-     * See if spans touch each other
+     * Go through the frame looking at each pixel (except the edge ones which we ignore)
      */
-    for (std::vector<afw::detection::IdSpan::Ptr>::iterator sp = spans.begin(), end = spans.end(); sp != end;
-         ++sp) {
-        int const y = (*sp)->y;
-        int const x0 = (*sp)->x0;
-        int const x1 = (*sp)->x1;
-
-        // this loop will probably run for only a few steps
-        for (std::vector<afw::detection::IdSpan::Ptr>::iterator sp2 = sp + 1; sp2 != end; ++sp2) {
-            if ((*sp2)->y == y) {
-                // on this row (but not adjoining columns, since it would have been merged into this span);
-                // keep looking.
-                continue;
-            } else if ((*sp2)->y != (y + 1)) {
-                // sp2 is more than one row below; can't be connected.
-                break;
-            } else if ((*sp2)->x0 > (x1 + 1)) {
-                // sp2 is more than one column away to the right; can't be connected
-                break;
-            } else if ((*sp2)->x1 >= (x0 - 1)) {
-                // touches
-                int r1 = afw::detection::resolve_alias(aliases, (*sp)->id);
-                int r2 = afw::detection::resolve_alias(aliases, (*sp2)->id);
-                aliases[r1] = r2;
-            }
-        }
-    }
-
+    int const ncol = mimage.getWidth();
+    int const nrow = mimage.getHeight();
     /*
-     * Resolve aliases; first alias chains, then the IDs in the spans
+     * Wall-clock time spent in each phase (s); reported in metadata, if provided
      */
-    for (unsigned int i = 0; i != spans.size(); ++i) {
-        spans[i]->id = afw::detection::resolve_alias(aliases, spans[i]->id);
-    }
+    double findTime = 0, mergeTime = 0, filterTime = 0, removeTime = 0, growTime = 0, finishTime = 0;
+    auto phaseStart = std::chrono::steady_clock::now();
+    auto endPhase = [&phaseStart]() {
+        auto const now = std::chrono::steady_clock::now();
+        double const elapsed = std::chrono::duration<double>(now - phaseStart).count();
+        phaseStart = now;
+        return elapsed;
+    };
+    auto recordTimings = [&](int nPixel, int nCr) {
+        LOGL_DEBUG("TRACE1.algorithms.CR",
+                   "Phase timings (s): find %g, merge %g, filter %g, remove %g, grow %g, finish %g", findTime,
+                   mergeTime, filterTime, removeTime, growTime, finishTime);
+        LSST_MEAS_ALGORITHMS_COUNT("findCosmicRays.candidatePixels", nPixel);
+        LSST_MEAS_ALGORITHMS_COUNT("findCosmicRays.cosmicRays", nCr);
+        if (!metadata) {
+            return;
+        }
+        metadata->set("crFindTime", findTime);
+        metadata->set("crMergeTime", mergeTime);
+        metadata->set("crFilterTime", filterTime);
+        metadata->set("crRemoveTime", removeTime);
+        metadata->set("crGrowTime", growTime);
+        metadata->set("crFinishTime", finishTime);
+        metadata->set("crPixelCount", nPixel);
+        metadata->set("crCount", nCr);
+    };
+
+    CrCallState<ImagePixel> state;                              // everything belonging to this call
+    std::vector<CRPixel<ImagePixel>> &crpixels = state.pixels;  // detected CR-contaminated pixels
+    typedef typename std::vector<CRPixel<ImagePixel>>::iterator crpixel_iter;
+    typedef typename std::vector<CRPixel<ImagePixel>>::reverse_iterator crpixel_riter;
 
     /*
-     * Sort spans by ID, so we can sweep through them once
+     * The preliminary corrections made while searching are kept out of the image, so nothing needs
+     * to be reinstated once the pixels have been merged into CRs
      */
-    if (spans.size() > 0) {
-        std::sort(spans.begin(), spans.end(), afw::detection::IdSpanCompar());
+    {
+        CrCandidateFinder<MaskedImageT> const finder(mimage, context, bkgd);
+        std::vector<typename CrCandidateFinder<MaskedImageT>::RowCandidates> const candidates =
+                finder.findAll(context.getNThreads());
+        for (int j = 1; j < nrow - 1; ++j) {
+            for (auto const &candidate : candidates[j]) {
+                state.addPixel(candidate.x + mimage.getX0(), j + mimage.getY0(), candidate.val);
+            }
+        }
     }
-
+    if (static_cast<int>(crpixels.size()) > nCrPixelMax) {
+        findTime = endPhase();
+        recordTimings(static_cast<int>(crpixels.size()), 0);
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Too many CR pixels (max %d)") % nCrPixelMax).str());
+    }
+    findTime = endPhase();
     /*
-     * Build Footprints from spans
+     * We've found them on a pixel-by-pixel basis, now merge those pixels into cosmic rays: strings of
+     * CR pixels on the same row and adjoining columns become Spans, which are grouped into connected
+     * components
      */
     std::vector<std::shared_ptr<afw::detection::Footprint>> CRs;  // our cosmic rays
-
-    if (spans.size() > 0) {
-        int id = spans[0]->id;
-        unsigned int i0 = 0;                                 // initial value of i
-        for (unsigned int i = i0; i <= spans.size(); ++i) {  // <= size to catch the last object
-            if (i == spans.size() || spans[i]->id != id) {
-                std::shared_ptr<afw::detection::Footprint> cr(new afw::detection::Footprint());
-
-                std::vector<afw::geom::Span> spanList;
-                spanList.reserve(i - i0);
-                for (; i0 < i; ++i0) {
-                    spanList.push_back(afw::geom::Span(spans[i0]->y, spans[i0]->x0, spans[i0]->x1));
-                }
-                cr->setSpans(std::make_shared<afw::geom::SpanSet>(std::move(spanList)));
-                CRs.push_back(cr);
+    {
+        std::vector<afw::geom::Span> spanList;  // crpixels are in row-major order
+        for (crpixel_iter crp = crpixels.begin(), end = crpixels.end(); crp != end;) {
+            crpixel_iter last = crp;  // last pixel in this span
+            while (last + 1 != end && last[1].row == crp->row && last[1].col == last->col + 1) {
+                ++last;
             }
-
-            if (i < spans.size()) {
-                id = spans[i]->id;
+            spanList.push_back(afw::geom::Span(crp->row, crp->col, last->col));
+            crp = last + 1;
+        }
+        SpanComponents const components(std::move(spanList));
+        /*
+         * CRs are listed in the order of their last span, as they always have been; the order matters,
+         * as removing and growing a CR changes the pixels seen by the CRs that follow it
+         */
+        std::vector<int> const &labels = components.getLabels();
+        std::vector<std::size_t> const lastSpans = components.getLastSpans();
+        std::vector<std::vector<afw::geom::Span>> componentSpans = components.getComponentSpans();
+        CRs.reserve(componentSpans.size());
+        for (std::size_t i = 0; i != labels.size(); ++i) {
+            if (lastSpans[labels[i]] == i) {
+                auto cr = std::make_shared<afw::detection::Footprint>();
+                cr->setSpans(std::make_shared<afw::geom::SpanSet>(std::move(componentSpans[labels[i]])));
+                CRs.push_back(cr);
             }
         }
     }
+    int ncr = CRs.size();  // number of detected cosmic rays
+    mergeTime = endPhase();
 
-    reinstateCrPixels(mimage.getImage().get(), crpixels);
     /*
      * apply condition #1
      */
@@ -586,13 +795,15 @@ std::vector<std::shared_ptr<afw::detection::Footprint>> findCosmicRays(
         CountDN.reset();
     }
     ncr = CRs.size(); /* some may have been too faint */
-                      /*
-                       * We've found them all, time to kill them all
-                       */
+    filterTime = endPhase();
+    /*
+     * We've found them all, time to kill them all
+     */
     bool const debias_values = true;
     bool grow = false;
     LOGL_DEBUG("TRACE2.algorithms.CR", "Removing initial list of CRs");
-    removeCR(mimage, CRs, bkgd, crBit, saturBit, badMask, debias_values, grow);
+    removeCR(mimage, CRs, bkgd, crBit, saturBit, badMask, debias_values, grow, state.resetRandom());
+    removeTime = endPhase();
 #if 0  // Useful to see phase 2 in display; debugging only
     (void)setMaskFromFootprintList(mimage.getMask().get(), CRs,
                                    mimage.getMask()->getPlaneBitMask("DETECTED"));
@@ -629,7 +840,8 @@ std::vector<std::shared_ptr<afw::detection::Footprint>> findCosmicRays(
             /*
              * No; some of the suspect pixels aren't interpolated
              */
-            afw::detection::Footprint extra;  // extra pixels added to cr
+            std::vector<afw::geom::Span> &extraSpans = state.extraSpans;  // extra pixels added to cr
+            extraSpans.clear();
             for (auto siter = cr->getSpans()->begin(); siter != cr->getSpans()->end(); siter++) {
                 auto const span = siter;
 
@@ -648,24 +860,26 @@ std::vector<std::shared_ptr<afw::detection::Footprint>> findCosmicRays(
                 x0 = (x0 < 2) ? 2 : (x0 > ncol - 3) ? ncol - 3 : x0;
                 x1 = (x1 < 2) ? 2 : (x1 > ncol - 3) ? ncol - 3 : x1;
 
-                checkSpanForCRs(&extra, crpixels, y - 1, x0, x1, mimage, minSigma / 2, thresH, thresV, thresD,
-                                bkgd, 0, keep);
-                checkSpanForCRs(&extra, crpixels, y, x0, x1, mimage, minSigma / 2, thresH, thresV, thresD,
-                                bkgd, 0, keep);
-                checkSpanForCRs(&extra, crpixels, y + 1, x0, x1, mimage, minSigma / 2, thresH, thresV, thresD,
-                                bkgd, 0, keep);
+                checkSpanForCRs(extraSpans, state, y - 1, x0, x1, mimage, minSigma / 2, context, bkgd, 0,
+                                keep);
+                checkSpanForCRs(extraSpans, state, y, x0, x1, mimage, minSigma / 2, context, bkgd, 0,
+                                keep);
+                checkSpanForCRs(extraSpans, state, y + 1, x0, x1, mimage, minSigma / 2, context, bkgd, 0,
+                                keep);
             }
 
-            if (extra.getSpans()->size() > 0) {  // we added some pixels
+            if (!extraSpans.empty()) {  // we added some pixels
                 if (nextra + static_cast<int>(crpixels.size()) > nCrPixelMax) {
                     too_many_crs = true;
                     break;
                 }
 
+                afw::geom::SpanSet const extra(
+                        std::vector<afw::geom::Span>(extraSpans.begin(), extraSpans.end()));
                 nextra += extra.getArea();
 
                 std::vector<afw::geom::Span> tmpSpanList(cr->getSpans()->begin(), cr->getSpans()->end());
-                for (auto const &spn : (*extra.getSpans())) {
+                for (auto const &spn : extra) {
                     tmpSpanList.push_back(spn);
                 }
                 cr->setSpans(std::make_shared<afw::geom::SpanSet>(std::move(tmpSpanList)));
@@ -676,6 +890,7 @@ std::vector<std::shared_ptr<afw::detection::Footprint>> findCosmicRays(
             break;
         }
     }
+    growTime = endPhase();
     /*
      * mark those pixels as CRs
      */
@@ -700,9 +915,6 @@ std::vector<std::shared_ptr<afw::detection::Footprint>> findCosmicRays(
 
             crpixel_riter rend = crpixels.rend();
             for (crpixel_riter crp = crpixels.rbegin(); crp != rend; ++crp) {
-                if (crp->row == -1)
-                    // dummy; skip it.
-                    continue;
                 mimage.at(crp->col - imageX0, crp->row - imageY0).image() = crp->val;
             }
         }
@@ -710,7 +922,7 @@ std::vector<std::shared_ptr<afw::detection::Footprint>> findCosmicRays(
         if (true || nextra > 0) {
             grow = true;
             LOGL_DEBUG("TRACE2.algorithms.CR", "Removing final list of CRs, grow = %d", grow);
-            removeCR(mimage, CRs, bkgd, crBit, saturBit, badMask, debias_values, grow);
+            removeCR(mimage, CRs, bkgd, crBit, saturBit, badMask, debias_values, grow, state.resetRandom());
         }
         /*
          * we interpolated over all CR pixels, so set the interp bits too
@@ -720,6 +932,9 @@ std::vector<std::shared_ptr<afw::detection::Footprint>> findCosmicRays(
         }
     }
 
+    finishTime = endPhase();
+    recordTimings(static_cast<int>(crpixels.size()), ncr);
+
     if (too_many_crs) {  // we've cleaned up, so we can throw the exception
         throw LSST_EXCEPT(pex::exceptions::LengthError,
                           (boost::format("Too many CR pixels (max %d)") % nCrPixelMax).str());
@@ -951,9 +1166,9 @@ void removeCR(afw::image::MaskedImage<ImageT, MaskT> &mi,                    //
               MaskT const saturBit,  // Bit value used to label saturated pixels
               MaskT const badMask,   // Bit mask for bad pixels
               bool const debias,     // statistically debias values?
-              bool const grow        // Grow CRs?
+              bool const grow,       // Grow CRs?
+              afw::math::Random &rand  // a random number generator
 ) {
-    afw::math::Random rand;  // a random number generator
     /*
      * replace the values of cosmic-ray contaminated pixels with 1-dim 2nd-order weighted means Cosmic-ray
      * contaminated pixels have already been given a mask value, crBit
@@ -1011,7 +1226,10 @@ void removeCR(afw::image::MaskedImage<ImageT, MaskT> &mi,                    //
 #define INSTANTIATE(TYPE)                                                                            \
     template std::vector<std::shared_ptr<afw::detection::Footprint>> findCosmicRays(                 \
             afw::image::MaskedImage<TYPE> &image, afw::detection::Psf const &psf, double const bkgd, \
-            daf::base::PropertySet const &ps, bool const keep)
+            daf::base::PropertySet const &ps, bool const keep);                                      \
+    template std::vector<std::shared_ptr<afw::detection::Footprint>> findCosmicRays(                 \
+            afw::image::MaskedImage<TYPE> &image, CrDetectionContext const &context,                 \
+            double const bkgd, bool const keep, daf::base::PropertySet *metadata)
 
 INSTANTIATE(float);
 INSTANTIATE(double);  // Why do we need double images?
@@ -21,6 +21,9 @@
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include "lsst/pex/exceptions/Runtime.h"
 #include "lsst/geom/Box.h"
 #include "lsst/afw/table/io/CatalogVector.h"
@@ -45,6 +48,24 @@ namespace meas {
 namespace algorithms {
 namespace {
 
+// Target number of pixels evaluated together by fillImage and addToImage.
+std::size_t const PIXELS_PER_BATCH = 1 << 16;
+
+std::shared_ptr<CoaddInputIndex const> makeIndex(afw::geom::SkyWcs const& coaddWcs,
+                                                 CoaddBoundedField::ElementVector const& elements) {
+    std::vector<geom::Box2D> boxes;
+    boxes.reserve(elements.size());
+    for (auto const& element : elements) {
+        boxes.push_back(CoaddInputIndex::computeCoaddBBox(geom::Box2D(element.field->getBBox()),
+                                                          *element.wcs, coaddWcs));
+    }
+    return std::make_shared<CoaddInputIndex const>(boxes);
+}
+
+// Grid sizes (cells per axis) tried when approximating an element's pixel mapping.
+int const MIN_APPROXIMATION_CELLS = 4;
+int const MAX_APPROXIMATION_CELLS = 128;
+
 /*
  * Compare two pointers of the same type
  *
@@ -65,6 +86,98 @@ bool ptrEquals(T a, T b) {
 
 }  // namespace
 
+// A bilinear interpolation, on a regular grid over an element's coadd-frame footprint, of the mapping
+// from coadd pixels to element pixels.
+class CoaddBoundedField::ElementApproximation {
+public:
+    // Return nullptr if the mapping cannot be approximated to within maxError.
+    static std::shared_ptr<ElementApproximation const> make(geom::Box2D const& bbox,
+                                                            afw::geom::SkyWcs const& coaddWcs,
+                                                            afw::geom::SkyWcs const& elementWcs,
+                                                            double maxError) {
+        if (bbox.isEmpty()) {
+            return nullptr;
+        }
+        std::shared_ptr<afw::geom::TransformPoint2ToPoint2> coaddToElement;
+        try {
+            coaddToElement = afw::geom::makeWcsPairTransform(coaddWcs, elementWcs);
+        } catch (pex::exceptions::Exception&) {
+            return nullptr;
+        }
+        for (int n = MIN_APPROXIMATION_CELLS; n <= MAX_APPROXIMATION_CELLS; n *= 2) {
+            // Evaluate the exact mapping on a grid twice as fine as the candidate, so the points
+            // between candidate grid points can be used to measure the interpolation error.
+            int const nFine = 2 * n + 1;
+            std::vector<geom::Point2D> finePoints;
+            finePoints.reserve(nFine * nFine);
+            for (int j = 0; j < nFine; ++j) {
+                for (int i = 0; i < nFine; ++i) {
+                    finePoints.emplace_back(bbox.getMinX() + 0.5 * i * bbox.getWidth() / n,
+                                            bbox.getMinY() + 0.5 * j * bbox.getHeight() / n);
+                }
+            }
+            std::vector<geom::Point2D> fineValues;
+            try {
+                fineValues = coaddToElement->applyForward(finePoints);
+            } catch (pex::exceptions::Exception&) {
+                return nullptr;
+            }
+            std::vector<geom::Point2D> nodes;
+            nodes.reserve((n + 1) * (n + 1));
+            for (int j = 0; j < nFine; j += 2) {
+                for (int i = 0; i < nFine; i += 2) {
+                    nodes.push_back(fineValues[j * nFine + i]);
+                }
+            }
+            std::shared_ptr<ElementApproximation const> result(new ElementApproximation(bbox, n, nodes));
+            bool good = true;
+            for (std::size_t k = 0; k < finePoints.size() && good; ++k) {
+                geom::Extent2D const error = (*result)(finePoints[k]) - fineValues[k];
+                good = std::isfinite(error.computeNorm()) && error.computeNorm() <= maxError;
+            }
+            if (good) {
+                return result;
+            }
+        }
+        return nullptr;
+    }
+
+    geom::Box2D const& getBBox() const { return _bbox; }
+
+    // Return the approximate element pixel position of a coadd pixel position within getBBox().
+    geom::Point2D operator()(geom::Point2D const& position) const {
+        double const fx = (position.getX() - _bbox.getMinX()) / _cellWidth;
+        double const fy = (position.getY() - _bbox.getMinY()) / _cellHeight;
+        int const ix = std::max(0, std::min(_n - 1, static_cast<int>(std::floor(fx))));
+        int const iy = std::max(0, std::min(_n - 1, static_cast<int>(std::floor(fy))));
+        double const tx = fx - ix;
+        double const ty = fy - iy;
+        std::size_t const k = static_cast<std::size_t>(iy) * (_n + 1) + ix;
+        geom::Point2D const& p00 = _nodes[k];
+        geom::Point2D const& p10 = _nodes[k + 1];
+        geom::Point2D const& p01 = _nodes[k + _n + 1];
+        geom::Point2D const& p11 = _nodes[k + _n + 2];
+        return geom::Point2D((1.0 - ty) * ((1.0 - tx) * p00.getX() + tx * p10.getX()) +
+                                     ty * ((1.0 - tx) * p01.getX() + tx * p11.getX()),
+                             (1.0 - ty) * ((1.0 - tx) * p00.getY() + tx * p10.getY()) +
+                                     ty * ((1.0 - tx) * p01.getY() + tx * p11.getY()));
+    }
+
+private:
+    ElementApproximation(geom::Box2D const& bbox, int n, std::vector<geom::Point2D> nodes)
+            : _bbox(bbox),
+              _n(n),
+              _cellWidth(bbox.getWidth() / n),
+              _cellHeight(bbox.getHeight() / n),
+              _nodes(std::move(nodes)) {}
+
+    geom::Box2D _bbox;
+    int _n;  // number of cells along each axis
+    double _cellWidth;
+    double _cellHeight;
+    std::vector<geom::Point2D> _nodes;  // (n + 1) x (n + 1) element positions, row-major
+};
+
 bool CoaddBoundedFieldElement::operator==(CoaddBoundedFieldElement const& rhs) const {
     return ptrEquals(field, rhs.field) && ptrEquals(wcs, rhs.wcs) &&
            ptrEquals(validPolygon, rhs.validPolygon) && (weight == rhs.weight);
@@ -76,7 +189,9 @@ CoaddBoundedField::CoaddBoundedField(geom::Box2I const& bbox, PTR(afw::geom::Sky
           _throwOnMissing(true),
           _default(0.0),  // unused
           _coaddWcs(coaddWcs),
-          _elements(elements) {}
+          _elements(elements),
+          _index(makeIndex(*_coaddWcs, _elements)),
+          _approximationMaxError(0.0) {}
 
 CoaddBoundedField::CoaddBoundedField(geom::Box2I const& bbox, PTR(afw::geom::SkyWcs const) coaddWcs,
                                      ElementVector const& elements, double default_)
@@ -84,14 +199,29 @@ CoaddBoundedField::CoaddBoundedField(geom::Box2I const& bbox, PTR(afw::geom::Sky
           _throwOnMissing(false),
           _default(default_),
           _coaddWcs(coaddWcs),
-          _elements(elements) {}
+          _elements(elements),
+          _index(makeIndex(*_coaddWcs, _elements)),
+          _approximationMaxError(0.0) {}
 
 double CoaddBoundedField::evaluate(geom::Point2D const& position) const {
-    auto coord = _coaddWcs->pixelToSky(position);
+    std::unique_ptr<geom::SpherePoint> coord;  // only computed if some element needs it
     double sum = 0.0;
     double wSum = 0.0;
-    for (ElementVector::const_iterator i = _elements.begin(); i != _elements.end(); ++i) {
-        geom::Point2D transformedPosition = i->wcs->skyToPixel(coord);
+    // The index only prunes elements that cannot contain the point; the exact test is unchanged.
+    for (std::size_t index : _index->getCandidates(position)) {
+        ElementVector::const_iterator i = _elements.begin() + index;
+        geom::Point2D transformedPosition;
+        if (ElementApproximation const* approximation = _getApproximation(index)) {
+            if (!approximation->getBBox().contains(position)) {
+                continue;
+            }
+            transformedPosition = (*approximation)(position);
+        } else {
+            if (!coord) {
+                coord.reset(new geom::SpherePoint(_coaddWcs->pixelToSky(position)));
+            }
+            transformedPosition = i->wcs->skyToPixel(*coord);
+        }
         bool inValidArea = i->validPolygon ? i->validPolygon->contains(transformedPosition) : true;
         if (geom::Box2D(i->field->getBBox()).contains(transformedPosition) && inValidArea) {
             sum += i->weight * i->field->evaluate(transformedPosition);
@@ -111,6 +241,189 @@ double CoaddBoundedField::evaluate(geom::Point2D const& position) const {
     return sum / wSum;
 }
 
+ndarray::Array<double, 1, 1> CoaddBoundedField::evaluate(ndarray::Array<double const, 1> const& x,
+                                                         ndarray::Array<double const, 1> const& y) const {
+    if (x.getSize<0>() != y.getSize<0>()) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("x and y arrays have different sizes (%d vs. %d)") %
+                           x.getSize<0>() % y.getSize<0>())
+                                  .str());
+    }
+    std::vector<geom::Point2D> positions;
+    positions.reserve(x.getSize<0>());
+    for (int k = 0, n = x.getSize<0>(); k < n; ++k) {
+        positions.emplace_back(x[k], y[k]);
+    }
+    return _evaluate(positions);
+}
+
+ndarray::Array<double, 1, 1> CoaddBoundedField::_evaluate(std::vector<geom::Point2D> const& positions) const {
+    std::size_t const nPoints = positions.size();
+    ndarray::Array<double, 1, 1> result = ndarray::allocate(nPoints);
+    if (nPoints == 0) {
+        return result;
+    }
+    geom::Box2D region;
+    for (auto const& position : positions) {
+        region.include(position);
+    }
+    std::vector<geom::SpherePoint> coords;  // only computed if some element needs them
+
+    std::vector<double> sum(nPoints, 0.0);
+    std::vector<double> wSum(nPoints, 0.0);
+    std::vector<std::size_t> selected;
+    std::vector<geom::SpherePoint> selectedCoords;
+    std::vector<std::size_t> inside;
+    // Elements are visited in order, so each point accumulates its sums in the same order as evaluate.
+    for (std::size_t index : _index->getOverlapping(region)) {
+        Element const& element = _elements[index];
+        geom::Box2D const& coaddBBox = _index->getInputBBox(index);
+        selected.clear();
+        for (std::size_t k = 0; k < nPoints; ++k) {
+            if (coaddBBox.isEmpty() || coaddBBox.contains(positions[k])) {
+                selected.push_back(k);
+            }
+        }
+        if (selected.empty()) {
+            continue;
+        }
+        std::vector<geom::Point2D> transformed;
+        if (ElementApproximation const* approximation = _getApproximation(index)) {
+            transformed.reserve(selected.size());
+            for (std::size_t k : selected) {
+                transformed.push_back((*approximation)(positions[k]));
+            }
+        } else {
+            if (coords.empty()) {
+                coords = _coaddWcs->pixelToSky(positions);
+            }
+            selectedCoords.clear();
+            for (std::size_t k : selected) {
+                selectedCoords.push_back(coords[k]);
+            }
+            transformed = element.wcs->skyToPixel(selectedCoords);
+        }
+        geom::Box2D const fieldBBox(element.field->getBBox());
+        inside.clear();
+        for (std::size_t j = 0; j < selected.size(); ++j) {
+            bool inValidArea = element.validPolygon ? element.validPolygon->contains(transformed[j]) : true;
+            if (fieldBBox.contains(transformed[j]) && inValidArea) {
+                inside.push_back(j);
+            }
+        }
+        if (inside.empty()) {
+            continue;
+        }
+        ndarray::Array<double, 1, 1> xInside = ndarray::allocate(inside.size());
+        ndarray::Array<double, 1, 1> yInside = ndarray::allocate(inside.size());
+        for (std::size_t j = 0; j < inside.size(); ++j) {
+            xInside[j] = transformed[inside[j]].getX();
+            yInside[j] = transformed[inside[j]].getY();
+        }
+        ndarray::Array<double, 1, 1> const values = element.field->evaluate(xInside, yInside);
+        for (std::size_t j = 0; j < inside.size(); ++j) {
+            std::size_t const k = selected[inside[j]];
+            sum[k] += element.weight * values[j];
+            wSum[k] += element.weight;
+        }
+    }
+
+    for (std::size_t k = 0; k < nPoints; ++k) {
+        if (wSum[k] == 0.0) {
+            if (_throwOnMissing) {
+                throw LSST_EXCEPT(pex::exceptions::DomainError,
+                                  (boost::format("No constituent fields to evaluate at point %f, %f") %
+                                   positions[k].getX() % positions[k].getY())
+                                          .str());
+            }
+            result[k] = _default;
+        } else {
+            result[k] = sum[k] / wSum[k];
+        }
+    }
+    return result;
+}
+
+PTR(CoaddBoundedField) CoaddBoundedField::approximated(double maxError) const {
+    if (!(maxError > 0.0)) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("maxError must be positive; got %g") % maxError).str());
+    }
+    auto result = std::make_shared<CoaddBoundedField>(*this);
+    result->_approximationMaxError = maxError;
+    result->_approximations.clear();
+    result->_approximations.reserve(_elements.size());
+    for (std::size_t i = 0; i < _elements.size(); ++i) {
+        result->_approximations.push_back(ElementApproximation::make(_index->getInputBBox(i), *_coaddWcs,
+                                                                     *_elements[i].wcs, maxError));
+    }
+    return result;
+}
+
+std::size_t CoaddBoundedField::getApproximatedElementCount() const {
+    return std::count_if(_approximations.begin(), _approximations.end(),
+                         [](std::shared_ptr<ElementApproximation const> const& a) { return bool(a); });
+}
+
+template <typename T, typename F>
+void CoaddBoundedField::_applyToImage(afw::image::Image<T>& image, bool overlapOnly, F functor) const {
+    geom::Box2I region(image.getBBox());
+    if (overlapOnly) {
+        region.clip(getBBox());
+    }
+    if (region.isEmpty()) {
+        return;
+    }
+    int const width = region.getWidth();
+    int const rowsPerBatch = std::max(1, static_cast<int>(PIXELS_PER_BATCH / width));
+    std::vector<geom::Point2D> positions;
+    for (int y0 = region.getBeginY(); y0 < region.getEndY(); y0 += rowsPerBatch) {
+        int const y1 = std::min(y0 + rowsPerBatch, region.getEndY());
+        positions.clear();
+        for (int y = y0; y < y1; ++y) {
+            for (int x = region.getBeginX(); x < region.getEndX(); ++x) {
+                positions.emplace_back(x, y);
+            }
+        }
+        ndarray::Array<double, 1, 1> const values = _evaluate(positions);
+        std::size_t k = 0;
+        for (int y = y0; y < y1; ++y) {
+            typename afw::image::Image<T>::x_iterator pixel =
+                    image.x_at(region.getBeginX() - image.getX0(), y - image.getY0());
+            for (int x = 0; x < width; ++x, ++pixel, ++k) {
+                functor(*pixel, values[k]);
+            }
+        }
+    }
+}
+
+template <typename T>
+void CoaddBoundedField::fillImage(afw::image::Image<T>& image, bool overlapOnly, int xStep,
+                                  int yStep) const {
+    if (xStep != 1 || yStep != 1) {
+        afw::math::BoundedField::fillImage(image, overlapOnly, xStep, yStep);
+        return;
+    }
+    _applyToImage(image, overlapOnly, [](T& pixel, double value) { pixel = value; });
+}
+
+template <typename T>
+void CoaddBoundedField::addToImage(afw::image::Image<T>& image, double scaleBy, bool overlapOnly, int xStep,
+                                   int yStep) const {
+    if (xStep != 1 || yStep != 1) {
+        afw::math::BoundedField::addToImage(image, scaleBy, overlapOnly, xStep, yStep);
+        return;
+    }
+    _applyToImage(image, overlapOnly, [scaleBy](T& pixel, double value) { pixel += scaleBy * value; });
+}
+
+#define INSTANTIATE(T)                                                                          \
+    template void CoaddBoundedField::fillImage(afw::image::Image<T>&, bool, int, int) const; \
+    template void CoaddBoundedField::addToImage(afw::image::Image<T>&, double, bool, int, int) const
+
+INSTANTIATE(float);
+INSTANTIATE(double);
+
 // ---------- Persistence -----------------------------------------------------------------------------------
 
 // For persistence of CoaddBoundedField, we have two catalogs: the first has just one record, and contains
@@ -0,0 +1,602 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <algorithm>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/table/io/CatalogVector.h"
+#include "lsst/afw/table/io/OutputArchive.h"
+#include "lsst/afw/table/io/InputArchive.h"
+#include "lsst/afw/table/io/Persistable.cc"
+#include "lsst/afw/table/aggregates.h"
+#include "lsst/meas/algorithms/CoaddBoundedFieldSet.h"
+
+namespace lsst {
+namespace afw {
+namespace table {
+namespace io {
+
+template std::shared_ptr<meas::algorithms::CoaddBoundedFieldSet>
+PersistableFacade<meas::algorithms::CoaddBoundedFieldSet>::dynamicCast(std::shared_ptr<Persistable> const&);
+
+template std::shared_ptr<meas::algorithms::CoaddBoundedFieldSetMember>
+PersistableFacade<meas::algorithms::CoaddBoundedFieldSetMember>::dynamicCast(
+        std::shared_ptr<Persistable> const&);
+
+}  // namespace io
+}  // namespace table
+}  // namespace afw
+namespace meas {
+namespace algorithms {
+namespace {
+
+// Compare two pointers of the same type: if both are set return *a == *b, else return a == b.
+template <typename T>
+bool ptrEquals(T a, T b) {
+    if (a == b) {
+        return true;
+    } else if (a && b) {
+        return *a == *b;
+    }
+    return false;
+}
+
+void checkElements(std::vector<std::string> const& names,
+                   CoaddBoundedFieldSet::ElementVector const& elements) {
+    for (auto const& name : names) {
+        if (name.size() > CoaddBoundedFieldSet::MAX_NAME_LENGTH) {
+            throw LSST_EXCEPT(pex::exceptions::LengthError,
+                              (boost::format("Field name %s is longer than %d characters") % name %
+                               CoaddBoundedFieldSet::MAX_NAME_LENGTH)
+                                      .str());
+        }
+    }
+    for (auto const& element : elements) {
+        if (element.fields.size() != names.size()) {
+            throw LSST_EXCEPT(pex::exceptions::LengthError,
+                              (boost::format("Element has %d fields, but there are %d names") %
+                               element.fields.size() % names.size())
+                                      .str());
+        }
+        if (!element.wcs) {
+            throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "Element has no Wcs");
+        }
+    }
+}
+
+// The coadd-frame footprint of each element is that of the union of its fields' bounding boxes.
+std::shared_ptr<CoaddInputIndex const> makeIndex(afw::geom::SkyWcs const& coaddWcs,
+                                                 CoaddBoundedFieldSet::ElementVector const& elements) {
+    std::vector<geom::Box2D> boxes;
+    boxes.reserve(elements.size());
+    for (auto const& element : elements) {
+        geom::Box2I bbox;
+        for (auto const& field : element.fields) {
+            if (field) {
+                bbox.include(field->getBBox());
+            }
+        }
+        boxes.push_back(CoaddInputIndex::computeCoaddBBox(geom::Box2D(bbox), *element.wcs, coaddWcs));
+    }
+    return std::make_shared<CoaddInputIndex const>(boxes);
+}
+
+std::vector<geom::Point2D> makePositions(ndarray::Array<double const, 1> const& x,
+                                         ndarray::Array<double const, 1> const& y) {
+    if (x.getSize<0>() != y.getSize<0>()) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("x and y arrays have different sizes (%d vs. %d)") %
+                           x.getSize<0>() % y.getSize<0>())
+                                  .str());
+    }
+    std::vector<geom::Point2D> positions;
+    positions.reserve(x.getSize<0>());
+    for (int k = 0, n = x.getSize<0>(); k < n; ++k) {
+        positions.emplace_back(x[k], y[k]);
+    }
+    return positions;
+}
+
+}  // namespace
+
+CoaddBoundedFieldSet::CoaddBoundedFieldSet(geom::Box2I const& bbox, PTR(afw::geom::SkyWcs const) coaddWcs,
+                                           std::vector<std::string> const& names,
+                                           ElementVector const& elements)
+        : _bbox(bbox),
+          _throwOnMissing(true),
+          _default(0.0),  // unused
+          _coaddWcs(coaddWcs),
+          _names(names),
+          _elements(elements) {
+    checkElements(_names, _elements);
+    _index = makeIndex(*_coaddWcs, _elements);
+}
+
+CoaddBoundedFieldSet::CoaddBoundedFieldSet(geom::Box2I const& bbox, PTR(afw::geom::SkyWcs const) coaddWcs,
+                                           std::vector<std::string> const& names,
+                                           ElementVector const& elements, double default_)
+        : _bbox(bbox),
+          _throwOnMissing(false),
+          _default(default_),
+          _coaddWcs(coaddWcs),
+          _names(names),
+          _elements(elements) {
+    checkElements(_names, _elements);
+    _index = makeIndex(*_coaddWcs, _elements);
+}
+
+ndarray::Array<double, 1, 1> CoaddBoundedFieldSet::evaluate(geom::Point2D const& position) const {
+    ndarray::Array<double, 2, 2> const values = _evaluate({position}, 0, _names.size());
+    ndarray::Array<double, 1, 1> result = ndarray::allocate(_names.size());
+    for (std::size_t f = 0; f < _names.size(); ++f) {
+        result[f] = values[f][0];
+    }
+    return result;
+}
+
+ndarray::Array<double, 2, 2> CoaddBoundedFieldSet::evaluate(ndarray::Array<double const, 1> const& x,
+                                                            ndarray::Array<double const, 1> const& y) const {
+    return _evaluate(makePositions(x, y), 0, _names.size());
+}
+
+double CoaddBoundedFieldSet::evaluate(std::size_t i, geom::Point2D const& position) const {
+    return _evaluate({position}, i, i + 1)[0][0];
+}
+
+ndarray::Array<double, 1, 1> CoaddBoundedFieldSet::evaluate(std::size_t i,
+                                                            ndarray::Array<double const, 1> const& x,
+                                                            ndarray::Array<double const, 1> const& y) const {
+    return ndarray::copy(_evaluate(makePositions(x, y), i, i + 1)[0]);
+}
+
+ndarray::Array<double, 2, 2> CoaddBoundedFieldSet::_evaluate(std::vector<geom::Point2D> const& positions,
+                                                             std::size_t fieldBegin,
+                                                             std::size_t fieldEnd) const {
+    std::size_t const nPoints = positions.size();
+    std::size_t const nFields = fieldEnd - fieldBegin;
+    ndarray::Array<double, 2, 2> result = ndarray::allocate(nFields, nPoints);
+    if (nPoints == 0 || nFields == 0) {
+        return result;
+    }
+    geom::Box2D region;
+    for (auto const& position : positions) {
+        region.include(position);
+    }
+    std::vector<geom::SpherePoint> coords;  // only computed if some element needs them
+
+    ndarray::Array<double, 2, 2> sum = ndarray::allocate(nFields, nPoints);
+    ndarray::Array<double, 2, 2> wSum = ndarray::allocate(nFields, nPoints);
+    sum.deep() = 0.0;
+    wSum.deep() = 0.0;
+    std::vector<std::size_t> selected;
+    std::vector<geom::SpherePoint> selectedCoords;
+    std::vector<bool> valid;
+    std::vector<std::size_t> inside;
+    // Elements are visited in order, so each field accumulates its sums in the same order as a
+    // CoaddBoundedField built from the elements that have that field.
+    for (std::size_t index : _index->getOverlapping(region)) {
+        Element const& element = _elements[index];
+        if (std::none_of(element.fields.begin() + fieldBegin, element.fields.begin() + fieldEnd,
+                         [](PTR(afw::math::BoundedField) const& field) { return bool(field); })) {
+            continue;
+        }
+        geom::Box2D const& coaddBBox = _index->getInputBBox(index);
+        selected.clear();
+        for (std::size_t k = 0; k < nPoints; ++k) {
+            if (coaddBBox.isEmpty() || coaddBBox.contains(positions[k])) {
+                selected.push_back(k);
+            }
+        }
+        if (selected.empty()) {
+            continue;
+        }
+        // The sky round trip and the validPolygon test are shared by all the fields.
+        if (coords.empty()) {
+            coords = _coaddWcs->pixelToSky(positions);
+        }
+        selectedCoords.clear();
+        for (std::size_t k : selected) {
+            selectedCoords.push_back(coords[k]);
+        }
+        std::vector<geom::Point2D> const transformed = element.wcs->skyToPixel(selectedCoords);
+        valid.assign(selected.size(), true);
+        if (element.validPolygon) {
+            for (std::size_t j = 0; j < selected.size(); ++j) {
+                valid[j] = element.validPolygon->contains(transformed[j]);
+            }
+        }
+        for (std::size_t f = fieldBegin; f < fieldEnd; ++f) {
+            PTR(afw::math::BoundedField) const& field = element.fields[f];
+            if (!field) {
+                continue;
+            }
+            geom::Box2D const fieldBBox(field->getBBox());
+            inside.clear();
+            for (std::size_t j = 0; j < selected.size(); ++j) {
+                if (valid[j] && fieldBBox.contains(transformed[j])) {
+                    inside.push_back(j);
+                }
+            }
+            if (inside.empty()) {
+                continue;
+            }
+            ndarray::Array<double, 1, 1> xInside = ndarray::allocate(inside.size());
+            ndarray::Array<double, 1, 1> yInside = ndarray::allocate(inside.size());
+            for (std::size_t j = 0; j < inside.size(); ++j) {
+                xInside[j] = transformed[inside[j]].getX();
+                yInside[j] = transformed[inside[j]].getY();
+            }
+            ndarray::Array<double, 1, 1> const values = field->evaluate(xInside, yInside);
+            for (std::size_t j = 0; j < inside.size(); ++j) {
+                std::size_t const k = selected[inside[j]];
+                sum[f - fieldBegin][k] += element.weight * values[j];
+                wSum[f - fieldBegin][k] += element.weight;
+            }
+        }
+    }
+
+    for (std::size_t f = 0; f < nFields; ++f) {
+        for (std::size_t k = 0; k < nPoints; ++k) {
+            if (wSum[f][k] == 0.0) {
+                if (_throwOnMissing) {
+                    throw LSST_EXCEPT(pex::exceptions::DomainError,
+                                      (boost::format("No constituent fields %s to evaluate at point %f, %f") %
+                                       _names[fieldBegin + f] % positions[k].getX() % positions[k].getY())
+                                              .str());
+                }
+                result[f][k] = _default;
+            } else {
+                result[f][k] = sum[f][k] / wSum[f][k];
+            }
+        }
+    }
+    return result;
+}
+
+std::size_t CoaddBoundedFieldSet::getFieldIndex(std::string const& name) const {
+    auto const iter = std::find(_names.begin(), _names.end(), name);
+    if (iter == _names.end()) {
+        throw LSST_EXCEPT(pex::exceptions::NotFoundError,
+                          (boost::format("No field named %s in CoaddBoundedFieldSet") % name).str());
+    }
+    return iter - _names.begin();
+}
+
+PTR(afw::math::BoundedField) CoaddBoundedFieldSet::getField(std::string const& name) const {
+    return std::make_shared<CoaddBoundedFieldSetMember>(shared_from_this(), getFieldIndex(name));
+}
+
+PTR(CoaddBoundedField) CoaddBoundedFieldSet::makeCoaddBoundedField(std::size_t i) const {
+    if (i >= _names.size()) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Field index %d out of range for a set of %d fields") % i %
+                           _names.size())
+                                  .str());
+    }
+    CoaddBoundedField::ElementVector elements;
+    for (auto const& element : _elements) {
+        if (element.fields[i]) {
+            elements.push_back(CoaddBoundedField::Element(element.fields[i], element.wcs,
+                                                          element.validPolygon, element.weight));
+        }
+    }
+    if (_throwOnMissing) {
+        return std::make_shared<CoaddBoundedField>(_bbox, _coaddWcs, elements);
+    }
+    return std::make_shared<CoaddBoundedField>(_bbox, _coaddWcs, elements, _default);
+}
+
+bool CoaddBoundedFieldSet::operator==(CoaddBoundedFieldSet const& rhs) const {
+    if (this == &rhs) {
+        return true;
+    }
+    if (_bbox != rhs._bbox || _default != rhs._default || _names != rhs._names ||
+        !ptrEquals(_coaddWcs, rhs._coaddWcs) || _elements.size() != rhs._elements.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < _elements.size(); ++i) {
+        Element const& a = _elements[i];
+        Element const& b = rhs._elements[i];
+        if (!ptrEquals(a.wcs, b.wcs) || !ptrEquals(a.validPolygon, b.validPolygon) || a.weight != b.weight) {
+            return false;
+        }
+        for (std::size_t f = 0; f < _names.size(); ++f) {
+            if (!ptrEquals(a.fields[f], b.fields[f])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+CoaddBoundedFieldSetMember::CoaddBoundedFieldSetMember(std::shared_ptr<CoaddBoundedFieldSet const> set,
+                                                       std::size_t index)
+        : afw::math::BoundedField(set->getBBox()), _set(std::move(set)), _index(index) {
+    if (_index >= _set->getFieldCount()) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Field index %d out of range for a set of %d fields") % _index %
+                           _set->getFieldCount())
+                                  .str());
+    }
+}
+
+double CoaddBoundedFieldSetMember::evaluate(geom::Point2D const& position) const {
+    return _set->evaluate(_index, position);
+}
+
+ndarray::Array<double, 1, 1> CoaddBoundedFieldSetMember::evaluate(
+        ndarray::Array<double const, 1> const& x, ndarray::Array<double const, 1> const& y) const {
+    return _set->evaluate(_index, x, y);
+}
+
+PTR(afw::math::BoundedField) CoaddBoundedFieldSetMember::operator*(double const scale) const {
+    throw LSST_EXCEPT(pex::exceptions::NotFoundError,
+                      "Scaling of CoaddBoundedFieldSetMember is not implemented");
+}
+
+bool CoaddBoundedFieldSetMember::operator==(BoundedField const& rhs) const {
+    auto rhsCasted = dynamic_cast<CoaddBoundedFieldSetMember const*>(&rhs);
+    if (!rhsCasted) return false;
+
+    return _index == rhsCasted->_index && ptrEquals(_set, rhsCasted->_set);
+}
+
+// ---------- Persistence -----------------------------------------------------------------------------------
+
+// For persistence of CoaddBoundedFieldSet, we have four catalogs: the first has just one record, and
+// contains the bbox, the archive ID of the coadd WCS and the parameters that control missing data.  The
+// second has a record for each field name, and the third a record for each element, with the archive IDs
+// of its Wcs and validPolygon and its weight.  The last has the archive ID of each element's field for
+// each name (0 if the element doesn't have it), element by element.
+//
+// CoaddBoundedFieldSetMember is persisted as the equivalent CoaddBoundedField, which older code can read;
+// the archive still saves each Wcs and validPolygon only once, as the fields share the pointers.
+
+namespace {
+
+// Singleton class that manages the first persistence catalog's schema and keys
+class CoaddBoundedFieldSetPersistenceKeys1 {
+public:
+    afw::table::Schema schema;
+    afw::table::PointKey<int> bboxMin;
+    afw::table::PointKey<int> bboxMax;
+    afw::table::Key<int> coaddWcs;
+    afw::table::Key<afw::table::Flag> throwOnMissing;
+    afw::table::Key<double> default_;
+
+    static CoaddBoundedFieldSetPersistenceKeys1 const& get() {
+        static CoaddBoundedFieldSetPersistenceKeys1 const instance;
+        return instance;
+    }
+
+    // No copying
+    CoaddBoundedFieldSetPersistenceKeys1(const CoaddBoundedFieldSetPersistenceKeys1&) = delete;
+    CoaddBoundedFieldSetPersistenceKeys1& operator=(const CoaddBoundedFieldSetPersistenceKeys1&) = delete;
+
+    // No moving
+    CoaddBoundedFieldSetPersistenceKeys1(CoaddBoundedFieldSetPersistenceKeys1&&) = delete;
+    CoaddBoundedFieldSetPersistenceKeys1& operator=(CoaddBoundedFieldSetPersistenceKeys1&&) = delete;
+
+private:
+    CoaddBoundedFieldSetPersistenceKeys1()
+            : schema(),
+              bboxMin(afw::table::PointKey<int>::addFields(schema, "bbox_min",
+                                                           "lower-left corner of bounding box", "pixel")),
+              bboxMax(afw::table::PointKey<int>::addFields(schema, "bbox_max",
+                                                           "upper-right corner of bounding box", "pixel")),
+              coaddWcs(schema.addField<int>("coaddWcs", "archive ID of the coadd's WCS")),
+              throwOnMissing(schema.addField<afw::table::Flag>(
+                      "throwOnMissing", "whether to throw an exception on missing data")),
+              default_(schema.addField<double>("default",
+                                               "default value to use when throwOnMissing is False")) {}
+};
+
+// Singleton class that manages the second persistence catalog's schema and keys
+class CoaddBoundedFieldSetPersistenceKeys2 {
+public:
+    afw::table::Schema schema;
+    afw::table::Key<std::string> name;
+
+    static CoaddBoundedFieldSetPersistenceKeys2 const& get() {
+        static CoaddBoundedFieldSetPersistenceKeys2 const instance;
+        return instance;
+    }
+
+    // No copying
+    CoaddBoundedFieldSetPersistenceKeys2(const CoaddBoundedFieldSetPersistenceKeys2&) = delete;
+    CoaddBoundedFieldSetPersistenceKeys2& operator=(const CoaddBoundedFieldSetPersistenceKeys2&) = delete;
+
+    // No moving
+    CoaddBoundedFieldSetPersistenceKeys2(CoaddBoundedFieldSetPersistenceKeys2&&) = delete;
+    CoaddBoundedFieldSetPersistenceKeys2& operator=(CoaddBoundedFieldSetPersistenceKeys2&&) = delete;
+
+private:
+    CoaddBoundedFieldSetPersistenceKeys2()
+            : schema(),
+              name(schema.addField<std::string>("name", "name of the field",
+                                                CoaddBoundedFieldSet::MAX_NAME_LENGTH)) {}
+};
+
+// Singleton class that manages the third persistence catalog's schema and keys
+class CoaddBoundedFieldSetPersistenceKeys3 {
+public:
+    afw::table::Schema schema;
+    afw::table::Key<int> wcs;
+    afw::table::Key<int> validPolygon;
+    afw::table::Key<double> weight;
+
+    static CoaddBoundedFieldSetPersistenceKeys3 const& get() {
+        static CoaddBoundedFieldSetPersistenceKeys3 const instance;
+        return instance;
+    }
+
+    // No copying
+    CoaddBoundedFieldSetPersistenceKeys3(const CoaddBoundedFieldSetPersistenceKeys3&) = delete;
+    CoaddBoundedFieldSetPersistenceKeys3& operator=(const CoaddBoundedFieldSetPersistenceKeys3&) = delete;
+
+    // No moving
+    CoaddBoundedFieldSetPersistenceKeys3(CoaddBoundedFieldSetPersistenceKeys3&&) = delete;
+    CoaddBoundedFieldSetPersistenceKeys3& operator=(CoaddBoundedFieldSetPersistenceKeys3&&) = delete;
+
+private:
+    CoaddBoundedFieldSetPersistenceKeys3()
+            : schema(),
+              wcs(schema.addField<int>("wcs", "archive ID of the Wcs associated with this element")),
+              validPolygon(schema.addField<int>("validPolygon",
+                                                "archive ID of the Polygon associated with this element")),
+              weight(schema.addField<double>("weight", "weight value for this element")) {}
+};
+
+// Singleton class that manages the fourth persistence catalog's schema and keys
+class CoaddBoundedFieldSetPersistenceKeys4 {
+public:
+    afw::table::Schema schema;
+    afw::table::Key<int> field;
+
+    static CoaddBoundedFieldSetPersistenceKeys4 const& get() {
+        static CoaddBoundedFieldSetPersistenceKeys4 const instance;
+        return instance;
+    }
+
+    // No copying
+    CoaddBoundedFieldSetPersistenceKeys4(const CoaddBoundedFieldSetPersistenceKeys4&) = delete;
+    CoaddBoundedFieldSetPersistenceKeys4& operator=(const CoaddBoundedFieldSetPersistenceKeys4&) = delete;
+
+    // No moving
+    CoaddBoundedFieldSetPersistenceKeys4(CoaddBoundedFieldSetPersistenceKeys4&&) = delete;
+    CoaddBoundedFieldSetPersistenceKeys4& operator=(CoaddBoundedFieldSetPersistenceKeys4&&) = delete;
+
+private:
+    CoaddBoundedFieldSetPersistenceKeys4()
+            : schema(),
+              field(schema.addField<int>("field", "archive ID of the element's BoundedField (0 if none)")) {}
+};
+
+}  // namespace
+
+class CoaddBoundedFieldSet::Factory : public afw::table::io::PersistableFactory {
+public:
+    virtual PTR(afw::table::io::Persistable)
+            read(InputArchive const& archive, CatalogVector const& catalogs) const {
+        CoaddBoundedFieldSetPersistenceKeys1 const& keys1 = CoaddBoundedFieldSetPersistenceKeys1::get();
+        CoaddBoundedFieldSetPersistenceKeys2 const& keys2 = CoaddBoundedFieldSetPersistenceKeys2::get();
+        CoaddBoundedFieldSetPersistenceKeys3 const& keys3 = CoaddBoundedFieldSetPersistenceKeys3::get();
+        CoaddBoundedFieldSetPersistenceKeys4 const& keys4 = CoaddBoundedFieldSetPersistenceKeys4::get();
+        LSST_ARCHIVE_ASSERT(catalogs.size() == 4u);
+        LSST_ARCHIVE_ASSERT(catalogs[0].getSchema() == keys1.schema);
+        LSST_ARCHIVE_ASSERT(catalogs[1].getSchema() == keys2.schema);
+        LSST_ARCHIVE_ASSERT(catalogs[2].getSchema() == keys3.schema);
+        LSST_ARCHIVE_ASSERT(catalogs[3].getSchema() == keys4.schema);
+        LSST_ARCHIVE_ASSERT(catalogs[3].size() == catalogs[1].size() * catalogs[2].size());
+        afw::table::BaseRecord const& record1 = catalogs[0].front();
+        std::vector<std::string> names;
+        names.reserve(catalogs[1].size());
+        for (auto const& record2 : catalogs[1]) {
+            names.push_back(record2.get(keys2.name));
+        }
+        ElementVector elements;
+        elements.reserve(catalogs[2].size());
+        afw::table::BaseCatalog::const_iterator record4 = catalogs[3].begin();
+        for (auto const& record3 : catalogs[2]) {
+            std::vector<PTR(afw::math::BoundedField)> fields;
+            fields.reserve(names.size());
+            for (std::size_t f = 0; f < names.size(); ++f, ++record4) {
+                fields.push_back(archive.get<afw::math::BoundedField>(record4->get(keys4.field)));
+            }
+            auto validPolygon = archive.get<afw::geom::polygon::Polygon>(record3.get(keys3.validPolygon));
+            elements.push_back(Element(fields, archive.get<afw::geom::SkyWcs>(record3.get(keys3.wcs)),
+                                       validPolygon, record3.get(keys3.weight)));
+        }
+        geom::Box2I const bbox(record1.get(keys1.bboxMin), record1.get(keys1.bboxMax));
+        auto coaddWcs = archive.get<afw::geom::SkyWcs>(record1.get(keys1.coaddWcs));
+        if (record1.get(keys1.throwOnMissing)) {
+            return std::make_shared<CoaddBoundedFieldSet>(bbox, coaddWcs, names, elements);
+        }
+        return std::make_shared<CoaddBoundedFieldSet>(bbox, coaddWcs, names, elements,
+                                                      record1.get(keys1.default_));
+    }
+
+    Factory(std::string const& name) : afw::table::io::PersistableFactory(name) {}
+};
+
+namespace {
+
+std::string getCoaddBoundedFieldSetPersistenceName() { return "CoaddBoundedFieldSet"; }
+
+CoaddBoundedFieldSet::Factory registration(getCoaddBoundedFieldSetPersistenceName());
+
+}  // namespace
+
+std::string CoaddBoundedFieldSet::getPersistenceName() const {
+    return getCoaddBoundedFieldSetPersistenceName();
+}
+
+std::string CoaddBoundedFieldSet::getPythonModule() const { return "lsst.meas.algorithms"; }
+
+void CoaddBoundedFieldSet::write(OutputArchiveHandle& handle) const {
+    CoaddBoundedFieldSetPersistenceKeys1 const& keys1 = CoaddBoundedFieldSetPersistenceKeys1::get();
+    CoaddBoundedFieldSetPersistenceKeys2 const& keys2 = CoaddBoundedFieldSetPersistenceKeys2::get();
+    CoaddBoundedFieldSetPersistenceKeys3 const& keys3 = CoaddBoundedFieldSetPersistenceKeys3::get();
+    CoaddBoundedFieldSetPersistenceKeys4 const& keys4 = CoaddBoundedFieldSetPersistenceKeys4::get();
+    afw::table::BaseCatalog cat1 = handle.makeCatalog(keys1.schema);
+    PTR(afw::table::BaseRecord) record1 = cat1.addNew();
+    record1->set(keys1.bboxMin, _bbox.getMin());
+    record1->set(keys1.bboxMax, _bbox.getMax());
+    record1->set(keys1.coaddWcs, handle.put(_coaddWcs));
+    record1->set(keys1.throwOnMissing, _throwOnMissing);
+    record1->set(keys1.default_, _default);
+    handle.saveCatalog(cat1);
+    afw::table::BaseCatalog cat2 = handle.makeCatalog(keys2.schema);
+    for (auto const& name : _names) {
+        cat2.addNew()->set(keys2.name, name);
+    }
+    handle.saveCatalog(cat2);
+    afw::table::BaseCatalog cat3 = handle.makeCatalog(keys3.schema);
+    afw::table::BaseCatalog cat4 = handle.makeCatalog(keys4.schema);
+    for (auto const& element : _elements) {
+        PTR(afw::table::BaseRecord) record3 = cat3.addNew();
+        record3->set(keys3.wcs, handle.put(element.wcs));
+        record3->set(keys3.validPolygon, handle.put(element.validPolygon));
+        record3->set(keys3.weight, element.weight);
+        for (auto const& field : element.fields) {
+            cat4.addNew()->set(keys4.field, handle.put(field));
+        }
+    }
+    handle.saveCatalog(cat3);
+    handle.saveCatalog(cat4);
+}
+
+std::string CoaddBoundedFieldSetMember::getPersistenceName() const {
+    return _set->makeCoaddBoundedField(_index)->getPersistenceName();
+}
+
+std::string CoaddBoundedFieldSetMember::getPythonModule() const { return "lsst.meas.algorithms"; }
+
+void CoaddBoundedFieldSetMember::write(OutputArchiveHandle& handle) const {
+    _set->makeCoaddBoundedField(_index)->write(handle);
+}
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,241 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/algorithms/CoaddInputIndex.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+namespace {
+
+// Number of points sampled along each edge of an input bbox when mapping it into the coadd frame.
+int const N_SAMPLES_PER_EDGE = 8;
+
+// Maximum number of cells along either axis of the grid.
+int const MAX_CELLS_PER_AXIS = 256;
+
+// Target number of grid cells per bounded input.
+int const CELLS_PER_INPUT = 4;
+
+bool isFinite(geom::Box2D const& box) {
+    return !box.isEmpty() && std::isfinite(box.getMinX()) && std::isfinite(box.getMinY()) &&
+           std::isfinite(box.getMaxX()) && std::isfinite(box.getMaxY());
+}
+
+std::vector<geom::Box2D> computeCatalogBoxes(afw::table::ExposureCatalog const& catalog,
+                                             afw::geom::SkyWcs const& coaddWcs) {
+    std::vector<geom::Box2D> boxes;
+    boxes.reserve(catalog.size());
+    for (auto const& record : catalog) {
+        if (!record.getWcs()) {
+            boxes.push_back(geom::Box2D());
+            continue;
+        }
+        boxes.push_back(
+                CoaddInputIndex::computeCoaddBBox(geom::Box2D(record.getBBox()), *record.getWcs(), coaddWcs));
+    }
+    return boxes;
+}
+
+}  // namespace
+
+CoaddInputIndex::CoaddInputIndex(std::vector<geom::Box2D> const& boxes) : _boxes(boxes) { _build(); }
+
+CoaddInputIndex::CoaddInputIndex(afw::table::ExposureCatalog const& catalog,
+                                 afw::geom::SkyWcs const& coaddWcs) {
+    // Include the (dominant) cost of mapping the input boxes into the coadd frame in the build time.
+    auto const start = std::chrono::steady_clock::now();
+    _boxes = computeCatalogBoxes(catalog, coaddWcs);
+    _build();
+    _buildTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+geom::Box2D CoaddInputIndex::computeCoaddBBox(geom::Box2D const& bbox, afw::geom::SkyWcs const& inputWcs,
+                                              afw::geom::SkyWcs const& coaddWcs) {
+    if (bbox.isEmpty()) {
+        return geom::Box2D();
+    }
+    std::vector<geom::Point2D> points;
+    points.reserve(4 * N_SAMPLES_PER_EDGE);
+    double const dx = bbox.getWidth() / N_SAMPLES_PER_EDGE;
+    double const dy = bbox.getHeight() / N_SAMPLES_PER_EDGE;
+    for (int i = 0; i < N_SAMPLES_PER_EDGE; ++i) {
+        points.emplace_back(bbox.getMinX() + i * dx, bbox.getMinY());
+        points.emplace_back(bbox.getMaxX(), bbox.getMinY() + i * dy);
+        points.emplace_back(bbox.getMaxX() - i * dx, bbox.getMaxY());
+        points.emplace_back(bbox.getMinX(), bbox.getMaxY() - i * dy);
+    }
+    std::vector<geom::Point2D> coaddPoints;
+    try {
+        auto inputToCoadd = afw::geom::makeWcsPairTransform(inputWcs, coaddWcs);
+        coaddPoints = inputToCoadd->applyForward(points);
+    } catch (pex::exceptions::Exception&) {
+        return geom::Box2D();
+    }
+    geom::Box2D result;
+    for (auto const& point : coaddPoints) {
+        if (!std::isfinite(point.getX()) || !std::isfinite(point.getY())) {
+            return geom::Box2D();
+        }
+        result.include(point);
+    }
+    // Pad to allow for curvature of the boundary between samples, plus a pixel for rounding.
+    double const pad = 0.01 * std::hypot(result.getWidth(), result.getHeight()) + 1.0;
+    result.grow(pad);
+    return result;
+}
+
+void CoaddInputIndex::_build() {
+    auto const start = std::chrono::steady_clock::now();
+
+    _unbounded.clear();
+    _cells.clear();
+    _bbox = geom::Box2D();
+    _nx = 0;
+    _ny = 0;
+    _cellWidth = 0.0;
+    _cellHeight = 0.0;
+
+    std::size_t nBounded = 0;
+    for (std::size_t i = 0; i < _boxes.size(); ++i) {
+        if (isFinite(_boxes[i])) {
+            _bbox.include(_boxes[i]);
+            ++nBounded;
+        } else {
+            _unbounded.push_back(i);
+        }
+    }
+
+    if (nBounded > 0) {
+        double const width = std::max(_bbox.getWidth(), 1.0);
+        double const height = std::max(_bbox.getHeight(), 1.0);
+        double const target = static_cast<double>(CELLS_PER_INPUT * nBounded);
+        _nx = std::max(1, std::min(MAX_CELLS_PER_AXIS, static_cast<int>(std::lround(
+                                                               std::sqrt(target * width / height)))));
+        _ny = std::max(1, std::min(MAX_CELLS_PER_AXIS, static_cast<int>(std::lround(target / _nx))));
+        _cellWidth = width / _nx;
+        _cellHeight = height / _ny;
+        _cells.resize(static_cast<std::size_t>(_nx) * _ny);
+
+        // Boxes are visited in index order, so every cell list ends up sorted.
+        for (std::size_t i = 0; i < _boxes.size(); ++i) {
+            geom::Box2D const& box = _boxes[i];
+            if (!isFinite(box)) {
+                continue;
+            }
+            int const ix0 = std::max(0, static_cast<int>((box.getMinX() - _bbox.getMinX()) / _cellWidth));
+            int const iy0 = std::max(0, static_cast<int>((box.getMinY() - _bbox.getMinY()) / _cellHeight));
+            int const ix1 =
+                    std::min(_nx - 1, static_cast<int>((box.getMaxX() - _bbox.getMinX()) / _cellWidth));
+            int const iy1 =
+                    std::min(_ny - 1, static_cast<int>((box.getMaxY() - _bbox.getMinY()) / _cellHeight));
+            for (int iy = iy0; iy <= iy1; ++iy) {
+                for (int ix = ix0; ix <= ix1; ++ix) {
+                    _cells[static_cast<std::size_t>(iy) * _nx + ix].push_back(i);
+                }
+            }
+        }
+
+        if (!_unbounded.empty()) {
+            for (auto& cell : _cells) {
+                std::vector<std::size_t> merged;
+                merged.reserve(cell.size() + _unbounded.size());
+                std::merge(cell.begin(), cell.end(), _unbounded.begin(), _unbounded.end(),
+                           std::back_inserter(merged));
+                cell.swap(merged);
+            }
+        }
+        for (auto& cell : _cells) {
+            cell.shrink_to_fit();
+        }
+    }
+
+    _buildTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::vector<std::size_t> const& CoaddInputIndex::getCandidates(geom::Point2D const& position) const {
+    if (_cells.empty() || !_bbox.contains(position)) {
+        return _unbounded;
+    }
+    int const ix = std::min(_nx - 1, static_cast<int>((position.getX() - _bbox.getMinX()) / _cellWidth));
+    int const iy = std::min(_ny - 1, static_cast<int>((position.getY() - _bbox.getMinY()) / _cellHeight));
+    return _cells[static_cast<std::size_t>(iy) * _nx + ix];
+}
+
+std::vector<std::size_t> CoaddInputIndex::getOverlapping(geom::Box2D const& box) const {
+    std::vector<std::size_t> result;
+    if (box.isEmpty()) {
+        return result;
+    }
+    if (_cells.empty() || !_bbox.overlaps(box)) {
+        return _unbounded;
+    }
+    int const ix0 = std::max(0, static_cast<int>((box.getMinX() - _bbox.getMinX()) / _cellWidth));
+    int const iy0 = std::max(0, static_cast<int>((box.getMinY() - _bbox.getMinY()) / _cellHeight));
+    int const ix1 = std::min(_nx - 1, static_cast<int>((box.getMaxX() - _bbox.getMinX()) / _cellWidth));
+    int const iy1 = std::min(_ny - 1, static_cast<int>((box.getMaxY() - _bbox.getMinY()) / _cellHeight));
+    for (int iy = iy0; iy <= iy1; ++iy) {
+        for (int ix = ix0; ix <= ix1; ++ix) {
+            auto const& cell = _cells[static_cast<std::size_t>(iy) * _nx + ix];
+            result.insert(result.end(), cell.begin(), cell.end());
+        }
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    result.erase(std::remove_if(result.begin(), result.end(),
+                                [this, &box](std::size_t i) {
+                                    return isFinite(_boxes[i]) && !_boxes[i].overlaps(box);
+                                }),
+                 result.end());
+    return result;
+}
+
+std::size_t CoaddInputIndex::getEntryCount() const {
+    std::size_t count = 0;
+    for (auto const& cell : _cells) {
+        count += cell.size();
+    }
+    return count;
+}
+
+std::size_t CoaddInputIndex::getMemorySize() const {
+    std::size_t size = sizeof(*this);
+    size += _boxes.capacity() * sizeof(geom::Box2D);
+    size += _unbounded.capacity() * sizeof(std::size_t);
+    size += _cells.capacity() * sizeof(std::vector<std::size_t>);
+    for (auto const& cell : _cells) {
+        size += cell.capacity() * sizeof(std::size_t);
+    }
+    return size;
+}
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
@@ -26,10 +26,19 @@
  * Represent a PSF as for a Coadd based on the James Jee stacking
  * algorithm which was extracted from Stackfit.
  */
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
 #include <sstream>
 #include <iostream>
+#include <mutex>
 #include <numeric>
+#include <thread>
 #include "boost/iterator/iterator_adaptor.hpp"
 #include "boost/iterator/transform_iterator.hpp"
 #include "ndarray/eigen.h"
@@ -39,6 +48,7 @@
 #include "lsst/afw/image/ImageUtils.h"
 #include "lsst/afw/math/Statistics.h"
 #include "lsst/meas/algorithms/CoaddPsf.h"
+#include "lsst/meas/algorithms/Instrumentation.h"
 #include "lsst/afw/table/io/OutputArchive.h"
 #include "lsst/afw/table/io/InputArchive.h"
 #include "lsst/afw/table/io/CatalogVector.h"
@@ -61,6 +71,28 @@ namespace algorithms {
 
 namespace {
 
+// Maximum number of positions evaluated together by doComputeKernelImages.
+std::size_t const BATCH_CHUNK_SIZE = 64;
+
+// Whether CoaddPsf::Factory defers reading the inputs' Psfs on this thread; see CoaddPsf::LazyReadingScope.
+thread_local bool lazyReading = false;
+
+std::shared_ptr<PsfImageCache> makeImageCache(CoaddPsfControl const &ctrl) {
+    if (ctrl.imageCacheTolerance <= 0.0) {
+        return nullptr;
+    }
+    return std::make_shared<PsfImageCache>(ctrl.imageCacheTolerance,
+                                           static_cast<std::size_t>(ctrl.imageCacheSizeMB) << 20);
+}
+
+CONST_PTR(LanczosStampWarper) makeStampWarper(CoaddPsfControl const &ctrl,
+                                              afw::math::WarpingControl const &warpingControl) {
+    if (!ctrl.useStampWarper) {
+        return nullptr;
+    }
+    return LanczosStampWarper::fromWarpingControl(warpingControl);
+}
+
 // Struct used to simplify calculations in computeAveragePosition; lets us use
 // std::accumulate instead of explicit for loop.
 struct AvgPosItem {
@@ -139,10 +171,8 @@ geom::Point2D computeAveragePosition(afw::table::ExposureCatalog const &catalog,
 }  // namespace
 
 CoaddPsf::CoaddPsf(afw::table::ExposureCatalog const &catalog, afw::geom::SkyWcs const &coaddWcs,
-                   std::string const &weightFieldName, std::string const &warpingKernelName, int cacheSize)
-        : _coaddWcs(coaddWcs),
-          _warpingKernelName(warpingKernelName),
-          _warpingControl(std::make_shared<afw::math::WarpingControl>(warpingKernelName, "", cacheSize)) {
+                   CoaddPsfControl const &ctrl, std::string const &weightFieldName)
+        : _coaddWcs(coaddWcs) {
     afw::table::SchemaMapper mapper(catalog.getSchema());
     mapper.addMinimalSchema(afw::table::ExposureTable::makeMinimalSchema(), true);
 
@@ -165,9 +195,51 @@ CoaddPsf::CoaddPsf(afw::table::ExposureCatalog const &catalog, afw::geom::SkyWcs
         _catalog.push_back(record);
     }
     _averagePosition = computeAveragePosition(_catalog, _coaddWcs, _weightKey);
+    _inputIndex = std::make_shared<CoaddInputIndex>(_catalog, _coaddWcs);
+    _setControl(ctrl);
 }
 
-PTR(afw::detection::Psf) CoaddPsf::clone() const { return std::make_shared<CoaddPsf>(*this); }
+PTR(afw::detection::Psf) CoaddPsf::clone() const {
+    auto result = std::make_shared<CoaddPsf>(*this);
+    // Give the clone its own WarpedPsfs, so it shares no mutable state (e.g. Psf image caches).
+    result->_warpedPsfCache = std::make_shared<WarpedPsfCache>(_catalog.size());
+    if (_imageCache) {
+        result->_imageCache =
+                std::make_shared<PsfImageCache>(_imageCache->getTolerance(), _imageCache->getMaxBytes());
+    }
+    return result;
+}
+
+CoaddPsfControl CoaddPsf::getControl() const {
+    CoaddPsfControl ctrl(_warpingKernelName, _warpingControl->getCacheSize(), _nThreads);
+    if (_imageCache) {
+        ctrl.imageCacheTolerance = _imageCache->getTolerance();
+        ctrl.imageCacheSizeMB = static_cast<int>(_imageCache->getMaxBytes() >> 20);
+    }
+    ctrl.useStampWarper = static_cast<bool>(_stampWarper);
+    return ctrl;
+}
+
+std::shared_ptr<CoaddPsf> CoaddPsf::withControl(CoaddPsfControl const &ctrl) const {
+    auto result = std::make_shared<CoaddPsf>(*this);
+    result->_setControl(ctrl);
+    if (auto resultCache = getResultCache()) {
+        // The measurements in the shared cache may have been made with a different warping kernel
+        result->setResultCacheCapacity(0);
+        result->setResultCacheCapacity(resultCache->getCapacity());
+    }
+    return result;
+}
+
+void CoaddPsf::_setControl(CoaddPsfControl const &ctrl) {
+    _warpingKernelName = ctrl.warpingKernelName;
+    _warpingControl = std::make_shared<afw::math::WarpingControl>(ctrl.warpingKernelName, "", ctrl.cacheSize);
+    _nThreads = ctrl.nThreads;
+    _stampWarper = makeStampWarper(ctrl, *_warpingControl);
+    _warpedPsfCache = std::make_shared<WarpedPsfCache>(_catalog.size());
+    _workerPool = ctrl.nThreads > 1 ? std::make_shared<WorkerPool>(ctrl.nThreads - 1) : nullptr;
+    _imageCache = makeImageCache(ctrl);
+}
 
 PTR(afw::detection::Psf) CoaddPsf::resized(int width, int height) const {
     // Not implemented for WarpedPsf
@@ -212,8 +284,312 @@ void addToImage(PTR(afw::image::Image<double>) image,
     }
 }
 
+// Sum the component images with the given weights into a new image that contains them all.
+
+PTR(afw::detection::Psf::Image) combineImages(std::vector<PTR(afw::image::Image<double>)> const &imgVector,
+                                              std::vector<double> const &weightVector, double weightSum) {
+    geom::Box2I bbox = getOverallBBox(imgVector);
+
+    // create a zero image of the right size to sum into
+    PTR(afw::detection::Psf::Image) image = std::make_shared<afw::detection::Psf::Image>(bbox);
+    *image = 0.0;
+    addToImage(image, imgVector, weightVector);
+    *image /= weightSum;
+    return image;
+}
+
+// Holds the WarpedPsf (and hence the exposure-to-coadd transform) for each input, constructed on
+// first use.  Construction happens outside the lock, so concurrent callers never wait on each other's
+// AST frameset construction; if two threads race to build the same entry, the first one stored wins.
+class CoaddPsf::WarpedPsfCache {
+public:
+    explicit WarpedPsfCache(std::size_t size) : _transforms(size), _warpedPsfs(size) {}
+
+    std::shared_ptr<afw::geom::TransformPoint2ToPoint2 const> getTransform(
+            std::size_t i, afw::table::ExposureRecord const &record, afw::geom::SkyWcs const &coaddWcs) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_transforms[i]) {
+                return _transforms[i];
+            }
+        }
+        // compute transform from exposure pixels to coadd pixels
+        std::shared_ptr<afw::geom::TransformPoint2ToPoint2 const> exposureToCoadd =
+                afw::geom::makeWcsPairTransform(*record.getWcs(), coaddWcs);
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_transforms[i]) {
+            _transforms[i] = std::move(exposureToCoadd);
+        }
+        return _transforms[i];
+    }
+
+    std::shared_ptr<WarpedPsf const> get(std::size_t i, afw::table::ExposureRecord const &record,
+                                         afw::geom::SkyWcs const &coaddWcs,
+                                         CONST_PTR(afw::math::WarpingControl) const &warpingControl,
+                                         CONST_PTR(LanczosStampWarper) const &stampWarper) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_warpedPsfs[i]) {
+                return _warpedPsfs[i];
+            }
+        }
+        auto warpedPsf = std::make_shared<WarpedPsf const>(record.getPsf(), getTransform(i, record, coaddWcs),
+                                                           warpingControl, 0.0, 0, stampWarper);
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_warpedPsfs[i]) {
+            _warpedPsfs[i] = std::move(warpedPsf);
+        }
+        return _warpedPsfs[i];
+    }
+
+    // Return a WarpingControl for exclusive use by one thread until it is released.
+    std::shared_ptr<afw::math::WarpingControl> acquireWarpingControl(std::string const &warpingKernelName,
+                                                                     int cacheSize) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_spareWarpingControls.empty()) {
+                auto warpingControl = std::move(_spareWarpingControls.back());
+                _spareWarpingControls.pop_back();
+                return warpingControl;
+            }
+        }
+        return std::make_shared<afw::math::WarpingControl>(warpingKernelName, "", cacheSize);
+    }
+
+    void releaseWarpingControl(std::shared_ptr<afw::math::WarpingControl> warpingControl) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _spareWarpingControls.push_back(std::move(warpingControl));
+    }
+
+    // A WarpingControl acquired from a WarpedPsfCache, returned to it when the lease is destroyed.
+    class WarpingControlLease {
+    public:
+        WarpingControlLease(WarpedPsfCache &cache, std::string const &warpingKernelName, int cacheSize)
+                : _cache(cache), _warpingControl(cache.acquireWarpingControl(warpingKernelName, cacheSize)) {}
+
+        WarpingControlLease(WarpingControlLease const &) = delete;
+        WarpingControlLease &operator=(WarpingControlLease const &) = delete;
+
+        ~WarpingControlLease() { _cache.releaseWarpingControl(std::move(_warpingControl)); }
+
+        std::shared_ptr<afw::math::WarpingControl> const &get() const { return _warpingControl; }
+
+    private:
+        WarpedPsfCache &_cache;
+        std::shared_ptr<afw::math::WarpingControl> _warpingControl;
+    };
+
+private:
+    std::mutex _mutex;
+    std::vector<std::shared_ptr<afw::math::WarpingControl>> _spareWarpingControls;
+    std::vector<std::shared_ptr<afw::geom::TransformPoint2ToPoint2 const>> _transforms;
+    std::vector<std::shared_ptr<WarpedPsf const>> _warpedPsfs;
+};
+
+// Threads that help the callers of run() with their work.  They are started with the pool and wait for
+// work until it is destroyed, so evaluating a CoaddPsf doesn't pay to start and join threads.
+class CoaddPsf::WorkerPool {
+public:
+    explicit WorkerPool(int nThreads) : _stopping(false) {
+        _threads.reserve(nThreads);
+        for (int n = 0; n < nThreads; ++n) {
+            _threads.emplace_back([this]() { _serve(); });
+        }
+    }
+
+    WorkerPool(WorkerPool const &) = delete;
+    WorkerPool &operator=(WorkerPool const &) = delete;
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _wake.notify_all();
+        for (auto &thread : _threads) {
+            thread.join();
+        }
+    }
+
+    // Call work on this thread and on up to nHelpers of the pool's threads, returning once all the calls
+    // have returned, and rethrowing the first exception any of them threw.  work must share out the
+    // work itself (e.g. from an atomic counter), as helpers that are still busy with other callers' work
+    // when this thread's call returns are not waited for.
+    void run(std::size_t nHelpers, std::function<void()> const &work) {
+        Job job{&work, 0, nullptr};
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            job.pending = std::min(nHelpers, _threads.size());
+            _queue.insert(_queue.end(), job.pending, &job);
+        }
+        _wake.notify_all();
+        std::exception_ptr error;
+        try {
+            work();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        std::unique_lock<std::mutex> lock(_mutex);
+        std::size_t const queued = _queue.size();
+        _queue.erase(std::remove(_queue.begin(), _queue.end(), &job), _queue.end());
+        job.pending -= queued - _queue.size();
+        _done.wait(lock, [&job]() { return job.pending == 0; });
+        if (!error) {
+            error = job.error;
+        }
+        lock.unlock();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    struct Job {
+        std::function<void()> const *work;
+        std::size_t pending;      // number of helpers asked to call work that haven't yet returned
+        std::exception_ptr error;  // first exception thrown by a helper
+    };
+
+    void _serve() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _wake.wait(lock, [this]() { return _stopping || !_queue.empty(); });
+            if (_stopping) {
+                return;
+            }
+            Job *job = _queue.front();
+            _queue.pop_front();
+            lock.unlock();
+            std::exception_ptr error;
+            try {
+                (*job->work)();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            lock.lock();
+            if (error && !job->error) {
+                job->error = error;
+            }
+            --job->pending;
+            _done.notify_all();
+        }
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _wake;  // signalled when work is queued, or the pool is stopping
+    std::condition_variable _done;  // signalled when a helper returns
+    std::deque<Job *> _queue;
+    bool _stopping;
+    std::vector<std::thread> _threads;
+};
+
+// Holds the archive ID of each input's Psf for a CoaddPsf that was read lazily, and sets the Psf on the
+// input's record the first time it's needed.  Reading from an InputArchive is not thread-safe, so all
+// reads hold the lock; the per-input flags let callers skip it once an input is read.
+class CoaddPsf::LazyInputs {
+public:
+    LazyInputs(afw::table::io::InputArchive const &archive, afw::table::BaseCatalog const &inputs,
+               std::vector<int> psfIds)
+            : _archive(archive),
+              _inputs(inputs),
+              _psfIds(std::move(psfIds)),
+              _hasPsf(new std::atomic<bool>[_psfIds.size()]()),
+              _psfCount(0) {}
+
+    void load(std::size_t i, afw::table::ExposureRecord &record) {
+        if (_hasPsf[i].load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_hasPsf[i].load(std::memory_order_relaxed)) {
+            record.setPsf(_archive.get<afw::detection::Psf>(_psfIds[i]));
+            _hasPsf[i].store(true, std::memory_order_release);
+            ++_psfCount;
+        }
+    }
+
+    // Read the complete inputs catalog, with all the components of every input (as needed to write it).
+    afw::table::ExposureCatalog readCatalog() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return afw::table::ExposureCatalog::readFromArchive(_archive, _inputs);
+    }
+
+    std::size_t getPsfCount() const { return _psfCount; }
+
+private:
+    std::mutex _mutex;
+    afw::table::io::InputArchive _archive;
+    afw::table::BaseCatalog _inputs;
+    std::vector<int> const _psfIds;
+    std::unique_ptr<std::atomic<bool>[]> _hasPsf;
+    std::atomic<std::size_t> _psfCount;
+};
+
+afw::table::ExposureRecord const &CoaddPsf::_getRecord(std::size_t i, bool needPsf) const {
+    if (_lazyInputs && needPsf) {
+        _lazyInputs->load(i, _catalog[i]);
+    }
+    return _catalog[i];
+}
+
+std::shared_ptr<WarpedPsf const> CoaddPsf::_getWarpedPsf(std::size_t i) const {
+    return _warpedPsfCache->get(i, _getRecord(i), _coaddWcs, _warpingControl, _stampWarper);
+}
+
+void CoaddPsf::_warpInParallel(std::vector<std::size_t> const &subcat, geom::Point2D const &ccdXY,
+                               afw::image::Color const &color,
+                               std::vector<PTR(afw::image::Image<double>)> &imgVector) const {
+    std::size_t const nWorkers = std::min(static_cast<std::size_t>(_nThreads), subcat.size());
+    std::vector<std::exception_ptr> errors(subcat.size());
+    std::atomic<std::size_t> next(0);
+    auto work = [&]() {
+        // The warping kernel in a WarpingControl is modified while warping, so each worker needs its
+        // own; the WarpedPsfs (and their expensive exposure-to-coadd transforms) are still shared.
+        WarpedPsfCache::WarpingControlLease warpingControl(*_warpedPsfCache, _warpingKernelName,
+                                                           _warpingControl->getCacheSize());
+        for (std::size_t k = next++; k < subcat.size(); k = next++) {
+            try {
+                imgVector[k] = _getWarpedPsf(subcat[k])->warpKernelImage(ccdXY, color, *warpingControl.get());
+            } catch (pex::exceptions::RangeError &exc) {
+                LSST_EXCEPT_ADD(exc, (boost::format("Computing WarpedPsf kernel image for id=%d") %
+                                      _catalog[subcat[k]].getId())
+                                             .str());
+                errors[k] = std::make_exception_ptr(exc);
+            } catch (...) {
+                errors[k] = std::current_exception();
+            }
+        }
+    };
+    _workerPool->run(nWorkers - 1, work);  // the calling thread is one of the workers
+    // Report the first failure in input order, independent of scheduling.
+    for (auto const &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+std::vector<std::size_t> CoaddPsf::_getOverlappingInputs(geom::Point2D const &ccdXY) const {
+    if (_inputIndex->getCandidates(ccdXY).empty()) {
+        return std::vector<std::size_t>();
+    }
+    // Only one coadd pixel -> sky transform is needed; each candidate then only does sky -> pixel.
+    return _getOverlappingInputs(ccdXY, _coaddWcs.pixelToSky(ccdXY));
+}
+
+std::vector<std::size_t> CoaddPsf::_getOverlappingInputs(geom::Point2D const &ccdXY,
+                                                         geom::SpherePoint const &coord) const {
+    std::vector<std::size_t> result;
+    for (std::size_t i : _inputIndex->getCandidates(ccdXY)) {
+        if (_getRecord(i, false).contains(coord, true)) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
 geom::Box2I CoaddPsf::doComputeBBox(geom::Point2D const &ccdXY, afw::image::Color const &color) const {
-    afw::table::ExposureCatalog subcat = _catalog.subsetContaining(ccdXY, _coaddWcs, true);
+    std::vector<std::size_t> subcat = _getOverlappingInputs(ccdXY);
     if (subcat.empty()) {
         throw LSST_EXCEPT(
                 pex::exceptions::InvalidParameterError,
@@ -221,12 +597,19 @@ geom::Box2I CoaddPsf::doComputeBBox(geom::Point2D const &ccdXY, afw::image::Colo
                         .str());
     }
 
+    geom::Point2D position = ccdXY;
+    if (_imageCache) {
+        // Must agree with the bbox of the (possibly cached) image doComputeKernelImage returns.
+        PsfImageCache::Key key = _imageCache->makeKey(ccdXY, color, subcat);
+        if (PTR(Image) cached = _imageCache->find(key)) {
+            return cached->getBBox();
+        }
+        position = _imageCache->getPosition(key);
+    }
+
     geom::Box2I ret;
-    for (auto const &exposureRecord : subcat) {
-        // compute transform from exposure pixels to coadd pixels
-        auto exposureToCoadd = afw::geom::makeWcsPairTransform(*exposureRecord.getWcs(), _coaddWcs);
-        WarpedPsf warpedPsf = WarpedPsf(exposureRecord.getPsf(), exposureToCoadd, _warpingControl);
-        geom::Box2I componentBBox = warpedPsf.computeBBox(ccdXY, color);
+    for (std::size_t i : subcat) {
+        geom::Box2I componentBBox = _getWarpedPsf(i)->computeBBox(position, color);
         ret.include(componentBBox);
     }
 
@@ -235,71 +618,173 @@ geom::Box2I CoaddPsf::doComputeBBox(geom::Point2D const &ccdXY, afw::image::Colo
 
 PTR(afw::detection::Psf::Image)
 CoaddPsf::doComputeKernelImage(geom::Point2D const &ccdXY, afw::image::Color const &color) const {
+    LSST_MEAS_ALGORITHMS_TIME("CoaddPsf.doComputeKernelImage");
     // Get the subset of expoures which contain our coordinate within their validPolygons.
-    afw::table::ExposureCatalog subcat = _catalog.subsetContaining(ccdXY, _coaddWcs, true);
+    std::vector<std::size_t> subcat = _getOverlappingInputs(ccdXY);
     if (subcat.empty()) {
         throw LSST_EXCEPT(
                 pex::exceptions::InvalidParameterError,
                 (boost::format("Cannot compute CoaddPsf at point %s; no input images at that point.") % ccdXY)
                         .str());
     }
+    if (!_imageCache) {
+        return _computeKernelImage(subcat, ccdXY, color);
+    }
+    PsfImageCache::Key key = _imageCache->makeKey(ccdXY, color, subcat);
+    PTR(Image) image = _imageCache->get(key);
+    LSST_MEAS_ALGORITHMS_COUNT(image ? "CoaddPsf.imageCacheHits" : "CoaddPsf.imageCacheMisses", 1);
+    if (!image) {
+        image = _computeKernelImage(subcat, _imageCache->getPosition(key), color);
+        _imageCache->insert(key, image);
+    }
+    return image;
+}
+
+PTR(afw::detection::Psf::Image) CoaddPsf::_computeKernelImage(std::vector<std::size_t> const &subcat,
+                                                             geom::Point2D const &ccdXY,
+                                                             afw::image::Color const &color) const {
+    LSST_MEAS_ALGORITHMS_COUNT("CoaddPsf.inputsWarped", subcat.size());
     double weightSum = 0.0;
 
     // Read all the Psf images into a vector.  The code is set up so that this can be done in chunks,
     // with the image modified to accomodate
     // However, we currently read all of the images.
-    std::vector<PTR(afw::image::Image<double>)> imgVector;
+    std::vector<PTR(afw::image::Image<double>)> imgVector(subcat.size());
     std::vector<double> weightVector;
 
-    for (auto const &exposureRecord : subcat) {
-        // compute transform from exposure pixels to coadd pixels
-        auto exposureToCoadd = afw::geom::makeWcsPairTransform(*exposureRecord.getWcs(), _coaddWcs);
-        PTR(afw::image::Image<double>) componentImg;
-        try {
-            WarpedPsf warpedPsf = WarpedPsf(exposureRecord.getPsf(), exposureToCoadd, _warpingControl);
-            componentImg = warpedPsf.computeKernelImage(ccdXY, color);
-        } catch (pex::exceptions::RangeError &exc) {
-            LSST_EXCEPT_ADD(exc, (boost::format("Computing WarpedPsf kernel image for id=%d") %
-                                  exposureRecord.getId())
-                                         .str());
-            throw exc;
+    if (_nThreads > 1 && subcat.size() > 1) {
+        _warpInParallel(subcat, ccdXY, color, imgVector);
+    } else {
+        // As in _warpInParallel, the warp uses a WarpingControl of its own, as other threads may be
+        // evaluating this CoaddPsf at the same time.
+        WarpedPsfCache::WarpingControlLease warpingControl(*_warpedPsfCache, _warpingKernelName,
+                                                           _warpingControl->getCacheSize());
+        for (std::size_t k = 0; k < subcat.size(); ++k) {
+            try {
+                imgVector[k] = _getWarpedPsf(subcat[k])->warpKernelImage(ccdXY, color, *warpingControl.get());
+            } catch (pex::exceptions::RangeError &exc) {
+                LSST_EXCEPT_ADD(exc, (boost::format("Computing WarpedPsf kernel image for id=%d") %
+                                      _catalog[subcat[k]].getId())
+                                             .str());
+                throw exc;
+            }
         }
-        imgVector.push_back(componentImg);
-        weightSum += exposureRecord.get(_weightKey);
-        weightVector.push_back(exposureRecord.get(_weightKey));
     }
 
-    geom::Box2I bbox = getOverallBBox(imgVector);
+    // The reduction is always done serially in input order, so results don't depend on _nThreads.
+    for (std::size_t i : subcat) {
+        weightSum += _catalog[i].get(_weightKey);
+        weightVector.push_back(_catalog[i].get(_weightKey));
+    }
 
-    // create a zero image of the right size to sum into
-    PTR(afw::detection::Psf::Image) image = std::make_shared<afw::detection::Psf::Image>(bbox);
-    *image = 0.0;
-    addToImage(image, imgVector, weightVector);
-    *image /= weightSum;
-    return image;
+    return combineImages(imgVector, weightVector, weightSum);
+}
+
+std::vector<PTR(afw::detection::Psf::Image)> CoaddPsf::doComputeKernelImages(
+        std::vector<geom::Point2D> const &positions, afw::image::Color const &color) const {
+    if (_imageCache) {
+        // Go through computeKernelImage so batch and single-position results share the cache
+        // (and so callers get copies they are free to modify).
+        return ImagePsf::doComputeKernelImages(positions, color);
+    }
+    LSST_MEAS_ALGORITHMS_TIME("CoaddPsf.doComputeKernelImages");
+    std::vector<PTR(Image)> result;
+    result.reserve(positions.size());
+    // Positions are processed in chunks, to bound the number of component images held at once.
+    for (std::size_t chunkBegin = 0; chunkBegin < positions.size(); chunkBegin += BATCH_CHUNK_SIZE) {
+        std::size_t const chunkEnd = std::min(positions.size(), chunkBegin + BATCH_CHUNK_SIZE);
+        std::vector<geom::Point2D> chunk(positions.begin() + chunkBegin, positions.begin() + chunkEnd);
+        std::vector<geom::SpherePoint> coords = _coaddWcs.pixelToSky(chunk);
+
+        // Invert the mapping from positions to inputs, so each input's WarpedPsf is evaluated
+        // for all of its positions in one batch.
+        std::map<std::size_t, std::vector<std::size_t>> positionsByInput;
+        for (std::size_t j = 0; j < chunk.size(); ++j) {
+            std::vector<std::size_t> subcat = _getOverlappingInputs(chunk[j], coords[j]);
+            if (subcat.empty()) {
+                throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                                  (boost::format("Cannot compute CoaddPsf at point %s; no input images at "
+                                                 "that point.") %
+                                   chunk[j])
+                                          .str());
+            }
+            for (std::size_t i : subcat) {
+                positionsByInput[i].push_back(j);
+            }
+        }
+
+        // Inputs are visited in catalog order, so each position accumulates its components in the
+        // same order as doComputeKernelImage and the results are identical.
+        std::vector<std::vector<PTR(afw::image::Image<double>)>> imgVectors(chunk.size());
+        std::vector<std::vector<double>> weightVectors(chunk.size());
+        std::vector<double> weightSums(chunk.size(), 0.0);
+        WarpedPsfCache::WarpingControlLease warpingControl(*_warpedPsfCache, _warpingKernelName,
+                                                           _warpingControl->getCacheSize());
+        for (auto const &item : positionsByInput) {
+            afw::table::ExposureRecord const &exposureRecord = _catalog[item.first];
+            std::vector<geom::Point2D> inputPositions;
+            inputPositions.reserve(item.second.size());
+            for (std::size_t j : item.second) {
+                inputPositions.push_back(chunk[j]);
+            }
+            LSST_MEAS_ALGORITHMS_COUNT("CoaddPsf.inputsWarped", inputPositions.size());
+            std::vector<PTR(Image)> componentImgs;
+            try {
+                componentImgs = _getWarpedPsf(item.first)
+                                        ->warpKernelImages(inputPositions, color, *warpingControl.get());
+            } catch (pex::exceptions::RangeError &exc) {
+                LSST_EXCEPT_ADD(exc, (boost::format("Computing WarpedPsf kernel image for id=%d") %
+                                      exposureRecord.getId())
+                                             .str());
+                throw exc;
+            }
+            double const weight = exposureRecord.get(_weightKey);
+            for (std::size_t k = 0; k < item.second.size(); ++k) {
+                std::size_t const j = item.second[k];
+                imgVectors[j].push_back(componentImgs[k]);
+                weightSums[j] += weight;
+                weightVectors[j].push_back(weight);
+            }
+        }
+
+        for (std::size_t j = 0; j < chunk.size(); ++j) {
+            result.push_back(combineImages(imgVectors[j], weightVectors[j], weightSums[j]));
+        }
+    }
+    return result;
 }
 
 int CoaddPsf::getComponentCount() const { return _catalog.size(); }
 
+int CoaddPsf::getLoadedComponentCount() const {
+    return _lazyInputs ? _lazyInputs->getPsfCount() : getComponentCount();
+}
+
+CoaddPsf::LazyReadingScope::LazyReadingScope(bool lazy) : _previous(lazyReading) { lazyReading = lazy; }
+
+CoaddPsf::LazyReadingScope::~LazyReadingScope() { lazyReading = _previous; }
+
+bool CoaddPsf::getLazyReading() { return lazyReading; }
+
 CONST_PTR(afw::detection::Psf) CoaddPsf::getPsf(int index) {
     if (index < 0 || index >= getComponentCount()) {
         throw LSST_EXCEPT(pex::exceptions::RangeError, "index of CoaddPsf component out of range");
     }
-    return _catalog[index].getPsf();
+    return _getRecord(index).getPsf();
 }
 
 afw::geom::SkyWcs CoaddPsf::getWcs(int index) {
     if (index < 0 || index >= getComponentCount()) {
         throw LSST_EXCEPT(pex::exceptions::RangeError, "index of CoaddPsf component out of range");
     }
-    return *_catalog[index].getWcs();
+    return *_getRecord(index, false).getWcs();
 }
 
 CONST_PTR(afw::geom::polygon::Polygon) CoaddPsf::getValidPolygon(int index) {
     if (index < 0 || index >= getComponentCount()) {
         throw LSST_EXCEPT(pex::exceptions::RangeError, "index of CoaddPsf component out of range");
     }
-    return _catalog[index].getValidPolygon();
+    return _getRecord(index, false).getValidPolygon();
 }
 
 double CoaddPsf::getWeight(int index) {
@@ -327,7 +812,8 @@ geom::Box2I CoaddPsf::getBBox(int index) {
 
 // For persistence of CoaddPsf, we have two catalogs: the first has just one record, and contains
 // the archive ID of the coadd WCS, the size of the warping cache, the name of the warping kernel,
-// and the average position.  The latter is simply the ExposureCatalog.
+// and the average position.  The latter is simply the ExposureCatalog.  The rest of CoaddPsfControl
+// (nThreads, the image cache and useStampWarper) is not saved; see its documentation and withControl.
 
 namespace {
 
@@ -372,11 +858,56 @@ public:
         CoaddPsfPersistenceHelper const &keys1 = CoaddPsfPersistenceHelper::get();
         LSST_ARCHIVE_ASSERT(catalogs.front().getSchema() == keys1.schema);
         afw::table::BaseRecord const &record1 = catalogs.front().front();
-        return PTR(CoaddPsf)(
-                new CoaddPsf(afw::table::ExposureCatalog::readFromArchive(archive, catalogs.back()),
-                             *archive.get<afw::geom::SkyWcs>(record1.get(keys1.coaddWcs)),
-                             record1.get(keys1.averagePosition), record1.get(keys1.warpingKernelName),
-                             record1.get(keys1.cacheSize)));
+        afw::geom::SkyWcs const coaddWcs = *archive.get<afw::geom::SkyWcs>(record1.get(keys1.coaddWcs));
+        CoaddPsfControl const ctrl(record1.get(keys1.warpingKernelName), record1.get(keys1.cacheSize));
+        if (getLazyReading()) {
+            if (PTR(CoaddPsf) result = readLazily(archive, catalogs[1], coaddWcs,
+                                                  record1.get(keys1.averagePosition), ctrl)) {
+                return result;
+            }
+        }
+        return PTR(CoaddPsf)(new CoaddPsf(afw::table::ExposureCatalog::readFromArchive(archive, catalogs[1]),
+                                          coaddWcs, record1.get(keys1.averagePosition), ctrl));
+    }
+
+    // Read a CoaddPsf whose inputs' Psfs are only read as they're needed, or return null if the
+    // persisted inputs catalog doesn't have the fields this needs.
+    std::shared_ptr<CoaddPsf> readLazily(InputArchive const &archive, afw::table::BaseCatalog const &inputs,
+                                         afw::geom::SkyWcs const &coaddWcs,
+                                         geom::Point2D const &averagePosition,
+                                         CoaddPsfControl const &ctrl) const {
+        // The archive IDs of the inputs' components are fields of the persisted ExposureCatalog.
+        afw::table::Schema const &inputSchema = inputs.getSchema();
+        afw::table::Key<int> psfKey;
+        afw::table::Key<int> wcsKey;
+        afw::table::Key<int> validPolygonKey;
+        try {
+            psfKey = inputSchema["psf"];
+            wcsKey = inputSchema["wcs"];
+            validPolygonKey = inputSchema["validPolygon"];
+        } catch (pex::exceptions::NotFoundError &) {
+            return nullptr;
+        }
+        // Copy only the plain fields CoaddPsf uses (id, bbox and weight) from the persisted inputs.
+        // The Wcss and validPolygons are needed to build the spatial index, so they're read now;
+        // the Psfs are left to be read as they're needed.
+        afw::table::SchemaMapper mapper(inputSchema);
+        mapper.addMinimalSchema(afw::table::ExposureTable::makeMinimalSchema(), true);
+        afw::table::Key<double> weightKey = inputSchema["weight"];
+        mapper.addMapping(weightKey, true);
+        afw::table::ExposureCatalog catalog(mapper.getOutputSchema());
+        catalog.reserve(inputs.size());
+        std::vector<int> psfIds;
+        psfIds.reserve(inputs.size());
+        for (auto const &input : inputs) {
+            PTR(afw::table::ExposureRecord) record = catalog.addNew();
+            record->assign(input, mapper);
+            record->setWcs(archive.get<afw::geom::SkyWcs>(input.get(wcsKey)));
+            record->setValidPolygon(archive.get<afw::geom::polygon::Polygon>(input.get(validPolygonKey)));
+            psfIds.push_back(input.get(psfKey));
+        }
+        auto lazyInputs = std::make_shared<LazyInputs>(archive, inputs, std::move(psfIds));
+        return PTR(CoaddPsf)(new CoaddPsf(catalog, coaddWcs, averagePosition, ctrl, std::move(lazyInputs)));
     }
 
     // Backwards compatibility for files saved before meas_algorithms commit
@@ -427,17 +958,33 @@ void CoaddPsf::write(OutputArchiveHandle &handle) const {
     record1->set(keys1.averagePosition, _averagePosition);
     record1->set(keys1.warpingKernelName, _warpingKernelName);
     handle.saveCatalog(cat1);
-    _catalog.writeToArchive(handle, false);
+    // A lazily-read CoaddPsf's catalog is missing the components it hasn't needed (and all the other
+    // fields), so write the complete catalog from the archive it was read from instead.
+    afw::table::ExposureCatalog const inputs = _lazyInputs ? _lazyInputs->readCatalog() : _catalog;
+    inputs.writeToArchive(handle, false);
 }
 
 CoaddPsf::CoaddPsf(afw::table::ExposureCatalog const &catalog, afw::geom::SkyWcs const &coaddWcs,
-                   geom::Point2D const &averagePosition, std::string const &warpingKernelName, int cacheSize)
+                   geom::Point2D const &averagePosition, CoaddPsfControl const &ctrl)
         : _catalog(catalog),
           _coaddWcs(coaddWcs),
           _weightKey(_catalog.getSchema()["weight"]),
           _averagePosition(averagePosition),
-          _warpingKernelName(warpingKernelName),
-          _warpingControl(new afw::math::WarpingControl(warpingKernelName, "", cacheSize)) {}
+          _inputIndex(std::make_shared<CoaddInputIndex>(_catalog, _coaddWcs)) {
+    _setControl(ctrl);
+}
+
+CoaddPsf::CoaddPsf(afw::table::ExposureCatalog const &catalog, afw::geom::SkyWcs const &coaddWcs,
+                   geom::Point2D const &averagePosition, CoaddPsfControl const &ctrl,
+                   std::shared_ptr<LazyInputs> lazyInputs)
+        : _catalog(catalog),
+          _coaddWcs(coaddWcs),
+          _weightKey(_catalog.getSchema()["weight"]),
+          _averagePosition(averagePosition),
+          _inputIndex(std::make_shared<CoaddInputIndex>(_catalog, _coaddWcs)),
+          _lazyInputs(std::move(lazyInputs)) {
+    _setControl(ctrl);
+}
 
 }  // namespace algorithms
 }  // namespace meas
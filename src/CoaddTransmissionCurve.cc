@@ -21,6 +21,7 @@
  */
 
 #include "lsst/meas/algorithms/CoaddTransmissionCurve.h"
+#include "lsst/meas/algorithms/CoaddInputIndex.h"
 #include "lsst/geom/Box.h"
 #include "lsst/afw/geom/SkyWcs.h"
 #include "lsst/afw/geom/polygon/Polygon.h"
@@ -42,6 +43,43 @@ struct CoaddInputData {
     double weight;
 };
 
+std::shared_ptr<CoaddInputIndex const> makeIndex(afw::geom::SkyWcs const& coaddWcs,
+                                                 std::vector<CoaddInputData> const& inputs) {
+    std::vector<geom::Box2D> boxes;
+    boxes.reserve(inputs.size());
+    for (auto const& input : inputs) {
+        boxes.push_back(CoaddInputIndex::computeCoaddBBox(input.bbox, *input.sensorWcs, coaddWcs));
+    }
+    return std::make_shared<CoaddInputIndex const>(boxes);
+}
+
+// A scratch array whose memory is kept per thread and reused between calls; nested users (e.g. a
+// coadd of coadds) find the per-thread slot empty and allocate their own.
+class ScratchArray {
+public:
+    explicit ScratchArray(std::size_t size) : _array(_getSlot()) {
+        _getSlot() = ndarray::Array<double, 1, 1>();
+        if (_array.getSize<0>() != static_cast<int>(size)) {
+            _array = ndarray::allocate(size);
+        }
+    }
+
+    ScratchArray(ScratchArray const&) = delete;
+    ScratchArray& operator=(ScratchArray const&) = delete;
+
+    ~ScratchArray() { _getSlot() = _array; }
+
+    ndarray::Array<double, 1, 1> const& get() const { return _array; }
+
+private:
+    static ndarray::Array<double, 1, 1>& _getSlot() {
+        thread_local ndarray::Array<double, 1, 1> slot;
+        return slot;
+    }
+
+    ndarray::Array<double, 1, 1> _array;
+};
+
 class CoaddTransmissionCurve : public afw::image::TransmissionCurve {
 public:
     CoaddTransmissionCurve(std::shared_ptr<afw::geom::SkyWcs const> coaddWcs,
@@ -81,6 +119,7 @@ public:
         }
         _throughputAtBounds.first /= weightSum;
         _throughputAtBounds.second /= weightSum;
+        _index = makeIndex(*_coaddWcs, _inputs);
     }
 
     // Private constructor used only for persistence
@@ -90,7 +129,8 @@ public:
             : _coaddWcs(std::move(coaddWcs)),
               _wavelengthBounds(std::move(wavelengthBounds)),
               _throughputAtBounds(std::move(throughputAtBounds)),
-              _inputs(std::move(inputs)) {}
+              _inputs(std::move(inputs)),
+              _index(makeIndex(*_coaddWcs, _inputs)) {}
 
     // All TransmissionCurves are immutable and noncopyable.
     CoaddTransmissionCurve(CoaddTransmissionCurve const&) = delete;
@@ -105,11 +145,13 @@ public:
     void sampleAt(geom::Point2D const& position, ndarray::Array<double const, 1, 1> const& wavelengths,
                   ndarray::Array<double, 1, 1> const& out) const override {
         auto const coord = _coaddWcs->pixelToSky(position);
-        ndarray::Array<double, 1, 1> tmp = ndarray::allocate(out.getShape());
-        tmp.deep() = 0.0;
+        ScratchArray const scratch(out.getSize<0>());
+        ndarray::Array<double, 1, 1> const& tmp = scratch.get();
         out.deep() = 0.0;
         double weightSum = 0.0;
-        for (auto const& input : _inputs) {
+        // The index only prunes inputs that cannot contain the point; the exact test is unchanged.
+        for (std::size_t i : _index->getCandidates(position)) {
+            CoaddInputData const& input = _inputs[i];
             geom::Point2D const inputPosition = input.sensorWcs->skyToPixel(coord);
             if (!input.bbox.contains(inputPosition)) {
                 continue;
@@ -132,6 +174,66 @@ public:
         out.deep() /= weightSum;
     }
 
+    // Sample at many positions; row k of out is set to the result of sampleAt(positions[k], ...).
+    void sampleAt(std::vector<geom::Point2D> const& positions,
+                  ndarray::Array<double const, 1, 1> const& wavelengths,
+                  ndarray::Array<double, 2, 2> const& out) const {
+        std::size_t const nPoints = positions.size();
+        out.deep() = 0.0;
+        if (nPoints == 0) {
+            return;
+        }
+        geom::Box2D region;
+        for (auto const& position : positions) {
+            region.include(position);
+        }
+        std::vector<geom::SpherePoint> const coords = _coaddWcs->pixelToSky(positions);
+        ScratchArray const scratch(wavelengths.getSize<0>());
+        ndarray::Array<double, 1, 1> const& tmp = scratch.get();
+        std::vector<double> weightSum(nPoints, 0.0);
+        std::vector<std::size_t> selected;
+        std::vector<geom::SpherePoint> selectedCoords;
+        // Inputs are visited in order, so each point accumulates in the same order as in sampleAt.
+        for (std::size_t i : _index->getOverlapping(region)) {
+            CoaddInputData const& input = _inputs[i];
+            geom::Box2D const& coaddBBox = _index->getInputBBox(i);
+            selected.clear();
+            selectedCoords.clear();
+            for (std::size_t k = 0; k < nPoints; ++k) {
+                if (coaddBBox.isEmpty() || coaddBBox.contains(positions[k])) {
+                    selected.push_back(k);
+                    selectedCoords.push_back(coords[k]);
+                }
+            }
+            if (selected.empty()) {
+                continue;
+            }
+            std::vector<geom::Point2D> const inputPositions = input.sensorWcs->skyToPixel(selectedCoords);
+            for (std::size_t j = 0; j < selected.size(); ++j) {
+                geom::Point2D const& inputPosition = inputPositions[j];
+                if (!input.bbox.contains(inputPosition)) {
+                    continue;
+                }
+                if (input.validPolygon && !input.validPolygon->contains(inputPosition)) {
+                    continue;
+                }
+                input.transmission->sampleAt(inputPosition, wavelengths, tmp);
+                tmp.deep() *= input.weight;
+                out[selected[j]] += tmp;
+                weightSum[selected[j]] += input.weight;
+            }
+        }
+        for (std::size_t k = 0; k < nPoints; ++k) {
+            if (weightSum[k] == 0.0) {
+                throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                                  (boost::format("No input TransmissionCurves at point (%s, %s)") %
+                                   positions[k].getX() % positions[k].getY())
+                                          .str());
+            }
+            out[k] /= weightSum[k];
+        }
+    }
+
     bool isPersistable() const noexcept override {
         for (auto const& input : _inputs) {
             if (!input.transmission->isPersistable()) {
@@ -158,6 +260,7 @@ private:
     std::pair<double, double> _wavelengthBounds;
     std::pair<double, double> _throughputAtBounds;
     std::vector<CoaddInputData> _inputs;
+    std::shared_ptr<CoaddInputIndex const> _index;
 };
 
 struct CoaddTransmissionCurve::PersistenceHelper {
@@ -259,6 +362,20 @@ std::shared_ptr<afw::image::TransmissionCurve const> makeCoaddTransmissionCurve(
     return std::make_shared<CoaddTransmissionCurve>(coaddWcs, inputSensors);
 }
 
+ndarray::Array<double, 2, 2> sampleTransmissionCurveAt(
+        afw::image::TransmissionCurve const& curve, std::vector<geom::Point2D> const& positions,
+        ndarray::Array<double const, 1, 1> const& wavelengths) {
+    ndarray::Array<double, 2, 2> out = ndarray::allocate(positions.size(), wavelengths.getSize<0>());
+    if (auto coaddCurve = dynamic_cast<CoaddTransmissionCurve const*>(&curve)) {
+        coaddCurve->sampleAt(positions, wavelengths, out);
+        return out;
+    }
+    for (std::size_t k = 0; k < positions.size(); ++k) {
+        curve.sampleAt(positions[k], wavelengths, out[k].shallow());
+    }
+    return out;
+}
+
 }  // namespace algorithms
 }  // namespace meas
 }  // namespace lsst
@@ -0,0 +1,259 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <thread>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/algorithms/DetectionSmoother.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+namespace {
+
+// Minimum number of rows given to a thread; fewer aren't worth starting one for
+int const MIN_ROWS_PER_THREAD = 32;
+
+// Number of output rows smoothed at a time; bounds the size of the intermediate buffers
+int const ROWS_PER_CHUNK = 64;
+
+/*
+ * Call processRows(y0, y1) for consecutive blocks of rows covering [0, nrow), using up to nThreads
+ * threads (including the calling one).  Any exception is rethrown once all the threads have finished.
+ */
+template <typename ProcessRows>
+void forEachRowBlock(int const nrow, int const nThreads, ProcessRows const& processRows) {
+    int const nBlocks = std::max(1, std::min(nThreads, nrow / MIN_ROWS_PER_THREAD));
+    if (nBlocks == 1) {
+        processRows(0, nrow);
+        return;
+    }
+
+    std::vector<int> starts(nBlocks + 1);  // first row of each block
+    for (int k = 0; k <= nBlocks; ++k) {
+        starts[k] = static_cast<int>(static_cast<long>(nrow) * k / nBlocks);
+    }
+    std::vector<std::exception_ptr> errors(nBlocks);
+    auto work = [&](int k) {
+        try {
+            processRows(starts[k], starts[k + 1]);
+        } catch (...) {
+            errors[k] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(nBlocks - 1);
+    for (int k = 1; k < nBlocks; ++k) {
+        workers.emplace_back(work, k);
+    }
+    work(0);  // the calling thread processes the first block
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto const& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+}  // namespace
+
+template <typename PixelT>
+DetectionSmoother<PixelT>::DetectionSmoother(double sigma, int width, int nThreads)
+        : _sigma(sigma), _width(width), _nThreads(std::max(1, nThreads)), _kernel(std::max(0, width)) {
+    if (!(sigma > 0.0)) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("sigma must be positive; got %g") % sigma).str());
+    }
+    if (width <= 0 || width % 2 == 0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("width must be a positive odd number; got %d") % width).str());
+    }
+    int const half = width / 2;
+    double sum = 0.0;
+    for (int i = 0; i < width; ++i) {
+        double const x = i - half;
+        _kernel[i] = std::exp(-0.5 * x * x / (sigma * sigma));
+        sum += _kernel[i];
+    }
+    for (auto& value : _kernel) {
+        value /= sum;
+    }
+}
+
+template <typename PixelT>
+geom::Box2I DetectionSmoother<PixelT>::getGoodBBox(geom::Box2I const& bbox) const {
+    if (bbox.getWidth() < _width || bbox.getHeight() < _width) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Image bbox %s is smaller than the %dx%d kernel") % bbox % _width %
+                           _width)
+                                  .str());
+    }
+    int const half = _width / 2;
+    return geom::Box2I(bbox.getMin() + geom::Extent2I(half, half),
+                       bbox.getDimensions() - geom::Extent2I(_width - 1, _width - 1));
+}
+
+template <typename PixelT>
+void DetectionSmoother<PixelT>::smooth(MaskedImageT const& src, MaskedImageT& dest,
+                                       bool doSmoothVariance) const {
+    typedef afw::image::MaskPixel MaskPixel;
+    typedef afw::image::VariancePixel VariancePixel;
+
+    if (src.getDimensions() != dest.getDimensions()) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Output dimensions %s differ from input dimensions %s") %
+                           dest.getDimensions() % src.getDimensions())
+                                  .str());
+    }
+    geom::Box2I const goodBBox = getGoodBBox(src.getBBox());  // checks that src is big enough
+    dest.setXY0(src.getXY0());
+
+    int const width = src.getWidth();
+    int const height = src.getHeight();
+    int const half = _width / 2;
+    int const goodWidth = goodBBox.getWidth();
+    int const goodHeight = goodBBox.getHeight();
+
+    auto const inImage = src.getImage()->getArray();
+    auto const inMask = src.getMask()->getArray();
+    auto const inVariance = src.getVariance()->getArray();
+    auto const outImage = dest.getImage()->getArray();
+    auto const outMask = dest.getMask()->getArray();
+    auto const outVariance = dest.getVariance()->getArray();
+
+    // Edges, as afw::math::convolve sets them
+    PixelT const edgeImage =
+            std::numeric_limits<PixelT>::has_quiet_NaN ? std::numeric_limits<PixelT>::quiet_NaN() : 0;
+    MaskPixel const edgeMask = MaskedImageT::Mask::getPlaneBitMask("NO_DATA");
+    VariancePixel const edgeVariance = std::numeric_limits<VariancePixel>::infinity();
+    auto setEdge = [&](int y, int x0, int x1) {
+        std::fill(outImage[y].begin() + x0, outImage[y].begin() + x1, edgeImage);
+        std::fill(outMask[y].begin() + x0, outMask[y].begin() + x1, edgeMask);
+        std::fill(outVariance[y].begin() + x0, outVariance[y].begin() + x1, edgeVariance);
+    };
+    for (int y = 0; y < height; ++y) {
+        if (y < half || y >= height - half) {
+            setEdge(y, 0, width);
+        } else {
+            setEdge(y, 0, half);
+            setEdge(y, width - half, width);
+        }
+    }
+    if (!doSmoothVariance) {
+        outVariance.deep() = std::numeric_limits<VariancePixel>::quiet_NaN();
+    }
+
+    std::vector<double> const& kernel = _kernel;
+    std::vector<double> kernel2(_width);  // weights for the variance
+    for (int i = 0; i < _width; ++i) {
+        kernel2[i] = kernel[i] * kernel[i];
+    }
+
+    forEachRowBlock(goodHeight, _nThreads, [&](int y0, int y1) {
+        // Rows smoothed in x only, for the output rows of one chunk and the half-kernels around them
+        std::size_t const bufferSize = static_cast<std::size_t>(ROWS_PER_CHUNK + _width - 1) * goodWidth;
+        std::vector<double> image(bufferSize);
+        std::vector<double> variance(doSmoothVariance ? bufferSize : 0);
+        std::vector<MaskPixel> mask(bufferSize);
+        std::vector<double> imageSum(goodWidth), varianceSum(doSmoothVariance ? goodWidth : 0);
+        std::vector<MaskPixel> maskSum(goodWidth);
+
+        for (int chunk = y0; chunk < y1; chunk += ROWS_PER_CHUNK) {
+            int const nOut = std::min(ROWS_PER_CHUNK, y1 - chunk);
+            // Output row chunk + j of goodBBox needs input rows chunk + j to chunk + j + _width - 1
+            for (int j = 0; j < nOut + _width - 1; ++j) {
+                int const y = chunk + j;
+                PixelT const* imageRow = inImage[y].getData();
+                MaskPixel const* maskRow = inMask[y].getData();
+                VariancePixel const* varianceRow = inVariance[y].getData();
+                double* imageOut = &image[static_cast<std::size_t>(j) * goodWidth];
+                MaskPixel* maskOut = &mask[static_cast<std::size_t>(j) * goodWidth];
+                for (int x = 0; x < goodWidth; ++x) {
+                    double sum = 0.0;
+                    MaskPixel bits = 0;
+                    for (int i = 0; i < _width; ++i) {
+                        sum += kernel[i] * imageRow[x + i];
+                        bits |= maskRow[x + i];
+                    }
+                    imageOut[x] = sum;
+                    maskOut[x] = bits;
+                }
+                if (doSmoothVariance) {
+                    double* varianceOut = &variance[static_cast<std::size_t>(j) * goodWidth];
+                    for (int x = 0; x < goodWidth; ++x) {
+                        double sum = 0.0;
+                        for (int i = 0; i < _width; ++i) {
+                            sum += kernel2[i] * varianceRow[x + i];
+                        }
+                        varianceOut[x] = sum;
+                    }
+                }
+            }
+            // Accumulate the rows under the kernel one at a time, so the inner loops are contiguous
+            for (int j = 0; j < nOut; ++j) {
+                int const y = chunk + j + half;
+                std::fill(imageSum.begin(), imageSum.end(), 0.0);
+                std::fill(maskSum.begin(), maskSum.end(), 0);
+                for (int i = 0; i < _width; ++i) {
+                    double const weight = kernel[i];
+                    double const* imageIn = &image[static_cast<std::size_t>(j + i) * goodWidth];
+                    MaskPixel const* maskIn = &mask[static_cast<std::size_t>(j + i) * goodWidth];
+                    for (int x = 0; x < goodWidth; ++x) {
+                        imageSum[x] += weight * imageIn[x];
+                        maskSum[x] |= maskIn[x];
+                    }
+                }
+                std::copy(imageSum.begin(), imageSum.end(), outImage[y].begin() + half);
+                std::copy(maskSum.begin(), maskSum.end(), outMask[y].begin() + half);
+                if (doSmoothVariance) {
+                    std::fill(varianceSum.begin(), varianceSum.end(), 0.0);
+                    for (int i = 0; i < _width; ++i) {
+                        double const weight = kernel2[i];
+                        double const* varianceIn = &variance[static_cast<std::size_t>(j + i) * goodWidth];
+                        for (int x = 0; x < goodWidth; ++x) {
+                            varianceSum[x] += weight * varianceIn[x];
+                        }
+                    }
+                    std::copy(varianceSum.begin(), varianceSum.end(), outVariance[y].begin() + half);
+                }
+            }
+        }
+    });
+}
+
+#define INSTANTIATE(T) template class DetectionSmoother<T>;
+
+INSTANTIATE(float)
+INSTANTIATE(double)
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
@@ -98,13 +98,14 @@ public:
     DoubleGaussianPsfFactory(std::string const& name) : afw::table::io::PersistableFactory(name) {}
 };
 
+// Helper function for ctor: the width to use for the second Gaussian.  A single Gaussian (b == 0) may
+// be given sigma2 == 0, which would give 0/0 at the centre of the Psf, so use 1 instead.
+double getSigma2(double sigma2, double b) { return (b == 0.0 && sigma2 == 0.0) ? 1.0 : sigma2; }
+
 // Helper function for ctor: need to construct the kernel to pass to KernelPsf, because we
 // can't change it after construction.
 PTR(afw::math::Kernel)
-makeDoubleGaussianKernel(int width, int height, double sigma1, double& sigma2, double b) {
-    if (b == 0.0 && sigma2 == 0.0) {
-        sigma2 = 1.0;  // avoid 0/0 at centre of Psf
-    }
+makeDoubleGaussianKernel(int width, int height, double sigma1, double sigma2, double b) {
     if (sigma1 <= 0 || sigma2 <= 0) {
         throw LSST_EXCEPT(pex::exceptions::DomainError,
                           (boost::format("sigma may not be 0: %g, %g") % sigma1 % sigma2).str());
@@ -121,10 +122,13 @@ DoubleGaussianPsfFactory registration(getDoubleGaussianPsfPersistenceName());
 }  // namespace
 
 DoubleGaussianPsf::DoubleGaussianPsf(int width, int height, double sigma1, double sigma2, double b)
-        : KernelPsf(makeDoubleGaussianKernel(width, height, sigma1, sigma2, b)),
+        : KernelPsf(makeDoubleGaussianKernel(width, height, sigma1, getSigma2(sigma2, b), b)),
           _sigma1(sigma1),
-          _sigma2(sigma2),
-          _b(b) {}
+          _sigma2(getSigma2(sigma2, b)),
+          _b(b),
+          // b is the ratio of peak amplitudes, so the fluxes are in the ratio b*sigma2^2/sigma1^2; the
+          // moments are only used where truncation by the kernel's bbox (width x height) is negligible
+          _moments({_sigma1, _sigma2}, {_sigma1 * _sigma1, _b * _sigma2 * _sigma2}, getKernel()->getBBox()) {}
 
 PTR(afw::detection::Psf) DoubleGaussianPsf::clone() const {
     return std::make_shared<DoubleGaussianPsf>(getKernel()->getWidth(), getKernel()->getHeight(), _sigma1,
@@ -135,6 +139,22 @@ PTR(afw::detection::Psf) DoubleGaussianPsf::resized(int width, int height) const
     return std::make_shared<DoubleGaussianPsf>(width, height, _sigma1, _sigma2, _b);
 }
 
+double DoubleGaussianPsf::doComputeApertureFlux(double radius, geom::Point2D const& position,
+                                                afw::image::Color const& color) const {
+    if (_moments.hasApertureFlux(radius)) {
+        return _moments.computeApertureFlux(radius);
+    }
+    return KernelPsf::doComputeApertureFlux(radius, position, color);
+}
+
+afw::geom::ellipses::Quadrupole DoubleGaussianPsf::doComputeShape(geom::Point2D const& position,
+                                                                  afw::image::Color const& color) const {
+    if (_moments.hasShape()) {
+        return _moments.computeShape();
+    }
+    return KernelPsf::doComputeShape(position, color);
+}
+
 std::string DoubleGaussianPsf::getPersistenceName() const { return getDoubleGaussianPsfPersistenceName(); }
 
 void DoubleGaussianPsf::write(OutputArchiveHandle& handle) const {
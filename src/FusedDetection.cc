@@ -0,0 +1,468 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/geom/SpanSet.h"
+#include "lsst/afw/detection/Footprint.h"
+#include "lsst/meas/algorithms/SpanComponents.h"
+#include "lsst/meas/algorithms/FusedDetection.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+namespace {
+
+typedef afw::detection::Footprint Footprint;
+typedef afw::detection::FootprintSet FootprintSet;
+typedef afw::detection::Threshold Threshold;
+typedef afw::geom::Span Span;
+
+void checkThreshold(Threshold const& threshold, bool polarity) {
+    if (threshold.getPolarity() != polarity) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          std::string("Expected a threshold with ") + (polarity ? "positive" : "negative") +
+                                  " polarity");
+    }
+    if (threshold.getType() != Threshold::VALUE && threshold.getType() != Threshold::PIXEL_STDEV) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          "Only VALUE and PIXEL_STDEV thresholds are supported");
+    }
+}
+
+// Tests one pixel against a Threshold, scaled by a multiplier
+class PixelTest {
+public:
+    PixelTest(Threshold const& threshold, double multiplier)
+            : _value(threshold.getValue() * multiplier),
+              _positive(threshold.getPolarity()),
+              _perPixel(threshold.getType() == Threshold::PIXEL_STDEV) {}
+
+    template <typename PixelT>
+    bool operator()(PixelT value, afw::image::VariancePixel variance) const {
+        double const threshold = _perPixel ? _value * std::sqrt(variance) : _value;
+        return _positive ? value >= threshold : value <= -threshold;
+    }
+
+private:
+    double _value;
+    bool _positive;
+    bool _perPixel;
+};
+
+// Does any pixel of spans pass test?
+template <typename PixelT>
+bool anyPixel(afw::image::MaskedImage<PixelT> const& image, afw::geom::SpanSet const& spans,
+              PixelTest const& test) {
+    auto const imageArray = image.getImage()->getArray();
+    auto const varianceArray = image.getVariance()->getArray();
+    for (auto const& span : spans) {
+        int const y = span.getY() - image.getY0();
+        PixelT const* imageRow = imageArray[y].getData();
+        afw::image::VariancePixel const* varianceRow = varianceArray[y].getData();
+        for (int x = span.getX0() - image.getX0(); x <= span.getX1() - image.getX0(); ++x) {
+            if (test(imageRow[x], varianceRow[x])) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+struct PeakPixel {
+    int x;
+    int y;
+    double value;
+};
+
+/*
+ * Is pixel (x, y) (in the image's LOCAL coordinates) a peak: does it have no brighter (if positive;
+ * fainter otherwise) neighbour?  Neighbours off the edge of the image are ignored.
+ */
+template <typename PixelT>
+bool isPeak(afw::image::Image<PixelT> const& image, int x, int y, bool positive) {
+    auto const array = image.getArray();
+    PixelT const value = array[y][x];
+    int const xMin = std::max(x - 1, 0);
+    int const xMax = std::min(x + 1, image.getWidth() - 1);
+    int const yMax = std::min(y + 1, image.getHeight() - 1);
+    for (int yy = std::max(y - 1, 0); yy <= yMax; ++yy) {
+        PixelT const* row = array[yy].getData();
+        for (int xx = xMin; xx <= xMax; ++xx) {
+            if (positive ? row[xx] > value : row[xx] < value) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Add peaks to a Footprint, most significant first
+void addPeaks(std::vector<PeakPixel>& peaks, bool positive, Footprint& footprint) {
+    std::stable_sort(peaks.begin(), peaks.end(), [positive](PeakPixel const& a, PeakPixel const& b) {
+        return positive ? a.value > b.value : a.value < b.value;
+    });
+    for (auto const& peak : peaks) {
+        footprint.addPeak(peak.x, peak.y, peak.value);
+    }
+}
+
+// Add the peaks of a Footprint found in image
+template <typename PixelT>
+void addPeaks(afw::image::Image<PixelT> const& image, bool positive, Footprint& footprint) {
+    int const x0 = image.getX0();
+    int const y0 = image.getY0();
+    std::vector<PeakPixel> peaks;
+    for (auto const& span : *footprint.getSpans()) {
+        int const y = span.getY() - y0;
+        for (int x = span.getX0() - x0; x <= span.getX1() - x0; ++x) {
+            if (isPeak(image, x, y, positive)) {
+                peaks.push_back(PeakPixel{x + x0, y + y0, image.getArray()[y][x]});
+            }
+        }
+    }
+    addPeaks(peaks, positive, footprint);
+}
+
+// Group the spans found for one threshold into Footprints
+template <typename PixelT>
+std::shared_ptr<FootprintSet> makeFootprintSet(afw::image::MaskedImage<PixelT> const& image,
+                                               std::vector<Span> spans, Threshold const& threshold,
+                                               int minPixels, geom::Box2I const& region,
+                                               afw::image::MaskPixel bitmask) {
+    auto fpSet = std::make_shared<FootprintSet>(region);
+    if (spans.empty()) {
+        return fpSet;
+    }
+    double const multiplier = threshold.getIncludeMultiplier();
+    PixelTest const includeTest(threshold, multiplier);
+    std::size_t const minArea = std::max(minPixels, 0);
+    auto& footprints = *fpSet->getFootprints();
+
+    SpanComponents const components(std::move(spans));
+    for (auto const& spanSet : components.makeSpanSets()) {
+        if (spanSet->getArea() < minArea || (multiplier != 1.0 && !anyPixel(image, *spanSet, includeTest))) {
+            continue;
+        }
+        auto footprint = std::make_shared<Footprint>(spanSet, region);
+        addPeaks(*image.getImage(), threshold.getPolarity(), *footprint);
+        spanSet->setMask(*image.getMask(), bitmask);
+        footprints.push_back(footprint);
+    }
+    return fpSet;
+}
+
+void copyPeaks(Footprint const& src, Footprint& dest) {
+    auto& peaks = dest.getPeaks();
+    for (auto const& peak : src.getPeaks()) {
+        peaks.addNew()->assign(peak);
+    }
+}
+
+bool spanLess(Span const& a, Span const& b) {
+    return a.getY() < b.getY() || (a.getY() == b.getY() && a.getX0() < b.getX0());
+}
+
+// Return the component containing pixel (x, y), or -1 if there isn't one
+int findComponent(SpanComponents const& components, int x, int y) {
+    auto const& spans = components.getSpans();
+    auto iter = std::upper_bound(spans.begin(), spans.end(), Span(y, x, x), spanLess);
+    if (iter == spans.begin()) {
+        return -1;
+    }
+    --iter;
+    if (iter->getY() != y || iter->getX1() < x) {
+        return -1;
+    }
+    return components.getLabels()[iter - spans.begin()];
+}
+
+std::shared_ptr<FootprintSet> growFootprintSet(FootprintSet const& fpSet, int nGrow, bool isotropic,
+                                               bool combined) {
+    geom::Box2I const region = fpSet.getRegion();
+    auto const stencil = isotropic ? afw::geom::Stencil::CIRCLE : afw::geom::Stencil::MANHATTAN;
+    auto grown = std::make_shared<FootprintSet>(region);
+    auto& grownFootprints = *grown->getFootprints();
+    auto const& footprints = *fpSet.getFootprints();
+
+    if (!combined) {
+        for (auto const& footprint : footprints) {
+            auto result = std::make_shared<Footprint>(footprint->getSpans()->dilated(nGrow, stencil),
+                                                      footprint->getPeaks().getSchema(),
+                                                      footprint->getRegion());
+            copyPeaks(*footprint, *result);
+            grownFootprints.push_back(result);
+        }
+        return grown;
+    }
+
+    std::vector<Span> spans;
+    for (auto const& footprint : footprints) {
+        auto const dilated = footprint->getSpans()->dilated(nGrow, stencil)->clippedTo(region);
+        spans.insert(spans.end(), dilated->begin(), dilated->end());
+    }
+    // The grown Footprints may overlap; normalizing the SpanSet merges them into disjoint spans
+    afw::geom::SpanSet const merged(std::move(spans), true);
+    SpanComponents const components(std::vector<Span>(merged.begin(), merged.end()));
+    auto const spanSets = components.makeSpanSets();
+
+    // Each input lies within its grown self, so its first pixel identifies the merged Footprint
+    std::vector<std::shared_ptr<Footprint>> results(spanSets.size());
+    for (auto const& footprint : footprints) {
+        if (footprint->getSpans()->empty()) {
+            continue;
+        }
+        Span const& first = *footprint->getSpans()->begin();
+        int const label = findComponent(components, first.getX0(), first.getY());
+        if (label < 0) {
+            continue;  // outside the region
+        }
+        auto& result = results[label];
+        if (!result) {
+            result = std::make_shared<Footprint>(spanSets[label], footprint->getPeaks().getSchema(), region);
+        }
+        copyPeaks(*footprint, *result);
+    }
+    for (auto const& result : results) {
+        if (result) {
+            grownFootprints.push_back(result);
+        }
+    }
+    return grown;
+}
+
+}  // namespace
+
+template <typename PixelT>
+FootprintSetPair thresholdFootprints(afw::image::MaskedImage<PixelT> const& image,
+                                     Threshold const* positive, Threshold const* negative, int minPixels,
+                                     geom::Box2I const& region) {
+    if (positive) {
+        checkThreshold(*positive, true);
+    }
+    if (negative) {
+        checkThreshold(*negative, false);
+    }
+    PixelTest const positiveTest = positive ? PixelTest(*positive, 1.0) : PixelTest(Threshold(0.0), 1.0);
+    PixelTest const negativeTest =
+            negative ? PixelTest(*negative, 1.0) : PixelTest(Threshold(0.0, Threshold::VALUE, false), 1.0);
+
+    int const x0 = image.getX0();
+    int const y0 = image.getY0();
+    int const width = image.getWidth();
+    auto const imageArray = image.getImage()->getArray();
+    auto const varianceArray = image.getVariance()->getArray();
+
+    std::vector<Span> positiveSpans, negativeSpans;
+    for (int y = 0; y < image.getHeight(); ++y) {
+        PixelT const* imageRow = imageArray[y].getData();
+        afw::image::VariancePixel const* varianceRow = varianceArray[y].getData();
+        int positiveStart = -1;  // start of the current run of pixels above threshold, if any
+        int negativeStart = -1;
+        for (int x = 0; x < width; ++x) {
+            if (positive) {
+                bool const above = positiveTest(imageRow[x], varianceRow[x]);
+                if (above && positiveStart < 0) {
+                    positiveStart = x;
+                } else if (!above && positiveStart >= 0) {
+                    positiveSpans.emplace_back(y + y0, positiveStart + x0, x - 1 + x0);
+                    positiveStart = -1;
+                }
+            }
+            if (negative) {
+                bool const below = negativeTest(imageRow[x], varianceRow[x]);
+                if (below && negativeStart < 0) {
+                    negativeStart = x;
+                } else if (!below && negativeStart >= 0) {
+                    negativeSpans.emplace_back(y + y0, negativeStart + x0, x - 1 + x0);
+                    negativeStart = -1;
+                }
+            }
+        }
+        if (positiveStart >= 0) {
+            positiveSpans.emplace_back(y + y0, positiveStart + x0, width - 1 + x0);
+        }
+        if (negativeStart >= 0) {
+            negativeSpans.emplace_back(y + y0, negativeStart + x0, width - 1 + x0);
+        }
+    }
+
+    FootprintSetPair result;
+    if (positive) {
+        result.first = makeFootprintSet(image, std::move(positiveSpans), *positive, minPixels, region,
+                                        image.getMask()->getPlaneBitMask("DETECTED"));
+    }
+    if (negative) {
+        result.second = makeFootprintSet(image, std::move(negativeSpans), *negative, minPixels, region,
+                                         image.getMask()->getPlaneBitMask("DETECTED_NEGATIVE"));
+    }
+    return result;
+}
+
+FootprintSetPair growFootprints(std::shared_ptr<FootprintSet> positive,
+                                std::shared_ptr<FootprintSet> negative,
+                                afw::image::Mask<afw::image::MaskPixel>& mask, int nGrow, bool isotropic,
+                                bool combined, bool returnOriginal) {
+    auto grow = [&](std::shared_ptr<FootprintSet> const& fpSet,
+                    std::string const& maskName) -> std::shared_ptr<FootprintSet> {
+        if (!fpSet) {
+            return nullptr;
+        }
+        auto grown = (nGrow > 0) ? growFootprintSet(*fpSet, nGrow, isotropic, combined) : fpSet;
+        afw::image::MaskPixel const bitmask = mask.getPlaneBitMask(maskName);
+        for (auto const& footprint : *grown->getFootprints()) {
+            footprint->getSpans()->clippedTo(mask.getBBox())->setMask(mask, bitmask);
+        }
+        return returnOriginal ? fpSet : grown;
+    };
+    return FootprintSetPair(grow(positive, "DETECTED"), grow(negative, "DETECTED_NEGATIVE"));
+}
+
+template <typename PixelT>
+FootprintSetPair detectFootprints(afw::image::MaskedImage<PixelT> const& image,
+                                  afw::image::Mask<afw::image::MaskPixel>& mask, Threshold const* positive,
+                                  Threshold const* negative, int minPixels, geom::Box2I const& region,
+                                  int nGrow, bool isotropic, bool combined, bool returnOriginal) {
+    FootprintSetPair const detected = thresholdFootprints(image, positive, negative, minPixels, region);
+    return growFootprints(detected.first, detected.second, mask, nGrow, isotropic, combined, returnOriginal);
+}
+
+FootprintStitcher::FootprintStitcher(geom::Box2I const& region, bool polarity)
+        : _region(region), _polarity(polarity) {}
+
+template <typename PixelT>
+void FootprintStitcher::addTile(afw::image::MaskedImage<PixelT> const& image, geom::Box2I const& core,
+                                Threshold const& threshold) {
+    checkThreshold(threshold, _polarity);
+    if (!image.getBBox().contains(core)) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "Tile's core is not within its image");
+    }
+    PixelTest const test(threshold, 1.0);
+    double const multiplier = threshold.getIncludeMultiplier();
+    PixelTest const includeTest(threshold, multiplier);
+
+    int const x0 = image.getX0();
+    int const y0 = image.getY0();
+    auto const& tileImage = *image.getImage();
+    auto const imageArray = tileImage.getArray();
+    auto const varianceArray = image.getVariance()->getArray();
+    for (int y = core.getMinY(); y <= core.getMaxY(); ++y) {
+        PixelT const* imageRow = imageArray[y - y0].getData();
+        afw::image::VariancePixel const* varianceRow = varianceArray[y - y0].getData();
+        int start = -1;  // start of the current run of detected pixels, if any
+        bool include = false;
+        for (int x = core.getMinX(); x <= core.getMaxX() + 1; ++x) {
+            int const ix = x - x0;
+            if (x <= core.getMaxX() && test(imageRow[ix], varianceRow[ix])) {
+                if (start < 0) {
+                    start = x;
+                    include = (multiplier == 1.0);
+                }
+                include = include || includeTest(imageRow[ix], varianceRow[ix]);
+                if (isPeak(tileImage, ix, y - y0, _polarity)) {
+                    _peaks.push_back(Peak{x, y, static_cast<double>(imageRow[ix])});
+                }
+            } else if (start >= 0) {
+                _spans.emplace_back(y, start, x - 1);
+                _include.push_back(include);
+                start = -1;
+            }
+        }
+    }
+}
+
+std::shared_ptr<FootprintSet> FootprintStitcher::makeFootprintSet(int minPixels) const {
+    auto fpSet = std::make_shared<FootprintSet>(_region);
+    if (_spans.empty()) {
+        return fpSet;
+    }
+    // Sort the runs (which are in tile order) ourselves, so we know where each one's flag went
+    std::vector<std::size_t> order(_spans.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [this](std::size_t i, std::size_t j) { return spanLess(_spans[i], _spans[j]); });
+    std::vector<Span> spans;
+    std::vector<bool> spanInclude;
+    spans.reserve(order.size());
+    spanInclude.reserve(order.size());
+    for (std::size_t i : order) {
+        spans.push_back(_spans[i]);
+        spanInclude.push_back(_include[i]);
+    }
+
+    SpanComponents const components(std::move(spans));
+    std::size_t const nComponents = components.getComponentCount();
+    auto const& labels = components.getLabels();
+    std::vector<std::size_t> areas(nComponents, 0);
+    std::vector<bool> include(nComponents, false);
+    for (std::size_t i = 0; i < labels.size(); ++i) {
+        areas[labels[i]] += components.getSpans()[i].getWidth();
+        if (spanInclude[i]) {
+            include[labels[i]] = true;
+        }
+    }
+    std::vector<std::vector<PeakPixel>> peaks(nComponents);
+    for (auto const& peak : _peaks) {
+        int const label = findComponent(components, peak.x, peak.y);
+        if (label >= 0) {
+            peaks[label].push_back(PeakPixel{peak.x, peak.y, peak.value});
+        }
+    }
+
+    std::size_t const minArea = std::max(minPixels, 0);
+    auto const spanSets = components.makeSpanSets();
+    auto& footprints = *fpSet->getFootprints();
+    for (std::size_t i = 0; i < nComponents; ++i) {
+        if (areas[i] < minArea || !include[i]) {
+            continue;
+        }
+        auto footprint = std::make_shared<Footprint>(spanSets[i], _region);
+        addPeaks(peaks[i], _polarity, *footprint);
+        footprints.push_back(footprint);
+    }
+    return fpSet;
+}
+
+#define INSTANTIATE(TYPE)                                                                        \
+    template FootprintSetPair thresholdFootprints(afw::image::MaskedImage<TYPE> const&,            \
+                                                  Threshold const*, Threshold const*, int,         \
+                                                  geom::Box2I const&);                             \
+    template FootprintSetPair detectFootprints(afw::image::MaskedImage<TYPE> const&,               \
+                                               afw::image::Mask<afw::image::MaskPixel>&,           \
+                                               Threshold const*, Threshold const*, int,            \
+                                               geom::Box2I const&, int, bool, bool, bool);        \
+    template void FootprintStitcher::addTile(afw::image::MaskedImage<TYPE> const&,                \
+                                             geom::Box2I const&, Threshold const&);
+
+INSTANTIATE(float)
+INSTANTIATE(double)
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,148 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/algorithms/GaussianPsfMoments.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+namespace {
+
+// Maximum number of iterations used to find the adaptive moments of a mixture.
+int const MAX_ITERATIONS = 100;
+
+// Fraction of a unit-flux Gaussian of width sigma (in one dimension) lying between a and b.
+double integrateGaussian(double a, double b, double sigma) {
+    return 0.5 * (std::erf(b / (M_SQRT2 * sigma)) - std::erf(a / (M_SQRT2 * sigma)));
+}
+
+}  // namespace
+
+double const GaussianPsfMoments::MIN_SHAPE_EXTENT = 4.0;
+
+GaussianPsfMoments::GaussianPsfMoments(std::vector<double> const& sigmas, std::vector<double> const& fluxes,
+                                       geom::Box2I const& bbox)
+        : _sigmas(sigmas),
+          _fluxes(fluxes),
+          _maxRadius(0.0),
+          _positive(false),
+          _hasShape(false),
+          _moment(0.0) {
+    if (sigmas.size() != fluxes.size()) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Got %d sigmas but %d fluxes") % sigmas.size() % fluxes.size())
+                                  .str());
+    }
+    // The kernel image's pixels sample the Gaussians at their centers, so the image covers the bbox
+    // extended by half a pixel on each side.
+    double const x0 = bbox.getMinX() - 0.5, x1 = bbox.getMaxX() + 0.5;
+    double const y0 = bbox.getMinY() - 0.5, y1 = bbox.getMaxY() + 0.5;
+    _maxRadius = std::max(0.0, std::min({-x0, x1, -y0, y1}));
+
+    double total = 0.0;
+    _positive = true;
+    for (std::size_t i = 0; i < _sigmas.size(); ++i) {
+        if (_fluxes[i] < 0.0) {
+            _positive = false;
+        }
+        if (_fluxes[i] != 0.0) {
+            double const sigma = _sigmas[i];
+            total += _fluxes[i] * integrateGaussian(x0, x1, sigma) * integrateGaussian(y0, y1, sigma);
+        }
+    }
+    if (!(total > 0.0)) {
+        _positive = false;
+        return;
+    }
+    for (auto& flux : _fluxes) {
+        flux /= total;
+    }
+    if (!_positive) {
+        return;
+    }
+
+    // Adaptive moments use a circular Gaussian weight of variance q, and converge when the weight
+    // matches the image: for a Gaussian of variance s^2 the weighted image is a Gaussian of variance
+    // v = s^2 q/(s^2 + q) and flux proportional to a = q/(s^2 + q).  We iterate the weight update that
+    // SdssShape uses, 1/q' = 1/M - 1/q, where M is the weighted second moment; it converges in a single
+    // step for one Gaussian.
+    double maxSigma = 0.0;
+    double sum = 0.0, sumSq = 0.0;
+    for (std::size_t i = 0; i < _sigmas.size(); ++i) {
+        if (_fluxes[i] > 0.0) {
+            maxSigma = std::max(maxSigma, _sigmas[i]);
+            sum += _fluxes[i];
+            sumSq += _fluxes[i] * _sigmas[i] * _sigmas[i];
+        }
+    }
+    if (_maxRadius < MIN_SHAPE_EXTENT * maxSigma) {
+        return;
+    }
+    double q = sumSq / sum;
+    for (int iter = 0; iter < MAX_ITERATIONS; ++iter) {
+        double num = 0.0, den = 0.0;
+        for (std::size_t i = 0; i < _sigmas.size(); ++i) {
+            if (_fluxes[i] > 0.0) {
+                double const s2 = _sigmas[i] * _sigmas[i];
+                double const a = _fluxes[i] * q / (s2 + q);
+                num += a * s2 * q / (s2 + q);
+                den += a;
+            }
+        }
+        double const next = 1.0 / (den / num - 1.0 / q);
+        if (!(next > 0.0) || !std::isfinite(next)) {
+            return;
+        }
+        bool const converged = std::abs(next - q) <= 1e-12 * q;
+        q = next;
+        if (converged) {
+            _moment = q;
+            _hasShape = true;
+            return;
+        }
+    }
+}
+
+bool GaussianPsfMoments::hasApertureFlux(double radius) const {
+    return _positive && radius >= 0.0 && radius <= _maxRadius;
+}
+
+double GaussianPsfMoments::computeApertureFlux(double radius) const {
+    double flux = 0.0;
+    for (std::size_t i = 0; i < _sigmas.size(); ++i) {
+        if (_fluxes[i] != 0.0) {
+            flux += _fluxes[i] * -std::expm1(-0.5 * radius * radius / (_sigmas[i] * _sigmas[i]));
+        }
+    }
+    return flux;
+}
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,383 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <thread>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/algorithms/HtmMesh.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+namespace {
+
+/*
+ * The arithmetic below deliberately mirrors the SDSS HTM library's SpatialVector, operation for
+ * operation, so that positions on (or within rounding of) a trixel edge end up in the same trixel.
+ */
+struct Vector {
+    double x;
+    double y;
+    double z;
+};
+
+Vector makeVector(double ra, double dec) {  // degrees
+    double const cd = std::cos((dec * M_PI) / 180.0);
+    return Vector{std::cos((ra * M_PI) / 180.0) * cd, std::sin((ra * M_PI) / 180.0) * cd,
+                  std::sin((dec * M_PI) / 180.0)};
+}
+
+Vector makeVector(geom::SpherePoint const& point) {
+    return makeVector(point.getLongitude().asDegrees(), point.getLatitude().asDegrees());
+}
+
+Vector cross(Vector const& a, Vector const& b) {
+    return Vector{a.y * b.z - b.y * a.z, a.z * b.x - b.z * a.x, a.x * b.y - b.x * a.y};
+}
+
+double dot(Vector const& a, Vector const& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+// Normalized midpoint of the great circle arc between a and b
+Vector midpoint(Vector const& a, Vector const& b) {
+    Vector w{a.x + b.x, a.y + b.y, a.z + b.z};
+    double const norm = std::sqrt(w.x * w.x + w.y * w.y + w.z * w.z);
+    w.x /= norm;
+    w.y /= norm;
+    w.z /= norm;
+    return w;
+}
+
+double const EPSILON = 1.0e-15;  // tolerance of the edge tests, as in the SDSS library
+
+bool isInside(Vector const& p, Vector const& v0, Vector const& v1, Vector const& v2) {
+    return !(dot(cross(v0, v1), p) < -EPSILON || dot(cross(v1, v2), p) < -EPSILON ||
+             dot(cross(v2, v0), p) < -EPSILON);
+}
+
+Vector const OCTAHEDRON[6] = {{0, 0, 1}, {1, 0, 0}, {0, 1, 0}, {-1, 0, 0}, {0, -1, 0}, {0, 0, -1}};
+
+// Vertices of the root trixels S0-S3, N0-N3 (IDs 8-15), counter-clockwise seen from outside the sphere
+int const ROOTS[8][3] = {{1, 5, 2}, {2, 5, 3}, {3, 5, 4}, {4, 5, 1},
+                         {1, 0, 4}, {4, 0, 3}, {3, 0, 2}, {2, 0, 1}};
+
+struct Trixel {
+    std::int64_t id;
+    Vector v[3];
+};
+
+Trixel getRoot(int i) {
+    return Trixel{8 + i, {OCTAHEDRON[ROOTS[i][0]], OCTAHEDRON[ROOTS[i][1]], OCTAHEDRON[ROOTS[i][2]]}};
+}
+
+// Return the k'th child (0 <= k < 4) of a trixel
+Trixel getChild(Trixel const& parent, int k) {
+    Vector const& v0 = parent.v[0];
+    Vector const& v1 = parent.v[1];
+    Vector const& v2 = parent.v[2];
+    Vector const w0 = midpoint(v1, v2);
+    Vector const w1 = midpoint(v0, v2);
+    Vector const w2 = midpoint(v0, v1);
+    std::int64_t const id = 4 * parent.id + k;
+    switch (k) {
+        case 0:
+            return Trixel{id, {v0, w2, w1}};
+        case 1:
+            return Trixel{id, {v1, w0, w2}};
+        case 2:
+            return Trixel{id, {v2, w1, w0}};
+        default:
+            return Trixel{id, {w0, w1, w2}};
+    }
+}
+
+// Locate a point, returning 0 if it falls through a crack (which the tolerance makes impossible for
+// finite points)
+std::int64_t locate(Vector const& p, int depth) {
+    int root = 0;
+    while (root < 8 && !isInside(p, OCTAHEDRON[ROOTS[root][0]], OCTAHEDRON[ROOTS[root][1]],
+                                 OCTAHEDRON[ROOTS[root][2]])) {
+        ++root;
+    }
+    if (root == 8) {
+        return 0;
+    }
+    std::int64_t id = 8 + root;
+    Vector v0 = OCTAHEDRON[ROOTS[root][0]];
+    Vector v1 = OCTAHEDRON[ROOTS[root][1]];
+    Vector v2 = OCTAHEDRON[ROOTS[root][2]];
+    for (int level = 0; level < depth; ++level) {
+        Vector const w0 = midpoint(v1, v2);
+        Vector const w1 = midpoint(v0, v2);
+        Vector const w2 = midpoint(v0, v1);
+        if (isInside(p, v0, w2, w1)) {
+            id = 4 * id;
+            v1 = w2;
+            v2 = w1;
+        } else if (isInside(p, v1, w0, w2)) {
+            id = 4 * id + 1;
+            v0 = v1;
+            v1 = w0;
+            v2 = w2;
+        } else if (isInside(p, v2, w1, w0)) {
+            id = 4 * id + 2;
+            v0 = v2;
+            v1 = w1;
+            v2 = w0;
+        } else if (isInside(p, w0, w1, w2)) {
+            id = 4 * id + 3;
+            v0 = w0;
+            v1 = w1;
+            v2 = w2;
+        } else {
+            return 0;
+        }
+    }
+    return id;
+}
+
+typedef std::function<void(std::size_t, std::size_t)> ProcessPoints;
+
+// Call processPoints(begin, end) on contiguous blocks of [0, n), with one thread per block
+void forEachPointBlock(std::size_t const n, int const nThreads, ProcessPoints const& processPoints) {
+    std::size_t const nBlocks = std::max<std::size_t>(1, std::min<std::size_t>(std::max(nThreads, 1), n));
+    if (nBlocks == 1) {
+        processPoints(0, n);
+        return;
+    }
+
+    std::vector<std::size_t> starts(nBlocks + 1);  // first point of each block
+    for (std::size_t k = 0; k <= nBlocks; ++k) {
+        starts[k] = n * k / nBlocks;
+    }
+    std::vector<std::exception_ptr> errors(nBlocks);
+    auto work = [&](std::size_t k) {
+        try {
+            processPoints(starts[k], starts[k + 1]);
+        } catch (...) {
+            errors[k] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(nBlocks - 1);
+    for (std::size_t k = 1; k < nBlocks; ++k) {
+        workers.emplace_back(work, k);
+    }
+    work(0);  // the calling thread processes the first block
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto const& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+enum Relation { DISJOINT, INTERSECTS, CONTAINS };  // how a region relates to a trixel
+
+// A spherical cap; convex (at most a hemisphere) when cosRadius >= 0
+struct Cap {
+    Vector center;
+    double cosRadius;
+
+    Relation relate(Trixel const& trixel) const {
+        if (cosRadius < 0.0) {
+            // Test against the (convex) complement instead
+            Cap const complement{Vector{-center.x, -center.y, -center.z}, -cosRadius};
+            Relation const relation = complement.relate(trixel);
+            return relation == DISJOINT ? CONTAINS : (relation == CONTAINS ? DISJOINT : INTERSECTS);
+        }
+        int nInside = 0;
+        for (auto const& v : trixel.v) {
+            nInside += (dot(center, v) >= cosRadius);
+        }
+        if (nInside == 3) {
+            return CONTAINS;
+        }
+        if (nInside > 0 || isInside(center, trixel.v[0], trixel.v[1], trixel.v[2])) {
+            return INTERSECTS;
+        }
+        // No vertex is inside, so the cap can only reach the trixel through the middle of an edge
+        for (int i = 0; i < 3; ++i) {
+            Vector const& a = trixel.v[i];
+            Vector const& b = trixel.v[(i + 1) % 3];
+            Vector n = cross(a, b);
+            double const norm = std::sqrt(dot(n, n));
+            n = Vector{n.x / norm, n.y / norm, n.z / norm};
+            double const offset = dot(center, n);
+            // Closest point to the center on the edge's great circle; |p| is the cosine of its distance
+            Vector const p{center.x - offset * n.x, center.y - offset * n.y, center.z - offset * n.z};
+            if (dot(cross(a, p), n) >= 0.0 && dot(cross(p, b), n) >= 0.0 &&
+                std::sqrt(dot(p, p)) >= cosRadius - EPSILON) {
+                return INTERSECTS;
+            }
+        }
+        return DISJOINT;
+    }
+};
+
+// A convex spherical polygon, as the inward normals of its edges
+struct ConvexPolygon {
+    std::vector<Vector> vertices;
+    std::vector<Vector> normals;
+
+    Relation relate(Trixel const& trixel) const {
+        bool contains = true;
+        for (auto const& n : normals) {
+            int nInside = 0;
+            for (auto const& v : trixel.v) {
+                nInside += (dot(n, v) >= 0.0);
+            }
+            if (nInside == 0) {
+                return DISJOINT;  // this edge separates the polygon from the trixel
+            }
+            contains = contains && nInside == 3;
+        }
+        if (contains) {
+            return CONTAINS;
+        }
+        for (int i = 0; i < 3; ++i) {
+            Vector const n = cross(trixel.v[i], trixel.v[(i + 1) % 3]);
+            if (std::none_of(vertices.begin(), vertices.end(),
+                             [&n](Vector const& v) { return dot(n, v) >= 0.0; })) {
+                return DISJOINT;  // this trixel edge separates them
+            }
+        }
+        return INTERSECTS;
+    }
+};
+
+typedef std::pair<std::vector<std::int64_t>, std::vector<bool>> Cover;
+
+template <typename Region>
+void addCover(Region const& region, Trixel const& trixel, int level, int depth, Cover& cover) {
+    Relation const relation = region.relate(trixel);
+    if (relation == DISJOINT) {
+        return;
+    }
+    if (relation == CONTAINS) {
+        int const shift = 2 * (depth - level);
+        for (std::int64_t id = trixel.id << shift; id < (trixel.id + 1) << shift; ++id) {
+            cover.first.push_back(id);
+            cover.second.push_back(false);
+        }
+        return;
+    }
+    if (level == depth) {
+        cover.first.push_back(trixel.id);
+        cover.second.push_back(true);
+        return;
+    }
+    for (int k = 0; k < 4; ++k) {
+        addCover(region, getChild(trixel, k), level + 1, depth, cover);
+    }
+}
+
+template <typename Region>
+Cover makeCover(Region const& region, int depth) {
+    Cover cover;
+    for (int i = 0; i < 8; ++i) {
+        addCover(region, getRoot(i), 0, depth, cover);
+    }
+    return cover;
+}
+
+}  // namespace
+
+HtmMesh::HtmMesh(int depth) : _depth(depth) {
+    if (depth < 0 || depth > MAX_DEPTH) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("HTM depth must be in [0, %d]; got %d") % MAX_DEPTH % depth).str());
+    }
+}
+
+std::int64_t HtmMesh::indexPoint(double ra, double dec) const { return locate(makeVector(ra, dec), _depth); }
+
+ndarray::Array<std::int64_t, 1, 1> HtmMesh::indexPoints(ndarray::Array<double const, 1> const& ra,
+                                                        ndarray::Array<double const, 1> const& dec,
+                                                        int nThreads) const {
+    if (ra.getSize<0>() != dec.getSize<0>()) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Lengths of ra (%d) and dec (%d) differ") % ra.getSize<0>() %
+                           dec.getSize<0>())
+                                  .str());
+    }
+    std::size_t const n = ra.getSize<0>();
+    ndarray::Array<std::int64_t, 1, 1> ids = ndarray::allocate(n);
+    forEachPointBlock(n, nThreads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            ids[i] = locate(makeVector(ra[i], dec[i]), _depth);
+        }
+    });
+    return ids;
+}
+
+std::pair<std::vector<std::int64_t>, std::vector<bool>> HtmMesh::getCircleCover(
+        geom::SpherePoint const& center, geom::Angle radius) const {
+    Cap const cap{makeVector(center), std::cos(radius.asRadians())};
+    return makeCover(cap, _depth);
+}
+
+std::pair<std::vector<std::int64_t>, std::vector<bool>> HtmMesh::getPolygonCover(
+        std::vector<geom::SpherePoint> const& vertices) const {
+    std::size_t const n = vertices.size();
+    if (n < 3) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("A polygon needs at least 3 vertices; got %d") % n).str());
+    }
+    ConvexPolygon polygon;
+    for (auto const& vertex : vertices) {
+        polygon.vertices.push_back(makeVector(vertex));
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        polygon.normals.push_back(cross(polygon.vertices[i], polygon.vertices[(i + 1) % n]));
+    }
+    // Every vertex must be on the same side of every edge; flip the normals if that side is the outside
+    int nPositive = 0;
+    int nNegative = 0;
+    for (auto const& normal : polygon.normals) {
+        for (auto const& vertex : polygon.vertices) {
+            double const side = dot(normal, vertex);
+            nPositive += (side > EPSILON);
+            nNegative += (side < -EPSILON);
+        }
+    }
+    if ((nPositive > 0 && nNegative > 0) || nPositive + nNegative == 0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "Polygon is not convex");
+    }
+    if (nNegative > 0) {
+        for (auto& normal : polygon.normals) {
+            normal = Vector{-normal.x, -normal.y, -normal.z};
+        }
+    }
+    return makeCover(polygon, _depth);
+}
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
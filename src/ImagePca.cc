@@ -30,6 +30,13 @@
  * @ingroup algorithms
  */
 
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <random>
+
+#include "Eigen/Eigenvalues"
+#include "Eigen/QR"
 #include "lsst/afw.h"
 #include "lsst/meas/algorithms/ImagePca.h"
 
@@ -37,9 +44,214 @@ namespace lsst {
 namespace meas {
 namespace algorithms {
 
+namespace {
+
+int const MAX_COMPONENTS = 100;  // number of eigenimages afw::image::ImagePca::analyze makes
+int const N_OVERSAMPLE = 10;     // extra random vectors used by the randomized SVD
+int const N_POWER_ITER = 2;      // power iterations used by the randomized SVD
+unsigned int const SEED = 1;     // seed for the randomized SVD's random vectors
+
+/// Copy the image plane of an image, in row-major order
+template <typename ImageT, typename PixelT>
+void copyPixels(std::shared_ptr<ImageT> const& image, std::vector<PixelT>& pixels) {
+    auto const plane = afw::image::GetImage<ImageT>::getImage(image);
+    pixels.resize(static_cast<std::size_t>(plane->getWidth()) * plane->getHeight());
+    auto out = pixels.begin();
+    for (int y = 0; y != plane->getHeight(); ++y) {
+        out = std::copy(plane->row_begin(y), plane->row_end(y), out);
+    }
+}
+
+/// Return the eigenvalues' indices, sorted by decreasing eigenvalue
+std::vector<std::pair<double, int>> sortEigenValues(Eigen::VectorXd const& eigenValues) {
+    std::vector<std::pair<double, int>> sorted;
+    sorted.reserve(eigenValues.size());
+    for (int i = 0; i != eigenValues.size(); ++i) {
+        sorted.emplace_back(eigenValues[i], i);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](std::pair<double, int> const& a, std::pair<double, int> const& b) {
+                         return a.first > b.first;
+                     });
+    return sorted;
+}
+
+}  // anonymous namespace
+
+template <typename ImageT>
+Eigen::MatrixXd const& ImageInnerProductCache<ImageT>::update(
+        std::vector<std::shared_ptr<ImageT>> const& images, std::vector<void const*> const& keys) {
+    int const nImage = images.size();
+    std::vector<Entry> entries(nImage);
+    std::vector<int> old(nImage, -1);  // index of each image's entry in _entries, if still valid
+    for (int i = 0; i != nImage; ++i) {
+        entries[i].key = keys[i];
+        copyPixels(images[i], entries[i].pixels);
+        auto const iter = _index.find(keys[i]);
+        if (iter != _index.end() && _entries[iter->second].pixels == entries[i].pixels) {
+            old[i] = iter->second;
+        }
+    }
+
+    Eigen::MatrixXd products(nImage, nImage);
+    for (int i = 0; i != nImage; ++i) {
+        for (int j = i; j != nImage; ++j) {
+            if (old[i] >= 0 && old[j] >= 0) {
+                products(i, j) = _products(old[i], old[j]);
+                ++_hits;
+            } else {
+                products(i, j) = std::inner_product(entries[i].pixels.begin(), entries[i].pixels.end(),
+                                                    entries[j].pixels.begin(), 0.0, std::plus<double>(),
+                                                    std::multiplies<double>());
+                ++_misses;
+            }
+            products(j, i) = products(i, j);
+        }
+    }
+
+    _entries.swap(entries);
+    _products.swap(products);
+    _index.clear();
+    for (int i = 0; i != nImage; ++i) {
+        _index[_entries[i].key] = i;
+    }
+    return _products;
+}
+
+template <typename ImageT>
+void ImageInnerProductCache<ImageT>::clear() {
+    _entries.clear();
+    _index.clear();
+    _products.resize(0, 0);
+}
+
+template <typename ImageT>
+void PsfImagePca<ImageT>::addImage(std::shared_ptr<ImageT> img, double flux, void const* key) {
+    Super::addImage(img, flux);
+    _keys.push_back(key ? key : img.get());
+    if (flux == 0.0) {
+        flux = afw::math::makeStatistics(*img, afw::math::SUM).getValue(afw::math::SUM);
+    }
+    _fluxes.push_back(flux);
+}
+
+template <typename ImageT>
+void PsfImagePca<ImageT>::setComponents(int nComponents, bool randomized) {
+    _nComponents = nComponents;
+    _randomized = randomized;
+}
+
+template <typename ImageT>
+void PsfImagePca<ImageT>::_setEigenImages(ImageList const& images, Eigen::MatrixXd const& eigenVectors,
+                                          std::vector<std::pair<double, int>> const& sorted,
+                                          int nComponents) {
+    int const nImage = images.size();
+    double const fluxBar = std::accumulate(_fluxes.begin(), _fluxes.end(), 0.0) / nImage;
+    this->_eigenImages.clear();
+    this->_eigenImages.reserve(nComponents);
+    for (int i = 0; i < nComponents; ++i) {
+        int const index = sorted[i].second;
+        auto eImage = std::make_shared<ImageT>(this->getDimensions());
+        for (int j = 0; j != nImage; ++j) {
+            double const weight = eigenVectors(j, index) * (_constantWeight ? fluxBar / _fluxes[j] : 1);
+            eImage->scaledPlus(weight, *images[j]);
+        }
+        this->_eigenImages.push_back(eImage);
+    }
+}
+
+/*
+ * As afw::image::ImagePca::analyze: find the eigenvectors Q of the matrix R of the images' inner products
+ * (divided by their fluxes if _constantWeight), and form the eigenimages as the images weighted by Q.
+ */
+template <typename ImageT>
+void PsfImagePca<ImageT>::_analyzeFull(ImageList const& images) {
+    int const nImage = images.size();
+    ImageInnerProductCache<ImageT> scratch;
+    Eigen::MatrixXd const& products = (_cache ? _cache : &scratch)->update(images, _keys);
+
+    Eigen::MatrixXd R(nImage, nImage);
+    for (int i = 0; i != nImage; ++i) {
+        for (int j = i; j != nImage; ++j) {
+            double dot = products(i, j);
+            if (_constantWeight) {
+                dot /= _fluxes[i] * _fluxes[j];
+            }
+            R(i, j) = R(j, i) = dot / nImage;
+        }
+    }
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eVecValues(R);
+    std::vector<std::pair<double, int>> const sorted = sortEigenValues(eVecValues.eigenvalues());
+
+    this->_eigenValues.clear();
+    for (auto const& value : sorted) {
+        this->_eigenValues.push_back(value.first);
+    }
+    int const nComponents = std::min(_nComponents > 0 ? _nComponents : MAX_COMPONENTS, nImage);
+    _setEigenImages(images, eVecValues.eigenvectors(), sorted, nComponents);
+}
+
+/*
+ * Find the leading eigenvectors of R = A^T A/n, where the columns of A are the (weighted) images, without
+ * forming R: orthonormalise R applied to a block of random vectors (and then to the result, a few times),
+ * and solve the small eigenproblem of R projected onto the span of that block.
+ */
+template <typename ImageT>
+void PsfImagePca<ImageT>::_analyzeRandomized(ImageList const& images) {
+    int const nImage = images.size();
+    int const nVector = std::min(nImage, _nComponents + N_OVERSAMPLE);
+
+    std::vector<typename afw::image::GetImage<ImageT>::type::Pixel> pixels;
+    copyPixels(images[0], pixels);
+    Eigen::MatrixXd A(pixels.size(), nImage);
+    for (int j = 0; j != nImage; ++j) {
+        copyPixels(images[j], pixels);
+        double const weight = _constantWeight ? 1.0 / _fluxes[j] : 1.0;
+        for (std::size_t k = 0; k != pixels.size(); ++k) {
+            A(k, j) = weight * pixels[k];
+        }
+    }
+
+    std::mt19937 rng(SEED);
+    std::normal_distribution<double> normal;
+    Eigen::MatrixXd Y(nImage, nVector);
+    for (int j = 0; j != nVector; ++j) {
+        for (int i = 0; i != nImage; ++i) {
+            Y(i, j) = normal(rng);
+        }
+    }
+    Eigen::MatrixXd Q;
+    for (int iter = 0; iter <= N_POWER_ITER; ++iter) {
+        Eigen::HouseholderQR<Eigen::MatrixXd> const qr(Y);
+        Q = qr.householderQ() * Eigen::MatrixXd::Identity(nImage, nVector);
+        if (iter < N_POWER_ITER) {
+            Y = A.transpose() * (A * Q) / nImage;
+        }
+    }
+    Eigen::MatrixXd const AQ = A * Q;
+    Eigen::MatrixXd const B = AQ.transpose() * AQ / nImage;
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eVecValues(B);
+    std::vector<std::pair<double, int>> const sorted = sortEigenValues(eVecValues.eigenvalues());
+
+    int const nComponents = std::min(_nComponents, nImage);
+    this->_eigenValues.clear();
+    for (int i = 0; i < nComponents; ++i) {
+        this->_eigenValues.push_back(sorted[i].first);
+    }
+    _setEigenImages(images, Q * eVecValues.eigenvectors(), sorted, nComponents);
+}
+
 template <typename ImageT>
 void PsfImagePca<ImageT>::analyze() {
-    Super::analyze();
+    ImageList const images = this->getImageList();
+    int const nImage = images.size();
+    if ((!_cache && _nComponents <= 0) || nImage <= 1) {
+        Super::analyze();  // which also deals with the trivial cases
+    } else if (_randomized && _nComponents > 0 && _nComponents + N_OVERSAMPLE < nImage) {
+        _analyzeRandomized(images);
+    } else {
+        _analyzeFull(images);
+    }
 
     typename Super::ImageList const &eImageList = this->getEigenImages();
     typename Super::ImageList::const_iterator iter = eImageList.begin(), end = eImageList.end();
@@ -122,7 +334,9 @@ void PsfImagePca<ImageT>::analyze() {
     }
 }
 
-#define INSTANTIATE_IMAGE(IMAGE) template class PsfImagePca<IMAGE>;
+#define INSTANTIATE_IMAGE(IMAGE)              \
+    template class ImageInnerProductCache<IMAGE>; \
+    template class PsfImagePca<IMAGE>;
 
 #define INSTANTIATE(TYPE)                       \
     INSTANTIATE_IMAGE(afw::image::Image<TYPE>); \
@@ -22,6 +22,7 @@
  */
 
 #include "lsst/geom/Point.h"
+#include "lsst/pex/exceptions.h"
 #include "lsst/afw/image/MaskedImage.h"
 #include "lsst/afw/table/io/Persistable.cc"
 #include "lsst/meas/algorithms/ImagePsf.h"
@@ -42,24 +43,97 @@ PersistableFacade<meas::algorithms::ImagePsf>::dynamicCast(std::shared_ptr<Persi
 namespace meas {
 namespace algorithms {
 
+std::vector<PTR(ImagePsf::Image)> ImagePsf::computeKernelImages(std::vector<geom::Point2D> const& positions,
+                                                                afw::image::Color const& color) const {
+    return doComputeKernelImages(positions, color);
+}
+
+void ImagePsf::computeKernelImages(std::vector<geom::Point2D> const& positions,
+                                   ndarray::Array<double, 3, 3> const& out,
+                                   afw::image::Color const& color) const {
+    if (static_cast<std::size_t>(out.getSize<0>()) != positions.size()) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Output stack has %d slices, but %d positions were given") %
+                           out.getSize<0>() % positions.size())
+                                  .str());
+    }
+    int const height = out.getSize<1>();
+    int const width = out.getSize<2>();
+    geom::Box2I const stackBBox(geom::Point2I(-(width / 2), -(height / 2)), geom::Extent2I(width, height));
+    std::vector<PTR(Image)> images = doComputeKernelImages(positions, color);
+    for (std::size_t i = 0; i < images.size(); ++i) {
+        Image slice(out[i], false, stackBBox.getMin());  // view into the caller's array
+        slice = 0.0;
+        geom::Box2I overlap = images[i]->getBBox();
+        overlap.clip(stackBBox);
+        if (!overlap.isEmpty()) {
+            Image(slice, overlap).assign(Image(*images[i], overlap));
+        }
+    }
+}
+
+std::vector<PTR(ImagePsf::Image)> ImagePsf::doComputeKernelImages(std::vector<geom::Point2D> const& positions,
+                                                                  afw::image::Color const& color) const {
+    std::vector<PTR(Image)> images;
+    images.reserve(positions.size());
+    for (auto const& position : positions) {
+        images.push_back(computeKernelImage(position, color));
+    }
+    return images;
+}
+
+void ImagePsf::setResultCacheCapacity(std::size_t capacity) {
+    if (capacity == 0) {
+        _resultCache.reset();
+    } else if (!_resultCache || _resultCache->getCapacity() != capacity) {
+        _resultCache = std::make_shared<PsfResultCache>(capacity);
+    }
+}
+
+PTR(ImagePsf::Image) ImagePsf::_getMeasurementImage(geom::Point2D const& position,
+                                                    afw::image::Color const& color) const {
+    if (_resultCache) {
+        PTR(Image) image = _resultCache->getImage(position, color);
+        if (image) {
+            return image;
+        }
+    }
+    return computeKernelImage(position, color, INTERNAL);
+}
+
 double ImagePsf::doComputeApertureFlux(double radius, geom::Point2D const& position,
                                        afw::image::Color const& color) const {
-    afw::image::Image<double> const& image(*computeKernelImage(position, color, INTERNAL));
+    double flux;
+    if (_resultCache && _resultCache->getApertureFlux(radius, position, color, flux)) {
+        return flux;
+    }
+    PTR(Image) image = _getMeasurementImage(position, color);
 
     geom::Point2D const center(0.0, 0.0);
     afw::geom::ellipses::Axes const axes(radius, radius);
     base::ApertureFluxResult result = base::ApertureFluxAlgorithm::computeSincFlux(
-            image, afw::geom::ellipses::Ellipse(axes, center), base::ApertureFluxControl());
+            *image, afw::geom::ellipses::Ellipse(axes, center), base::ApertureFluxControl());
+    if (_resultCache) {
+        _resultCache->insertApertureFlux(radius, position, color, result.instFlux, image);
+    }
     return result.instFlux;
 }
 
 afw::geom::ellipses::Quadrupole ImagePsf::doComputeShape(geom::Point2D const& position,
                                                          afw::image::Color const& color) const {
-    PTR(Image) image = computeKernelImage(position, color, INTERNAL);
-    return meas::base::SdssShapeAlgorithm::computeAdaptiveMoments(
-                   *image, geom::Point2D(0.0, 0.0)  // image has origin at the center
-                   )
-            .getShape();
+    afw::geom::ellipses::Quadrupole shape;
+    if (_resultCache && _resultCache->getShape(position, color, shape)) {
+        return shape;
+    }
+    PTR(Image) image = _getMeasurementImage(position, color);
+    shape = meas::base::SdssShapeAlgorithm::computeAdaptiveMoments(
+                    *image, geom::Point2D(0.0, 0.0)  // image has origin at the center
+                    )
+                    .getShape();
+    if (_resultCache) {
+        _resultCache->insertShape(position, color, shape, image);
+    }
+    return shape;
 }
 
 }  // namespace algorithms
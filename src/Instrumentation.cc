@@ -0,0 +1,168 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "lsst/meas/algorithms/Instrumentation.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+namespace {
+
+typedef std::unordered_map<char const*, Instrumentation::Entry> ThreadEntryMap;
+
+/*
+ * The timers and counters of one thread.  The mutex is only contended while the tables are being read or
+ * reset, so taking it costs little on the hot path.
+ */
+struct ThreadTable {
+    std::mutex mutex;
+    ThreadEntryMap timers;
+    ThreadEntryMap counters;
+};
+
+void accumulate(ThreadEntryMap& entries, char const* name, double value) {
+    Instrumentation::Entry& entry = entries[name];  // value-initialized to zero if new
+    ++entry.calls;
+    entry.total += value;
+}
+
+void merge(ThreadEntryMap const& from, Instrumentation::EntryMap& to) {
+    for (auto const& item : from) {
+        Instrumentation::Entry& entry = to[item.first];
+        entry.calls += item.second.calls;
+        entry.total += item.second.total;
+    }
+}
+
+/*
+ * All the live threads' tables, and the merged tables of the threads that have exited
+ */
+class Registry {
+public:
+    // Never destroyed, so threads exiting during static destruction can still retire their tables
+    static Registry& get() {
+        static Registry* const registry = new Registry();
+        return *registry;
+    }
+
+    void add(ThreadTable* table) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tables.push_back(table);
+    }
+
+    void retire(ThreadTable* table) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::lock_guard<std::mutex> tableLock(table->mutex);
+        merge(table->timers, _retiredTimers);
+        merge(table->counters, _retiredCounters);
+        _tables.erase(std::find(_tables.begin(), _tables.end(), table));
+    }
+
+    Instrumentation::EntryMap collect(bool timers) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Instrumentation::EntryMap result = timers ? _retiredTimers : _retiredCounters;
+        for (ThreadTable* table : _tables) {
+            std::lock_guard<std::mutex> tableLock(table->mutex);
+            merge(timers ? table->timers : table->counters, result);
+        }
+        return result;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _retiredTimers.clear();
+        _retiredCounters.clear();
+        for (ThreadTable* table : _tables) {
+            std::lock_guard<std::mutex> tableLock(table->mutex);
+            table->timers.clear();
+            table->counters.clear();
+        }
+    }
+
+private:
+    Registry() = default;
+
+    std::mutex _mutex;
+    std::vector<ThreadTable*> _tables;
+    Instrumentation::EntryMap _retiredTimers;
+    Instrumentation::EntryMap _retiredCounters;
+};
+
+/*
+ * Registers a thread's table on first use, and merges it into the retired tables when the thread exits
+ */
+class ThreadTableHolder {
+public:
+    ThreadTableHolder() { Registry::get().add(&_table); }
+    ~ThreadTableHolder() { Registry::get().retire(&_table); }
+
+    ThreadTable& getTable() { return _table; }
+
+private:
+    ThreadTable _table;
+};
+
+ThreadTable& getThreadTable() {
+    thread_local ThreadTableHolder holder;
+    return holder.getTable();
+}
+
+}  // namespace
+
+std::atomic<bool> Instrumentation::_enabled(false);
+
+bool Instrumentation::isCompiled() {
+#ifndef LSST_MEAS_ALGORITHMS_NO_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+Instrumentation::EntryMap Instrumentation::getTimers() { return Registry::get().collect(true); }
+
+Instrumentation::EntryMap Instrumentation::getCounters() { return Registry::get().collect(false); }
+
+void Instrumentation::reset() { Registry::get().reset(); }
+
+void Instrumentation::addTime(char const* name, double seconds) {
+    ThreadTable& table = getThreadTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    accumulate(table.timers, name, seconds);
+}
+
+void Instrumentation::addCount(char const* name, double value) {
+    ThreadTable& table = getThreadTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    accumulate(table.counters, name, value);
+}
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
@@ -32,112 +32,153 @@
 #include <stdexcept>
 #include <algorithm>
 #include <cassert>
+#include <exception>
 #include <string>
+#include <thread>
 #include <typeinfo>
 #include <limits>
+#include <numeric>
 #include "boost/format.hpp"
 
 #include "lsst/geom.h"
 #include "lsst/pex/exceptions.h"
+#include "lsst/afw/detection/Footprint.h"
 #include "lsst/afw/image/MaskedImage.h"
+#include "lsst/meas/algorithms/Instrumentation.h"
 #include "lsst/meas/algorithms/Interp.h"
+#include "lsst/meas/algorithms/SpanComponents.h"
 
 namespace lsst {
 namespace meas {
 namespace algorithms {
 
-typedef std::vector<Defect::Ptr>::const_iterator DefectCIter;
+namespace {
+/*
+ * A range of bad columns, [x0, x1]
+ */
+struct ColumnRange {
+    int x0;
+    int x1;
+};
+
+/*
+ * A run of bad pixels within a single row, classified as described above do_defect
+ */
+typedef CompiledDefectMap::Run DefectRun;
 
-/************************************************************************************************************/
 /*
- * Classify an vector of Defect::Ptr for the given row, returning a vector of 1-D
- * Defects (i.e. y0 == y1).  In general we can merge in saturated pixels at
- * this step, although we don't currently do so.
+ * The column ranges of the defects touching each row of an image, stored in one flat array
  *
- * See comment above do_defects for a description of how to interpret DefectType
+ * The defects touching row y are [begin(y), end(y)), in the order in which they were given (i.e.
+ * sorted by their left edges); building the index costs one visit to each row a defect spans, so
+ * the work per row is proportional to the number of defects that touch it.
  */
-static std::vector<Defect::Ptr> classify_defects(
-        std::vector<Defect::Ptr> const &badList,  // list of bad things
-        int const y,                              // the row to process
-        int const ncol,                           // number of columns in image
-        int = 0                                   // number of rows in image
-) {
-    std::vector<Defect::Ptr> badList1D;
+class RowDefectIndex {
+public:
+    RowDefectIndex(std::vector<geom::BoxI> const &boxes,  // defects, sorted by their left edges
+                   int const nrow                         // number of rows in image
+                   )
+            : _offsets(nrow + 1, 0) {
+        for (auto const &box : boxes) {
+            for (int y = std::max(box.getMinY(), 0), y1 = std::min(box.getMaxY(), nrow - 1); y <= y1; ++y) {
+                ++_offsets[y + 1];
+            }
+        }
+        std::partial_sum(_offsets.begin(), _offsets.end(), _offsets.begin());
+
+        _ranges.resize(_offsets.back());
+        std::vector<std::size_t> next(_offsets.begin(), _offsets.end() - 1);  // next free slot in each row
+        for (auto const &box : boxes) {
+            ColumnRange const range = {box.getMinX(), box.getMaxX()};
+            for (int y = std::max(box.getMinY(), 0), y1 = std::min(box.getMaxY(), nrow - 1); y <= y1; ++y) {
+                _ranges[next[y]++] = range;
+            }
+        }
+    }
 
-    for (DefectCIter begin = badList.begin(), end = badList.end(), bri = begin; bri != end; ++bri) {
-        Defect::Ptr defect = *bri;
+    ColumnRange const *begin(int y) const { return _ranges.data() + _offsets[y]; }
+    ColumnRange const *end(int y) const { return _ranges.data() + _offsets[y + 1]; }
 
-        if (y < defect->getY0() || y > defect->getY1() || ncol < defect->getX0()) {
-            continue;
-        }
+private:
+    std::vector<std::size_t> _offsets;  // start of each row's ranges in _ranges
+    std::vector<ColumnRange> _ranges;   // ranges touching each row, row by row
+};
+}  // namespace
 
-        int const x0 = defect->getX0();
-        int x1 = defect->getX1();
+/************************************************************************************************************/
+/*
+ * Classify the defects touching a row (sorted by their left edges), returning merged 1-D runs in runs.
+ * In general we can merge in saturated pixels at this step, although we don't currently do so.
+ *
+ * See comment above do_defect for a description of how to interpret DefectType
+ */
+static void classify_defects(ColumnRange const *const rowBegin,  // defects touching this row
+                             ColumnRange const *const rowEnd,    //    (end)
+                             int const ncol,                     // number of columns in image
+                             std::vector<DefectRun> &runs        // the classified runs
+) {
+    runs.clear();
+
+    for (ColumnRange const *bri = rowBegin; bri != rowEnd; ++bri) {
+        int const x0 = bri->x0;
+        int x1 = bri->x1;
         //
-        // Look for other defects that touch this one, and push them onto badList1d
+        // Look for other defects that touch this one, and merge them into this run
         //
-        for (++bri; bri != end; ++bri) {
-            defect = *bri;
-
-            if (y < defect->getY0() || y > defect->getY1()) {  // this defect doesn't concern this row
-                continue;
-            }
-            if (x1 < defect->getX0() - 1) {  // no further defects can touch this one
+        for (++bri; bri != rowEnd; ++bri) {
+            if (x1 < bri->x0 - 1) {  // no further defects can touch this one
                 --bri;
                 break;
             }
-            if (defect->getX1() > x1) {
-                x1 = defect->getX1();
+            if (bri->x1 > x1) {
+                x1 = bri->x1;
             }
         }
 
-        int const nbad = x1 - x0 + 1;
-        assert(nbad >= 1);
-
-        defect = Defect::Ptr(new Defect(geom::BoxI(geom::Point2I(x0, y), geom::Extent2I(nbad, 1))));
-        badList1D.push_back(defect);
+        assert(x1 - x0 + 1 >= 1);
+        runs.emplace_back(x0, x1);
 
-        if (bri == end) {
+        if (bri == rowEnd) {
             break;
         }
     }
     //
-    // Now process our new list
+    // Now classify the runs
     //
-    for (DefectCIter begin = badList1D.begin(), end = badList1D.end(), bri = begin; bri != end; ++bri) {
-        Defect::Ptr defect = *bri;
+    for (auto begin = runs.begin(), end = runs.end(), bri = begin; bri != end; ++bri) {
+        DefectRun &defect = *bri;
 
-        int const nbad = defect->getX1() - defect->getX0() + 1;
+        int const nbad = defect.getX1() - defect.getX0() + 1;
         assert(nbad >= 1);
 
-        if (defect->getX0() == 0) {
+        if (defect.getX0() == 0) {
             if (nbad >= Defect::WIDE_DEFECT) {
-                defect->classify(Defect::WIDE_LEFT, 03);
+                defect.classify(Defect::WIDE_LEFT, 03);
             } else {
-                defect->classify(Defect::LEFT, 03 << nbad);
+                defect.classify(Defect::LEFT, 03 << nbad);
             }
-        } else if (defect->getX0() == 1) { /* only second column is usable */
+        } else if (defect.getX0() == 1) { /* only second column is usable */
             if (nbad >= Defect::WIDE_DEFECT) {
-                defect->classify(Defect::WIDE_NEAR_LEFT, (01 << 2) | 03);
+                defect.classify(Defect::WIDE_NEAR_LEFT, (01 << 2) | 03);
             } else {
-                defect->classify(Defect::NEAR_LEFT, (01 << (nbad + 2)) | 03);
+                defect.classify(Defect::NEAR_LEFT, (01 << (nbad + 2)) | 03);
             }
-        } else if (defect->getX1() == ncol - 2) { /* use only penultimate column */
+        } else if (defect.getX1() == ncol - 2) { /* use only penultimate column */
             if (nbad >= Defect::WIDE_DEFECT) {
-                defect->classify(Defect::WIDE_NEAR_RIGHT, (03 << 2) | 02);
+                defect.classify(Defect::WIDE_NEAR_RIGHT, (03 << 2) | 02);
             } else {
-                defect->classify(Defect::NEAR_RIGHT, (03 << (nbad + 2)) | 02);
+                defect.classify(Defect::NEAR_RIGHT, (03 << (nbad + 2)) | 02);
             }
-        } else if (defect->getX1() == ncol - 1) {
+        } else if (defect.getX1() == ncol - 1) {
             if (nbad >= Defect::WIDE_DEFECT) {
-                defect->classify(Defect::WIDE_RIGHT, 03);
+                defect.classify(Defect::WIDE_RIGHT, 03);
             } else {
-                defect->classify(Defect::RIGHT, 03 << nbad);
+                defect.classify(Defect::RIGHT, 03 << nbad);
             }
         } else if (nbad >= Defect::WIDE_DEFECT) {
-            defect->classify(Defect::WIDE, (03 << 2) | 03);
+            defect.classify(Defect::WIDE, (03 << 2) | 03);
         } else {
-            defect->classify(Defect::MIDDLE, (03 << (nbad + 2)) | 03);
+            defect.classify(Defect::MIDDLE, (03 << (nbad + 2)) | 03);
         }
         /*
          * look for bad columns in regions that we'll get `good' values from.
@@ -145,7 +186,7 @@ static std::vector<Defect::Ptr> classify_defects(
          * We know that no two Defects are adjacent.
          */
         int nshift = 0;  // number of bits to shift to get to left edge of defect pattern
-        switch (defect->getPos()) {
+        switch (defect.getPos()) {
             case Defect::WIDE:             // no bits
             case Defect::WIDE_NEAR_LEFT:   //       are used to encode
             case Defect::WIDE_NEAR_RIGHT:  //            the bad section of data
@@ -157,34 +198,197 @@ static std::vector<Defect::Ptr> classify_defects(
         }
 
         if (bri != begin) {
-            Defect::Ptr const defect_m = *(bri - 1);
-            assert(defect_m->getX1() < defect->getX0());
+            DefectRun const &defect_m = *(bri - 1);
+            assert(defect_m.getX1() < defect.getX0());
 
-            if (defect_m->getX1() == defect->getX0() - 2) {
-                defect->classify(defect->getPos(), (defect->getType() & ~(02 << (nshift + 2))));
+            if (defect_m.getX1() == defect.getX0() - 2) {
+                defect.classify(defect.getPos(), (defect.getType() & ~(02 << (nshift + 2))));
             }
         }
 
         if (bri + 1 != end) {
-            Defect::Ptr const defect_p = *(bri + 1);
+            DefectRun const &defect_p = *(bri + 1);
 
-            if (defect->getX1() == defect_p->getX0() - 2) {
-                Defect::DefectPosition defectPos = defect->getPos();
+            if (defect.getX1() == defect_p.getX0() - 2) {
+                Defect::DefectPosition defectPos = defect.getPos();
                 if (defectPos == Defect::LEFT || defectPos == Defect::NEAR_LEFT) {
-                    defect->classify(defect->getPos(), (defect->getType() & ~(02 << nshift)));
+                    defect.classify(defect.getPos(), (defect.getType() & ~(02 << nshift)));
                 } else {
-                    defect->classify(defectPos, (defect->getType() & ~01));
+                    defect.classify(defectPos, (defect.getType() & ~01));
                 }
             }
         }
     }
 
-    return badList1D;
 }
 
+namespace {
+/*
+ * Defects no wider than this with good pixels on both sides (DefectPosition MIDDLE, NEAR_LEFT or
+ * NEAR_RIGHT) are interpolated by kernels specialized on their width and neighbours, rather than by the
+ * general switch in do_defect; most bad columns are this narrow.
+ */
+constexpr int NARROW_DEFECT_MAX = 4;
+
+/*
+ * The coefficients of out[badX0 - 2], out[badX0 - 1], out[badX1 + 1] and out[badX1 + 2] for each pixel
+ * of a narrow defect, copied from the MIDDLE cases of do_defect
+ */
+struct NarrowInterpolant {
+    double coeffs[NARROW_DEFECT_MAX][4];
+};
+
+/*
+ * Index into NARROW_INTERPOLANTS; leftPair (rightPair) is true if out[badX0 - 2] (out[badX1 + 2]) is good
+ */
+constexpr int narrowIndex(int const nbad, bool const leftPair, bool const rightPair) {
+    return 4 * (nbad - 1) + 2 * leftPair + rightPair;
+}
+
+constexpr NarrowInterpolant NARROW_INTERPOLANTS[4 * NARROW_DEFECT_MAX] = {
+        {{{0.0, 0.5000, 0.5000, 0.0}}},                   // 012: #.#.
+        {{{0.0, 0.4875, 0.8959, -0.3834}}},               // 013: #.##
+        {{{-0.3834, 0.8959, 0.4875, 0.0}}},               // 032: ##.#.
+        {{{-0.2737, 0.7737, 0.7737, -0.2737}}},           // 033: ##.##
+        {{{0.0, 0.7297, 0.2703, 0.0},                     // 022: #..#.
+          {0.0, 0.2703, 0.7297, 0.0}}},
+        {{{0.0, 0.7538, 0.5680, -0.3218},                 // 023: #..##
+          {0.0, 0.3095, 1.2132, -0.5227}}},
+        {{{-0.5227, 1.2132, 0.3095, 0.0},                 // 062: ##..#.
+          {-0.3218, 0.5680, 0.7538, 0.0}}},
+        {{{-0.4793, 1.1904, 0.5212, -0.2323},             // 063: ##..##
+          {-0.2323, 0.5212, 1.1904, -0.4793}}},
+        {{{0.0, 0.8430, 0.1570, 0.0},                     // 042: #...#.
+          {0.0, 0.5000, 0.5000, 0.0},
+          {0.0, 0.1570, 0.8430, 0.0}}},
+        {{{0.0, 0.8525, 0.2390, -0.0915},                 // 043: #...##
+          {0.0, 0.5356, 0.8057, -0.3413},
+          {0.0, 0.2120, 1.3150, -0.5270}}},
+        {{{-0.5270, 1.3150, 0.2120, 0.0},                 // 0142: ##...#.
+          {-0.3413, 0.8057, 0.5356, 0.0},
+          {-0.0915, 0.2390, 0.8525, 0.0}}},
+        {{{-0.5230, 1.3163, 0.2536, -0.0469},             // 0143: ##...##
+          {-0.3144, 0.8144, 0.8144, -0.3144},
+          {-0.0469, 0.2536, 1.3163, -0.5230}}},
+        {{{0.0, 0.8810, 0.1190, 0.0},                     // 0102: #....#.
+          {0.0, 0.6315, 0.3685, 0.0},
+          {0.0, 0.3685, 0.6315, 0.0},
+          {0.0, 0.1190, 0.8810, 0.0}}},
+        {{{0.0, 0.8779, 0.0945, 0.0276},                  // 0103: #....##
+          {0.0, 0.6327, 0.3779, -0.0106},
+          {0.0, 0.4006, 0.8914, -0.2920},
+          {0.0, 0.1757, 1.3403, -0.5160}}},
+        {{{-0.5160, 1.3403, 0.1757, 0.0},                 // 0302: ##....#.
+          {-0.2920, 0.8914, 0.4006, 0.0},
+          {-0.0106, 0.3779, 0.6327, 0.0},
+          {0.0276, 0.0945, 0.8779, 0.0}}},
+        {{{-0.5197, 1.3370, 0.1231, 0.0596},              // 0303: ##....##
+          {-0.2924, 0.8910, 0.3940, 0.0074},
+          {0.0074, 0.3940, 0.8910, -0.2924},
+          {0.0596, 0.1231, 1.3370, -0.5197}}},
+};
+
+/*
+ * Interpolate over a defect of NBad pixels starting at badX0.  The loop has a fixed trip count and the
+ * coefficients are compile-time constants, so this compiles to straight-line code.
+ *
+ * The arithmetic is that of the corresponding case of do_defect's switch term by term, so the results are
+ * identical; in particular "#..#." clips to zero rather than to the mean of its neighbours.
+ */
+template <typename ImageT, int NBad, bool LeftPair, bool RightPair>
+void narrowDefectKernel(typename ImageT::x_iterator out, int const badX0, typename ImageT::Pixel const min) {
+    typedef typename ImageT::Pixel ImagePixel;
+    double const(&coeffs)[NARROW_DEFECT_MAX][4] =
+            NARROW_INTERPOLANTS[narrowIndex(NBad, LeftPair, RightPair)].coeffs;
+    bool const clipToZero = (NBad == 2 && !LeftPair && !RightPair);
+
+    ImagePixel const out1_2 = LeftPair ? out[badX0 - 2] : 0;
+    ImagePixel const out1_1 = out[badX0 - 1];
+    ImagePixel const out2_1 = out[badX0 + NBad];
+    ImagePixel const out2_2 = RightPair ? out[badX0 + NBad + 1] : 0;
+
+    for (int i = 0; i < NBad; ++i) {
+        double sum = LeftPair ? coeffs[i][0] * out1_2 + coeffs[i][1] * out1_1 : coeffs[i][1] * out1_1;
+        sum += coeffs[i][2] * out2_1;
+        if (RightPair) {
+            sum += coeffs[i][3] * out2_2;
+        }
+        ImagePixel const val = sum;
+        if (clipToZero) {
+            out[badX0 + i] = (val < 0) ? 0 : val;
+        } else {
+            out[badX0 + i] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+        }
+    }
+}
+
+template <typename ImageT, int NBad>
+void narrowDefectKernel(typename ImageT::x_iterator out, int const badX0, typename ImageT::Pixel const min,
+                        bool const leftPair, bool const rightPair) {
+    if (leftPair) {
+        if (rightPair) {
+            narrowDefectKernel<ImageT, NBad, true, true>(out, badX0, min);
+        } else {
+            narrowDefectKernel<ImageT, NBad, true, false>(out, badX0, min);
+        }
+    } else {
+        if (rightPair) {
+            narrowDefectKernel<ImageT, NBad, false, true>(out, badX0, min);
+        } else {
+            narrowDefectKernel<ImageT, NBad, false, false>(out, badX0, min);
+        }
+    }
+}
+
+/*
+ * Interpolate over a defect using one of the narrow kernels, returning false (and leaving the row
+ * untouched) if it isn't narrow or doesn't have good pixels on both sides
+ */
+template <typename ImageT>
+bool interpolateNarrowDefect(Defect::DefectPosition const defectPos, unsigned int const defectType,
+                             int const badX0, int const nbad, typename ImageT::x_iterator out,
+                             typename ImageT::Pixel const min) {
+    if (nbad > NARROW_DEFECT_MAX ||
+        (defectPos != Defect::MIDDLE && defectPos != Defect::NEAR_LEFT && defectPos != Defect::NEAR_RIGHT)) {
+        return false;
+    }
+    unsigned int const left = defectType >> (nbad + 2);  // 01 for .#, 03 for ##
+    unsigned int const right = defectType & 03;          // 02 for #., 03 for ##
+    if ((left != 01 && left != 03) || (right != 02 && right != 03) ||
+        defectType != ((left << (nbad + 2)) | right)) {
+        return false;
+    }
+    bool const leftPair = (left == 03);
+    bool const rightPair = (right == 03);
+    // Defects moved away from the edge by useFallbackValueAtEdge can claim a pair of good pixels beyond
+    // the edge; leave them to do_defect, which uses -1 for the missing pixel
+    if ((leftPair && defectPos == Defect::NEAR_LEFT) || (rightPair && defectPos == Defect::NEAR_RIGHT)) {
+        return false;
+    }
+
+    switch (nbad) {
+        case 1:
+            narrowDefectKernel<ImageT, 1>(out, badX0, min, leftPair, rightPair);
+            break;
+        case 2:
+            narrowDefectKernel<ImageT, 2>(out, badX0, min, leftPair, rightPair);
+            break;
+        case 3:
+            narrowDefectKernel<ImageT, 3>(out, badX0, min, leftPair, rightPair);
+            break;
+        case 4:
+            narrowDefectKernel<ImageT, 4>(out, badX0, min, leftPair, rightPair);
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+}  // namespace
+
 /*****************************************************************************/
 /*
- * Interpolate over the defects in a given line of data. In the comments,
+ * Interpolate over a defect in a given line of data. In the comments,
  * a bad pixel is written as ., a good one as #, and unknown but non-interpolated pixels as ?.
  *
  * This may be mapped to an int by replacing # with 1 and . or ? with 0.  So "##..##" would mean, "I have two
@@ -199,1831 +403,1834 @@ static std::vector<Defect::Ptr> classify_defects(
  * written as 110000 not 000011).
  */
 template <typename ImageT>
-static void do_defects(std::vector<Defect::Ptr> const &badList,  // list of bad things
-                       int const y,                              // Row that we should fix
-                       ImageT &data,                             // data to fix
-                       typename ImageT::Pixel min,               // minimum acceptable value
-                       double fallbackValue,                     // Value to fallback to if all else fails
-                       bool useFallbackValueAtEdge,              // use fallbackValue at edge of chip?
-                       int nUseInterp                            // no. of pixels to interpolate towards edge
+static void do_defect(DefectRun const &defect,          // the bad run to fix
+                      typename ImageT::x_iterator out,  // the row containing it
+                      int const ncol,                   // number of columns in the row
+                      typename ImageT::Pixel min,       // minimum acceptable value
+                      double fallbackValue,             // Value to fallback to if all else fails
+                      bool useFallbackValueAtEdge,      // use fallbackValue at edge of chip?
+                      int nUseInterp                    // no. of pixels to interpolate towards edge
 ) {
     typedef typename ImageT::Pixel ImagePixel;
     ImagePixel out1_2, out1_1, out2_1, out2_2;  // == out[badX1-2], ..., out[bad_x2+2]
     ImagePixel val;                             // unpack a pixel value
-    //
-    // Get pointer to this row of data
-    //
-    int const ncol = data.getWidth();
-    typename ImageT::x_iterator out = data.row_begin(y);
 
-    for (DefectCIter ptr = badList.begin(), end = badList.end(); ptr != end; ++ptr) {
-        Defect::Ptr const defect = *ptr;
+    int badX0 = defect.getX0();
+    int badX1 = defect.getX1();
 
-        if (y < defect->getY0() || y > defect->getY1()) {
-            continue;
-        }
+    Defect::DefectPosition defectPos = defect.getPos();
+    unsigned int defectType = defect.getType();
 
-        int badX0 = defect->getX0();
-        int badX1 = defect->getX1();
+    int nbad = badX1 - badX0 + 1;
 
-        Defect::DefectPosition defectPos = defect->getPos();
-        unsigned int defectType = defect->getType();
+    if (nbad > nUseInterp && useFallbackValueAtEdge) {
+        switch (defectPos) {
+            case Defect::LEFT:
+            case Defect::WIDE_LEFT:
+                assert(badX0 == 0);
 
-        int nbad = badX1 - badX0 + 1;
+                if (badX1 == ncol - 1) {  // also RIGHT --- spans the entire image
+                    for (int i = 0; i != ncol; ++i) {
+                        out[i] = fallbackValue;
+                    }
+                    return;
+                }
 
-        if (nbad > nUseInterp && useFallbackValueAtEdge) {
-            switch (defectPos) {
-                case Defect::LEFT:
-                case Defect::WIDE_LEFT:
-                    assert(badX0 == 0);
+                for (; badX0 <= badX1 - nUseInterp; ++badX0) {
+                    out[badX0] = fallbackValue;
+                }
 
-                    if (badX1 == ncol - 1) {  // also RIGHT --- spans the entire image
-                        for (int i = 0; i != ncol; ++i) {
-                            out[i] = fallbackValue;
-                        }
-                        continue;
+                if (defectPos == Defect::LEFT) {
+                    defectType >>= nbad;  // we just want the last 2 bits
+                    switch (defectType) {
+                        case 01:
+                            defectType = 02;
+                            break;
+                        case 03:
+                            defectType = 03;
+                            break;
+                        default:
+                            throw std::runtime_error(str(
+                                    boost::format("Impossible value of defectType: 0%o") % defectType));
                     }
+                }
+                nbad = badX1 - badX0 + 1;
+                defectType = (03 << (nbad + 2)) | defectType;
+                defectPos = (badX0 > 1) ? ((badX1 < ncol - 2) ? Defect::MIDDLE : Defect::NEAR_RIGHT)
+                                        : Defect::NEAR_LEFT;
+                break;
+            case Defect::RIGHT:
+            case Defect::WIDE_RIGHT:
+                assert(badX1 == ncol - 1);
+                for (; badX1 >= badX0 + nUseInterp; --badX1) {
+                    out[badX1] = fallbackValue;
+                }
+                nbad = badX1 - badX0 + 1;
+                defectType = (03 << (nbad + 2)) | 03;
+                defectPos = (badX1 < ncol - 2) ? Defect::MIDDLE : Defect::NEAR_RIGHT;
+                break;
+            default:
+                break;
+        }
+    }
 
-                    for (; badX0 <= badX1 - nUseInterp; ++badX0) {
-                        out[badX0] = fallbackValue;
-                    }
+    if (interpolateNarrowDefect<ImageT>(defectPos, defectType, badX0, nbad, out, min)) {
+        return;
+    }
+
+    switch (defectPos) {
+        case Defect::LEFT:
+            assert(badX0 >= 0 && badX1 + 2 < ncol);
+
+            out2_1 = out[badX1 + 1];
+            out2_2 = out[badX1 + 2];
+
+            switch (defectType) {
+                case 02: /* .#?, <noise^2> = 0 */
+                    val = 1.0000 * out2_1;
+                    out[badX1] = (val < min) ? out2_1 : val;
 
-                    if (defectPos == Defect::LEFT) {
-                        defectType >>= nbad;  // we just want the last 2 bits
-                        switch (defectType) {
-                            case 01:
-                                defectType = 02;
-                                break;
-                            case 03:
-                                defectType = 03;
-                                break;
-                            default:
-                                throw std::runtime_error(str(
-                                        boost::format("Impossible value of defectType: 0%o") % defectType));
-                        }
-                    }
-                    nbad = badX1 - badX0 + 1;
-                    defectType = (03 << (nbad + 2)) | defectType;
-                    defectPos = (badX0 > 1) ? ((badX1 < ncol - 2) ? Defect::MIDDLE : Defect::NEAR_RIGHT)
-                                            : Defect::NEAR_LEFT;
-                    break;
-                case Defect::RIGHT:
-                case Defect::WIDE_RIGHT:
-                    assert(badX1 == ncol - 1);
-                    for (; badX1 >= badX0 + nUseInterp; --badX1) {
-                        out[badX1] = fallbackValue;
-                    }
-                    nbad = badX1 - badX0 + 1;
-                    defectType = (03 << (nbad + 2)) | 03;
-                    defectPos = (badX1 < ncol - 2) ? Defect::MIDDLE : Defect::NEAR_RIGHT;
                     break;
-                default:
+                case 06: /* .##, <noise^2> = 0 */
+                    val = 1.4288 * out2_1 - 0.4288 * out2_2;
+                    out[badX1] = (val < min) ? out2_1 : val;
+
                     break;
-            }
-        }
+                case 014: /* ..##, <noise^2> = 0 */
+                    val = 1.0933 * out2_1 - 0.0933 * out2_2;
+                    out[badX0] = (val < min) ? out2_1 : val;
 
-        switch (defectPos) {
-            case Defect::LEFT:
-                assert(badX0 >= 0 && badX1 + 2 < ncol);
+                    val = 1.4288 * out2_1 - 0.4288 * out2_2;
+                    out[badX1] = (val < min) ? out2_1 : val;
 
-                out2_1 = out[badX1 + 1];
-                out2_2 = out[badX1 + 2];
+                    break;
+                case 04: /* ..#?, <noise^2> = 0 */
+                    val = 1.000 * out2_1;
+                    out[badX0] = (val < min) ? out2_1 : val;
+                    out[badX1] = (val < min) ? out2_1 : val;
 
-                switch (defectType) {
-                    case 02: /* .#?, <noise^2> = 0 */
-                        val = 1.0000 * out2_1;
-                        out[badX1] = (val < min) ? out2_1 : val;
+                    break;
+                case 030: /* ...##, <noise^2> = 0 */
+                    val = 0.6968 * out2_1 + 0.3032 * out2_2;
+                    out[badX0] = (val < min) ? out2_1 : val;
 
-                        break;
-                    case 06: /* .##, <noise^2> = 0 */
-                        val = 1.4288 * out2_1 - 0.4288 * out2_2;
-                        out[badX1] = (val < min) ? out2_1 : val;
+                    val = 1.0933 * out2_1 - 0.0933 * out2_2;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
 
-                        break;
-                    case 014: /* ..##, <noise^2> = 0 */
-                        val = 1.0933 * out2_1 - 0.0933 * out2_2;
-                        out[badX0] = (val < min) ? out2_1 : val;
+                    val = 1.4288 * out2_1 - 0.4288 * out2_2;
+                    out[badX1] = (val < min) ? out2_1 : val;
 
-                        val = 1.4288 * out2_1 - 0.4288 * out2_2;
-                        out[badX1] = (val < min) ? out2_1 : val;
+                    break;
+                case 010: /* ...#?, <noise^2> = 0 */
+                    val = 1.000 * out2_1;
 
-                        break;
-                    case 04: /* ..#?, <noise^2> = 0 */
-                        val = 1.000 * out2_1;
-                        out[badX0] = (val < min) ? out2_1 : val;
-                        out[badX1] = (val < min) ? out2_1 : val;
+                    out[badX0] = (val < min) ? out2_1 : val;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
+                    out[badX1] = (val < min) ? out2_1 : val;
 
-                        break;
-                    case 030: /* ...##, <noise^2> = 0 */
-                        val = 0.6968 * out2_1 + 0.3032 * out2_2;
-                        out[badX0] = (val < min) ? out2_1 : val;
+                    break;
+                case 060: /* ....##, <noise^2> = 0 */
+                    val = 0.5370 * out2_1 + 0.4630 * out2_2;
+                    out[badX0] = (val < min) ? out2_1 : val;
 
-                        val = 1.0933 * out2_1 - 0.0933 * out2_2;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
+                    val = 0.6968 * out2_1 + 0.3032 * out2_2;
+                    out[badX0 + 1] = (val < min) ? out2_1 : val;
 
-                        val = 1.4288 * out2_1 - 0.4288 * out2_2;
-                        out[badX1] = (val < min) ? out2_1 : val;
+                    val = 1.0933 * out2_1 - 0.0933 * out2_2;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
 
-                        break;
-                    case 010: /* ...#?, <noise^2> = 0 */
-                        val = 1.000 * out2_1;
+                    val = 1.4288 * out2_1 - 0.4288 * out2_2;
+                    out[badX1] = (val < min) ? out2_1 : val;
 
-                        out[badX0] = (val < min) ? out2_1 : val;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
-                        out[badX1] = (val < min) ? out2_1 : val;
+                    break;
+                case 020: /* ....#?, <noise^2> = 0 */
+                    val = 1.0000 * out2_1;
 
-                        break;
-                    case 060: /* ....##, <noise^2> = 0 */
-                        val = 0.5370 * out2_1 + 0.4630 * out2_2;
-                        out[badX0] = (val < min) ? out2_1 : val;
+                    out[badX0] = (val < min) ? out2_1 : val;
+                    out[badX0 + 1] = (val < min) ? out2_1 : val;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
+                    out[badX1] = (val < min) ? out2_1 : val;
 
-                        val = 0.6968 * out2_1 + 0.3032 * out2_2;
-                        out[badX0 + 1] = (val < min) ? out2_1 : val;
+                    break;
+                case 0140: /* .....##, <noise^2> = 0 */
+                    val = 0.5041 * out2_1 + 0.4959 * out2_2;
+                    out[badX0] = (val < min) ? out2_1 : val;
 
-                        val = 1.0933 * out2_1 - 0.0933 * out2_2;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
+                    val = 0.5370 * out2_1 + 0.4630 * out2_2;
+                    out[badX0 + 1] = (val < min) ? out2_1 : val;
 
-                        val = 1.4288 * out2_1 - 0.4288 * out2_2;
-                        out[badX1] = (val < min) ? out2_1 : val;
+                    val = 0.6968 * out2_1 + 0.3032 * out2_2;
+                    out[badX1 - 2] = (val < min) ? out2_1 : val;
 
-                        break;
-                    case 020: /* ....#?, <noise^2> = 0 */
-                        val = 1.0000 * out2_1;
-
-                        out[badX0] = (val < min) ? out2_1 : val;
-                        out[badX0 + 1] = (val < min) ? out2_1 : val;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
-                        out[badX1] = (val < min) ? out2_1 : val;
+                    val = 1.0933 * out2_1 - 0.0933 * out2_2;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
 
-                        break;
-                    case 0140: /* .....##, <noise^2> = 0 */
-                        val = 0.5041 * out2_1 + 0.4959 * out2_2;
-                        out[badX0] = (val < min) ? out2_1 : val;
+                    val = 1.4288 * out2_1 - 0.4288 * out2_2;
+                    out[badX1] = (val < min) ? out2_1 : val;
 
-                        val = 0.5370 * out2_1 + 0.4630 * out2_2;
-                        out[badX0 + 1] = (val < min) ? out2_1 : val;
+                    break;
+                case 040: /* .....#?, <noise^2> = 0 */
+                    val = 1.0000 * out2_1;
+                    out[badX0] = (val < min) ? out2_1 : val;
+                    out[badX0 + 1] = (val < min) ? out2_1 : val;
+                    out[badX1 - 2] = (val < min) ? out2_1 : val;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
+                    out[badX1] = (val < min) ? out2_1 : val;
 
-                        val = 0.6968 * out2_1 + 0.3032 * out2_2;
-                        out[badX1 - 2] = (val < min) ? out2_1 : val;
+                    break;
+                case 0300: /* ......##, <noise^2> = 0 */
+                    val = 0.5003 * out2_1 + 0.4997 * out2_2;
+                    out[badX0] = (val < min) ? out2_1 : val;
 
-                        val = 1.0933 * out2_1 - 0.0933 * out2_2;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
+                    val = 0.5041 * out2_1 + 0.4959 * out2_2;
+                    out[badX0 + 1] = (val < min) ? out2_1 : val;
 
-                        val = 1.4288 * out2_1 - 0.4288 * out2_2;
-                        out[badX1] = (val < min) ? out2_1 : val;
+                    val = 0.5370 * out2_1 + 0.4630 * out2_2;
+                    out[badX0 + 2] = (val < min) ? out2_1 : val;
 
-                        break;
-                    case 040: /* .....#?, <noise^2> = 0 */
-                        val = 1.0000 * out2_1;
-                        out[badX0] = (val < min) ? out2_1 : val;
-                        out[badX0 + 1] = (val < min) ? out2_1 : val;
-                        out[badX1 - 2] = (val < min) ? out2_1 : val;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
-                        out[badX1] = (val < min) ? out2_1 : val;
-
-                        break;
-                    case 0300: /* ......##, <noise^2> = 0 */
-                        val = 0.5003 * out2_1 + 0.4997 * out2_2;
-                        out[badX0] = (val < min) ? out2_1 : val;
-
-                        val = 0.5041 * out2_1 + 0.4959 * out2_2;
-                        out[badX0 + 1] = (val < min) ? out2_1 : val;
-
-                        val = 0.5370 * out2_1 + 0.4630 * out2_2;
-                        out[badX0 + 2] = (val < min) ? out2_1 : val;
-
-                        val = 0.6968 * out2_1 + 0.3032 * out2_2;
-                        out[badX1 - 2] = (val < min) ? out2_1 : val;
-
-                        val = 1.0933 * out2_1 - 0.0933 * out2_2;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
+                    val = 0.6968 * out2_1 + 0.3032 * out2_2;
+                    out[badX1 - 2] = (val < min) ? out2_1 : val;
 
-                        val = 1.4288 * out2_1 - 0.4288 * out2_2;
-                        out[badX1] = (val < min) ? out2_1 : val;
+                    val = 1.0933 * out2_1 - 0.0933 * out2_2;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
 
-                        break;
-                    case 0100: /* ......#?, <noise^2> = 0 */
-                        val = 1.0000 * out2_1;
+                    val = 1.4288 * out2_1 - 0.4288 * out2_2;
+                    out[badX1] = (val < min) ? out2_1 : val;
 
-                        out[badX0] = (val < min) ? out2_1 : val;
-                        out[badX0 + 1] = (val < min) ? out2_1 : val;
-                        out[badX0 + 2] = (val < min) ? out2_1 : val;
-                        out[badX1 - 2] = (val < min) ? out2_1 : val;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
-                        out[badX1] = (val < min) ? out2_1 : val;
+                    break;
+                case 0100: /* ......#?, <noise^2> = 0 */
+                    val = 1.0000 * out2_1;
 
-                        break;
-                    case 0600: /* .......##, <noise^2> = 0 */
-                        val = 0.5000 * out2_1 + 0.5000 * out2_2;
-                        out[badX0] = (val < min) ? out2_1 : val;
+                    out[badX0] = (val < min) ? out2_1 : val;
+                    out[badX0 + 1] = (val < min) ? out2_1 : val;
+                    out[badX0 + 2] = (val < min) ? out2_1 : val;
+                    out[badX1 - 2] = (val < min) ? out2_1 : val;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
+                    out[badX1] = (val < min) ? out2_1 : val;
 
-                        val = 0.5003 * out2_1 + 0.4997 * out2_2;
-                        out[badX0 + 1] = (val < min) ? out2_1 : val;
+                    break;
+                case 0600: /* .......##, <noise^2> = 0 */
+                    val = 0.5000 * out2_1 + 0.5000 * out2_2;
+                    out[badX0] = (val < min) ? out2_1 : val;
 
-                        val = 0.5041 * out2_1 + 0.4959 * out2_2;
-                        out[badX0 + 2] = (val < min) ? out2_1 : val;
-
-                        val = 0.5370 * out2_1 + 0.4630 * out2_2;
-                        out[badX1 - 3] = (val < min) ? out2_1 : val;
-
-                        val = 0.6968 * out2_1 + 0.3032 * out2_2;
-                        out[badX1 - 2] = (val < min) ? out2_1 : val;
-
-                        val = 1.0933 * out2_1 - 0.0933 * out2_2;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
-
-                        val = 1.4288 * out2_1 - 0.4288 * out2_2;
-                        out[badX1] = (val < min) ? out2_1 : val;
-
-                        break;
-                    case 0200: /* .......#?, <noise^2> = 0 */
-                        val = 1.0000 * out2_1;
-                        out[badX0] = (val < min) ? out2_1 : val;
-                        out[badX0 + 1] = (val < min) ? out2_1 : val;
-                        out[badX0 + 2] = (val < min) ? out2_1 : val;
-                        out[badX1 - 3] = (val < min) ? out2_1 : val;
-                        out[badX1 - 2] = (val < min) ? out2_1 : val;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
-                        out[badX1] = (val < min) ? out2_1 : val;
+                    val = 0.5003 * out2_1 + 0.4997 * out2_2;
+                    out[badX0 + 1] = (val < min) ? out2_1 : val;
 
-                        break;
-                    case 01400: /* ........##, <noise^2> = 0 */
-                        val = 0.5000 * out2_1 + 0.5000 * out2_2;
-                        out[badX0] = (val < min) ? out2_1 : val;
-
-                        val = 0.5000 * out2_1 + 0.5000 * out2_2;
-                        out[badX0 + 1] = (val < min) ? out2_1 : val;
+                    val = 0.5041 * out2_1 + 0.4959 * out2_2;
+                    out[badX0 + 2] = (val < min) ? out2_1 : val;
 
-                        val = 0.5003 * out2_1 + 0.4997 * out2_2;
-                        out[badX0 + 2] = (val < min) ? out2_1 : val;
+                    val = 0.5370 * out2_1 + 0.4630 * out2_2;
+                    out[badX1 - 3] = (val < min) ? out2_1 : val;
 
-                        val = 0.5041 * out2_1 + 0.4959 * out2_2;
-                        out[badX0 + 3] = (val < min) ? out2_1 : val;
+                    val = 0.6968 * out2_1 + 0.3032 * out2_2;
+                    out[badX1 - 2] = (val < min) ? out2_1 : val;
 
-                        val = 0.5370 * out2_1 + 0.4630 * out2_2;
-                        out[badX1 - 3] = (val < min) ? out2_1 : val;
+                    val = 1.0933 * out2_1 - 0.0933 * out2_2;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
 
-                        val = 0.6968 * out2_1 + 0.3032 * out2_2;
-                        out[badX1 - 2] = (val < min) ? out2_1 : val;
+                    val = 1.4288 * out2_1 - 0.4288 * out2_2;
+                    out[badX1] = (val < min) ? out2_1 : val;
+
+                    break;
+                case 0200: /* .......#?, <noise^2> = 0 */
+                    val = 1.0000 * out2_1;
+                    out[badX0] = (val < min) ? out2_1 : val;
+                    out[badX0 + 1] = (val < min) ? out2_1 : val;
+                    out[badX0 + 2] = (val < min) ? out2_1 : val;
+                    out[badX1 - 3] = (val < min) ? out2_1 : val;
+                    out[badX1 - 2] = (val < min) ? out2_1 : val;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
+                    out[badX1] = (val < min) ? out2_1 : val;
+
+                    break;
+                case 01400: /* ........##, <noise^2> = 0 */
+                    val = 0.5000 * out2_1 + 0.5000 * out2_2;
+                    out[badX0] = (val < min) ? out2_1 : val;
+
+                    val = 0.5000 * out2_1 + 0.5000 * out2_2;
+                    out[badX0 + 1] = (val < min) ? out2_1 : val;
+
+                    val = 0.5003 * out2_1 + 0.4997 * out2_2;
+                    out[badX0 + 2] = (val < min) ? out2_1 : val;
+
+                    val = 0.5041 * out2_1 + 0.4959 * out2_2;
+                    out[badX0 + 3] = (val < min) ? out2_1 : val;
+
+                    val = 0.5370 * out2_1 + 0.4630 * out2_2;
+                    out[badX1 - 3] = (val < min) ? out2_1 : val;
+
+                    val = 0.6968 * out2_1 + 0.3032 * out2_2;
+                    out[badX1 - 2] = (val < min) ? out2_1 : val;
+
+                    val = 1.0933 * out2_1 - 0.0933 * out2_2;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
+
+                    val = 1.4288 * out2_1 - 0.4288 * out2_2;
+                    out[badX1] = (val < min) ? out2_1 : val;
+
+                    break;
+                case 0400: /* ........#?, <noise^2> = 0 */
+                    val = 1.0000 * out2_1;
+                    out[badX0] = (val < min) ? out2_1 : val;
+                    out[badX0 + 1] = (val < min) ? out2_1 : val;
+                    out[badX0 + 2] = (val < min) ? out2_1 : val;
+                    out[badX0 + 3] = (val < min) ? out2_1 : val;
+                    out[badX1 - 3] = (val < min) ? out2_1 : val;
+                    out[badX1 - 2] = (val < min) ? out2_1 : val;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
+                    out[badX1] = (val < min) ? out2_1 : val;
 
-                        val = 1.0933 * out2_1 - 0.0933 * out2_2;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
-
-                        val = 1.4288 * out2_1 - 0.4288 * out2_2;
-                        out[badX1] = (val < min) ? out2_1 : val;
-
-                        break;
-                    case 0400: /* ........#?, <noise^2> = 0 */
-                        val = 1.0000 * out2_1;
-                        out[badX0] = (val < min) ? out2_1 : val;
-                        out[badX0 + 1] = (val < min) ? out2_1 : val;
-                        out[badX0 + 2] = (val < min) ? out2_1 : val;
-                        out[badX0 + 3] = (val < min) ? out2_1 : val;
-                        out[badX1 - 3] = (val < min) ? out2_1 : val;
-                        out[badX1 - 2] = (val < min) ? out2_1 : val;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
-                        out[badX1] = (val < min) ? out2_1 : val;
-
-                        break;
-                    case 03000: /* .........##, <noise^2> = 0 */
-                        val = 0.5000 * out2_1 + 0.5000 * out2_2;
-                        out[badX0] = (val < min) ? out2_1 : val;
-
-                        val = 0.5000 * out2_1 + 0.5000 * out2_2;
-                        out[badX0 + 1] = (val < min) ? out2_1 : val;
-
-                        val = 0.5000 * out2_1 + 0.5000 * out2_2;
-                        out[badX0 + 2] = (val < min) ? out2_1 : val;
-
-                        val = 0.5003 * out2_1 + 0.4997 * out2_2;
-                        out[badX0 + 3] = (val < min) ? out2_1 : val;
-
-                        val = 0.5041 * out2_1 + 0.4959 * out2_2;
-                        out[badX1 - 4] = (val < min) ? out2_1 : val;
-
-                        val = 0.5370 * out2_1 + 0.4630 * out2_2;
-                        out[badX1 - 3] = (val < min) ? out2_1 : val;
-
-                        val = 0.6968 * out2_1 + 0.3032 * out2_2;
-                        out[badX1 - 2] = (val < min) ? out2_1 : val;
-
-                        val = 1.0933 * out2_1 - 0.0933 * out2_2;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
-
-                        val = 1.4288 * out2_1 - 0.4288 * out2_2;
-                        out[badX1] = (val < min) ? out2_1 : val;
-
-                        break;
-                    case 01000: /* .........#?, <noise^2> = 0 */
-                        val = 1.0000 * out2_1;
-                        out[badX0] = (val < min) ? out2_1 : val;
-                        out[badX0 + 1] = (val < min) ? out2_1 : val;
-                        out[badX0 + 2] = (val < min) ? out2_1 : val;
-                        out[badX0 + 3] = (val < min) ? out2_1 : val;
-                        out[badX1 - 4] = (val < min) ? out2_1 : val;
-                        out[badX1 - 3] = (val < min) ? out2_1 : val;
-                        out[badX1 - 2] = (val < min) ? out2_1 : val;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
-                        out[badX1] = (val < min) ? out2_1 : val;
-
-                        break;
-                    case 06000: /* ..........##, <noise^2> = 0 */
-                        val = 0.5000 * out2_1 + 0.5000 * out2_2;
-                        out[badX0] = (val < min) ? out2_1 : val;
-
-                        val = 0.5000 * out2_1 + 0.5000 * out2_2;
-                        out[badX0 + 1] = (val < min) ? out2_1 : val;
-
-                        val = 0.5000 * out2_1 + 0.5000 * out2_2;
-                        out[badX0 + 2] = (val < min) ? out2_1 : val;
-
-                        val = 0.5000 * out2_1 + 0.5000 * out2_2;
-                        out[badX0 + 3] = (val < min) ? out2_1 : val;
-
-                        val = 0.5003 * out2_1 + 0.4997 * out2_2;
-                        out[badX0 + 4] = (val < min) ? out2_1 : val;
-
-                        val = 0.5041 * out2_1 + 0.4959 * out2_2;
-                        out[badX1 - 4] = (val < min) ? out2_1 : val;
-
-                        val = 0.5370 * out2_1 + 0.4630 * out2_2;
-                        out[badX1 - 3] = (val < min) ? out2_1 : val;
-
-                        val = 0.6968 * out2_1 + 0.3032 * out2_2;
-                        out[badX1 - 2] = (val < min) ? out2_1 : val;
-
-                        val = 1.0933 * out2_1 - 0.0933 * out2_2;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
-
-                        val = 1.4288 * out2_1 - 0.4288 * out2_2;
-                        out[badX1] = (val < min) ? out2_1 : val;
-
-                        break;
-                    case 02000: /* ..........#?, <noise^2> = 0 */
-                        val = 1.0000 * out2_1;
-
-                        out[badX0] = (val < min) ? out2_1 : val;
-                        out[badX0 + 1] = (val < min) ? out2_1 : val;
-                        out[badX0 + 2] = (val < min) ? out2_1 : val;
-                        out[badX0 + 3] = (val < min) ? out2_1 : val;
-                        out[badX0 + 4] = (val < min) ? out2_1 : val;
-                        out[badX1 - 4] = (val < min) ? out2_1 : val;
-                        out[badX1 - 3] = (val < min) ? out2_1 : val;
-                        out[badX1 - 2] = (val < min) ? out2_1 : val;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
-                        out[badX1] = (val < min) ? out2_1 : val;
-
-                        break;
-                    default:
-                        // shFatal("Unsupported defect type: LEFT 0%o", defectType);
-                        break; /* NOTREACHED */
+                    break;
+                case 03000: /* .........##, <noise^2> = 0 */
+                    val = 0.5000 * out2_1 + 0.5000 * out2_2;
+                    out[badX0] = (val < min) ? out2_1 : val;
+
+                    val = 0.5000 * out2_1 + 0.5000 * out2_2;
+                    out[badX0 + 1] = (val < min) ? out2_1 : val;
+
+                    val = 0.5000 * out2_1 + 0.5000 * out2_2;
+                    out[badX0 + 2] = (val < min) ? out2_1 : val;
+
+                    val = 0.5003 * out2_1 + 0.4997 * out2_2;
+                    out[badX0 + 3] = (val < min) ? out2_1 : val;
+
+                    val = 0.5041 * out2_1 + 0.4959 * out2_2;
+                    out[badX1 - 4] = (val < min) ? out2_1 : val;
+
+                    val = 0.5370 * out2_1 + 0.4630 * out2_2;
+                    out[badX1 - 3] = (val < min) ? out2_1 : val;
+
+                    val = 0.6968 * out2_1 + 0.3032 * out2_2;
+                    out[badX1 - 2] = (val < min) ? out2_1 : val;
+
+                    val = 1.0933 * out2_1 - 0.0933 * out2_2;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
+
+                    val = 1.4288 * out2_1 - 0.4288 * out2_2;
+                    out[badX1] = (val < min) ? out2_1 : val;
+
+                    break;
+                case 01000: /* .........#?, <noise^2> = 0 */
+                    val = 1.0000 * out2_1;
+                    out[badX0] = (val < min) ? out2_1 : val;
+                    out[badX0 + 1] = (val < min) ? out2_1 : val;
+                    out[badX0 + 2] = (val < min) ? out2_1 : val;
+                    out[badX0 + 3] = (val < min) ? out2_1 : val;
+                    out[badX1 - 4] = (val < min) ? out2_1 : val;
+                    out[badX1 - 3] = (val < min) ? out2_1 : val;
+                    out[badX1 - 2] = (val < min) ? out2_1 : val;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
+                    out[badX1] = (val < min) ? out2_1 : val;
+
+                    break;
+                case 06000: /* ..........##, <noise^2> = 0 */
+                    val = 0.5000 * out2_1 + 0.5000 * out2_2;
+                    out[badX0] = (val < min) ? out2_1 : val;
+
+                    val = 0.5000 * out2_1 + 0.5000 * out2_2;
+                    out[badX0 + 1] = (val < min) ? out2_1 : val;
+
+                    val = 0.5000 * out2_1 + 0.5000 * out2_2;
+                    out[badX0 + 2] = (val < min) ? out2_1 : val;
+
+                    val = 0.5000 * out2_1 + 0.5000 * out2_2;
+                    out[badX0 + 3] = (val < min) ? out2_1 : val;
+
+                    val = 0.5003 * out2_1 + 0.4997 * out2_2;
+                    out[badX0 + 4] = (val < min) ? out2_1 : val;
+
+                    val = 0.5041 * out2_1 + 0.4959 * out2_2;
+                    out[badX1 - 4] = (val < min) ? out2_1 : val;
+
+                    val = 0.5370 * out2_1 + 0.4630 * out2_2;
+                    out[badX1 - 3] = (val < min) ? out2_1 : val;
+
+                    val = 0.6968 * out2_1 + 0.3032 * out2_2;
+                    out[badX1 - 2] = (val < min) ? out2_1 : val;
+
+                    val = 1.0933 * out2_1 - 0.0933 * out2_2;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
+
+                    val = 1.4288 * out2_1 - 0.4288 * out2_2;
+                    out[badX1] = (val < min) ? out2_1 : val;
+
+                    break;
+                case 02000: /* ..........#?, <noise^2> = 0 */
+                    val = 1.0000 * out2_1;
+
+                    out[badX0] = (val < min) ? out2_1 : val;
+                    out[badX0 + 1] = (val < min) ? out2_1 : val;
+                    out[badX0 + 2] = (val < min) ? out2_1 : val;
+                    out[badX0 + 3] = (val < min) ? out2_1 : val;
+                    out[badX0 + 4] = (val < min) ? out2_1 : val;
+                    out[badX1 - 4] = (val < min) ? out2_1 : val;
+                    out[badX1 - 3] = (val < min) ? out2_1 : val;
+                    out[badX1 - 2] = (val < min) ? out2_1 : val;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
+                    out[badX1] = (val < min) ? out2_1 : val;
+
+                    break;
+                default:
+                    // shFatal("Unsupported defect type: LEFT 0%o", defectType);
+                    break; /* NOTREACHED */
+            }
+            break;
+        case Defect::WIDE_LEFT:
+            assert(badX0 >= 0);
+            if (badX1 + 2 >= ncol) {     /* left defect extends near
+                                            right edge of data! */
+                if (badX1 == ncol - 2) { /* one column remains */
+                    val = out[ncol - 1];
+                } else {
+                    val = fallbackValue; /* there is no information */
+                }
+                for (int j = badX0; j <= badX1; j++) {
+                    out[j] = val;
                 }
                 break;
-            case Defect::WIDE_LEFT:
-                assert(badX0 >= 0);
-                if (badX1 + 2 >= ncol) {     /* left defect extends near
-                                                right edge of data! */
-                    if (badX1 == ncol - 2) { /* one column remains */
-                        val = out[ncol - 1];
-                    } else {
-                        val = fallbackValue; /* there is no information */
-                    }
+            }
+            out2_1 = out[badX1 + 1];
+            out2_2 = out[badX1 + 2];
+
+            switch (defectType) {
+                case 02: /* ?#., <noise^2> = 0 */
+                    val = 1.0000 * out2_1;
+                    val = (val < min) ? out2_1 : val;
+
                     for (int j = badX0; j <= badX1; j++) {
                         out[j] = val;
                     }
                     break;
-                }
-                out2_1 = out[badX1 + 1];
-                out2_2 = out[badX1 + 2];
-
-                switch (defectType) {
-                    case 02: /* ?#., <noise^2> = 0 */
-                        val = 1.0000 * out2_1;
-                        val = (val < min) ? out2_1 : val;
+                case 03: /* ?##, <noise^2> = 0 */
+                    val = 0.5000 * out2_1 + 0.5000 * out2_2;
+                    if (val < min) {
+                        val = out2_1;
+                    }
 
-                        for (int j = badX0; j <= badX1; j++) {
-                            out[j] = val;
-                        }
-                        break;
-                    case 03: /* ?##, <noise^2> = 0 */
-                        val = 0.5000 * out2_1 + 0.5000 * out2_2;
-                        if (val < min) {
-                            val = out2_1;
-                        }
+                    for (int j = badX0; j < badX1 - 5; j++) {
+                        out[j] = val;
+                    }
 
-                        for (int j = badX0; j < badX1 - 5; j++) {
-                            out[j] = val;
-                        }
+                    val = 0.5003 * out2_1 + 0.4997 * out2_2;
+                    out[badX1 - 5] = (val < min) ? out2_1 : val;
 
-                        val = 0.5003 * out2_1 + 0.4997 * out2_2;
-                        out[badX1 - 5] = (val < min) ? out2_1 : val;
+                    val = 0.5041 * out2_1 + 0.4959 * out2_2;
+                    out[badX1 - 4] = (val < min) ? out2_1 : val;
 
-                        val = 0.5041 * out2_1 + 0.4959 * out2_2;
-                        out[badX1 - 4] = (val < min) ? out2_1 : val;
+                    val = 0.5370 * out2_1 + 0.4630 * out2_2;
+                    out[badX1 - 3] = (val < min) ? out2_1 : val;
 
-                        val = 0.5370 * out2_1 + 0.4630 * out2_2;
-                        out[badX1 - 3] = (val < min) ? out2_1 : val;
+                    val = 0.6968 * out2_1 + 0.3032 * out2_2;
+                    out[badX1 - 2] = (val < min) ? out2_1 : val;
 
-                        val = 0.6968 * out2_1 + 0.3032 * out2_2;
-                        out[badX1 - 2] = (val < min) ? out2_1 : val;
+                    val = 1.0933 * out2_1 - 0.0933 * out2_2;
+                    out[badX1 - 1] = (val < min) ? out2_1 : val;
 
-                        val = 1.0933 * out2_1 - 0.0933 * out2_2;
-                        out[badX1 - 1] = (val < min) ? out2_1 : val;
+                    val = 1.4288 * out2_1 - 0.4288 * out2_2;
+                    out[badX1] = (val < min) ? out2_1 : val;
 
-                        val = 1.4288 * out2_1 - 0.4288 * out2_2;
-                        out[badX1] = (val < min) ? out2_1 : val;
+                    break;
+                default:
+                    // shFatal("Unsupported defect type: WIDE_LEFT 0%o",defect[i].type);
+                    break; /* NOTREACHED */
+            }
 
-                        break;
-                    default:
-                        // shFatal("Unsupported defect type: WIDE_LEFT 0%o",defect[i].type);
-                        break; /* NOTREACHED */
-                }
+            break;
+        case Defect::RIGHT:
+            assert(badX0 >= 2 && badX1 < ncol);
 
-                break;
-            case Defect::RIGHT:
-                assert(badX0 >= 2 && badX1 < ncol);
+            out1_2 = out[badX0 - 2];
+            out1_1 = out[badX0 - 1];
 
-                out1_2 = out[badX0 - 2];
-                out1_1 = out[badX0 - 1];
+            switch (defectType) {
+                case 06: /* ##., <noise^2> = 0 */
+                    val = -0.4288 * out1_2 + 1.4288 * out1_1;
+                    out[badX1] = (val < min) ? out1_1 : val;
 
-                switch (defectType) {
-                    case 06: /* ##., <noise^2> = 0 */
-                        val = -0.4288 * out1_2 + 1.4288 * out1_1;
-                        out[badX1] = (val < min) ? out1_1 : val;
+                    break;
+                case 014: /* ##.., <noise^2> = 0 */
+                    val = -0.4288 * out1_2 + 1.4288 * out1_1;
+                    out[badX0] = (val < min) ? out1_1 : val;
 
-                        break;
-                    case 014: /* ##.., <noise^2> = 0 */
-                        val = -0.4288 * out1_2 + 1.4288 * out1_1;
-                        out[badX0] = (val < min) ? out1_1 : val;
+                    val = -0.0933 * out1_2 + 1.0933 * out1_1;
+                    out[badX1] = (val < min) ? out1_1 : val;
 
-                        val = -0.0933 * out1_2 + 1.0933 * out1_1;
-                        out[badX1] = (val < min) ? out1_1 : val;
+                    break;
+                case 030: /* ##..., <noise^2> = 0 */
+                    val = -0.4288 * out1_2 + 1.4288 * out1_1;
+                    out[badX0] = (val < min) ? out1_1 : val;
 
-                        break;
-                    case 030: /* ##..., <noise^2> = 0 */
-                        val = -0.4288 * out1_2 + 1.4288 * out1_1;
-                        out[badX0] = (val < min) ? out1_1 : val;
+                    val = -0.0933 * out1_2 + 1.0933 * out1_1;
+                    out[badX1 - 1] = (val < min) ? out1_1 : val;
 
-                        val = -0.0933 * out1_2 + 1.0933 * out1_1;
-                        out[badX1 - 1] = (val < min) ? out1_1 : val;
+                    val = 0.3032 * out1_2 + 0.6968 * out1_1;
+                    out[badX1] = (val < min) ? out1_1 : val;
 
-                        val = 0.3032 * out1_2 + 0.6968 * out1_1;
-                        out[badX1] = (val < min) ? out1_1 : val;
+                    break;
+                case 060: /* ##...., <noise^2> = 0 */
+                    val = -0.4288 * out1_2 + 1.4288 * out1_1;
+                    out[badX0] = (val < min) ? out1_1 : val;
 
-                        break;
-                    case 060: /* ##...., <noise^2> = 0 */
-                        val = -0.4288 * out1_2 + 1.4288 * out1_1;
-                        out[badX0] = (val < min) ? out1_1 : val;
+                    val = -0.0933 * out1_2 + 1.0933 * out1_1;
+                    out[badX0 + 1] = (val < min) ? out1_1 : val;
 
-                        val = -0.0933 * out1_2 + 1.0933 * out1_1;
-                        out[badX0 + 1] = (val < min) ? out1_1 : val;
+                    val = 0.3032 * out1_2 + 0.6968 * out1_1;
+                    out[badX1 - 1] = (val < min) ? out1_1 : val;
 
-                        val = 0.3032 * out1_2 + 0.6968 * out1_1;
-                        out[badX1 - 1] = (val < min) ? out1_1 : val;
+                    val = 0.4630 * out1_2 + 0.5370 * out1_1;
+                    out[badX1] = (val < min) ? out1_1 : val;
 
-                        val = 0.4630 * out1_2 + 0.5370 * out1_1;
-                        out[badX1] = (val < min) ? out1_1 : val;
+                    break;
+                case 0140: /* ##....., <noise^2> = 0 */
+                    val = -0.4288 * out1_2 + 1.4288 * out1_1;
+                    out[badX0] = (val < min) ? out1_1 : val;
 
-                        break;
-                    case 0140: /* ##....., <noise^2> = 0 */
-                        val = -0.4288 * out1_2 + 1.4288 * out1_1;
-                        out[badX0] = (val < min) ? out1_1 : val;
+                    val = -0.0933 * out1_2 + 1.0933 * out1_1;
+                    out[badX0 + 1] = (val < min) ? out1_1 : val;
 
-                        val = -0.0933 * out1_2 + 1.0933 * out1_1;
-                        out[badX0 + 1] = (val < min) ? out1_1 : val;
+                    val = 0.3032 * out1_2 + 0.6968 * out1_1;
+                    out[badX1 - 2] = (val < min) ? out1_1 : val;
 
-                        val = 0.3032 * out1_2 + 0.6968 * out1_1;
-                        out[badX1 - 2] = (val < min) ? out1_1 : val;
+                    val = 0.4630 * out1_2 + 0.5370 * out1_1;
+                    out[badX1 - 1] = (val < min) ? out1_1 : val;
 
-                        val = 0.4630 * out1_2 + 0.5370 * out1_1;
-                        out[badX1 - 1] = (val < min) ? out1_1 : val;
+                    val = 0.4959 * out1_2 + 0.5041 * out1_1;
+                    out[badX1] = (val < min) ? out1_1 : val;
 
-                        val = 0.4959 * out1_2 + 0.5041 * out1_1;
-                        out[badX1] = (val < min) ? out1_1 : val;
+                    break;
+                case 0300: /* ##......, <noise^2> = 0 */
+                    val = -0.4288 * out1_2 + 1.4288 * out1_1;
+                    out[badX0] = (val < min) ? out1_1 : val;
 
-                        break;
-                    case 0300: /* ##......, <noise^2> = 0 */
-                        val = -0.4288 * out1_2 + 1.4288 * out1_1;
-                        out[badX0] = (val < min) ? out1_1 : val;
+                    val = -0.0933 * out1_2 + 1.0933 * out1_1;
+                    out[badX0 + 1] = (val < min) ? out1_1 : val;
 
-                        val = -0.0933 * out1_2 + 1.0933 * out1_1;
-                        out[badX0 + 1] = (val < min) ? out1_1 : val;
+                    val = 0.3032 * out1_2 + 0.6968 * out1_1;
+                    out[badX0 + 2] = (val < min) ? out1_1 : val;
 
-                        val = 0.3032 * out1_2 + 0.6968 * out1_1;
-                        out[badX0 + 2] = (val < min) ? out1_1 : val;
+                    val = 0.4630 * out1_2 + 0.5370 * out1_1;
+                    out[badX1 - 2] = (val < min) ? out1_1 : val;
 
-                        val = 0.4630 * out1_2 + 0.5370 * out1_1;
-                        out[badX1 - 2] = (val < min) ? out1_1 : val;
+                    val = 0.4959 * out1_2 + 0.5041 * out1_1;
+                    out[badX1 - 1] = (val < min) ? out1_1 : val;
 
-                        val = 0.4959 * out1_2 + 0.5041 * out1_1;
-                        out[badX1 - 1] = (val < min) ? out1_1 : val;
+                    val = 0.4997 * out1_2 + 0.5003 * out1_1;
+                    out[badX1] = (val < min) ? out1_1 : val;
 
-                        val = 0.4997 * out1_2 + 0.5003 * out1_1;
-                        out[badX1] = (val < min) ? out1_1 : val;
+                    break;
+                case 0600: /* ##......., <noise^2> = 0 */
+                    val = -0.4288 * out1_2 + 1.4288 * out1_1;
+                    out[badX0] = (val < min) ? out1_1 : val;
 
-                        break;
-                    case 0600: /* ##......., <noise^2> = 0 */
-                        val = -0.4288 * out1_2 + 1.4288 * out1_1;
-                        out[badX0] = (val < min) ? out1_1 : val;
+                    val = -0.0933 * out1_2 + 1.0933 * out1_1;
+                    out[badX0 + 1] = (val < min) ? out1_1 : val;
 
-                        val = -0.0933 * out1_2 + 1.0933 * out1_1;
-                        out[badX0 + 1] = (val < min) ? out1_1 : val;
+                    val = 0.3032 * out1_2 + 0.6968 * out1_1;
+                    out[badX0 + 2] = (val < min) ? out1_1 : val;
 
-                        val = 0.3032 * out1_2 + 0.6968 * out1_1;
-                        out[badX0 + 2] = (val < min) ? out1_1 : val;
+                    val = 0.4630 * out1_2 + 0.5370 * out1_1;
+                    out[badX1 - 3] = (val < min) ? out1_1 : val;
 
-                        val = 0.4630 * out1_2 + 0.5370 * out1_1;
-                        out[badX1 - 3] = (val < min) ? out1_1 : val;
+                    val = 0.4959 * out1_2 + 0.5041 * out1_1;
+                    out[badX1 - 2] = (val < min) ? out1_1 : val;
 
-                        val = 0.4959 * out1_2 + 0.5041 * out1_1;
-                        out[badX1 - 2] = (val < min) ? out1_1 : val;
+                    val = 0.4997 * out1_2 + 0.5003 * out1_1;
+                    out[badX1 - 1] = (val < min) ? out1_1 : val;
 
-                        val = 0.4997 * out1_2 + 0.5003 * out1_1;
-                        out[badX1 - 1] = (val < min) ? out1_1 : val;
+                    val = 0.5000 * out1_2 + 0.5000 * out1_1;
+                    out[badX1] = (val < min) ? out1_1 : val;
 
-                        val = 0.5000 * out1_2 + 0.5000 * out1_1;
-                        out[badX1] = (val < min) ? out1_1 : val;
+                    break;
+                case 01400: /* ##........, <noise^2> = 0 */
+                    val = -0.4288 * out1_2 + 1.4288 * out1_1;
+                    out[badX0] = (val < min) ? out1_1 : val;
 
-                        break;
-                    case 01400: /* ##........, <noise^2> = 0 */
-                        val = -0.4288 * out1_2 + 1.4288 * out1_1;
-                        out[badX0] = (val < min) ? out1_1 : val;
+                    val = -0.0933 * out1_2 + 1.0933 * out1_1;
+                    out[badX0 + 1] = (val < min) ? out1_1 : val;
 
-                        val = -0.0933 * out1_2 + 1.0933 * out1_1;
-                        out[badX0 + 1] = (val < min) ? out1_1 : val;
+                    val = 0.3032 * out1_2 + 0.6968 * out1_1;
+                    out[badX0 + 2] = (val < min) ? out1_1 : val;
 
-                        val = 0.3032 * out1_2 + 0.6968 * out1_1;
-                        out[badX0 + 2] = (val < min) ? out1_1 : val;
+                    val = 0.4630 * out1_2 + 0.5370 * out1_1;
+                    out[badX0 + 3] = (val < min) ? out1_1 : val;
 
-                        val = 0.4630 * out1_2 + 0.5370 * out1_1;
-                        out[badX0 + 3] = (val < min) ? out1_1 : val;
+                    val = 0.4959 * out1_2 + 0.5041 * out1_1;
+                    out[badX1 - 3] = (val < min) ? out1_1 : val;
 
-                        val = 0.4959 * out1_2 + 0.5041 * out1_1;
-                        out[badX1 - 3] = (val < min) ? out1_1 : val;
+                    val = 0.4997 * out1_2 + 0.5003 * out1_1;
+                    out[badX1 - 2] = (val < min) ? out1_1 : val;
 
-                        val = 0.4997 * out1_2 + 0.5003 * out1_1;
-                        out[badX1 - 2] = (val < min) ? out1_1 : val;
+                    val = 0.5000 * out1_2 + 0.5000 * out1_1;
+                    out[badX1 - 1] = (val < min) ? out1_1 : val;
 
-                        val = 0.5000 * out1_2 + 0.5000 * out1_1;
-                        out[badX1 - 1] = (val < min) ? out1_1 : val;
+                    val = 0.5000 * out1_2 + 0.5000 * out1_1;
+                    out[badX1] = (val < min) ? out1_1 : val;
 
-                        val = 0.5000 * out1_2 + 0.5000 * out1_1;
-                        out[badX1] = (val < min) ? out1_1 : val;
+                    break;
+                case 03000: /* ##........., <noise^2> = 0 */
+                    val = -0.4288 * out1_2 + 1.4288 * out1_1;
+                    out[badX0] = (val < min) ? out1_1 : val;
 
-                        break;
-                    case 03000: /* ##........., <noise^2> = 0 */
-                        val = -0.4288 * out1_2 + 1.4288 * out1_1;
-                        out[badX0] = (val < min) ? out1_1 : val;
+                    val = -0.0933 * out1_2 + 1.0933 * out1_1;
+                    out[badX0 + 1] = (val < min) ? out1_1 : val;
 
-                        val = -0.0933 * out1_2 + 1.0933 * out1_1;
-                        out[badX0 + 1] = (val < min) ? out1_1 : val;
+                    val = 0.3032 * out1_2 + 0.6968 * out1_1;
+                    out[badX0 + 2] = (val < min) ? out1_1 : val;
 
-                        val = 0.3032 * out1_2 + 0.6968 * out1_1;
-                        out[badX0 + 2] = (val < min) ? out1_1 : val;
+                    val = 0.4630 * out1_2 + 0.5370 * out1_1;
+                    out[badX0 + 3] = (val < min) ? out1_1 : val;
 
-                        val = 0.4630 * out1_2 + 0.5370 * out1_1;
-                        out[badX0 + 3] = (val < min) ? out1_1 : val;
+                    val = 0.4959 * out1_2 + 0.5041 * out1_1;
+                    out[badX1 - 4] = (val < min) ? out1_1 : val;
 
-                        val = 0.4959 * out1_2 + 0.5041 * out1_1;
-                        out[badX1 - 4] = (val < min) ? out1_1 : val;
+                    val = 0.4997 * out1_2 + 0.5003 * out1_1;
+                    out[badX1 - 3] = (val < min) ? out1_1 : val;
 
-                        val = 0.4997 * out1_2 + 0.5003 * out1_1;
-                        out[badX1 - 3] = (val < min) ? out1_1 : val;
+                    val = 0.5000 * out1_2 + 0.5000 * out1_1;
+                    out[badX1 - 2] = (val < min) ? out1_1 : val;
 
-                        val = 0.5000 * out1_2 + 0.5000 * out1_1;
-                        out[badX1 - 2] = (val < min) ? out1_1 : val;
+                    val = 0.5000 * out1_2 + 0.5000 * out1_1;
+                    out[badX1 - 1] = (val < min) ? out1_1 : val;
 
-                        val = 0.5000 * out1_2 + 0.5000 * out1_1;
-                        out[badX1 - 1] = (val < min) ? out1_1 : val;
+                    val = 0.5000 * out1_2 + 0.5000 * out1_1;
+                    out[badX1] = (val < min) ? out1_1 : val;
 
-                        val = 0.5000 * out1_2 + 0.5000 * out1_1;
-                        out[badX1] = (val < min) ? out1_1 : val;
+                    break;
+                case 06000: /* ##.........., <noise^2> = 0 */
+                    val = -0.4288 * out1_2 + 1.4288 * out1_1;
+                    out[badX0] = (val < min) ? out1_1 : val;
 
-                        break;
-                    case 06000: /* ##.........., <noise^2> = 0 */
-                        val = -0.4288 * out1_2 + 1.4288 * out1_1;
-                        out[badX0] = (val < min) ? out1_1 : val;
+                    val = -0.0933 * out1_2 + 1.0933 * out1_1;
+                    out[badX0 + 1] = (val < min) ? out1_1 : val;
 
-                        val = -0.0933 * out1_2 + 1.0933 * out1_1;
-                        out[badX0 + 1] = (val < min) ? out1_1 : val;
+                    val = 0.3032 * out1_2 + 0.6968 * out1_1;
+                    out[badX0 + 2] = (val < min) ? out1_1 : val;
 
-                        val = 0.3032 * out1_2 + 0.6968 * out1_1;
-                        out[badX0 + 2] = (val < min) ? out1_1 : val;
+                    val = 0.4630 * out1_2 + 0.5370 * out1_1;
+                    out[badX0 + 3] = (val < min) ? out1_1 : val;
 
-                        val = 0.4630 * out1_2 + 0.5370 * out1_1;
-                        out[badX0 + 3] = (val < min) ? out1_1 : val;
+                    val = 0.4959 * out1_2 + 0.5041 * out1_1;
+                    out[badX0 + 4] = (val < min) ? out1_1 : val;
 
-                        val = 0.4959 * out1_2 + 0.5041 * out1_1;
-                        out[badX0 + 4] = (val < min) ? out1_1 : val;
+                    val = 0.4997 * out1_2 + 0.5003 * out1_1;
+                    out[badX1 - 4] = (val < min) ? out1_1 : val;
 
-                        val = 0.4997 * out1_2 + 0.5003 * out1_1;
-                        out[badX1 - 4] = (val < min) ? out1_1 : val;
+                    val = 0.5000 * out1_2 + 0.5000 * out1_1;
+                    out[badX1 - 3] = (val < min) ? out1_1 : val;
 
-                        val = 0.5000 * out1_2 + 0.5000 * out1_1;
-                        out[badX1 - 3] = (val < min) ? out1_1 : val;
+                    val = 0.5000 * out1_2 + 0.5000 * out1_1;
+                    out[badX1 - 2] = (val < min) ? out1_1 : val;
 
-                        val = 0.5000 * out1_2 + 0.5000 * out1_1;
-                        out[badX1 - 2] = (val < min) ? out1_1 : val;
+                    val = 0.5000 * out1_2 + 0.5000 * out1_1;
+                    out[badX1 - 1] = (val < min) ? out1_1 : val;
 
-                        val = 0.5000 * out1_2 + 0.5000 * out1_1;
-                        out[badX1 - 1] = (val < min) ? out1_1 : val;
+                    val = 0.5000 * out1_2 + 0.5000 * out1_1;
+                    out[badX1] = (val < min) ? out1_1 : val;
 
-                        val = 0.5000 * out1_2 + 0.5000 * out1_1;
-                        out[badX1] = (val < min) ? out1_1 : val;
+                    break;
+                default:
+                    // shFatal("Unsupported defect type: RIGHT 0%o",defect[i].type);
+                    break; /* NOTREACHED */
+            }
+            break;
+        case Defect::WIDE_RIGHT:
+            assert(badX1 < ncol);
 
-                        break;
-                    default:
-                        // shFatal("Unsupported defect type: RIGHT 0%o",defect[i].type);
-                        break; /* NOTREACHED */
+            if (badX0 < 2) {      /* right defect extends near
+                                     left edge of data! */
+                if (badX0 == 1) { /* one column remains */
+                    val = out[0];
+                } else {
+                    val = fallbackValue; /* there is no information */
+                }
+                for (int j = badX0; j <= badX1; j++) {
+                    out[j] = val;
                 }
                 break;
-            case Defect::WIDE_RIGHT:
-                assert(badX1 < ncol);
+            }
 
-                if (badX0 < 2) {      /* right defect extends near
-                                         left edge of data! */
-                    if (badX0 == 1) { /* one column remains */
-                        val = out[0];
-                    } else {
-                        val = fallbackValue; /* there is no information */
-                    }
-                    for (int j = badX0; j <= badX1; j++) {
-                        out[j] = val;
-                    }
-                    break;
-                }
+            out1_2 = out[badX0 - 2];
+            out1_1 = out[badX0 - 1];
 
-                out1_2 = out[badX0 - 2];
-                out1_1 = out[badX0 - 1];
+            switch (defectType) {
+                case 03: /* ##?, S/N = infty */
+                    val = -0.4288 * out1_2 + 1.4288 * out1_1;
+                    out[badX0] = (val < min) ? out1_1 : val;
 
-                switch (defectType) {
-                    case 03: /* ##?, S/N = infty */
-                        val = -0.4288 * out1_2 + 1.4288 * out1_1;
-                        out[badX0] = (val < min) ? out1_1 : val;
+                    val = -0.0933 * out1_2 + 1.0933 * out1_1;
+                    out[badX0 + 1] = (val < min) ? out1_1 : val;
 
-                        val = -0.0933 * out1_2 + 1.0933 * out1_1;
-                        out[badX0 + 1] = (val < min) ? out1_1 : val;
+                    val = 0.3032 * out1_2 + 0.6968 * out1_1;
+                    out[badX0 + 2] = (val < min) ? out1_1 : val;
 
-                        val = 0.3032 * out1_2 + 0.6968 * out1_1;
-                        out[badX0 + 2] = (val < min) ? out1_1 : val;
+                    val = 0.4630 * out1_2 + 0.5370 * out1_1;
+                    out[badX0 + 3] = (val < min) ? out1_1 : val;
 
-                        val = 0.4630 * out1_2 + 0.5370 * out1_1;
-                        out[badX0 + 3] = (val < min) ? out1_1 : val;
+                    val = 0.4959 * out1_2 + 0.5041 * out1_1;
+                    out[badX0 + 4] = (val < min) ? out1_1 : val;
 
-                        val = 0.4959 * out1_2 + 0.5041 * out1_1;
-                        out[badX0 + 4] = (val < min) ? out1_1 : val;
+                    val = 0.4997 * out1_2 + 0.5003 * out1_1;
+                    out[badX0 + 5] = (val < min) ? out1_1 : val;
 
-                        val = 0.4997 * out1_2 + 0.5003 * out1_1;
-                        out[badX0 + 5] = (val < min) ? out1_1 : val;
+                    val = 0.5000 * out1_2 + 0.5000 * out1_1;
+                    val = (val < min) ? out1_1 : val;
 
-                        val = 0.5000 * out1_2 + 0.5000 * out1_1;
-                        val = (val < min) ? out1_1 : val;
+                    for (int j = badX0 + 6; j <= badX1; j++) {
+                        out[j] = val;
+                    }
+                    break;
+                default:
+                    // shFatal("Unsupported defect type: WIDE_RIGHT 0%o",defect[i].type);
+                    break; /* NOTREACHED */
+            }
+            break;
+        case Defect::MIDDLE:
+        case Defect::NEAR_LEFT:
+        case Defect::NEAR_RIGHT:
+            if (defectPos == Defect::MIDDLE) {
+                assert(badX0 >= 2 && badX1 + 2 < ncol);
+                out1_2 = out[badX0 - 2];
+                out2_2 = out[badX1 + 2];
+            } else if (defectPos == Defect::NEAR_LEFT) {
+                assert(badX0 >= 1 && badX1 + 2 < ncol);
+                out1_2 = -1; /* NOTUSED */
+                out2_2 = out[badX1 + 2];
+            } else if (defectPos == Defect::NEAR_RIGHT) {
+                assert(badX0 >= 2 && badX1 + 1 < ncol);
+                out1_2 = out[badX0 - 2];
+                out2_2 = -1; /* NOTUSED */
+            } else {
+                // shFatal("Unknown defect classification %d (%s:%d)",defectPos, __FILE__,__LINE__);
+                out1_2 = out2_2 = -1; /* NOTUSED */
+            }
+            out1_1 = out[badX0 - 1];
+            out2_1 = out[badX1 + 1];
 
-                        for (int j = badX0 + 6; j <= badX1; j++) {
-                            out[j] = val;
-                        }
-                        break;
-                    default:
-                        // shFatal("Unsupported defect type: WIDE_RIGHT 0%o",defect[i].type);
-                        break; /* NOTREACHED */
-                }
-                break;
-            case Defect::MIDDLE:
-            case Defect::NEAR_LEFT:
-            case Defect::NEAR_RIGHT:
-                if (defectPos == Defect::MIDDLE) {
-                    assert(badX0 >= 2 && badX1 + 2 < ncol);
-                    out1_2 = out[badX0 - 2];
-                    out2_2 = out[badX1 + 2];
-                } else if (defectPos == Defect::NEAR_LEFT) {
-                    assert(badX0 >= 1 && badX1 + 2 < ncol);
-                    out1_2 = -1; /* NOTUSED */
-                    out2_2 = out[badX1 + 2];
-                } else if (defectPos == Defect::NEAR_RIGHT) {
-                    assert(badX0 >= 2 && badX1 + 1 < ncol);
-                    out1_2 = out[badX0 - 2];
-                    out2_2 = -1; /* NOTUSED */
-                } else {
-                    // shFatal("Unknown defect classification %d (%s:%d)",defectPos, __FILE__,__LINE__);
-                    out1_2 = out2_2 = -1; /* NOTUSED */
-                }
-                out1_1 = out[badX0 - 1];
-                out2_1 = out[badX1 + 1];
+            switch (defectType) {
+                case 012: /* #.#., <noise^2> = 0, sigma = 1 */
+                    val = 0.5000 * out1_1 + 0.5000 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                switch (defectType) {
-                    case 012: /* #.#., <noise^2> = 0, sigma = 1 */
-                        val = 0.5000 * out1_1 + 0.5000 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 013: /* #.##, <noise^2> = 0 */
+                    val = 0.4875 * out1_1 + 0.8959 * out2_1 - 0.3834 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 013: /* #.##, <noise^2> = 0 */
-                        val = 0.4875 * out1_1 + 0.8959 * out2_1 - 0.3834 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 022: /* #..#., <noise^2> = 0, sigma = 1 */
+                    val = 0.7297 * out1_1 + 0.2703 * out2_1;
+                    out[badX0] = (val < 0) ? 0 : val;
 
-                        break;
-                    case 022: /* #..#., <noise^2> = 0, sigma = 1 */
-                        val = 0.7297 * out1_1 + 0.2703 * out2_1;
-                        out[badX0] = (val < 0) ? 0 : val;
+                    val = 0.2703 * out1_1 + 0.7297 * out2_1;
+                    out[badX1] = (val < 0) ? 0 : val;
 
-                        val = 0.2703 * out1_1 + 0.7297 * out2_1;
-                        out[badX1] = (val < 0) ? 0 : val;
+                    break;
+                case 023: /* #..##, <noise^2> = 0 */
+                    val = 0.7538 * out1_1 + 0.5680 * out2_1 - 0.3218 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 023: /* #..##, <noise^2> = 0 */
-                        val = 0.7538 * out1_1 + 0.5680 * out2_1 - 0.3218 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3095 * out1_1 + 1.2132 * out2_1 - 0.5227 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3095 * out1_1 + 1.2132 * out2_1 - 0.5227 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 032: /* ##.#., <noise^2> = 0 */
+                    val = -0.3834 * out1_2 + 0.8959 * out1_1 + 0.4875 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 032: /* ##.#., <noise^2> = 0 */
-                        val = -0.3834 * out1_2 + 0.8959 * out1_1 + 0.4875 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 033: /* ##.##, <noise^2> = 0 */
+                    /* These coefficients are also available as
+                       interp::interp_1_c1 and interp::interp_1_c2 */
+                    val = -0.2737 * out1_2 + 0.7737 * out1_1 + 0.7737 * out2_1 - 0.2737 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 033: /* ##.##, <noise^2> = 0 */
-                        /* These coefficients are also available as
-                           interp::interp_1_c1 and interp::interp_1_c2 */
-                        val = -0.2737 * out1_2 + 0.7737 * out1_1 + 0.7737 * out2_1 - 0.2737 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 042: /* #...#., <noise^2> = 0, sigma = 1 */
+                    val = 0.8430 * out1_1 + 0.1570 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 042: /* #...#., <noise^2> = 0, sigma = 1 */
-                        val = 0.8430 * out1_1 + 0.1570 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5000 * out1_1 + 0.5000 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5000 * out1_1 + 0.5000 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1570 * out1_1 + 0.8430 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1570 * out1_1 + 0.8430 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 043: /* #...##, <noise^2> = 0 */
+                    val = 0.8525 * out1_1 + 0.2390 * out2_1 - 0.0915 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 043: /* #...##, <noise^2> = 0 */
-                        val = 0.8525 * out1_1 + 0.2390 * out2_1 - 0.0915 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5356 * out1_1 + 0.8057 * out2_1 - 0.3413 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5356 * out1_1 + 0.8057 * out2_1 - 0.3413 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2120 * out1_1 + 1.3150 * out2_1 - 0.5270 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2120 * out1_1 + 1.3150 * out2_1 - 0.5270 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 062: /* ##..#., <noise^2> = 0 */
+                    val = -0.5227 * out1_2 + 1.2132 * out1_1 + 0.3095 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 062: /* ##..#., <noise^2> = 0 */
-                        val = -0.5227 * out1_2 + 1.2132 * out1_1 + 0.3095 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.3218 * out1_2 + 0.5680 * out1_1 + 0.7538 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.3218 * out1_2 + 0.5680 * out1_1 + 0.7538 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 063: /* ##..##, <noise^2> = 0 */
+                    val = -0.4793 * out1_2 + 1.1904 * out1_1 + 0.5212 * out2_1 - 0.2323 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 063: /* ##..##, <noise^2> = 0 */
-                        val = -0.4793 * out1_2 + 1.1904 * out1_1 + 0.5212 * out2_1 - 0.2323 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2323 * out1_2 + 0.5212 * out1_1 + 1.1904 * out2_1 - 0.4793 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2323 * out1_2 + 0.5212 * out1_1 + 1.1904 * out2_1 - 0.4793 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 0102: /* #....#., <noise^2> = 0, sigma = 1 */
+                    val = 0.8810 * out1_1 + 0.1190 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 0102: /* #....#., <noise^2> = 0, sigma = 1 */
-                        val = 0.8810 * out1_1 + 0.1190 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6315 * out1_1 + 0.3685 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6315 * out1_1 + 0.3685 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3685 * out1_1 + 0.6315 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3685 * out1_1 + 0.6315 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1190 * out1_1 + 0.8810 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1190 * out1_1 + 0.8810 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 0103: /* #....##, <noise^2> = 0 */
+                    val = 0.8779 * out1_1 + 0.0945 * out2_1 + 0.0276 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 0103: /* #....##, <noise^2> = 0 */
-                        val = 0.8779 * out1_1 + 0.0945 * out2_1 + 0.0276 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6327 * out1_1 + 0.3779 * out2_1 - 0.0106 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6327 * out1_1 + 0.3779 * out2_1 - 0.0106 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4006 * out1_1 + 0.8914 * out2_1 - 0.2920 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4006 * out1_1 + 0.8914 * out2_1 - 0.2920 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1757 * out1_1 + 1.3403 * out2_1 - 0.5160 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1757 * out1_1 + 1.3403 * out2_1 - 0.5160 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 0142: /* ##...#., <noise^2> = 0 */
+                    val = -0.5270 * out1_2 + 1.3150 * out1_1 + 0.2120 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 0142: /* ##...#., <noise^2> = 0 */
-                        val = -0.5270 * out1_2 + 1.3150 * out1_1 + 0.2120 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.3413 * out1_2 + 0.8057 * out1_1 + 0.5356 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.3413 * out1_2 + 0.8057 * out1_1 + 0.5356 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.0915 * out1_2 + 0.2390 * out1_1 + 0.8525 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.0915 * out1_2 + 0.2390 * out1_1 + 0.8525 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 0143: /* ##...##, <noise^2> = 0 */
+                    val = -0.5230 * out1_2 + 1.3163 * out1_1 + 0.2536 * out2_1 - 0.0469 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 0143: /* ##...##, <noise^2> = 0 */
-                        val = -0.5230 * out1_2 + 1.3163 * out1_1 + 0.2536 * out2_1 - 0.0469 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.3144 * out1_2 + 0.8144 * out1_1 + 0.8144 * out2_1 - 0.3144 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.3144 * out1_2 + 0.8144 * out1_1 + 0.8144 * out2_1 - 0.3144 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.0469 * out1_2 + 0.2536 * out1_1 + 1.3163 * out2_1 - 0.5230 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.0469 * out1_2 + 0.2536 * out1_1 + 1.3163 * out2_1 - 0.5230 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 0202: /* #.....#., <noise^2> = 0, sigma = 1 */
+                    val = 0.8885 * out1_1 + 0.1115 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 0202: /* #.....#., <noise^2> = 0, sigma = 1 */
-                        val = 0.8885 * out1_1 + 0.1115 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6748 * out1_1 + 0.3252 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6748 * out1_1 + 0.3252 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5000 * out1_1 + 0.5000 * out2_1;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5000 * out1_1 + 0.5000 * out2_1;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3252 * out1_1 + 0.6748 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3252 * out1_1 + 0.6748 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1115 * out1_1 + 0.8885 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1115 * out1_1 + 0.8885 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 0203: /* #.....##, <noise^2> = 0 */
+                    val = 0.8824 * out1_1 + 0.0626 * out2_1 + 0.0549 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 0203: /* #.....##, <noise^2> = 0 */
-                        val = 0.8824 * out1_1 + 0.0626 * out2_1 + 0.0549 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6601 * out1_1 + 0.2068 * out2_1 + 0.1331 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6601 * out1_1 + 0.2068 * out2_1 + 0.1331 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4938 * out1_1 + 0.4498 * out2_1 + 0.0564 * out2_2;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4938 * out1_1 + 0.4498 * out2_1 + 0.0564 * out2_2;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3551 * out1_1 + 0.9157 * out2_1 - 0.2708 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3551 * out1_1 + 0.9157 * out2_1 - 0.2708 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1682 * out1_1 + 1.3447 * out2_1 - 0.5129 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1682 * out1_1 + 1.3447 * out2_1 - 0.5129 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 0302: /* ##....#., <noise^2> = 0 */
+                    val = -0.5160 * out1_2 + 1.3403 * out1_1 + 0.1757 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 0302: /* ##....#., <noise^2> = 0 */
-                        val = -0.5160 * out1_2 + 1.3403 * out1_1 + 0.1757 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2920 * out1_2 + 0.8914 * out1_1 + 0.4006 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2920 * out1_2 + 0.8914 * out1_1 + 0.4006 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.0106 * out1_2 + 0.3779 * out1_1 + 0.6327 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.0106 * out1_2 + 0.3779 * out1_1 + 0.6327 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0276 * out1_2 + 0.0945 * out1_1 + 0.8779 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0276 * out1_2 + 0.0945 * out1_1 + 0.8779 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 0303: /* ##....##, <noise^2> = 0 */
+                    val = -0.5197 * out1_2 + 1.3370 * out1_1 + 0.1231 * out2_1 + 0.0596 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 0303: /* ##....##, <noise^2> = 0 */
-                        val = -0.5197 * out1_2 + 1.3370 * out1_1 + 0.1231 * out2_1 + 0.0596 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2924 * out1_2 + 0.8910 * out1_1 + 0.3940 * out2_1 + 0.0074 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2924 * out1_2 + 0.8910 * out1_1 + 0.3940 * out2_1 + 0.0074 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0074 * out1_2 + 0.3940 * out1_1 + 0.8910 * out2_1 - 0.2924 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0074 * out1_2 + 0.3940 * out1_1 + 0.8910 * out2_1 - 0.2924 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0596 * out1_2 + 0.1231 * out1_1 + 1.3370 * out2_1 - 0.5197 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0596 * out1_2 + 0.1231 * out1_1 + 1.3370 * out2_1 - 0.5197 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 0402: /* #......#., <noise^2> = 0, sigma = 1 */
+                    val = 0.8893 * out1_1 + 0.1107 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 0402: /* #......#., <noise^2> = 0, sigma = 1 */
-                        val = 0.8893 * out1_1 + 0.1107 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6830 * out1_1 + 0.3170 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6830 * out1_1 + 0.3170 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5435 * out1_1 + 0.4565 * out2_1;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5435 * out1_1 + 0.4565 * out2_1;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4565 * out1_1 + 0.5435 * out2_1;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4565 * out1_1 + 0.5435 * out2_1;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3170 * out1_1 + 0.6830 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3170 * out1_1 + 0.6830 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1107 * out1_1 + 0.8893 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1107 * out1_1 + 0.8893 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 0403: /* #......##, <noise^2> = 0 */
+                    val = 0.8829 * out1_1 + 0.0588 * out2_1 + 0.0583 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 0403: /* #......##, <noise^2> = 0 */
-                        val = 0.8829 * out1_1 + 0.0588 * out2_1 + 0.0583 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6649 * out1_1 + 0.1716 * out2_1 + 0.1635 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6649 * out1_1 + 0.1716 * out2_1 + 0.1635 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5212 * out1_1 + 0.2765 * out2_1 + 0.2024 * out2_2;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5212 * out1_1 + 0.2765 * out2_1 + 0.2024 * out2_2;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4477 * out1_1 + 0.4730 * out2_1 + 0.0793 * out2_2;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4477 * out1_1 + 0.4730 * out2_1 + 0.0793 * out2_2;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3465 * out1_1 + 0.9201 * out2_1 - 0.2666 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3465 * out1_1 + 0.9201 * out2_1 - 0.2666 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1673 * out1_1 + 1.3452 * out2_1 - 0.5125 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1673 * out1_1 + 1.3452 * out2_1 - 0.5125 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 0602: /* ##.....#., <noise^2> = 0 */
+                    val = -0.5129 * out1_2 + 1.3447 * out1_1 + 0.1682 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 0602: /* ##.....#., <noise^2> = 0 */
-                        val = -0.5129 * out1_2 + 1.3447 * out1_1 + 0.1682 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2708 * out1_2 + 0.9157 * out1_1 + 0.3551 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2708 * out1_2 + 0.9157 * out1_1 + 0.3551 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0564 * out1_2 + 0.4498 * out1_1 + 0.4938 * out2_1;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0564 * out1_2 + 0.4498 * out1_1 + 0.4938 * out2_1;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1331 * out1_2 + 0.2068 * out1_1 + 0.6601 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1331 * out1_2 + 0.2068 * out1_1 + 0.6601 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0549 * out1_2 + 0.0626 * out1_1 + 0.8824 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0549 * out1_2 + 0.0626 * out1_1 + 0.8824 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 0603: /* ##.....##, <noise^2> = 0 */
+                    val = -0.5179 * out1_2 + 1.3397 * out1_1 + 0.0928 * out2_1 + 0.0854 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 0603: /* ##.....##, <noise^2> = 0 */
-                        val = -0.5179 * out1_2 + 1.3397 * out1_1 + 0.0928 * out2_1 + 0.0854 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2796 * out1_2 + 0.9069 * out1_1 + 0.2231 * out2_1 + 0.1495 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2796 * out1_2 + 0.9069 * out1_1 + 0.2231 * out2_1 + 0.1495 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0533 * out1_2 + 0.4467 * out1_1 + 0.4467 * out2_1 + 0.0533 * out2_2;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0533 * out1_2 + 0.4467 * out1_1 + 0.4467 * out2_1 + 0.0533 * out2_2;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1495 * out1_2 + 0.2231 * out1_1 + 0.9069 * out2_1 - 0.2796 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1495 * out1_2 + 0.2231 * out1_1 + 0.9069 * out2_1 - 0.2796 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0854 * out1_2 + 0.0928 * out1_1 + 1.3397 * out2_1 - 0.5179 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0854 * out1_2 + 0.0928 * out1_1 + 1.3397 * out2_1 - 0.5179 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 01002: /* #.......#., <noise^2> = 0, sigma = 1 */
+                    val = 0.8894 * out1_1 + 0.1106 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 01002: /* #.......#., <noise^2> = 0, sigma = 1 */
-                        val = 0.8894 * out1_1 + 0.1106 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6839 * out1_1 + 0.3161 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6839 * out1_1 + 0.3161 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5517 * out1_1 + 0.4483 * out2_1;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5517 * out1_1 + 0.4483 * out2_1;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5000 * out1_1 + 0.5000 * out2_1;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5000 * out1_1 + 0.5000 * out2_1;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4483 * out1_1 + 0.5517 * out2_1;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4483 * out1_1 + 0.5517 * out2_1;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3161 * out1_1 + 0.6839 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3161 * out1_1 + 0.6839 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1106 * out1_1 + 0.8894 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1106 * out1_1 + 0.8894 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 01003: /* #.......##, <noise^2> = 0 */
+                    val = 0.8829 * out1_1 + 0.0585 * out2_1 + 0.0585 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 01003: /* #.......##, <noise^2> = 0 */
-                        val = 0.8829 * out1_1 + 0.0585 * out2_1 + 0.0585 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6654 * out1_1 + 0.1676 * out2_1 + 0.1670 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6654 * out1_1 + 0.1676 * out2_1 + 0.1670 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5260 * out1_1 + 0.2411 * out2_1 + 0.2329 * out2_2;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5260 * out1_1 + 0.2411 * out2_1 + 0.2329 * out2_2;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4751 * out1_1 + 0.2995 * out2_1 + 0.2254 * out2_2;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4751 * out1_1 + 0.2995 * out2_1 + 0.2254 * out2_2;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4390 * out1_1 + 0.4773 * out2_1 + 0.0836 * out2_2;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4390 * out1_1 + 0.4773 * out2_1 + 0.0836 * out2_2;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3456 * out1_1 + 0.9205 * out2_1 - 0.2661 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3456 * out1_1 + 0.9205 * out2_1 - 0.2661 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1673 * out1_1 + 1.3452 * out2_1 - 0.5125 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1673 * out1_1 + 1.3452 * out2_1 - 0.5125 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 01402: /* ##......#., <noise^2> = 0 */
+                    val = -0.5125 * out1_2 + 1.3452 * out1_1 + 0.1673 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 01402: /* ##......#., <noise^2> = 0 */
-                        val = -0.5125 * out1_2 + 1.3452 * out1_1 + 0.1673 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2666 * out1_2 + 0.9201 * out1_1 + 0.3465 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2666 * out1_2 + 0.9201 * out1_1 + 0.3465 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0793 * out1_2 + 0.4730 * out1_1 + 0.4477 * out2_1;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0793 * out1_2 + 0.4730 * out1_1 + 0.4477 * out2_1;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2024 * out1_2 + 0.2765 * out1_1 + 0.5212 * out2_1;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2024 * out1_2 + 0.2765 * out1_1 + 0.5212 * out2_1;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1635 * out1_2 + 0.1716 * out1_1 + 0.6649 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1635 * out1_2 + 0.1716 * out1_1 + 0.6649 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0583 * out1_2 + 0.0588 * out1_1 + 0.8829 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0583 * out1_2 + 0.0588 * out1_1 + 0.8829 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 01403: /* ##......##, <noise^2> = 0 */
+                    val = -0.5177 * out1_2 + 1.3400 * out1_1 + 0.0891 * out2_1 + 0.0886 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 01403: /* ##......##, <noise^2> = 0 */
-                        val = -0.5177 * out1_2 + 1.3400 * out1_1 + 0.0891 * out2_1 + 0.0886 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2771 * out1_2 + 0.9095 * out1_1 + 0.1878 * out2_1 + 0.1797 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2771 * out1_2 + 0.9095 * out1_1 + 0.1878 * out2_1 + 0.1797 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0677 * out1_2 + 0.4614 * out1_1 + 0.2725 * out2_1 + 0.1984 * out2_2;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0677 * out1_2 + 0.4614 * out1_1 + 0.2725 * out2_1 + 0.1984 * out2_2;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1984 * out1_2 + 0.2725 * out1_1 + 0.4614 * out2_1 + 0.0677 * out2_2;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1984 * out1_2 + 0.2725 * out1_1 + 0.4614 * out2_1 + 0.0677 * out2_2;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1797 * out1_2 + 0.1878 * out1_1 + 0.9095 * out2_1 - 0.2771 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1797 * out1_2 + 0.1878 * out1_1 + 0.9095 * out2_1 - 0.2771 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0886 * out1_2 + 0.0891 * out1_1 + 1.3400 * out2_1 - 0.5177 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0886 * out1_2 + 0.0891 * out1_1 + 1.3400 * out2_1 - 0.5177 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 02002: /* #........#., <noise^2> = 0, sigma = 1 */
+                    val = 0.8894 * out1_1 + 0.1106 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 02002: /* #........#., <noise^2> = 0, sigma = 1 */
-                        val = 0.8894 * out1_1 + 0.1106 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6839 * out1_1 + 0.3161 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6839 * out1_1 + 0.3161 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5526 * out1_1 + 0.4474 * out2_1;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5526 * out1_1 + 0.4474 * out2_1;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5082 * out1_1 + 0.4918 * out2_1;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5082 * out1_1 + 0.4918 * out2_1;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4918 * out1_1 + 0.5082 * out2_1;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4918 * out1_1 + 0.5082 * out2_1;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4474 * out1_1 + 0.5526 * out2_1;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4474 * out1_1 + 0.5526 * out2_1;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3161 * out1_1 + 0.6839 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3161 * out1_1 + 0.6839 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1106 * out1_1 + 0.8894 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1106 * out1_1 + 0.8894 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 02003: /* #........##, <noise^2> = 0 */
+                    val = 0.8829 * out1_1 + 0.0585 * out2_1 + 0.0585 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 02003: /* #........##, <noise^2> = 0 */
-                        val = 0.8829 * out1_1 + 0.0585 * out2_1 + 0.0585 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6654 * out1_1 + 0.1673 * out2_1 + 0.1673 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6654 * out1_1 + 0.1673 * out2_1 + 0.1673 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5265 * out1_1 + 0.2370 * out2_1 + 0.2365 * out2_2;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5265 * out1_1 + 0.2370 * out2_1 + 0.2365 * out2_2;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4799 * out1_1 + 0.2641 * out2_1 + 0.2560 * out2_2;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4799 * out1_1 + 0.2641 * out2_1 + 0.2560 * out2_2;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4664 * out1_1 + 0.3038 * out2_1 + 0.2298 * out2_2;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4664 * out1_1 + 0.3038 * out2_1 + 0.2298 * out2_2;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4381 * out1_1 + 0.4778 * out2_1 + 0.0841 * out2_2;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4381 * out1_1 + 0.4778 * out2_1 + 0.0841 * out2_2;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3455 * out1_1 + 0.9206 * out2_1 - 0.2661 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3455 * out1_1 + 0.9206 * out2_1 - 0.2661 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1673 * out1_1 + 1.3452 * out2_1 - 0.5125 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1673 * out1_1 + 1.3452 * out2_1 - 0.5125 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 03002: /* ##.......#., <noise^2> = 0 */
+                    val = -0.5125 * out1_2 + 1.3452 * out1_1 + 0.1673 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 03002: /* ##.......#., <noise^2> = 0 */
-                        val = -0.5125 * out1_2 + 1.3452 * out1_1 + 0.1673 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2661 * out1_2 + 0.9205 * out1_1 + 0.3456 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2661 * out1_2 + 0.9205 * out1_1 + 0.3456 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0836 * out1_2 + 0.4773 * out1_1 + 0.4390 * out2_1;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0836 * out1_2 + 0.4773 * out1_1 + 0.4390 * out2_1;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2254 * out1_2 + 0.2995 * out1_1 + 0.4751 * out2_1;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2254 * out1_2 + 0.2995 * out1_1 + 0.4751 * out2_1;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2329 * out1_2 + 0.2411 * out1_1 + 0.5260 * out2_1;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2329 * out1_2 + 0.2411 * out1_1 + 0.5260 * out2_1;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1670 * out1_2 + 0.1676 * out1_1 + 0.6654 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1670 * out1_2 + 0.1676 * out1_1 + 0.6654 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0585 * out1_2 + 0.0585 * out1_1 + 0.8829 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0585 * out1_2 + 0.0585 * out1_1 + 0.8829 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 03003: /* ##.......##, <noise^2> = 0 */
+                    val = -0.5177 * out1_2 + 1.3400 * out1_1 + 0.0889 * out2_1 + 0.0888 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 03003: /* ##.......##, <noise^2> = 0 */
-                        val = -0.5177 * out1_2 + 1.3400 * out1_1 + 0.0889 * out2_1 + 0.0888 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2768 * out1_2 + 0.9098 * out1_1 + 0.1838 * out2_1 + 0.1832 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2768 * out1_2 + 0.9098 * out1_1 + 0.1838 * out2_1 + 0.1832 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0703 * out1_2 + 0.4639 * out1_1 + 0.2370 * out2_1 + 0.2288 * out2_2;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0703 * out1_2 + 0.4639 * out1_1 + 0.2370 * out2_1 + 0.2288 * out2_2;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2130 * out1_2 + 0.2870 * out1_1 + 0.2870 * out2_1 + 0.2130 * out2_2;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2130 * out1_2 + 0.2870 * out1_1 + 0.2870 * out2_1 + 0.2130 * out2_2;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2288 * out1_2 + 0.2370 * out1_1 + 0.4639 * out2_1 + 0.0703 * out2_2;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2288 * out1_2 + 0.2370 * out1_1 + 0.4639 * out2_1 + 0.0703 * out2_2;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1832 * out1_2 + 0.1838 * out1_1 + 0.9098 * out2_1 - 0.2768 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1832 * out1_2 + 0.1838 * out1_1 + 0.9098 * out2_1 - 0.2768 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0888 * out1_2 + 0.0889 * out1_1 + 1.3400 * out2_1 - 0.5177 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0888 * out1_2 + 0.0889 * out1_1 + 1.3400 * out2_1 - 0.5177 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 04002: /* #.........#., <noise^2> = 0 */
+                    val = 0.8894 * out1_1 + 0.1106 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 04002: /* #.........#., <noise^2> = 0 */
-                        val = 0.8894 * out1_1 + 0.1106 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6839 * out1_1 + 0.3161 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6839 * out1_1 + 0.3161 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5527 * out1_1 + 0.4473 * out2_1;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5527 * out1_1 + 0.4473 * out2_1;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5091 * out1_1 + 0.4909 * out2_1;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5091 * out1_1 + 0.4909 * out2_1;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5000 * out1_1 + 0.5000 * out2_1;
+                    out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5000 * out1_1 + 0.5000 * out2_1;
-                        out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4909 * out1_1 + 0.5091 * out2_1;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4909 * out1_1 + 0.5091 * out2_1;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4473 * out1_1 + 0.5527 * out2_1;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4473 * out1_1 + 0.5527 * out2_1;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3161 * out1_1 + 0.6839 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3161 * out1_1 + 0.6839 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1106 * out1_1 + 0.8894 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1106 * out1_1 + 0.8894 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 04003: /* #.........##, <noise^2> = 0 */
+                    val = 0.8829 * out1_1 + 0.0585 * out2_1 + 0.0585 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 04003: /* #.........##, <noise^2> = 0 */
-                        val = 0.8829 * out1_1 + 0.0585 * out2_1 + 0.0585 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6654 * out1_1 + 0.1673 * out2_1 + 0.1673 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6654 * out1_1 + 0.1673 * out2_1 + 0.1673 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5265 * out1_1 + 0.2368 * out2_1 + 0.2367 * out2_2;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5265 * out1_1 + 0.2368 * out2_1 + 0.2367 * out2_2;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4804 * out1_1 + 0.2601 * out2_1 + 0.2595 * out2_2;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4804 * out1_1 + 0.2601 * out2_1 + 0.2595 * out2_2;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4712 * out1_1 + 0.2685 * out2_1 + 0.2603 * out2_2;
+                    out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4712 * out1_1 + 0.2685 * out2_1 + 0.2603 * out2_2;
-                        out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4654 * out1_1 + 0.3043 * out2_1 + 0.2302 * out2_2;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4654 * out1_1 + 0.3043 * out2_1 + 0.2302 * out2_2;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4380 * out1_1 + 0.4778 * out2_1 + 0.0842 * out2_2;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4380 * out1_1 + 0.4778 * out2_1 + 0.0842 * out2_2;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3455 * out1_1 + 0.9206 * out2_1 - 0.2661 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3455 * out1_1 + 0.9206 * out2_1 - 0.2661 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1673 * out1_1 + 1.3452 * out2_1 - 0.5125 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1673 * out1_1 + 1.3452 * out2_1 - 0.5125 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 06002: /* ##........#., <noise^2> = 0 */
+                    val = -0.5125 * out1_2 + 1.3452 * out1_1 + 0.1673 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 06002: /* ##........#., <noise^2> = 0 */
-                        val = -0.5125 * out1_2 + 1.3452 * out1_1 + 0.1673 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2661 * out1_2 + 0.9206 * out1_1 + 0.3455 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2661 * out1_2 + 0.9206 * out1_1 + 0.3455 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0841 * out1_2 + 0.4778 * out1_1 + 0.4381 * out2_1;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0841 * out1_2 + 0.4778 * out1_1 + 0.4381 * out2_1;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2298 * out1_2 + 0.3038 * out1_1 + 0.4664 * out2_1;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2298 * out1_2 + 0.3038 * out1_1 + 0.4664 * out2_1;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2560 * out1_2 + 0.2641 * out1_1 + 0.4799 * out2_1;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2560 * out1_2 + 0.2641 * out1_1 + 0.4799 * out2_1;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2365 * out1_2 + 0.2370 * out1_1 + 0.5265 * out2_1;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2365 * out1_2 + 0.2370 * out1_1 + 0.5265 * out2_1;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1673 * out1_2 + 0.1673 * out1_1 + 0.6654 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1673 * out1_2 + 0.1673 * out1_1 + 0.6654 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0585 * out1_2 + 0.0585 * out1_1 + 0.8829 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0585 * out1_2 + 0.0585 * out1_1 + 0.8829 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 06003: /* ##........##, <noise^2> = 0 */
+                    val = -0.5177 * out1_2 + 1.3400 * out1_1 + 0.0888 * out2_1 + 0.0888 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 06003: /* ##........##, <noise^2> = 0 */
-                        val = -0.5177 * out1_2 + 1.3400 * out1_1 + 0.0888 * out2_1 + 0.0888 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2768 * out1_2 + 0.9098 * out1_1 + 0.1835 * out2_1 + 0.1835 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2768 * out1_2 + 0.9098 * out1_1 + 0.1835 * out2_1 + 0.1835 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0705 * out1_2 + 0.4642 * out1_1 + 0.2329 * out2_1 + 0.2324 * out2_2;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0705 * out1_2 + 0.4642 * out1_1 + 0.2329 * out2_1 + 0.2324 * out2_2;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2155 * out1_2 + 0.2896 * out1_1 + 0.2515 * out2_1 + 0.2434 * out2_2;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2155 * out1_2 + 0.2896 * out1_1 + 0.2515 * out2_1 + 0.2434 * out2_2;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2434 * out1_2 + 0.2515 * out1_1 + 0.2896 * out2_1 + 0.2155 * out2_2;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2434 * out1_2 + 0.2515 * out1_1 + 0.2896 * out2_1 + 0.2155 * out2_2;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2324 * out1_2 + 0.2329 * out1_1 + 0.4642 * out2_1 + 0.0705 * out2_2;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2324 * out1_2 + 0.2329 * out1_1 + 0.4642 * out2_1 + 0.0705 * out2_2;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1835 * out1_2 + 0.1835 * out1_1 + 0.9098 * out2_1 - 0.2768 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1835 * out1_2 + 0.1835 * out1_1 + 0.9098 * out2_1 - 0.2768 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0888 * out1_2 + 0.0888 * out1_1 + 1.3400 * out2_1 - 0.5177 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0888 * out1_2 + 0.0888 * out1_1 + 1.3400 * out2_1 - 0.5177 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 010002: /* #..........#., <noise^2> = 0, sigma = 1 */
+                    val = 0.8894 * out1_1 + 0.1106 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 010002: /* #..........#., <noise^2> = 0, sigma = 1 */
-                        val = 0.8894 * out1_1 + 0.1106 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6839 * out1_1 + 0.3161 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6839 * out1_1 + 0.3161 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5527 * out1_1 + 0.4473 * out2_1;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5527 * out1_1 + 0.4473 * out2_1;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5092 * out1_1 + 0.4908 * out2_1;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5092 * out1_1 + 0.4908 * out2_1;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5009 * out1_1 + 0.4991 * out2_1;
+                    out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5009 * out1_1 + 0.4991 * out2_1;
-                        out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4991 * out1_1 + 0.5009 * out2_1;
+                    out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4991 * out1_1 + 0.5009 * out2_1;
-                        out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4908 * out1_1 + 0.5092 * out2_1;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4908 * out1_1 + 0.5092 * out2_1;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4473 * out1_1 + 0.5527 * out2_1;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4473 * out1_1 + 0.5527 * out2_1;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3161 * out1_1 + 0.6839 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3161 * out1_1 + 0.6839 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1106 * out1_1 + 0.8894 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1106 * out1_1 + 0.8894 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 010003: /* #..........##, <noise^2> = 0 */
+                    val = 0.8829 * out1_1 + 0.0585 * out2_1 + 0.0585 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 010003: /* #..........##, <noise^2> = 0 */
-                        val = 0.8829 * out1_1 + 0.0585 * out2_1 + 0.0585 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6654 * out1_1 + 0.1673 * out2_1 + 0.1673 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6654 * out1_1 + 0.1673 * out2_1 + 0.1673 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5265 * out1_1 + 0.2367 * out2_1 + 0.2367 * out2_2;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5265 * out1_1 + 0.2367 * out2_1 + 0.2367 * out2_2;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4804 * out1_1 + 0.2598 * out2_1 + 0.2598 * out2_2;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4804 * out1_1 + 0.2598 * out2_1 + 0.2598 * out2_2;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4717 * out1_1 + 0.2644 * out2_1 + 0.2639 * out2_2;
+                    out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4717 * out1_1 + 0.2644 * out2_1 + 0.2639 * out2_2;
-                        out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4703 * out1_1 + 0.2690 * out2_1 + 0.2608 * out2_2;
+                    out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4703 * out1_1 + 0.2690 * out2_1 + 0.2608 * out2_2;
-                        out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4654 * out1_1 + 0.3043 * out2_1 + 0.2303 * out2_2;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4654 * out1_1 + 0.3043 * out2_1 + 0.2303 * out2_2;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4380 * out1_1 + 0.4778 * out2_1 + 0.0842 * out2_2;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4380 * out1_1 + 0.4778 * out2_1 + 0.0842 * out2_2;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3455 * out1_1 + 0.9206 * out2_1 - 0.2661 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3455 * out1_1 + 0.9206 * out2_1 - 0.2661 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1673 * out1_1 + 1.3452 * out2_1 - 0.5125 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1673 * out1_1 + 1.3452 * out2_1 - 0.5125 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 014002: /* ##.........#., <noise^2> = 0 */
+                    val = -0.5125 * out1_2 + 1.3452 * out1_1 + 0.1673 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 014002: /* ##.........#., <noise^2> = 0 */
-                        val = -0.5125 * out1_2 + 1.3452 * out1_1 + 0.1673 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2661 * out1_2 + 0.9206 * out1_1 + 0.3455 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2661 * out1_2 + 0.9206 * out1_1 + 0.3455 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0842 * out1_2 + 0.4778 * out1_1 + 0.4380 * out2_1;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0842 * out1_2 + 0.4778 * out1_1 + 0.4380 * out2_1;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2302 * out1_2 + 0.3043 * out1_1 + 0.4654 * out2_1;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2302 * out1_2 + 0.3043 * out1_1 + 0.4654 * out2_1;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2603 * out1_2 + 0.2685 * out1_1 + 0.4712 * out2_1;
+                    out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2603 * out1_2 + 0.2685 * out1_1 + 0.4712 * out2_1;
-                        out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2595 * out1_2 + 0.2601 * out1_1 + 0.4804 * out2_1;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2595 * out1_2 + 0.2601 * out1_1 + 0.4804 * out2_1;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2367 * out1_2 + 0.2368 * out1_1 + 0.5265 * out2_1;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2367 * out1_2 + 0.2368 * out1_1 + 0.5265 * out2_1;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1673 * out1_2 + 0.1673 * out1_1 + 0.6654 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1673 * out1_2 + 0.1673 * out1_1 + 0.6654 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0585 * out1_2 + 0.0585 * out1_1 + 0.8829 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0585 * out1_2 + 0.0585 * out1_1 + 0.8829 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 014003: /* ##.........##, <noise^2> = 0 */
+                    val = -0.5177 * out1_2 + 1.3400 * out1_1 + 0.0888 * out2_1 + 0.0888 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 014003: /* ##.........##, <noise^2> = 0 */
-                        val = -0.5177 * out1_2 + 1.3400 * out1_1 + 0.0888 * out2_1 + 0.0888 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2768 * out1_2 + 0.9098 * out1_1 + 0.1835 * out2_1 + 0.1835 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2768 * out1_2 + 0.9098 * out1_1 + 0.1835 * out2_1 + 0.1835 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0705 * out1_2 + 0.4642 * out1_1 + 0.2326 * out2_1 + 0.2326 * out2_2;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0705 * out1_2 + 0.4642 * out1_1 + 0.2326 * out2_1 + 0.2326 * out2_2;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2158 * out1_2 + 0.2899 * out1_1 + 0.2474 * out2_1 + 0.2469 * out2_2;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2158 * out1_2 + 0.2899 * out1_1 + 0.2474 * out2_1 + 0.2469 * out2_2;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2459 * out1_2 + 0.2541 * out1_1 + 0.2541 * out2_1 + 0.2459 * out2_2;
+                    out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2459 * out1_2 + 0.2541 * out1_1 + 0.2541 * out2_1 + 0.2459 * out2_2;
-                        out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2469 * out1_2 + 0.2474 * out1_1 + 0.2899 * out2_1 + 0.2158 * out2_2;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2469 * out1_2 + 0.2474 * out1_1 + 0.2899 * out2_1 + 0.2158 * out2_2;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2326 * out1_2 + 0.2326 * out1_1 + 0.4642 * out2_1 + 0.0705 * out2_2;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2326 * out1_2 + 0.2326 * out1_1 + 0.4642 * out2_1 + 0.0705 * out2_2;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1835 * out1_2 + 0.1835 * out1_1 + 0.9098 * out2_1 - 0.2768 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1835 * out1_2 + 0.1835 * out1_1 + 0.9098 * out2_1 - 0.2768 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0888 * out1_2 + 0.0888 * out1_1 + 1.3400 * out2_1 - 0.5177 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0888 * out1_2 + 0.0888 * out1_1 + 1.3400 * out2_1 - 0.5177 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 020003: /* #...........##, <noise^2> = 0 */
+                    val = 0.8829 * out1_1 + 0.0585 * out2_1 + 0.0585 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 020003: /* #...........##, <noise^2> = 0 */
-                        val = 0.8829 * out1_1 + 0.0585 * out2_1 + 0.0585 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6654 * out1_1 + 0.1673 * out2_1 + 0.1673 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6654 * out1_1 + 0.1673 * out2_1 + 0.1673 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5265 * out1_1 + 0.2367 * out2_1 + 0.2367 * out2_2;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5265 * out1_1 + 0.2367 * out2_1 + 0.2367 * out2_2;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4804 * out1_1 + 0.2598 * out2_1 + 0.2598 * out2_2;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4804 * out1_1 + 0.2598 * out2_1 + 0.2598 * out2_2;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4718 * out1_1 + 0.2641 * out2_1 + 0.2641 * out2_2;
+                    out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4718 * out1_1 + 0.2641 * out2_1 + 0.2641 * out2_2;
-                        out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4708 * out1_1 + 0.2649 * out2_1 + 0.2644 * out2_2;
+                    out[badX1 - 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4708 * out1_1 + 0.2649 * out2_1 + 0.2644 * out2_2;
-                        out[badX1 - 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4702 * out1_1 + 0.2690 * out2_1 + 0.2608 * out2_2;
+                    out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4702 * out1_1 + 0.2690 * out2_1 + 0.2608 * out2_2;
-                        out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4654 * out1_1 + 0.3044 * out2_1 + 0.2303 * out2_2;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4654 * out1_1 + 0.3044 * out2_1 + 0.2303 * out2_2;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4380 * out1_1 + 0.4778 * out2_1 + 0.0842 * out2_2;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4380 * out1_1 + 0.4778 * out2_1 + 0.0842 * out2_2;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3455 * out1_1 + 0.9206 * out2_1 - 0.2661 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3455 * out1_1 + 0.9206 * out2_1 - 0.2661 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1673 * out1_1 + 1.3452 * out2_1 - 0.5125 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1673 * out1_1 + 1.3452 * out2_1 - 0.5125 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 030002: /* ##..........#., <noise^2> = 0 */
+                    val = -0.5125 * out1_2 + 1.3452 * out1_1 + 0.1673 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 030002: /* ##..........#., <noise^2> = 0 */
-                        val = -0.5125 * out1_2 + 1.3452 * out1_1 + 0.1673 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2661 * out1_2 + 0.9206 * out1_1 + 0.3455 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2661 * out1_2 + 0.9206 * out1_1 + 0.3455 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0842 * out1_2 + 0.4778 * out1_1 + 0.4380 * out2_1;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0842 * out1_2 + 0.4778 * out1_1 + 0.4380 * out2_1;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2303 * out1_2 + 0.3043 * out1_1 + 0.4654 * out2_1;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2303 * out1_2 + 0.3043 * out1_1 + 0.4654 * out2_1;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2608 * out1_2 + 0.2690 * out1_1 + 0.4703 * out2_1;
+                    out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2608 * out1_2 + 0.2690 * out1_1 + 0.4703 * out2_1;
-                        out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2639 * out1_2 + 0.2644 * out1_1 + 0.4717 * out2_1;
+                    out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2639 * out1_2 + 0.2644 * out1_1 + 0.4717 * out2_1;
-                        out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2598 * out1_2 + 0.2598 * out1_1 + 0.4804 * out2_1;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2598 * out1_2 + 0.2598 * out1_1 + 0.4804 * out2_1;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2367 * out1_2 + 0.2367 * out1_1 + 0.5265 * out2_1;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2367 * out1_2 + 0.2367 * out1_1 + 0.5265 * out2_1;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1673 * out1_2 + 0.1673 * out1_1 + 0.6654 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1673 * out1_2 + 0.1673 * out1_1 + 0.6654 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0585 * out1_2 + 0.0585 * out1_1 + 0.8829 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0585 * out1_2 + 0.0585 * out1_1 + 0.8829 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 030003: /* ##..........##, <noise^2> = 0 */
+                    val = -0.5177 * out1_2 + 1.3400 * out1_1 + 0.0888 * out2_1 + 0.0888 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 030003: /* ##..........##, <noise^2> = 0 */
-                        val = -0.5177 * out1_2 + 1.3400 * out1_1 + 0.0888 * out2_1 + 0.0888 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2768 * out1_2 + 0.9098 * out1_1 + 0.1835 * out2_1 + 0.1835 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2768 * out1_2 + 0.9098 * out1_1 + 0.1835 * out2_1 + 0.1835 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0705 * out1_2 + 0.4642 * out1_1 + 0.2326 * out2_1 + 0.2326 * out2_2;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0705 * out1_2 + 0.4642 * out1_1 + 0.2326 * out2_1 + 0.2326 * out2_2;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2158 * out1_2 + 0.2899 * out1_1 + 0.2472 * out2_1 + 0.2471 * out2_2;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2158 * out1_2 + 0.2899 * out1_1 + 0.2472 * out2_1 + 0.2471 * out2_2;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2462 * out1_2 + 0.2544 * out1_1 + 0.2500 * out2_1 + 0.2495 * out2_2;
+                    out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2462 * out1_2 + 0.2544 * out1_1 + 0.2500 * out2_1 + 0.2495 * out2_2;
-                        out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2495 * out1_2 + 0.2500 * out1_1 + 0.2544 * out2_1 + 0.2462 * out2_2;
+                    out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2495 * out1_2 + 0.2500 * out1_1 + 0.2544 * out2_1 + 0.2462 * out2_2;
-                        out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2471 * out1_2 + 0.2472 * out1_1 + 0.2899 * out2_1 + 0.2158 * out2_2;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2471 * out1_2 + 0.2472 * out1_1 + 0.2899 * out2_1 + 0.2158 * out2_2;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2326 * out1_2 + 0.2326 * out1_1 + 0.4642 * out2_1 + 0.0705 * out2_2;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2326 * out1_2 + 0.2326 * out1_1 + 0.4642 * out2_1 + 0.0705 * out2_2;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1835 * out1_2 + 0.1835 * out1_1 + 0.9098 * out2_1 - 0.2768 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1835 * out1_2 + 0.1835 * out1_1 + 0.9098 * out2_1 - 0.2768 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0888 * out1_2 + 0.0888 * out1_1 + 1.3400 * out2_1 - 0.5177 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0888 * out1_2 + 0.0888 * out1_1 + 1.3400 * out2_1 - 0.5177 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 040003: /* #............##, <noise^2> = 0 */
+                    val = 0.8829 * out1_1 + 0.0585 * out2_1 + 0.0585 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 040003: /* #............##, <noise^2> = 0 */
-                        val = 0.8829 * out1_1 + 0.0585 * out2_1 + 0.0585 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6654 * out1_1 + 0.1673 * out2_1 + 0.1673 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6654 * out1_1 + 0.1673 * out2_1 + 0.1673 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5265 * out1_1 + 0.2367 * out2_1 + 0.2367 * out2_2;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5265 * out1_1 + 0.2367 * out2_1 + 0.2367 * out2_2;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4804 * out1_1 + 0.2598 * out2_1 + 0.2598 * out2_2;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4804 * out1_1 + 0.2598 * out2_1 + 0.2598 * out2_2;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4718 * out1_1 + 0.2641 * out2_1 + 0.2641 * out2_2;
+                    out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4718 * out1_1 + 0.2641 * out2_1 + 0.2641 * out2_2;
-                        out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4708 * out1_1 + 0.2646 * out2_1 + 0.2646 * out2_2;
+                    out[badX0 + 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4708 * out1_1 + 0.2646 * out2_1 + 0.2646 * out2_2;
-                        out[badX0 + 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4707 * out1_1 + 0.2649 * out2_1 + 0.2644 * out2_2;
+                    out[badX1 - 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4707 * out1_1 + 0.2649 * out2_1 + 0.2644 * out2_2;
-                        out[badX1 - 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4702 * out1_1 + 0.2690 * out2_1 + 0.2608 * out2_2;
+                    out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4702 * out1_1 + 0.2690 * out2_1 + 0.2608 * out2_2;
-                        out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4654 * out1_1 + 0.3044 * out2_1 + 0.2303 * out2_2;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4654 * out1_1 + 0.3044 * out2_1 + 0.2303 * out2_2;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4380 * out1_1 + 0.4778 * out2_1 + 0.0842 * out2_2;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4380 * out1_1 + 0.4778 * out2_1 + 0.0842 * out2_2;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3455 * out1_1 + 0.9206 * out2_1 - 0.2661 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3455 * out1_1 + 0.9206 * out2_1 - 0.2661 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1673 * out1_1 + 1.3452 * out2_1 - 0.5125 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1673 * out1_1 + 1.3452 * out2_1 - 0.5125 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 060002: /* ##...........#., <noise^2> = 0 */
+                    val = -0.5125 * out1_2 + 1.3452 * out1_1 + 0.1673 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 060002: /* ##...........#., <noise^2> = 0 */
-                        val = -0.5125 * out1_2 + 1.3452 * out1_1 + 0.1673 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2661 * out1_2 + 0.9206 * out1_1 + 0.3455 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2661 * out1_2 + 0.9206 * out1_1 + 0.3455 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0842 * out1_2 + 0.4778 * out1_1 + 0.4380 * out2_1;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0842 * out1_2 + 0.4778 * out1_1 + 0.4380 * out2_1;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2303 * out1_2 + 0.3044 * out1_1 + 0.4654 * out2_1;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2303 * out1_2 + 0.3044 * out1_1 + 0.4654 * out2_1;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2608 * out1_2 + 0.2690 * out1_1 + 0.4702 * out2_1;
+                    out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2608 * out1_2 + 0.2690 * out1_1 + 0.4702 * out2_1;
-                        out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2644 * out1_2 + 0.2649 * out1_1 + 0.4708 * out2_1;
+                    out[badX1 - 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2644 * out1_2 + 0.2649 * out1_1 + 0.4708 * out2_1;
-                        out[badX1 - 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2641 * out1_2 + 0.2641 * out1_1 + 0.4718 * out2_1;
+                    out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2641 * out1_2 + 0.2641 * out1_1 + 0.4718 * out2_1;
-                        out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2598 * out1_2 + 0.2598 * out1_1 + 0.4804 * out2_1;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2598 * out1_2 + 0.2598 * out1_1 + 0.4804 * out2_1;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2367 * out1_2 + 0.2367 * out1_1 + 0.5265 * out2_1;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2367 * out1_2 + 0.2367 * out1_1 + 0.5265 * out2_1;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1673 * out1_2 + 0.1673 * out1_1 + 0.6654 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1673 * out1_2 + 0.1673 * out1_1 + 0.6654 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0585 * out1_2 + 0.0585 * out1_1 + 0.8829 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0585 * out1_2 + 0.0585 * out1_1 + 0.8829 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                default:
+                    // shFatal("Unsupported defect type: MIDDLE 0%o",defect[i].type);
+                    break; /* NOTREACHED */
+            }
+            break;
+        case Defect::WIDE:
+        case Defect::WIDE_NEAR_LEFT:
+        case Defect::WIDE_NEAR_RIGHT:
+            if (defectPos == Defect::WIDE_NEAR_LEFT) {
+                assert(badX0 >= 1);
 
-                        break;
-                    default:
-                        // shFatal("Unsupported defect type: MIDDLE 0%o",defect[i].type);
-                        break; /* NOTREACHED */
+                if (badX1 + 2 >= ncol) {     /* left defect extends near
+                                                right edge of data! */
+                    if (badX1 == ncol - 2) { /* one column remains */
+                        val = out[ncol - 1];
+                    } else {
+                        val = fallbackValue; /* there is no information */
+                    }
+                    for (int j = badX0; j <= badX1; j++) {
+                        out[j] = val;
+                    }
+                    break;
                 }
-                break;
-            case Defect::WIDE:
-            case Defect::WIDE_NEAR_LEFT:
-            case Defect::WIDE_NEAR_RIGHT:
-                if (defectPos == Defect::WIDE_NEAR_LEFT) {
-                    assert(badX0 >= 1);
-
-                    if (badX1 + 2 >= ncol) {     /* left defect extends near
-                                                    right edge of data! */
-                        if (badX1 == ncol - 2) { /* one column remains */
-                            val = out[ncol - 1];
-                        } else {
-                            val = fallbackValue; /* there is no information */
-                        }
-                        for (int j = badX0; j <= badX1; j++) {
-                            out[j] = val;
-                        }
-                        break;
+                out1_2 = -1; /* NOTUSED */
+                out2_2 = out[badX1 + 2];
+            } else if (defectPos == Defect::WIDE) {
+                assert(badX0 >= 2 && badX1 + 2 < ncol);
+                out1_2 = out[badX0 - 2];
+                out2_2 = out[badX1 + 2];
+            } else if (defectPos == Defect::WIDE_NEAR_RIGHT) {
+                assert(badX1 + 1 < ncol);
+
+                if (badX0 < 2) {      /* right defect extends near
+                                         left edge of data! */
+                    if (badX0 == 1) { /* one column remains */
+                        val = out[0];
+                    } else {
+                        val = fallbackValue; /* there is no information */
                     }
-                    out1_2 = -1; /* NOTUSED */
-                    out2_2 = out[badX1 + 2];
-                } else if (defectPos == Defect::WIDE) {
-                    assert(badX0 >= 2 && badX1 + 2 < ncol);
-                    out1_2 = out[badX0 - 2];
-                    out2_2 = out[badX1 + 2];
-                } else if (defectPos == Defect::WIDE_NEAR_RIGHT) {
-                    assert(badX1 + 1 < ncol);
-
-                    if (badX0 < 2) {      /* right defect extends near
-                                             left edge of data! */
-                        if (badX0 == 1) { /* one column remains */
-                            val = out[0];
-                        } else {
-                            val = fallbackValue; /* there is no information */
-                        }
-                        for (int j = badX0; j <= badX1; j++) {
-                            out[j] = val;
-                        }
-                        break;
+                    for (int j = badX0; j <= badX1; j++) {
+                        out[j] = val;
                     }
-                    out1_2 = out[badX0 - 2];
-                    out2_2 = -1; /* NOTUSED */
-                } else {
-                    // shFatal("Unknown defect classification %d (%s:%d)",defectPos, __FILE__,__LINE__);
-                    out1_2 = out2_2 = -1; /* NOTUSED */
+                    break;
                 }
+                out1_2 = out[badX0 - 2];
+                out2_2 = -1; /* NOTUSED */
+            } else {
+                // shFatal("Unknown defect classification %d (%s:%d)",defectPos, __FILE__,__LINE__);
+                out1_2 = out2_2 = -1; /* NOTUSED */
+            }
 
-                out1_1 = out[badX0 - 1];
-                out2_1 = out[badX1 + 1];
+            out1_1 = out[badX0 - 1];
+            out2_1 = out[badX1 + 1];
 
-                switch (defectType) {
-                    case 06: /* #?#., <noise^2> = 0 */
-                        val = 0.8894 * out1_1 + 0.1106 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+            switch (defectType) {
+                case 06: /* #?#., <noise^2> = 0 */
+                    val = 0.8894 * out1_1 + 0.1106 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6839 * out1_1 + 0.3161 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6839 * out1_1 + 0.3161 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5527 * out1_1 + 0.4473 * out2_1;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5527 * out1_1 + 0.4473 * out2_1;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5092 * out1_1 + 0.4908 * out2_1;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5092 * out1_1 + 0.4908 * out2_1;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5010 * out1_1 + 0.4990 * out2_1;
-                        out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5010 * out1_1 + 0.4990 * out2_1;
+                    out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5001 * out1_1 + 0.4999 * out2_1;
-                        out[badX0 + 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5001 * out1_1 + 0.4999 * out2_1;
+                    out[badX0 + 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5000 * out1_1 + 0.5000 * out2_1;
+                    val = 0.5000 * out1_1 + 0.5000 * out2_1;
 
-                        for (int j = badX0 + 6; j < badX1 - 5; j++) {
-                            out[j] = val;
-                        }
+                    for (int j = badX0 + 6; j < badX1 - 5; j++) {
+                        out[j] = val;
+                    }
 
-                        val = 0.4999 * out1_1 + 0.5001 * out2_1;
-                        out[badX1 - 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4999 * out1_1 + 0.5001 * out2_1;
+                    out[badX1 - 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4990 * out1_1 + 0.5010 * out2_1;
-                        out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4990 * out1_1 + 0.5010 * out2_1;
+                    out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4908 * out1_1 + 0.5092 * out2_1;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4908 * out1_1 + 0.5092 * out2_1;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4473 * out1_1 + 0.5527 * out2_1;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4473 * out1_1 + 0.5527 * out2_1;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3161 * out1_1 + 0.6839 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3161 * out1_1 + 0.6839 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1106 * out1_1 + 0.8894 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1106 * out1_1 + 0.8894 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 07: /* #?##, <noise^2> = 0 */
-                        val = 0.8829 * out1_1 + 0.0585 * out2_1 + 0.0585 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 07: /* #?##, <noise^2> = 0 */
+                    val = 0.8829 * out1_1 + 0.0585 * out2_1 + 0.0585 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.6654 * out1_1 + 0.1673 * out2_1 + 0.1673 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.6654 * out1_1 + 0.1673 * out2_1 + 0.1673 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.5265 * out1_1 + 0.2367 * out2_1 + 0.2367 * out2_2;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.5265 * out1_1 + 0.2367 * out2_1 + 0.2367 * out2_2;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4804 * out1_1 + 0.2598 * out2_1 + 0.2598 * out2_2;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4804 * out1_1 + 0.2598 * out2_1 + 0.2598 * out2_2;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4718 * out1_1 + 0.2641 * out2_1 + 0.2641 * out2_2;
-                        out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4718 * out1_1 + 0.2641 * out2_1 + 0.2641 * out2_2;
+                    out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4708 * out1_1 + 0.2646 * out2_1 + 0.2646 * out2_2;
-                        out[badX0 + 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4708 * out1_1 + 0.2646 * out2_1 + 0.2646 * out2_2;
+                    out[badX0 + 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4707 * out[badX0 - 1] + 0.2646 * out[badX1 + 1] + 0.2646 * out[badX1 + 2];
+                    val = 0.4707 * out[badX0 - 1] + 0.2646 * out[badX1 + 1] + 0.2646 * out[badX1 + 2];
 
-                        for (int j = badX0 + 6; j < badX1 - 5; j++) {
-                            out[j] = val;
-                        }
+                    for (int j = badX0 + 6; j < badX1 - 5; j++) {
+                        out[j] = val;
+                    }
 
-                        val = 0.4707 * out1_1 + 0.2649 * out2_1 + 0.2644 * out2_2;
-                        out[badX1 - 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4707 * out1_1 + 0.2649 * out2_1 + 0.2644 * out2_2;
+                    out[badX1 - 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4702 * out1_1 + 0.2690 * out2_1 + 0.2608 * out2_2;
-                        out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4702 * out1_1 + 0.2690 * out2_1 + 0.2608 * out2_2;
+                    out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4654 * out1_1 + 0.3044 * out2_1 + 0.2303 * out2_2;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4654 * out1_1 + 0.3044 * out2_1 + 0.2303 * out2_2;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.4380 * out1_1 + 0.4778 * out2_1 + 0.0842 * out2_2;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.4380 * out1_1 + 0.4778 * out2_1 + 0.0842 * out2_2;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.3455 * out1_1 + 0.9206 * out2_1 - 0.2661 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.3455 * out1_1 + 0.9206 * out2_1 - 0.2661 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1673 * out1_1 + 1.3452 * out2_1 - 0.5125 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1673 * out1_1 + 1.3452 * out2_1 - 0.5125 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 016: /* ##?#., <noise^2> = 0 */
-                        val = -0.5125 * out1_2 + 1.3452 * out1_1 + 0.1673 * out2_1;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 016: /* ##?#., <noise^2> = 0 */
+                    val = -0.5125 * out1_2 + 1.3452 * out1_1 + 0.1673 * out2_1;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2661 * out1_2 + 0.9206 * out1_1 + 0.3455 * out2_1;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2661 * out1_2 + 0.9206 * out1_1 + 0.3455 * out2_1;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0842 * out1_2 + 0.4778 * out1_1 + 0.4380 * out2_1;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0842 * out1_2 + 0.4778 * out1_1 + 0.4380 * out2_1;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2303 * out1_2 + 0.3044 * out1_1 + 0.4654 * out2_1;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2303 * out1_2 + 0.3044 * out1_1 + 0.4654 * out2_1;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2608 * out1_2 + 0.2690 * out1_1 + 0.4702 * out2_1;
-                        out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2608 * out1_2 + 0.2690 * out1_1 + 0.4702 * out2_1;
+                    out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2644 * out1_2 + 0.2649 * out1_1 + 0.4707 * out2_1;
-                        out[badX0 + 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2644 * out1_2 + 0.2649 * out1_1 + 0.4707 * out2_1;
+                    out[badX0 + 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2646 * out1_2 + 0.2646 * out1_1 + 0.4707 * out2_1;
-                        val = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2646 * out1_2 + 0.2646 * out1_1 + 0.4707 * out2_1;
+                    val = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        for (int j = badX0 + 6; j < badX1 - 5; j++) {
-                            out[j] = val;
-                        }
+                    for (int j = badX0 + 6; j < badX1 - 5; j++) {
+                        out[j] = val;
+                    }
 
-                        val = 0.2646 * out1_2 + 0.2646 * out1_1 + 0.4708 * out2_1;
-                        out[badX1 - 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2646 * out1_2 + 0.2646 * out1_1 + 0.4708 * out2_1;
+                    out[badX1 - 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2641 * out1_2 + 0.2641 * out1_1 + 0.4718 * out2_1;
-                        out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2641 * out1_2 + 0.2641 * out1_1 + 0.4718 * out2_1;
+                    out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2598 * out1_2 + 0.2598 * out1_1 + 0.4804 * out2_1;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2598 * out1_2 + 0.2598 * out1_1 + 0.4804 * out2_1;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2367 * out1_2 + 0.2367 * out1_1 + 0.5265 * out2_1;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2367 * out1_2 + 0.2367 * out1_1 + 0.5265 * out2_1;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1673 * out1_2 + 0.1673 * out1_1 + 0.6654 * out2_1;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1673 * out1_2 + 0.1673 * out1_1 + 0.6654 * out2_1;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0585 * out1_2 + 0.0585 * out1_1 + 0.8829 * out2_1;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0585 * out1_2 + 0.0585 * out1_1 + 0.8829 * out2_1;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    case 017: /* ##?##, S/N = infty */
-                        val = -0.5177 * out1_2 + 1.3400 * out1_1 + 0.0888 * out2_1 + 0.0888 * out2_2;
-                        out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    break;
+                case 017: /* ##?##, S/N = infty */
+                    val = -0.5177 * out1_2 + 1.3400 * out1_1 + 0.0888 * out2_1 + 0.0888 * out2_2;
+                    out[badX0] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = -0.2768 * out1_2 + 0.9098 * out1_1 + 0.1835 * out2_1 + 0.1835 * out2_2;
-                        out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = -0.2768 * out1_2 + 0.9098 * out1_1 + 0.1835 * out2_1 + 0.1835 * out2_2;
+                    out[badX0 + 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0705 * out1_2 + 0.4642 * out1_1 + 0.2326 * out2_1 + 0.2326 * out2_2;
-                        out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0705 * out1_2 + 0.4642 * out1_1 + 0.2326 * out2_1 + 0.2326 * out2_2;
+                    out[badX0 + 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2158 * out1_2 + 0.2899 * out1_1 + 0.2472 * out2_1 + 0.2472 * out2_2;
-                        out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2158 * out1_2 + 0.2899 * out1_1 + 0.2472 * out2_1 + 0.2472 * out2_2;
+                    out[badX0 + 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2462 * out1_2 + 0.2544 * out1_1 + 0.2497 * out2_1 + 0.2497 * out2_2;
-                        out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2462 * out1_2 + 0.2544 * out1_1 + 0.2497 * out2_1 + 0.2497 * out2_2;
+                    out[badX0 + 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2497 * out1_2 + 0.2503 * out1_1 + 0.2500 * out2_1 + 0.2500 * out2_2;
-                        out[badX0 + 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2497 * out1_2 + 0.2503 * out1_1 + 0.2500 * out2_1 + 0.2500 * out2_2;
+                    out[badX0 + 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2500 * out1_2 + 0.2500 * out1_1 + 0.2500 * out2_1 + 0.2500 * out2_2;
-                        val = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2500 * out1_2 + 0.2500 * out1_1 + 0.2500 * out2_1 + 0.2500 * out2_2;
+                    val = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        for (int j = badX0 + 6; j < badX1 - 5; j++) {
-                            out[j] = val;
-                        }
+                    for (int j = badX0 + 6; j < badX1 - 5; j++) {
+                        out[j] = val;
+                    }
 
-                        val = 0.2500 * out1_2 + 0.2500 * out1_1 + 0.2503 * out2_1 + 0.2497 * out2_2;
-                        out[badX1 - 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2500 * out1_2 + 0.2500 * out1_1 + 0.2503 * out2_1 + 0.2497 * out2_2;
+                    out[badX1 - 5] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2497 * out1_2 + 0.2497 * out1_1 + 0.2544 * out2_1 + 0.2462 * out2_2;
-                        out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2497 * out1_2 + 0.2497 * out1_1 + 0.2544 * out2_1 + 0.2462 * out2_2;
+                    out[badX1 - 4] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2472 * out1_2 + 0.2472 * out1_1 + 0.2899 * out2_1 + 0.2158 * out2_2;
-                        out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2472 * out1_2 + 0.2472 * out1_1 + 0.2899 * out2_1 + 0.2158 * out2_2;
+                    out[badX1 - 3] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.2326 * out1_2 + 0.2326 * out1_1 + 0.4642 * out2_1 + 0.0705 * out2_2;
-                        out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.2326 * out1_2 + 0.2326 * out1_1 + 0.4642 * out2_1 + 0.0705 * out2_2;
+                    out[badX1 - 2] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.1835 * out1_2 + 0.1835 * out1_1 + 0.9098 * out2_1 - 0.2768 * out2_2;
-                        out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.1835 * out1_2 + 0.1835 * out1_1 + 0.9098 * out2_1 - 0.2768 * out2_2;
+                    out[badX1 - 1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        val = 0.0888 * out1_2 + 0.0888 * out1_1 + 1.3400 * out2_1 - 0.5177 * out2_2;
-                        out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
+                    val = 0.0888 * out1_2 + 0.0888 * out1_1 + 1.3400 * out2_1 - 0.5177 * out2_2;
+                    out[badX1] = (val < min) ? 0.5 * (out1_1 + out2_1) : val;
 
-                        break;
-                    default:
-                        // shFatal("Unsupported defect type: WIDE 0%o",defect[i].type);
-                        break; /* NOTREACHED */
-                }
-                break;
-        }
+                    break;
+                default:
+                    // shFatal("Unsupported defect type: WIDE 0%o",defect[i].type);
+                    break; /* NOTREACHED */
+            }
+            break;
     }
 }
 
-template <typename MaskT>
-static void do_defects(std::vector<Defect::Ptr> const &badList,  // list of bad things
-                       int const y,                              // Row that we should fix
-                       MaskT &mask,                              // mask to set
-                       typename MaskT::Pixel const interpBit,    // bit to set for bad pixels
-                       bool useFallbackValueAtEdge,              // use fallbackValue at edge of chip?
-                       int nUseInterp                            // no. of pixels to interpolate towards edge
+/*
+ * Interpolate over the defects in a given row of a MaskedImage, fixing the image and variance and
+ * setting interpBit in the mask.  All three planes are handled for each run before moving on to the
+ * next, so each run's pixels are only brought into cache once.
+ */
+template <typename MaskedImageT>
+static void do_defects(DefectRun const *const rowBegin,        // list of bad things in this row
+                       DefectRun const *const rowEnd,          //    (end)
+                       int const y,                            // Row that we should fix
+                       MaskedImageT &mimage,                   // data to fix
+                       typename MaskedImageT::Mask::Pixel const interpBit,  // bit to set for bad pixels
+                       double fallbackValue,         // Value to fallback to if all else fails
+                       bool useFallbackValueAtEdge,  // use fallbackValue at edge of chip?
+                       int nUseInterp                // no. of pixels to interpolate towards edge
 ) {
-    typename MaskT::x_iterator mask_row = mask.row_begin(y);  // pointer to this row of mask
-
-    for (DefectCIter ptr = badList.begin(), end = badList.end(); ptr != end; ++ptr) {
-        Defect::Ptr const defect = *ptr;
-
-        if (y < defect->getY0() || y > defect->getY1()) {
-            continue;
-        }
-
-        int const badX0 = defect->getX0();
-        int const badX1 = defect->getX1();
-
-        for (int c = badX0; c <= badX1; ++c) {
+    typedef typename MaskedImageT::Image ImageT;
+    typedef typename MaskedImageT::Variance VarianceT;
+    typename ImageT::Pixel const imageMin = -std::numeric_limits<typename ImageT::Pixel>::max();
+    typename VarianceT::Pixel const varianceMin = -std::numeric_limits<typename ImageT::Pixel>::max();
+    //
+    // Get pointers to this row of data
+    //
+    int const ncol = mimage.getWidth();
+    typename ImageT::x_iterator image_row = mimage.getImage()->row_begin(y);
+    typename MaskedImageT::Mask::x_iterator mask_row = mimage.getMask()->row_begin(y);
+    typename VarianceT::x_iterator variance_row = mimage.getVariance()->row_begin(y);
+
+    for (DefectRun const *ptr = rowBegin; ptr != rowEnd; ++ptr) {
+        do_defect<ImageT>(*ptr, image_row, ncol, imageMin, fallbackValue, useFallbackValueAtEdge,
+                          nUseInterp);
+        do_defect<VarianceT>(*ptr, variance_row, ncol, varianceMin, fallbackValue, useFallbackValueAtEdge,
+                             nUseInterp);
+        for (int c = ptr->getX0(); c <= ptr->getX1(); ++c) {
             mask_row[c] |= interpBit;
         }
     }
@@ -2032,36 +2239,61 @@ static void do_defects(std::vector<Defect::Ptr> const &badList,  // list of bad
 /************************************************************************************************************/
 
 namespace {
-template <typename T>
-struct Sort_ByX0 : public std::binary_function<std::shared_ptr<T> const, std::shared_ptr<T> const, bool> {
-    bool operator()(std::shared_ptr<T> const a, std::shared_ptr<T> const b) const {
-        return a->getX0() < b->getX0();
+// Minimum number of rows given to a thread; fewer aren't worth starting one for
+int const MIN_ROWS_PER_THREAD = 32;
+
+/*
+ * Call processRows(y0, y1) for consecutive blocks of rows covering [0, nrow), using up to nThreads
+ * threads (including the calling one).  Any exception is rethrown once all the threads have finished.
+ */
+template <typename ProcessRows>
+void forEachRowBlock(int const nrow, int const nThreads, ProcessRows const &processRows) {
+    int const nBlocks = std::max(1, std::min(nThreads, nrow / MIN_ROWS_PER_THREAD));
+    if (nBlocks == 1) {
+        processRows(0, nrow);
+        return;
     }
-};
+
+    std::vector<int> starts(nBlocks + 1);  // first row of each block
+    for (int k = 0; k <= nBlocks; ++k) {
+        starts[k] = static_cast<int>(static_cast<long>(nrow) * k / nBlocks);
+    }
+    std::vector<std::exception_ptr> errors(nBlocks);
+    auto work = [&](int k) {
+        try {
+            processRows(starts[k], starts[k + 1]);
+        } catch (...) {
+            errors[k] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(nBlocks - 1);
+    for (int k = 1; k < nBlocks; ++k) {
+        workers.emplace_back(work, k);
+    }
+    work(0);  // the calling thread processes the first block
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    for (auto const &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
 }  // namespace
 
-/*!
- * @brief Process a set of known bad pixels in an image
- */
-template <typename MaskedImageT>
-void interpolateOverDefects(MaskedImageT &mimage,                ///< Image to patch
-                            afw::detection::Psf const &,         ///< the Image's PSF
-                            std::vector<Defect::Ptr> &_badList,  ///< List of Defects to patch
-                            double fallbackValue,                ///< Value to fallback to if all else fails
-                            bool useFallbackValueAtEdge  ///< Use the fallback value at the image's edge?
-) {
-    /*
-     * Allow for image's origin
-     */
-    int const width = mimage.getWidth();
-    int const height = mimage.getHeight();
-
-    std::vector<Defect::Ptr> badList;
-    badList.reserve(_badList.size());
-    for (std::vector<Defect::Ptr>::iterator ptr = _badList.begin(), end = _badList.end(); ptr != end; ++ptr) {
-        geom::BoxI bbox = (*ptr)->getBBox();
-        bbox.shift(geom::ExtentI(-mimage.getX0(), -mimage.getY0()));  // allow for image's origin
-        geom::PointI min = bbox.getMin(), max = bbox.getMax();
+CompiledDefectMap::CompiledDefectMap(std::vector<Defect::Ptr> const &defects, geom::Box2I const &bbox)
+        : _bbox(bbox), _offsets(1, 0) {
+    int const width = bbox.getWidth();
+    int const height = bbox.getHeight();
+
+    std::vector<geom::BoxI> badList;  // defects, in the image's local coordinates
+    badList.reserve(defects.size());
+    for (auto ptr = defects.begin(), end = defects.end(); ptr != end; ++ptr) {
+        geom::BoxI defectBBox = (*ptr)->getBBox();
+        defectBBox.shift(geom::ExtentI(-bbox.getMinX(), -bbox.getMinY()));  // allow for image's origin
+        geom::PointI min = defectBBox.getMin(), max = defectBBox.getMax();
         if (min.getX() >= width) {
             continue;
         } else if (min.getX() < 0) {
@@ -2078,13 +2310,147 @@ void interpolateOverDefects(MaskedImageT &mimage,                ///< Image to p
             max.setX(width - 1);
         }
 
-        bbox = geom::BoxI(min, max);
-        Defect::Ptr ndefect(new Defect(bbox));
-        ndefect->classify((*ptr)->getPos(), (*ptr)->getType());
-        badList.push_back(ndefect);
+        badList.push_back(geom::BoxI(min, max));
     }
 
-    sort(badList.begin(), badList.end(), Sort_ByX0<Defect>());
+    std::stable_sort(badList.begin(), badList.end(), [](geom::BoxI const &a, geom::BoxI const &b) {
+        return a.getMinX() < b.getMinX();
+    });
+    RowDefectIndex const rowIndex(badList, height);
+
+    _offsets.reserve(height + 1);
+    std::vector<DefectRun> badList1D;  // reused for every row
+    for (int y = 0; y != height; y++) {
+        if (rowIndex.begin(y) != rowIndex.end(y)) {
+            classify_defects(rowIndex.begin(y), rowIndex.end(y), width, badList1D);
+            _runs.insert(_runs.end(), badList1D.begin(), badList1D.end());
+        }
+        _offsets.push_back(_runs.size());
+    }
+}
+
+CompiledDefectMap::CompiledDefectMap(geom::Box2I const &bbox, std::vector<std::size_t> const &offsets,
+                                     std::vector<Run> const &runs)
+        : _bbox(bbox), _offsets(offsets), _runs(runs) {
+    bool const ok = _offsets.size() == static_cast<std::size_t>(bbox.getHeight()) + 1 &&
+                    _offsets.front() == 0 && _offsets.back() == _runs.size() &&
+                    std::is_sorted(_offsets.begin(), _offsets.end());
+    if (!ok) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("%d offsets and %d runs are inconsistent with a bbox of height %d") %
+                           _offsets.size() % _runs.size() % bbox.getHeight())
+                                  .str());
+    }
+    for (auto const &run : _runs) {
+        if (run.getX0() < 0 || run.getX1() < run.getX0() || run.getX1() >= bbox.getWidth()) {
+            throw LSST_EXCEPT(pex::exceptions::LengthError,
+                              (boost::format("Run [%d, %d] doesn't fit in a bbox of width %d") % run.getX0() %
+                               run.getX1() % bbox.getWidth())
+                                      .str());
+        }
+    }
+}
+
+void maskBoxes(afw::image::Mask<afw::image::MaskPixel> &mask, std::vector<geom::Box2I> const &bboxes,
+               afw::image::MaskPixel const bitmask) {
+    geom::Box2I const maskBBox = mask.getBBox();
+    std::vector<geom::BoxI> localBoxes;  // boxes, clipped and in the mask's local coordinates
+    localBoxes.reserve(bboxes.size());
+    for (auto const &bbox : bboxes) {
+        geom::Box2I clipped(bbox);
+        clipped.clip(maskBBox);
+        if (!clipped.isEmpty()) {
+            clipped.shift(geom::ExtentI(-maskBBox.getMinX(), -maskBBox.getMinY()));
+            localBoxes.push_back(clipped);
+        }
+    }
+    std::stable_sort(localBoxes.begin(), localBoxes.end(), [](geom::BoxI const &a, geom::BoxI const &b) {
+        return a.getMinX() < b.getMinX();
+    });
+    RowDefectIndex const rowIndex(localBoxes, mask.getHeight());
+
+    for (int y = 0; y != mask.getHeight(); ++y) {
+        afw::image::Mask<afw::image::MaskPixel>::x_iterator row = mask.row_begin(y);
+        int done = -1;  // last column masked in this row; the ranges are sorted by their left edges
+        for (ColumnRange const *range = rowIndex.begin(y); range != rowIndex.end(y); ++range) {
+            for (int x = std::max(range->x0, done + 1); x <= range->x1; ++x) {
+                row[x] |= bitmask;
+            }
+            done = std::max(done, range->x1);
+        }
+    }
+}
+
+std::vector<geom::Box2I> boxesFromMask(afw::image::Mask<afw::image::MaskPixel> const &mask,
+                                       afw::image::MaskPixel const bitmask) {
+    // Runs of masked pixels in each row; grouped (eight-connected, as by FootprintSet) with a union-find
+    std::vector<afw::geom::Span> spans;
+    int const x0 = mask.getX0();
+    for (int y = 0; y != mask.getHeight(); ++y) {
+        afw::image::Mask<afw::image::MaskPixel>::x_iterator const row = mask.row_begin(y);
+        for (int x = 0; x != mask.getWidth();) {
+            if (!(row[x] & bitmask)) {
+                ++x;
+                continue;
+            }
+            int const start = x;
+            while (x != mask.getWidth() && (row[x] & bitmask)) {
+                ++x;
+            }
+            spans.push_back(afw::geom::Span(y + mask.getY0(), start + x0, x - 1 + x0));
+        }
+    }
+    SpanComponents const components(std::move(spans));
+
+    std::vector<geom::Box2I> result;
+    for (auto const &spanSet : components.makeSpanSets()) {
+        std::vector<geom::Box2I> const boxes =
+                afw::detection::footprintToBBoxList(afw::detection::Footprint(spanSet));
+        result.insert(result.end(), boxes.begin(), boxes.end());
+    }
+    return result;
+}
+
+/*!
+ * @brief Process a set of known bad pixels in an image
+ */
+template <typename MaskedImageT>
+void interpolateOverDefects(MaskedImageT &mimage,                ///< Image to patch
+                            afw::detection::Psf const &,         ///< the Image's PSF
+                            std::vector<Defect::Ptr> &_badList,  ///< List of Defects to patch
+                            double fallbackValue,                ///< Value to fallback to if all else fails
+                            bool useFallbackValueAtEdge,  ///< Use the fallback value at the image's edge?
+                            int nThreads                  ///< Maximum number of threads to use
+) {
+    interpolateOverDefects(mimage, CompiledDefectMap(_badList, mimage.getBBox()), fallbackValue,
+                           useFallbackValueAtEdge, nThreads);
+}
+
+/*!
+ * @brief Process a set of known bad pixels, compiled for the image's bbox, in an image
+ *
+ * Each row is interpolated independently of the others, so the rows may be shared among nThreads
+ * threads; the result doesn't depend on the number of threads.
+ */
+template <typename MaskedImageT>
+void interpolateOverDefects(MaskedImageT &mimage,                ///< Image to patch
+                            CompiledDefectMap const &defectMap,  ///< Defects to patch
+                            double fallbackValue,                ///< Value to fallback to if all else fails
+                            bool useFallbackValueAtEdge,  ///< Use the fallback value at the image's edge?
+                            int nThreads                  ///< Maximum number of threads to use
+) {
+    if (mimage.getBBox() != defectMap.getBBox()) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Image bbox %s doesn't match the defect map's %s") %
+                           mimage.getBBox() % defectMap.getBBox())
+                                  .str());
+    }
+    if (nThreads < 1) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("nThreads must be positive; got %d") % nThreads).str());
+    }
+    LSST_MEAS_ALGORITHMS_TIME("interpolateOverDefects");
+    LSST_MEAS_ALGORITHMS_COUNT("interpolateOverDefects.defectRuns", defectMap.getRuns().size());
     /*
      * Go through the frame looking at each pixel (except the edge ones which we ignore)
      */
@@ -2095,20 +2461,18 @@ void interpolateOverDefects(MaskedImageT &mimage,                ///< Image to p
     static_assert(nUseInterp < Defect::WIDE_DEFECT,
                   "make sure that we can handle these defects using"
                   "the full interpolation not edge code");
-
-    for (int y = 0; y != height; y++) {
-        std::vector<Defect::Ptr> badList1D = classify_defects(badList, y, width);
-
-        do_defects(badList1D, y, *mimage.getImage(),
-                   -std::numeric_limits<typename MaskedImageT::Image::Pixel>::max(), fallbackValue,
-                   useFallbackValueAtEdge, nUseInterp);
-
-        do_defects(badList1D, y, *mimage.getMask(), interpBit, useFallbackValueAtEdge, nUseInterp);
-
-        do_defects(badList1D, y, *mimage.getVariance(),
-                   -std::numeric_limits<typename MaskedImageT::Image::Pixel>::max(), fallbackValue,
-                   useFallbackValueAtEdge, nUseInterp);
-    }
+    /*
+     * A row only reads and writes its own pixels (and the shared, read-only, defectMap)
+     */
+    auto processRows = [&](int y0, int y1) {
+        for (int y = y0; y != y1; y++) {
+            if (defectMap.beginRow(y) != defectMap.endRow(y)) {
+                do_defects(defectMap.beginRow(y), defectMap.endRow(y), y, mimage, interpBit, fallbackValue,
+                           useFallbackValueAtEdge, nUseInterp);
+            }
+        }
+    };
+    forEachRowBlock(mimage.getHeight(), nThreads, processRows);
 }
 
 /*****************************************************************************/
@@ -2233,7 +2597,9 @@ typedef float ImagePixel;
 
 template void interpolateOverDefects(afw::image::MaskedImage<ImagePixel, afw::image::MaskPixel> &image,
                                      afw::detection::Psf const &, std::vector<Defect::Ptr> &badList, double,
-                                     bool);
+                                     bool, int);
+template void interpolateOverDefects(afw::image::MaskedImage<ImagePixel, afw::image::MaskPixel> &image,
+                                     CompiledDefectMap const &, double, bool, int);
 template std::pair<bool, ImagePixel> interp::singlePixel(
         int x, int y, afw::image::MaskedImage<ImagePixel, afw::image::MaskPixel> const &image,
         bool horizontal, double minval);
@@ -2243,7 +2609,9 @@ template std::pair<bool, ImagePixel> interp::singlePixel(
 #if 1
 template void interpolateOverDefects(afw::image::MaskedImage<double, afw::image::MaskPixel> &image,
                                      afw::detection::Psf const &, std::vector<Defect::Ptr> &badList, double,
-                                     bool);
+                                     bool, int);
+template void interpolateOverDefects(afw::image::MaskedImage<double, afw::image::MaskPixel> &image,
+                                     CompiledDefectMap const &, double, bool, int);
 
 template std::pair<bool, double> interp::singlePixel(
         int x, int y, afw::image::MaskedImage<double, afw::image::MaskPixel> const &image, bool horizontal,
@@ -1,5 +1,8 @@
 // -*- LSST-C++ -*-
 
+#include <map>
+#include <mutex>
+
 #include "lsst/geom/Box.h"
 #include "lsst/afw/table/io/Persistable.cc"
 #include "lsst/meas/algorithms/KernelPsf.h"
@@ -19,6 +22,14 @@ PersistableFacade<meas::algorithms::KernelPsf>::dynamicCast(std::shared_ptr<Pers
 namespace meas {
 namespace algorithms {
 
+// Shape and aperture fluxes of a spatially constant kernel image, filled in as they are requested.
+struct KernelPsf::MomentsCache {
+    std::mutex mutex;
+    bool hasShape = false;
+    afw::geom::ellipses::Quadrupole shape;
+    std::map<double, double> apertureFluxes;  // keyed on radius
+};
+
 PTR(afw::detection::Psf::Image)
 KernelPsf::doComputeKernelImage(geom::Point2D const& position, afw::image::Color const& color) const {
     PTR(Psf::Image) im = std::make_shared<Psf::Image>(_kernel->getDimensions());
@@ -65,6 +76,51 @@ KernelPsfPersistenceHelper::KernelPsfPersistenceHelper()
 
 bool KernelPsf::isPersistable() const noexcept { return _kernel->isPersistable(); }
 
+void KernelPsf::setCacheMoments(bool cacheMoments) {
+    if (!cacheMoments || _kernel->isSpatiallyVarying()) {
+        _momentsCache.reset();
+    } else if (!_momentsCache) {
+        _momentsCache = std::make_shared<MomentsCache>();
+    }
+}
+
+double KernelPsf::doComputeApertureFlux(double radius, geom::Point2D const& position,
+                                        afw::image::Color const& color) const {
+    if (!_momentsCache) {
+        return ImagePsf::doComputeApertureFlux(radius, position, color);
+    }
+    {
+        std::lock_guard<std::mutex> lock(_momentsCache->mutex);
+        auto iter = _momentsCache->apertureFluxes.find(radius);
+        if (iter != _momentsCache->apertureFluxes.end()) {
+            return iter->second;
+        }
+    }
+    // Measure without holding the lock; if another thread gets there first we'll get the same value.
+    double const flux = ImagePsf::doComputeApertureFlux(radius, position, color);
+    std::lock_guard<std::mutex> lock(_momentsCache->mutex);
+    _momentsCache->apertureFluxes.emplace(radius, flux);
+    return flux;
+}
+
+afw::geom::ellipses::Quadrupole KernelPsf::doComputeShape(geom::Point2D const& position,
+                                                          afw::image::Color const& color) const {
+    if (!_momentsCache) {
+        return ImagePsf::doComputeShape(position, color);
+    }
+    {
+        std::lock_guard<std::mutex> lock(_momentsCache->mutex);
+        if (_momentsCache->hasShape) {
+            return _momentsCache->shape;
+        }
+    }
+    afw::geom::ellipses::Quadrupole const shape = ImagePsf::doComputeShape(position, color);
+    std::lock_guard<std::mutex> lock(_momentsCache->mutex);
+    _momentsCache->shape = shape;
+    _momentsCache->hasShape = true;
+    return shape;
+}
+
 std::string KernelPsf::getPersistenceName() const { return "KernelPsf"; }
 
 std::string KernelPsf::getPythonModule() const { return "lsst.meas.algorithms"; }
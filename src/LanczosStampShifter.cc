@@ -0,0 +1,354 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "boost/format.hpp"
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/math/offsetImage.h"
+#include "lsst/meas/algorithms/LanczosStampShifter.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+namespace {
+
+// As afw::math::LanczosFunction1
+double lanczos(double x, int order) {
+    double const xArg1 = x * M_PI;
+    if (std::abs(xArg1) < 1.0e-5) {
+        return 1.0;
+    }
+    double const xArg2 = xArg1 / order;
+    return std::sin(xArg1) * std::sin(xArg2) / (xArg1 * xArg2);
+}
+
+// The shift along one axis
+struct Axis {
+    int ctr;                      // index of the tap centered on the output pixel
+    std::vector<double> weights;  // normalized weights of the taps
+    std::vector<double> squared;  // squares of weights, for shifting variances
+    int lo, hi;                   // output pixels [lo, hi] are convolved; the rest are copied
+};
+
+// Set up the shift by frac pixels of an axis of the given size, laid out as afw::math::offsetImage's
+// convolution with a normalized LanczosWarpingKernel: tap i multiplies input pixel (x + i - ctr).
+Axis makeAxis(double frac, int order, int size, int buffer) {
+    int const width = 2 * order;
+    double const dKer = -frac;
+    Axis axis;
+    // For negative kernel offsets offsetImage moves the kernel center right, to center the largest weights
+    axis.ctr = (dKer < 0) ? order : order - 1;
+    axis.weights.resize(width);
+    axis.squared.resize(width);
+    double sum = 0.0;
+    for (int i = 0; i < width; ++i) {
+        axis.weights[i] = lanczos(i - axis.ctr - dKer, order);
+        sum += axis.weights[i];
+    }
+    for (int i = 0; i < width; ++i) {
+        axis.weights[i] /= sum;
+        axis.squared[i] = axis.weights[i] * axis.weights[i];
+    }
+    // The kernel has to fit within the zero-padded input
+    axis.lo = std::max(0, axis.ctr - buffer);
+    axis.hi = std::min(size - 1, size + buffer - width + axis.ctr);
+    return axis;
+}
+
+struct Shift {
+    geom::Extent2I dOrig;  // integer part of the shift, applied to xy0
+    Axis x, y;
+    int width, height;
+    bool convolve;  // are any output pixels convolved?
+};
+
+Shift makeShift(int order, geom::Extent2I const& srcDims, geom::Extent2I const& destDims, float dx, float dy,
+                unsigned int buffer) {
+    if (srcDims != destDims) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Destination of size %dx%d doesn't match source of size %dx%d") %
+                           destDims.getX() % destDims.getY() % srcDims.getX() % srcDims.getY())
+                                  .str());
+    }
+    int const width = 2 * order;
+    if (width > srcDims.getX() + 2 * static_cast<int>(buffer) ||
+        width > srcDims.getY() + 2 * static_cast<int>(buffer)) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Image of size %dx%d is too small to offset using a lanczos%d kernel"
+                                         "(minimum %dx%d)") %
+                           (srcDims.getX() + 2 * buffer) % (srcDims.getY() + 2 * buffer) % order % width %
+                           width)
+                                  .str());
+    }
+    // Split the shift into integer and fractional parts as afw::math::offsetImage does
+    int dOrigX = 0, dOrigY = 0;
+    double fracX = dx, fracY = dy;
+    if (!(dx > -1 && dx < 1 && dy > -1 && dy < 1)) {
+        dOrigX = static_cast<int>(std::floor(dx + 0.5));
+        dOrigY = static_cast<int>(std::floor(dy + 0.5));
+        fracX = dx - dOrigX;
+        fracY = dy - dOrigY;
+    }
+    Shift shift;
+    shift.dOrig = geom::Extent2I(dOrigX, dOrigY);
+    shift.x = makeAxis(fracX, order, srcDims.getX(), buffer);
+    shift.y = makeAxis(fracY, order, srcDims.getY(), buffer);
+    shift.width = srcDims.getX();
+    shift.height = srcDims.getY();
+    shift.convolve = shift.x.lo <= shift.x.hi && shift.y.lo <= shift.y.hi;
+    return shift;
+}
+
+/*
+ * Convolve a plane with separable weights wx, wy, writing the output pixels in [x.lo, x.hi] x [y.lo, y.hi].
+ *
+ * All the input rows needed are convolved along x into a scratch buffer before any output is written, so
+ * in and out may be the same plane.  Input pixels beyond the plane are zero.
+ */
+template <typename InT, typename OutT>
+void convolvePlane(InT const* in, std::ptrdiff_t inStride, OutT* out, std::ptrdiff_t outStride,
+                   Shift const& shift, double const* wx, double const* wy) {
+    thread_local std::vector<double> scratch;
+    thread_local std::vector<double> sum;
+    Axis const& x = shift.x;
+    Axis const& y = shift.y;
+    int const nTap = x.weights.size();
+    int const nx = x.hi - x.lo + 1;
+    int const rowLo = std::max(0, y.lo - y.ctr);
+    int const rowHi = std::min(shift.height - 1, y.hi - y.ctr + nTap - 1);
+    scratch.assign(static_cast<std::size_t>(rowHi - rowLo + 1) * nx, 0.0);
+    sum.resize(nx);
+
+    for (int row = rowLo; row <= rowHi; ++row) {
+        InT const* inRow = in + row * inStride;
+        double* tmp = &scratch[static_cast<std::size_t>(row - rowLo) * nx] - x.lo;
+        for (int i = 0; i < nTap; ++i) {
+            int const offset = i - x.ctr;
+            int const begin = std::max(x.lo, -offset);
+            int const end = std::min(x.hi, shift.width - 1 - offset);
+            double const weight = wx[i];
+            for (int k = begin; k <= end; ++k) {
+                tmp[k] += weight * inRow[k + offset];
+            }
+        }
+    }
+    for (int iy = y.lo; iy <= y.hi; ++iy) {
+        std::fill(sum.begin(), sum.end(), 0.0);
+        for (int j = 0; j < nTap; ++j) {
+            int const row = iy + j - y.ctr;
+            if (row < rowLo || row > rowHi) {
+                continue;
+            }
+            double const* tmp = &scratch[static_cast<std::size_t>(row - rowLo) * nx];
+            double const weight = wy[j];
+            for (int k = 0; k < nx; ++k) {
+                sum[k] += weight * tmp[k];
+            }
+        }
+        OutT* outRow = out + iy * outStride + x.lo;
+        for (int k = 0; k < nx; ++k) {
+            outRow[k] = sum[k];
+        }
+    }
+}
+
+/*
+ * Set each output mask pixel in [x.lo, x.hi] x [y.lo, y.hi] to the OR of the input pixels under the
+ * non-zero weights, as afw::math::convolve does; in and out may be the same plane.
+ */
+void convolveMask(afw::image::MaskPixel const* in, std::ptrdiff_t inStride, afw::image::MaskPixel* out,
+                  std::ptrdiff_t outStride, Shift const& shift) {
+    thread_local std::vector<afw::image::MaskPixel> scratch;
+    thread_local std::vector<afw::image::MaskPixel> sum;
+    Axis const& x = shift.x;
+    Axis const& y = shift.y;
+    int const nTap = x.weights.size();
+    int const nx = x.hi - x.lo + 1;
+    int const rowLo = std::max(0, y.lo - y.ctr);
+    int const rowHi = std::min(shift.height - 1, y.hi - y.ctr + nTap - 1);
+    scratch.assign(static_cast<std::size_t>(rowHi - rowLo + 1) * nx, 0);
+    sum.resize(nx);
+
+    for (int row = rowLo; row <= rowHi; ++row) {
+        afw::image::MaskPixel const* inRow = in + row * inStride;
+        afw::image::MaskPixel* tmp = &scratch[static_cast<std::size_t>(row - rowLo) * nx] - x.lo;
+        for (int i = 0; i < nTap; ++i) {
+            if (x.weights[i] == 0.0) {
+                continue;
+            }
+            int const offset = i - x.ctr;
+            int const begin = std::max(x.lo, -offset);
+            int const end = std::min(x.hi, shift.width - 1 - offset);
+            for (int k = begin; k <= end; ++k) {
+                tmp[k] |= inRow[k + offset];
+            }
+        }
+    }
+    for (int iy = y.lo; iy <= y.hi; ++iy) {
+        std::fill(sum.begin(), sum.end(), 0);
+        for (int j = 0; j < nTap; ++j) {
+            int const row = iy + j - y.ctr;
+            if (y.weights[j] == 0.0 || row < rowLo || row > rowHi) {
+                continue;
+            }
+            afw::image::MaskPixel const* tmp = &scratch[static_cast<std::size_t>(row - rowLo) * nx];
+            for (int k = 0; k < nx; ++k) {
+                sum[k] |= tmp[k];
+            }
+        }
+        std::copy(sum.begin(), sum.end(), out + iy * outStride + x.lo);
+    }
+}
+
+// Call func(x, y) for each output pixel that isn't convolved
+template <typename Func>
+void forEachEdgePixel(Shift const& shift, Func func) {
+    for (int iy = 0; iy < shift.height; ++iy) {
+        bool const rowIsEdge = !shift.convolve || iy < shift.y.lo || iy > shift.y.hi;
+        for (int ix = 0; ix < shift.width; ++ix) {
+            if (!rowIsEdge && ix == shift.x.lo) {
+                ix = shift.x.hi;
+                continue;
+            }
+            func(ix, iy);
+        }
+    }
+}
+
+}  // namespace
+
+LanczosStampShifter::LanczosStampShifter(int order) : _order(order) {
+    if (order < 1) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Lanczos order must be positive; got %d") % order).str());
+    }
+}
+
+std::shared_ptr<LanczosStampShifter const> LanczosStampShifter::fromAlgorithm(
+        std::string const& algorithmName) {
+    std::string const prefix = "lanczos";
+    if (algorithmName.size() <= prefix.size() || algorithmName.compare(0, prefix.size(), prefix) != 0) {
+        return nullptr;
+    }
+    std::string const digits = algorithmName.substr(prefix.size());
+    if (digits.find_first_not_of("0123456789") != std::string::npos) {
+        return nullptr;
+    }
+    int const order = std::stoi(digits);
+    if (order < 1) {
+        return nullptr;
+    }
+    return std::make_shared<LanczosStampShifter const>(order);
+}
+
+template <typename PixelT>
+void LanczosStampShifter::shift(afw::image::Image<PixelT> const& src, float dx, float dy,
+                                afw::image::Image<PixelT>& dest, unsigned int buffer) const {
+    Shift const shift = makeShift(_order, src.getDimensions(), dest.getDimensions(), dx, dy, buffer);
+    geom::Point2I const xy0 = src.getXY0();
+    auto const in = src.getArray();
+    auto const out = dest.getArray();
+    if (shift.convolve) {
+        convolvePlane(in.getData(), in.template getStride<0>(), out.getData(), out.template getStride<0>(),
+                      shift, shift.x.weights.data(), shift.y.weights.data());
+    }
+    if (&dest != &src) {
+        forEachEdgePixel(shift, [&in, &out](int x, int y) { out[y][x] = in[y][x]; });
+    }
+    dest.setXY0(xy0 + shift.dOrig);
+}
+
+template <typename PixelT>
+void LanczosStampShifter::shift(afw::image::MaskedImage<PixelT> const& src, float dx, float dy,
+                                afw::image::MaskedImage<PixelT>& dest, unsigned int buffer) const {
+    Shift const shift = makeShift(_order, src.getDimensions(), dest.getDimensions(), dx, dy, buffer);
+    geom::Point2I const xy0 = src.getXY0();
+    auto const inImage = src.getImage()->getArray();
+    auto const inMask = src.getMask()->getArray();
+    auto const inVariance = src.getVariance()->getArray();
+    auto const outImage = dest.getImage()->getArray();
+    auto const outMask = dest.getMask()->getArray();
+    auto const outVariance = dest.getVariance()->getArray();
+    if (shift.convolve) {
+        convolvePlane(inImage.getData(), inImage.template getStride<0>(), outImage.getData(),
+                      outImage.template getStride<0>(), shift, shift.x.weights.data(),
+                      shift.y.weights.data());
+        convolveMask(inMask.getData(), inMask.template getStride<0>(), outMask.getData(),
+                     outMask.template getStride<0>(), shift);
+        convolvePlane(inVariance.getData(), inVariance.template getStride<0>(), outVariance.getData(),
+                      outVariance.template getStride<0>(), shift, shift.x.squared.data(),
+                      shift.y.squared.data());
+    }
+    afw::image::MaskPixel const edge = afw::image::Mask<afw::image::MaskPixel>::getPlaneBitMask("EDGE");
+    forEachEdgePixel(shift, [&](int x, int y) {
+        outImage[y][x] = inImage[y][x];
+        outMask[y][x] = inMask[y][x] | edge;
+        outVariance[y][x] = inVariance[y][x];
+    });
+    dest.setXY0(xy0 + shift.dOrig);
+}
+
+template <typename ImageT>
+std::shared_ptr<ImageT> LanczosStampShifter::shift(ImageT const& src, float dx, float dy,
+                                                   unsigned int buffer) const {
+    auto dest = std::make_shared<ImageT>(src.getDimensions());
+    shift(src, dx, dy, *dest, buffer);
+    return dest;
+}
+
+template <typename ImageT>
+std::shared_ptr<ImageT> offsetStamp(ImageT const& image, float dx, float dy, std::string const& algorithmName,
+                                    unsigned int buffer) {
+    auto const shifter = LanczosStampShifter::fromAlgorithm(algorithmName);
+    if (!shifter) {
+        return afw::math::offsetImage(image, dx, dy, algorithmName, buffer);
+    }
+    return shifter->shift(image, dx, dy, buffer);
+}
+
+//
+// Explicit instantiations
+//
+#define INSTANTIATE_IMAGE(IMAGE)                                                                          \
+    template std::shared_ptr<IMAGE> LanczosStampShifter::shift(IMAGE const&, float, float, unsigned int) \
+            const;                                                                                        \
+    template std::shared_ptr<IMAGE> offsetStamp(IMAGE const&, float, float, std::string const&, unsigned int);
+
+#define INSTANTIATE(PIXEL)                                                                                 \
+    template void LanczosStampShifter::shift(afw::image::Image<PIXEL> const&, float, float,                \
+                                             afw::image::Image<PIXEL>&, unsigned int) const;               \
+    template void LanczosStampShifter::shift(afw::image::MaskedImage<PIXEL> const&, float, float,          \
+                                             afw::image::MaskedImage<PIXEL>&, unsigned int) const;         \
+    INSTANTIATE_IMAGE(afw::image::Image<PIXEL>)                                                            \
+    INSTANTIATE_IMAGE(afw::image::MaskedImage<PIXEL>)
+
+INSTANTIATE(float)
+INSTANTIATE(double)
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
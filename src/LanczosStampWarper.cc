@@ -0,0 +1,178 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include <cmath>
+
+#include "boost/format.hpp"
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/algorithms/LanczosStampWarper.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+namespace {
+
+int const MAX_ORDER = 5;
+
+double lanczos(double x, int order) {
+    if (std::abs(x) >= order) {
+        return 0.0;
+    }
+    double const xArg1 = x * M_PI;
+    if (std::abs(xArg1) < 1.0e-5) {
+        return 1.0;
+    }
+    double const xArg2 = xArg1 / order;
+    return std::sin(xArg1) * std::sin(xArg2) / (xArg1 * xArg2);
+}
+
+}  // namespace
+
+LanczosStampWarper::LanczosStampWarper(int order, int tableSize) : _order(order), _tableSize(tableSize) {
+    if (order < 1 || order > MAX_ORDER) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Lanczos order must be between 1 and %d; got %d") % MAX_ORDER %
+                           order)
+                                  .str());
+    }
+    if (tableSize < 1) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("tableSize must be positive; got %d") % tableSize).str());
+    }
+    // Tap k of the kernel is centered on pixel (index + k - (order - 1)), as for
+    // afw::math::LanczosWarpingKernel, whose center is at order - 1.
+    int const width = 2 * order;
+    _table.resize(static_cast<std::size_t>(tableSize + 1) * width);
+    for (int i = 0; i <= tableSize; ++i) {
+        double const frac = static_cast<double>(i) / tableSize;
+        double* weights = &_table[static_cast<std::size_t>(i) * width];
+        double sum = 0.0;
+        for (int k = 0; k < width; ++k) {
+            weights[k] = lanczos(k - (order - 1) - frac, order);
+            sum += weights[k];
+        }
+        for (int k = 0; k < width; ++k) {
+            weights[k] /= sum;
+        }
+    }
+}
+
+std::shared_ptr<LanczosStampWarper const> LanczosStampWarper::fromWarpingControl(
+        afw::math::WarpingControl const& control) {
+    auto kernel =
+            std::dynamic_pointer_cast<afw::math::LanczosWarpingKernel const>(control.getWarpingKernel());
+    if (!kernel) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          "LanczosStampWarper requires a Lanczos warping kernel");
+    }
+    int const tableSize = control.getCacheSize() > 0 ? control.getCacheSize() : 10000;
+    return std::make_shared<LanczosStampWarper const>(kernel->getOrder(), tableSize);
+}
+
+double LanczosStampWarper::warp(Image const& src, geom::AffineTransform const& srcToDest, Image& dest) const {
+    geom::AffineTransform const destToSrc = srcToDest.inverted();
+    switch (_order) {
+        case 1:
+            return _warp<1>(src, destToSrc, dest);
+        case 2:
+            return _warp<2>(src, destToSrc, dest);
+        case 3:
+            return _warp<3>(src, destToSrc, dest);
+        case 4:
+            return _warp<4>(src, destToSrc, dest);
+        default:
+            return _warp<5>(src, destToSrc, dest);
+    }
+}
+
+template <int N>
+double LanczosStampWarper::_warp(Image const& src, geom::AffineTransform const& destToSrc,
+                                 Image& dest) const {
+    int const width = 2 * N;
+    int const srcWidth = src.getWidth();
+    int const srcHeight = src.getHeight();
+    auto const srcArray = src.getArray();
+    Image::Pixel const* srcData = srcArray.getData();
+    std::ptrdiff_t const srcStride = srcArray.getStride<0>();
+
+    // Source pixel index (relative to src's xy0) as an affine function of destination parent position.
+    auto const& matrix = destToSrc.getLinear().getMatrix();
+    geom::Extent2D const step(matrix(0, 0), matrix(1, 0));  // change in source index per destination column
+
+    double sum = 0.0;
+    double rowValues[width];
+    for (int y = 0; y < dest.getHeight(); ++y) {
+        geom::Point2D srcPos = destToSrc(geom::Point2D(dest.getX0(), dest.getY0() + y)) -
+                               geom::Extent2D(src.getX0(), src.getY0());
+        Image::x_iterator destIter = dest.row_begin(y);
+        for (int x = 0; x < dest.getWidth(); ++x, ++destIter, srcPos += step) {
+            double const ixFloor = std::floor(srcPos.getX());
+            double const iyFloor = std::floor(srcPos.getY());
+            int const x0 = static_cast<int>(ixFloor) - (N - 1);
+            int const y0 = static_cast<int>(iyFloor) - (N - 1);
+            if (x0 >= srcWidth || y0 >= srcHeight || x0 + width <= 0 || y0 + width <= 0) {
+                *destIter = 0.0;
+                continue;
+            }
+            double const* wx = _getWeights(srcPos.getX() - ixFloor);
+            double const* wy = _getWeights(srcPos.getY() - iyFloor);
+            double value = 0.0;
+            if (x0 >= 0 && y0 >= 0 && x0 + width <= srcWidth && y0 + width <= srcHeight) {
+                // Interior: fixed trip counts, so these loops are fully unrolled and vectorized.
+                Image::Pixel const* row = srcData + y0 * srcStride + x0;
+                for (int j = 0; j < width; ++j, row += srcStride) {
+                    double rowValue = 0.0;
+                    for (int i = 0; i < width; ++i) {
+                        rowValue += wx[i] * row[i];
+                    }
+                    rowValues[j] = rowValue;
+                }
+                for (int j = 0; j < width; ++j) {
+                    value += wy[j] * rowValues[j];
+                }
+            } else {
+                // Edge: clip the kernel footprint to the source image (i.e. zero padding).
+                int const i0 = std::max(0, -x0);
+                int const i1 = std::min(width, srcWidth - x0);
+                int const j0 = std::max(0, -y0);
+                int const j1 = std::min(width, srcHeight - y0);
+                for (int j = j0; j < j1; ++j) {
+                    Image::Pixel const* row = srcData + (y0 + j) * srcStride + x0;
+                    double rowValue = 0.0;
+                    for (int i = i0; i < i1; ++i) {
+                        rowValue += wx[i] * row[i];
+                    }
+                    value += wy[j] * rowValue;
+                }
+            }
+            *destIter = value;
+            sum += value;
+        }
+    }
+    return sum;
+}
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
@@ -29,8 +29,10 @@
  *
  * @ingroup algorithms
  */
+#include <algorithm>
 #include <cmath>
 #include <memory>
+#include <vector>
 
 #include "lsst/base.h"
 #include "lsst/pex/exceptions.h"
@@ -55,11 +57,110 @@ PersistableFacade<meas::algorithms::PcaPsf>::dynamicCast(std::shared_ptr<Persist
 namespace meas {
 namespace algorithms {
 
-PcaPsf::PcaPsf(PTR(afw::math::LinearCombinationKernel) kernel, geom::Point2D const& averagePosition)
-        : KernelPsf(kernel, averagePosition) {
+namespace {
+
+// Maximum number of positions realized by one matrix product in doComputeKernelImages; bounds the
+// size of the temporary (pixels x positions) result.
+std::size_t const MAX_BATCH_SIZE = 256;
+
+// Copy a flattened kernel realization into a new image with the given bbox, normalizing it to unit
+// sum as Kernel::computeImage(..., doNormalize=true) does.
+template <typename VectorT>
+PTR(afw::detection::Psf::Image) makeNormalizedImage(VectorT const& pixels, geom::Box2I const& bbox) {
+    Eigen::VectorXd const realization = pixels.template cast<double>();
+    double const sum = realization.sum();
+    if (sum == 0.0) {
+        throw LSST_EXCEPT(pex::exceptions::OverflowError, "Cannot normalize; kernel sum is 0");
+    }
+    auto image = std::make_shared<afw::detection::Psf::Image>(bbox);
+    Eigen::Map<Eigen::VectorXd>(image->getArray().getData(), realization.size()) = realization / sum;
+    return image;
+}
+
+}  // namespace
+
+PcaPsf::PcaPsf(PTR(afw::math::LinearCombinationKernel) kernel, geom::Point2D const& averagePosition,
+               bool singlePrecision)
+        : KernelPsf(kernel, averagePosition), _singlePrecision(singlePrecision) {
     if (!kernel) {
         throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "PcaPsf kernel must not be null");
     }
+    _init();
+}
+
+void PcaPsf::_init() {
+    auto kernel = getKernel();
+    afw::math::KernelList const& kernelList = kernel->getKernelList();
+    int const width = kernel->getWidth();
+    int const height = kernel->getHeight();
+
+    auto basis = std::make_shared<Eigen::MatrixXd>(width * height, kernelList.size());
+    afw::image::Image<double> basisImage(kernel->getDimensions());
+    for (std::size_t i = 0; i < kernelList.size(); ++i) {
+        // The LinearCombinationKernel sums unnormalized basis images, and so do we.
+        kernelList[i]->computeImage(basisImage, false);
+        auto const& array = basisImage.getArray();
+        for (int y = 0; y < height; ++y) {
+            std::copy(array[y].begin(), array[y].end(), &(*basis)(y * width, i));
+        }
+    }
+    _basis = basis;
+    if (_singlePrecision) {
+        _basisF = std::make_shared<Eigen::MatrixXf const>(basis->cast<float>());
+    }
+    if (kernel->isSpatiallyVarying()) {
+        _spatialFunctions = std::make_shared<std::vector<afw::math::Kernel::SpatialFunctionPtr> const>(
+                kernel->getSpatialFunctionList());
+    }
+}
+
+void PcaPsf::_computeCoefficients(geom::Point2D const& position,
+                                  Eigen::Ref<Eigen::VectorXd> coefficients) const {
+    if (_spatialFunctions) {
+        for (std::size_t i = 0; i < _spatialFunctions->size(); ++i) {
+            coefficients[i] = (*(*_spatialFunctions)[i])(position.getX(), position.getY());
+        }
+    } else {
+        std::vector<double> const params = getKernel()->getKernelParameters();
+        std::copy(params.begin(), params.end(), coefficients.data());
+    }
+}
+
+PTR(afw::detection::Psf::Image)
+PcaPsf::doComputeKernelImage(geom::Point2D const& position, afw::image::Color const& color) const {
+    Eigen::VectorXd coefficients(_basis->cols());
+    _computeCoefficients(position, coefficients);
+    geom::Box2I const bbox = getKernel()->getBBox();
+    if (_singlePrecision) {
+        return makeNormalizedImage(Eigen::VectorXf((*_basisF) * coefficients.cast<float>()), bbox);
+    }
+    return makeNormalizedImage(Eigen::VectorXd((*_basis) * coefficients), bbox);
+}
+
+std::vector<PTR(afw::detection::Psf::Image)> PcaPsf::doComputeKernelImages(
+        std::vector<geom::Point2D> const& positions, afw::image::Color const& color) const {
+    std::vector<PTR(Image)> images;
+    images.reserve(positions.size());
+    geom::Box2I const bbox = getKernel()->getBBox();
+    for (std::size_t start = 0; start < positions.size(); start += MAX_BATCH_SIZE) {
+        std::size_t const n = std::min(MAX_BATCH_SIZE, positions.size() - start);
+        Eigen::MatrixXd coefficients(_basis->cols(), n);
+        for (std::size_t i = 0; i < n; ++i) {
+            _computeCoefficients(positions[start + i], coefficients.col(i));
+        }
+        if (_singlePrecision) {
+            Eigen::MatrixXf const realizations = (*_basisF) * coefficients.cast<float>();
+            for (std::size_t i = 0; i < n; ++i) {
+                images.push_back(makeNormalizedImage(realizations.col(i), bbox));
+            }
+        } else {
+            Eigen::MatrixXd const realizations = (*_basis) * coefficients;
+            for (std::size_t i = 0; i < n; ++i) {
+                images.push_back(makeNormalizedImage(realizations.col(i), bbox));
+            }
+        }
+    }
+    return images;
 }
 
 PTR(afw::math::LinearCombinationKernel const) PcaPsf::getKernel() const {
@@ -71,7 +172,7 @@ PTR(afw::detection::Psf) PcaPsf::clone() const { return std::make_shared<PcaPsf>
 PTR(afw::detection::Psf) PcaPsf::resized(int width, int height) const {
     PTR(afw::math::LinearCombinationKernel)
     kern = std::static_pointer_cast<afw::math::LinearCombinationKernel>(getKernel()->resized(width, height));
-    return std::make_shared<PcaPsf>(kern, this->getAveragePosition());
+    return std::make_shared<PcaPsf>(kern, this->getAveragePosition(), _singlePrecision);
 }
 
 namespace {
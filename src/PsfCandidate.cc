@@ -29,11 +29,18 @@
  *
  * @ingroup algorithms
  */
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
 #include "lsst/afw/detection/Footprint.h"
 #include "lsst/geom.h"
 #include "lsst/afw/image/ImageAlgorithm.h"
 #include "lsst/afw/image/Image.h"
 #include "lsst/afw/math/offsetImage.h"
+#include "lsst/meas/algorithms/LanczosStampShifter.h"
 #include "lsst/meas/algorithms/PsfCandidate.h"
 
 namespace lsst {
@@ -55,6 +62,10 @@ bool PsfCandidate<PixelT>::_doMaskBlends = true;
 
 /************************************************************************************************************/
 namespace {
+// Serialises copying candidates' pixels out of their (shared) parent exposure, as the candidates of a
+// SpatialCellSet may be visited by several threads at once.
+std::mutex parentExposureMutex;
+
 template <typename T>  // functor used by makeImageFromMask to return inputMask
 struct noop : public afw::image::pixelOp1<T> {
     T operator()(T x) const { return x; }
@@ -101,50 +112,118 @@ std::shared_ptr<afw::image::Image<LhsT>> makeImageFromMask(
 
 /// Return square of the distance between a point and a peak
 double distanceSquared(double x, double y, afw::detection::PeakRecord const& peak) {
-    return std::pow(peak.getIx() - x, 2) + std::pow(peak.getIy() - y, 2);
+    double const dx = peak.getIx() - x;
+    double const dy = peak.getIy() - y;
+    return dx * dx + dy * dy;
 }
 
-/// Functor to mask pixels in a blended candidate
+/// Squared distances from each pixel of a box to the nearest of a set of points, in row-major order
 ///
-/// We mask pixels in the footprint that are closest to a peak other than the central one.
-/// For these pixels, we activate the "turnOn" bit mask and deactivate the "turnOff" bit mask.
-template <typename MaskT>
-class BlendedFunctor {
-public:
-    BlendedFunctor(afw::detection::PeakRecord const& central,  ///< Central peak
-                   afw::detection::PeakCatalog const& peaks,   ///< Other peaks
-                   afw::image::MaskPixel turnOff,              ///< Bit mask to deactivate
-                   afw::image::MaskPixel turnOn                ///< Bit mask to activate
-                   )
-            : _central(central), _peaks(peaks), _turnOff(~turnOff), _turnOn(turnOn) {}
-
-    /// Functor operation to mask pixels closest to a peak other than the central one.
-    void operator()(geom::Point2I const& point, MaskT& val) {
-        int x = point.getX();
-        int y = point.getY();
-        double const central = distanceSquared(x, y, _central);
-        for (afw::detection::PeakCatalog::const_iterator iter = _peaks.begin(), end = _peaks.end();
-             iter != end; ++iter) {
-            double const dist2 = distanceSquared(x, y, *iter);
-            if (dist2 < central) {
-                val &= _turnOff;
-                val |= _turnOn;
+/// This is the two-pass lower-envelope distance transform of Felzenszwalb & Huttenlocher: we first find
+/// the nearest point along each column that contains any, then the lower envelope of the parabolas
+/// centered on those columns along each row.  Points may lie outside the box; the cost is
+/// O((width + number of columns with points) * height + number of points) rather than
+/// O(width * height * number of points).  Pixels are infinitely far from an empty set of points.
+std::vector<std::int64_t> computeDistanceSquared(geom::Box2I const& box,
+                                                 std::vector<geom::Point2I> const& points) {
+    std::int64_t const infinity = std::numeric_limits<std::int64_t>::max();
+    int const width = box.getWidth(), height = box.getHeight();
+    std::vector<std::int64_t> result(static_cast<std::size_t>(width) * height, infinity);
+    if (points.empty() || box.isEmpty()) {
+        return result;
+    }
+
+    // Pass 1: squared distance to the nearest point in each column that has one
+    std::vector<geom::Point2I> sorted(points);
+    std::sort(sorted.begin(), sorted.end(), [](geom::Point2I const& a, geom::Point2I const& b) {
+        return a.getX() < b.getX() || (a.getX() == b.getX() && a.getY() < b.getY());
+    });
+    std::vector<int> columns;          // x of columns with points, ascending
+    std::vector<std::int64_t> column;  // column-major squared distances along each of columns
+    for (auto begin = sorted.begin(); begin != sorted.end();) {
+        auto end = begin;
+        while (end != sorted.end() && end->getX() == begin->getX()) {
+            ++end;
+        }
+        columns.push_back(begin->getX());
+        auto nearest = begin;
+        for (int y = box.getMinY(); y <= box.getMaxY(); ++y) {
+            auto closer = [y](geom::Point2I const& a, geom::Point2I const& b) {
+                return std::abs(a.getY() - y) <= std::abs(b.getY() - y);
+            };
+            while (nearest + 1 != end && closer(*(nearest + 1), *nearest)) {
+                ++nearest;
             }
+            std::int64_t const dy = nearest->getY() - y;
+            column.push_back(dy * dy);
         }
+        begin = end;
     }
 
-private:
-    afw::detection::PeakRecord const& _central;
-    afw::detection::PeakCatalog const& _peaks;
-    afw::image::MaskPixel const _turnOff;
-    afw::image::MaskPixel const _turnOn;
-};
+    // Pass 2: lower envelope of the parabolas (x - columns[k])^2 + f[k] along each row
+    int const nColumn = columns.size();
+    std::vector<std::int64_t> f(nColumn);
+    std::vector<int> vertex(nColumn);     // indices into columns of the parabolas in the envelope
+    std::vector<double> bound(nColumn + 1);  // the envelope is given by parabola k in [bound[k], bound[k+1]]
+    for (int iy = 0; iy < height; ++iy) {
+        for (int k = 0; k < nColumn; ++k) {
+            f[k] = column[static_cast<std::size_t>(k) * height + iy];
+        }
+        auto intersect = [&columns, &f](int q, int p) {
+            double const cq = columns[q], cp = columns[p];
+            return ((f[q] + cq * cq) - (f[p] + cp * cp)) / (2.0 * (cq - cp));
+        };
+        int k = 0;
+        vertex[0] = 0;
+        bound[0] = -std::numeric_limits<double>::infinity();
+        bound[1] = std::numeric_limits<double>::infinity();
+        for (int q = 1; q < nColumn; ++q) {
+            double s = intersect(q, vertex[k]);
+            while (s <= bound[k]) {
+                --k;
+                s = intersect(q, vertex[k]);
+            }
+            ++k;
+            vertex[k] = q;
+            bound[k] = s;
+            bound[k + 1] = std::numeric_limits<double>::infinity();
+        }
+        std::int64_t* row = &result[static_cast<std::size_t>(iy) * width];
+        k = 0;
+        for (int ix = 0; ix < width; ++ix) {
+            int const x = box.getMinX() + ix;
+            while (bound[k + 1] < x) {
+                ++k;
+            }
+            std::int64_t const dx = x - columns[vertex[k]];
+            row[ix] = dx * dx + f[vertex[k]];
+        }
+    }
+    return result;
+}
+
+/// Return a deep copy of image, in a stamp from arena if it has room for one
+template <typename PixelT>
+PTR(afw::image::MaskedImage<PixelT>)
+copyToStamp(afw::image::MaskedImage<PixelT> const& image, PsfStampArena<PixelT>* arena) {
+    PTR(afw::image::MaskedImage<PixelT>) stamp;
+    if (arena) {
+        stamp = arena->allocate(image.getDimensions());
+    }
+    if (!stamp) {
+        return std::make_shared<afw::image::MaskedImage<PixelT>>(image, true);
+    }
+    stamp->assign(image);
+    stamp->setXY0(image.getXY0());
+    return stamp;
+}
 
 }  // anonymous namespace
 
 /// Extract an image of the candidate.
 ///
 /// The MaskedImage is a deep copy of a sub-image of the original image.  No offsets are applied.
+/// If a stamp arena has been set the copy is made into one of its stamps, when it has room.
 ///
 /// In the mask, the INTRP bit is set and DETECTED unset for any pixels that are not considered part of the
 /// actual candidate.  You should consider that, for the output mask:
@@ -174,8 +253,9 @@ PsfCandidate<PixelT>::extractImage(unsigned int width,  // Width of image
 
     PTR(MaskedImageT) image;
     try {
+        std::lock_guard<std::mutex> lock(parentExposureMutex);
         MaskedImageT mimg = _parentExposure->getMaskedImage();
-        image.reset(new MaskedImageT(mimg, bbox, afw::image::LOCAL, true));  // a deep copy
+        image = copyToStamp(MaskedImageT(mimg, bbox, afw::image::LOCAL, false), _arena.get());  // a deep copy
     } catch (pex::exceptions::LengthError& e) {
         LSST_EXCEPT_ADD(e, "Extracting image of PSF candidate");
         throw e;
@@ -206,17 +286,33 @@ PsfCandidate<PixelT>::extractImage(unsigned int width,  // Width of image
             }
             assert(central);  // We must have found something
 
-            PeakCatalog others(peaks.getTable());
+            std::vector<geom::Point2I> others;
             others.reserve(peaks.size() - 1);
             for (PeakCatalog::const_iterator iter = peaks.begin(), end = peaks.end(); iter != end; ++iter) {
                 PTR(afw::detection::PeakRecord) ptr(iter);
                 if (central != ptr) {
-                    others.push_back(ptr);
+                    others.push_back(ptr->getI());
                 }
             }
 
-            BlendedFunctor<typename MaskedImageT::Mask::Pixel> functor(*central, others, detected, intrp);
-            foot->getSpans()->clippedTo(image->getBBox())->applyFunctor(functor, *image->getMask());
+            // Mask pixels that are closer to some other peak than to the central one
+            auto spans = foot->getSpans()->clippedTo(image->getBBox());
+            geom::Box2I const box = spans->getBBox();
+            std::vector<std::int64_t> const nearest = computeDistanceSquared(box, others);
+            auto mask = image->getMask()->getArray();
+            int const x0 = image->getX0(), y0 = image->getY0();
+            std::int64_t const cx = central->getIx(), cy = central->getIy();
+            for (auto const& span : *spans) {
+                int const y = span.getY();
+                std::int64_t const* dist2 =
+                        &nearest[static_cast<std::size_t>(y - box.getMinY()) * box.getWidth()];
+                for (int x = span.getMinX(); x <= span.getMaxX(); ++x) {
+                    if (dist2[x - box.getMinX()] < (x - cx) * (x - cx) + (y - cy) * (y - cy)) {
+                        auto& val = mask[y - y0][x - x0];
+                        val = (val & ~detected) | intrp;
+                    }
+                }
+            }
         }
     }
 
@@ -236,16 +332,33 @@ PsfCandidate<PixelT>::extractImage(unsigned int width,  // Width of image
         //
         // Go through Footprints looking for ones that don't contain cen
         //
+        std::vector<geom::Point2I> bad;  // pixels of the Footprints that don't contain cen
         for (FootprintList::const_iterator fiter = feet->begin(); fiter != feet->end(); ++fiter) {
             PTR(afw::detection::Footprint) foot = *fiter;
             if (foot->contains(cen)) {
                 continue;
             }
+            for (auto const& span : *foot->getSpans()) {
+                for (int x = span.getMinX(); x <= span.getMaxX(); ++x) {
+                    bad.emplace_back(x, span.getY());
+                }
+            }
+        }
 
-            // Dilate and clip to the image bounding box, incase the span grows outside the image
-            auto bigSpan = foot->getSpans()->dilated(ngrow)->clippedTo(image->getBBox());
-            bigSpan->clearMask(*image->getMask(), detected);
-            bigSpan->setMask(*image->getMask(), intrp);
+        // Dilate them all at once (with a circular stencil, as SpanSet::dilated) using the distances of
+        // the image's pixels from them; this also clips the grown Footprints to the image.
+        if (!bad.empty()) {
+            std::vector<std::int64_t> const dist2 = computeDistanceSquared(image->getBBox(), bad);
+            auto mask = image->getMask()->getArray();
+            for (int y = 0; y < image->getHeight(); ++y) {
+                std::int64_t const* rowDist2 = &dist2[static_cast<std::size_t>(y) * image->getWidth()];
+                for (int x = 0; x < image->getWidth(); ++x) {
+                    if (rowDist2[x] <= ngrow * ngrow) {
+                        auto& val = mask[y][x];
+                        val = (val & ~detected) | intrp;
+                    }
+                }
+            }
         }
     }
 
@@ -327,6 +440,7 @@ bool PsfCandidate<PixelT>::getMaskBlends() {
 /**
  * @brief Return an offset version of the image of the source.
  * The returned image has been offset to put the centre of the object in the centre of a pixel.
+ * It is cached, and only recomputed if the candidate's size, the algorithm or the buffer changes.
  *
  */
 template <typename PixelT>
@@ -336,8 +450,9 @@ PsfCandidate<PixelT>::getOffsetImage(std::string const algorithm,  // Warping al
                                      ) const {
     unsigned int const width = getWidth() == 0 ? _defaultWidth : getWidth();
     unsigned int const height = getHeight() == 0 ? _defaultWidth : getHeight();
-    if (_offsetImage && static_cast<unsigned int>(_offsetImage->getWidth()) == width + 2 * buffer &&
-        static_cast<unsigned int>(_offsetImage->getHeight()) == height + 2 * buffer) {
+    if (_offsetImage && static_cast<unsigned int>(_offsetImage->getWidth()) == width &&
+        static_cast<unsigned int>(_offsetImage->getHeight()) == height && _offsetAlgorithm == algorithm &&
+        _offsetBuffer == buffer) {
         return _offsetImage;
     }
 
@@ -347,11 +462,21 @@ PsfCandidate<PixelT>::getOffsetImage(std::string const algorithm,  // Warping al
     double const dx = afw::image::positionToIndex(xcen, true).second;
     double const dy = afw::image::positionToIndex(ycen, true).second;
 
-    PTR(MaskedImageT) offset = afw::math::offsetImage(*image, -dx, -dy, algorithm);
+    // image is our own copy, so Lanczos shifts can be done in place
+    PTR(MaskedImageT) offset;
+    if (auto shifter = LanczosStampShifter::fromAlgorithm(algorithm)) {
+        shifter->shift(*image, -dx, -dy, *image);
+        offset = image;
+    } else {
+        offset = afw::math::offsetImage(*image, -dx, -dy, algorithm);
+    }
     geom::Point2I llc(buffer, buffer);
     geom::Extent2I dims(width, height);
     geom::Box2I box(llc, dims);
-    _offsetImage.reset(new MaskedImageT(*offset, box, afw::image::LOCAL, true));  // Deep copy
+    _offsetImage = copyToStamp(MaskedImageT(*offset, box, afw::image::LOCAL, false),  // Deep copy
+                               _arena.get());
+    _offsetAlgorithm = algorithm;
+    _offsetBuffer = buffer;
 
     return _offsetImage;
 }
@@ -0,0 +1,84 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <cstddef>
+#include <unordered_map>
+
+#include "lsst/meas/algorithms/PsfEvaluationLock.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+namespace {
+
+// The mutexes of the Psfs that are locked; each is created when its Psf is first locked, and destroyed
+// when the last lock on it is released.
+class MutexRegistry {
+public:
+    static MutexRegistry& get() {
+        static MutexRegistry instance;
+        return instance;
+    }
+
+    std::recursive_mutex& acquire(void const* psf) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Entry& entry = _entries[psf];
+        ++entry.users;
+        return entry.mutex;
+    }
+
+    void release(void const* psf) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto iter = _entries.find(psf);
+        if (--iter->second.users == 0) {
+            _entries.erase(iter);
+        }
+    }
+
+private:
+    struct Entry {
+        std::recursive_mutex mutex;
+        std::size_t users = 0;  // number of threads holding or waiting for mutex
+    };
+
+    std::mutex _mutex;
+    std::unordered_map<void const*, Entry> _entries;
+};
+
+}  // namespace
+
+PsfEvaluationLock::PsfEvaluationLock(afw::detection::Psf const& psf)
+        : _psf(&psf), _mutex(&MutexRegistry::get().acquire(_psf)) {
+    _mutex->lock();
+}
+
+PsfEvaluationLock::~PsfEvaluationLock() {
+    _mutex->unlock();
+    MutexRegistry::get().release(_psf);
+}
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
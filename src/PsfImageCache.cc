@@ -0,0 +1,140 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include <cmath>
+#include <functional>
+
+#include "boost/functional/hash.hpp"
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/algorithms/PsfImageCache.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+PsfImageCache::PsfImageCache(double tolerance, std::size_t maxBytes)
+        : _tolerance(tolerance), _maxBytes(maxBytes), _memoryUsage(0), _hits(0), _misses(0) {
+    if (!(tolerance > 0.0)) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("PsfImageCache tolerance must be positive; got %g") % tolerance).str());
+    }
+}
+
+PsfImageCache::Key PsfImageCache::makeKey(geom::Point2D const& position, afw::image::Color const& color,
+                                          std::vector<std::size_t> const& inputs) const {
+    Key key = {static_cast<std::int64_t>(std::floor(position.getX() / _tolerance + 0.5)),
+               static_cast<std::int64_t>(std::floor(position.getY() / _tolerance + 0.5)), color, inputs};
+    return key;
+}
+
+geom::Point2D PsfImageCache::getPosition(Key const& key) const {
+    return geom::Point2D(key.ix * _tolerance, key.iy * _tolerance);
+}
+
+std::size_t PsfImageCache::KeyHash::operator()(Key const& key) const {
+    // Colors only participate in equality, not in the hash; they rarely vary among cached entries.
+    std::size_t seed = 0;
+    boost::hash_combine(seed, key.ix);
+    boost::hash_combine(seed, key.iy);
+    boost::hash_range(seed, key.inputs.begin(), key.inputs.end());
+    return seed;
+}
+
+std::size_t PsfImageCache::_getBytes(Image const& image) {
+    return sizeof(Image::Pixel) * image.getWidth() * image.getHeight();
+}
+
+PTR(PsfImageCache::Image) PsfImageCache::get(Key const& key) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto iter = _lookup.find(key);
+    if (iter == _lookup.end()) {
+        ++_misses;
+        return nullptr;
+    }
+    ++_hits;
+    _entries.splice(_entries.begin(), _entries, iter->second);
+    return iter->second->second;
+}
+
+PTR(PsfImageCache::Image) PsfImageCache::find(Key const& key) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto iter = _lookup.find(key);
+    if (iter == _lookup.end()) {
+        return nullptr;
+    }
+    return iter->second->second;
+}
+
+void PsfImageCache::insert(Key const& key, PTR(Image) image) {
+    std::size_t const bytes = _getBytes(*image);
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto iter = _lookup.find(key);
+    if (iter != _lookup.end()) {
+        // Another thread got here first; keep its image so all callers see the same one.
+        _entries.splice(_entries.begin(), _entries, iter->second);
+        return;
+    }
+    if (bytes > _maxBytes) {
+        return;
+    }
+    _entries.emplace_front(key, std::move(image));
+    _lookup.emplace(key, _entries.begin());
+    _memoryUsage += bytes;
+    while (_memoryUsage > _maxBytes) {
+        auto const& last = _entries.back();
+        _memoryUsage -= _getBytes(*last.second);
+        _lookup.erase(last.first);
+        _entries.pop_back();
+    }
+}
+
+void PsfImageCache::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _lookup.clear();
+    _entries.clear();
+    _memoryUsage = 0;
+}
+
+std::size_t PsfImageCache::getHits() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _hits;
+}
+
+std::size_t PsfImageCache::getMisses() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _misses;
+}
+
+std::size_t PsfImageCache::getSize() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+std::size_t PsfImageCache::getMemoryUsage() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _memoryUsage;
+}
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,145 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <functional>
+
+#include "boost/functional/hash.hpp"
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/algorithms/PsfResultCache.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+PsfResultCache::PsfResultCache(std::size_t capacity) : _capacity(capacity), _hits(0), _misses(0) {
+    if (capacity == 0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "PsfResultCache capacity must be positive");
+    }
+}
+
+std::size_t PsfResultCache::KeyHash::operator()(Key const& key) const {
+    // Colors only participate in equality, not in the hash; they rarely vary among cached entries.
+    std::size_t seed = 0;
+    boost::hash_combine(seed, key.position.getX());
+    boost::hash_combine(seed, key.position.getY());
+    return seed;
+}
+
+PsfResultCache::Entry& PsfResultCache::_getOrInsert(Key const& key, PTR(Image) image) {
+    auto iter = _lookup.find(key);
+    if (iter != _lookup.end()) {
+        _entries.splice(_entries.begin(), _entries, iter->second);
+        return iter->second->second;
+    }
+    _entries.emplace_front(key, Entry());
+    _entries.front().second.image = std::move(image);
+    _lookup.emplace(key, _entries.begin());
+    while (_entries.size() > _capacity) {
+        _lookup.erase(_entries.back().first);
+        _entries.pop_back();
+    }
+    return _entries.front().second;
+}
+
+bool PsfResultCache::getShape(geom::Point2D const& position, afw::image::Color const& color,
+                              afw::geom::ellipses::Quadrupole& shape) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto iter = _lookup.find(Key{position, color});
+    if (iter == _lookup.end() || !iter->second->second.hasShape) {
+        ++_misses;
+        return false;
+    }
+    ++_hits;
+    _entries.splice(_entries.begin(), _entries, iter->second);
+    shape = iter->second->second.shape;
+    return true;
+}
+
+bool PsfResultCache::getApertureFlux(double radius, geom::Point2D const& position,
+                                     afw::image::Color const& color, double& flux) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto iter = _lookup.find(Key{position, color});
+    if (iter != _lookup.end()) {
+        auto const& fluxes = iter->second->second.apertureFluxes;
+        auto fluxIter = fluxes.find(radius);
+        if (fluxIter != fluxes.end()) {
+            ++_hits;
+            _entries.splice(_entries.begin(), _entries, iter->second);
+            flux = fluxIter->second;
+            return true;
+        }
+    }
+    ++_misses;
+    return false;
+}
+
+PTR(PsfResultCache::Image)
+PsfResultCache::getImage(geom::Point2D const& position, afw::image::Color const& color) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto iter = _lookup.find(Key{position, color});
+    if (iter == _lookup.end()) {
+        return nullptr;
+    }
+    return iter->second->second.image;
+}
+
+void PsfResultCache::insertShape(geom::Point2D const& position, afw::image::Color const& color,
+                                 afw::geom::ellipses::Quadrupole const& shape, PTR(Image) image) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry& entry = _getOrInsert(Key{position, color}, std::move(image));
+    entry.shape = shape;
+    entry.hasShape = true;
+}
+
+void PsfResultCache::insertApertureFlux(double radius, geom::Point2D const& position,
+                                        afw::image::Color const& color, double flux, PTR(Image) image) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry& entry = _getOrInsert(Key{position, color}, std::move(image));
+    entry.apertureFluxes[radius] = flux;
+}
+
+void PsfResultCache::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _lookup.clear();
+    _entries.clear();
+}
+
+std::size_t PsfResultCache::getHits() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _hits;
+}
+
+std::size_t PsfResultCache::getMisses() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _misses;
+}
+
+std::size_t PsfResultCache::getSize() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
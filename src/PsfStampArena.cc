@@ -0,0 +1,110 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include <cstdint>
+
+#include "ndarray.h"
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/algorithms/PsfStampArena.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+namespace {
+
+// Planes are aligned to a cache line, so no two stamps (or planes) share one.
+std::size_t const ALIGNMENT = 64;
+
+std::size_t roundUp(std::size_t bytes) { return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+
+template <typename T>
+ndarray::Array<T, 2, 1> makePlane(char* ptr, int width, int height, std::shared_ptr<char> const& owner) {
+    return ndarray::external(reinterpret_cast<T*>(ptr), ndarray::makeVector(height, width),
+                             ndarray::makeVector(width, 1), owner);
+}
+
+}  // namespace
+
+template <typename PixelT>
+PsfStampArena<PixelT>::PsfStampArena(int width, int height, std::size_t capacity)
+        : _width(width), _height(height), _capacity(capacity), _size(0) {
+    if (width <= 0 || height <= 0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("PsfStampArena stamps must have positive dimensions; got %dx%d") %
+                           width % height)
+                                  .str());
+    }
+    std::size_t const nPix = static_cast<std::size_t>(width) * height;
+    _maskOffset = roundUp(nPix * sizeof(typename MaskedImageT::Image::Pixel));
+    _varianceOffset = _maskOffset + roundUp(nPix * sizeof(typename MaskedImageT::Mask::Pixel));
+    _stride = _varianceOffset + roundUp(nPix * sizeof(typename MaskedImageT::Variance::Pixel));
+    _bytes = _stride * capacity;
+    // Over-allocate so the first slot can be aligned.
+    _block.reset(new char[_bytes + ALIGNMENT], std::default_delete<char[]>());
+}
+
+template <typename PixelT>
+std::shared_ptr<typename PsfStampArena<PixelT>::MaskedImageT> PsfStampArena<PixelT>::allocate(
+        geom::Extent2I const& dims) {
+    if (dims.getX() != _width || dims.getY() != _height) {
+        return nullptr;
+    }
+    std::size_t slot;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_size >= _capacity) {
+            return nullptr;
+        }
+        slot = _size++;
+    }
+    std::uintptr_t const base = reinterpret_cast<std::uintptr_t>(_block.get());
+    char* ptr = _block.get() + (roundUp(base) - base) + slot * _stride;
+
+    typedef typename MaskedImageT::Image Image;
+    typedef typename MaskedImageT::Mask Mask;
+    typedef typename MaskedImageT::Variance Variance;
+    auto image = std::make_shared<Image>(makePlane<typename Image::Pixel>(ptr, _width, _height, _block));
+    auto mask = std::make_shared<Mask>(
+            makePlane<typename Mask::Pixel>(ptr + _maskOffset, _width, _height, _block));
+    auto variance = std::make_shared<Variance>(
+            makePlane<typename Variance::Pixel>(ptr + _varianceOffset, _width, _height, _block));
+    return std::make_shared<MaskedImageT>(image, mask, variance);
+}
+
+template <typename PixelT>
+std::size_t PsfStampArena<PixelT>::getSize() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _size;
+}
+
+//
+// Explicit instantiations
+//
+typedef float Pixel;
+
+template class PsfStampArena<Pixel>;
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
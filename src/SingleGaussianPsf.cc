@@ -115,7 +115,9 @@ PTR(afw::math::Kernel) makeSingleGaussianKernel(int width, int height, double si
 }  // namespace
 
 SingleGaussianPsf::SingleGaussianPsf(int width, int height, double sigma)
-        : KernelPsf(makeSingleGaussianKernel(width, height, sigma)), _sigma(sigma) {}
+        : KernelPsf(makeSingleGaussianKernel(width, height, sigma)),
+          _sigma(sigma),
+          _moments({sigma}, {1.0}, getKernel()->getBBox()) {}
 
 PTR(afw::detection::Psf) SingleGaussianPsf::clone() const {
     return std::make_shared<SingleGaussianPsf>(getKernel()->getWidth(), getKernel()->getHeight(), _sigma);
@@ -125,6 +127,22 @@ PTR(afw::detection::Psf) SingleGaussianPsf::resized(int width, int height) const
     return std::make_shared<SingleGaussianPsf>(width, height, _sigma);
 }
 
+double SingleGaussianPsf::doComputeApertureFlux(double radius, geom::Point2D const& position,
+                                                afw::image::Color const& color) const {
+    if (_moments.hasApertureFlux(radius)) {
+        return _moments.computeApertureFlux(radius);
+    }
+    return KernelPsf::doComputeApertureFlux(radius, position, color);
+}
+
+afw::geom::ellipses::Quadrupole SingleGaussianPsf::doComputeShape(geom::Point2D const& position,
+                                                                  afw::image::Color const& color) const {
+    if (_moments.hasShape()) {
+        return _moments.computeShape();
+    }
+    return KernelPsf::doComputeShape(position, color);
+}
+
 std::string SingleGaussianPsf::getPersistenceName() const { return "SingleGaussianPsf"; }
 
 void SingleGaussianPsf::write(OutputArchiveHandle& handle) const {
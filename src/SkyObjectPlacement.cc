@@ -0,0 +1,123 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "lsst/afw/geom/SpanSet.h"
+#include "lsst/afw/math/Random.h"
+#include "lsst/meas/algorithms/SkyObjectPlacement.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+namespace {
+
+// Which pixels of a box are possible centers, one bit per pixel
+class CenterGrid {
+public:
+    explicit CenterGrid(geom::Box2I const& box)
+            : _box(box), _free(static_cast<std::size_t>(box.getWidth()) * box.getHeight(), true) {}
+
+    std::size_t size() const { return _free.size(); }
+
+    bool isFree(std::size_t index) const { return _free[index]; }
+
+    geom::Point2I getPoint(std::size_t index) const {
+        return geom::Point2I(_box.getMinX() + index % _box.getWidth(),
+                             _box.getMinY() + index / _box.getWidth());
+    }
+
+    // Mark the pixels of spans (which may extend beyond the box) as unavailable
+    void block(afw::geom::SpanSet const& spans) {
+        for (auto const& span : spans) {
+            int const y = span.getY();
+            if (y < _box.getMinY() || y > _box.getMaxY()) {
+                continue;
+            }
+            int const x0 = std::max(span.getX0(), _box.getMinX());
+            int const x1 = std::min(span.getX1(), _box.getMaxX());
+            if (x0 > x1) {
+                continue;
+            }
+            std::size_t const start = static_cast<std::size_t>(y - _box.getMinY()) * _box.getWidth();
+            std::fill(_free.begin() + start + (x0 - _box.getMinX()),
+                      _free.begin() + start + (x1 - _box.getMinX()) + 1, false);
+        }
+    }
+
+private:
+    geom::Box2I _box;
+    std::vector<bool> _free;
+};
+
+}  // namespace
+
+std::vector<std::shared_ptr<afw::detection::Footprint>> placeSkyObjects(
+        afw::image::Mask<afw::image::MaskPixel> const& mask, afw::image::MaskPixel avoidBitmask, int radius,
+        int nSources, int nTrials, unsigned long seed, int growMask) {
+    std::vector<std::shared_ptr<afw::detection::Footprint>> skyObjects;
+    geom::Box2I box = mask.getBBox();
+    box.grow(-(radius + 1));  // avoid objects partially off the image
+    if (nSources <= 0 || box.isEmpty()) {
+        return skyObjects;
+    }
+
+    auto const shape = afw::geom::SpanSet::fromShape(radius);
+    // Two objects overlap if the difference of their centers lies in shape dilated by (reflected) shape
+    auto const exclusion = shape->dilated(*shape);
+
+    CenterGrid grid(box);
+    auto avoid = afw::geom::SpanSet::fromMask(mask, avoidBitmask);
+    if (growMask > 0) {
+        avoid = avoid->dilated(growMask);
+    }
+    if (!avoid->empty()) {
+        grid.block(*avoid->dilated(*shape));
+    }
+
+    afw::math::Random rng(afw::math::Random::MT19937, seed);
+    for (int trial = 0; trial < nTrials; ++trial) {
+        std::size_t const index = rng.uniformInt(grid.size());
+        if (!grid.isFree(index)) {
+            continue;  // masked, or blocked by an earlier sky object
+        }
+
+        geom::Point2I const center = grid.getPoint(index);
+        auto footprint =
+                std::make_shared<afw::detection::Footprint>(shape->shiftedBy(center.getX(), center.getY()),
+                                                            mask.getBBox());
+        footprint->addPeak(center.getX(), center.getY(), 0);
+        skyObjects.push_back(footprint);
+        if (static_cast<int>(skyObjects.size()) == nSources) {
+            break;
+        }
+        grid.block(*exclusion->shiftedBy(center.getX(), center.getY()));
+    }
+    return skyObjects;
+}
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,152 @@
+// -*- LSST-C++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 LSST Corporation.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include <algorithm>
+#include <numeric>
+
+#include "lsst/meas/algorithms/SpanComponents.h"
+
+namespace lsst {
+namespace meas {
+namespace algorithms {
+
+namespace {
+
+bool spanLess(afw::geom::Span const& a, afw::geom::Span const& b) {
+    return a.getY() < b.getY() || (a.getY() == b.getY() && a.getX0() < b.getX0());
+}
+
+// A union-find over span indices; the root of each set is its lowest index.
+class DisjointSets {
+public:
+    explicit DisjointSets(std::size_t n) : _parent(n) { std::iota(_parent.begin(), _parent.end(), 0); }
+
+    std::size_t find(std::size_t i) {
+        while (_parent[i] != i) {
+            _parent[i] = _parent[_parent[i]];  // path halving
+            i = _parent[i];
+        }
+        return i;
+    }
+
+    void join(std::size_t i, std::size_t j) {
+        std::size_t const ri = find(i);
+        std::size_t const rj = find(j);
+        if (ri < rj) {
+            _parent[rj] = ri;
+        } else if (rj < ri) {
+            _parent[ri] = rj;
+        }
+    }
+
+private:
+    std::vector<std::size_t> _parent;
+};
+
+}  // namespace
+
+SpanComponents::SpanComponents(std::vector<afw::geom::Span> spans, bool eightConnected)
+        : _spans(std::move(spans)), _labels(_spans.size()), _nComponents(0) {
+    if (!std::is_sorted(_spans.begin(), _spans.end(), spanLess)) {
+        std::sort(_spans.begin(), _spans.end(), spanLess);
+    }
+    int const reach = eightConnected ? 1 : 0;  // how far a span reaches into the rows either side
+    std::size_t const n = _spans.size();
+    DisjointSets sets(n);
+
+    std::size_t prevBegin = 0, prevEnd = 0;  // spans in the previous row, if it is adjacent
+    std::size_t begin = 0;
+    while (begin < n) {
+        int const y = _spans[begin].getY();
+        std::size_t end = begin + 1;
+        for (; end < n && _spans[end].getY() == y; ++end) {
+            if (_spans[end].getX0() <= _spans[end - 1].getX1() + 1) {
+                sets.join(end - 1, end);
+            }
+        }
+        // Sweep this row against the previous one, always advancing the span that ends first
+        for (std::size_t i = prevBegin, j = begin; i < prevEnd && j < end;) {
+            afw::geom::Span const& below = _spans[i];
+            afw::geom::Span const& here = _spans[j];
+            if (below.getX0() <= here.getX1() + reach && here.getX0() <= below.getX1() + reach) {
+                sets.join(i, j);
+            }
+            if (below.getX1() < here.getX1()) {
+                ++i;
+            } else {
+                ++j;
+            }
+        }
+        bool const nextAdjacent = end < n && _spans[end].getY() == y + 1;
+        prevBegin = nextAdjacent ? begin : end;
+        prevEnd = end;
+        begin = end;
+    }
+
+    // Number the components in order of their first span; a root always precedes its set's members.
+    std::vector<int> rootLabels(n, -1);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t const root = sets.find(i);
+        if (rootLabels[root] < 0) {
+            rootLabels[root] = static_cast<int>(_nComponents++);
+        }
+        _labels[i] = rootLabels[root];
+    }
+}
+
+std::vector<std::size_t> SpanComponents::getFirstSpans() const {
+    std::vector<std::size_t> result(_nComponents, _spans.size());
+    for (std::size_t i = _spans.size(); i > 0; --i) {
+        result[_labels[i - 1]] = i - 1;
+    }
+    return result;
+}
+
+std::vector<std::size_t> SpanComponents::getLastSpans() const {
+    std::vector<std::size_t> result(_nComponents, 0);
+    for (std::size_t i = 0; i < _spans.size(); ++i) {
+        result[_labels[i]] = i;
+    }
+    return result;
+}
+
+std::vector<std::vector<afw::geom::Span>> SpanComponents::getComponentSpans() const {
+    std::vector<std::vector<afw::geom::Span>> result(_nComponents);
+    for (std::size_t i = 0; i < _spans.size(); ++i) {
+        result[_labels[i]].push_back(_spans[i]);
+    }
+    return result;
+}
+
+std::vector<std::shared_ptr<afw::geom::SpanSet>> SpanComponents::makeSpanSets() const {
+    std::vector<std::shared_ptr<afw::geom::SpanSet>> result;
+    result.reserve(_nComponents);
+    for (auto& spans : getComponentSpans()) {
+        result.push_back(std::make_shared<afw::geom::SpanSet>(std::move(spans)));
+    }
+    return result;
+}
+
+}  // namespace algorithms
+}  // namespace meas
+}  // namespace lsst
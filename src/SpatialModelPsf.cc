@@ -29,7 +29,11 @@
  *
  * @ingroup algorithms
  */
+#include <algorithm>
+#include <cmath>
+#include <exception>
 #include <numeric>
+#include <thread>
 
 #if !defined(DOXYGEN)
 #include "Minuit2/FCNBase.h"
@@ -49,6 +53,9 @@
 #include "lsst/afw/math/SpatialCell.h"
 #include "lsst/afw/math/FunctionLibrary.h"
 #include "lsst/meas/algorithms/ImagePca.h"
+#include "lsst/meas/algorithms/Instrumentation.h"
+#include "lsst/meas/algorithms/LanczosStampShifter.h"
+#include "lsst/meas/algorithms/PsfEvaluationLock.h"
 #include "lsst/meas/algorithms/SpatialModelPsf.h"
 #include "lsst/meas/algorithms/PsfCandidate.h"
 
@@ -61,6 +68,107 @@ namespace {
 int const WARP_BUFFER(1);                      // Buffer (border) around kernel to prevent warp issues
 std::string const WARP_ALGORITHM("lanczos5");  // Name of warping algorithm to use
 
+// A visitor that records the candidates a SpatialCellSet visits, in the order that it visits them
+class CandidateCollector : public afw::math::CandidateVisitor {
+public:
+    void reset() { _candidates.clear(); }
+
+    void processCandidate(afw::math::SpatialCellCandidate* candidate) { _candidates.push_back(candidate); }
+
+    std::vector<afw::math::SpatialCellCandidate*> const& getCandidates() const { return _candidates; }
+
+private:
+    std::vector<afw::math::SpatialCellCandidate*> _candidates;
+};
+
+// Return the candidates that psfCells.visitCandidates(visitor, nStarPerCell) would visit
+std::vector<afw::math::SpatialCellCandidate*> collectCandidates(afw::math::SpatialCellSet const& psfCells,
+                                                                int nStarPerCell) {
+    CandidateCollector collector;
+    psfCells.visitCandidates(&collector, nStarPerCell);
+    return collector.getCandidates();
+}
+
+// Return the candidates that psfCells.visitAllCandidates(visitor) would visit
+std::vector<afw::math::SpatialCellCandidate*> collectAllCandidates(
+        afw::math::SpatialCellSet const& psfCells) {
+    CandidateCollector collector;
+    psfCells.visitAllCandidates(&collector);
+    return collector.getCandidates();
+}
+
+// Does mask have any of the pixels that createKernelFromPsfCandidates has the PCA replace?
+bool hasBadPixels(afw::image::Mask<afw::image::MaskPixel> const& mask) {
+    afw::image::MaskPixel const bad = afw::image::Mask<>::getPlaneBitMask("BAD") |
+                                      afw::image::Mask<>::getPlaneBitMask("CR") |
+                                      afw::image::Mask<>::getPlaneBitMask("INTRP");
+    for (int y = 0; y != mask.getHeight(); ++y) {
+        for (auto ptr = mask.row_begin(y), end = mask.row_end(y); ptr != end; ++ptr) {
+            if (*ptr & bad) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Number of threads to use for nCandidates candidates given nThreads requested
+int getNWorkers(std::size_t nCandidates, int nThreads) {
+    if (nThreads < 1) {
+        throw LSST_EXCEPT(lsst::pex::exceptions::InvalidParameterError,
+                          (boost::format("nThreads must be positive; got %d") % nThreads).str());
+    }
+    return std::max(1, static_cast<int>(std::min(nCandidates, static_cast<std::size_t>(nThreads))));
+}
+
+/*
+ * Call process(worker, i) for each of the candidates, i, giving each of nWorkers threads a contiguous
+ * block of candidates; worker (in [0, nWorkers)) identifies the thread so that callers can provide
+ * each thread with its own scratch space.
+ *
+ * As in SpatialCellSet::visitCandidates, LengthErrors are skipped if ignoreExceptions is true; any other
+ * exception stops that thread's block, and once all the threads are done the exception thrown by the
+ * earliest candidate is rethrown.
+ */
+template <typename Process>
+void visitInParallel(std::size_t nCandidates, int nWorkers, bool ignoreExceptions, Process const& process) {
+    std::vector<std::exception_ptr> errors(nWorkers);
+    auto processBlock = [&](int worker) {
+        std::size_t const begin = nCandidates * worker / nWorkers;
+        std::size_t const end = nCandidates * (worker + 1) / nWorkers;
+        for (std::size_t i = begin; i != end; ++i) {
+            try {
+                try {
+                    process(worker, i);
+                } catch (lsst::pex::exceptions::LengthError&) {
+                    if (!ignoreExceptions) {
+                        throw;
+                    }
+                }
+            } catch (...) {
+                errors[worker] = std::current_exception();
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(nWorkers - 1);
+    for (int worker = 1; worker < nWorkers; ++worker) {
+        threads.emplace_back(processBlock, worker);
+    }
+    processBlock(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    // The blocks are in candidate order, so the first error found is the earliest one
+    for (auto const& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
 // A class to pass around to all our PsfCandidates which builds the PcaImageSet
 template <typename PixelT>
 class SetPcaImageVisitor : public afw::math::CandidateVisitor {
@@ -78,6 +186,16 @@ public:
 
     // Called by SpatialCellSet::visitCandidates for each Candidate
     void processCandidate(afw::math::SpatialCellCandidate* candidate) {
+        std::pair<std::shared_ptr<MaskedImageT>, double> const image = getImage(candidate);
+        if (image.first) {
+            _imagePca->addImage(image.first, image.second, candidate);
+        }
+    }
+
+    // Return the candidate's image and flux, as processCandidate would add them to the ImagePca;
+    // the image is null if the candidate should be skipped.  Safe to call from several threads at once.
+    std::pair<std::shared_ptr<MaskedImageT>, double> getImage(
+            afw::math::SpatialCellCandidate* candidate) const {
         PsfCandidate<PixelT>* imCandidate = dynamic_cast<PsfCandidate<PixelT>*>(candidate);
         if (imCandidate == NULL) {
             throw LSST_EXCEPT(lsst::pex::exceptions::LogicError,
@@ -107,9 +225,14 @@ public:
                                       imCandidate->getXCenter() % imCandidate->getYCenter()));
             }
 
-            _imagePca->addImage(im, imCandidate->getSource()->getPsfInstFlux());
+            // The PCA replaces bad pixels with its model, so give it a copy of the candidate's cached
+            // stamp (which is also used to fit the kernel and compute chi^2) if it has any
+            if (hasBadPixels(*im->getMask())) {
+                im = std::make_shared<MaskedImageT>(*im, true);
+            }
+            return std::make_pair(im, imCandidate->getSource()->getPsfInstFlux());
         } catch (lsst::pex::exceptions::LengthError&) {
-            return;
+            return std::make_pair(std::shared_ptr<MaskedImageT>(), 0.0);
         }
     }
 
@@ -172,7 +295,7 @@ std::vector<std::shared_ptr<ImageT>> offsetKernel(
     ImageT scratch(kernel.getDimensions());  // Buffered scratch space
     for (unsigned int i = 0; i != nKernel; ++i) {
         kernels[i]->computeImage(scratch, false);
-        kernelImages[i] = afw::math::offsetImage(scratch, dx, dy, WARP_ALGORITHM, WARP_BUFFER);
+        kernelImages[i] = offsetStamp(scratch, dx, dy, WARP_ALGORITHM, WARP_BUFFER);
     }
 
     return kernelImages;
@@ -199,7 +322,11 @@ createKernelFromPsfCandidates(
         int const ksize,            ///< Size of generated Kernel images
         int const nStarPerCell,     ///< max no. of stars per cell; <= 0 => infty
         bool const constantWeight,  ///< should each star have equal weight in the fit?
-        int const border            ///< Border size for background subtraction
+        int const border,           ///< Border size for background subtraction
+        int const nThreads,         ///< number of threads to use when extracting the candidates' images
+        bool const randomized,      ///< find the nEigenComponents with a randomized truncated SVD?
+        ImageInnerProductCache<afw::image::MaskedImage<PixelT>>* cache  ///< cache of the PCA's inner
+                                                                         ///< products, or null
         ) {
     typedef typename afw::image::Image<PixelT> ImageT;
     typedef typename afw::image::MaskedImage<PixelT> MaskedImageT;
@@ -215,11 +342,29 @@ createKernelFromPsfCandidates(
     lsst::meas::algorithms::PsfCandidate<PixelT>::setHeight(ksize);
 
     PsfImagePca<MaskedImageT> imagePca(constantWeight, border);  // Here's the set of images we'll analyze
+    if (randomized || cache) {
+        // We only need the first nEigenComponents eigenimages
+        imagePca.setComponents(nEigenComponents, randomized);
+        imagePca.setInnerProductCache(cache);
+    }
 
     {
         SetPcaImageVisitor<PixelT> importStarVisitor(&imagePca);
         bool const ignoreExceptions = true;
-        psfCells.visitCandidates(&importStarVisitor, nStarPerCell, ignoreExceptions);
+        //
+        // Extract the images in parallel, but add them to the PCA in the order visitCandidates would
+        //
+        std::vector<afw::math::SpatialCellCandidate*> const candidates =
+                collectCandidates(psfCells, nStarPerCell);
+        std::vector<std::pair<std::shared_ptr<MaskedImageT>, double>> images(candidates.size());
+        visitInParallel(candidates.size(), getNWorkers(candidates.size(), nThreads), ignoreExceptions,
+                        [&](int, std::size_t i) { images[i] = importStarVisitor.getImage(candidates[i]); });
+        for (std::size_t i = 0; i != images.size(); ++i) {
+            if (images[i].first) {
+                // the images may be copies, so identify them to the inner product cache by candidate
+                imagePca.addImage(images[i].first, images[i].second, candidates[i]);
+            }
+        }
     }
 
     //
@@ -446,7 +591,10 @@ public:
     void reset() { _chi2 = 0.0; }
 
     // Called by SpatialCellSet::visitCandidates for each Candidate
-    void processCandidate(afw::math::SpatialCellCandidate* candidate) {
+    void processCandidate(afw::math::SpatialCellCandidate* candidate) { _chi2 += computeChi2(candidate); }
+
+    // Set the candidate's chi^2 and amplitude, and return its contribution to the total chi^2
+    double computeChi2(afw::math::SpatialCellCandidate* candidate) const {
         PsfCandidate<PixelT>* imCandidate = dynamic_cast<PsfCandidate<PixelT>*>(candidate);
         if (imCandidate == NULL) {
             throw LSST_EXCEPT(lsst::pex::exceptions::LogicError,
@@ -461,7 +609,7 @@ public:
         try {
             data = imCandidate->getOffsetImage(WARP_ALGORITHM, WARP_BUFFER);
         } catch (lsst::pex::exceptions::LengthError&) {
-            return;
+            return 0.0;
         }
 
         try {
@@ -474,12 +622,13 @@ public:
             imCandidate->setChi2(dchi2);
             imCandidate->setAmplitude(amp);
 
-            _chi2 += dchi2;
+            return dchi2;
         } catch (lsst::pex::exceptions::RangeError& e) {
             imCandidate->setStatus(afw::math::SpatialCellCandidate::BAD);
             imCandidate->setChi2(std::numeric_limits<double>::quiet_NaN());
             imCandidate->setAmplitude(std::numeric_limits<double>::quiet_NaN());
         }
+        return 0.0;
     }
 
     // Return the computed chi^2
@@ -492,6 +641,33 @@ private:
     std::shared_ptr<KImage> mutable _kImage;  // The Kernel at this point; a scratch copy
 };
 
+/*
+ * Return the chi^2 of kernel's fit to the candidates, setting each candidate's chi^2 and amplitude
+ * as evalChi2Visitor does.  The candidates are shared among nThreads threads, but their contributions
+ * are summed in order so the result doesn't depend on the number of threads.
+ */
+template <typename PixelT>
+double evalChi2(afw::math::Kernel const& kernel, double lambda,
+                std::vector<afw::math::SpatialCellCandidate*> const& candidates, bool ignoreExceptions,
+                int nThreads) {
+    int const nWorkers = getNWorkers(candidates.size(), nThreads);
+    // Kernel::computeImage sets a spatially-varying Kernel's parameters, so each thread needs its own
+    std::vector<std::shared_ptr<afw::math::Kernel>> kernels(1);
+    std::vector<evalChi2Visitor<PixelT>> visitors;
+    visitors.reserve(nWorkers);
+    visitors.emplace_back(kernel, lambda);
+    for (int worker = 1; worker < nWorkers; ++worker) {
+        kernels.push_back(kernel.clone());
+        visitors.emplace_back(*kernels.back(), lambda);
+    }
+
+    std::vector<double> chi2(candidates.size(), 0.0);
+    visitInParallel(candidates.size(), nWorkers, ignoreExceptions, [&](int worker, std::size_t i) {
+        chi2[i] = visitors[worker].computeChi2(candidates[i]);
+    });
+    return std::accumulate(chi2.begin(), chi2.end(), 0.0);
+}
+
 /********************************************************************************************************/
 /**
  * Fit a Kernel's spatial variability from a set of stars
@@ -543,16 +719,16 @@ void setSpatialParameters(afw::math::Kernel* kernel, Eigen::VectorXd const& vec)
 template <typename PixelT>
 class MinimizeChi2 : public ROOT::Minuit2::FCNBase {
 public:
-    explicit MinimizeChi2(evalChi2Visitor<PixelT>& chi2Visitor, afw::math::Kernel* kernel,
-                          afw::math::SpatialCellSet const& psfCells, int nStarPerCell, int nComponents,
-                          int nSpatialParams)
+    explicit MinimizeChi2(afw::math::Kernel* kernel, double lambda, afw::math::SpatialCellSet const& psfCells,
+                          int nStarPerCell, int nComponents, int nSpatialParams, int nThreads)
             : _errorDef(1.0),
-              _chi2Visitor(chi2Visitor),
               _kernel(kernel),
+              _lambda(lambda),
               _psfCells(psfCells),
               _nStarPerCell(nStarPerCell),
               _nComponents(nComponents),
-              _nSpatialParams(nSpatialParams) {}
+              _nSpatialParams(nSpatialParams),
+              _nThreads(nThreads) {}
 
     /**
      * Error definition of the function. MINUIT defines Parameter errors as the
@@ -566,9 +742,9 @@ public:
     double operator()(const std::vector<double>& coeffs) const {
         setSpatialParameters(_kernel, coeffs);
 
-        _psfCells.visitCandidates(&_chi2Visitor, _nStarPerCell);
-
-        return _chi2Visitor.getValue();
+        // Candidates may have been marked BAD by the previous call, so look them up again
+        return evalChi2<PixelT>(*_kernel, _lambda, collectCandidates(_psfCells, _nStarPerCell), false,
+                                _nThreads);
     }
 
     void setErrorDef(double def) { _errorDef = def; }
@@ -576,12 +752,13 @@ public:
 private:
     double _errorDef;  // how much cost function has changed at the +- 1 error points
 
-    evalChi2Visitor<PixelT>& _chi2Visitor;
     afw::math::Kernel* _kernel;
+    double _lambda;  // floor for variance is _lambda*data
     afw::math::SpatialCellSet const& _psfCells;
     int _nStarPerCell;
     int _nComponents;
     int _nSpatialParams;
+    int _nThreads;
 };
 
 /************************************************************************************************************/
@@ -594,15 +771,13 @@ std::pair<bool, double> fitSpatialKernelFromPsfCandidates(
         afw::math::SpatialCellSet const& psfCells,  ///< A SpatialCellSet containing PsfCandidates
         int const nStarPerCell,                     ///< max no. of stars per cell; <= 0 => infty
         double const tolerance,                     ///< Tolerance; how close chi^2 should be to true minimum
-        double const lambda                         ///< floor for variance is lambda*data
+        double const lambda,                        ///< floor for variance is lambda*data
+        int const nThreads                          ///< number of threads to use when evaluating chi^2
         ) {
+    LSST_MEAS_ALGORITHMS_TIME("fitSpatialKernelFromPsfCandidates.nonLinear");
     int const nComponents = kernel->getNKernelParameters();
     int const nSpatialParams = kernel->getNSpatialParameters();
     //
-    // visitor that evaluates the chi^2 of the current fit
-    //
-    evalChi2Visitor<PixelT> getChi2(*kernel, lambda);
-    //
     // We have to unpack the Kernel coefficients into a linear array, coeffs
     //
     std::vector<double> coeffs;  // The coefficients we want to fit
@@ -628,7 +803,8 @@ std::pair<bool, double> fitSpatialKernelFromPsfCandidates(
     //
     // Create the minuit object that knows how to minimise our functor
     //
-    MinimizeChi2<PixelT> minimizerFunc(getChi2, kernel, psfCells, nStarPerCell, nComponents, nSpatialParams);
+    MinimizeChi2<PixelT> minimizerFunc(kernel, lambda, psfCells, nStarPerCell, nComponents, nSpatialParams,
+                                       nThreads);
 
     double const errorDef = 1.0;  // use +- 1sigma errors
     minimizerFunc.setErrorDef(errorDef);
@@ -671,11 +847,75 @@ std::pair<bool, double> fitSpatialKernelFromPsfCandidates(
     // One time more through the Candidates setting their chi^2 values. We'll
     // do all the candidates this time, not just the first nStarPerCell
     //
-    psfCells.visitAllCandidates(&getChi2, true);
+    evalChi2<PixelT>(*kernel, lambda, collectAllCandidates(psfCells), true, nThreads);
 
     return std::make_pair(isValid, minChi2);
 }
 
+/************************************************************************************************************/
+/*
+ * SpatialKernelFitCache's members
+ */
+template <typename PixelT>
+SpatialKernelFitCache<PixelT>::Entry::Entry()
+        : basisAmplitude(std::numeric_limits<double>::quiet_NaN()),
+          amplitude(std::numeric_limits<double>::quiet_NaN()),
+          reused(false) {}
+
+template <typename PixelT>
+SpatialKernelFitCache<PixelT>::SpatialKernelFitCache() : _border(0), _hits(0), _misses(0) {}
+
+template <typename PixelT>
+std::vector<typename SpatialKernelFitCache<PixelT>::Entry*> SpatialKernelFitCache<PixelT>::getEntries(
+        afw::math::LinearCombinationKernel const& kernel,
+        std::vector<afw::math::SpatialCellCandidate*> const& candidates) {
+    afw::math::KernelList const& kernels = kernel.getKernelList();  // Kernel's components
+    std::vector<std::shared_ptr<KernelImage>> basis;
+    basis.reserve(kernels.size());
+    for (auto const& component : kernels) {
+        basis.push_back(std::make_shared<KernelImage>(component->getDimensions()));
+        component->computeImage(*basis.back(), false);
+    }
+    int const border = PsfCandidate<PixelT>::getBorderWidth();
+
+    bool sameBasis = (basis.size() == _basis.size() && border == _border);
+    for (std::size_t i = 0; sameBasis && i != basis.size(); ++i) {
+        sameBasis = basis[i]->getBBox() == _basis[i]->getBBox() &&
+                    std::equal(basis[i]->begin(true), basis[i]->end(true), _basis[i]->begin(true));
+    }
+    if (!sameBasis) {
+        clear();
+        _basis.swap(basis);
+        _border = border;
+    }
+
+    std::vector<Entry*> entries;
+    entries.reserve(candidates.size());
+    for (auto const& candidate : candidates) {
+        Entry& entry = _entries[candidate->getId()];
+        entry.reused = false;
+        entries.push_back(&entry);
+    }
+    return entries;
+}
+
+template <typename PixelT>
+void SpatialKernelFitCache<PixelT>::countUses(std::vector<Entry*> const& entries) {
+    for (auto const& entry : entries) {
+        if (entry->reused) {
+            ++_hits;
+        } else {
+            ++_misses;
+        }
+    }
+}
+
+template <typename PixelT>
+void SpatialKernelFitCache<PixelT>::clear() {
+    _basis.clear();
+    _entries.clear();
+}
+
 /************************************************************************************************************/
 /**
  * Fit spatial kernel using approximate fluxes for candidates, and solving a linear system of equations
@@ -727,11 +967,13 @@ class FillABVisitor : public afw::math::CandidateVisitor {
 
 public:
     explicit FillABVisitor(afw::math::LinearCombinationKernel const& kernel,  // the Kernel we're fitting
-                           double tau2 = 0.0  // floor to the per-candidate variance
+                           double tau2 = 0.0,  // floor to the per-candidate variance
+                           bool useCandidateAmplitudes = false  // use the candidates' current amplitudes?
                            )
             : afw::math::CandidateVisitor(),
               _kernel(kernel),
               _tau2(tau2),
+              _useCandidateAmplitudes(useCandidateAmplitudes),
               _nSpatialParams(_kernel.getNSpatialParameters()),
               _nComponents(_kernel.getNKernelParameters()),
               _basisImgs(),
@@ -766,6 +1008,14 @@ public:
 
     // Called by SpatialCellSet::visitCandidates for each Candidate
     void processCandidate(afw::math::SpatialCellCandidate* candidate) {
+        typename SpatialKernelFitCache<PixelT>::Entry entry;
+        accumulate(candidate, _A, _b, entry);
+    }
+
+    // Add the candidate's contribution to A and b, which must have the dimensions of getA() and getB(),
+    // reusing (or filling) entry, the candidate's cached quantities for this Kernel's basis
+    void accumulate(afw::math::SpatialCellCandidate* candidate, Eigen::MatrixXd& A, Eigen::VectorXd& b,
+                    typename SpatialKernelFitCache<PixelT>::Entry& entry) const {
         PsfCandidate<PixelT>* imCandidate = dynamic_cast<PsfCandidate<PixelT>*>(candidate);
         if (imCandidate == NULL) {
             throw LSST_EXCEPT(lsst::pex::exceptions::LogicError,
@@ -778,16 +1028,18 @@ public:
         } catch (lsst::pex::exceptions::LengthError&) {
             return;
         }
+        if (entry.data != data) {
+            entry = typename SpatialKernelFitCache<PixelT>::Entry();
+            entry.data = data;
+        }
         double const xcen = imCandidate->getXCenter();
         double const ycen = imCandidate->getYCenter();
         double const dx = afw::image::positionToIndex(xcen, true).second;
         double const dy = afw::image::positionToIndex(ycen, true).second;
 
-#if 0
-        double const amp = imCandidate->getAmplitude();
-#else
         /*
-         * Estimate the amplitude based on the current basis functions.
+         * Estimate the amplitude based on the current basis functions, unless we're refining a previous
+         * solution, in which case the amplitudes of the previous model's fit to the candidates are used.
          *
          * N.b. you have to be a little careful here.  Consider a PSF that is phi == (N0 + b*y*N1)/(1 + b*y)
          * where the amplitude of N0 and N1 is 1.0, so a star has profile I = A*(N0 + b*y*N1)/(1 + b*y)
@@ -795,10 +1047,17 @@ public:
          * If we set the amplitude to be A = I(0)/phi(0) (i.e. the central value of the data and best-fit phi)
          * then the coefficient of N0 becomes 1/(1 + b*y) which makes the model non-linear in y.
          */
-        std::pair<std::shared_ptr<afw::math::Kernel>, std::pair<double, double>> ret =
-                fitKernelToImage(_kernel, *data, geom::Point2D(xcen, ycen));
-        double const amp = ret.second.first;
-#endif
+        double amp = 0.0;
+        if (_useCandidateAmplitudes) {
+            amp = imCandidate->getAmplitude();
+        } else if (std::isnan(entry.basisAmplitude)) {
+            std::pair<std::shared_ptr<afw::math::Kernel>, std::pair<double, double>> ret =
+                    fitKernelToImage(_kernel, *data, geom::Point2D(xcen, ycen));
+            amp = entry.basisAmplitude = ret.second.first;
+        } else {
+            amp = entry.basisAmplitude;
+            entry.reused = true;
+        }
 
         double const var = imCandidate->getVar();
         double const ivar = 1 / (var + _tau2);  // Allow for floor on variance
@@ -809,27 +1068,43 @@ public:
             params[ic] = _kernel.getSpatialFunction(ic)->getDFuncDParameters(xcen, ycen);
         }
 
-        std::vector<std::shared_ptr<KImage>> basisImages = offsetKernel<KImage>(_kernel, dx, dy);
+        if (entry.offsetBasis.empty()) {
+            entry.offsetBasis = offsetKernel<KImage>(_kernel, dx, dy);
+        } else {
+            entry.reused = true;
+        }
+        std::vector<std::shared_ptr<KImage>> const& basisImages = entry.offsetBasis;
+
+        if (entry.basisDotData.empty() || entry.amplitude != amp) {
+            // Prepare values for basis dot data
+            // Scale data and subtract 0th component as part of unit kernel sum construction
+            std::shared_ptr<Image> dataImage(new Image(*data->getImage(), true));
+            typename KImage::fast_iterator bPtr = basisImages[0]->begin(true);
+            for (typename Image::fast_iterator dPtr = dataImage->begin(true), end = dataImage->end(true);
+                 dPtr != end; ++dPtr, ++bPtr) {
+                *dPtr = *dPtr / amp - *bPtr;
+            }
 
-        // Prepare values for basis dot data
-        // Scale data and subtract 0th component as part of unit kernel sum construction
-        std::shared_ptr<Image> dataImage(new Image(*data->getImage(), true));
-        typename KImage::fast_iterator bPtr = basisImages[0]->begin(true);
-        for (typename Image::fast_iterator dPtr = dataImage->begin(true), end = dataImage->end(true);
-             dPtr != end; ++dPtr, ++bPtr) {
-            *dPtr = *dPtr / amp - *bPtr;
+            std::vector<double> basisDotData(_nComponents);
+            for (int ic = 1; ic != _nComponents; ++ic) {  // Don't need 0th component now
+                basisDotData[ic] = afw::image::innerProduct(*basisImages[ic], *dataImage,
+                                                            PsfCandidate<PixelT>::getBorderWidth());
+            }
+            entry.amplitude = amp;
+            entry.basisDotData.swap(basisDotData);
+        } else {
+            entry.reused = true;
         }
 
         for (int i = 0, ic = 1; ic != _nComponents; ++ic) {  // Don't need 0th component now
-            double const basisDotData = afw::image::innerProduct(*basisImages[ic], *dataImage,
-                                                                 PsfCandidate<PixelT>::getBorderWidth());
+            double const basisDotData = entry.basisDotData[ic];
             for (int is = 0; is != _nSpatialParams; ++is, ++i) {
-                _b(i) += ivar * params[ic][is] * basisDotData;
+                b(i) += ivar * params[ic][is] * basisDotData;
 
                 for (int j = i, jc = ic; jc != _nComponents; ++jc) {
                     for (int js = (i == j) ? is : 0; js != _nSpatialParams; ++js, ++j) {
-                        _A(i, j) += ivar * params[ic][is] * params[jc][js] * _basisDotBasis(ic, jc);
-                        _A(j, i) = _A(i, j);  // could do this after _A is fully calculated
+                        A(i, j) += ivar * params[ic][is] * params[jc][js] * _basisDotBasis(ic, jc);
+                        A(j, i) = A(i, j);  // could do this after A is fully calculated
                     }
                 }
             }
@@ -842,6 +1117,7 @@ public:
 private:
     afw::math::LinearCombinationKernel const& _kernel;  // the kernel
     double _tau2;               // variance floor added in quadrature to true candidate variance
+    bool _useCandidateAmplitudes;  // use the candidates' amplitudes rather than fitting the basis?
     int const _nSpatialParams;  // number of spatial parameters
     int const _nComponents;     // number of basis functions
     std::vector<std::shared_ptr<KImage>> _basisImgs;  // basis function images from _kernel
@@ -870,50 +1146,54 @@ public:
     }
 };
 
-}  // namespace
-
+/*
+ * Solve the linear system set up by FillABVisitor for the candidates, and return the corresponding
+ * spatial parameters for the Kernel (including those of the 0th component)
+ */
 template <typename PixelT>
-std::pair<bool, double> fitSpatialKernelFromPsfCandidates(
-        afw::math::Kernel* kernel,                  ///< the Kernel to fit
-        afw::math::SpatialCellSet const& psfCells,  ///< A SpatialCellSet containing PsfCandidates
-        bool const doNonLinearFit,                  ///< Use the full-up nonlinear fitter
-        int const nStarPerCell,                     ///< max no. of stars per cell; <= 0 => infty
-        double const tolerance,                     ///< Tolerance; how close chi^2 should be to true minimum
-        double const lambda                         ///< floor for variance is lambda*data
-        ) {
-    if (doNonLinearFit) {
-        return fitSpatialKernelFromPsfCandidates<PixelT>(kernel, psfCells, nStarPerCell, tolerance);
-    }
-
-    double const tau = 0;  // softening for errors
-
-    afw::math::LinearCombinationKernel const* lcKernel =
-            dynamic_cast<afw::math::LinearCombinationKernel const*>(kernel);
-    if (!lcKernel) {
-        throw LSST_EXCEPT(
-                lsst::pex::exceptions::LogicError,
-                "Failed to cast Kernel to LinearCombinationKernel while building spatial PSF model");
-    }
-#if 1
+Eigen::VectorXd solveForSpatialParameters(afw::math::LinearCombinationKernel const& kernel, double tau,
+                                          bool useCandidateAmplitudes,
+                                          std::vector<afw::math::SpatialCellCandidate*> const& candidates,
+                                          SpatialKernelFitCache<PixelT>& cache, int nThreads) {
     //
-    // Set the initial amplitudes of all our candidates
+    // visitors that fill out the A and b matrices (we'll solve A x = b for the coeffs, x); each thread
+    // has its own copy of the Kernel, and each candidate's contribution is kept separately so that they
+    // can be summed in the same order whatever the number of threads
     //
-    setAmplitudeVisitor<PixelT> setAmplitude;
-    psfCells.visitAllCandidates(&setAmplitude, true);
-#endif
-    //
-    // visitor that fills out the A and b matrices (we'll solve A x = b for the coeffs, x)
-    //
-    FillABVisitor<PixelT> getAB(*lcKernel, tau);
+    int const nWorkers = getNWorkers(candidates.size(), nThreads);
+    std::vector<std::shared_ptr<afw::math::Kernel>> kernels(1);
+    std::vector<FillABVisitor<PixelT>> visitors;
+    visitors.reserve(nWorkers);
+    visitors.emplace_back(kernel, tau, useCandidateAmplitudes);
+    for (int worker = 1; worker < nWorkers; ++worker) {
+        kernels.push_back(kernel.clone());
+        visitors.emplace_back(dynamic_cast<afw::math::LinearCombinationKernel const&>(*kernels.back()), tau,
+                              useCandidateAmplitudes);
+    }
+    Eigen::MatrixXd A = visitors[0].getA();
+    Eigen::VectorXd b = visitors[0].getB();
+    std::vector<typename SpatialKernelFitCache<PixelT>::Entry*> const entries =
+            cache.getEntries(kernel, candidates);
+    std::vector<Eigen::MatrixXd> candidateA(candidates.size());
+    std::vector<Eigen::VectorXd> candidateB(candidates.size());
     //
     // Actually visit all our candidates
     //
-    psfCells.visitCandidates(&getAB, nStarPerCell, true);
+    visitInParallel(candidates.size(), nWorkers, true, [&](int worker, std::size_t i) {
+        candidateA[i] = Eigen::MatrixXd::Zero(A.rows(), A.cols());
+        candidateB[i] = Eigen::VectorXd::Zero(b.size());
+        visitors[worker].accumulate(candidates[i], candidateA[i], candidateB[i], *entries[i]);
+    });
+    cache.countUses(entries);
+    for (std::size_t i = 0; i != candidates.size(); ++i) {
+        if (candidateA[i].size() > 0) {
+            A += candidateA[i];
+            b += candidateB[i];
+        }
+    }
     //
-    // Extract A and b, and solve Ax = b
+    // Solve Ax = b
     //
-    Eigen::MatrixXd const& A = getAB.getA();
-    Eigen::VectorXd const& b = getAB.getB();
     Eigen::VectorXd x0(b.size());  // Solution to matrix problem
 
     switch (b.size()) {
@@ -949,23 +1229,91 @@ std::pair<bool, double> fitSpatialKernelFromPsfCandidates(
 #endif
 
     // Generate kernel parameters (including 0th component) from matrix solution
-    Eigen::VectorXd x(kernel->getNKernelParameters() * kernel->getNSpatialParameters());  // Kernel parameters
+    Eigen::VectorXd x(kernel.getNKernelParameters() * kernel.getNSpatialParameters());  // Kernel parameters
     x(0) = 1.0;
-    std::fill(x.data() + 1, x.data() + kernel->getNSpatialParameters(), 0.0);
-    std::copy(x0.data(), x0.data() + x0.size(), x.data() + kernel->getNSpatialParameters());
+    std::fill(x.data() + 1, x.data() + kernel.getNSpatialParameters(), 0.0);
+    std::copy(x0.data(), x0.data() + x0.size(), x.data() + kernel.getNSpatialParameters());
+
+    return x;
+}
+
 
+}  // namespace
+
+template <typename PixelT>
+std::pair<bool, double> fitSpatialKernelFromPsfCandidates(
+        afw::math::Kernel* kernel,                  ///< the Kernel to fit
+        afw::math::SpatialCellSet const& psfCells,  ///< A SpatialCellSet containing PsfCandidates
+        bool const doNonLinearFit,                  ///< Use the full-up nonlinear fitter
+        int const nStarPerCell,                     ///< max no. of stars per cell; <= 0 => infty
+        double const tolerance,                     ///< Tolerance; how close chi^2 should be to true minimum
+        double const lambda,                        ///< floor for variance is lambda*data
+        int const nThreads,                         ///< number of threads to use when visiting candidates
+        int const nAmplitudeIter,                   ///< max. no. of refits using the models' amplitudes
+        SpatialKernelFitCache<PixelT>* cache        ///< per-candidate quantities to reuse; may be null
+        ) {
+    if (doNonLinearFit) {
+        return fitSpatialKernelFromPsfCandidates<PixelT>(kernel, psfCells, nStarPerCell, tolerance, 0.0,
+                                                         nThreads);
+    }
+    LSST_MEAS_ALGORITHMS_TIME("fitSpatialKernelFromPsfCandidates.linear");
+
+    double const tau = 0;  // softening for errors
+
+    afw::math::LinearCombinationKernel const* lcKernel =
+            dynamic_cast<afw::math::LinearCombinationKernel const*>(kernel);
+    if (!lcKernel) {
+        throw LSST_EXCEPT(
+                lsst::pex::exceptions::LogicError,
+                "Failed to cast Kernel to LinearCombinationKernel while building spatial PSF model");
+    }
+#if 1
+    //
+    // Set the initial amplitudes of all our candidates
+    //
+    setAmplitudeVisitor<PixelT> setAmplitude;
+    {
+        std::vector<afw::math::SpatialCellCandidate*> const candidates = collectAllCandidates(psfCells);
+        visitInParallel(candidates.size(), getNWorkers(candidates.size(), nThreads), true,
+                        [&](int, std::size_t i) { setAmplitude.processCandidate(candidates[i]); });
+    }
+#endif
+    SpatialKernelFitCache<PixelT> localCache;  // used if we weren't given a cache
+    if (!cache) {
+        cache = &localCache;
+    }
+    Eigen::VectorXd x = solveForSpatialParameters<PixelT>(
+            *lcKernel, tau, false, collectCandidates(psfCells, nStarPerCell), *cache, nThreads);
     setSpatialParameters(kernel, x);
     //
-    // One time more through the Candidates setting their chi^2 values. We'll
+    // One time more through the Candidates setting their chi^2 values (and amplitudes). We'll
     // do all the candidates this time, not just the first nStarPerCell
     //
-    // visitor that evaluates the chi^2 of the current fit
+    double chi2 = evalChi2<PixelT>(*kernel, lambda, collectAllCandidates(psfCells), true, nThreads);
     //
-    evalChi2Visitor<PixelT> getChi2(*kernel, lambda);
-
-    psfCells.visitAllCandidates(&getChi2, true);
+    // Refit using the amplitudes of the current model's fits to the candidates, until chi^2
+    // converges to within tolerance
+    //
+    for (int iter = 0; iter < nAmplitudeIter && std::isfinite(chi2); ++iter) {
+        x = solveForSpatialParameters<PixelT>(*lcKernel, tau, true,
+                                              collectCandidates(psfCells, nStarPerCell), *cache, nThreads);
+        setSpatialParameters(kernel, x);
+
+        double const previousChi2 = chi2;
+        chi2 = evalChi2<PixelT>(*kernel, lambda, collectAllCandidates(psfCells), true, nThreads);
+        if (std::fabs(chi2 - previousChi2) <= tolerance * std::fabs(chi2)) {
+            break;
+        }
+    }
+    //
+    // Fall back to the non-linear fitter if the linear system was degenerate
+    //
+    if (!x.allFinite() || !std::isfinite(chi2)) {
+        return fitSpatialKernelFromPsfCandidates<PixelT>(kernel, psfCells, true, nStarPerCell, tolerance,
+                                                         lambda, nThreads);
+    }
 
-    return std::make_pair(true, getChi2.getValue());
+    return std::make_pair(true, chi2);
 }
 
 /************************************************************************************************************/
@@ -986,7 +1334,11 @@ double subtractPsf(afw::detection::Psf const& psf,  ///< the PSF to subtract
     //
     // Get Psf candidate
     //
-    std::shared_ptr<afw::detection::Psf::Image> kImage = psf.computeImage(geom::PointD(x, y));
+    std::shared_ptr<afw::detection::Psf::Image> kImage;
+    {
+        PsfEvaluationLock lock(psf);  // we may be called without the GIL on several threads
+        kImage = psf.computeImage(geom::PointD(x, y));
+    }
 
     //
     // Now find the proper sub-Image
@@ -1039,6 +1391,7 @@ std::pair<std::vector<double>, afw::math::KernelList> fitKernelParamsToImage(
         Image const& image,                                ///< the image to be fit
         geom::Point2D const& pos                           ///< the position of the object
         ) {
+    LSST_MEAS_ALGORITHMS_TIME("fitKernelParamsToImage");
     typedef afw::image::Image<afw::math::Kernel::Pixel> KernelT;
 
     afw::math::KernelList kernels = kernel.getKernelList();  // the Kernels that kernel adds together
@@ -1139,17 +1492,20 @@ typedef float Pixel;
 template std::pair<std::shared_ptr<afw::math::LinearCombinationKernel>, std::vector<double>>
 createKernelFromPsfCandidates<Pixel>(afw::math::SpatialCellSet const&, geom::Extent2I const&,
                                      geom::Point2I const&, int const, int const, int const, int const,
-                                     bool const, int const);
+                                     bool const, int const, int const, bool const,
+                                     ImageInnerProductCache<afw::image::MaskedImage<Pixel>>*);
 template int countPsfCandidates<Pixel>(afw::math::SpatialCellSet const&, int const);
 
 template std::pair<bool, double> fitSpatialKernelFromPsfCandidates<Pixel>(afw::math::Kernel*,
                                                                           afw::math::SpatialCellSet const&,
                                                                           int const, double const,
-                                                                          double const);
+                                                                          double const, int const);
 template std::pair<bool, double> fitSpatialKernelFromPsfCandidates<Pixel>(afw::math::Kernel*,
                                                                           afw::math::SpatialCellSet const&,
                                                                           bool const, int const, double const,
-                                                                          double const);
+                                                                          double const, int const, int const,
+                                                                          SpatialKernelFitCache<Pixel>*);
+template class SpatialKernelFitCache<Pixel>;
 
 template double subtractPsf(afw::detection::Psf const&, afw::image::MaskedImage<float>*, double, double,
                             double);
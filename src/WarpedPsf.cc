@@ -22,9 +22,13 @@
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
 
+#include "boost/format.hpp"
 #include "lsst/geom/AffineTransform.h"
+#include "lsst/geom/LinearTransform.h"
 #include "lsst/geom/Box.h"
 #include "lsst/pex/exceptions.h"
+#include "lsst/meas/algorithms/Instrumentation.h"
+#include "lsst/meas/algorithms/PsfEvaluationLock.h"
 #include "lsst/meas/algorithms/WarpedPsf.h"
 #include "lsst/afw/math/warpExposure.h"
 #include "lsst/afw/image/Image.h"
@@ -45,18 +49,27 @@ inline double max4(double a, double b, double c, double d) {
 
 // TODO: make this routine externally callable and more generic using templates
 //  (also useful in e.g. math/offsetImage.cc)
-PTR(afw::detection::Psf::Image) zeroPadImage(afw::detection::Psf::Image const &im, int xPad, int yPad) {
+//
+// The padded image is written into a per-thread scratch buffer that is reused whenever the padded
+// dimensions repeat (as they do for every call on a given Psf), so this does not allocate in the
+// steady state.  The returned reference is valid until the next call on the same thread.
+afw::detection::Psf::Image const &zeroPadImage(afw::detection::Psf::Image const &im, int xPad, int yPad) {
+    thread_local std::unique_ptr<afw::detection::Psf::Image> scratch;
+
     int nx = im.getWidth();
     int ny = im.getHeight();
 
-    PTR(afw::detection::Psf::Image)
-    out = std::make_shared<afw::detection::Psf::Image>(nx + 2 * xPad, ny + 2 * yPad);
-    out->setXY0(im.getX0() - xPad, im.getY0() - yPad);
+    geom::Extent2I const dimensions(nx + 2 * xPad, ny + 2 * yPad);
+    if (!scratch || scratch->getDimensions() != dimensions) {
+        scratch.reset(new afw::detection::Psf::Image(dimensions));
+    }
+    scratch->setXY0(im.getX0() - xPad, im.getY0() - yPad);
+    *scratch = 0.0;
 
     geom::Box2I box(geom::Point2I(xPad, yPad), geom::Extent2I(nx, ny));
-    out->assign(im, box, afw::image::LOCAL);
+    scratch->assign(im, box, afw::image::LOCAL);
 
-    return out;
+    return *scratch;
 }
 
 geom::Box2I computeBBoxFromTransform(geom::Box2I const bbox, geom::AffineTransform const &t) {
@@ -99,7 +112,7 @@ geom::Box2I computeBBoxFromTransform(geom::Box2I const bbox, geom::AffineTransfo
 
 /**
  * @brief Alternate interface to afw::math::warpImage()
- * in which the caller does not need to precompute the output bounding box.
+ * in which the destination has already been sized by computeBBoxFromTransform.
  *
  * This version takes an affine transform instead of an arbitrary xy transform.
  *
@@ -107,12 +120,12 @@ geom::Box2I computeBBoxFromTransform(geom::Box2I const bbox, geom::AffineTransfo
  * @param[in] srcToDest  Affine transformation from source pixels to destination pixels in the forward
  *                  direction; the warping code only uses the inverse direction
  * @param[in] wc  Warping parameters
+ * @param[out] dest  Destination image (or view), with bbox computeBBoxFromTransform(im.getBBox(), srcToDest)
  *
  * The input image is assumed zero-padded.
  */
-PTR(afw::detection::Psf::Image)
-warpAffine(afw::detection::Psf::Image const &im, geom::AffineTransform const &srcToDest,
-           afw::math::WarpingControl const &wc) {
+void warpAffine(afw::detection::Psf::Image const &im, geom::AffineTransform const &srcToDest,
+                afw::math::WarpingControl const &wc, afw::detection::Psf::Image &dest) {
     std::shared_ptr<afw::geom::TransformPoint2ToPoint2> srcToDestTransform =
             afw::geom::makeTransform(srcToDest);
 
@@ -121,16 +134,31 @@ warpAffine(afw::detection::Psf::Image const &im, geom::AffineTransform const &sr
     int const xPad = std::max(center.getX(), kernel.getWidth() - center.getX());
     int const yPad = std::max(center.getY(), kernel.getHeight() - center.getY());
 
-    // allocate output image
-    geom::Box2I bbox = computeBBoxFromTransform(im.getBBox(), srcToDest);
-    PTR(afw::detection::Psf::Image) ret = std::make_shared<afw::detection::Psf::Image>(bbox);
-
     // zero-pad input image
-    PTR(afw::detection::Psf::Image) im_padded = zeroPadImage(im, xPad, yPad);
+    afw::detection::Psf::Image const &im_padded = zeroPadImage(im, xPad, yPad);
 
     // warp it!
-    afw::math::warpImage(*ret, *im_padded, *srcToDestTransform, wc, 0.0);
-    return ret;
+    afw::math::warpImage(dest, im_padded, *srcToDestTransform, wc, 0.0);
+}
+
+// FIXME defining a member function Image::getSum() would be convenient here and in other places
+double sumImage(afw::detection::Psf::Image const &image) {
+    double sum = 0.0;
+    for (int y = 0; y != image.getHeight(); ++y) {
+        afw::detection::Psf::Image::x_iterator imEnd = image.row_end(y);
+        for (afw::detection::Psf::Image::x_iterator imPtr = image.row_begin(y); imPtr != imEnd; imPtr++) {
+            sum += *imPtr;
+        }
+    }
+    return sum;
+}
+
+// Normalize an image with the given sum to sum 1 in place.
+void normalizeKernelImage(afw::detection::Psf::Image &image, double normFactor) {
+    if (normFactor == 0.0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "psf image has sum 0");
+    }
+    image /= normFactor;
 }
 
 }  // namespace
@@ -155,6 +183,21 @@ WarpedPsf::WarpedPsf(PTR(afw::detection::Psf const) undistortedPsf,
     _init();
 }
 
+WarpedPsf::WarpedPsf(PTR(afw::detection::Psf const) undistortedPsf,
+                     PTR(afw::geom::TransformPoint2ToPoint2 const) distortion,
+                     CONST_PTR(afw::math::WarpingControl) control, double imageCacheTolerance,
+                     std::size_t imageCacheMaxBytes, CONST_PTR(LanczosStampWarper) stampWarper)
+        : ImagePsf(false),
+          _undistortedPsf(undistortedPsf),
+          _distortion(distortion),
+          _warpingControl(control),
+          _stampWarper(stampWarper) {
+    _init();
+    if (imageCacheTolerance > 0.0) {
+        _imageCache = std::make_shared<PsfImageCache>(imageCacheTolerance, imageCacheMaxBytes);
+    }
+}
+
 void WarpedPsf::_init() {
     if (!_undistortedPsf) {
         throw LSST_EXCEPT(pex::exceptions::LogicError,
@@ -174,7 +217,9 @@ geom::Point2D WarpedPsf::getAveragePosition() const {
 }
 
 PTR(afw::detection::Psf) WarpedPsf::clone() const {
-    return std::make_shared<WarpedPsf>(_undistortedPsf->clone(), _distortion, _warpingControl);
+    return std::make_shared<WarpedPsf>(_undistortedPsf->clone(), _distortion, _warpingControl,
+                                       _imageCache ? _imageCache->getTolerance() : 0.0,
+                                       _imageCache ? _imageCache->getMaxBytes() : 0, _stampWarper);
 }
 
 PTR(afw::detection::Psf) WarpedPsf::resized(int width, int height) const {
@@ -186,35 +231,134 @@ PTR(afw::detection::Psf) WarpedPsf::resized(int width, int height) const {
 
 PTR(afw::detection::Psf::Image)
 WarpedPsf::doComputeKernelImage(geom::Point2D const &position, afw::image::Color const &color) const {
+    LSST_MEAS_ALGORITHMS_TIME("WarpedPsf.doComputeKernelImage");
+    if (_imageCache) {
+        PsfImageCache::Key key = _imageCache->makeKey(position, color);
+        PTR(Image) image = _imageCache->get(key);
+        LSST_MEAS_ALGORITHMS_COUNT(image ? "WarpedPsf.imageCacheHits" : "WarpedPsf.imageCacheMisses", 1);
+        if (!image) {
+            geom::Point2D const cellPosition = _imageCache->getPosition(key);
+            geom::AffineTransform t = afw::geom::linearizeTransform(*_distortion->inverted(), cellPosition);
+            image = _warpKernelImage(t(cellPosition), t.getLinear(), color, *_warpingControl);
+            _imageCache->insert(key, image);
+        }
+        return image;
+    }
+    return warpKernelImage(position, color, *_warpingControl);
+}
+
+PTR(afw::detection::Psf::Image) WarpedPsf::warpKernelImage(
+        geom::Point2D const &position, afw::image::Color const &color,
+        afw::math::WarpingControl const &warpingControl) const {
     geom::AffineTransform t = afw::geom::linearizeTransform(*_distortion->inverted(), position);
-    geom::Point2D tp = t(position);
+    return _warpKernelImage(t(position), t.getLinear(), color, warpingControl);
+}
 
-    PTR(Image) im = _undistortedPsf->computeKernelImage(tp, color);
+std::vector<PTR(afw::detection::Psf::Image)> WarpedPsf::doComputeKernelImages(
+        std::vector<geom::Point2D> const &positions, afw::image::Color const &color) const {
+    if (_imageCache) {
+        // Share the cache with single-position calls.
+        return ImagePsf::doComputeKernelImages(positions, color);
+    }
+    return warpKernelImages(positions, color, *_warpingControl);
+}
 
-    // Go to the warped coordinate system with 'p' at the origin
-    auto srcToDest = geom::AffineTransform(t.inverted().getLinear());
-    PTR(afw::detection::Psf::Psf::Image) ret = warpAffine(*im, srcToDest, *_warpingControl);
+std::vector<PTR(afw::detection::Psf::Image)> WarpedPsf::warpKernelImages(
+        std::vector<geom::Point2D> const &positions, afw::image::Color const &color,
+        afw::math::WarpingControl const &warpingControl) const {
+    LSST_MEAS_ALGORITHMS_TIME("WarpedPsf.doComputeKernelImages");
+    std::vector<PTR(Image)> images;
+    images.reserve(positions.size());
+    if (positions.empty()) {
+        return images;
+    }
+    // Build the inverse once for the whole batch, and map all the positions in one vectorized call.
+    auto inverse = _distortion->inverted();
+    std::vector<geom::Point2D> undistortedPositions = inverse->applyForward(positions);
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        geom::LinearTransform jacobian(inverse->getJacobian(positions[i]));
+        if (!jacobian.getMatrix().allFinite()) {
+            throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                              (boost::format("Transform is not differentiable at %s") % positions[i]).str());
+        }
+        images.push_back(_warpKernelImage(undistortedPositions[i], jacobian, color, warpingControl));
+    }
+    return images;
+}
 
-    double normFactor = 1.0;
-    //
-    // Normalize the output image to sum 1
-    // FIXME defining a member function Image::getSum() would be convenient here and in other places
-    //
-    normFactor = 0.0;
-    for (int y = 0; y != ret->getHeight(); ++y) {
-        afw::detection::Psf::Image::x_iterator imEnd = ret->row_end(y);
-        for (afw::detection::Psf::Image::x_iterator imPtr = ret->row_begin(y); imPtr != imEnd; imPtr++) {
-            normFactor += *imPtr;
+PTR(afw::detection::Psf::Image)
+WarpedPsf::_warpKernelImage(geom::Point2D const &undistortedPosition, geom::LinearTransform const &linear,
+                            afw::image::Color const &color,
+                            afw::math::WarpingControl const &warpingControl, Image *buffer) const {
+    PTR(Image) im;
+    {
+        // The undistorted Psf may be shared (e.g. CoaddPsf.getPsf), and evaluated on other threads
+        PsfEvaluationLock lock(*_undistortedPsf);
+        im = _undistortedPsf->computeKernelImage(undistortedPosition, color, INTERNAL);
+    }
+
+    // Go to the warped coordinate system with 'p' at the origin
+    auto srcToDest = geom::AffineTransform(linear.inverted());
+    geom::Box2I bbox = computeBBoxFromTransform(im->getBBox(), srcToDest);
+
+    PTR(Image) ret;
+    if (buffer) {
+        if (!buffer->getBBox().contains(bbox)) {
+            throw LSST_EXCEPT(pex::exceptions::LengthError,
+                              (boost::format("Buffer with bbox %s does not contain kernel bbox %s") %
+                               buffer->getBBox() % bbox)
+                                      .str());
         }
+        *buffer = 0.0;
+        ret = std::make_shared<Image>(*buffer, bbox);  // a view; no pixels are allocated
+    } else {
+        ret = std::make_shared<Image>(bbox);
     }
-    if (normFactor == 0.0) {
-        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "psf image has sum 0");
+    double normFactor;
+    if (_stampWarper) {
+        // The stamp warper needs no padding, and accumulates the sum as it warps.
+        normFactor = _stampWarper->warp(*im, srcToDest, *ret);
+    } else {
+        // afw::math::warpImage has no per-pixel hook, so the sum takes a pass of its own.
+        warpAffine(*im, srcToDest, warpingControl, *ret);
+        normFactor = sumImage(*ret);
     }
-    *ret /= normFactor;
+
+    // Normalize the output image to sum 1
+    normalizeKernelImage(*ret, normFactor);
     return ret;
 }
 
-geom::Box2I WarpedPsf::doComputeBBox(geom::Point2D const &position, afw::image::Color const &color) const {
+geom::Box2I WarpedPsf::computeKernelImageInto(Image &out, geom::Point2D const &position,
+                                              afw::image::Color const &color) const {
+    if (_imageCache) {
+        // The cached image is shared, so it has to be copied.
+        PTR(Image) image = doComputeKernelImage(position, color);
+        if (!out.getBBox().contains(image->getBBox())) {
+            throw LSST_EXCEPT(pex::exceptions::LengthError,
+                              (boost::format("Buffer with bbox %s does not contain kernel bbox %s") %
+                               out.getBBox() % image->getBBox())
+                                      .str());
+        }
+        out = 0.0;
+        Image(out, image->getBBox()).assign(*image);
+        return image->getBBox();
+    }
+    geom::AffineTransform t = afw::geom::linearizeTransform(*_distortion->inverted(), position);
+    return _warpKernelImage(t(position), t.getLinear(), color, *_warpingControl, &out)->getBBox();
+}
+
+geom::Box2I WarpedPsf::doComputeBBox(geom::Point2D const &requestedPosition,
+                                     afw::image::Color const &color) const {
+    geom::Point2D position = requestedPosition;
+    if (_imageCache) {
+        // Must agree with the bbox of the (possibly cached) image doComputeKernelImage returns.
+        PsfImageCache::Key key = _imageCache->makeKey(requestedPosition, color);
+        if (PTR(Image) cached = _imageCache->find(key)) {
+            return cached->getBBox();
+        }
+        position = _imageCache->getPosition(key);
+    }
     geom::AffineTransform t = afw::geom::linearizeTransform(*_distortion->inverted(), position);
     geom::Point2D tp = t(position);
     geom::Box2I bboxUndistorted = _undistortedPsf->computeBBox(tp, color);
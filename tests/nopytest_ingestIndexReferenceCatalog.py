@@ -24,6 +24,7 @@ import tempfile
 import unittest
 import unittest.mock
 
+import astropy.table
 import numpy as np
 
 import lsst.daf.persistence as dafPersist
@@ -32,6 +33,7 @@ from lsst.meas.algorithms import (IngestIndexedReferenceTask, LoadIndexedReferen
 from lsst.meas.algorithms.htmIndexer import HtmIndexer
 from lsst.meas.algorithms.ingestIndexReferenceTask import addRefCatMetadata
 from lsst.meas.algorithms.ingestIndexManager import IngestIndexManager
+from lsst.meas.algorithms.readFitsCatalogTask import ReadFitsCatalogTask
 from lsst.meas.algorithms.readTextCatalogTask import ReadTextCatalogTask
 import lsst.utils
 
@@ -131,7 +133,52 @@ class TestIngestIndexManager(ingestIndexTestBase.IngestIndexCatalogTestBase,
         catalog.resize(nOld + nNew)  # make space for the elements we will add
         return catalog.copy(deep=True)
 
-    def test_doOnePixelNewData(self):
+    def _spill(self):
+        """Write the fake input to a spill file, returning the pieces for each pixel."""
+        ids = self.worker._getIds(self.fakeInput)
+        return self.worker._writeSpillFile(os.path.join(self.path, "0"), self.fakeInput,
+                                           self.matchedPixels, {}, ids)
+
+    def test_writeSpillFile(self):
+        """Test that the spill file holds each pixel's rows contiguously, in input order."""
+        pieces = self._spill()
+        self.assertEqual(set(pieces), set(self.matchedPixels))
+        rows = np.load(os.path.join(self.path, "0_rows.npy"))
+        for pixelId, (prefix, start, end) in pieces.items():
+            np.testing.assert_equal(rows[start:end]['id'],
+                                    self.fakeInput[self.matchedPixels == pixelId]['id'])
+        self.assertFalse(os.path.exists(os.path.join(self.path, "0_fluxes.npy")))
+
+    def test_spillMaskedFits(self):
+        """Test that rows read from a FITS file with null values go through the spill file."""
+        table = astropy.table.Table(self.fakeInput, masked=True)
+        table['is_var'].mask = [False, True, False, False, True]
+        filename = os.path.join(self.path, "masked.fits")
+        table.write(filename)
+        inputData = ReadFitsCatalogTask().run(filename)
+        self.assertTrue(np.ma.isMaskedArray(inputData))
+
+        ids = self.worker._getIds(inputData)
+        pieces = self.worker._writeSpillFile(os.path.join(self.path, "0"), inputData,
+                                             self.matchedPixels, {}, ids)
+        for pixelId, (prefix, start, end) in pieces.items():
+            rows = self.worker._readSpillFile(prefix, start, end)
+            expected = inputData[self.matchedPixels == pixelId]
+            np.testing.assert_equal(np.ma.getmaskarray(rows), np.ma.getmaskarray(expected))
+            np.testing.assert_equal(rows['id'], expected['id'])
+            np.testing.assert_equal(rows['is_var'].compressed(), expected['is_var'].compressed())
+
+        pixelId = 2
+        catalog = self._createFakeCatalog(nOld=0, nNew=sum(self.matchedPixels == pixelId))
+        self.worker.getCatalog = unittest.mock.Mock(self.worker.getCatalog, return_value=catalog)
+        self.worker._mergeOnePixel(pixelId, [pieces[pixelId]])
+        newcat = lsst.afw.table.SimpleCatalog.readFits(self.filenames[pixelId])
+        newElements = self.fakeInput[self.matchedPixels == pixelId]
+        np.testing.assert_equal(newcat['id'], newElements['id'])
+        self.assertFloatsAlmostEqual(newcat['coord_ra'], newElements['ra_icrs']*np.pi/180)
+        self.assertFloatsAlmostEqual(newcat['coord_dec'], newElements['dec_icrs']*np.pi/180)
+
+    def test_mergeOnePixelNewData(self):
         """Test that we can add new data to an existing catalog."""
         pixelId = 1  # the pixel we are going to test
 
@@ -140,7 +187,7 @@ class TestIngestIndexManager(ingestIndexTestBase.IngestIndexCatalogTestBase,
         catalog = self._createFakeCatalog(nOld=nOld, nNew=nNew)
         self.worker.getCatalog = unittest.mock.Mock(self.worker.getCatalog, return_value=catalog)
 
-        self.worker._doOnePixel(self.fakeInput, self.matchedPixels, pixelId, {})
+        self.worker._mergeOnePixel(pixelId, [self._spill()[pixelId]])
         newcat = lsst.afw.table.SimpleCatalog.readFits(self.filenames[pixelId])
 
         # check that the "pre" catalog is unchanged, exactly
@@ -154,20 +201,21 @@ class TestIngestIndexManager(ingestIndexTestBase.IngestIndexCatalogTestBase,
         self.assertFloatsAlmostEqual(newcat[nOld:]['coord_ra'], newElements['ra_icrs']*np.pi/180)
         self.assertFloatsAlmostEqual(newcat[nOld:]['coord_dec'], newElements['dec_icrs']*np.pi/180)
 
-    def test_doOnePixelNoData(self):
-        """Test that we can put new data into an empty catalog."""
+    def test_mergeOnePixelNoData(self):
+        """Test that we can put new data from several spill files into an empty catalog."""
         pixelId = 2
 
         nOld = 0
-        nNew = sum(self.matchedPixels == pixelId)
+        nNew = 2*sum(self.matchedPixels == pixelId)
         catalog = self._createFakeCatalog(nOld=nOld, nNew=nNew)
         self.worker.getCatalog = unittest.mock.Mock(self.worker.getCatalog, return_value=catalog)
 
-        self.worker._doOnePixel(self.fakeInput, self.matchedPixels, pixelId, {})
+        piece = self._spill()[pixelId]
+        self.worker._mergeOnePixel(pixelId, [piece, piece])
         newcat = lsst.afw.table.SimpleCatalog.readFits(self.filenames[pixelId])
 
         # check that the new catalog elements are set correctly
-        newElements = self.fakeInput[self.matchedPixels == pixelId]
+        newElements = np.concatenate([self.fakeInput[self.matchedPixels == pixelId]]*2)
         np.testing.assert_equal(newcat['id'], newElements['id'])
         self.assertFloatsAlmostEqual(newcat['coord_ra'], newElements['ra_icrs']*np.pi/180)
         self.assertFloatsAlmostEqual(newcat['coord_dec'], newElements['dec_icrs']*np.pi/180)
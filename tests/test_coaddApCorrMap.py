@@ -30,6 +30,7 @@ import lsst.afw.math as afwMath
 import lsst.afw.table as afwTable
 import lsst.afw.image as afwImage
 import lsst.meas.algorithms as measAlg
+import lsst.pex.exceptions
 import lsst.utils.tests
 
 try:
@@ -129,6 +130,75 @@ class CoaddApCorrMapTest(lsst.utils.tests.TestCase):
             actual = apCorrMap["only"].evaluate(point)
             self.assertEqual(actual, expected)
 
+    def testMultipleFields(self):
+        """Check that the fields of a coadd ApCorrMap agree with individual CoaddBoundedFields."""
+        coaddBox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(100, 100))
+        cdMatrix = afwGeom.makeCdMatrix(scale=5.0e-5*lsst.geom.degrees)
+        crval = lsst.geom.SpherePoint(0.0, 0.0, lsst.geom.degrees)
+        coaddWcs = afwGeom.makeSkyWcs(crpix=lsst.geom.Point2D(0, 0), crval=crval, cdMatrix=cdMatrix)
+        schema = afwTable.ExposureTable.makeMinimalSchema()
+        weightKey = schema.addField("weight", type="D", doc="Coadd weight")
+        catalog = afwTable.ExposureCatalog(schema)
+        inputBox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(60, 60))
+        names = ["a", "b", "c"]
+        rng = np.random.RandomState(5)
+        elements = {name: [] for name in names}
+        for i in range(6):
+            wcs = afwGeom.makeSkyWcs(crpix=lsst.geom.Point2D(-8.0*i, -5.0*i), crval=crval, cdMatrix=cdMatrix)
+            validPolygon = afwGeom.Polygon(lsst.geom.Box2D(lsst.geom.Point2D(0, 0),
+                                                           lsst.geom.Extent2D(55 - i, 50 + i)))
+            apCorrMap = afwImage.ApCorrMap()
+            for name in names[:1 + i % 3]:  # not every input has every field
+                bf = afwMath.ChebyshevBoundedField(inputBox, rng.uniform(0.5, 1.5, (2, 2)))
+                apCorrMap.set(name, bf)
+                elements[name].append(measAlg.CoaddBoundedField.Element(bf, wcs, validPolygon, i + 1.0))
+            record = catalog.addNew()
+            record.setWcs(wcs)
+            record.setBBox(inputBox)
+            record.setApCorrMap(apCorrMap)
+            record.setValidPolygon(validPolygon)
+            record.set(weightKey, i + 1.0)
+            record['id'] = i
+
+        coaddApCorrMap = measAlg.makeCoaddApCorrMap(catalog, coaddBox, coaddWcs)
+        self.assertEqual(sorted(name for name, _ in coaddApCorrMap.items()), names)
+        fieldSet = coaddApCorrMap["a"].getSet()
+        self.assertEqual(fieldSet.getNames(), names)
+        self.assertEqual(fieldSet.getElementCount(), len(catalog))
+        expected = {name: measAlg.CoaddBoundedField(coaddBox, coaddWcs, elements[name], np.nan)
+                    for name in names}
+
+        x = rng.uniform(0, 100, 200)
+        y = rng.uniform(0, 100, 200)
+        for name in names:
+            self.assertEqual(coaddApCorrMap[name].getName(), name)
+            want = expected[name].evaluate(x, y)
+            valid = np.isfinite(want)
+            self.assertGreater(valid.sum(), 0)
+            self.assertFloatsAlmostEqual(coaddApCorrMap[name].evaluate(x[valid], y[valid]), want[valid],
+                                         rtol=1e-14)
+            point = lsst.geom.Point2D(x[valid][0], y[valid][0])
+            self.assertFloatsAlmostEqual(coaddApCorrMap[name].evaluate(point), want[valid][0], rtol=1e-14)
+        valid = np.all([np.isfinite(expected[name].evaluate(x, y)) for name in names], axis=0)
+        values = fieldSet.evaluate(x[valid], y[valid])
+        self.assertEqual(values.shape, (len(names), valid.sum()))
+        for i, name in enumerate(names):
+            self.assertFloatsAlmostEqual(values[i], expected[name].evaluate(x[valid], y[valid]), rtol=1e-14)
+        with self.assertRaises(lsst.pex.exceptions.DomainError):
+            coaddApCorrMap["c"].evaluate(lsst.geom.Point2D(-50, -50))
+
+        with lsst.utils.tests.getTempFilePath(".fits") as filename:
+            exposure = afwImage.ExposureF(1, 1)
+            exposure.getInfo().setApCorrMap(coaddApCorrMap)
+            exposure.writeFits(filename)
+            readApCorrMap = afwImage.ExposureF(filename).getInfo().getApCorrMap()
+        for name in names:
+            # Written in the same format as before there were sets
+            self.assertIsInstance(readApCorrMap[name], measAlg.CoaddBoundedField)
+            self.assertEqual(len(readApCorrMap[name].getElements()), len(elements[name]))
+            self.assertFloatsAlmostEqual(readApCorrMap[name].evaluate(x[valid], y[valid]),
+                                         coaddApCorrMap[name].evaluate(x[valid], y[valid]), rtol=1e-14)
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
@@ -136,6 +136,62 @@ class CoaddBoundedFieldTestCase(lsst.utils.tests.TestCase):
             self.assertNotEqual(elements[0], elements[1])
             runTest(elements, validBoxes)
 
+    def testBatchEvaluate(self):
+        """Test that the array evaluate, fillImage and addToImage agree with evaluating one point at a
+        time.
+        """
+        for validBox in self.possibleValidBoxes:
+            elements, validBoxes = self.constructElements(validBox)
+            field = lsst.meas.algorithms.CoaddBoundedField(self.bbox, self.coaddWcs, elements, -1.0)
+            x = np.random.uniform(low=-100, high=100, size=200)
+            y = np.random.uniform(low=-100, high=100, size=200)
+            expected = np.array([field.evaluate(lsst.geom.Point2D(xi, yi)) for xi, yi in zip(x, y)])
+            self.assertFloatsAlmostEqual(field.evaluate(x, y), expected, rtol=1E-13)
+
+            image = lsst.afw.image.ImageD(self.bbox)
+            field.fillImage(image)
+            yy, xx = np.mgrid[self.bbox.getBeginY():self.bbox.getEndY(),
+                              self.bbox.getBeginX():self.bbox.getEndX()]
+            expected = field.evaluate(xx.ravel().astype(float), yy.ravel().astype(float))
+            self.assertFloatsAlmostEqual(image.getArray(), expected.reshape(image.getArray().shape),
+                                         rtol=1E-13)
+            self.assertFloatsAlmostEqual(image[0, 0, lsst.afw.image.LOCAL],
+                                         field.evaluate(self.bbox.getMinX(), self.bbox.getMinY()),
+                                         rtol=1E-13)
+            field.addToImage(image, -0.5)
+            self.assertFloatsAlmostEqual(image.getArray(), 0.5*expected.reshape(image.getArray().shape),
+                                         rtol=1E-13)
+
+            # Without a default, points not covered by any element raise.
+            strict = lsst.meas.algorithms.CoaddBoundedField(self.bbox, self.coaddWcs, elements)
+            with self.assertRaises(lsst.pex.exceptions.DomainError):
+                strict.evaluate(np.array([0.0, 1.0E4]), np.array([0.0, 1.0E4]))
+
+    def testApproximated(self):
+        """Test that evaluating through approximate pixel mappings agrees with exact evaluation."""
+        for validBox in self.possibleValidBoxes:
+            elements, validBoxes = self.constructElements(validBox)
+            field = lsst.meas.algorithms.CoaddBoundedField(self.bbox, self.coaddWcs, elements, 0.0)
+            self.assertEqual(field.getApproximationMaxError(), 0.0)
+            self.assertEqual(field.getApproximatedElementCount(), 0)
+            approx = field.approximated(1E-3)
+            self.assertEqual(approx.getApproximationMaxError(), 1E-3)
+            self.assertEqual(approx.getApproximatedElementCount(), len(elements))
+            self.assertEqual(approx, field)
+
+            exact = lsst.afw.image.ImageD(self.bbox)
+            field.fillImage(exact)
+            image = lsst.afw.image.ImageD(self.bbox)
+            approx.fillImage(image)
+            # Pixels within maxError of an element boundary may differ; everything else agrees closely.
+            diff = np.abs(image.getArray() - exact.getArray())
+            self.assertLess((diff > 1E-4*np.abs(exact.getArray()).max()).sum(), 0.01*self.bbox.getArea())
+            self.assertFloatsAlmostEqual(approx.evaluate(lsst.geom.Point2D(3.0, -4.0)),
+                                         field.evaluate(lsst.geom.Point2D(3.0, -4.0)), rtol=1E-4)
+
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            field.approximated(0.0)
+
     def testEquality(self):
         def runTest(elements, validBoxes):
             field1 = lsst.meas.algorithms.CoaddBoundedField(self.bbox, self.coaddWcs, elements, 0.0)
@@ -20,8 +20,12 @@
 # the GNU General Public License along with this program.  If not,
 # see <https://www.lsstcorp.org/LegalNotices/>.
 #
+import concurrent.futures
+import time
 import unittest
 
+import numpy as np
+
 import lsst.geom
 import lsst.afw.geom as afwGeom
 import lsst.afw.math as afwMath
@@ -459,6 +463,307 @@ class CoaddPsfTest(lsst.utils.tests.TestCase):
         with self.assertRaises(pexExceptions.LogicError):
             mypsf.resized(100, 100)
 
+    def testInputIndex(self):
+        """Check that the spatial index finds exactly the inputs subsetContaining would."""
+        for i in range(1, 10):
+            record = self.mycatalog.getTable().makeRecord()
+            record.setPsf(measAlg.DoubleGaussianPsf(21, 21, 2.0, 1.00, 0.0))
+            crpix = lsst.geom.PointD(1000 - 250.0*(i % 3), 1000.0 - 250.0*(i // 3))
+            record.setWcs(afwGeom.makeSkyWcs(crpix=crpix, crval=self.crval, cdMatrix=self.cdMatrix))
+            record['weight'] = 1.0
+            record['id'] = i
+            record.setBBox(lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(400, 400)))
+            validPolygon = afwGeom.Polygon(lsst.geom.Box2D(lsst.geom.Point2D(0, 0),
+                                                           lsst.geom.Extent2D(300, 300)))
+            record.setValidPolygon(validPolygon)
+            self.mycatalog.append(record)
+
+        mypsf = measAlg.CoaddPsf(self.mycatalog, self.wcsref, 'weight')
+        index = mypsf.getInputIndex()
+        self.assertEqual(index.getInputCount(), len(self.mycatalog))
+        self.assertGreater(index.getCellCount(), 0)
+        self.assertGreaterEqual(index.getEntryCount(), len(self.mycatalog))
+        self.assertGreater(index.getMemorySize(), 0)
+        self.assertGreaterEqual(index.getBuildTime(), 0.0)
+
+        for x in range(0, 1000, 37):
+            for y in range(0, 1000, 41):
+                point = lsst.geom.Point2D(x, y)
+                expected = [record.getId() for record in
+                            self.mycatalog.subsetContaining(point, self.wcsref, True)]
+                candidates = index.getCandidates(point)
+                self.assertEqual(candidates, sorted(candidates))
+                found = [self.mycatalog[i].getId() for i in candidates
+                         if self.mycatalog[i].contains(point, self.wcsref, True)]
+                self.assertEqual(found, expected)
+
+    def testLazyReading(self):
+        """Check that a CoaddPsf read lazily only reads the inputs it needs, and gives the same results."""
+        for i in range(1, 10):
+            record = self.mycatalog.getTable().makeRecord()
+            record.setPsf(measAlg.DoubleGaussianPsf(21, 21, 1.0 + 0.1*i, 3.00, 0.1))
+            crpix = lsst.geom.PointD(1000 - 250.0*(i % 3), 1000.0 - 250.0*(i // 3))
+            record.setWcs(afwGeom.makeSkyWcs(crpix=crpix, crval=self.crval, cdMatrix=self.cdMatrix))
+            record['weight'] = 1.0*i
+            record['id'] = i
+            record.setBBox(lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(300, 300)))
+            self.mycatalog.append(record)
+        original = measAlg.CoaddPsf(self.mycatalog, self.wcsref, 'weight')
+        point = lsst.geom.Point2D(260, 520)  # only inputs 3, 4, 6 and 7 contain this point
+
+        with lsst.utils.tests.getTempFilePath(".fits") as filename:
+            original.writeFits(filename)
+            self.assertFalse(measAlg.CoaddPsf.getLazyReading())
+            eager = measAlg.CoaddPsf.readFits(filename)
+            with measAlg.CoaddPsf.LazyReading():
+                self.assertTrue(measAlg.CoaddPsf.getLazyReading())
+                lazy = measAlg.CoaddPsf.readFits(filename)
+                # Only reads on the thread that entered LazyReading are lazy
+                with concurrent.futures.ThreadPoolExecutor(1) as executor:
+                    other = executor.submit(measAlg.CoaddPsf.readFits, filename).result()
+            self.assertFalse(measAlg.CoaddPsf.getLazyReading())
+        self.assertEqual(eager.getLoadedComponentCount(), len(self.mycatalog))
+        self.assertEqual(other.getLoadedComponentCount(), len(self.mycatalog))
+        self.assertEqual(lazy.getComponentCount(), len(self.mycatalog))
+        self.assertEqual(lazy.getLoadedComponentCount(), 0)
+
+        self.assertFloatsEqual(lazy.computeKernelImage(point).getArray(),
+                               eager.computeKernelImage(point).getArray())
+        self.assertGreater(lazy.getLoadedComponentCount(), 0)
+        self.assertLess(lazy.getLoadedComponentCount(), len(self.mycatalog))
+        self.assertEqual(lazy.getId(8), 9)
+        self.assertEqual(lazy.getBBox(8), self.mycatalog[8].getBBox())
+        self.assertEqual(lazy.getWeight(8), 9.0)
+
+        # Writing a lazily-read CoaddPsf must still save all of its inputs.
+        with lsst.utils.tests.getTempFilePath(".fits") as filename:
+            lazy.writeFits(filename)
+            reread = measAlg.CoaddPsf.readFits(filename)
+        self.assertEqual(reread.getComponentCount(), len(self.mycatalog))
+        for i in range(len(self.mycatalog)):
+            self.assertEqual(reread.getPsf(i).computeShape().getDeterminantRadius(),
+                             self.mycatalog[i].getPsf().computeShape().getDeterminantRadius())
+        self.assertFloatsEqual(reread.computeKernelImage(point).getArray(),
+                               eager.computeKernelImage(point).getArray())
+
+    def testRepeatedEvaluation(self):
+        """Check that cached per-input WarpedPsfs give the same results as fresh ones."""
+        for i in range(1, 5):
+            record = self.mycatalog.getTable().makeRecord()
+            record.setPsf(measAlg.DoubleGaussianPsf(21, 21, 1.0 + 0.5*i, 3.00, 0.1))
+            crpix = lsst.geom.PointD(1000 - 5.0*i, 1000.0 + 7.0*i)
+            record.setWcs(afwGeom.makeSkyWcs(crpix=crpix, crval=self.crval, cdMatrix=self.cdMatrix))
+            record['weight'] = 1.0*i
+            record['id'] = i
+            record.setBBox(lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(2000, 2000)))
+            self.mycatalog.append(record)
+
+        mypsf = measAlg.CoaddPsf(self.mycatalog, self.wcsref, 'weight')
+        points = [lsst.geom.Point2D(1000, 1000), lsst.geom.Point2D(500, 1500), lsst.geom.Point2D(1200, 300)]
+        first = [mypsf.computeKernelImage(point).getArray().copy() for point in points]
+        for point, expected in zip(reversed(points), reversed(first)):
+            # A fresh CoaddPsf builds its WarpedPsfs from scratch.
+            fresh = measAlg.CoaddPsf(self.mycatalog, self.wcsref, 'weight')
+            self.assertFloatsEqual(mypsf.computeKernelImage(point).getArray(), expected)
+            self.assertFloatsEqual(mypsf.clone().computeKernelImage(point).getArray(), expected)
+            self.assertFloatsEqual(fresh.computeKernelImage(point).getArray(), expected)
+            self.assertEqual(mypsf.computeBBox(point), fresh.computeBBox(point))
+
+    def testBatchEvaluation(self):
+        """Check that computeKernelImages matches computeKernelImage at each position.
+
+        The batch transforms all the positions at once, so it may differ in the last bits.
+        """
+        for i in range(1, 6):
+            record = self.mycatalog.getTable().makeRecord()
+            record.setPsf(measAlg.DoubleGaussianPsf(21, 21, 1.0 + 0.3*i, 3.00, 0.1))
+            crpix = lsst.geom.PointD(1000 - 300.0*i, 1000.0 - 200.0*i)
+            record.setWcs(afwGeom.makeSkyWcs(crpix=crpix, crval=self.crval, cdMatrix=self.cdMatrix))
+            record['weight'] = 1.0*i
+            record['id'] = i
+            record.setBBox(lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(2000, 2000)))
+            self.mycatalog.append(record)
+
+        mypsf = measAlg.CoaddPsf(self.mycatalog, self.wcsref, 'weight')
+        points = [lsst.geom.Point2D(x, y) for x in range(100, 1000, 150) for y in range(50, 600, 110)]
+        images = mypsf.computeKernelImages(points)
+        self.assertEqual(len(images), len(points))
+        for point, image in zip(points, images):
+            expected = mypsf.computeKernelImage(point)
+            self.assertEqual(image.getBBox(), expected.getBBox())
+            self.assertFloatsAlmostEqual(image.getArray(), expected.getArray(), rtol=1e-10, atol=1e-14)
+
+        stack = np.zeros((len(points), 21, 21), dtype=float)
+        mypsf.computeKernelImages(points, stack)
+        for point, image, stamp in zip(points, images, stack):
+            bbox = lsst.geom.Box2I(lsst.geom.Point2I(-10, -10), lsst.geom.Extent2I(21, 21))
+            bbox.clip(image.getBBox())
+            expected = image.Factory(image, bbox).getArray()
+            self.assertFloatsEqual(stamp[bbox.getMinY() + 10:bbox.getMaxY() + 11,
+                                         bbox.getMinX() + 10:bbox.getMaxX() + 11], expected)
+
+    def testThreadedWarping(self):
+        """Check that warping inputs on several threads gives bit-identical results."""
+        for i in range(1, 8):
+            record = self.mycatalog.getTable().makeRecord()
+            record.setPsf(measAlg.DoubleGaussianPsf(21, 21, 1.0 + 0.2*i, 3.00, 0.1))
+            crpix = lsst.geom.PointD(1000 - 11.0*i, 1000.0 + 3.0*i)
+            cdMatrix = afwGeom.makeCdMatrix(scale=5.55555555e-05*lsst.geom.degrees,
+                                            orientation=(5.0*i)*lsst.geom.degrees, flipX=True)
+            record.setWcs(afwGeom.makeSkyWcs(crpix=crpix, crval=self.crval, cdMatrix=cdMatrix))
+            record['weight'] = 1.0*i
+            record['id'] = i
+            record.setBBox(lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(2000, 2000)))
+            self.mycatalog.append(record)
+
+        serial = measAlg.CoaddPsf(self.mycatalog, self.wcsref, measAlg.CoaddPsfControl(nThreads=1))
+        for nThreads in (2, 3, 16):
+            threaded = measAlg.CoaddPsf(self.mycatalog, self.wcsref,
+                                        measAlg.CoaddPsfControl(nThreads=nThreads))
+            for point in [lsst.geom.Point2D(1000, 1000), lsst.geom.Point2D(400, 1700)]:
+                expected = serial.computeKernelImage(point)
+                image = threaded.computeKernelImage(point)
+                self.assertEqual(image.getBBox(), expected.getBBox())
+                self.assertFloatsEqual(image.getArray(), expected.getArray())
+
+    def testPythonThreads(self):
+        """Check that Python threads can evaluate one CoaddPsf, and do so concurrently."""
+        for i in range(1, 8):
+            record = self.mycatalog.getTable().makeRecord()
+            record.setPsf(measAlg.DoubleGaussianPsf(41, 41, 1.0 + 0.2*i, 3.00, 0.1))
+            crpix = lsst.geom.PointD(1000 - 11.0*i, 1000.0 + 3.0*i)
+            cdMatrix = afwGeom.makeCdMatrix(scale=5.55555555e-05*lsst.geom.degrees,
+                                            orientation=(5.0*i)*lsst.geom.degrees, flipX=True)
+            record.setWcs(afwGeom.makeSkyWcs(crpix=crpix, crval=self.crval, cdMatrix=cdMatrix))
+            record['weight'] = 1.0*i
+            record['id'] = i
+            record.setBBox(lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(2000, 2000)))
+            self.mycatalog.append(record)
+        coaddPsf = measAlg.CoaddPsf(self.mycatalog, self.wcsref, 'weight')
+        nThreads = 4
+        rng = np.random.RandomState(3)
+        points = [[lsst.geom.Point2D(x, y) for x, y in rng.uniform(300, 1700, (16, 2))]
+                  for _ in range(nThreads)]
+        # Use different positions for the threaded run, so nothing is reused from the Psf's caches
+        shiftedPoints = [[point + lsst.geom.Extent2D(0.25, 0.25) for point in somePoints]
+                         for somePoints in points]
+
+        def evaluate(psf, somePoints):
+            return [psf.computeKernelImage(point).getArray() for point in somePoints]
+
+        for somePoints in points:
+            evaluate(coaddPsf, somePoints)
+        with concurrent.futures.ThreadPoolExecutor(nThreads) as executor:
+            results = list(executor.map(lambda somePoints: evaluate(coaddPsf, somePoints), shiftedPoints))
+
+        fresh = measAlg.CoaddPsf(self.mycatalog, self.wcsref, 'weight')
+        for arrays, somePoints in zip(results, shiftedPoints):
+            for array, expected in zip(arrays, evaluate(fresh, somePoints)):
+                self.assertFloatsEqual(array, expected)
+        # Bounding boxes are computed with the GIL released
+        with concurrent.futures.ThreadPoolExecutor(nThreads) as executor:
+            bboxes = list(executor.map(lambda somePoints: [coaddPsf.computeBBox(p) for p in somePoints],
+                                       shiftedPoints))
+        for someBBoxes, somePoints in zip(bboxes, shiftedPoints):
+            self.assertEqual(someBBoxes, [fresh.computeBBox(point) for point in somePoints])
+
+        # Kernel images are computed with the GIL released too: while one thread evaluates a long batch,
+        # this thread keeps running Python.  Were the GIL held, there'd be a gap as long as the batch.
+        manyPoints = [lsst.geom.Point2D(x, y) for x, y in rng.uniform(300, 1700, (256, 2))]
+
+        def timeEvaluation():
+            start = time.perf_counter()
+            fresh.computeKernelImages(manyPoints)
+            return time.perf_counter() - start
+
+        with concurrent.futures.ThreadPoolExecutor(1) as executor:
+            future = executor.submit(timeEvaluation)
+            ticks = [time.perf_counter()]
+            while not future.done():
+                ticks.append(time.perf_counter())
+            duration = future.result()
+        self.assertLess(max(np.diff(ticks)), 0.5*duration)
+
+    def testImageCache(self):
+        """Check the position-quantized kernel image cache."""
+        for i in range(1, 4):
+            record = self.mycatalog.getTable().makeRecord()
+            record.setPsf(measAlg.DoubleGaussianPsf(21, 21, 1.0 + 0.5*i, 3.00, 0.1))
+            crpix = lsst.geom.PointD(1000 - 5.0*i, 1000.0 + 7.0*i)
+            record.setWcs(afwGeom.makeSkyWcs(crpix=crpix, crval=self.crval, cdMatrix=self.cdMatrix))
+            record['weight'] = 1.0*i
+            record['id'] = i
+            record.setBBox(lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(2000, 2000)))
+            self.mycatalog.append(record)
+
+        uncached = measAlg.CoaddPsf(self.mycatalog, self.wcsref, 'weight')
+        self.assertIsNone(uncached.getImageCache())
+        ctrl = measAlg.CoaddPsfControl(imageCacheTolerance=2.0, imageCacheSizeMB=1)
+        cached = measAlg.CoaddPsf(self.mycatalog, self.wcsref, ctrl)
+        cache = cached.getImageCache()
+        self.assertEqual(cache.getTolerance(), 2.0)
+
+        # Positions in the same cell share an image computed at the cell center.
+        image1 = cached.computeKernelImage(lsst.geom.Point2D(1000.3, 999.8))
+        image2 = cached.computeKernelImage(lsst.geom.Point2D(999.4, 1000.6))
+        self.assertFloatsEqual(image1.getArray(), image2.getArray())
+        self.assertFloatsEqual(image1.getArray(),
+                               uncached.computeKernelImage(lsst.geom.Point2D(1000, 1000)).getArray())
+        self.assertEqual(cached.computeBBox(lsst.geom.Point2D(1000.3, 999.8)), image1.getBBox())
+        self.assertEqual(cache.getSize(), 1)
+        self.assertEqual(cache.getMisses(), 1)
+        self.assertGreaterEqual(cache.getHits(), 1)
+
+        # The memory budget is respected.
+        for x in range(0, 2000, 10):
+            cached.computeKernelImage(lsst.geom.Point2D(x, 500))
+        self.assertLessEqual(cache.getMemoryUsage(), cache.getMaxBytes())
+        self.assertGreater(cache.getSize(), 0)
+
+        # The cache is an option of this process, and is not persisted.
+        with lsst.utils.tests.getTempFilePath(".fits") as filename:
+            cached.writeFits(filename)
+            reread = measAlg.CoaddPsf.readFits(filename)
+        self.assertIsNone(reread.getImageCache())
+        self.assertEqual(reread.getControl().warpingKernelName, ctrl.warpingKernelName)
+
+        # ...but can be restored with withControl.
+        restored = reread.withControl(cached.getControl())
+        self.assertIsNone(reread.getImageCache())
+        self.assertEqual(restored.getImageCache().getTolerance(), 2.0)
+        self.assertEqual(restored.getImageCache().getMaxBytes(), cache.getMaxBytes())
+        self.assertEqual(restored.getComponentCount(), cached.getComponentCount())
+        self.assertFloatsEqual(restored.computeKernelImage(lsst.geom.Point2D(1000.3, 999.8)).getArray(),
+                               image1.getArray())
+
+    def testStampWarper(self):
+        """Check that the small-stamp warper agrees with afw.math.warpImage."""
+        for i in range(1, 4):
+            record = self.mycatalog.getTable().makeRecord()
+            record.setPsf(measAlg.DoubleGaussianPsf(31, 31, 1.0 + 0.5*i, 3.00, 0.1))
+            cdMatrix = afwGeom.makeCdMatrix(scale=(0.2 + 0.01*i)*lsst.geom.arcseconds,
+                                            orientation=(10.0*i)*lsst.geom.degrees)
+            record.setWcs(afwGeom.makeSkyWcs(crpix=self.crpix, crval=self.crval, cdMatrix=cdMatrix))
+            record['weight'] = 1.0*i
+            record['id'] = i
+            record.setBBox(lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(2000, 2000)))
+            self.mycatalog.append(record)
+
+        default = measAlg.CoaddPsf(self.mycatalog, self.wcsref, 'weight')
+        ctrl = measAlg.CoaddPsfControl(useStampWarper=True)
+        stamp = measAlg.CoaddPsf(self.mycatalog, self.wcsref, ctrl)
+        for position in (lsst.geom.Point2D(1000, 1000), lsst.geom.Point2D(1010.3, 990.7)):
+            expected = default.computeKernelImage(position)
+            image = stamp.computeKernelImage(position)
+            self.assertEqual(image.getBBox(), expected.getBBox())
+            self.assertAlmostEqual(image.getArray().sum(), 1.0)
+            self.assertFloatsAlmostEqual(image.getArray(), expected.getArray(),
+                                         atol=1E-4*expected.getArray().max())
+
+        with self.assertRaises(pexExceptions.InvalidParameterError):
+            measAlg.CoaddPsf(self.mycatalog, self.wcsref,
+                             measAlg.CoaddPsfControl("bilinear", useStampWarper=True))
+
     def testLargeTransform(self):
         """Test that images with bad astrometry are identified"""
         multiplier = 1000.0  # CD matrix multiplier for bad input
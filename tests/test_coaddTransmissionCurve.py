@@ -29,7 +29,7 @@ from lsst.geom import Point2D, Extent2D, Point2I, Box2D, Box2I, SpherePoint, deg
 from lsst.afw.geom import makeSkyWcs, makeCdMatrix, Polygon
 from lsst.afw.image import TransmissionCurve
 from lsst.afw.table import ExposureTable, ExposureCatalog
-from lsst.meas.algorithms import makeCoaddTransmissionCurve
+from lsst.meas.algorithms import makeCoaddTransmissionCurve, sampleTransmissionCurveAt
 from lsst.meas.algorithms.testUtils import makeRandomTransmissionCurve
 
 
@@ -163,6 +163,27 @@ class CoaddBoundedFieldTestCase(lsst.utils.tests.TestCase):
         throughputD2 = self.curveA.sampleAt(pointDA, wavelengths)
         self.assertFloatsAlmostEqual(throughputD1, throughputD2)
 
+    def testSampleAtBatch(self):
+        """Test that sampling many positions at once agrees with sampling them one at a time."""
+        wavelengths = np.linspace(4000, 7000, 200)
+        # Points covered by at least one input (regions A-D; see setUp).
+        points = [self.makeRandomPoint(Point2I(-100, 0), Point2I(99, 99)) for i in range(20)]
+        points += [self.makeRandomPoint(Point2I(0, -100), Point2I(99, -1)) for i in range(20)]
+        throughputs = sampleTransmissionCurveAt(self.curveCoadd, points, wavelengths)
+        self.assertEqual(throughputs.shape, (len(points), len(wavelengths)))
+        for point, throughput in zip(points, throughputs):
+            self.assertFloatsEqual(throughput, self.curveCoadd.sampleAt(point, wavelengths))
+
+        # Points with no inputs raise, as in sampleAt.
+        point0 = self.makeRandomPoint(Point2I(-100, -100), Point2I(-1, -1))
+        with self.assertRaises(InvalidParameterError):
+            sampleTransmissionCurveAt(self.curveCoadd, points + [point0], wavelengths)
+
+        # Other TransmissionCurves are sampled one position at a time.
+        throughputs = sampleTransmissionCurveAt(self.curveA, points[:3], wavelengths)
+        for point, throughput in zip(points[:3], throughputs):
+            self.assertFloatsEqual(throughput, self.curveA.sampleAt(point, wavelengths))
+
     def testPersistence(self):
         wavelengths = np.linspace(4000, 7000, 200)
         with lsst.utils.tests.getTempFilePath(".fits") as filename:
@@ -19,17 +19,23 @@
 # You should have received a copy of the GNU General Public License
 # along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
+import concurrent.futures
 import math
 import os
 import sys
 import unittest
 
+import numpy as np
+
+import lsst.daf.base as dafBase
 import lsst.geom
+import lsst.afw.geom as afwGeom
 import lsst.afw.image as afwImage
 import lsst.afw.math as afwMath
 import lsst.log.utils as logUtils
 import lsst.meas.algorithms as algorithms
 import lsst.pex.config as pexConfig
+import lsst.pex.exceptions
 import lsst.utils
 import lsst.utils.tests
 
@@ -184,6 +190,151 @@ class CosmicRayNullTestCase(unittest.TestCase):
         self.assertEqual(len(crs), 0, "Found %d CRs in empty image" % len(crs))
 
 
+class CosmicRayThreadingTestCase(lsst.utils.tests.TestCase):
+    """Test that searching in parallel strips matches the serial search."""
+
+    def setUp(self):
+        self.FWHM = 5                   # pixels
+        self.psf = algorithms.DoubleGaussianPsf(29, 29, self.FWHM/(2*math.sqrt(2*math.log(2))))
+        self.background = 100.0
+
+        rng = np.random.RandomState(12345)
+        width, height = 300, 400
+        self.mi = afwImage.MaskedImageF(width, height)
+        self.mi.image.array[:] = rng.normal(self.background, 3.0, (height, width))
+        self.mi.variance.array[:] = 9.0
+        # Tracks of hot pixels, including some crossing the boundaries between strips
+        for i in range(40):
+            x0, y0 = rng.randint(5, width - 5), rng.randint(5, height - 5)
+            dx, dy = rng.choice([-1, 0, 1]), rng.choice([-1, 0, 1])
+            for k in range(rng.randint(1, 8)):
+                x, y = x0 + k*dx, y0 + k*dy
+                if 1 < x < width - 1 and 1 < y < height - 1:
+                    self.mi.image.array[y, x] += rng.uniform(200, 2000)
+        for y in (101, 200, 300):
+            self.mi.image.array[y - 2:y + 2, 150] += 1000.0
+
+    def tearDown(self):
+        del self.mi
+        del self.psf
+
+    def testThreadsMatchSerial(self):
+        crConfig = algorithms.FindCosmicRaysConfig()
+        serial = self.mi.clone()
+        crs = algorithms.findCosmicRays(serial, self.psf, self.background,
+                                        pexConfig.makePropertySet(crConfig))
+        self.assertGreater(len(crs), 0)
+        for nThreads in (2, 3, 4):
+            crConfig.nThreads = nThreads
+            threaded = self.mi.clone()
+            threadedCrs = algorithms.findCosmicRays(threaded, self.psf, self.background,
+                                                    pexConfig.makePropertySet(crConfig))
+            self.assertEqual([cr.spans for cr in threadedCrs], [cr.spans for cr in crs])
+            self.assertMaskedImagesEqual(threaded, serial)
+
+    def testDetectionContext(self):
+        """Test that findCosmicRays gives the same results with a reusable context."""
+        crConfig = algorithms.FindCosmicRaysConfig()
+        ps = pexConfig.makePropertySet(crConfig)
+        expected = self.mi.clone()
+        expectedCrs = algorithms.findCosmicRays(expected, self.psf, self.background, ps)
+
+        context = algorithms.CrDetectionContext(self.psf, self.mi.mask, ps)
+        self.assertEqual(context.getNCrPixelMax(), crConfig.nCrPixelMax)
+        for i in range(2):
+            cleaned = self.mi.clone()
+            crs = algorithms.findCosmicRays(cleaned, context, self.background)
+            self.assertEqual([cr.spans for cr in crs], [cr.spans for cr in expectedCrs])
+            self.assertMaskedImagesEqual(cleaned, expected)
+
+        # The PSF doesn't vary, so a grid of thresholds agrees with a single realisation
+        grid = algorithms.CrDetectionContext(self.psf, self.mi.mask, ps, self.mi.getBBox(), 3, 4)
+        self.assertEqual(len(grid.getGridThresholds()), 12)
+        single = context.getThresholds(0.0, 0.0)
+        for x, y in [(0, 0), (150.5, 20.0), (299, 399), (-50, 1000)]:
+            thresholds = grid.getThresholds(x, y)
+            self.assertAlmostEqual(thresholds.horizontal, single.horizontal)
+            self.assertAlmostEqual(thresholds.vertical, single.vertical)
+            self.assertAlmostEqual(thresholds.diagonal, single.diagonal)
+        cleaned = self.mi.clone()
+        crs = algorithms.findCosmicRays(cleaned, grid, self.background)
+        self.assertEqual([cr.spans for cr in crs], [cr.spans for cr in expectedCrs])
+
+        with self.assertRaises(TypeError):
+            algorithms.findCosmicRays(self.mi.clone(), context, self.background, ps)
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            algorithms.CrDetectionContext(self.psf, self.mi.mask, ps, lsst.geom.Box2I(), 2, 2)
+
+    def testConcurrentCalls(self):
+        """Test that calls on different images may run concurrently."""
+        crConfig = algorithms.FindCosmicRaysConfig()
+        ps = pexConfig.makePropertySet(crConfig)
+        images = []
+        for i in range(8):
+            mi = self.mi.clone()
+            mi.image.array[:] = np.roll(mi.image.array, 37*i, axis=1)
+            images.append(mi)
+
+        expected = []
+        for mi in images:
+            cleaned = mi.clone()
+            expected.append((algorithms.findCosmicRays(cleaned, self.psf, self.background, ps), cleaned))
+
+        def run(mi):
+            cleaned = mi.clone()
+            return algorithms.findCosmicRays(cleaned, self.psf, self.background, ps), cleaned
+
+        with concurrent.futures.ThreadPoolExecutor(max_workers=4) as executor:
+            results = list(executor.map(run, images))
+
+        for (crs, cleaned), (expectedCrs, expectedCleaned) in zip(results, expected):
+            self.assertEqual([cr.spans for cr in crs], [cr.spans for cr in expectedCrs])
+            self.assertMaskedImagesEqual(cleaned, expectedCleaned)
+
+    def testMetadata(self):
+        """Test that per-phase timings are reported when metadata is provided."""
+        ps = pexConfig.makePropertySet(algorithms.FindCosmicRaysConfig())
+        metadata = dafBase.PropertySet()
+        expected = self.mi.clone()
+        expectedCrs = algorithms.findCosmicRays(expected, self.psf, self.background, ps)
+        cleaned = self.mi.clone()
+        crs = algorithms.findCosmicRays(cleaned, self.psf, self.background, ps, metadata=metadata)
+        self.assertEqual([cr.spans for cr in crs], [cr.spans for cr in expectedCrs])
+        self.assertMaskedImagesEqual(cleaned, expected)
+        self.assertEqual(metadata.getScalar("crCount"), len(crs))
+        self.assertGreaterEqual(metadata.getScalar("crPixelCount"), len(crs))
+        for name in ("crFindTime", "crMergeTime", "crFilterTime", "crRemoveTime", "crGrowTime",
+                     "crFinishTime"):
+            self.assertGreaterEqual(metadata.getScalar(name), 0.0)
+
+
+class SpanComponentsTestCase(unittest.TestCase):
+    """A test case for grouping Spans into connected components"""
+
+    def testConnectivity(self):
+        spans = [afwGeom.Span(1, 1, 1), afwGeom.Span(0, 0, 0)]
+        eight = algorithms.SpanComponents(spans)
+        self.assertEqual(eight.getComponentCount(), 1)
+        self.assertEqual(eight.getSpans(), [afwGeom.Span(0, 0, 0), afwGeom.Span(1, 1, 1)])
+        four = algorithms.SpanComponents(spans, eightConnected=False)
+        self.assertEqual(four.getComponentCount(), 2)
+        self.assertEqual(four.getLabels(), [0, 1])
+
+    def testMerging(self):
+        """Test that both arms of a U join its base, and that components are numbered in order."""
+        spans = [afwGeom.Span(2, 0, 0), afwGeom.Span(2, 4, 4),  # arms of the U
+                 afwGeom.Span(1, 0, 0), afwGeom.Span(1, 4, 4),
+                 afwGeom.Span(0, 0, 4),                         # base of the U
+                 afwGeom.Span(1, 10, 12), afwGeom.Span(5, 2, 3)]
+        components = algorithms.SpanComponents(spans)
+        self.assertEqual(components.getComponentCount(), 3)
+        self.assertEqual(components.getLabels(), [0, 0, 0, 1, 0, 0, 2])
+        self.assertEqual(components.getFirstSpans(), [0, 3, 6])
+        self.assertEqual(components.getLastSpans(), [5, 3, 6])
+        spanSets = components.makeSpanSets()
+        self.assertEqual([ss.getArea() for ss in spanSets], [9, 3, 2])
+
+
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
 
@@ -24,10 +24,13 @@ import unittest
 import numpy as np
 
 import lsst.geom
+import lsst.afw.detection as afwDet
 import lsst.afw.table as afwTable
 import lsst.afw.image as afwImage
-from lsst.meas.algorithms import SourceDetectionTask
+import lsst.afw.math as afwMath
+from lsst.meas.algorithms import SourceDetectionTask, DetectionSmootherF, thresholdFootprints
 from lsst.meas.algorithms.testUtils import plantSources
+import lsst.pex.exceptions
 import lsst.utils.tests
 
 display = False
@@ -76,6 +79,144 @@ class DetectionTestCase(lsst.utils.tests.TestCase):
             self.assertEqual(res.numPos, numX * numY)
             self.assertEqual(res.numNeg, 0)
 
+    def testFastSmoothing(self):
+        """Test that DetectionSmoother matches afwMath.convolve, and that the task can use it"""
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(-3, 45), lsst.geom.Extent2I(157, 203))
+        rng = np.random.RandomState(12345)
+        original = afwImage.MaskedImageF(bbox)
+        original.image.array[:] = rng.normal(100.0, 10.0, size=original.image.array.shape)
+        original.variance.array[:] = rng.uniform(50.0, 150.0, size=original.variance.array.shape)
+        original.mask.array[rng.uniform(size=original.mask.array.shape) < 0.01] = 0x4
+
+        sigma, width = 2.3, 17
+        gaussFunc = afwMath.GaussianFunction1D(sigma)
+        gaussKernel = afwMath.SeparableKernel(width, width, gaussFunc, gaussFunc)
+        expected = afwImage.MaskedImageF(bbox)
+        afwMath.convolve(expected, original, gaussKernel, afwMath.ConvolutionControl())
+        goodBBox = gaussKernel.shrinkBBox(bbox)
+
+        for nThreads in (1, 3):
+            smoother = DetectionSmootherF(sigma, width, nThreads)
+            self.assertEqual(smoother.getGoodBBox(bbox), goodBBox)
+            smoothed = afwImage.MaskedImageF(bbox.getDimensions())
+            smoother.smooth(original, smoothed)
+            self.assertEqual(smoothed.getBBox(), bbox)
+            good = afwImage.MaskedImageF(smoothed, goodBBox)
+            expectedGood = afwImage.MaskedImageF(expected, goodBBox)
+            self.assertFloatsAlmostEqual(good.image.array, expectedGood.image.array, rtol=1e-5)
+            self.assertFloatsAlmostEqual(good.variance.array, expectedGood.variance.array, rtol=1e-5)
+            self.assertFloatsEqual(good.mask.array, expectedGood.mask.array)
+            self.assertTrue(np.all(np.isnan(smoothed.image.array[0, :])))
+
+            smoother.smooth(original, smoothed, doSmoothVariance=False)
+            self.assertTrue(np.all(np.isnan(smoothed.variance.array)))
+            self.assertFloatsAlmostEqual(good.image.array, expectedGood.image.array, rtol=1e-5)
+
+        with self.assertRaises(lsst.pex.exceptions.LengthError):
+            smoother.smooth(original, afwImage.MaskedImageF(10, 10))
+
+    def testFastSmoothingDetection(self):
+        """Test that detection with doFastSmoothing finds the same footprints"""
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(256, 100), lsst.geom.Extent2I(128, 127))
+        coordList = self.makeCoordList(bbox=bbox, numX=4, numY=4, minCounts=5000, maxCounts=50000,
+                                       sigma=1.5)
+        exposure = plantSources(bbox=bbox, kwid=11, sky=2000, coordList=coordList, addPoissonNoise=True)
+
+        results = []
+        for doFastSmoothing in (False, True):
+            config = SourceDetectionTask.ConfigClass()
+            config.reEstimateBackground = False
+            config.doFastSmoothing = doFastSmoothing
+            config.nSmoothingThreads = 2
+            config.doSmoothVariance = False
+            task = SourceDetectionTask(config=config, schema=afwTable.SourceTable.makeMinimalSchema())
+            for i in range(2):  # the second pass reuses the smoothing buffer
+                res = task.detectFootprints(exposure.clone(), sigma=2.2)
+            results.append(res)
+        self.assertEqual(results[0].numPos, results[1].numPos)
+        for fp0, fp1 in zip(results[0].positive.getFootprints(), results[1].positive.getFootprints()):
+            self.assertEqual(fp0.getSpans(), fp1.getSpans())
+
+    def testFusedDetection(self):
+        """Test that detection with doFusedDetection finds the same footprints, peaks and mask bits"""
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(256, 100), lsst.geom.Extent2I(128, 127))
+        coordList = self.makeCoordList(bbox=bbox, numX=4, numY=4, minCounts=5000, maxCounts=50000,
+                                       sigma=1.5)
+        # Two sources close enough for their grown footprints to merge
+        coordList += [[300.5, 160.0, 20000, 1.5], [306.5, 160.0, 20000, 1.5]]
+        exposure = plantSources(bbox=bbox, kwid=11, sky=2000, coordList=coordList, addPoissonNoise=True)
+
+        def getPeaks(fp):
+            return sorted((peak.getIx(), peak.getIy()) for peak in fp.getPeaks())
+
+        for combinedGrow in (True, False):
+            results = []
+            masks = []
+            for doFusedDetection in (False, True):
+                config = SourceDetectionTask.ConfigClass()
+                config.reEstimateBackground = False
+                config.thresholdPolarity = "both"
+                config.combinedGrow = combinedGrow
+                config.doFusedDetection = doFusedDetection
+                task = SourceDetectionTask(config=config, schema=afwTable.SourceTable.makeMinimalSchema())
+                exp = exposure.clone()
+                results.append(task.detectFootprints(exp, sigma=2.2))
+                masks.append(exp.mask.array.copy())
+            with self.subTest(combinedGrow=combinedGrow):
+                self.assertGreater(results[0].numPos, 0)
+                for polarity in ("positive", "negative"):
+                    fps0 = getattr(results[0], polarity).getFootprints()
+                    fps1 = getattr(results[1], polarity).getFootprints()
+                    self.assertEqual(len(fps0), len(fps1))
+                    for fp0, fp1 in zip(fps0, fps1):
+                        self.assertEqual(fp0.getSpans(), fp1.getSpans())
+                        self.assertEqual(getPeaks(fp0), getPeaks(fp1))
+                self.assertEqual(results[0].numPosPeaks, results[1].numPosPeaks)
+                np.testing.assert_array_equal(masks[0], masks[1])
+
+        # Only value and pixel_stdev thresholds are supported
+        threshold = afwDet.Threshold(5.0, afwDet.Threshold.VARIANCE)
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            thresholdFootprints(exposure.maskedImage, threshold, None, 1, bbox)
+
+    def testTiledDetection(self):
+        """Test that detection in tiles finds the same footprints as detection on the whole image"""
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(256, 100), lsst.geom.Extent2I(128, 127))
+        coordList = self.makeCoordList(bbox=bbox, numX=4, numY=4, minCounts=5000, maxCounts=50000,
+                                       sigma=1.5)
+        # A source straddling the boundary of the tiles
+        coordList.append([296.5, 140.0, 40000, 2.5])
+        exposure = plantSources(bbox=bbox, kwid=11, sky=2000, coordList=coordList, addPoissonNoise=True)
+
+        def getPeaks(fp):
+            return sorted((peak.getIx(), peak.getIy()) for peak in fp.getPeaks())
+
+        results = []
+        masks = []
+        for tileSize in (0, 40):
+            config = SourceDetectionTask.ConfigClass()
+            config.reEstimateBackground = False
+            config.doTempLocalBackground = False
+            config.thresholdPolarity = "both"
+            config.thresholdType = "value"
+            config.thresholdValue = 30.0
+            config.includeThresholdMultiplier = 2.0
+            config.tileSize = tileSize
+            task = SourceDetectionTask(config=config, schema=afwTable.SourceTable.makeMinimalSchema())
+            exp = exposure.clone()
+            results.append(task.detectFootprints(exp, sigma=2.2))
+            masks.append(exp.mask.array.copy())
+
+        self.assertGreater(results[0].numPos, 0)
+        for polarity in ("positive", "negative"):
+            fps0 = getattr(results[0], polarity).getFootprints()
+            fps1 = getattr(results[1], polarity).getFootprints()
+            self.assertEqual(len(fps0), len(fps1))
+            for fp0, fp1 in zip(fps0, fps1):
+                self.assertEqual(fp0.getSpans(), fp1.getSpans())
+                self.assertEqual(getPeaks(fp0), getPeaks(fp1))
+        np.testing.assert_array_equal(masks[0], masks[1])
+
     def makeCoordList(self, bbox, numX, numY, minCounts, maxCounts, sigma):
         """Make a coordList for plantSources."""
         """
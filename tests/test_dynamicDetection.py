@@ -80,6 +80,19 @@ class DynamicDetectionTest(lsst.utils.tests.TestCase):
         self.exposure.maskedImage.variance /= factor
         self.check(1.0/np.sqrt(factor))
 
+    def testReuseSmoothedImage(self):
+        """Reusing the smoothed image for the background tweak gives the same background"""
+        images = []
+        for doReuseSmoothedImage in (True, False):
+            self.config.doReuseSmoothedImage = doReuseSmoothedImage
+            exposure = self.exposure.clone()
+            schema = SourceTable.makeMinimalSchema()
+            task = DynamicDetectionTask(config=self.config, schema=schema)
+            task.run(SourceTable.make(schema), exposure, expId=12345)
+            images.append(exposure.image.array)
+        noise = np.sqrt(np.median(self.exposure.variance.array))
+        self.assertFloatsAlmostEqual(np.median(images[0] - images[1]), 0.0, atol=0.01*noise)
+
     def testNoSources(self):
         self.config.skyObjects.nSources = self.config.minNumSources - 1
         self.check(1.0)
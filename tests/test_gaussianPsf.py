@@ -242,6 +242,63 @@ class GaussianPsfTestCase(lsst.utils.tests.TestCase):
         self.assertTrue(np.allclose(im1Arr, im2Arr),
                         "kernel images %s, %s do not match" % (im1Arr, im2Arr))
 
+    def assertShapesEqual(self, shape1, shape2):
+        self.assertEqual(shape1.getIxx(), shape2.getIxx())
+        self.assertEqual(shape1.getIyy(), shape2.getIyy())
+        self.assertEqual(shape1.getIxy(), shape2.getIxy())
+
+    def testAnalyticMoments(self):
+        """Test that the closed-form shapes and aperture fluxes match measurements of the kernel image.
+        """
+        for psf in [self.psfDg, self.psfSg]:
+            kernelPsf = measAlg.KernelPsf(psf.getKernel())
+            shape = psf.computeShape()
+            measured = kernelPsf.computeShape()
+            self.assertFloatsAlmostEqual(shape.getIxx(), measured.getIxx(), rtol=1E-4)
+            self.assertFloatsAlmostEqual(shape.getIyy(), measured.getIyy(), rtol=1E-4)
+            self.assertFloatsAlmostEqual(shape.getIxy(), 0.0, atol=1E-12)
+            self.assertFloatsAlmostEqual(measured.getIxy(), 0.0, atol=1E-6)
+            self.assertEqual(psf.computeShape(lsst.geom.Point2D(100, -50)).getIxx(), shape.getIxx())
+            for radius in [2.0, 3.5, 7.0, 12.0]:
+                self.assertFloatsAlmostEqual(psf.computeApertureFlux(radius),
+                                             kernelPsf.computeApertureFlux(radius), rtol=2E-3)
+
+    def testTruncatedMoments(self):
+        """Test that moments fall back to measuring the kernel image when it truncates the PSF.
+        """
+        for psf in [self.psfDg.resized(7, 7), self.psfSg.resized(7, 7)]:
+            kernelPsf = measAlg.KernelPsf(psf.getKernel())
+            self.assertShapesEqual(psf.computeShape(), kernelPsf.computeShape())
+            # Apertures lying partly outside the kernel image are always measured.
+            self.assertEqual(psf.computeApertureFlux(5.0), kernelPsf.computeApertureFlux(5.0))
+
+    def testCacheMoments(self):
+        """Test the KernelPsf moments cache for spatially constant kernels.
+        """
+        kernelPsf = measAlg.KernelPsf(self.psfDg.getKernel())
+        reference = measAlg.KernelPsf(self.psfDg.getKernel())
+        self.assertFalse(kernelPsf.getCacheMoments())
+        kernelPsf.setCacheMoments(True)
+        self.assertTrue(kernelPsf.getCacheMoments())
+        for position in [lsst.geom.Point2D(0, 0), lsst.geom.Point2D(30, 40)]:
+            self.assertShapesEqual(kernelPsf.computeShape(position), reference.computeShape(position))
+            for radius in [3.0, 5.0]:
+                self.assertEqual(kernelPsf.computeApertureFlux(radius, position),
+                                 reference.computeApertureFlux(radius, position))
+        self.assertTrue(kernelPsf.clone().getCacheMoments())
+        kernelPsf.setCacheMoments(False)
+        self.assertFalse(kernelPsf.getCacheMoments())
+
+        # Spatially varying kernels are never cached.
+        spFunc = afwMath.PolynomialFunction2D(1)
+        basis = [afwMath.FixedKernel(self.psfSg.computeKernelImage()),
+                 afwMath.FixedKernel(self.psfDg.computeKernelImage())]
+        varying = afwMath.LinearCombinationKernel(basis, spFunc)
+        varying.setSpatialParameters([[1.0, 0.0, 0.0], [0.0, 1E-3, 1E-3]])
+        varyingPsf = measAlg.KernelPsf(varying)
+        varyingPsf.setCacheMoments(True)
+        self.assertFalse(varyingPsf.getCacheMoments())
+
     def testComputeBBox(self):
         """Test that computeBBox returns same bbox as kernel.
         """
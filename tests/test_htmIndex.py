@@ -23,6 +23,7 @@
 
 import os
 import unittest
+import unittest.mock
 from collections import Counter
 
 import astropy.time
@@ -35,6 +36,7 @@ import lsst.daf.persistence as dafPersist
 from lsst.meas.algorithms import (IngestIndexedReferenceTask, LoadIndexedReferenceObjectsTask,
                                   LoadIndexedReferenceObjectsConfig, getRefFluxField)
 from lsst.meas.algorithms.loadReferenceObjects import hasNanojanskyFluxUnits
+from lsst.meas.algorithms.loadIndexedReferenceObjects import _shardCache
 import lsst.utils
 
 import ingestIndexTestBase
@@ -244,6 +246,36 @@ class HtmIndexTestCase(ingestIndexTestBase.IngestIndexCatalogTestBase, lsst.util
             else:
                 self.assertEqual(len(idList), 0)
 
+    def testShardCache(self):
+        """Test that loaders share cached shards, and that loads don't modify them."""
+        _shardCache.clear()
+        cent = ingestIndexTestBase.make_coord(93.0, -30.1)
+        with unittest.mock.patch.object(self.testButler, "get", wraps=self.testButler.get) as get:
+            def countShardReads():
+                return sum(1 for call in get.call_args_list if call[0][0] == "ref_cat" and
+                           call[1]["dataId"]["pixel_id"] != "master_schema")
+
+            first = LoadIndexedReferenceObjectsTask(butler=self.testButler)
+            refCat1 = first.loadSkyCircle(cent, self.searchRadius, filterName='a').refCat
+            nReads = countShardReads()
+            self.assertGreater(nReads, 0)
+            original = refCat1.copy(True)
+            refCat1["coord_ra"] += 0.1
+
+            second = LoadIndexedReferenceObjectsTask(butler=self.testButler)
+            refCat2 = second.loadSkyCircle(cent, self.searchRadius, filterName='a').refCat
+            self.assertEqual(countShardReads(), nReads)
+            self.assertFloatsEqual(refCat2["coord_ra"], original["coord_ra"])
+
+            config = LoadIndexedReferenceObjectsConfig()
+            config.shardCacheMaxBytes = 0
+            _shardCache.clear()
+            uncached = LoadIndexedReferenceObjectsTask(butler=self.testButler, config=config)
+            refCat3 = uncached.loadSkyCircle(cent, self.searchRadius, filterName='a').refCat
+            uncached.loadSkyCircle(cent, self.searchRadius, filterName='a')
+            self.assertEqual(countShardReads(), 3*nReads)
+            self.assertFloatsEqual(refCat3["coord_ra"], original["coord_ra"])
+
     def testLoadPixelBox(self):
         """Test LoadIndexedReferenceObjectsTask.loadPixelBox with default config."""
         loader = LoadIndexedReferenceObjectsTask(butler=self.testButler)
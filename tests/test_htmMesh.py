@@ -0,0 +1,129 @@
+# This file is part of meas_algorithms.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+import unittest
+
+import numpy as np
+
+import lsst.geom
+import lsst.utils.tests
+import lsst.pex.exceptions
+from lsst.meas.algorithms import HtmMesh, HtmIndexer
+
+try:
+    import esutil
+except ImportError:
+    esutil = None
+
+
+class HtmMeshTestCase(lsst.utils.tests.TestCase):
+    def setUp(self):
+        rng = np.random.RandomState(12345)
+        self.ra = rng.uniform(0.0, 360.0, 20000)
+        self.dec = np.degrees(np.arcsin(rng.uniform(-1.0, 1.0, 20000)))
+        self.depth = 6
+        self.mesh = HtmMesh(self.depth)
+
+    def testDepth(self):
+        self.assertEqual(self.mesh.getDepth(), self.depth)
+        for depth in (-1, HtmMesh.MAX_DEPTH + 1):
+            with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+                HtmMesh(depth)
+
+    def testKnownIds(self):
+        """Shard IDs of the persisted test reference catalogs (made with esutil) must not change."""
+        mesh = HtmMesh(4)
+        self.assertEqual(mesh.indexPoint(83.8727628055583, -33.5744176723089), 2222)
+        self.assertEqual(mesh.indexPoint(10.6964691855979, 20.513128154199), 4022)
+        # The root trixels S0-S3, N0-N3 are 8-15
+        root = HtmMesh(0)
+        self.assertEqual([root.indexPoint(ra, dec) for dec in (-45, 45) for ra in (45, 135, 225, 315)],
+                         [8, 9, 10, 11, 15, 14, 13, 12])
+
+    def testIndexPoints(self):
+        ids = self.mesh.indexPoints(self.ra, self.dec)
+        self.assertEqual(ids.dtype, np.int64)
+        self.assertEqual(list(ids), [self.mesh.indexPoint(ra, dec) for ra, dec in zip(self.ra, self.dec)])
+        self.assertTrue(np.all((ids >= 8 << (2*self.depth)) & (ids < 16 << (2*self.depth))))
+        np.testing.assert_array_equal(self.mesh.indexPoints(self.ra, self.dec, nThreads=4), ids)
+        with self.assertRaises(lsst.pex.exceptions.LengthError):
+            self.mesh.indexPoints(self.ra, self.dec[:-1])
+
+    @unittest.skipIf(esutil is None, "esutil is not available")
+    def testEsutil(self):
+        np.testing.assert_array_equal(self.mesh.indexPoints(self.ra, self.dec),
+                                      esutil.htm.HTM(self.depth).lookup_id(self.ra, self.dec))
+
+    def checkCover(self, cover, inside):
+        """Check a cover against the points inside its region."""
+        shardIds, isOnBoundary = cover
+        self.assertEqual(list(shardIds), sorted(set(shardIds)))
+        ids = self.mesh.indexPoints(self.ra, self.dec)
+        self.assertTrue(set(ids[inside]) <= set(shardIds))
+        interior = set(shardId for shardId, onBoundary in zip(shardIds, isOnBoundary) if not onBoundary)
+        self.assertGreater(len(interior), 0)
+        self.assertTrue(np.all(inside[np.isin(ids, list(interior))]))
+
+    def testCircleCover(self):
+        ctrCoord = lsst.geom.SpherePoint(30.0, -20.0, lsst.geom.degrees)
+        points = [lsst.geom.SpherePoint(ra, dec, lsst.geom.degrees) for ra, dec in zip(self.ra, self.dec)]
+        for radius in (10.0, 120.0):
+            with self.subTest(radius=radius):
+                inside = np.array([ctrCoord.separation(point).asDegrees() <= radius for point in points])
+                self.checkCover(self.mesh.getCircleCover(ctrCoord, radius*lsst.geom.degrees), inside)
+
+    def testPolygonCover(self):
+        vertices = [lsst.geom.SpherePoint(ra, dec, lsst.geom.degrees)
+                    for ra, dec in ((100, -10), (140, -10), (140, 20), (100, 20))]
+        # Boxes in RA, Dec are only approximately spherical polygons; stay clear of the curved edges
+        inside = (self.ra > 100.5) & (self.ra < 139.5) & (self.dec > -9.5) & (self.dec < 19.5)
+        for winding in (vertices, vertices[::-1]):
+            cover = self.mesh.getPolygonCover(winding)
+            shardIds, isOnBoundary = cover
+            ids = self.mesh.indexPoints(self.ra, self.dec)
+            self.assertTrue(set(ids[inside]) <= set(shardIds))
+            self.assertGreater(len(isOnBoundary) - sum(isOnBoundary), 0)
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            self.mesh.getPolygonCover(vertices[:2])
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            self.mesh.getPolygonCover([vertices[0], vertices[2], vertices[1], vertices[3]])
+
+    def testHtmIndexer(self):
+        indexer = HtmIndexer(depth=self.depth)
+        np.testing.assert_array_equal(indexer.indexPoints(list(self.ra), list(self.dec)),
+                                      self.mesh.indexPoints(self.ra, self.dec))
+        ctrCoord = lsst.geom.SpherePoint(30.0, -20.0, lsst.geom.degrees)
+        shardIds, isOnBoundary = indexer.getShardIds(ctrCoord, 5*lsst.geom.degrees)
+        self.assertEqual(len(shardIds), len(isOnBoundary))
+        self.assertIn(indexer.indexPoints([30.0], [-20.0])[0], shardIds)
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
@@ -0,0 +1,96 @@
+# This file is part of meas_algorithms.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+import unittest
+
+import lsst.geom
+import lsst.afw.image as afwImage
+import lsst.daf.base as dafBase
+import lsst.meas.algorithms as algorithms
+import lsst.utils.tests
+
+
+@unittest.skipUnless(algorithms.Instrumentation.isCompiled(), "instrumentation not compiled in")
+class InstrumentationTestCase(lsst.utils.tests.TestCase):
+    """Tests for the timers and counters of the C++ code"""
+
+    def setUp(self):
+        algorithms.Instrumentation.reset()
+        self.mi = afwImage.MaskedImageF(50, 40)
+        self.mi.set((100, 0x0, 10))
+        self.psf = algorithms.DoubleGaussianPsf(15, 15, 1.0)
+        self.defects = algorithms.Defects()
+        self.defects.append(lsst.geom.BoxI(lsst.geom.PointI(10, 0), lsst.geom.ExtentI(2, 40)))
+
+    def tearDown(self):
+        algorithms.Instrumentation.setEnabled(False)
+        algorithms.Instrumentation.reset()
+        del self.mi
+        del self.psf
+        del self.defects
+
+    def testDisabled(self):
+        """Test that nothing is recorded unless instrumentation is enabled"""
+        self.assertFalse(algorithms.Instrumentation.isEnabled())
+        algorithms.interpolateOverDefects(self.mi, self.psf, self.defects)
+        self.assertEqual(algorithms.Instrumentation.getTimers(), {})
+        self.assertEqual(algorithms.Instrumentation.getCounters(), {})
+
+    def testThreads(self):
+        """Test that the entries of all threads, including ones that have exited, are merged"""
+        algorithms.Instrumentation.setEnabled(True)
+        for nThreads in (1, 4):
+            algorithms.interpolateOverDefects(self.mi, self.psf, self.defects, nThreads=nThreads)
+
+        timers = algorithms.Instrumentation.getTimers()
+        self.assertEqual(timers["interpolateOverDefects"].calls, 2)
+        self.assertGreater(timers["interpolateOverDefects"].total, 0.0)
+        counters = algorithms.Instrumentation.getCounters()
+        self.assertEqual(counters["interpolateOverDefects.defectRuns"].calls, 2)
+        self.assertEqual(counters["interpolateOverDefects.defectRuns"].total, 2*40)
+
+        algorithms.Instrumentation.reset()
+        self.assertEqual(algorithms.Instrumentation.getTimers(), {})
+        self.assertEqual(algorithms.Instrumentation.getCounters(), {})
+
+    def testUpdateMetadata(self):
+        """Test copying the entries into Task metadata"""
+        algorithms.Instrumentation.setEnabled(True)
+        algorithms.interpolateOverDefects(self.mi, self.psf, self.defects)
+        metadata = dafBase.PropertySet()
+        algorithms.Instrumentation.updateMetadata(metadata, prefix="test")
+        self.assertEqual(metadata.getScalar("test.interpolateOverDefects.calls"), 1)
+        self.assertGreater(metadata.getScalar("test.interpolateOverDefects.seconds"), 0.0)
+        self.assertEqual(metadata.getScalar("test.interpolateOverDefects.defectRuns.count"), 1)
+        self.assertEqual(metadata.getScalar("test.interpolateOverDefects.defectRuns.total"), 40)
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
@@ -20,13 +20,17 @@
 # along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 import os
+import pickle
 import unittest
 import math
 import numpy as np
 
 import lsst.geom
+import lsst.afw.detection as afwDetection
+import lsst.afw.geom
 import lsst.afw.image as afwImage
 import lsst.meas.algorithms as algorithms
+import lsst.pex.exceptions
 import lsst.utils.tests
 from lsst.daf.base import PropertyList
 
@@ -123,6 +127,41 @@ class DefectsTestCase(lsst.utils.tests.TestCase):
         with self.assertRaises(ValueError):
             defects.append("defect")
 
+    def testMaskPixels(self):
+        """Test masking defects, including overlapping and partly off-image ones, and the reverse."""
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(100, 200), lsst.geom.Extent2I(60, 40))
+        defects = algorithms.Defects([lsst.geom.Box2I(lsst.geom.Point2I(110, 205), lsst.geom.Extent2I(3, 20)),
+                                      lsst.geom.Box2I(lsst.geom.Point2I(111, 210), lsst.geom.Extent2I(10, 2)),
+                                      lsst.geom.Box2I(lsst.geom.Point2I(90, 230), lsst.geom.Extent2I(20, 30)),
+                                      lsst.geom.Box2I(lsst.geom.Point2I(150, 215), lsst.geom.Extent2I(1, 1)),
+                                      lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(5, 5))])
+        mi = afwImage.MaskedImageF(bbox)
+        mi.mask.array[:, :] = mi.mask.getPlaneBitMask("SAT")
+        defects.maskPixels(mi, "BAD")
+
+        expected = afwImage.MaskedImageF(bbox)
+        expected.mask.array[:, :] = expected.mask.getPlaneBitMask("SAT")
+        bitmask = expected.mask.getPlaneBitMask("BAD")
+        for defect in defects:
+            lsst.afw.geom.SpanSet(defect.getBBox()).clippedTo(bbox).setMask(expected.mask, bitmask)
+        self.assertMasksEqual(mi.mask, expected.mask)
+
+        # Converting back covers exactly the masked pixels
+        mi.mask.array[:, :] &= ~mi.mask.getPlaneBitMask("SAT")
+        recovered = algorithms.Defects.fromMask(mi, "BAD")
+        remasked = afwImage.MaskedImageF(bbox)
+        recovered.maskPixels(remasked, "BAD")
+        self.assertMasksEqual(remasked.mask, mi.mask)
+        # ... with the same boxes as decomposing the footprints of a FootprintSet
+        threshold = afwDetection.Threshold(mi.mask.getPlaneBitMask("BAD"), afwDetection.Threshold.BITMASK)
+        footprints = afwDetection.FootprintSet(mi.mask, threshold).getFootprints()
+
+        def sortedBoxes(someDefects):
+            return sorted((d.getBBox() for d in someDefects),
+                          key=lambda box: (box.getMinY(), box.getMinX(), box.getMaxY(), box.getMaxX()))
+        self.assertEqual(sortedBoxes(recovered),
+                         sortedBoxes(algorithms.Defects.fromFootprintList(footprints)))
+
     def testAstropyRegion(self):
         """Read a FITS region file created by Astropy regions."""
 
@@ -344,6 +383,61 @@ class InterpolationTestCase(lsst.utils.tests.TestCase):
             self.assertGreater(np.min(ima), -2)
             self.assertGreater(2, np.max(ima))
 
+    @unittest.skipUnless(afwdataDir, "afwdata not available")
+    def testNarrowDefects(self):
+        """Test interpolating over bad columns 1-4 pixels wide, alone and separated by single good pixels"""
+        mi = afwImage.MaskedImageF(40, 10)
+        mi.set((100, 0x0, 10))
+        columns = [(1, 2), (5, 1), (7, 3), (13, 4), (18, 2), (21, 1), (25, 3), (29, 4), (38, 1)]
+        defectList = algorithms.Defects()
+        for x0, width in columns:
+            defectList.append(lsst.geom.BoxI(lsst.geom.PointI(x0, 0), lsst.geom.ExtentI(width, 10)))
+        mi.image.array[:, [x for x0, width in columns for x in range(x0, x0 + width)]] = np.nan
+
+        algorithms.interpolateOverDefects(mi, self.psf, defectList)
+
+        self.assertFloatsAlmostEqual(mi.image.array, 100, atol=0.05)
+        self.assertFloatsAlmostEqual(mi.variance.array, 10, atol=0.005)
+        interpBit = mi.getMask().getPlaneBitMask("INTRP")
+        for x0, width in columns:
+            self.assertTrue(np.all(mi.mask.array[:, x0:x0 + width] == interpBit))
+
+    @unittest.skipUnless(afwdataDir, "afwdata not available")
+    def testThreads(self):
+        """Test that interpolating with several threads matches a single thread."""
+        expected = self.mi.clone()
+        algorithms.interpolateOverDefects(expected, self.psf, self.badPixels, 0.0, True)
+        for nThreads in (2, 4, 7):
+            mi = self.mi.clone()
+            algorithms.interpolateOverDefects(mi, self.psf, self.badPixels, 0.0, True, nThreads=nThreads)
+            self.assertMaskedImagesEqual(mi, expected)
+
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            algorithms.interpolateOverDefects(self.mi.clone(), self.psf, self.badPixels, nThreads=0)
+
+    @unittest.skipUnless(afwdataDir, "afwdata not available")
+    def testCompiledDefectMap(self):
+        """Test that a compiled defect map, and a persisted copy, give the same results as the defects."""
+        expected = self.mi.clone()
+        algorithms.interpolateOverDefects(expected, self.psf, self.badPixels, 0.0, True)
+
+        defectMap = self.badPixels.compile(self.mi.getBBox())
+        self.assertEqual(defectMap.getBBox(), self.mi.getBBox())
+        self.assertEqual(len(defectMap.getOffsets()), self.mi.getHeight() + 1)
+        restored = pickle.loads(pickle.dumps(defectMap))
+        self.assertEqual(restored.getRuns(), defectMap.getRuns())
+        for dm in (defectMap, restored):
+            for nThreads in (1, 3):
+                mi = self.mi.clone()
+                algorithms.interpolateOverDefects(mi, dm, 0.0, True, nThreads=nThreads)
+                self.assertMaskedImagesEqual(mi, expected)
+
+        subImage = self.mi[lsst.geom.Box2I(lsst.geom.Point2I(10, 10), lsst.geom.Extent2I(100, 100))]
+        with self.assertRaises(lsst.pex.exceptions.LengthError):
+            algorithms.interpolateOverDefects(subImage, defectMap)
+        with self.assertRaises(lsst.pex.exceptions.LengthError):
+            algorithms.CompiledDefectMap(self.mi.getBBox(), [0, 0], [])
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
@@ -0,0 +1,117 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE LanczosStampShifter
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-variable"
+#include "boost/test/unit_test.hpp"
+#pragma clang diagnostic pop
+
+#include <cmath>
+#include <memory>
+#include <random>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/image/Image.h"
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/afw/math/offsetImage.h"
+#include "lsst/meas/algorithms/LanczosStampShifter.h"
+
+using namespace lsst::afw::image;
+using namespace lsst::meas::algorithms;
+
+namespace {
+
+// Offsets to test: within a pixel, either sign, exactly zero, and more than a pixel (integer part in xy0)
+float const OFFSETS[][2] = {{0.3, -0.2}, {-0.45, 0.1}, {0.0, 0.25}, {0.0, 0.0}, {1.3, -2.6}};
+
+template <typename PixelT>
+void fill(Image<PixelT>& image, std::mt19937& rng) {
+    std::uniform_real_distribution<> uniform(0.0, 1.0);
+    for (int y = 0; y < image.getHeight(); ++y) {
+        for (int x = 0; x < image.getWidth(); ++x) {
+            // A smooth blob plus some noise
+            double const r2 =
+                    std::pow(x - 0.5 * image.getWidth(), 2) + std::pow(y - 0.4 * image.getHeight(), 2);
+            image(x, y) = 100.0 * std::exp(-0.5 * r2 / 4.0) + uniform(rng);
+        }
+    }
+    image.setXY0(12, -7);
+}
+
+template <typename PixelT>
+void checkClose(Image<PixelT> const& image, Image<PixelT> const& expected, double tol) {
+    BOOST_REQUIRE_EQUAL(image.getDimensions(), expected.getDimensions());
+    BOOST_CHECK_EQUAL(image.getXY0(), expected.getXY0());
+    for (int y = 0; y < image.getHeight(); ++y) {
+        for (int x = 0; x < image.getWidth(); ++x) {
+            BOOST_CHECK_SMALL(image(x, y) - expected(x, y), static_cast<PixelT>(tol));
+        }
+    }
+}
+
+template <typename PixelT>
+void checkImage(double tol) {
+    std::mt19937 rng(0);
+    Image<PixelT> image(21, 19);
+    fill(image, rng);
+    for (std::string algorithm : {"lanczos3", "lanczos5"}) {
+        auto shifter = LanczosStampShifter::fromAlgorithm(algorithm);
+        BOOST_REQUIRE(shifter);
+        for (auto const& offset : OFFSETS) {
+            for (unsigned int buffer : {0, 1, 5}) {
+                auto expected = lsst::afw::math::offsetImage(image, offset[0], offset[1], algorithm, buffer);
+                checkClose(*shifter->shift(image, offset[0], offset[1], buffer), *expected, tol);
+                checkClose(*offsetStamp(image, offset[0], offset[1], algorithm, buffer), *expected, tol);
+
+                Image<PixelT> inPlace(image, true);
+                shifter->shift(inPlace, offset[0], offset[1], inPlace, buffer);
+                checkClose(inPlace, *expected, tol);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(ShiftImage) {
+    checkImage<float>(1e-4);
+    checkImage<double>(1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(ShiftMaskedImage) {
+    std::mt19937 rng(1);
+    MaskedImage<float> mimage(25, 23);
+    fill(*mimage.getImage(), rng);
+    fill(*mimage.getVariance(), rng);
+    mimage.setXY0(12, -7);
+    MaskPixel const bad = Mask<MaskPixel>::getPlaneBitMask("BAD");
+    (*mimage.getMask())(11, 12) = bad;
+
+    auto shifter = LanczosStampShifter::fromAlgorithm("lanczos5");
+    for (auto const& offset : OFFSETS) {
+        auto expected = lsst::afw::math::offsetImage(mimage, offset[0], offset[1], "lanczos5");
+        MaskedImage<float> shifted(mimage, true);
+        shifter->shift(shifted, offset[0], offset[1], shifted);
+
+        checkClose(*shifted.getImage(), *expected->getImage(), 1e-4);
+        checkClose(*shifted.getVariance(), *expected->getVariance(), 1e-4);
+        for (int y = 0; y < mimage.getHeight(); ++y) {
+            for (int x = 0; x < mimage.getWidth(); ++x) {
+                BOOST_CHECK_EQUAL((*shifted.getMask())(x, y), (*expected->getMask())(x, y));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ShiftErrors) {
+    BOOST_CHECK(!LanczosStampShifter::fromAlgorithm("bilinear"));
+    BOOST_CHECK(!LanczosStampShifter::fromAlgorithm("lanczos"));
+    BOOST_CHECK(!LanczosStampShifter::fromAlgorithm("lanczos3x"));
+    BOOST_CHECK_EQUAL(LanczosStampShifter::fromAlgorithm("lanczos4")->getOrder(), 4);
+    BOOST_CHECK_THROW(LanczosStampShifter(0), lsst::pex::exceptions::InvalidParameterError);
+
+    LanczosStampShifter shifter(5);
+    Image<float> image(9, 20), other(10, 20);
+    BOOST_CHECK_THROW(shifter.shift(image, 0.1, 0.1), lsst::pex::exceptions::LengthError);
+    BOOST_CHECK_NO_THROW(shifter.shift(image, 0.1, 0.1, 1));
+    BOOST_CHECK_THROW(shifter.shift(other, 0.1, 0.1, image), lsst::pex::exceptions::LengthError);
+}
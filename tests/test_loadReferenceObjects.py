@@ -24,10 +24,14 @@
 import itertools
 import unittest
 
+import numpy as np
+
+import lsst.geom
 import lsst.afw.table as afwTable
 import lsst.log
 from lsst.meas.algorithms import LoadReferenceObjectsTask, getRefFluxField, getRefFluxKeys
-from lsst.meas.algorithms.loadReferenceObjects import hasNanojanskyFluxUnits, convertToNanojansky
+from lsst.meas.algorithms.loadReferenceObjects import (hasNanojanskyFluxUnits, convertToNanojansky,
+                                                       offsetCoords)
 import lsst.utils.tests
 
 
@@ -209,6 +213,20 @@ class TestLoadReferenceObjects(lsst.utils.tests.TestCase):
         newRefCat = convertToNanojansky(oldRefCat, log, doConvert=False)
         self.assertIsNone(newRefCat)
 
+    def testOffsetCoords(self):
+        """offsetCoords should agree with SpherePoint.offset."""
+        rng = np.random.RandomState(1)
+        ra = rng.uniform(0.0, 2*np.pi, 100)
+        dec = np.arcsin(rng.uniform(-0.999, 0.999, 100))
+        bearing = rng.uniform(-np.pi, np.pi, 100)
+        amount = rng.uniform(0.0, 1.0e-3, 100)
+        newRa, newDec = offsetCoords(ra, dec, bearing, amount)
+        for i in range(len(ra)):
+            expected = lsst.geom.SpherePoint(ra[i], dec[i], lsst.geom.radians).offset(
+                bearing[i]*lsst.geom.radians, amount[i]*lsst.geom.radians)
+            self.assertSpherePointsAlmostEqual(lsst.geom.SpherePoint(newRa[i], newDec[i], lsst.geom.radians),
+                                               expected, maxSep=1.0e-7*lsst.geom.arcseconds)
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
@@ -22,8 +22,10 @@
 import unittest
 import numpy as np
 
+import lsst.geom
+import lsst.afw.geom as afwGeom
 import lsst.afw.table as afwTable
-from lsst.meas.algorithms import sourceSelector
+from lsst.meas.algorithms import sourceSelector, objectSizeStarSelector
 import lsst.meas.base.tests
 import lsst.utils.tests
 
@@ -116,6 +118,39 @@ class TestObjectSizeSourceSelector(lsst.utils.tests.TestCase):
         self.assertIn(self.sourceCat[1]["id"], result.sourceCat["id"])
         self.assertNotIn(self.sourceCat[2]["id"], result.sourceCat["id"])
 
+    def testKCenters(self):
+        """Test that well-separated clusters are recovered, whatever the order of the points"""
+        rng = np.random.RandomState(12345)
+        truth = np.array([2.0, 2.6, 3.5])
+        yvec = np.concatenate([rng.normal(center, 0.02, 100) for center in truth])
+        shuffle = rng.permutation(len(yvec))
+        for useMedian in (False, True):
+            centers, clusterId = objectSizeStarSelector._kcenters(yvec, 3, useMedian=useMedian)
+            np.testing.assert_array_equal(clusterId, np.repeat(np.arange(3), 100))
+            self.assertFloatsAlmostEqual(centers, truth, atol=0.01)
+
+            shuffledCenters, shuffledId = objectSizeStarSelector._kcenters(yvec[shuffle], 3,
+                                                                            useMedian=useMedian)
+            np.testing.assert_array_equal(shuffledId, clusterId[shuffle])
+            self.assertFloatsAlmostEqual(shuffledCenters, centers, rtol=1e-12)
+
+    def testTransformMoments(self):
+        """Test that moments transformed through an affine transform match the Quadrupole transform"""
+        affine = lsst.geom.AffineTransform(lsst.geom.LinearTransform(np.array([[1.1, 0.2], [-0.1, 0.9]])),
+                                           lsst.geom.Extent2D(3.0, -2.0))
+        transform = afwGeom.makeTransform(affine)
+        x = np.array([10.0, 200.0, 1500.0])
+        y = np.array([20.0, 800.0, 3000.0])
+        xx = np.array([2.0, 4.0, 3.0])
+        xy = np.array([0.1, -0.5, 0.0])
+        yy = np.array([2.5, 3.0, 3.0])
+        txx, txy, tyy = objectSizeStarSelector._transformMoments(transform, x, y, xx, xy, yy)
+        for i in range(len(x)):
+            expect = afwGeom.Quadrupole(xx[i], yy[i], xy[i]).transform(affine.getLinear())
+            self.assertFloatsAlmostEqual(txx[i], expect.getIxx(), rtol=1e-8)
+            self.assertFloatsAlmostEqual(txy[i], expect.getIxy(), rtol=1e-8, atol=1e-10)
+            self.assertFloatsAlmostEqual(tyy[i], expect.getIyy(), rtol=1e-8)
+
     def testSelectSourcesNoSignalToNoiseCut(self):
         for i in range(5):
             addGoodSource(self.sourceCat, i)
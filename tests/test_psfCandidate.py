@@ -182,6 +182,42 @@ class CandidateMaskingTestCase(lsst.utils.tests.TestCase):
         """
         self.checkCandidateMasking([(self.x + 2, self.y, 1.0)], [(self.x + 1, self.y, 0.5)])
 
+    def testManyPeakBlend(self):
+        """Test that pixels of a many-peak blend go to their nearest peak.
+
+        A ring of peaks around the central one, all joined into one footprint,
+        is checked against a brute-force assignment of pixels to peaks.
+        """
+        size = 25
+        image = self.exposure.getMaskedImage().getImage()
+        ring = [(4, 0), (-5, 2), (0, 5), (-3, -6), (6, -4), (-7, 8)]
+        for dx, dy in ring:
+            # An L-shaped bridge to the center, dipping in the middle so that it has no peaks of its own
+            path = [(i, 0) for i in range(0, dx, 1 if dx > 0 else -1)] + \
+                   [(dx, j) for j in range(0, dy, 1 if dy > 0 else -1)]
+            for k, (px, py) in enumerate(path[1:], 1):
+                image[self.x + px, self.y + py, afwImage.LOCAL] = 0.5 + 0.05*abs(k - len(path)/2)
+            image[self.x + dx, self.y + dy, afwImage.LOCAL] = 1.0
+        cand = self.createCandidate()
+        foot = cand.getSource().getFootprint()
+        peaks = [(peak.getIx(), peak.getIy()) for peak in foot.getPeaks()]
+        self.assertGreater(len(peaks), 2)
+
+        mask = cand.getMaskedImage(size, size).getMask()
+        intrp = mask.getPlaneBitMask("INTRP")
+        nMasked = 0
+        for span in foot.getSpans():
+            y = span.getY()
+            for x in range(span.getMinX(), span.getMaxX() + 1):
+                if not mask.getBBox().contains(lsst.geom.Point2I(x, y)):
+                    continue
+                central = (x - self.x)**2 + (y - self.y)**2
+                nearest = min((x - px)**2 + (y - py)**2 for px, py in peaks if (px, py) != (self.x, self.y))
+                masked = bool(mask[x, y, afwImage.PARENT] & intrp)
+                self.assertEqual(masked, nearest < central, "pixel (%d, %d)" % (x, y))
+                nMasked += masked
+        self.assertGreater(nMasked, 0)
+
     def testNeighborMasking(self):
         """Test that neighbours are masked.
 
@@ -198,6 +234,33 @@ class CandidateMaskingTestCase(lsst.utils.tests.TestCase):
         """
         self.checkCandidateMasking([(self.x + 5, self.y, 0.5)], threshold=0.9, pixelThreshold=1.0)
 
+    def testStampArena(self):
+        """Test that stamps made in an arena are the same as those allocated separately."""
+        size = 25
+        cand = self.createCandidate()
+        expected = afwImage.MaskedImageF(cand.getMaskedImage(size, size), True)
+
+        arena = measAlg.PsfStampArenaF(size, size, 1)
+        self.assertEqual(len(arena), 0)
+        self.assertGreaterEqual(arena.getMemorySize(), 10*size*size)
+        cand = self.createCandidate()
+        cand.setStampArena(arena)
+        stamp = cand.getMaskedImage(size, size)
+        self.assertEqual(len(arena), 1)
+        self.assertEqual(stamp.getXY0(), expected.getXY0())
+        self.assertMaskedImagesEqual(stamp, expected)
+
+        # The arena is full, and stamps of other sizes never come from it
+        self.assertIsNone(arena.allocate(lsst.geom.Extent2I(size, size)))
+        self.assertIsNone(measAlg.PsfStampArenaF(size, size, 1).allocate(lsst.geom.Extent2I(size + 2, size)))
+        other = cand.getMaskedImage(size + 2, size + 2)
+        self.assertEqual(other.getDimensions(), lsst.geom.Extent2I(size + 2, size + 2))
+
+        # Stamps outlive the arena
+        del arena
+        cand.setStampArena(None)
+        self.assertMaskedImagesEqual(stamp, expected)
+
 
 class MakePsfCandidatesTaskTest(lsst.utils.tests.TestCase):
     """Test MakePsfCandidatesTask on a handful of fake sources.
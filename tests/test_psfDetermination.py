@@ -298,6 +298,117 @@ class SpatialModelPsfTestCase(lsst.utils.tests.TestCase):
         chi_lim = 5.0
         self.subtractStars(self.exposure, self.catalog, chi_lim)
 
+    def testPsfDeterminerAmplitudeIteration(self):
+        """Test refitting the linear spatial model with the previous model's amplitudes."""
+        self.setupDeterminer(starSelectorAlg="objectSize")
+        self.psfDeterminer.config.nIterForSpatialAmplitude = 3
+        metadata = dafBase.PropertyList()
+
+        stars = self.starSelector.run(self.catalog, exposure=self.exposure)
+        psfCandidateList = self.makePsfCandidates.run(stars.sourceCat, self.exposure).psfCandidates
+
+        psf, cellSet = self.psfDeterminer.determinePsf(self.exposure, psfCandidateList, metadata)
+        self.assertTrue(np.isfinite(metadata.getScalar("spatialFitChi2")))
+        self.exposure.setPsf(psf)
+
+        chi_lim = 5.0
+        self.subtractStars(self.exposure, self.catalog, chi_lim)
+
+    def testSpatialKernelFitCache(self):
+        """Test that reusing a SpatialKernelFitCache doesn't change the linear spatial fit."""
+        kernel, eigenValues = measAlg.createKernelFromPsfCandidates(
+            self.cellSet, self.exposure.getDimensions(), self.exposure.getXY0(), 2, 1, self.ksize)
+        status, chi2 = measAlg.fitSpatialKernelFromPsfCandidates(kernel, self.cellSet, False)
+        params = kernel.getSpatialParameters()
+
+        cache = measAlg.SpatialKernelFitCacheF()
+        for i in range(2):
+            status, cachedChi2 = measAlg.fitSpatialKernelFromPsfCandidates(kernel, self.cellSet, False,
+                                                                           cache=cache)
+            self.assertEqual(cachedChi2, chi2)
+            self.assertEqual(kernel.getSpatialParameters(), params)
+        self.assertGreater(len(cache), 0)
+        self.assertGreater(cache.getHits(), 0)
+        self.assertEqual(cache.getHits() + cache.getMisses(), 2*len(cache))
+
+        cache.clear()
+        self.assertEqual(len(cache), 0)
+
+    def checkKernelsClose(self, kernel, expected, rtol):
+        """Check that the basis images of two LinearCombinationKernels agree."""
+        self.assertEqual(kernel.getNBasisKernels(), expected.getNBasisKernels())
+        for basis, expectedBasis in zip(kernel.getKernelList(), expected.getKernelList()):
+            image = afwImage.ImageD(basis.getDimensions())
+            expectedImage = afwImage.ImageD(expectedBasis.getDimensions())
+            basis.computeImage(image, False)
+            expectedBasis.computeImage(expectedImage, False)
+            self.assertFloatsAlmostEqual(image.array, expectedImage.array,
+                                         atol=rtol*np.abs(expectedImage.array).max())
+
+    def testIncrementalPca(self):
+        """Test that reusing an ImageInnerProductCache gives the same PCA basis."""
+        args = (self.cellSet, self.exposure.getDimensions(), self.exposure.getXY0(), 2, 1, self.ksize)
+        kernel, eigenValues = measAlg.createKernelFromPsfCandidates(*args)
+
+        cache = measAlg.ImageInnerProductCacheF()
+        cachedKernel, cachedEigenValues = measAlg.createKernelFromPsfCandidates(*args, cache=cache)
+        self.assertFloatsAlmostEqual(np.array(cachedEigenValues), np.array(eigenValues), rtol=1e-5)
+        self.checkKernelsClose(cachedKernel, kernel, 1e-5)
+        nCandidates = len(cache)
+        self.assertGreater(nCandidates, 0)
+
+        # Rejecting a candidate only drops its inner products
+        cand = next(iter(self.cellSet.getCellList()[0].begin(True)))
+        cand.setStatus(afwMath.SpatialCellCandidate.BAD)
+        hits = cache.getHits()
+        measAlg.createKernelFromPsfCandidates(*args, cache=cache)
+        self.assertEqual(len(cache), nCandidates - 1)
+        self.assertGreater(cache.getHits(), hits)
+
+    def testRandomizedPca(self):
+        """Test that the randomized PCA finds the same leading components as the full one."""
+        args = (self.cellSet, self.exposure.getDimensions(), self.exposure.getXY0(), 2, 1, self.ksize)
+        kernel, eigenValues = measAlg.createKernelFromPsfCandidates(*args)
+        randomKernel, randomEigenValues = measAlg.createKernelFromPsfCandidates(*args, randomized=True)
+        self.assertEqual(len(randomEigenValues), 2)
+        self.assertFloatsAlmostEqual(np.array(randomEigenValues), np.array(eigenValues[:2]), rtol=1e-3)
+        self.checkKernelsClose(randomKernel, kernel, 1e-3)
+
+    def testPsfDeterminerThreads(self):
+        """Test that the PSF model doesn't depend on the number of threads used to fit it."""
+        results = []
+        for nThreads in (1, 4):
+            self.setupDeterminer(starSelectorAlg="objectSize")
+            self.psfDeterminer.config.nThreads = nThreads
+            metadata = dafBase.PropertyList()
+
+            stars = self.starSelector.run(self.catalog, exposure=self.exposure)
+            psfCandidateList = self.makePsfCandidates.run(stars.sourceCat, self.exposure).psfCandidates
+
+            psf, cellSet = self.psfDeterminer.determinePsf(self.exposure, psfCandidateList, metadata)
+            results.append((psf.getKernel().getSpatialParameters(), metadata.getScalar("spatialFitChi2"),
+                            metadata.getScalar("numGoodStars")))
+
+        self.assertEqual(results[0], results[1])
+
+    def testPsfDeterminerStampArena(self):
+        """Test that storing the candidates' stamps in an arena doesn't change the PSF model."""
+        results = []
+        for useStampArena in (False, True):
+            self.setupDeterminer(starSelectorAlg="objectSize")
+            self.psfDeterminer.config.useStampArena = useStampArena
+            metadata = dafBase.PropertyList()
+
+            stars = self.starSelector.run(self.catalog, exposure=self.exposure)
+            psfCandidateList = self.makePsfCandidates.run(stars.sourceCat, self.exposure).psfCandidates
+
+            psf, cellSet = self.psfDeterminer.determinePsf(self.exposure, psfCandidateList, metadata)
+            results.append((psf.getKernel().getSpatialParameters(), metadata.getScalar("spatialFitChi2"),
+                            metadata.getScalar("numGoodStars")))
+            self.assertEqual(psfCandidateList[0].getStampArena() is not None, useStampArena)
+
+        self.assertEqual(results[0], results[1])
+
     def testPsfDeterminerSubimageObjectSizeStarSelector(self):
         """Test the (PCA) psfDeterminer on subImages."""
         w, h = self.exposure.getDimensions()
@@ -64,7 +64,7 @@ class SdssShapePsfTestCase(measBaseTests.AlgorithmTestCase, lsst.utils.tests.Tes
         del self.extendedCentroid
         del self.config
 
-    def _computeVaryingPsf(self):
+    def _computeVaryingPsf(self, singlePrecision=False):
         """Compute a varying PSF as a linear combination of PCA (== Karhunen-Loeve) basis functions
 
         We simply desire a PSF that is not constant across the image, so the precise choice of
@@ -90,7 +90,7 @@ class SdssShapePsfTestCase(measBaseTests.AlgorithmTestCase, lsst.utils.tests.Tes
         spFunc = afwMath.PolynomialFunction2D(order)
         exactKernel = afwMath.LinearCombinationKernel(basisKernelList, spFunc)
         exactKernel.setSpatialParameters([[1.0, 0, 0], [0.0, 0.5E-2, 0.2E-2]])
-        exactPsf = measAlg.PcaPsf(exactKernel)
+        exactPsf = measAlg.PcaPsf(exactKernel, singlePrecision=singlePrecision)
 
         return exactPsf
 
@@ -155,6 +155,67 @@ class SdssShapePsfTestCase(measBaseTests.AlgorithmTestCase, lsst.utils.tests.Tes
                                  psf.getKernel().getKernelParameters())
             self._compareKernelImages(resizedPsf, psf)
 
+    def testPcaPsfKernelImages(self):
+        """Test that PcaPsf's stacked-basis kernel images match the LinearCombinationKernel's.
+
+        This test resides here because PcaPsfs do not have their own test module"""
+        positions = [lsst.geom.Point2D(x, y) for x, y in [(0, 0), (50.1, 49.8), (-11.6, -1.7), (200, 120)]]
+        for singlePrecision, rtol, atol in [(False, 1E-12, 1E-15), (True, 1E-5, 1E-8)]:
+            psf = self._computeVaryingPsf(singlePrecision=singlePrecision)
+            self.assertEqual(psf.isSinglePrecision(), singlePrecision)
+            self.assertEqual(psf.resized(41, 41).isSinglePrecision(), singlePrecision)
+            kernel = psf.getKernel()
+            batch = psf.computeKernelImages(positions)
+            self.assertEqual(len(batch), len(positions))
+            for position, batchImage in zip(positions, batch):
+                expected = afwImage.ImageD(kernel.getDimensions())
+                kernel.computeImage(expected, True, position.getX(), position.getY())
+                image = psf.computeKernelImage(position)
+                self.assertEqual(image.getBBox(), expected.getBBox())
+                self.assertEqual(batchImage.getBBox(), expected.getBBox())
+                self.assertFloatsAlmostEqual(image.getArray(), expected.getArray(), rtol=rtol, atol=atol)
+                self.assertFloatsAlmostEqual(batchImage.getArray(), image.getArray(), rtol=rtol,
+                                             atol=atol)
+
+    def testPsfResultCache(self):
+        """Test that cached PSF shapes and aperture fluxes match freshly measured ones.
+        """
+        reference = self._computeVaryingPsf()
+        psf = self._computeVaryingPsf()
+        self.assertIsNone(psf.getResultCache())
+        psf.setResultCacheCapacity(2)
+        cache = psf.getResultCache()
+        self.assertEqual(cache.getCapacity(), 2)
+        positions = [self.pointCentroid1, self.pointCentroid2, self.extendedCentroid]
+        for i in range(2):
+            for position in positions[:2]:
+                shape = psf.computeShape(position)
+                expected = reference.computeShape(position)
+                self.assertEqual(shape.getIxx(), expected.getIxx())
+                self.assertEqual(shape.getIyy(), expected.getIyy())
+                self.assertEqual(shape.getIxy(), expected.getIxy())
+                for radius in (3.0, 5.0):
+                    self.assertEqual(psf.computeApertureFlux(radius, position),
+                                     reference.computeApertureFlux(radius, position))
+        self.assertEqual(cache.getSize(), 2)
+        self.assertEqual(cache.getMisses(), 6)
+        self.assertEqual(cache.getHits(), 6)
+        # A third position evicts the least recently used one
+        psf.computeShape(positions[2])
+        self.assertEqual(cache.getSize(), 2)
+        self.assertEqual(cache.getMisses(), 7)
+        psf.computeShape(positions[1])
+        self.assertEqual(cache.getHits(), 7)
+        psf.computeShape(positions[0])
+        self.assertEqual(cache.getMisses(), 8)
+
+        self.assertIs(type(psf.clone().getResultCache()), type(cache))
+        self.assertEqual(psf.clone().getResultCache().getSize(), cache.getSize())
+        cache.clear()
+        self.assertEqual(cache.getSize(), 0)
+        psf.setResultCacheCapacity(0)
+        self.assertIsNone(psf.getResultCache())
+
     def _compareKernelImages(self, psf1, psf2):
         """Test that overlapping portions of kernel images are identical
         """
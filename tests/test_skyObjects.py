@@ -0,0 +1,93 @@
+# This file is part of meas_algorithms.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+import unittest
+
+import numpy as np
+
+import lsst.geom
+import lsst.afw.geom
+import lsst.afw.image
+import lsst.utils.tests
+from lsst.meas.algorithms import SkyObjectsConfig, generateSkyObjects
+
+
+class SkyObjectsTestCase(lsst.utils.tests.TestCase):
+    def setUp(self):
+        self.mask = lsst.afw.image.Mask(lsst.geom.Box2I(lsst.geom.Point2I(123, 456),
+                                                        lsst.geom.Extent2I(300, 200)))
+        self.mask.addMaskPlane("DETECTED")
+        rng = np.random.RandomState(12345)
+        detected = self.mask.getPlaneBitMask("DETECTED")
+        for x, y in zip(rng.randint(0, 300, 30), rng.randint(0, 200, 30)):
+            self.mask.array[max(y - 10, 0):y + 10, max(x - 10, 0):x + 10] |= detected
+        self.config = SkyObjectsConfig()
+        self.config.avoidMask = ["DETECTED"]
+        self.config.nSources = 50
+
+    def tearDown(self):
+        del self.mask
+
+    def testSkyObjects(self):
+        """Sky objects avoid the masked pixels, the edge and each other"""
+        footprints = generateSkyObjects(self.mask, 678, self.config)
+        self.assertGreater(len(footprints), 0)
+        self.assertLessEqual(len(footprints), self.config.nSources)
+
+        avoid = lsst.afw.geom.SpanSet.fromMask(self.mask, self.mask.getPlaneBitMask("DETECTED"))
+        box = self.mask.getBBox()
+        box.grow(-(int(self.config.sourceRadius) + 1))
+        for i, fp in enumerate(footprints):
+            self.assertEqual(len(fp.getPeaks()), 1)
+            center = fp.getPeaks()[0].getI()
+            self.assertTrue(box.contains(center))
+            self.assertEqual(fp.getSpans(),
+                             lsst.afw.geom.SpanSet.fromShape(int(self.config.sourceRadius),
+                                                             offset=(center.getX(), center.getY())))
+            self.assertFalse(fp.getSpans().overlaps(avoid))
+            for other in footprints[:i]:
+                self.assertFalse(fp.getSpans().overlaps(other.getSpans()))
+
+        # The same seed gives the same objects
+        again = generateSkyObjects(self.mask, 678, self.config)
+        self.assertEqual([fp.getPeaks()[0].getI() for fp in footprints],
+                         [fp.getPeaks()[0].getI() for fp in again])
+
+    def testFull(self):
+        """No sky objects are found when the mask leaves no room"""
+        self.mask.array[:] |= self.mask.getPlaneBitMask("DETECTED")
+        self.assertEqual(generateSkyObjects(self.mask, 678, self.config), [])
+        self.config.avoidMask = ["BAD"]
+        self.config.nSources = 0
+        self.assertEqual(generateSkyObjects(self.mask, 678, self.config), [])
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
@@ -0,0 +1,110 @@
+# This file is part of meas_algorithms.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+import unittest
+
+import numpy as np
+
+import lsst.geom
+import lsst.afw.image as afwImage
+import lsst.afw.math as afwMath
+import lsst.meas.algorithms as measAlg
+import lsst.pex.exceptions
+import lsst.utils.tests
+
+
+class SubtractBackgroundTestCase(lsst.utils.tests.TestCase):
+    def setUp(self):
+        rng = np.random.RandomState(12345)
+        self.maskedImage = afwImage.MaskedImageF(lsst.geom.Box2I(lsst.geom.Point2I(100, 200),
+                                                                 lsst.geom.Extent2I(517, 389)))
+        yy, xx = np.mgrid[0:389, 0:517]
+        self.maskedImage.image.array[:] = 1000 + 0.1*xx - 0.05*yy + rng.normal(0.0, 10.0, xx.shape)
+        self.maskedImage.variance.set(100.0)
+        # Some masked bright pixels and a NaN, to be ignored
+        detected = self.maskedImage.mask.getPlaneBitMask("DETECTED")
+        self.maskedImage.image.array[100:110, 200:220] += 5000
+        self.maskedImage.mask.array[100:110, 200:220] |= detected
+        self.maskedImage.image.array[50, 50] = np.nan
+
+    def tearDown(self):
+        del self.maskedImage
+
+    def testBinEdges(self):
+        edges = measAlg.makeBackgroundBinEdges(517, 5)
+        self.assertEqual(len(edges), 6)
+        self.assertEqual(edges[0], 0)
+        self.assertEqual(edges[-1], 517)
+        self.assertTrue(all(b > a for a, b in zip(edges[:-1], edges[1:])))
+
+    def testFastStatistics(self):
+        """Test that the multithreaded statistics match those of afw
+
+        The tolerance allows for a few pixels (of noise 10) being clipped differently in each bin.
+        """
+        for statistic in ("MEAN", "MEANCLIP", "MEDIAN"):
+            config = measAlg.SubtractBackgroundTask.ConfigClass()
+            config.binSize = 64
+            config.isNanSafe = True
+            config.statisticsProperty = statistic
+            task = measAlg.SubtractBackgroundTask(config=config)
+            expect = task.fitBackground(self.maskedImage)
+            config.doFastStatistics = True
+            config.nThreads = 3
+            actual = task.fitBackground(self.maskedImage)
+            with self.subTest(statistic=statistic):
+                self.assertImagesAlmostEqual(actual.getStatsImage().image, expect.getStatsImage().image,
+                                             atol=0.05)
+                self.assertImagesAlmostEqual(actual.getImageF(config.algorithm, config.undersampleStyle),
+                                             expect.getImageF(config.algorithm, config.undersampleStyle),
+                                             atol=0.05)
+
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            measAlg.computeBackgroundStatistics(self.maskedImage, 5, 5, afwMath.StatisticsControl(),
+                                                afwMath.STDEVCLIP)
+
+    def testReuseStatistics(self):
+        """Test that reusing the statistics with another interpolation gives the same result"""
+        config = measAlg.SubtractBackgroundTask.ConfigClass()
+        config.binSize = 64
+        config.useApprox = False
+        config.isNanSafe = True
+        task = measAlg.SubtractBackgroundTask(config=config)
+        fit = task.fitBackground(self.maskedImage)
+        expect = task.fitBackground(self.maskedImage, algorithm="LINEAR")
+        actual = task.fitBackground(self.maskedImage, algorithm="LINEAR", statsImage=fit.getStatsImage())
+        self.assertImagesAlmostEqual(actual.getImageF("LINEAR", config.undersampleStyle),
+                                     expect.getImageF("LINEAR", config.undersampleStyle))
+        with self.assertRaises(ValueError):
+            task.fitBackground(self.maskedImage, nx=3, ny=3, statsImage=fit.getStatsImage())
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()